@@ -0,0 +1,69 @@
+#pragma once
+
+// Deterministic fixtures shared by the benchmark executables. Everything is
+// derived from a fixed seed so runs on different commits see the same data.
+
+#include "core/ContentItem.h"
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+namespace Bench {
+
+// Mix of plain words, JSON escapes and multi-byte UTF-8
+inline const char* const kWords[] = {"moderation", "queue", "\"quoted\"", "line\nbreak", "tab\there",
+                                     "caf\xC3\xA9", "\xE2\x9C\x93", "\\slash", "emoji\xF0\x9F\x98\x80", "plain"};
+inline constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+inline std::string makeText(std::mt19937& rng, size_t length) {
+    std::string text;
+    text.reserve(length + 16);
+    while (text.size() < length) {
+        text += kWords[rng() % kWordCount];
+        text += ' ';
+    }
+    return text;
+}
+
+// Text of roughly `length` bytes, the same for a given length and seed
+inline std::string makeText(size_t length, unsigned seed = 7) {
+    std::mt19937 rng(seed);
+    return makeText(rng, length);
+}
+
+inline std::vector<ContentItem> makeItems(size_t count, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> score(0.0, 1.0);
+    std::uniform_int_distribution<int> length(20, 2000);
+    std::vector<ContentItem> items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ContentItem item("bench" + std::to_string(i % 7), i % 3 == 0 ? "image" : "text");
+        item.author = "user" + std::to_string(rng() % 1000);
+        item.text = makeText(rng, static_cast<size_t>(length(rng)));
+        if (item.content_type == "image") {
+            item.image_path = "/data/images/" + std::to_string(rng()) + ".jpg";
+        }
+        item.ai_detection.model = "deberta-v3";
+        item.ai_detection.ai_score = score(rng);
+        item.ai_detection.label = item.ai_detection.ai_score > 0.5 ? "ai_generated" : "human";
+        item.ai_detection.confidence = score(rng);
+        item.moderation.provider = "hive";
+        item.moderation.labels.sexual = score(rng);
+        item.moderation.labels.violence = score(rng) * 1e-6;
+        item.moderation.labels.hate = 0.0;
+        item.moderation.labels.drugs = 1.0;
+        item.moderation.labels.additional_labels["harassment"] = score(rng);
+        item.moderation.labels.additional_labels["self_harm"] = score(rng);
+        item.decision.auto_action = i % 5 == 0 ? "review" : "allow";
+        item.decision.rule_id = "rule-" + std::to_string(i % 11);
+        item.decision.threshold_triggered = i % 2 == 0;
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+} // namespace Bench
+} // namespace ModAI
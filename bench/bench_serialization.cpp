@@ -0,0 +1,152 @@
+// Compares ContentItem/HumanAction JSON serialization against the previous
+// nlohmann DOM implementation, and checks that both produce the same bytes.
+//
+// Usage: bench_serialization [items] [rounds]
+
+#include "BenchFixtures.h"
+#include "core/ContentItem.h"
+#include "storage/Storage.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using namespace ModAI;
+using json = nlohmann::json;
+
+namespace {
+
+// The DOM-based serializer this replaced, kept verbatim as the baseline
+std::string legacyToJson(const ContentItem& item) {
+    json j;
+    j["id"] = item.id;
+    j["timestamp"] = item.timestamp;
+    j["source"] = item.source;
+    j["subreddit"] = item.subreddit;
+    j["author"] = item.author.has_value() ? json(item.author.value()) : json(nullptr);
+    j["content_type"] = item.content_type;
+    j["text"] = item.text.has_value() ? json(item.text.value()) : json(nullptr);
+    j["image_path"] = item.image_path.has_value() ? json(item.image_path.value()) : json(nullptr);
+    j["ai_detection"]["model"] = item.ai_detection.model;
+    j["ai_detection"]["ai_score"] = item.ai_detection.ai_score;
+    j["ai_detection"]["label"] = item.ai_detection.label;
+    j["ai_detection"]["confidence"] = item.ai_detection.confidence;
+    j["moderation"]["provider"] = item.moderation.provider;
+    j["moderation"]["labels"]["sexual"] = item.moderation.labels.sexual;
+    j["moderation"]["labels"]["violence"] = item.moderation.labels.violence;
+    j["moderation"]["labels"]["hate"] = item.moderation.labels.hate;
+    j["moderation"]["labels"]["drugs"] = item.moderation.labels.drugs;
+    for (const auto& [key, value] : item.moderation.labels.additional_labels) {
+        j["moderation"]["labels"][key] = value;
+    }
+    j["decision"]["auto_action"] = item.decision.auto_action;
+    j["decision"]["rule_id"] = item.decision.rule_id;
+    j["decision"]["threshold_triggered"] = item.decision.threshold_triggered;
+    j["schema_version"] = item.schema_version;
+    return j.dump();
+}
+
+ContentItem legacyFromJson(const std::string& jsonStr) {
+    ContentItem item;
+    json j = json::parse(jsonStr);
+    item.id = j.value("id", "");
+    item.timestamp = j.value("timestamp", "");
+    item.source = j.value("source", "reddit");
+    item.subreddit = j.value("subreddit", "");
+    if (j.contains("author") && !j["author"].is_null()) item.author = j["author"].get<std::string>();
+    item.content_type = j.value("content_type", "text");
+    if (j.contains("text") && !j["text"].is_null()) item.text = j["text"].get<std::string>();
+    if (j.contains("image_path") && !j["image_path"].is_null()) item.image_path = j["image_path"].get<std::string>();
+    if (j.contains("ai_detection")) {
+        item.ai_detection.model = j["ai_detection"].value("model", "");
+        item.ai_detection.ai_score = j["ai_detection"].value("ai_score", 0.0);
+        item.ai_detection.label = j["ai_detection"].value("label", "");
+        item.ai_detection.confidence = j["ai_detection"].value("confidence", 0.0);
+    }
+    if (j.contains("moderation")) {
+        item.moderation.provider = j["moderation"].value("provider", "");
+        if (j["moderation"].contains("labels")) {
+            auto& labels = j["moderation"]["labels"];
+            item.moderation.labels.sexual = labels.value("sexual", 0.0);
+            item.moderation.labels.violence = labels.value("violence", 0.0);
+            item.moderation.labels.hate = labels.value("hate", 0.0);
+            item.moderation.labels.drugs = labels.value("drugs", 0.0);
+            for (auto& [key, value] : labels.items()) {
+                if (key != "sexual" && key != "violence" && key != "hate" && key != "drugs" && value.is_number()) {
+                    item.moderation.labels.additional_labels[key] = value.get<double>();
+                }
+            }
+        }
+    }
+    if (j.contains("decision")) {
+        item.decision.auto_action = j["decision"].value("auto_action", "allow");
+        item.decision.rule_id = j["decision"].value("rule_id", "");
+        item.decision.threshold_triggered = j["decision"].value("threshold_triggered", false);
+    }
+    item.schema_version = j.value("schema_version", 1);
+    return item;
+}
+
+template <typename Fn>
+double timeIt(size_t rounds, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+void report(const char* name, double legacyMs, double currentMs, size_t items) {
+    std::cout << name << ": legacy " << legacyMs << " ms, current " << currentMs << " ms ("
+              << (legacyMs / currentMs) << "x), " << (currentMs * 1e6 / items) << " ns/item\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+    std::vector<ContentItem> items = Bench::makeItems(count);
+
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    size_t mismatches = 0;
+    for (const auto& item : items) {
+        lines.push_back(item.toJson());
+        if (lines.back() != legacyToJson(item)) {
+            ++mismatches;
+        }
+        if (ContentItem::fromJson(lines.back()).toJson() != lines.back()) {
+            ++mismatches;
+        }
+    }
+    HumanAction action;
+    action.action_id = "a";
+    action.content_id = "c";
+    action.notes = "n\"";
+    if (HumanAction::fromJson(action.toJson()).toJson() != action.toJson()) {
+        ++mismatches;
+    }
+
+    size_t sink = 0;
+    double legacyWrite = timeIt(rounds, [&]() {
+        for (const auto& item : items) sink += legacyToJson(item).size();
+    });
+    double currentWrite = timeIt(rounds, [&]() {
+        for (const auto& item : items) sink += item.toJson().size();
+    });
+    double legacyRead = timeIt(rounds, [&]() {
+        for (const auto& line : lines) sink += legacyFromJson(line).id.size();
+    });
+    double currentRead = timeIt(rounds, [&]() {
+        for (const auto& line : lines) sink += ContentItem::fromJson(line).id.size();
+    });
+
+    std::cout << count << " items, " << rounds << " rounds\n";
+    report("toJson", legacyWrite, currentWrite, count);
+    report("fromJson", legacyRead, currentRead, count);
+    std::cout << "byte mismatches: " << mismatches << " (checksum " << sink << ")\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,376 @@
+// Microbenchmarks for the hot paths of the moderation app, built on Google
+// Benchmark. Fixtures are seeded, so numbers are comparable across commits:
+//
+//   modai_bench --benchmark_out=bench.json --benchmark_out_format=json
+//   compare.py benchmarks before.json after.json   (from google/benchmark tools)
+//
+// The LocalAIDetector benchmarks need a real model: set MODAI_BENCH_MODELS to
+// a directory holding ai_detector.onnx and vocab.txt (the app's data/models).
+// Without it they are reported as skipped, and the tokenizer benchmarks use a
+// generated vocab instead.
+
+#include "BenchFixtures.h"
+#include "core/ContentItem.h"
+#include "core/ResultCache.h"
+#include "core/RuleEngine.h"
+#include "detectors/LocalAIDetector.h"
+#include "detectors/Tokenizer.h"
+#include "storage/JsonlStorage.h"
+#include "ui/DashboardModel.h"
+#include "ui/DashboardProxyModel.h"
+#include "utils/Logger.h"
+#include <benchmark/benchmark.h>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using namespace ModAI;
+
+namespace {
+
+constexpr size_t kItemPool = 1024;
+
+const std::vector<ContentItem>& itemPool() {
+    static const std::vector<ContentItem> items = Bench::makeItems(kItemPool);
+    return items;
+}
+
+std::filesystem::path scratchDir(const std::string& name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "modai_bench" / name;
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+const char* modelsDir() {
+    const char* dir = std::getenv("MODAI_BENCH_MODELS");
+    return dir && *dir ? dir : nullptr;
+}
+
+// --- RuleEngine -------------------------------------------------------------
+
+// `count` rules over varied fields and subreddits. Roughly one in eight can
+// match, and the catch-all comes last, so evaluate() scans most of the list.
+RuleEngine makeRuleEngine(int count) {
+    static const char* const conditions[] = {
+        "ai_score > 0.97 && sexual > 0.9",
+        "violence > 0.5",
+        "hate >= 0.8 || harassment > 0.99",
+        "not (drugs < 2.0)",
+        "self_harm > 0.995",
+        "(sexual > 0.95 and ai_score > 0.9) or hate > 0.5",
+        "harassment > 0.9 && self_harm > 0.9",
+        "ai_score > 0.6 && sexual < 0.1",
+    };
+    RuleEngine engine;
+    for (int i = 0; i < count; ++i) {
+        Rule rule;
+        rule.id = "rule-" + std::to_string(i);
+        rule.name = rule.id;
+        rule.condition = i == count - 1 ? "true" : conditions[i % 8];
+        rule.action = i % 3 == 0 ? "block" : "review";
+        if (i % 4 == 1) {
+            rule.subreddit = "bench" + std::to_string(i % 7);
+        }
+        engine.addRule(rule);
+    }
+    return engine;
+}
+
+void BM_RuleEngineEvaluate(benchmark::State& state) {
+    RuleEngine engine = makeRuleEngine(static_cast<int>(state.range(0)));
+    const auto& items = itemPool();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.evaluate(items[i++ % items.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RuleEngineEvaluate)->RangeMultiplier(10)->Range(10, 1000);
+
+void BM_RuleEngineGetMatchingRules(benchmark::State& state) {
+    RuleEngine engine = makeRuleEngine(static_cast<int>(state.range(0)));
+    const auto& items = itemPool();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.getMatchingRules(items[i++ % items.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RuleEngineGetMatchingRules)->RangeMultiplier(10)->Range(10, 1000);
+
+// --- Tokenizer --------------------------------------------------------------
+
+// The real vocab when available, otherwise a generated one with the special
+// tokens, every fixture word as a whole piece and short subword pieces
+const Tokenizer& benchTokenizer() {
+    static const Tokenizer tokenizer = []() {
+        Tokenizer t;
+        if (const char* dir = modelsDir()) {
+            if (t.loadVocab(std::string(dir) + "/vocab.txt")) {
+                return t;
+            }
+        }
+        std::filesystem::path path = scratchDir("vocab") / "vocab.txt";
+        std::ofstream out(path);
+        out << "[PAD]\n[CLS]\n[SEP]\n[UNK]\n";
+        const std::string wordStart = "\xE2\x96\x81";
+        for (const char* word : Bench::kWords) {
+            out << wordStart << word << '\n';
+        }
+        for (char a = 'a'; a <= 'z'; ++a) {
+            out << wordStart << a << '\n' << a << '\n';
+            for (char b = 'a'; b <= 'z'; ++b) {
+                out << a << b << '\n';
+            }
+        }
+        out.close();
+        t.loadVocab(path.string());
+        return t;
+    }();
+    return tokenizer;
+}
+
+void BM_TokenizerEncode(benchmark::State& state) {
+    const Tokenizer& tokenizer = benchTokenizer();
+    std::string text = Bench::makeText(static_cast<size_t>(state.range(0)));
+    std::vector<int64_t> ids;
+    for (auto _ : state) {
+        // Unbounded length so long inputs are not cut short by truncation
+        tokenizer.encode(text, 1 << 20, ids);
+        benchmark::DoNotOptimize(ids.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_TokenizerEncode)->Arg(64)->Arg(512)->Arg(4096)->Arg(32768);
+
+// --- LocalAIDetector --------------------------------------------------------
+
+LocalAIDetector* benchDetector() {
+    static std::unique_ptr<LocalAIDetector> detector = []() -> std::unique_ptr<LocalAIDetector> {
+        const char* dir = modelsDir();
+        if (!dir) {
+            return nullptr;
+        }
+        auto d = std::make_unique<LocalAIDetector>(std::string(dir) + "/ai_detector.onnx", dir);
+        return d->isAvailable() ? std::move(d) : nullptr;
+    }();
+    return detector.get();
+}
+
+void BM_LocalAIDetectorAnalyze(benchmark::State& state) {
+    LocalAIDetector* detector = benchDetector();
+    if (!detector) {
+        state.SkipWithError("MODAI_BENCH_MODELS not set or model unavailable");
+        return;
+    }
+    std::string text = Bench::makeText(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detector->analyze(text));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LocalAIDetectorAnalyze)->Arg(200)->Arg(1000)->Arg(4000)->Unit(benchmark::kMillisecond);
+
+void BM_LocalAIDetectorAnalyzeBatch(benchmark::State& state) {
+    LocalAIDetector* detector = benchDetector();
+    if (!detector) {
+        state.SkipWithError("MODAI_BENCH_MODELS not set or model unavailable");
+        return;
+    }
+    std::vector<std::string> texts;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        texts.push_back(Bench::makeText(static_cast<size_t>(state.range(1)), static_cast<unsigned>(i)));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detector->analyzeBatch(texts));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LocalAIDetectorAnalyzeBatch)
+    ->ArgsProduct({{1, 8, 32}, {200, 1000}})
+    ->Unit(benchmark::kMillisecond);
+
+// --- ContentItem JSON -------------------------------------------------------
+
+void BM_ContentItemToJson(benchmark::State& state) {
+    const auto& items = itemPool();
+    size_t i = 0;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        std::string json = items[i++ % items.size()].toJson();
+        bytes += static_cast<int64_t>(json.size());
+        benchmark::DoNotOptimize(json.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ContentItemToJson);
+
+void BM_ContentItemFromJson(benchmark::State& state) {
+    std::vector<std::string> lines;
+    for (const auto& item : itemPool()) {
+        lines.push_back(item.toJson());
+    }
+    size_t i = 0;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        const std::string& line = lines[i++ % lines.size()];
+        benchmark::DoNotOptimize(ContentItem::fromJson(line));
+        bytes += static_cast<int64_t>(line.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ContentItemFromJson);
+
+// --- JsonlStorage -----------------------------------------------------------
+
+// One iteration queues range(0) items and waits for them to reach the file
+void BM_JsonlStorageAppend(benchmark::State& state) {
+    std::filesystem::path dir = scratchDir("jsonl_append");
+    JsonlStorage storage(dir.string());
+    const auto& items = itemPool();
+    for (auto _ : state) {
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            storage.saveContent(items[static_cast<size_t>(i) % items.size()]);
+        }
+        storage.flush();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_JsonlStorageAppend)->Arg(1)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+void BM_JsonlStorageLoadAll(benchmark::State& state) {
+    std::filesystem::path dir = scratchDir("jsonl_load");
+    JsonlStorage storage(dir.string());
+    const auto& items = itemPool();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        storage.saveContent(items[static_cast<size_t>(i) % items.size()]);
+    }
+    storage.flush();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(storage.loadAllContent());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_JsonlStorageLoadAll)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+// --- ResultCache ------------------------------------------------------------
+
+nlohmann::json cacheValue(size_t i) {
+    return {{"model", "hive"}, {"sexual", 0.01 * static_cast<double>(i % 100)}, {"violence", 0.2},
+            {"hate", 0.0}, {"drugs", 0.5}, {"labels", {{"harassment", 0.3}, {"self_harm", 0.01}}}};
+}
+
+void BM_ResultCacheGetHit(benchmark::State& state) {
+    std::filesystem::path dir = scratchDir("cache_get");
+    ResultCache cache((dir / "results.cache").string());
+    const size_t keys = static_cast<size_t>(state.range(0));
+    for (size_t i = 0; i < keys; ++i) {
+        cache.put("hash-" + std::to_string(i), cacheValue(i));
+    }
+    std::vector<std::string> lookups;
+    std::mt19937 rng(3);
+    for (size_t i = 0; i < 4096; ++i) {
+        lookups.push_back("hash-" + std::to_string(rng() % keys));
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(lookups[i++ % lookups.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+// Below and above the in-memory value bound, so the second also decodes from disk
+BENCHMARK(BM_ResultCacheGetHit)->Arg(1000)->Arg(100000);
+
+void BM_ResultCachePut(benchmark::State& state) {
+    std::filesystem::path dir = scratchDir("cache_put");
+    ResultCache cache((dir / "results.cache").string());
+    size_t i = 0;
+    for (auto _ : state) {
+        cache.put("hash-" + std::to_string(i), cacheValue(i));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResultCachePut);
+
+// --- DashboardProxyModel ----------------------------------------------------
+
+struct DashboardFixture {
+    DashboardModel model;
+    DashboardProxyModel proxy;
+
+    explicit DashboardFixture(size_t rows) {
+        std::vector<ContentItem> items;
+        items.reserve(rows);
+        const auto& pool = itemPool();
+        for (size_t i = 0; i < rows; ++i) {
+            ContentItem item = pool[i % pool.size()];
+            item.id = "item-" + std::to_string(i);
+            items.push_back(std::move(item));
+        }
+        model.addItems(std::move(items));
+        proxy.setSourceModel(&model);
+    }
+};
+
+void BM_DashboardStatusFilter(benchmark::State& state) {
+    DashboardFixture fixture(static_cast<size_t>(state.range(0)));
+    bool review = false;
+    for (auto _ : state) {
+        review = !review;
+        fixture.proxy.setStatusFilter(review ? "review" : "");
+        benchmark::DoNotOptimize(fixture.proxy.rowCount());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DashboardStatusFilter)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Background scan plus publishing the result to the proxy
+void BM_DashboardSearch(benchmark::State& state) {
+    DashboardFixture fixture(static_cast<size_t>(state.range(0)));
+    auto* watcher = fixture.proxy.findChild<QFutureWatcherBase*>();
+    QEventLoop loop;
+    // Connected after the proxy's own handler, so quit() runs once the result is applied
+    QObject::connect(watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+    static const char* const needles[] = {"caf\xC3\xA9 tab", "user42", "review", "no such text"};
+    size_t i = 0;
+    for (auto _ : state) {
+        fixture.proxy.setSearchFilter(QString::fromUtf8(needles[i++ % 4]));
+        loop.exec();
+        benchmark::DoNotOptimize(fixture.proxy.rowCount());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DashboardSearch)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Event loop for the proxy's search watcher; no GUI is created
+    QCoreApplication app(argc, argv);
+    Logger::init("", Logger::Options{8192, 0, 0, false});
+    Logger::setLevel(Logger::Warn);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "modai_bench", ec);
+    return 0;
+}
@@ -0,0 +1,568 @@
+// End-to-end load generator: pushes a feed through RedditScraper ->
+// ModerationEngine -> Storage with every HTTP call answered by
+// ReplayHttpClient, and reports throughput, latency from a post appearing
+// to its result being stored, and peak memory. Nothing leaves the machine.
+//
+// Usage: modai_loadgen [--config config/daemon.json] [--recording traffic.jsonl]
+//                      [--rate 20] [--duration 60] [--warmup 5] [--subreddits 10]
+//                      [--image-share 0.2] [--latency-scale 1] [--latency-ms N]
+//                      [--jitter-ms 0] [--error-rate 0] [--throttle-rate 0]
+//                      [--lift-rate-limits] [--data <dir>] [--seed 1]
+//
+// The feed is synthetic: each combined listing gains posts at its share of
+// --rate. With --recording (made by modai_daemon --record) the posts reuse
+// the recorded listings' subreddits and content under fresh ids, and Hive
+// and image calls take the recorded latencies, responses and failures;
+// Hive text responses are still generated, to match each batch's size.
+// By default the real Reddit and Hive request budgets apply, so the feed
+// can outrun the scraper; --lift-rate-limits measures the pipeline alone.
+// The service runs on a fresh data directory, with the model from the
+// config's model directory (or the app's) when there is one.
+
+#include "BenchFixtures.h"
+#include "core/ModerationService.h"
+#include "network/HttpTransport.h"
+#include "network/RateLimiter.h"
+#include "network/ReplayHttpClient.h"
+#include "network/ResponseParsers.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace ModAI;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr const char* kCredential = "loadgen";
+
+// Resident set high-water mark in MB; 0 where unknown
+double peakMemoryMb() {
+#if defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);  // bytes
+#elif defined(__unix__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;  // kilobytes
+#else
+    return 0.0;
+#endif
+}
+
+struct FeedOptions {
+    double rate = 20.0;              // posts per second over all listings
+    double imageShare = 0.2;
+    std::chrono::milliseconds redditLatency{120};
+    std::chrono::milliseconds hiveTextLatency{300};
+    std::chrono::milliseconds hiveImageLatency{400};
+    std::chrono::milliseconds downloadLatency{80};
+    uint32_t seed = 1;
+};
+
+/**
+ * Answers Reddit and Hive requests for ReplayHttpClient: listings that
+ * grow at the target rate, Hive outputs sized to the request, and small
+ * generated images. Remembers when each post appeared, which is where
+ * its latency is measured from. Thread-safe.
+ */
+class SyntheticFeed {
+public:
+    SyntheticFeed(FeedOptions options, size_t subreddits, std::shared_ptr<HttpRecording> recording,
+                  std::vector<RedditThing> templates)
+        : options_(options)
+        , subreddits_(std::max<size_t>(1, subreddits))
+        , recording_(std::move(recording))
+        , templates_(std::move(templates))
+        , random_(options.seed)
+        , started_(Clock::now()) {
+    }
+
+    std::optional<HttpExchange> respond(const HttpRequest& req) {
+        if (req.url.find("/api/v1/access_token") != std::string::npos) {
+            return exchange(R"({"access_token":"loadgen","token_type":"bearer","expires_in":86400})",
+                            options_.redditLatency);
+        }
+        if (req.url.find("/new.json") != std::string::npos) {
+            return listing(req.url);
+        }
+        if (req.url.find("thehive.ai") != std::string::npos && req.url.find("text-moderation") != std::string::npos) {
+            return hiveText(req);
+        }
+        // Image moderation and downloads come from the recording when it has them
+        if (recording_ && recording_->contains(req.method, req.url)) {
+            return std::nullopt;
+        }
+        if (req.url.find("visual-moderation") != std::string::npos) {
+            return exchange(hiveImageBody(), options_.hiveImageLatency);
+        }
+        if (req.method == "DOWNLOAD") {
+            return exchange(imageBody(req.url), options_.downloadLatency);
+        }
+        return std::nullopt;
+    }
+
+    // When the post appeared in its subreddit; nullopt if it is not ours
+    std::optional<Clock::time_point> takePostedAt(const std::string& id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = postedAt_.find(id);
+        if (it == postedAt_.end()) {
+            return std::nullopt;
+        }
+        Clock::time_point posted = it->second;
+        postedAt_.erase(it);
+        return posted;
+    }
+
+    uint64_t generated() const { return generated_; }
+
+private:
+    struct Post {
+        std::string id;
+        std::string json;   // the listing child, ready to splice in
+    };
+    struct Listing {
+        std::vector<std::string> subreddits;
+        std::deque<Post> posts;  // oldest first
+        std::unordered_map<std::string, uint64_t> sequence;  // fullname -> position
+        uint64_t first = 0;      // position of posts.front()
+        uint64_t due = 0;        // posts the rate asks for so far
+    };
+
+    static constexpr size_t kKeptPosts = 5000;  // per listing, for cursors
+
+    FeedOptions options_;
+    size_t subreddits_;
+    std::shared_ptr<HttpRecording> recording_;
+    std::vector<RedditThing> templates_;
+    std::mutex mutex_;
+    std::mt19937 random_;
+    Clock::time_point started_;
+    std::map<std::string, Listing> listings_;
+    std::unordered_map<std::string, Clock::time_point> postedAt_;
+    std::atomic<uint64_t> generated_{0};
+    uint64_t nextId_ = 0;
+    size_t nextTemplate_ = 0;
+
+    static HttpExchange exchange(std::string body, std::chrono::milliseconds latency) {
+        HttpExchange result;
+        result.statusCode = 200;
+        result.success = true;
+        result.body = std::move(body);
+        result.latency = latency;
+        result.headers["Content-Type"] = "application/json";
+        return result;
+    }
+
+    static std::string queryValue(const std::string& url, const std::string& key) {
+        size_t at = url.find("?" + key + "=");
+        if (at == std::string::npos) {
+            at = url.find("&" + key + "=");
+        }
+        if (at == std::string::npos) {
+            return "";
+        }
+        at += key.size() + 2;
+        return url.substr(at, url.find('&', at) - at);
+    }
+
+    std::string newPost(const std::string& subreddit, Clock::time_point posted, std::string& id) {
+        static const char* kDigits = "0123456789abcdefghijklmnopqrstuvwxyz";
+        uint64_t n = ++nextId_;
+        id.clear();
+        while (n > 0) {
+            id.insert(id.begin(), kDigits[n % 36]);
+            n /= 36;
+        }
+        id = "lg" + id;
+
+        RedditThing post;
+        if (!templates_.empty()) {
+            post = templates_[nextTemplate_++ % templates_.size()];
+        } else {
+            post.author = "user" + std::to_string(random_() % 5000);
+            post.isSelf = std::uniform_real_distribution<double>(0.0, 1.0)(random_) >= options_.imageShare;
+            post.title = Bench::makeText(random_, 40 + random_() % 80);
+            if (post.isSelf) {
+                post.selftext = Bench::makeText(random_, 50 + random_() % 1500);
+            }
+        }
+        if (!post.isSelf && (templates_.empty() || post.url.empty())) {
+            post.url = "https://i.redd.it/" + id + ".jpg";
+        }
+
+        nlohmann::json data;
+        data["name"] = "t3_" + id;
+        data["id"] = id;
+        data["subreddit"] = subreddit;
+        data["url"] = post.url;
+        data["author"] = post.author ? nlohmann::json(*post.author) : nlohmann::json(nullptr);
+        data["title"] = post.title.value_or("");
+        data["selftext"] = post.selftext.value_or("");
+        data["is_self"] = post.isSelf;
+        data["created_utc"] = std::chrono::duration<double>(
+            (std::chrono::system_clock::now() - (Clock::now() - posted)).time_since_epoch()).count();
+        return nlohmann::json{{"kind", "t3"}, {"data", std::move(data)}}.dump(
+            -1, ' ', false, nlohmann::json::error_handler_t::replace);
+    }
+
+    HttpExchange listing(const std::string& url) {
+        // .../r/a+b+c/new.json?limit=25[&before=t3_x | &after=t3_y]
+        size_t begin = url.find("/r/") + 3;
+        std::string name = url.substr(begin, url.find("/new.json") - begin);
+        size_t limit = std::max<size_t>(1, std::strtoul(queryValue(url, "limit").c_str(), nullptr, 10));
+        std::string before = queryValue(url, "before");
+        std::string after = queryValue(url, "after");
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Listing& feed = listings_[name];
+        if (feed.subreddits.empty()) {
+            for (size_t start = 0, plus; start <= name.size(); start = plus + 1) {
+                plus = std::min(name.find('+', start), name.size());
+                feed.subreddits.push_back(name.substr(start, plus - start));
+            }
+        }
+        // Posts are spread over listings by their share of subreddits; the
+        // ones that appeared since the last poll are created now, dated
+        // when they were due
+        const double rate = options_.rate * static_cast<double>(feed.subreddits.size()) / subreddits_;
+        const double seconds = std::chrono::duration<double>(Clock::now() - started_).count();
+        const uint64_t due = rate > 0.0 ? static_cast<uint64_t>(seconds * rate) : 0;
+        for (; feed.due < due; ++feed.due) {
+            auto posted = started_ + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(feed.due + 1) / rate));
+            Post post;
+            post.json = newPost(feed.subreddits[feed.due % feed.subreddits.size()], posted, post.id);
+            postedAt_.emplace(post.id, posted);
+            feed.sequence["t3_" + post.id] = feed.first + feed.posts.size();
+            feed.posts.push_back(std::move(post));
+            ++generated_;
+        }
+        while (feed.posts.size() > kKeptPosts) {
+            feed.sequence.erase("t3_" + feed.posts.front().id);
+            feed.posts.pop_front();
+            ++feed.first;
+        }
+
+        // Positions [from, to) in feed.posts, served newest first
+        const uint64_t end = feed.first + feed.posts.size();
+        uint64_t from = 0;
+        uint64_t to = 0;
+        if (!before.empty()) {
+            auto it = feed.sequence.find(before);
+            if (it != feed.sequence.end()) {
+                from = it->second + 1;
+                to = std::min(end, from + limit);
+            }
+        } else if (!after.empty()) {
+            auto it = feed.sequence.find(after);
+            if (it != feed.sequence.end()) {
+                to = it->second;
+                from = to - std::min<uint64_t>(to - feed.first, limit);
+            }
+        } else {
+            to = end;
+            from = to - std::min<uint64_t>(feed.posts.size(), limit);
+        }
+
+        std::string body = R"({"kind":"Listing","data":{"children":[)";
+        for (uint64_t position = to; position > from; --position) {
+            body += feed.posts[position - 1 - feed.first].json;
+            if (position - 1 > from) {
+                body += ',';
+            }
+        }
+        body += "],\"after\":";
+        body += to > from && from > feed.first ? "\"t3_" + feed.posts[from - feed.first].id + "\"" : std::string("null");
+        body += "}}";
+        return exchange(std::move(body), options_.redditLatency);
+    }
+
+    HttpExchange hiveText(const HttpRequest& req) {
+        size_t inputs = 1;
+        try {
+            inputs = std::max<size_t>(1, nlohmann::json::parse(req.body).at("input").size());
+        } catch (const std::exception&) {
+        }
+        std::chrono::milliseconds latency = options_.hiveTextLatency;
+        if (recording_) {
+            if (const HttpExchange* recorded = recording_->next(req.method, req.url)) {
+                latency = recorded->latency;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        nlohmann::json outputs = nlohmann::json::array();
+        for (size_t i = 0; i < inputs; ++i) {
+            nlohmann::json classes = nlohmann::json::array();
+            for (const char* name : {"sexual", "violence", "hate", "drugs", "bullying"}) {
+                // Mostly clean, with the occasional flag for the rules to act on
+                int value = random_() % 100 < 3 ? 1 + static_cast<int>(random_() % 3) : 0;
+                classes.push_back({{"class", name}, {"value", value}});
+            }
+            outputs.push_back({{"classes", std::move(classes)}});
+        }
+        return exchange(nlohmann::json{{"output", std::move(outputs)}}.dump(), latency);
+    }
+
+    std::string hiveImageBody() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::uniform_real_distribution<double> score(0.0, 0.2);
+        nlohmann::json classes = nlohmann::json::array();
+        for (const char* name : {"general_nsfw", "general_suggestive", "general_not_nsfw_not_suggestive",
+                                 "yes_violence", "yes_drugs"}) {
+            classes.push_back({{"class", name}, {"value", score(random_)}});
+        }
+        return nlohmann::json{{"output", {{{"classes", std::move(classes)}}}}}.dump();
+    }
+
+    // Noise seeded by the URL, so every post has its own image
+    static std::string imageBody(const std::string& url) {
+        std::mt19937 noise(static_cast<uint32_t>(std::hash<std::string>()(url)));
+        QImage image(160, 120, QImage::Format_RGB32);
+        for (int y = 0; y < image.height(); ++y) {
+            auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                line[x] = qRgb(noise() & 0xff, noise() & 0xff, noise() & 0xff);
+            }
+        }
+        QByteArray bytes;
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "JPG", 80);
+        return bytes.toStdString();
+    }
+};
+
+// Subreddits and post content of the recorded listings
+std::vector<RedditThing> recordedPosts(const HttpRecording& recording, std::vector<std::string>& subreddits) {
+    std::vector<RedditThing> posts;
+    std::map<std::string, bool> seen;
+    for (const auto& exchange : recording.exchanges()) {
+        if (exchange.method != "GET" || exchange.url.find("/new.json") == std::string::npos || !exchange.success) {
+            continue;
+        }
+        try {
+            if (auto listing = parseRedditListing(exchange.body)) {
+                for (auto& post : listing->children) {
+                    if (!post.subreddit.empty() && !seen[post.subreddit]) {
+                        seen[post.subreddit] = true;
+                        subreddits.push_back(post.subreddit);
+                    }
+                    posts.push_back(std::move(post));
+                }
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return posts;
+}
+
+void usage(const char* program) {
+    std::cout << "Usage: " << program << " [--config <path>] [--recording <file>] [--rate <posts/s>]\n"
+              << "       [--duration <s>] [--warmup <s>] [--subreddits <n>] [--image-share <0..1>]\n"
+              << "       [--latency-scale <x>] [--latency-ms <ms>] [--jitter-ms <ms>]\n"
+              << "       [--error-rate <0..1>] [--throttle-rate <0..1>] [--lift-rate-limits]\n"
+              << "       [--data <dir>] [--seed <n>]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("ModAI");
+    app.setOrganizationName("ModAI");
+
+    std::string configPath;
+    std::string recordingPath;
+    std::string dataPath;
+    FeedOptions feedOptions;
+    ReplayOptions replayOptions;
+    int durationSeconds = 60;
+    int warmupSeconds = 5;
+    size_t subredditCount = 10;
+    bool liftRateLimits = false;
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+        if (std::strcmp(argv[i], "--config") == 0) {
+            configPath = next();
+        } else if (std::strcmp(argv[i], "--recording") == 0) {
+            recordingPath = next();
+        } else if (std::strcmp(argv[i], "--data") == 0) {
+            dataPath = next();
+        } else if (std::strcmp(argv[i], "--rate") == 0) {
+            feedOptions.rate = std::atof(next());
+        } else if (std::strcmp(argv[i], "--duration") == 0) {
+            durationSeconds = std::max(1, std::atoi(next()));
+        } else if (std::strcmp(argv[i], "--warmup") == 0) {
+            warmupSeconds = std::max(0, std::atoi(next()));
+        } else if (std::strcmp(argv[i], "--subreddits") == 0) {
+            subredditCount = std::max(1, std::atoi(next()));
+        } else if (std::strcmp(argv[i], "--image-share") == 0) {
+            feedOptions.imageShare = std::atof(next());
+        } else if (std::strcmp(argv[i], "--latency-scale") == 0) {
+            replayOptions.latencyScale = std::atof(next());
+        } else if (std::strcmp(argv[i], "--latency-ms") == 0) {
+            replayOptions.fixedLatency = std::chrono::milliseconds(std::atoi(next()));
+        } else if (std::strcmp(argv[i], "--jitter-ms") == 0) {
+            replayOptions.jitter = std::chrono::milliseconds(std::atoi(next()));
+        } else if (std::strcmp(argv[i], "--error-rate") == 0) {
+            replayOptions.errorRate = std::atof(next());
+        } else if (std::strcmp(argv[i], "--throttle-rate") == 0) {
+            replayOptions.throttleRate = std::atof(next());
+        } else if (std::strcmp(argv[i], "--lift-rate-limits") == 0) {
+            liftRateLimits = true;
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            feedOptions.seed = replayOptions.seed = static_cast<uint32_t>(std::strtoul(next(), nullptr, 10));
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << "\n";
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    ServiceConfig config;
+    if (!configPath.empty()) {
+        auto loaded = ServiceConfig::fromJsonFile(configPath);
+        if (!loaded) {
+            return 1;
+        }
+        config = std::move(*loaded);
+    }
+
+    auto recording = std::make_shared<HttpRecording>();
+    std::vector<RedditThing> templates;
+    std::vector<std::string> subreddits;
+    if (!recordingPath.empty()) {
+        if (!recording->load(recordingPath)) {
+            return 1;
+        }
+        templates = recordedPosts(*recording, subreddits);
+    }
+    if (subreddits.empty()) {
+        for (size_t i = 0; i < subredditCount; ++i) {
+            subreddits.push_back("loadgen" + std::to_string(i));
+        }
+    }
+
+    QTemporaryDir scratch;
+    if (config.modelDir.empty()) {
+        config.modelDir = ServiceConfig::defaultDataPath() + "/models";
+    }
+    config.dataPath = dataPath.empty() ? scratch.path().toStdString() : dataPath;
+    config.logFile = config.dataPath + "/logs/loadgen.log";
+    Logger::init(config.logFile);
+    config.hiveApiKey = config.redditClientId = config.redditClientSecret = kCredential;
+    config.watchRules = false;
+    config.workQueue.persist = false;
+    config.shardInstance.clear();
+    config.shardInstances.clear();
+    // Every listing is polled each second; the feed decides how much is new
+    config.polling.adaptive = false;
+
+    if (liftRateLimits) {
+        // The first caller for a key decides its rate
+        RateLimiter::shared(std::string("reddit:") + kCredential, 1000000, std::chrono::seconds(60));
+        RateLimiter::shared(std::string("hive:") + kCredential, 1000000, std::chrono::seconds(60));
+    }
+
+    auto feed = std::make_shared<SyntheticFeed>(feedOptions, subreddits.size(), recording, std::move(templates));
+    auto clients = std::make_shared<std::atomic<uint32_t>>(0);
+    config.httpClientFactory = [recording, feed, replayOptions, clients]() -> std::unique_ptr<HttpClient> {
+        ReplayOptions options = replayOptions;
+        options.seed += clients->fetch_add(1);  // clients don't fail in lockstep
+        return std::make_unique<ReplayHttpClient>(recording, options,
+            [feed](const HttpRequest& req) { return feed->respond(req); });
+    };
+
+    Histogram& latency = Metrics::histogram("modai_loadgen_item_latency");
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> measured{0};  // processed within the measured window
+    const auto started = Clock::now();
+    const auto measureFrom = started + std::chrono::seconds(warmupSeconds);
+    const auto measureUntil = measureFrom + std::chrono::seconds(durationSeconds);
+
+    ModerationService service(config);
+    service.setOnItemProcessed([&](const ContentItem& item) {
+        ++processed;
+        auto posted = feed->takePostedAt(item.id);
+        auto now = Clock::now();
+        if (now < measureFrom || now > measureUntil) {
+            return;
+        }
+        ++measured;
+        if (posted && *posted >= measureFrom) {
+            latency.record(now - *posted);
+        }
+    });
+
+    std::cout << "Feeding " << feedOptions.rate << " posts/s into " << subreddits.size() << " subreddits for "
+              << durationSeconds << "s (after " << warmupSeconds << "s warm-up)"
+              << (recordingPath.empty() ? "" : " from " + recordingPath) << "\n";
+    service.start();
+    service.startScraping(subreddits, 1);
+
+    QTimer progress;
+    uint64_t lastProcessed = 0;
+    QObject::connect(&progress, &QTimer::timeout, &app, [&]() {
+        uint64_t now = processed.load();
+        std::cout << "  " << std::setw(4)
+                  << std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - started).count()
+                  << "s  generated " << feed->generated() << ", processed " << now << " (+"
+                  << (now - lastProcessed) << "/s), peak " << std::fixed << std::setprecision(0)
+                  << peakMemoryMb() << " MB\n";
+        lastProcessed = now;
+    });
+    progress.start(1000);
+    QTimer::singleShot(std::chrono::duration_cast<std::chrono::milliseconds>(measureUntil - started),
+                       &app, &QCoreApplication::quit);
+    app.exec();
+    progress.stop();
+
+    const double seconds = static_cast<double>(durationSeconds);
+    const uint64_t generated = feed->generated();
+    const uint64_t done = processed.load();
+    service.stop(false);
+
+    auto ms = [](uint64_t micros) { return static_cast<double>(micros) / 1000.0; };
+    std::cout << std::fixed << std::setprecision(2)
+              << "\nGenerated " << generated << " posts, processed " << done << "\n"
+              << "Throughput: " << static_cast<double>(measured.load()) / seconds << " items/s measured ("
+              << feedOptions.rate << " offered)\n"
+              << "Latency, posted to stored (ms): p50 " << ms(latency.quantileMicros(0.50))
+              << ", p90 " << ms(latency.quantileMicros(0.90))
+              << ", p99 " << ms(latency.quantileMicros(0.99))
+              << ", max " << ms(latency.maxMicros()) << "\n"
+              << "Peak memory: " << peakMemoryMb() << " MB\n\n"
+              << Metrics::renderSummary();
+
+    HttpTransport::instance().shutdown();
+    Logger::shutdown();
+    return 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace ModAI {
+
+// Thread-safe FIFO with a fixed capacity. push() blocks while the queue is
+// full, which is how pipeline stages apply backpressure to their producers.
+// After close(), pushes fail and pops drain whatever is left before
+// returning std::nullopt.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(capacity == 0 ? 1 : capacity) {
+    }
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    bool tryPush(T item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || items_.size() >= capacity_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return item;
+    }
+
+    // Blocks for the first item, then keeps collecting until maxItems are
+    // taken or maxWait has elapsed since the first one arrived. Returns an
+    // empty vector only once the queue is closed and drained.
+    std::vector<T> popBatch(size_t maxItems, std::chrono::milliseconds maxWait) {
+        std::vector<T> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+
+        auto deadline = std::chrono::steady_clock::now() + maxWait;
+        while (batch.size() < maxItems) {
+            if (items_.empty()) {
+                if (closed_ || !notEmpty_.wait_until(lock, deadline, [this] {
+                        return closed_ || !items_.empty();
+                    })) {
+                    break;
+                }
+                if (items_.empty()) {
+                    break;
+                }
+            }
+            batch.push_back(std::move(items_.front()));
+            items_.pop_front();
+            notFull_.notify_one();
+        }
+        return batch;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.clear();
+        notFull_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+private:
+    const size_t capacity_;
+    std::deque<T> items_;
+    bool closed_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+} // namespace ModAI
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+/**
+ * Consistent hashing of keys (subreddit names) onto instances. Each
+ * instance owns many points on a 64-bit ring and a key belongs to the
+ * first point at or after its hash, so adding or removing an instance
+ * moves only about 1/n of the keys. Keys are case-insensitive.
+ */
+class ConsistentHashRing {
+public:
+    explicit ConsistentHashRing(std::vector<std::string> nodes, int virtualNodes = 128);
+
+    // The owning node; empty if the ring has no nodes
+    const std::string& owner(const std::string& key) const;
+    bool owns(const std::string& node, const std::string& key) const { return owner(key) == node; }
+
+    const std::vector<std::string>& nodes() const { return nodes_; }
+
+private:
+    struct Point {
+        uint64_t hash;
+        size_t node;
+    };
+
+    std::vector<std::string> nodes_;
+    std::vector<Point> ring_;  // sorted by hash
+};
+
+} // namespace ModAI
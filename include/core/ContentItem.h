@@ -1,18 +1,26 @@
 #pragma once
 
+#include "core/LabelScores.h"
+#include "core/Symbol.h"
+#include "utils/CancellationToken.h"
 #include <string>
-#include <map>
 #include <chrono>
+#include <memory>
 #include <optional>
+#include <vector>
 #include <QMetaType>
 
 namespace ModAI {
 
+// Fields repeated across many items are interned Symbols; id, timestamp
+// and text stay plain strings.
+
 struct AIDetection {
-    std::string model;
+    Symbol model;
     double ai_score = 0.0;
-    std::string label;  // "ai_generated" or "human"
+    Symbol label;  // "ai_generated" or "human"
     double confidence = 0.0;
+    std::vector<double> chunk_scores;  // per window for long texts, else empty
 };
 
 struct ModerationLabels {
@@ -20,17 +28,17 @@ struct ModerationLabels {
     double violence = 0.0;
     double hate = 0.0;
     double drugs = 0.0;
-    std::map<std::string, double> additional_labels;
+    LabelScores additional_labels;
 };
 
 struct ModerationResult {
-    std::string provider;
+    Symbol provider;
     ModerationLabels labels;
 };
 
 struct Decision {
-    std::string auto_action;  // "allow", "block", "review"
-    std::string rule_id;
+    Symbol auto_action;  // "allow", "block", "review"
+    Symbol rule_id;
     bool threshold_triggered = false;
 };
 
@@ -38,10 +46,10 @@ class ContentItem {
 public:
     std::string id;
     std::string timestamp;  // ISO-8601
-    std::string source;
-    std::string subreddit;
+    Symbol source;
+    Symbol subreddit;
     std::optional<std::string> author;
-    std::string content_type;  // "text" or "image"
+    Symbol content_type;  // "text" or "image"
     std::optional<std::string> text;
     std::optional<std::string> image_path;
     std::optional<std::string> post_id;  // Reddit post ID for fetching comments
@@ -50,15 +58,35 @@ public:
     ModerationResult moderation;
     Decision decision;
     
+    // Id of the earlier item this one is a near-duplicate of (the cluster
+    // it joined); its detector results were reused. Empty if none.
+    std::string duplicate_of;
+    // Set by ReprocessJob: the detectors run again rather than reusing
+    // cached or near-duplicate results. Carried through the work queue,
+    // never stored.
+    bool reprocess = false;
+    
     int schema_version = 1;
     
+    // Not serialized: the session the item is processed for and its
+    // latency budget; stages stop working on it once this stops
+    CancellationToken cancellation;
+    
+    // New item: fresh UUIDv7 id, current time
     ContentItem();
     ContentItem(const std::string& subreddit, const std::string& content_type);
     
+    // Empty id and timestamp, for items about to be filled from parsed data
+    struct Blank {};
+    explicit ContentItem(Blank);
+    
     std::string toJson() const;
     static ContentItem fromJson(const std::string& json);
 };
 
+// Shared, immutable handle for views that keep items without copying them
+using ContentItemPtr = std::shared_ptr<const ContentItem>;
+
 } // namespace ModAI
 
 // Register with Qt's meta-type system for signal/slot usage
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/WorkQueue.h"
+#include "storage/GroupCommitWriter.h"
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ModAI {
+
+/**
+ * The in-process work queue: bounded, with priority classes and
+ * per-subreddit fairness.
+ *
+ * Classes are served by weighted round robin (by default 8 fresh posts, 3
+ * requested comments, 1 backfill item per round while all have work), and
+ * within a class subreddits take turns, so a 10k-comment megathread or
+ * one busy subreddit can't starve the rest.
+ *
+ * When full, publish() holds the caller (the scraper's listing threads)
+ * for up to maxBlock, which stretches the scrape cycle instead of
+ * buffering more; after that the shed policy decides what is dropped.
+ *
+ * With a journal path, accepted items are journaled and retired on ack(),
+ * so items queued or in flight at a restart are delivered again.
+ */
+class IngestScheduler : public WorkQueue {
+public:
+    explicit IngestScheduler(const WorkQueueConfig& config);
+    ~IngestScheduler() override;
+
+    bool publish(const ContentItem& item, WorkPriority priority) override;
+    std::vector<WorkDelivery> receive(size_t maxItems, std::chrono::milliseconds wait) override;
+    void ack(const std::string& token) override;
+    void clear() override;
+    void close() override;
+    bool isClosed() const override;
+    const char* name() const override { return "inprocess"; }
+
+    size_t size() const;
+    size_t size(WorkPriority priority) const;
+
+private:
+    static constexpr size_t kClasses = 3;
+
+    struct Entry {
+        ContentItem item;
+        WorkPriority priority;
+        bool replayed = false;  // restored from the journal
+    };
+    // One class: a FIFO per subreddit, served in turn
+    struct ClassQueue {
+        std::unordered_map<std::string, std::deque<Entry>> bySubreddit;
+        std::deque<std::string> turns;  // subreddits with items, next first
+        size_t size = 0;
+        int credit = 0;                 // takes left this round
+    };
+
+    WorkQueueConfig config_;
+    std::array<int, kClasses> weights_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::array<ClassQueue, kClasses> classes_;
+    size_t size_ = 0;
+    bool closed_ = false;
+
+    // Journal: "+<priority><item json>" when accepted, "-<id>" when acked;
+    // each "-" retires one "+" for that id, oldest first
+    std::unique_ptr<GroupCommitWriter> journal_;
+    // Taken, not yet acked, by delivery token ("<seq>:<id>"): the same id
+    // can be in flight twice when it was published again
+    std::unordered_map<std::string, Entry> inFlight_;
+    uint64_t deliverySeq_ = 0;
+    size_t journalRecords_ = 0;
+
+    void enqueue(Entry entry);
+    Entry takeNext();
+    bool shedFor(WorkPriority priority);
+    void replayJournal();
+    void compactJournal();  // caller holds mutex_
+};
+
+} // namespace ModAI
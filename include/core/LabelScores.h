@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/Symbol.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace ModAI {
+
+/**
+ * Small flat map of label -> score, kept in label string order like the
+ * std::map it replaces. Items carry a handful of labels, so a linear scan
+ * over one contiguous vector beats tree nodes and per-node key strings.
+ */
+class LabelScores {
+public:
+    using value_type = std::pair<Symbol, double>;
+    using iterator = std::vector<value_type>::iterator;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    double& operator[](const Symbol& label) {
+        auto it = find(label);
+        if (it != entries_.end()) {
+            return it->second;
+        }
+        auto position = std::lower_bound(entries_.begin(), entries_.end(), label,
+                                         [](const value_type& entry, const Symbol& key) { return entry.first < key; });
+        return entries_.insert(position, value_type(label, 0.0))->second;
+    }
+
+    iterator find(const Symbol& label) {
+        return std::find_if(entries_.begin(), entries_.end(),
+                            [&label](const value_type& entry) { return entry.first == label; });
+    }
+
+    const_iterator find(const Symbol& label) const {
+        return std::find_if(entries_.begin(), entries_.end(),
+                            [&label](const value_type& entry) { return entry.first == label; });
+    }
+
+    size_t count(const Symbol& label) const { return find(label) != entries_.end() ? 1 : 0; }
+
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    void clear() { entries_.clear(); }
+
+    friend bool operator==(const LabelScores& a, const LabelScores& b) { return a.entries_ == b.entries_; }
+    friend bool operator!=(const LabelScores& a, const LabelScores& b) { return a.entries_ != b.entries_; }
+
+private:
+    std::vector<value_type> entries_;
+};
+
+} // namespace ModAI
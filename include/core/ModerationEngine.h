@@ -1,16 +1,35 @@
 #pragma once
 
 #include "core/ContentItem.h"
+#include "core/NearDuplicateIndex.h"
 #include "core/RuleEngine.h"
+#include "core/ResultCache.h"
 #include "detectors/TextDetector.h"
 #include "detectors/ImageModerator.h"
+#include "detectors/ImagePreprocessor.h"
 #include "detectors/TextModerator.h"
 #include "storage/Storage.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <unordered_map>
+
+class QThreadPool;
 
 namespace ModAI {
 
+struct DetectionCacheStats {
+    uint64_t aiDetectionHits = 0;
+    uint64_t aiDetectionMisses = 0;
+    uint64_t textModerationHits = 0;
+    uint64_t textModerationMisses = 0;
+    uint64_t imageModerationHits = 0;
+    uint64_t imageModerationMisses = 0;
+};
+
 class ModerationEngine {
 private:
     std::unique_ptr<TextDetector> textDetector_;
@@ -18,8 +37,38 @@ private:
     std::unique_ptr<TextModerator> textModerator_;
     std::unique_ptr<RuleEngine> ruleEngine_;
     std::unique_ptr<Storage> storage_;
+    // ai_detection.model, also part of the AI detection cache key
+    Symbol textDetectorModel_;
+    
+    std::unique_ptr<ResultCache> resultCache_;
+    // SimHash / dHash of already moderated items, for lightly edited reposts
+    std::unique_ptr<NearDuplicateIndex> textDuplicates_;
+    std::unique_ptr<NearDuplicateIndex> imageDuplicates_;
+    // Hashes computed at lookup, kept until the item is remembered
+    std::mutex pendingHashesMutex_;
+    std::unordered_map<std::string, uint64_t> pendingHashes_;
+    ImagePreprocessor imagePreprocessor_;  // downscales before upload
     
     std::function<void(const ContentItem&)> onItemProcessed_;
+    
+    // Runs processItem()'s detectors side by side
+    std::unique_ptr<QThreadPool> detectorPool_;
+    std::atomic<int64_t> detectorTimeoutMs_{20000};
+    std::atomic<bool> lazyDetectors_{false};
+    
+    std::atomic<uint64_t> aiDetectionHits_{0};
+    std::atomic<uint64_t> aiDetectionMisses_{0};
+    std::atomic<uint64_t> textModerationHits_{0};
+    std::atomic<uint64_t> textModerationMisses_{0};
+    std::atomic<uint64_t> imageModerationHits_{0};
+    std::atomic<uint64_t> imageModerationMisses_{0};
+
+    template <typename Labels>
+    static void applyModerationLabels(ContentItem& item, const Labels& labels);
+    void moderateImage(ContentItem& item);
+    void runDetectors(ContentItem& item);
+    // resultCache_'s entry for key, unless the item is being reprocessed
+    std::optional<nlohmann::json> cachedResult(const ContentItem& item, const std::string& key);
 
 public:
     ModerationEngine(
@@ -29,9 +78,63 @@ public:
         std::unique_ptr<RuleEngine> ruleEngine,
         std::unique_ptr<Storage> storage
     );
+    ~ModerationEngine();
     
+    // AI detection and moderation run concurrently; a detector that misses
+    // the timeout (or the item's deadline) leaves its fields at their
+    // defaults instead of blocking. Items already cancelled are ignored.
     void processItem(ContentItem item);
+    void setDetectorTimeout(std::chrono::milliseconds timeout) { detectorTimeoutMs_ = timeout.count(); }
+    
+    /**
+     * With lazy detectors, detectors run cheapest first (local AI, then
+     * Hive) and Hive moderation is skipped when the item's rules don't read
+     * its labels or the decision is already settled without them. Skipped
+     * items keep default labels with provider "skipped".
+     */
+    void setLazyDetectors(bool lazy) { lazyDetectors_ = lazy; }
+    // Whether Hive moderation can still change the item's decision, given
+    // the inputs already filled in; always true unless lazy
+    bool needsModeration(const ContentItem& item, RuleInputs known = kAIScoreInput) const;
+    // Records that moderation was not needed for the item
+    void skipModeration(ContentItem& item);
+
+    // Individual stages, run in order by processItem() or concurrently
+    // across items by ModerationPipeline. All are safe to call from
+    // worker threads.
+    void detectAI(ContentItem& item);
+    void detectAIBatch(std::vector<ContentItem>& items);
+    void moderate(ContentItem& item);
+    void moderateBatch(std::vector<ContentItem>& items);
+    void applyRules(ContentItem& item);
+    // Blocks until the item is on disk. False if the save failed: the item
+    // must not be notified (and so acked), leaving it to be redelivered.
+    bool persist(const ContentItem& item);
+    void notify(const ContentItem& item);
+
     void setOnItemProcessed(std::function<void(const ContentItem&)> callback);
+    // The ONNX model variant (fp32, int8, fp16) the text detector runs;
+    // recorded with each score and keyed into the cache. Set before
+    // processing starts.
+    void setTextDetectorVariant(const std::string& variant);
+    
+    // Detector results are reused for content whose normalized text or
+    // image bytes (and detector version) were seen before. Optional;
+    // set before processing starts.
+    void setResultCache(std::unique_ptr<ResultCache> cache);
+    
+    /**
+     * Text and image items within the given Hamming distance of an earlier
+     * item reuse its AI and moderation results instead of running the
+     * detectors again. Optional; set before processing starts.
+     */
+    void setNearDuplicateDetection(NearDuplicateOptions text, NearDuplicateOptions image);
+    // If the item is a near-duplicate of one processed before, copies that
+    // item's detector results, sets duplicate_of and returns true
+    bool reuseNearDuplicate(ContentItem& item);
+    // Makes a processed item available to later near-duplicates
+    void rememberNearDuplicate(const ContentItem& item);
+    DetectionCacheStats cacheStats() const;
 };
 
 } // namespace ModAI
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "core/BoundedQueue.h"
+#include "core/ContentItem.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ModAI {
+
+class ModerationEngine;
+class Histogram;
+class Gauge;
+
+struct PipelineStageConfig {
+    size_t queueCapacity;
+    int workers;
+};
+
+struct PipelineConfig {
+    PipelineStageConfig ingest{512, 1};
+    PipelineStageConfig aiDetection{128, 2};   // CPU-bound ONNX inference
+    PipelineStageConfig moderation{128, 4};    // network-bound Hive calls
+    PipelineStageConfig rules{128, 1};
+    PipelineStageConfig persistence{256, 4};   // each waits for its fsync; they share group commits
+    PipelineStageConfig notify{256, 1};
+
+    // Micro-batching for the AI detection stage: a worker takes up to
+    // aiBatchSize items, waiting at most aiBatchMaxWait after the first.
+    size_t aiBatchSize = 16;
+    std::chrono::milliseconds aiBatchMaxWait{20};
+
+    // Same for moderation: text items in a batch share one multi-input
+    // Hive request (and one rate-limiter token).
+    size_t moderationBatchSize = 32;
+    std::chrono::milliseconds moderationBatchMaxWait{50};
+};
+
+/**
+ * Runs ModerationEngine's stages on separate worker pools connected by
+ * bounded queues, so slow Hive round-trips overlap with local inference
+ * instead of serialising the whole feed behind one item.
+ *
+ * Each stage runs under its item's CancellationToken. Items whose token
+ * was cancelled are dropped at the next stage; items past their deadline
+ * skip the remaining detectors and are decided on what they already have.
+ */
+class ModerationPipeline {
+public:
+    enum class Stage {
+        Ingest = 0,
+        AIDetection,
+        Moderation,
+        Rules,
+        Persistence,
+        Notify
+    };
+    static constexpr size_t kStageCount = 6;
+
+    explicit ModerationPipeline(ModerationEngine& engine, PipelineConfig config = PipelineConfig());
+    ~ModerationPipeline();
+
+    ModerationPipeline(const ModerationPipeline&) = delete;
+    ModerationPipeline& operator=(const ModerationPipeline&) = delete;
+
+    void start();
+    void stop();
+    // Stops accepting items and finishes everything already submitted:
+    // stages shut down in order, each once the ones feeding it are done
+    void drain();
+
+    // Blocks while the ingest queue is full. Returns false once stopped.
+    bool submit(ContentItem item);
+    // Never blocks; returns false if the ingest queue is full or stopped.
+    bool trySubmit(ContentItem item);
+
+    // Drops everything still waiting in the stage queues. Items a worker
+    // has already picked up run to completion.
+    void clear();
+
+    size_t queuedCount(Stage stage) const;
+    size_t pendingCount() const;
+    bool isRunning() const { return running_; }
+
+    static const char* stageName(Stage stage);
+
+private:
+    struct Queued {
+        ContentItem item;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    // modai_pipeline_{stage,queue_wait}_seconds and modai_pipeline_queue_depth;
+    // batched stages record one stage sample per batch
+    struct StageMetrics {
+        Histogram* run = nullptr;
+        Histogram* wait = nullptr;
+        Gauge* depth = nullptr;
+    };
+
+    ModerationEngine& engine_;
+    PipelineConfig config_;
+    std::array<std::unique_ptr<BoundedQueue<Queued>>, kStageCount> queues_;
+    std::array<StageMetrics, kStageCount> metrics_;
+    std::array<std::vector<std::thread>, kStageCount> workers_;
+    std::atomic<bool> running_{false};
+
+    const PipelineStageConfig& stageConfig(Stage stage) const;
+    void joinStage(Stage stage);
+    void runWorker(Stage stage);
+    void runBatchWorker(Stage stage);
+    bool forward(Stage stage, ContentItem item);
+    bool push(Stage stage, ContentItem item, bool block);
+    // Records queue wait time and depth for an item just popped from stage
+    void noteDequeued(Stage stage, const Queued& queued);
+    // False if the item must go no further (its save failed)
+    bool runStage(Stage stage, ContentItem& item);
+    // True if the item's session was cancelled and it should be dropped;
+    // marks an item that reaches a detector over its budget
+    bool abandoned(Stage stage, ContentItem& item);
+    // Routes an item past stages that have nothing to do for it, including
+    // moderation the engine says the rules no longer need
+    Stage nextStage(Stage stage, ContentItem& item) const;
+};
+
+} // namespace ModAI
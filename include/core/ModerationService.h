@@ -0,0 +1,223 @@
+#pragma once
+
+#include "core/ModerationPipeline.h"
+#include "core/NearDuplicateIndex.h"
+#include "core/ReprocessJob.h"
+#include "core/WorkQueue.h"
+#include "detectors/LocalAIDetector.h"
+#include "detectors/OnnxSessionOptions.h"
+#include "scraper/PollScheduler.h"
+#include "storage/ImageStore.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class QFileSystemWatcher;
+class QTimer;
+
+namespace ModAI {
+
+class HttpClient;
+class ModerationEngine;
+class RedditScraper;
+class RuleEngine;
+class Storage;
+
+struct ServiceConfig {
+    std::string dataPath;            // empty = defaultDataPath()
+    std::string rulesPath;           // empty = <dataPath>/rules.json, seeded from config/rules.json
+    bool watchRules = true;          // reload the rules when the file changes
+    std::string modelDir;            // empty = <dataPath>/models (ai_detector.onnx, vocab.txt)
+    std::string modelVariant;        // fp32, int8 or fp16; empty = $MODAI_MODEL_VARIANT or fp32
+    std::string logFile;             // empty = <dataPath>/logs/system.log
+
+    // Empty credentials are read from the encrypted key store
+    std::string hiveApiKey;
+    std::string redditClientId;
+    std::string redditClientSecret;
+    std::string userAgent = "ModAI/1.0 by /u/yourusername";
+    // Makes the Hive and Reddit clients; empty = QtHttpClient on the shared
+    // transport. Load tests plug in recording or replay clients here.
+    std::function<std::unique_ptr<HttpClient>()> httpClientFactory;
+
+    std::vector<std::string> subreddits;
+    int scrapeIntervalSeconds = 60;
+    // Busy listings are polled more often than quiet ones, within the
+    // Reddit budget; scrapeIntervalSeconds applies until one has history
+    PollSchedulerOptions polling;
+    int onnxIntraOpThreads = 0;      // 0 = half the hardware threads
+    std::vector<std::string> onnxExecutionProviders;  // tried in order; empty = CPU
+    int onnxDeviceId = 0;
+    bool warmUpModel = true;         // dummy inference after loading
+    // Long posts are scored as overlapping windows instead of truncated
+    bool chunkLongTexts = true;
+    int chunkOverlapTokens = 128;
+    int maxChunks = 8;
+    std::string chunkAggregation = "length_weighted";  // max, mean or length_weighted
+    bool resultCache = true;
+    bool lazyDetectors = true;       // skip Hive when the rules can't use its labels
+    // Latency budget per item from entering the pipeline; detector work
+    // (HTTP retries included) still pending when it runs out is abandoned
+    // and the item decided without it. 0 = no budget
+    int itemBudgetMs = 30000;
+    // Lightly edited reposts reuse the earlier item's detector results
+    bool nearDuplicates = true;
+    NearDuplicateOptions textDuplicates{6, 50000};
+    NearDuplicateOptions imageDuplicates{4, 50000};
+    // Downloaded images persist across restarts within this budget
+    ImageStoreOptions imageStore;
+    int metricsIntervalSeconds = 10; // headless metrics dump period, 0 = off
+    PipelineConfig pipeline;
+
+    // Scraped items reach the pipeline through this queue; a shared one
+    // lets several instances moderate each other's items
+    WorkQueueConfig workQueue;
+    // With several instances, each scrapes only the subreddits it owns on
+    // a consistent-hash ring of shardInstances; empty = scrape them all
+    std::string shardInstance;
+    std::vector<std::string> shardInstances;
+
+    // Re-running detection over history (startReprocessing); an empty
+    // checkpoint path means <dataPath>/cache/reprocess.checkpoint
+    ReprocessOptions reprocess;
+
+    // The per-user application data directory the GUI has always used
+    static std::string defaultDataPath();
+
+    /**
+     * Reads a JSON config file (see config/daemon.json). Missing keys keep
+     * their defaults; returns nullopt (and logs why) if the file cannot be
+     * read or parsed.
+     */
+    static std::optional<ServiceConfig> fromJsonFile(const std::string& path);
+};
+
+/**
+ * The scrape -> moderate -> store engine without any UI: detectors,
+ * storage, rule engine, pipeline and scraper wired from a ServiceConfig.
+ * Both the GUI and the headless daemon run one of these.
+ *
+ * Scraped items are published to the work queue (fresh posts, requested
+ * comment threads and backfill at their own priorities) and a consumer
+ * thread feeds the pipeline from it; an item is acked once it is stored,
+ * and redelivered ids that are already stored are acked without
+ * reprocessing. Processed items are reported on a pipeline
+ * worker thread through setOnItemProcessed().
+ * The text model loads in the background, so construction is quick;
+ * items reaching AI detection before it is ready wait in the pipeline.
+ *
+ * The rules file is watched; an edit is applied to items evaluated from
+ * then on, and one that doesn't parse leaves the current rules in place.
+ * This needs an event loop on the constructing thread.
+ *
+ * Items carry a token of the current session with their latency budget.
+ * stopScraping(true) and stop(false) cancel the session, so in-flight
+ * HTTP calls abort and its items are dropped at their next stage.
+ */
+class ModerationService {
+public:
+    explicit ModerationService(ServiceConfig config);
+    ~ModerationService();
+
+    ModerationService(const ModerationService&) = delete;
+    ModerationService& operator=(const ModerationService&) = delete;
+
+    // Set before start()
+    void setOnItemProcessed(std::function<void(const ContentItem&)> callback);
+
+    void start();
+    // When sharded, only the subreddits this instance owns are polled
+    void startScraping(const std::vector<std::string>& subreddits, int intervalSeconds);
+    // Stops polling; with dropQueued, items still waiting or in flight in
+    // the pipeline are discarded and a new session begins
+    void stopScraping(bool dropQueued);
+    // With drain, everything already scraped is finished and stored first
+    void stop(bool drain);
+
+    /**
+     * Re-runs detection and rules over stored items through the work
+     * queue's Backfill class, so live items keep precedence. An earlier
+     * run of the same query that was interrupted resumes from its
+     * checkpoint. False if a run is still going. Call after start().
+     */
+    bool startReprocessing(ReprocessOptions options, ReprocessJob::FinishedCallback onFinished = {});
+    // The run stops submitting; its checkpoint keeps the rest
+    void cancelReprocessing();
+    // The current or last run, if any
+    std::shared_ptr<ReprocessJob> reprocessJob() const;
+
+    ModerationEngine& engine() { return *engine_; }
+    ModerationPipeline& pipeline() { return *pipeline_; }
+    RedditScraper& scraper() { return *scraper_; }
+    Storage& storage() { return *storage_; }
+    WorkQueue& workQueue() { return *workQueue_; }
+
+    const ServiceConfig& config() const { return config_; }
+    // Cancelled when the current session is; for work done on its behalf
+    CancellationToken sessionToken() const;
+    const OnnxSessionOptions& onnxOptions() const { return onnxOptions_; }
+    // The subset of subreddits this shard owns (all of them when unsharded)
+    std::vector<std::string> ownedSubreddits(const std::vector<std::string>& subreddits) const;
+    LocalAIDetector::ChunkingOptions chunkingOptions() const;
+    // The configured variant's file, or fp32 if that variant wasn't exported
+    std::string modelPath() const;
+    // False until the model has loaded
+    bool textDetectorAvailable() const;
+    // Runs once the model has loaded or failed to, on the loading thread
+    // (or right away if it already has)
+    void whenTextDetectorLoaded(std::function<void(bool available)> callback);
+
+    // The storage backend of a data directory, importing older formats
+    // once; for tools that read history without running the service
+    static std::unique_ptr<Storage> openStorage(const std::string& dataPath);
+
+private:
+    ServiceConfig config_;
+    OnnxSessionOptions onnxOptions_;
+    bool stopped_ = false;
+
+    Storage* storage_ = nullptr;            // owned by engine_
+    RuleEngine* ruleEngine_ = nullptr;      // owned by engine_
+    LocalAIDetector* textDetector_ = nullptr;  // owned by engine_
+    std::unique_ptr<ModerationEngine> engine_;
+    std::unique_ptr<ModerationPipeline> pipeline_;
+    std::unique_ptr<RedditScraper> scraper_;
+
+    mutable std::mutex sessionMutex_;
+    CancellationSource session_;
+
+    std::unique_ptr<WorkQueue> workQueue_;
+    std::thread consumer_;
+    std::function<void(const ContentItem&)> onItemProcessed_;
+    std::mutex pendingAcksMutex_;
+    // item id -> delivery tokens, oldest first; a redelivery can race the
+    // original, and each finished copy acks one of them
+    std::unordered_map<std::string, std::vector<std::string>> pendingAcks_;
+    mutable std::mutex reprocessMutex_;
+    std::shared_ptr<ReprocessJob> reprocess_;
+
+    // Declared last so they are gone before what their handlers use
+    std::string rulesPath_;
+    int64_t rulesModified_ = 0;  // msecs since epoch, and size, of the loaded file
+    int64_t rulesSize_ = -1;
+    std::unique_ptr<QFileSystemWatcher> rulesWatcher_;
+    std::unique_ptr<QTimer> rulesReloadTimer_;  // debounces bursts of change events
+    static constexpr int kRulesReloadDelayMs = 300;
+
+    void consume();
+    void cancelSession();
+    void acknowledge(const ContentItem& item);
+    void releaseImage(const ContentItem& item);
+    std::unique_ptr<HttpClient> makeHttpClient() const;
+    std::string prepareRules() const;
+    void watchRules();
+    void reloadRules(bool initial = false);
+};
+
+} // namespace ModAI
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/ContentItem.h"
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+class QImage;
+
+namespace ModAI {
+
+struct NearDuplicateOptions {
+    int maxDistance = 3;        // Hamming distance on the 64-bit hash; at most 7
+    size_t capacity = 50000;    // oldest entries are forgotten first
+};
+
+/**
+ * In-memory index of 64-bit similarity hashes (SimHash for text, dHash for
+ * images) answering "was an item within maxDistance bits seen before?".
+ * Each hash keeps the earlier item, so its detector results can be reused.
+ *
+ * Lookups use multi-index hashing: the hash is cut into maxDistance + 1
+ * bands, and by pigeonhole any hash within the distance shares at least
+ * one band exactly, so only entries in matching band buckets are compared.
+ * Safe to use from several threads.
+ */
+class NearDuplicateIndex {
+public:
+    struct Match {
+        ContentItemPtr item;  // as passed to insert()
+        int distance = 0;
+    };
+
+    explicit NearDuplicateIndex(NearDuplicateOptions options = NearDuplicateOptions());
+
+    // Closest stored hash within maxDistance
+    std::optional<Match> find(uint64_t hash) const;
+    void insert(uint64_t hash, ContentItemPtr item);
+
+    size_t size() const;
+    void clear();
+
+    /**
+     * SimHash over character 5-grams of case-folded, punctuation-free text,
+     * so copypasta with small edits lands a few bits apart. Returns nullopt
+     * for texts under minWords words, where a few edits flip too many bits.
+     */
+    static std::optional<uint64_t> textHash(const std::string& text, size_t minWords = 8);
+
+    /**
+     * Difference hash: the image scaled to 9x8 grayscale, one bit per
+     * horizontally adjacent pair. Stable under resizing and re-encoding.
+     * Returns nullopt if the image is null.
+     */
+    static std::optional<uint64_t> imageHash(const QImage& image);
+    static std::optional<uint64_t> imageHash(const std::string& path);
+
+    static int distance(uint64_t a, uint64_t b);
+
+private:
+    struct Entry {
+        uint64_t hash = 0;
+        ContentItemPtr item;
+        uint64_t sequence = 0;  // insertion number, to retire bucket slots
+    };
+
+    NearDuplicateOptions options_;
+    int bands_;
+    int bandBits_;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<Entry> entries_;  // oldest first
+    uint64_t firstSequence_ = 0; // sequence of entries_.front()
+    // Per band: band value -> sequences of entries with that value
+    std::vector<std::unordered_map<uint64_t, std::vector<uint64_t>>> buckets_;
+
+    uint64_t bandValue(uint64_t hash, int band) const;
+    void evictOldest();
+};
+
+} // namespace ModAI
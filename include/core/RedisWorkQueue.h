@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/WorkQueue.h"
+#include <atomic>
+#include <mutex>
+
+struct redisContext;
+struct redisReply;
+
+namespace ModAI {
+
+/**
+ * WorkQueue on a Redis stream read through a consumer group. Every
+ * instance publishes with XADD and reads new entries with XREADGROUP, so
+ * each entry goes to one consumer; XACK retires it. Entries left pending
+ * by a consumer that died are taken over with XAUTOCLAIM once they have
+ * been idle for claimIdle (needs Redis 6.2).
+ *
+ * publish() and ack() share one connection and may be called from any
+ * thread; receive() uses its own, from one consumer thread. A dropped
+ * connection is reopened on the next call.
+ */
+class RedisWorkQueue : public WorkQueue {
+public:
+    explicit RedisWorkQueue(WorkQueueConfig config);
+    ~RedisWorkQueue() override;
+
+    // Opens both connections and creates the group; false if Redis is unreachable
+    bool connect();
+
+    // Priority is not carried: every instance reads the one stream in order
+    bool publish(const ContentItem& item, WorkPriority priority) override;
+    std::vector<WorkDelivery> receive(size_t maxItems, std::chrono::milliseconds wait) override;
+    void ack(const std::string& token) override;
+    void close() override;
+    bool isClosed() const override { return closed_; }
+    const char* name() const override { return "redis"; }
+
+private:
+    WorkQueueConfig config_;
+    std::atomic<bool> closed_{false};
+
+    std::mutex writeMutex_;
+    redisContext* writer_ = nullptr;  // guarded by writeMutex_
+    redisContext* reader_ = nullptr;  // consumer thread only
+    std::atomic<bool> groupReady_{false};
+
+    redisContext* open();
+    bool ensureGroup(redisContext* context);
+    static void reset(redisContext*& context);
+    // Appends the entries of an [[id, [field, value, ...]], ...] reply
+    static void collectEntries(const redisReply* entries, std::vector<WorkDelivery>& out);
+};
+
+} // namespace ModAI
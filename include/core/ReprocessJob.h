@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/ContentItem.h"
+#include "storage/Storage.h"
+#include "utils/CancellationToken.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ModAI {
+
+struct ReprocessOptions {
+    ContentQuery query;               // the history to re-run; always read oldest first
+    size_t maxInFlight = 64;          // items submitted but not yet processed
+    double itemsPerSecond = 20.0;     // submission budget; 0 = unlimited
+    std::string checkpointPath;       // required; resumes from it when it matches the query
+    size_t checkpointEvery = 500;     // items completed between checkpoint writes
+    // Items not back by then were shed or dropped on the way and go again
+    std::chrono::seconds resubmitAfter{300};
+};
+
+/**
+ * Re-runs detection and rules over stored items, e.g. after a model or
+ * label mapping upgrade. Items are streamed from a storage cursor on a
+ * background thread (the latest version of each), stripped of their old
+ * results, marked ContentItem::reprocess so the engine bypasses the result
+ * cache and the near-duplicate index, and handed to submit (the service
+ * publishes them in the Backfill scheduling class, so live traffic keeps
+ * precedence, and the pipeline batches them like any other item). Results
+ * are saved as new versions of the items; an item whose save fails is not
+ * reported and goes again after resubmitAfter.
+ *
+ * Progress is checkpointed as the number of cursor records below which
+ * every item has been processed, so a restarted job skips them. This
+ * relies on the storage appending new versions after the records a scan
+ * started with, as both backends do. Completion is reported through
+ * itemProcessed(); with a shared queue, items another instance handles
+ * are not seen and are re-published after resubmitAfter.
+ */
+class ReprocessJob {
+public:
+    // Queues an item; false if it could not be queued right now
+    using Submit = std::function<bool(const ContentItem&)>;
+    // Both are called on the job thread
+    using ProgressCallback = std::function<void(size_t done, size_t total)>;
+    // error is empty on success and on cancellation
+    using FinishedCallback = std::function<void(size_t done, bool cancelled, const std::string& error)>;
+
+    ReprocessJob(Storage& storage, Submit submit, ReprocessOptions options);
+    // Cancels and waits for the thread
+    ~ReprocessJob();
+
+    ReprocessJob(const ReprocessJob&) = delete;
+    ReprocessJob& operator=(const ReprocessJob&) = delete;
+
+    void setOnProgress(ProgressCallback callback);
+    void setOnFinished(FinishedCallback callback);
+
+    void start();
+    // Items already submitted still finish; the checkpoint keeps the rest
+    void cancel();
+    void wait();
+
+    // Called for every item the pipeline finishes, from any thread
+    void itemProcessed(const ContentItem& item);
+
+    size_t total() const;
+    size_t done() const;
+    // True once run to the end, cancelled or failed
+    bool finished() const { return finished_; }
+
+private:
+    struct InFlight {
+        ContentItem item;
+        size_t position;  // of its cursor record
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    Storage& storage_;
+    Submit submit_;
+    ReprocessOptions options_;
+    ProgressCallback onProgress_;
+    FinishedCallback onFinished_;
+    CancellationSource cancellation_;
+    std::thread thread_;
+    std::atomic<bool> finished_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::unordered_map<std::string, InFlight> inFlight_;  // by item id
+    std::deque<std::pair<size_t, std::string>> order_;    // positions in flight, oldest first
+    std::unordered_set<std::string> completed_;           // in flight when they completed
+    size_t watermark_ = 0;  // every record below this is done
+    size_t total_ = 0;
+    size_t done_ = 0;
+    size_t lastCheckpoint_ = 0;
+
+    void run();
+    // Counts the records of the query's scan, up to limit, noting where
+    // each item's latest version is
+    size_t indexRecords(size_t limit, std::unordered_map<std::string, size_t>& latest);
+    bool loadCheckpoint(size_t& position, size_t& total, size_t& done);
+    void saveCheckpoint(size_t position, size_t total, size_t done, bool finished);
+    bool submitItem(ContentItem item, size_t position);
+    // Waits for room (or, with drain, for everything) while re-publishing
+    // items that stayed out too long; false once cancelled
+    bool waitForRoom(bool drain);
+    void advanceWatermarkLocked();
+};
+
+} // namespace ModAI
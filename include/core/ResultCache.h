@@ -1,26 +1,97 @@
 #pragma once
-#include <string>
-#include <map>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <list>
 #include <mutex>
 #include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 namespace ModAI {
 
+struct ResultCacheOptions {
+    size_t maxEntries = 1000000;          // index size bound (LRU eviction)
+    size_t maxMemoryEntries = 20000;      // decoded values kept in memory
+    std::chrono::seconds defaultTtl{std::chrono::hours(24 * 30)};  // 0 = never expire
+    double compactionGarbageRatio = 0.5;  // compact once dead bytes exceed this share
+    uint64_t compactionMinBytes = 4 * 1024 * 1024;
+};
+
+/**
+ * Persistent key -> JSON cache backed by a binary append-only log.
+ *
+ * Records are length-prefixed (key, CBOR value, expiry), so startup only
+ * scans record headers to rebuild a hashed index of offsets; values are
+ * decoded lazily on get() and kept in a bounded LRU. Entries past their
+ * TTL or evicted by the size bound become garbage that a background
+ * thread compacts away.
+ */
 class ResultCache {
 public:
-    explicit ResultCache(const std::string& filePath);
-    
+    explicit ResultCache(const std::string& filePath, ResultCacheOptions options = ResultCacheOptions());
+    ~ResultCache();
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
     std::optional<nlohmann::json> get(const std::string& hash);
     void put(const std::string& hash, const nlohmann::json& result);
-    
+    void put(const std::string& hash, const nlohmann::json& result, std::chrono::seconds ttl);
+
+    size_t size();
+    // Rewrites the log with live entries only. Normally runs in the background.
+    void compact();
+
 private:
+    struct IndexEntry {
+        uint64_t offset = 0;      // start of the record in the log
+        uint32_t valueLength = 0;
+        uint32_t recordLength = 0;
+        int64_t expiresAt = 0;    // unix seconds, 0 = never
+        std::list<std::string>::iterator lru;
+    };
+
+    struct CachedValue {
+        nlohmann::json value;
+        std::list<std::string>::iterator lru;
+    };
+
     std::string filePath_;
-    std::map<std::string, nlohmann::json> cache_;
+    ResultCacheOptions options_;
+
+    std::unordered_map<std::string, IndexEntry> index_;
+    std::list<std::string> indexLru_;  // most recent first
+    std::unordered_map<std::string, CachedValue> values_;
+    std::list<std::string> valueLru_;
+
+    std::ofstream writer_;
+    std::ifstream reader_;
+    uint64_t fileSize_ = 0;
+    uint64_t liveBytes_ = 0;
+
     std::mutex mutex_;
-    
-    void load();
-    void append(const std::string& hash, const nlohmann::json& result);
+
+    std::thread compactor_;
+    std::condition_variable compactCv_;
+    std::mutex compactMutex_;
+    bool compactRequested_ = false;
+    bool stopping_ = false;
+    bool compacting_ = false;
+
+    // False if the file is a legacy JSONL cache that must be imported first
+    bool load();
+    // Rewrites a legacy cache in place; called without the lock
+    bool importLegacyJsonl();
+    void openStreams();
+    void append(const std::string& hash, const std::vector<uint8_t>& value, int64_t expiresAt);
+    void eraseLocked(std::unordered_map<std::string, IndexEntry>::iterator it);
+    void rememberValueLocked(const std::string& hash, const nlohmann::json& value);
+    void maybeRequestCompactionLocked();
+    void compactorLoop();
 };
 
 }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/RuleEngine.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ModAI {
+
+class Storage;
+struct ContentQuery;
+
+struct RuleBacktestReport {
+    struct RuleStats {
+        std::string id;
+        std::string action;
+        size_t matched = 0;  // items the rule applies to and whose condition holds
+        size_t decided = 0;  // of those, items it is the first match for
+    };
+    struct Transition {
+        std::string from;  // recorded auto_action
+        std::string to;    // under the tested rules
+        size_t count = 0;
+    };
+
+    size_t items = 0;
+    size_t changed = 0;  // items whose action differs from the recorded one
+    // Items decided without Hive labels (skipped or failed); rules on them
+    // see 0 here, where live moderation might have fetched the labels
+    size_t withoutModeration = 0;
+    std::vector<RuleStats> rules;          // in rule order
+    std::vector<Transition> transitions;   // changed items only, most frequent first
+    std::vector<std::string> changedSamples;  // ids of the first few changed items
+    double seconds = 0.0;
+};
+
+/**
+ * Replays rule sets over stored history. The fields rules can read are
+ * loaded once into columns (struct of arrays); run() then evaluates a
+ * RuleSet over blocks of rows, one rule at a time, with every node of its
+ * condition a plain loop over contiguous arrays, and splits the blocks
+ * across threads. Loading is the expensive part, so one load can back
+ * any number of runs.
+ */
+class RuleBacktest {
+public:
+    static constexpr size_t kBlockRows = 1024;
+    static constexpr size_t kMaxSamples = 20;
+
+    // Loads the latest version of every item the query matches
+    size_t load(Storage& storage, const ContentQuery& query);
+    size_t size() const { return ids_.size(); }
+
+    // threads = 0 uses every hardware thread
+    RuleBacktestReport run(const RuleSet& rules, unsigned threads = 0) const;
+
+private:
+    class BlockColumns;
+    struct LabelValue {
+        uint32_t label;
+        double value;
+    };
+
+    std::vector<std::string> ids_;
+    std::vector<Symbol> recordedActions_;
+    std::vector<uint8_t> withoutModeration_;
+    std::vector<uint32_t> subreddits_;  // index into subredditNames_
+    std::vector<Symbol> subredditNames_;
+    // AIScore, Sexual, Violence, Hate, Drugs, indexed by RuleField
+    std::array<std::vector<double>, 5> fields_;
+    // Additional labels are sparse: row i's are labelValues_[labelOffsets_[i], labelOffsets_[i + 1])
+    std::vector<uint32_t> labelOffsets_{0};
+    std::vector<LabelValue> labelValues_;
+    std::unordered_map<Symbol, uint32_t> labelIndex_;
+};
+
+} // namespace ModAI
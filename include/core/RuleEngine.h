@@ -1,9 +1,12 @@
 #pragma once
 
 #include "core/ContentItem.h"
+#include "core/RuleExpression.h"
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <map>
 
 namespace ModAI {
 
@@ -12,24 +15,86 @@ struct Rule {
     std::string name;
     std::string condition;  // e.g., "ai_score > 0.8", "sexual > 0.9"
     std::string action;     // "allow", "block", "review"
-    std::string subreddit;  // empty = global
+    Symbol subreddit;       // empty = global; matched by pointer
     bool enabled = true;
+    
+    // Compiled form of `condition`, set by RuleEngine; null never matches
+    std::shared_ptr<const RuleExpression> compiled;
 };
 
-class RuleEngine {
+/**
+ * Immutable compiled rules, indexed by subreddit. Each subreddit's list
+ * holds its own rules and the global ones in file order, so first-match
+ * order is unchanged but only rules that can apply are visited. Disabled
+ * rules and ones that failed to compile are left out of the lists.
+ */
+class RuleSet {
+public:
+    explicit RuleSet(std::vector<Rule> rules = {});
+
+    RuleSet(const RuleSet&) = delete;
+    RuleSet& operator=(const RuleSet&) = delete;
+
+    const std::vector<Rule>& rules() const { return rules_; }
+    const std::vector<const Rule*>& rulesFor(const Symbol& subreddit) const { return bucketFor(subreddit).rules; }
+    // Inputs read by the rules that apply to items in `subreddit`
+    RuleInputs inputsFor(const Symbol& subreddit) const { return bucketFor(subreddit).inputs; }
+
 private:
+    struct Bucket {
+        std::vector<const Rule*> rules;
+        RuleInputs inputs = 0;
+    };
     std::vector<Rule> rules_;
+    Bucket global_;
+    std::unordered_map<Symbol, Bucket> bySubreddit_;
+
+    const Bucket& bucketFor(const Symbol& subreddit) const;
+};
+
+// Keeps the rule set it belongs to alive
+using RuleRef = std::shared_ptr<const Rule>;
+
+/**
+ * Evaluates items against the current RuleSet. Changing the rules builds
+ * a new set and swaps it in atomically; an evaluation keeps using the
+ * snapshot it started with, so reloads never wait for (or block)
+ * evaluations in flight.
+ */
+class RuleEngine {
+private:
+    std::shared_ptr<const RuleSet> rules_;  // only through std::atomic_load/store
+    std::mutex writeMutex_;                 // serializes rule set rebuilds
     
-    bool evaluateCondition(const Rule& rule, const ContentItem& item);
-    double getValue(const std::string& field, const ContentItem& item);
+    static bool compileRule(Rule& rule);
+    void publish(std::vector<Rule> rules);
 
 public:
-    void loadRulesFromJson(const std::string& jsonPath);
+    RuleEngine();
+    
+    // False (keeping the current rules) if the file can't be read or parsed
+    bool loadRulesFromJson(const std::string& jsonPath);
     void addRule(const Rule& rule);
     void clearRules();
     
-    std::string evaluate(const ContentItem& item);
-    std::vector<Rule> getMatchingRules(const ContentItem& item);
+    std::shared_ptr<const RuleSet> snapshot() const { return std::atomic_load(&rules_); }
+    
+    std::string evaluate(const ContentItem& item) const;
+    std::vector<RuleRef> getMatchingRules(const ContentItem& item) const;
+    
+    // First enabled rule that applies to the item, or null. Does not
+    // allocate, and stays valid across reloads.
+    RuleRef findFirstMatch(const ContentItem& item) const;
+    
+    // Inputs read by the enabled rules that apply to items in `subreddit`
+    RuleInputs requiredInputs(const Symbol& subreddit) const;
+    
+    /**
+     * True if the first matching rule (or the default allow) is already
+     * settled with only the `known` inputs filled in, i.e. running the
+     * remaining detectors could not change the item's decision.
+     */
+    bool decisionFixed(const ContentItem& item, RuleInputs known) const;
 };
 
 } // namespace ModAI
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "core/ContentItem.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+enum class RuleField : uint8_t {
+    AIScore,
+    Sexual,
+    Violence,
+    Hate,
+    Drugs,
+    Label  // any other name, looked up in additional_labels
+};
+
+// Detector outputs a condition can read, as a bit set
+using RuleInputs = uint32_t;
+constexpr RuleInputs kAIScoreInput = 1u << 0;     // local AI text detector
+constexpr RuleInputs kModerationInput = 1u << 1;  // Hive labels, fixed and additional
+constexpr RuleInputs kAllRuleInputs = kAIScoreInput | kModerationInput;
+
+/**
+ * Field values of a block of items laid out column-wise, for evaluating a
+ * condition over many items at once (see RuleBacktest).
+ */
+class RuleColumns {
+public:
+    virtual ~RuleColumns() = default;
+    virtual size_t rows() const = 0;
+    // rows() values of the field, or nullptr if they are all 0
+    virtual const double* column(RuleField field, const Symbol& label) const = 0;
+};
+
+/**
+ * A rule condition compiled once into a flat expression tree.
+ *
+ * Grammar (lowest to highest precedence):
+ *   expr       := and ( ("||" | "or") and )*
+ *   and        := unary ( ("&&" | "and") unary )*
+ *   unary      := ("!" | "not") unary | "(" expr ")" | comparison | "true" | "false"
+ *   comparison := field ( ">" | ">=" | "<" | "<=" | "==" | "!=" ) number
+ *
+ * Field names resolve to direct slots at compile time; evaluate() walks the
+ * node array without allocating.
+ */
+class RuleExpression {
+public:
+    RuleExpression() = default;
+
+    /**
+     * @throws std::invalid_argument with the offending position on syntax errors
+     */
+    static RuleExpression compile(const std::string& condition);
+
+    bool evaluate(const ContentItem& item) const;
+    bool empty() const { return nodes_.empty(); }
+
+    // Inputs the condition reads, known at compile time
+    RuleInputs inputs() const { return inputs_; }
+    static RuleInputs inputFor(RuleField field);
+
+    /**
+     * Three-valued evaluation before every detector has run: comparisons
+     * on fields outside `known` are Unknown, and And/Or/Not follow Kleene
+     * logic, so True/False are final whatever the missing fields turn out
+     * to be.
+     */
+    enum class Truth : uint8_t { False, True, Unknown };
+    Truth evaluatePartial(const ContentItem& item, RuleInputs known) const;
+
+    /**
+     * evaluate() for every row of the columns at once: out[i] is 1 if row i
+     * matches, else 0. Each node is a plain loop over contiguous arrays, so
+     * comparisons and And/Or/Not vectorize. scratch is reused across calls.
+     */
+    void evaluateColumns(const RuleColumns& columns, uint8_t* out, std::vector<uint8_t>& scratch) const;
+
+    // Field value as rules see it; unknown labels read as 0.
+    static double fieldValue(RuleField field, const Symbol& label, const ContentItem& item);
+
+private:
+    enum class Op : uint8_t { Greater, GreaterEqual, Less, LessEqual, Equal, NotEqual };
+    enum class Kind : uint8_t { Compare, And, Or, Not, Constant };
+
+    struct Node {
+        Kind kind = Kind::Constant;
+        RuleField field = RuleField::AIScore;
+        Op op = Op::Greater;
+        bool constant = false;
+        int32_t left = -1;
+        int32_t right = -1;
+        uint32_t label = 0;  // index into labels_ for RuleField::Label
+        double threshold = 0.0;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<Symbol> labels_;  // interned at compile time, matched by pointer
+    int32_t root_ = -1;
+    RuleInputs inputs_ = 0;
+
+    bool evaluateNode(int32_t index, const ContentItem& item) const;
+    Truth evaluatePartialNode(int32_t index, const ContentItem& item, RuleInputs known) const;
+    bool compare(const Node& node, const ContentItem& item) const;
+    static bool compareValue(Op op, double value, double threshold);
+    void evaluateColumnsNode(int32_t index, const RuleColumns& columns, uint8_t* out,
+                             uint8_t* scratch) const;
+
+    class Parser;
+};
+
+} // namespace ModAI
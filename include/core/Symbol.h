@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace ModAI {
+
+/**
+ * Interned string for low-cardinality fields (subreddit, status, provider,
+ * label names...). Equal strings share one immutable pool entry, so a
+ * Symbol is a single pointer, copies never allocate and Symbol == Symbol
+ * is a pointer compare. Interning takes a lock, so assign once and copy
+ * the Symbol rather than re-assigning from strings in hot loops.
+ *
+ * Pool entries are never freed; do not intern unbounded data such as ids
+ * or free text.
+ */
+class Symbol {
+public:
+    Symbol() noexcept
+        : text_(&emptyString()) {}
+    Symbol(const std::string& text)
+        : text_(intern(text)) {}
+    Symbol(std::string_view text)
+        : text_(intern(text)) {}
+    Symbol(const char* text)
+        : text_(intern(std::string_view(text))) {}
+
+    const std::string& str() const noexcept { return *text_; }
+    const char* c_str() const noexcept { return text_->c_str(); }
+    bool empty() const noexcept { return text_->empty(); }
+    size_t size() const noexcept { return text_->size(); }
+
+    operator const std::string&() const noexcept { return *text_; }
+
+    friend bool operator==(const Symbol& a, const Symbol& b) noexcept { return a.text_ == b.text_; }
+    friend bool operator!=(const Symbol& a, const Symbol& b) noexcept { return a.text_ != b.text_; }
+    friend bool operator==(const Symbol& a, const std::string& b) noexcept { return *a.text_ == b; }
+    friend bool operator!=(const Symbol& a, const std::string& b) noexcept { return *a.text_ != b; }
+    friend bool operator==(const std::string& a, const Symbol& b) noexcept { return a == *b.text_; }
+    friend bool operator!=(const std::string& a, const Symbol& b) noexcept { return a != *b.text_; }
+    friend bool operator==(const Symbol& a, const char* b) noexcept { return *a.text_ == b; }
+    friend bool operator!=(const Symbol& a, const char* b) noexcept { return *a.text_ != b; }
+    friend bool operator==(const char* a, const Symbol& b) noexcept { return *b.text_ == a; }
+    friend bool operator!=(const char* a, const Symbol& b) noexcept { return *b.text_ != a; }
+    // Lexicographic, so sorted containers keep string order
+    friend bool operator<(const Symbol& a, const Symbol& b) noexcept { return a.text_ != b.text_ && *a.text_ < *b.text_; }
+
+    friend std::string operator+(const std::string& a, const Symbol& b) { return a + *b.text_; }
+    friend std::string operator+(const Symbol& a, const std::string& b) { return *a.text_ + b; }
+    friend std::string operator+(const char* a, const Symbol& b) { return a + *b.text_; }
+    friend std::string operator+(const Symbol& a, const char* b) { return *a.text_ + b; }
+
+    friend std::ostream& operator<<(std::ostream& out, const Symbol& symbol) { return out << *symbol.text_; }
+
+    // Number of distinct strings interned so far
+    static size_t poolSize();
+
+private:
+    const std::string* text_;
+
+    static const std::string& emptyString();
+    static const std::string* intern(std::string_view text);
+
+    friend struct std::hash<Symbol>;
+};
+
+} // namespace ModAI
+
+template <>
+struct std::hash<ModAI::Symbol> {
+    size_t operator()(const ModAI::Symbol& symbol) const noexcept {
+        return std::hash<const void*>()(symbol.text_);
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core/ContentItem.h"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+// Scheduling classes, most urgent first
+enum class WorkPriority { Fresh = 0, Requested = 1, Backfill = 2 };
+
+struct WorkQueueConfig {
+    std::string type = "inprocess";  // "inprocess" or "redis"
+
+    // In-process scheduling (see IngestScheduler)
+    size_t capacity = 512;
+    std::array<int, 3> priorityWeights{8, 3, 1};  // items per round: fresh, requested, backfill
+    // How long a full queue holds up the publisher before shedding
+    std::chrono::milliseconds maxBlock{2000};
+    // What goes when still full: "lowest_priority" (the newest item of the
+    // least urgent class, taken from its busiest subreddit), "newest" (the
+    // incoming item) or "none" (block until there is room)
+    std::string shedPolicy = "lowest_priority";
+    // Journal the queue so a restart resumes the backlog; an empty path
+    // means <data>/queue/ingest.journal
+    bool persist = true;
+    std::string journalPath;
+    // Scraped posts older than this (caught up after downtime) are backfill
+    std::chrono::seconds backfillAge{900};
+
+    // Redis Streams: one stream shared by every instance, one consumer group
+    std::string redisHost = "127.0.0.1";
+    int redisPort = 6379;
+    std::string stream = "modai:items";
+    std::string group = "modai";
+    std::string consumer;            // empty = <hostname>:<pid>
+    size_t maxLength = 100000;       // stream trimmed to about this many entries
+    // Entries a consumer took but never acked (it crashed) are taken over
+    // by another after sitting this long
+    std::chrono::milliseconds claimIdle{60000};
+};
+
+struct WorkDelivery {
+    std::string token;  // passed back to ack(); empty = nothing to ack
+    ContentItem item;
+    // Handed out before without an ack (a consumer died or restarted), so
+    // it may already be stored
+    bool redelivered = false;
+};
+
+/**
+ * Hand-off between scrapers and moderation. The in-process queue keeps the
+ * single-box behaviour; a shared queue (Redis Streams) lets several daemons
+ * scrape and moderate for each other with at-least-once delivery: an item
+ * is redelivered, possibly to another instance, until it is acked, so
+ * consumers ack only once the item is stored and treat ids they have
+ * already stored as done.
+ */
+class WorkQueue {
+public:
+    virtual ~WorkQueue() = default;
+
+    // May hold the caller briefly as backpressure; false if the item was
+    // not queued (shed, closed or unreachable)
+    virtual bool publish(const ContentItem& item, WorkPriority priority) = 0;
+
+    /**
+     * Up to maxItems deliveries, waiting at most `wait` for the first.
+     * May return none on timeout; returns none right away once closed and
+     * (for the in-process queue) drained. Every delivery with a token must
+     * be acked once the item is stored.
+     */
+    virtual std::vector<WorkDelivery> receive(size_t maxItems, std::chrono::milliseconds wait) = 0;
+    virtual void ack(const std::string& token) = 0;
+
+    // Drops items not yet received when the queue is private to this
+    // process; a shared queue keeps them for the other instances
+    virtual void clear() {}
+    // Publishes fail afterwards and receive() stops waiting
+    virtual void close() = 0;
+    virtual bool isClosed() const = 0;
+    virtual const char* name() const = 0;
+};
+
+/**
+ * Builds the queue for config.type. Types this build lacks, or that fail
+ * to connect, fall back to the in-process scheduler with an error logged.
+ */
+std::unique_ptr<WorkQueue> makeWorkQueue(const WorkQueueConfig& config);
+
+} // namespace ModAI
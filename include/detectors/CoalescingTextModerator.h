@@ -0,0 +1,58 @@
+#pragma once
+
+#include "detectors/TextModerator.h"
+#include "utils/CancellationToken.h"
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ModAI {
+
+/**
+ * Groups concurrent analyzeText() calls into analyzeTexts() batches on a
+ * wrapped moderator. A batch is sent once it reaches maxBatchSize or
+ * maxDelay after its first text, whichever comes first; each caller
+ * blocks only until its own result is back, or until its
+ * CancellationToken::current() stops, leaving that text out of the batch
+ * if it hasn't been sent yet.
+ */
+class CoalescingTextModerator : public TextModerator {
+public:
+    CoalescingTextModerator(std::unique_ptr<TextModerator> inner,
+                            size_t maxBatchSize = 32,
+                            std::chrono::milliseconds maxDelay = std::chrono::milliseconds(50));
+    ~CoalescingTextModerator() override;
+
+    CoalescingTextModerator(const CoalescingTextModerator&) = delete;
+    CoalescingTextModerator& operator=(const CoalescingTextModerator&) = delete;
+
+    TextModerationResult analyzeText(const std::string& text) override;
+    // Already batched by the caller; forwarded as-is
+    std::vector<TextModerationResult> analyzeTexts(const std::vector<std::string>& texts) override;
+
+private:
+    struct Pending {
+        std::string text;
+        std::promise<TextModerationResult> result;
+        CancellationToken cancellation;
+    };
+
+    std::unique_ptr<TextModerator> inner_;
+    size_t maxBatchSize_;
+    std::chrono::milliseconds maxDelay_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Pending> pending_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool stopping_ = false;
+    std::thread flusher_;
+
+    void flushLoop();
+};
+
+} // namespace ModAI
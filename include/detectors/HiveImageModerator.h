@@ -12,14 +12,13 @@ class HiveImageModerator : public ImageModerator {
 private:
     std::unique_ptr<HttpClient> httpClient_;
     std::string apiKey_;
-    std::unique_ptr<RateLimiter> rateLimiter_;
+    std::shared_ptr<RateLimiter> rateLimiter_;
 
 public:
     HiveImageModerator(std::unique_ptr<HttpClient> httpClient, 
                        const std::string& apiKey);
     
-    VisualModerationResult analyzeImage(const std::vector<uint8_t>& imageBytes, 
-                                        const std::string& mime) override;
+    VisualModerationResult analyzeImage(const SharedBytes& imageBytes) override;
 };
 
 } // namespace ModAI
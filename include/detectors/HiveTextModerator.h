@@ -3,8 +3,10 @@
 #include "detectors/TextModerator.h"
 #include "network/HttpClient.h"
 #include "network/RateLimiter.h"
+#include "network/ResponseParsers.h"
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace ModAI {
 
@@ -12,13 +14,23 @@ class HiveTextModerator : public TextModerator {
 private:
     std::unique_ptr<HttpClient> httpClient_;
     std::string apiKey_;
-    std::unique_ptr<RateLimiter> rateLimiter_;
+    std::shared_ptr<RateLimiter> rateLimiter_;
 
 public:
     HiveTextModerator(std::unique_ptr<HttpClient> httpClient, 
                       const std::string& apiKey);
     
+    // The v3 endpoint takes an array of inputs; one request (and one
+    // rate-limiter token) covers up to kMaxInputsPerRequest texts.
+    static constexpr size_t kMaxInputsPerRequest = 32;
+
     TextModerationResult analyzeText(const std::string& text) override;
+    std::vector<TextModerationResult> analyzeTexts(const std::vector<std::string>& texts) override;
+
+private:
+    void analyzeChunk(const std::vector<std::string>& texts, size_t begin, size_t end,
+                      std::vector<TextModerationResult>& results);
+    static TextModerationResult parseOutput(const std::vector<HiveClass>& classes);
 };
 
 } // namespace ModAI
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "utils/SharedBytes.h"
 #include <vector>
 #include <map>
 #include <string>
@@ -9,13 +10,16 @@ namespace ModAI {
 
 struct VisualModerationResult {
     std::map<std::string, double> labels;  // label -> confidence
+    bool ok = false;  // false if the provider call failed (nothing to cache)
 };
 
 class ImageModerator {
 public:
     virtual ~ImageModerator() = default;
-    virtual VisualModerationResult analyzeImage(const std::vector<uint8_t>& imageBytes, 
-                                                const std::string& mime) = 0;
+    // imageBytes is shared, not copied; implementations must not hold on
+    // to it past the call unless they keep the SharedBytes itself. The
+    // provider identifies the format from the bytes.
+    virtual VisualModerationResult analyzeImage(const SharedBytes& imageBytes) = 0;
 };
 
 } // namespace ModAI
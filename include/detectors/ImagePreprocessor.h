@@ -0,0 +1,44 @@
+#pragma once
+
+#include "utils/SharedBytes.h"
+#include <cstdint>
+#include <string>
+
+namespace ModAI {
+
+struct ImagePreprocessOptions {
+    int maxDimension = 1024;              // longest side sent to the provider
+    int jpegQuality = 85;
+    uint64_t passthroughBytes = 256 * 1024;  // small JPEG/WebP within bounds go as-is
+};
+
+struct PreparedImage {
+    SharedBytes bytes;  // may be a mapping of the original file
+    bool ok = false;
+};
+
+/**
+ * Shrinks images to the moderation provider's working resolution before
+ * upload. Decoding is scaled where the format supports it (JPEG), the
+ * result is re-encoded as JPEG and cached next to the original as
+ * "<original>.<size>q<quality>.jpg", so each file is processed once.
+ */
+class ImagePreprocessor {
+public:
+    explicit ImagePreprocessor(ImagePreprocessOptions options = ImagePreprocessOptions());
+
+    // Falls back to the original bytes if decoding fails
+    PreparedImage prepare(const std::string& imagePath) const;
+
+    // Mime type from the file's magic bytes, "application/octet-stream" if unknown
+    static std::string sniffMime(const char* data, size_t size);
+
+    const ImagePreprocessOptions& options() const { return options_; }
+
+private:
+    ImagePreprocessOptions options_;
+
+    std::string cachePathFor(const std::string& imagePath) const;
+};
+
+} // namespace ModAI
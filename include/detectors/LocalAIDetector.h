@@ -1,8 +1,15 @@
 #pragma once
 
 #include "detectors/TextDetector.h"
+#include "detectors/OnnxSessionOptions.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace ModAI {
@@ -13,22 +20,80 @@ namespace ModAI {
  */
 class LocalAIDetector : public TextDetector {
 public:
+    /**
+     * Texts longer than maxLength tokens are scored as overlapping windows
+     * (all in the same batched run as the rest of the batch) and the window
+     * scores combined. Disabled, they are truncated to the first window.
+     */
+    struct ChunkingOptions {
+        enum class Aggregation {
+            Max,            // the most AI-like window decides
+            Mean,
+            LengthWeighted  // each window weighted by the tokens it adds
+        };
+        
+        bool enabled = false;
+        int overlapTokens = 128;  // shared by consecutive windows
+        int maxChunks = 8;        // longer texts are cut after this many windows
+        Aggregation aggregation = Aggregation::LengthWeighted;
+    };
+    
+    enum class LoadMode {
+        Blocking,    // the constructor returns with the model loaded (or failed)
+        Background   // the constructor returns at once; a worker thread loads
+    };
+    
     /**
      * @param modelPath Path to the ONNX model file
      * @param tokenizerPath Path to the tokenizer directory
      * @param maxLength Maximum sequence length (default: 768)
      * @param threshold Detection threshold (default: 0.5)
+     * @param sessionOptions ONNX Runtime threading, used if this model is
+     *        not already loaded by another detector
+     * @param loadMode With Background, analyze() calls made while loading
+     *        wait for the model instead of returning "unknown"
      */
     LocalAIDetector(const std::string& modelPath,
                     const std::string& tokenizerPath,
                     int maxLength = 768,
-                    float threshold = 0.5f);
+                    float threshold = 0.5f,
+                    const OnnxSessionOptions& sessionOptions = OnnxSessionOptions(),
+                    LoadMode loadMode = LoadMode::Blocking);
     
     ~LocalAIDetector() override;
     
+    /**
+     * Model file for a precision variant written by export_model_to_onnx.py:
+     * "fp32" (or empty) is ai_detector.onnx, others ai_detector.<variant>.onnx
+     */
+    static std::string variantModelPath(const std::string& modelDir, const std::string& variant);
+    
     TextDetectResult analyze(const std::string& text) override;
     
+    /**
+     * Tokenizes all texts and scores them in a single {N, L} session run.
+     * Texts too short to classify are answered without touching the model.
+     */
+    std::vector<TextDetectResult> analyzeBatch(const std::vector<std::string>& texts) override;
+    
+    // False while loading
     bool isAvailable() const;
+    bool isLoading() const;
+    // Blocks until loading has finished; returns isAvailable()
+    bool waitUntilLoaded() const;
+    // Runs once loading has finished, on the loading thread, or right away
+    // on the caller's thread if it already has
+    void whenLoaded(std::function<void(bool available)> callback);
+    
+    /**
+     * Sequence lengths inputs are padded to; each batch is grouped by the
+     * smallest bucket that fits. Buckets above maxLength are dropped and
+     * maxLength is always the last bucket.
+     */
+    void setLengthBuckets(std::vector<int> buckets);
+    
+    // Set before the detector is shared with other threads
+    void setChunking(const ChunkingOptions& options);
 
 private:
     struct Impl;
@@ -38,16 +103,37 @@ private:
     std::string tokenizerPath_;
     int maxLength_;
     float threshold_;
-    bool available_;
+    std::vector<int> lengthBuckets_;
+    ChunkingOptions chunking_;
+    
+    std::atomic<bool> available_{false};
+    mutable std::mutex loadMutex_;
+    mutable std::condition_variable loadCv_;
+    bool loading_ = true;  // guarded by loadMutex_
+    std::vector<std::function<void(bool)>> loadCallbacks_;
+    std::thread loader_;
+    
+    void load(const OnnxSessionOptions& sessionOptions, const std::vector<int>& warmUpLengths);
+    void finishLoading(bool available);
+    void warmUp(const std::vector<int>& lengths);
     
-    // Tokenization
+    // Tokenization: ids at their real length, unpadded
     struct TokenizedInput {
         std::vector<int64_t> input_ids;
-        std::vector<int64_t> attention_mask;
     };
     
-    TokenizedInput tokenize(const std::string& text);
-    float runInference(const TokenizedInput& input);
+    TokenizedInput tokenize(const std::string& text, int maxLength);
+    // [CLS] window [SEP] inputs covering the text's tokens, at most maxChunks
+    std::vector<TokenizedInput> splitWindows(const TokenizedInput& input) const;
+    float aggregateChunks(const std::vector<float>& scores, const std::vector<size_t>& weights) const;
+    // Probabilities in input order; nullopt for rows whose run failed
+    std::optional<float> runInference(const TokenizedInput& input);
+    std::vector<std::optional<float>> runBatchInference(const std::vector<TokenizedInput>& inputs);
+    std::vector<std::optional<float>> runPaddedBatch(const std::vector<TokenizedInput>& inputs,
+                                                     const std::vector<size_t>& members,
+                                                     int seqLength);
+    int bucketLength(size_t tokenCount) const;
+    TextDetectResult makeResult(float probability) const;
 };
 
 } // namespace ModAI
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+// Kept separate from OnnxSessionRegistry.h so detector headers don't pull
+// in onnxruntime_cxx_api.h.
+struct OnnxSessionOptions {
+    int intraOpThreads = 1;   // 0 lets ONNX Runtime pick
+    int interOpThreads = 1;   // only used with parallelExecution
+    bool parallelExecution = false;
+    // After loading, score one dummy input per length bucket so kernel
+    // selection and arena growth happen before the first real item
+    bool warmUp = false;
+    // Tried in order: "cuda", "tensorrt", "openvino", "coreml", "directml".
+    // Ones this ONNX Runtime build lacks, or that fail to initialise, are
+    // skipped; CPU always remains as the fallback.
+    std::vector<std::string> executionProviders;
+    int deviceId = 0;  // GPU index for CUDA/TensorRT/DirectML
+};
+
+} // namespace ModAI
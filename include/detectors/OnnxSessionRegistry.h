@@ -0,0 +1,79 @@
+#pragma once
+
+#include "detectors/OnnxSessionOptions.h"
+#include "detectors/Tokenizer.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef ONNXRUNTIME_FOUND
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace ModAI {
+
+/**
+ * A loaded model: one session plus its vocab. Session::Run is thread-safe,
+ * so every detector using the same model file shares one of these.
+ */
+struct OnnxModel {
+    std::string modelPath;
+    std::shared_ptr<const Tokenizer> tokenizer;
+    mutable std::once_flag warmedUp;  // only the first detector warms a shared session
+    std::string executionProvider = "cpu";  // the first one that attached
+#ifdef ONNXRUNTIME_FOUND
+    std::shared_ptr<Ort::Env> env;  // must outlive the session
+    std::unique_ptr<Ort::Session> session;
+    // Read from the model once, so runs don't query the session
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+    std::string probabilityOutput;  // "probability" if exported, else the first output
+    size_t outputRank = 1;          // of probabilityOutput: {N} or {N, 1}
+#endif
+};
+
+/**
+ * Process-wide cache of loaded models keyed by model path, vocab path and
+ * the session options that shape the session (threads, execution mode,
+ * providers, device), so callers asking for different options get their
+ * own session. Entries are held weakly, so a model is unloaded once the
+ * last detector using it is destroyed.
+ */
+class OnnxSessionRegistry {
+public:
+    static OnnxSessionRegistry& instance();
+
+    /**
+     * @param modelPath Path to the ONNX model file
+     * @param vocabPath Path to vocab.txt for the model's tokenizer
+     * @param options Session options; part of the cache key
+     * @throws std::exception if the model cannot be loaded
+     */
+    std::shared_ptr<const OnnxModel> acquire(const std::string& modelPath,
+                                             const std::string& vocabPath,
+                                             const OnnxSessionOptions& options);
+
+    size_t loadedModelCount();
+
+private:
+    OnnxSessionRegistry() = default;
+
+    std::mutex mutex_;
+    std::map<std::string, std::weak_ptr<const OnnxModel>> models_;  // by cacheKey()
+#ifdef ONNXRUNTIME_FOUND
+    std::shared_ptr<Ort::Env> env_;
+#endif
+
+    std::shared_ptr<const OnnxModel> load(const std::string& modelPath,
+                                          const std::string& vocabPath,
+                                          const OnnxSessionOptions& options);
+#ifdef ONNXRUNTIME_FOUND
+    // Appends the first requested provider that initialises; returns its name
+    static std::string appendExecutionProvider(Ort::SessionOptions& sessionOptions,
+                                               const OnnxSessionOptions& options);
+#endif
+};
+
+} // namespace ModAI
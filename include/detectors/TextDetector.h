@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace ModAI {
 
@@ -8,12 +9,25 @@ struct TextDetectResult {
     double ai_score = 0.0;
     std::string label;  // "ai_generated" or "human"
     double confidence = 0.0;
+    // Per-window scores when a long text was scored in chunks, else empty
+    std::vector<double> chunk_scores;
 };
 
 class TextDetector {
 public:
     virtual ~TextDetector() = default;
     virtual TextDetectResult analyze(const std::string& text) = 0;
+    
+    // Results are returned in input order. Detectors that can amortise work
+    // across inputs (e.g. one batched ONNX run) should override this.
+    virtual std::vector<TextDetectResult> analyzeBatch(const std::vector<std::string>& texts) {
+        std::vector<TextDetectResult> results;
+        results.reserve(texts.size());
+        for (const auto& text : texts) {
+            results.push_back(analyze(text));
+        }
+        return results;
+    }
 };
 
 } // namespace ModAI
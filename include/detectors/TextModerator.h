@@ -8,12 +8,26 @@ namespace ModAI {
 
 struct TextModerationResult {
     std::vector<std::pair<std::string, double>> labels;  // label, confidence pairs
+    bool ok = false;  // false if the provider call failed (nothing to cache)
 };
 
 class TextModerator {
 public:
     virtual ~TextModerator() = default;
     virtual TextModerationResult analyzeText(const std::string& text) = 0;
+
+    /**
+     * Moderate several texts at once; results are in input order. The
+     * default makes one analyzeText() call per input.
+     */
+    virtual std::vector<TextModerationResult> analyzeTexts(const std::vector<std::string>& texts) {
+        std::vector<TextModerationResult> results;
+        results.reserve(texts.size());
+        for (const auto& text : texts) {
+            results.push_back(analyzeText(text));
+        }
+        return results;
+    }
 };
 
 } // namespace ModAI
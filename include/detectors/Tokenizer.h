@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ModAI {
+
+/**
+ * SentencePiece-style tokenizer for the DeBERTa detector vocab.
+ *
+ * The vocab (vocab.txt, one piece per line) is loaded once into a flat
+ * byte trie: nodes own a contiguous, sorted run of edges, so lookups are a
+ * binary search per byte and never build temporary strings. Words are
+ * segmented by greedy longest match against the trie ("▁" marks a word
+ * start), so out-of-vocabulary words fall back to subword pieces and only
+ * bytes with no piece at all become [UNK].
+ *
+ * Immutable after loadVocab(); encode() is safe to call concurrently.
+ */
+class Tokenizer {
+public:
+    Tokenizer() = default;
+
+    /**
+     * @param vocabPath Path to vocab.txt. Ids are assigned in file order.
+     * @return false if the file could not be read or was empty
+     */
+    bool loadVocab(const std::string& vocabPath);
+
+    bool isLoaded() const { return vocabSize_ > 0; }
+    size_t vocabSize() const { return vocabSize_; }
+
+    /**
+     * Encodes [CLS] text [SEP], truncated to maxLength ids. No padding is
+     * added. Appends to `ids` after clearing it, so callers can reuse the
+     * buffer's capacity across calls.
+     */
+    void encode(std::string_view text, int maxLength, std::vector<int64_t>& ids) const;
+    std::vector<int64_t> encode(std::string_view text, int maxLength) const;
+
+    // Exact vocab lookup; returns unkId() for unknown pieces.
+    int64_t tokenId(std::string_view piece) const;
+
+    int64_t clsId() const { return clsId_; }
+    int64_t sepId() const { return sepId_; }
+    int64_t padId() const { return padId_; }
+    int64_t unkId() const { return unkId_; }
+
+private:
+    static constexpr int32_t kNoToken = -1;
+
+    struct Node {
+        uint32_t firstEdge = 0;
+        uint32_t edgeCount = 0;
+        int32_t tokenId = kNoToken;
+    };
+
+    // Edges of node n are edgeBytes_/edgeTargets_[firstEdge, firstEdge + edgeCount),
+    // sorted by byte.
+    std::vector<Node> nodes_;
+    std::vector<uint8_t> edgeBytes_;
+    std::vector<uint32_t> edgeTargets_;
+    uint32_t wordStartNode_ = 0;  // node reached by "▁" from the root
+    size_t vocabSize_ = 0;
+
+    int64_t clsId_ = 1;
+    int64_t sepId_ = 2;
+    int64_t padId_ = 0;
+    int64_t unkId_ = 1;
+
+    static constexpr uint32_t kRoot = 0;
+    static constexpr uint32_t kNoNode = UINT32_MAX;
+
+    uint32_t child(uint32_t node, uint8_t byte) const;
+    uint32_t walk(uint32_t node, std::string_view bytes) const;
+
+    // Longest vocab match of a prefix of `piece`, starting at `start`.
+    // Returns the matched byte length, 0 if none.
+    size_t longestMatch(uint32_t start, std::string_view piece, int32_t& tokenId) const;
+
+    void encodeWord(std::string_view word, size_t limit, std::vector<int64_t>& ids) const;
+    void encodePiece(std::string_view piece, bool wordStart, size_t limit,
+                     std::vector<int64_t>& ids) const;
+};
+
+} // namespace ModAI
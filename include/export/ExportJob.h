@@ -0,0 +1,60 @@
+#pragma once
+
+#include "export/Exporter.h"
+#include "storage/Storage.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace ModAI {
+
+struct ExportJobOptions {
+    size_t pageSize = 500;  // items pulled from the cursor per write
+};
+
+/**
+ * Streams a cursor's results into an export file on a background thread.
+ * Output goes to "<path>.part" and is renamed into place on success, so a
+ * failed or cancelled export never leaves a truncated file behind.
+ */
+class ExportJob {
+public:
+    // Both are called on the job thread
+    using ProgressCallback = std::function<void(size_t itemsWritten)>;
+    // error is empty on success and on cancellation
+    using FinishedCallback = std::function<void(size_t itemsWritten, bool cancelled, const std::string& error)>;
+
+    ExportJob(std::unique_ptr<ContentCursor> cursor, ExportFormat format, std::string filepath,
+              ExportJobOptions options = ExportJobOptions());
+    // Cancels and waits for the thread
+    ~ExportJob();
+
+    ExportJob(const ExportJob&) = delete;
+    ExportJob& operator=(const ExportJob&) = delete;
+
+    void setOnProgress(ProgressCallback callback);
+    void setOnFinished(FinishedCallback callback);
+
+    void start();
+    // Takes effect between pages
+    void cancel();
+    void wait();
+
+    const std::string& filepath() const { return filepath_; }
+
+private:
+    std::unique_ptr<ContentCursor> cursor_;
+    ExportFormat format_;
+    std::string filepath_;
+    ExportJobOptions options_;
+    ProgressCallback onProgress_;
+    FinishedCallback onFinished_;
+    std::atomic<bool> cancelled_{false};
+    std::thread thread_;
+
+    void run();
+};
+
+} // namespace ModAI
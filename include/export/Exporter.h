@@ -1,11 +1,43 @@
 #pragma once
 
 #include "core/ContentItem.h"
+#include <memory>
 #include <vector>
 #include <string>
 
 namespace ModAI {
 
+enum class ExportFormat {
+    Csv,
+    Json,   // one array, importable by the dashboard
+    Jsonl,  // one item per line (NDJSON)
+    Pdf
+};
+
+// By extension: .csv, .jsonl/.ndjson, .pdf; anything else is JSON
+ExportFormat exportFormatForPath(const std::string& filepath);
+
+/**
+ * Incremental writer for one export file. Items are written a page at a
+ * time, so memory stays bounded by the page rather than the export.
+ */
+class ExportWriter {
+public:
+    virtual ~ExportWriter() = default;
+
+    /**
+     * @throws std::runtime_error on write failure
+     */
+    virtual void write(const std::vector<ContentItem>& items) = 0;
+    // Writes trailers and closes the file; throws on failure
+    virtual void finish() = 0;
+
+    /**
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    static std::unique_ptr<ExportWriter> create(ExportFormat format, const std::string& filepath);
+};
+
 class Exporter {
 public:
     static void exportToPDF(const std::vector<ContentItem>& items, const std::string& filepath);
@@ -14,4 +46,3 @@ public:
 };
 
 } // namespace ModAI
-
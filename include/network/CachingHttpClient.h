@@ -0,0 +1,60 @@
+#pragma once
+
+#include "network/HttpCache.h"
+#include "network/HttpClient.h"
+#include <memory>
+#include <optional>
+
+namespace ModAI {
+
+/**
+ * HttpClient decorator that caches GET responses in an HttpCache. While
+ * Cache-Control's max-age lasts, a GET is answered from the cache without
+ * a request; after that it is revalidated with If-None-Match /
+ * If-Modified-Since, and a 304 is answered with the cached body.
+ * Either way the response has statusCode 200 and notModified set, so
+ * callers that processed that body before can skip parsing it.
+ *
+ * no-store responses are never kept and no-cache ones are revalidated on
+ * every request. This is a private cache: the key is the URL alone, so
+ * one instance should serve one set of credentials. POSTs, downloads and
+ * streamed requests pass straight through.
+ */
+class CachingHttpClient : public HttpClient {
+public:
+    CachingHttpClient(std::unique_ptr<HttpClient> inner, std::shared_ptr<HttpCache> cache);
+
+    HttpResponse post(const HttpRequest& req) override;
+    HttpResponse get(const std::string& url, const std::map<std::string, std::string>& headers = {}) override;
+
+    using HttpClient::postAsync;
+    using HttpClient::getAsync;
+    HttpRequestHandle postAsync(const HttpRequest& req, HttpCallback callback) override;
+    HttpRequestHandle getAsync(const std::string& url,
+                               const std::map<std::string, std::string>& headers,
+                               HttpCallback callback) override;
+    HttpRequestHandle downloadAsync(const std::string& url,
+                                    const std::map<std::string, std::string>& headers,
+                                    const std::string& filePath,
+                                    uint64_t maxBytes,
+                                    HttpCallback callback) override;
+    HttpRequestHandle streamAsync(const HttpRequest& req,
+                                  HttpChunkCallback onChunk,
+                                  HttpCallback callback) override;
+
+    HttpClient& inner() { return *inner_; }
+
+private:
+    std::unique_ptr<HttpClient> inner_;
+    std::shared_ptr<HttpCache> cache_;
+
+    // The cached response if it is still fresh; otherwise adds the
+    // validators of any stale entry to headers
+    std::optional<HttpResponse> prepare(const std::string& url,
+                                        std::map<std::string, std::string>& headers,
+                                        std::optional<HttpCacheEntry>& cached);
+    HttpResponse complete(const std::string& url, const std::optional<HttpCacheEntry>& cached,
+                          HttpResponse response);
+};
+
+} // namespace ModAI
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace ModAI {
+
+struct HttpCacheEntry {
+    std::string body;
+    std::string etag;          // validators sent back when revalidating
+    std::string lastModified;
+    int64_t freshUntil = 0;    // unix seconds; served without a request until then
+};
+
+/**
+ * Bounded store of GET responses keyed by URL: a least recently used
+ * in-memory layer in front of a directory of files named by the SHA-256 of
+ * the key, so validators survive restarts. Both layers evict the least
+ * recently used entries once over their byte budget. An empty directory
+ * keeps everything in memory. Thread-safe.
+ */
+class HttpCache {
+public:
+    explicit HttpCache(const std::string& directory,
+                       size_t memoryBytes = 8 * 1024 * 1024,
+                       size_t diskBytes = 64 * 1024 * 1024);
+
+    HttpCache(const HttpCache&) = delete;
+    HttpCache& operator=(const HttpCache&) = delete;
+
+    std::optional<HttpCacheEntry> find(const std::string& key);
+    void store(const std::string& key, const HttpCacheEntry& entry);
+    // After a 304 only the freshness changes; the stored file keeps its
+    // old one, which just means one extra revalidation after a restart
+    void refresh(const std::string& key, int64_t freshUntil);
+    void remove(const std::string& key);
+
+private:
+    struct MemoryEntry {
+        HttpCacheEntry entry;
+        std::list<std::string>::iterator position;
+    };
+    struct DiskEntry {
+        uint64_t size = 0;
+        std::list<std::string>::iterator position;
+    };
+
+    std::string directory_;
+    size_t memoryBytes_;
+    size_t diskBytes_;
+    std::mutex mutex_;
+
+    std::list<std::string> memoryOrder_;  // keys, most recent first
+    std::unordered_map<std::string, MemoryEntry> memory_;
+    size_t memoryUsed_ = 0;
+
+    std::list<std::string> diskOrder_;  // file names, most recent first
+    std::unordered_map<std::string, DiskEntry> disk_;
+    uint64_t diskUsed_ = 0;
+
+    static size_t sizeOf(const std::string& key, const HttpCacheEntry& entry);
+    static std::string fileNameFor(const std::string& key);
+
+    void loadIndex();
+    void putMemoryLocked(const std::string& key, const HttpCacheEntry& entry);
+    void removeMemoryLocked(const std::string& key);
+    std::optional<HttpCacheEntry> readFileLocked(const std::string& key);
+    void writeFileLocked(const std::string& key, const HttpCacheEntry& entry);
+    void removeFileLocked(const std::string& name);
+};
+
+} // namespace ModAI
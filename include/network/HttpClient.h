@@ -1,9 +1,15 @@
 #pragma once
 
+#include "utils/CancellationToken.h"
+#include "utils/SharedBytes.h"
 #include <string>
 #include <map>
 #include <vector>
 #include <cstdint>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
 
 namespace ModAI {
 
@@ -13,6 +19,11 @@ struct HttpResponse {
     std::map<std::string, std::string> headers;
     bool success = false;
     std::string errorMessage;
+    bool cancelled = false;
+    bool deadlineExceeded = false;  // the request's deadline ran out first
+    // The body is the one a CachingHttpClient returned for this URL before
+    // (fresh, or revalidated by a 304); callers that processed it can skip it
+    bool notModified = false;
 };
 
 struct HttpRequest {
@@ -20,8 +31,38 @@ struct HttpRequest {
     std::string method;  // "GET", "POST", etc.
     std::map<std::string, std::string> headers;
     std::string body;
-    std::vector<uint8_t> binaryData;  // For multipart/form-data
+    // Raw payload, shared rather than copied into the request; used for
+    // multipart/form-data, or as the body when body is empty
+    SharedBytes binaryData;
     std::string contentType;
+    // Cancelling aborts the request; retries, backoff and per-attempt
+    // timeouts stay within the deadline. Clients on the shared transport
+    // use the caller's CancellationToken::current() when this can't stop.
+    CancellationToken cancellation;
+};
+
+using HttpCallback = std::function<void(HttpResponse)>;
+using HttpChunkCallback = std::function<void(const char* data, size_t size)>;
+
+/**
+ * Handle to an in-flight asynchronous request. Cancelling completes the
+ * request with HttpResponse::cancelled set; the callback still runs once.
+ */
+class HttpRequestHandle {
+public:
+    HttpRequestHandle() = default;
+    explicit HttpRequestHandle(std::function<void()> cancel)
+        : cancel_(std::make_shared<std::function<void()>>(std::move(cancel))) {}
+
+    void cancel() const {
+        if (cancel_ && *cancel_) {
+            (*cancel_)();
+        }
+    }
+    bool valid() const { return cancel_ != nullptr; }
+
+private:
+    std::shared_ptr<std::function<void()>> cancel_;
 };
 
 class HttpClient {
@@ -30,7 +71,93 @@ public:
     
     virtual HttpResponse post(const HttpRequest& req) = 0;
     virtual HttpResponse get(const std::string& url, const std::map<std::string, std::string>& headers = {}) = 0;
+
+    /**
+     * Non-blocking variants. The callback runs exactly once, on the client's
+     * I/O thread for implementations that have one. The defaults complete
+     * synchronously via post()/get() for clients without a reactor.
+     */
+    virtual HttpRequestHandle postAsync(const HttpRequest& req, HttpCallback callback) {
+        callback(post(req));
+        return HttpRequestHandle();
+    }
+    virtual HttpRequestHandle getAsync(const std::string& url,
+                                       const std::map<std::string, std::string>& headers,
+                                       HttpCallback callback) {
+        callback(get(url, headers));
+        return HttpRequestHandle();
+    }
+
+    /**
+     * GET straight into a file instead of HttpResponse::body. Fails, leaving
+     * no file behind, if the body exceeds maxBytes (0 = no limit). The
+     * default buffers through get(); streaming clients override it.
+     */
+    virtual HttpRequestHandle downloadAsync(const std::string& url,
+                                            const std::map<std::string, std::string>& headers,
+                                            const std::string& filePath,
+                                            uint64_t maxBytes,
+                                            HttpCallback callback) {
+        HttpResponse response = get(url, headers);
+        if (response.success && maxBytes > 0 && response.body.size() > maxBytes) {
+            response.success = false;
+            response.errorMessage = "Response exceeds " + std::to_string(maxBytes) + " bytes";
+        }
+        if (response.success) {
+            std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+            out.write(response.body.data(), static_cast<std::streamsize>(response.body.size()));
+            if (!out) {
+                response.success = false;
+                response.errorMessage = "Failed to write " + filePath;
+            }
+        }
+        response.body.clear();
+        callback(std::move(response));
+        return HttpRequestHandle();
+    }
+
+    /**
+     * Like getAsync/postAsync (per req.method), but the body is handed to
+     * onChunk piece by piece as it arrives instead of being collected in
+     * HttpResponse::body. onChunk may run on another thread. The default
+     * delivers the whole buffered body as one chunk.
+     */
+    virtual HttpRequestHandle streamAsync(const HttpRequest& req,
+                                          HttpChunkCallback onChunk,
+                                          HttpCallback callback) {
+        HttpResponse response = req.method == "GET" ? get(req.url, req.headers) : post(req);
+        if (!response.body.empty()) {
+            onChunk(response.body.data(), response.body.size());
+            response.body.clear();
+        }
+        callback(std::move(response));
+        return HttpRequestHandle();
+    }
+
+    HttpResponse download(const std::string& url,
+                          const std::map<std::string, std::string>& headers,
+                          const std::string& filePath,
+                          uint64_t maxBytes = 0) {
+        auto promise = std::make_shared<std::promise<HttpResponse>>();
+        auto future = promise->get_future();
+        downloadAsync(url, headers, filePath, maxBytes,
+                      [promise](HttpResponse response) { promise->set_value(std::move(response)); });
+        return future.get();
+    }
+
+    std::future<HttpResponse> postAsync(const HttpRequest& req) {
+        auto promise = std::make_shared<std::promise<HttpResponse>>();
+        auto future = promise->get_future();
+        postAsync(req, [promise](HttpResponse response) { promise->set_value(std::move(response)); });
+        return future;
+    }
+    std::future<HttpResponse> getAsync(const std::string& url,
+                                       const std::map<std::string, std::string>& headers = {}) {
+        auto promise = std::make_shared<std::promise<HttpResponse>>();
+        auto future = promise->get_future();
+        getAsync(url, headers, [promise](HttpResponse response) { promise->set_value(std::move(response)); });
+        return future;
+    }
 };
 
 } // namespace ModAI
-
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ModAI {
+
+// One request and the response it got, as RecordingHttpClient saw it
+struct HttpExchange {
+    std::string method;               // GET, POST, or DOWNLOAD for downloadAsync
+    std::string url;
+    size_t requestBytes = 0;          // request headers and bodies are not kept
+    int statusCode = 0;
+    bool success = false;
+    std::string errorMessage;
+    std::map<std::string, std::string> headers;  // of the response
+    std::string body;
+    std::chrono::milliseconds latency{0};
+    bool cancelled = false;
+};
+
+/**
+ * Request/response pairs in a JSON lines file, one exchange per line. Text
+ * bodies are stored as they are, anything else as base64, so recordings
+ * can be read and edited by hand.
+ *
+ * Lookup for replay is by method and URL, falling back to the same path
+ * without its query (listing cursors, cache busters); several exchanges
+ * for one key are handed out in turn. Fill it before replaying; next()
+ * may then be called from any thread.
+ */
+class HttpRecording {
+public:
+    HttpRecording() = default;
+    HttpRecording(const HttpRecording&) = delete;
+    HttpRecording& operator=(const HttpRecording&) = delete;
+
+    // Lines that don't parse are skipped; false if the file can't be read
+    bool load(const std::string& path);
+    void add(HttpExchange exchange);
+
+    // Nullptr if nothing was recorded for the request
+    const HttpExchange* next(const std::string& method, const std::string& url);
+    bool contains(const std::string& method, const std::string& url);
+    const std::vector<HttpExchange>& exchanges() const { return exchanges_; }
+    size_t size() const { return exchanges_.size(); }
+
+    static std::string toJsonLine(const HttpExchange& exchange);
+    static bool fromJsonLine(const std::string& line, HttpExchange& exchange);
+    // scheme://host/path of a URL
+    static std::string withoutQuery(const std::string& url);
+
+private:
+    struct Cursor {
+        std::vector<size_t> indices;
+        size_t next = 0;
+    };
+
+    std::vector<HttpExchange> exchanges_;
+    std::unordered_map<std::string, Cursor> byUrl_;
+    std::unordered_map<std::string, Cursor> byPath_;
+    std::mutex mutex_;
+};
+
+/**
+ * Appends exchanges to a recording file. Writes are serialized and
+ * flushed per line, so a recording cut short by a crash keeps everything
+ * before it. Thread-safe.
+ */
+class HttpRecordingWriter {
+public:
+    explicit HttpRecordingWriter(const std::string& path);
+
+    bool isOpen() const { return out_.is_open(); }
+    void write(const HttpExchange& exchange);
+
+private:
+    std::ofstream out_;
+    std::mutex mutex_;
+};
+
+} // namespace ModAI
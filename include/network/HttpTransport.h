@@ -0,0 +1,112 @@
+#pragma once
+
+#include "network/HttpClient.h"
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace ModAI {
+
+struct HttpCallOptions {
+    int timeoutMs = 60000;
+    int maxRetries = 3;
+    int retryDelayMs = 1000;
+    // When set, the body is streamed into this file (via a ".part" file
+    // renamed on success) and HttpResponse::body stays empty.
+    std::string downloadPath;
+    uint64_t maxBodyBytes = 0;  // 0 = unlimited; larger bodies fail the call
+    // When set, body chunks are handed to this (on the transport thread) as
+    // they arrive and HttpResponse::body stays empty
+    std::function<void(const char*, size_t)> onChunk;
+};
+
+struct HttpTransportStats {
+    uint64_t requests = 0;           // attempts sent, including retries
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    uint64_t tlsHandshakes = 0;      // new encrypted connections
+    uint64_t reusedConnections = 0;  // https attempts served without a handshake
+    uint64_t http2Responses = 0;
+    uint64_t queuedForPool = 0;      // attempts that waited for a per-host slot
+};
+
+/**
+ * Process-wide HTTP transport: one QNetworkAccessManager on a dedicated
+ * I/O thread, so every API client shares its per-host connection pools and
+ * TLS sessions. HTTP/2 is negotiated where the server supports it. Requests
+ * beyond the per-host in-flight limit wait in a FIFO instead of opening
+ * more connections. Timeouts and retry backoff run as timers on the I/O
+ * thread; callbacks are invoked there too. A request's CancellationToken
+ * aborts it wherever it is, and its deadline bounds the whole call:
+ * backoff that would overrun it is skipped and the last failure returned.
+ */
+class HttpTransport : public QObject {
+    Q_OBJECT
+
+public:
+    static HttpTransport& instance();
+    ~HttpTransport() override;
+
+    HttpRequestHandle submit(const HttpRequest& req, const HttpCallOptions& options, HttpCallback callback);
+
+    // Opens connections ahead of the first request (scheme://host[:port] is enough)
+    void prewarm(const std::vector<std::string>& urls);
+
+    void setMaxInFlightPerHost(int limit);
+    void setHttp2Enabled(bool enabled) { http2Enabled_ = enabled; }
+
+    HttpTransportStats stats() const;
+    bool isTransportThread() const { return QThread::currentThread() == &thread_; }
+
+    // Stops the I/O thread; later submissions fail immediately
+    void shutdown();
+
+private:
+    HttpTransport();
+
+    struct Call;
+    struct HostState {
+        int inFlight = 0;
+        std::deque<std::shared_ptr<Call>> waiting;
+    };
+
+    QThread thread_;
+    QNetworkAccessManager* manager_ = nullptr;  // created and used on thread_ only
+    std::map<std::string, HostState> hosts_;    // thread_ only
+    std::set<std::shared_ptr<Call>> unfinished_;  // thread_ only; completed on shutdown
+
+    std::atomic<int> maxInFlightPerHost_{6};
+    std::atomic<bool> http2Enabled_{true};
+    std::atomic<bool> stopped_{false};
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> tlsHandshakes_{0};
+    std::atomic<uint64_t> httpsAttempts_{0};
+    std::atomic<uint64_t> http2Responses_{0};
+    std::atomic<uint64_t> queuedForPool_{0};
+
+    QNetworkAccessManager* manager();
+    void enqueue(std::shared_ptr<Call> call);
+    void startAttempt(std::shared_ptr<Call> call);
+    // Cancels the call (deadline: because it ran out of time); thread_ only
+    void abort(const std::shared_ptr<Call>& call, bool deadline);
+    void onAttemptFinished(std::shared_ptr<Call> call, QNetworkReply* reply);
+    void drainBody(const std::shared_ptr<Call>& call, QNetworkReply* reply);
+    void releaseHost(const std::string& host);
+    void finish(std::shared_ptr<Call> call, HttpResponse response);
+    QNetworkReply* send(const HttpRequest& req);
+    static HttpResponse readReply(QNetworkReply* reply);
+};
+
+} // namespace ModAI
@@ -1,24 +1,23 @@
 #pragma once
 
 #include "network/HttpClient.h"
+#include "network/HttpTransport.h"
 #include <QObject>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <memory>
 
 namespace ModAI {
 
+/**
+ * HttpClient on the shared HttpTransport. Instances only carry per-client
+ * timeout and retry settings; connections, TLS sessions and the I/O thread
+ * are shared. Async callbacks run on the transport thread. The blocking
+ * post()/get() wait on the result, keeping the GUI thread's events flowing
+ * while they do.
+ */
 class QtHttpClient : public QObject, public HttpClient {
     Q_OBJECT
 
 private:
-    std::unique_ptr<QNetworkAccessManager> networkManager_;
-    QThread* creationThread_;
-    int timeoutMs_;
-    int maxRetries_ = 3;
-    int retryDelayMs_ = 1000;
-    
-    QNetworkAccessManager* getNetworkManager();
+    HttpCallOptions options_;
 
 public:
     explicit QtHttpClient(QObject* parent = nullptr);
@@ -26,14 +25,27 @@ public:
     
     HttpResponse post(const HttpRequest& req) override;
     HttpResponse get(const std::string& url, const std::map<std::string, std::string>& headers = {}) override;
+
+    using HttpClient::postAsync;
+    using HttpClient::getAsync;
+    HttpRequestHandle postAsync(const HttpRequest& req, HttpCallback callback) override;
+    HttpRequestHandle getAsync(const std::string& url,
+                               const std::map<std::string, std::string>& headers,
+                               HttpCallback callback) override;
+    HttpRequestHandle downloadAsync(const std::string& url,
+                                    const std::map<std::string, std::string>& headers,
+                                    const std::string& filePath,
+                                    uint64_t maxBytes,
+                                    HttpCallback callback) override;
+    HttpRequestHandle streamAsync(const HttpRequest& req,
+                                  HttpChunkCallback onChunk,
+                                  HttpCallback callback) override;
     
-    void setTimeout(int milliseconds) { timeoutMs_ = milliseconds; }
-    void setRetries(int maxRetries, int delayMs) { maxRetries_ = maxRetries; retryDelayMs_ = delayMs; }
+    void setTimeout(int milliseconds) { options_.timeoutMs = milliseconds; }
+    void setRetries(int maxRetries, int delayMs) { options_.maxRetries = maxRetries; options_.retryDelayMs = delayMs; }
 
 private:
-    HttpResponse executeRequest(QNetworkReply* reply);
-    QNetworkRequest createRequest(const std::string& url, const std::map<std::string, std::string>& headers);
+    HttpResponse waitFor(const HttpRequest& req);
 };
 
 } // namespace ModAI
-
@@ -1,24 +1,62 @@
 #pragma once
 
+#include "utils/CancellationToken.h"
 #include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <string>
 
 namespace ModAI {
 
+/**
+ * Token bucket: holds up to maxRequests tokens and refills maxRequests per
+ * timeWindow. Blocked callers sleep until exactly the next token is due.
+ * Server hints (Retry-After, X-RateLimit-*) can only tighten the budget.
+ */
 class RateLimiter {
-private:
-    int maxRequests_;
-    std::chrono::milliseconds timeWindow_;
-    std::queue<std::chrono::steady_clock::time_point> requestTimes_;
-    std::mutex mutex_;
-
 public:
+    using Clock = std::chrono::steady_clock;
+
     RateLimiter(int maxRequests, std::chrono::milliseconds timeWindow);
+
+    /**
+     * Limiter shared by every caller using the same key (e.g. one per API
+     * key), so separate clients draw from one budget. The first caller for
+     * a key decides its rate.
+     */
+    static std::shared_ptr<RateLimiter> shared(const std::string& key, int maxRequests,
+                                               std::chrono::milliseconds timeWindow);
     
+    // Takes a token if one is available right now
     bool acquire();
+    // Blocks until a token is available
     void waitIfNeeded();
+    // Blocks at most until the deadline; false means no token was taken
+    bool tryAcquireFor(std::chrono::milliseconds timeout);
+    bool tryAcquireUntil(Clock::time_point deadline);
+    // Blocks until a token is available, the token's deadline can't be
+    // met or it is cancelled; false means no token was taken
+    bool acquire(const CancellationToken& token);
+
+    // How long until acquire() would succeed
+    std::chrono::milliseconds timeUntilAvailable();
+
+    // Adapt to the server's view of the quota after a response
+    void updateFromHeaders(const std::map<std::string, std::string>& headers, int statusCode = 0);
+
+private:
+    double capacity_;
+    double tokensPerMs_;
+    double tokens_;
+    Clock::time_point lastRefill_;
+    Clock::time_point blockedUntil_;  // server-imposed pause
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    void refillLocked(Clock::time_point now);
+    Clock::time_point nextAvailableLocked(Clock::time_point now) const;
 };
 
 } // namespace ModAI
-
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "network/HttpClient.h"
+#include "network/HttpRecording.h"
+#include <memory>
+
+namespace ModAI {
+
+/**
+ * HttpClient decorator that appends every request it passes on, with the
+ * response and how long it took, to an HttpRecording file for
+ * ReplayHttpClient. Downloads are recorded with the file's contents and
+ * streamed responses with their chunks joined.
+ *
+ * Request headers and bodies are left out so credentials stay out of the
+ * file, and OAuth token responses are recorded with a placeholder token.
+ * Several clients can share one writer.
+ */
+class RecordingHttpClient : public HttpClient {
+public:
+    RecordingHttpClient(std::unique_ptr<HttpClient> inner, std::shared_ptr<HttpRecordingWriter> writer);
+
+    HttpResponse post(const HttpRequest& req) override;
+    HttpResponse get(const std::string& url, const std::map<std::string, std::string>& headers = {}) override;
+
+    using HttpClient::postAsync;
+    using HttpClient::getAsync;
+    HttpRequestHandle postAsync(const HttpRequest& req, HttpCallback callback) override;
+    HttpRequestHandle getAsync(const std::string& url,
+                               const std::map<std::string, std::string>& headers,
+                               HttpCallback callback) override;
+    HttpRequestHandle downloadAsync(const std::string& url,
+                                    const std::map<std::string, std::string>& headers,
+                                    const std::string& filePath,
+                                    uint64_t maxBytes,
+                                    HttpCallback callback) override;
+    HttpRequestHandle streamAsync(const HttpRequest& req,
+                                  HttpChunkCallback onChunk,
+                                  HttpCallback callback) override;
+
+    HttpClient& inner() { return *inner_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::unique_ptr<HttpClient> inner_;
+    std::shared_ptr<HttpRecordingWriter> writer_;
+
+    void record(const std::string& method, const std::string& url, size_t requestBytes,
+                const HttpResponse& response, const std::string& body, Clock::time_point started);
+};
+
+} // namespace ModAI
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "network/HttpClient.h"
+#include "network/HttpRecording.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+
+namespace ModAI {
+
+struct ReplayOptions {
+    double latencyScale = 1.0;                   // applied to recorded latencies
+    std::chrono::milliseconds fixedLatency{-1};  // replaces them when >= 0
+    std::chrono::milliseconds jitter{0};         // +/- uniformly, never below zero
+    double errorRate = 0.0;                      // share answered with a 503
+    double throttleRate = 0.0;                   // share answered with a 429
+    int retryAfterSeconds = 1;                   // sent with injected 429s
+    uint32_t seed = 1;
+};
+
+/**
+ * HttpClient that answers from an HttpRecording instead of the network,
+ * for load tests and reproducing production traffic offline. A responder,
+ * if set, is asked first and can synthesize exchanges (a generated feed,
+ * responses sized to the request); requests neither can answer get a 404.
+ *
+ * Responses are delivered after the exchange's latency, shaped by the
+ * options, from the client's own timer thread, so async callers see the
+ * same concurrency as with the real transport; post()/get() block for it.
+ * Injected errors and 429s go straight to the caller: the transport's
+ * retries are not simulated. Cancellation and deadlines are honoured as
+ * by QtHttpClient.
+ */
+class ReplayHttpClient : public HttpClient {
+public:
+    // nullopt = not handled, try the recording
+    using Responder = std::function<std::optional<HttpExchange>(const HttpRequest& req)>;
+
+    ReplayHttpClient(std::shared_ptr<HttpRecording> recording, ReplayOptions options = ReplayOptions(),
+                     Responder responder = Responder());
+    // Requests still pending complete as cancelled
+    ~ReplayHttpClient() override;
+
+    ReplayHttpClient(const ReplayHttpClient&) = delete;
+    ReplayHttpClient& operator=(const ReplayHttpClient&) = delete;
+
+    HttpResponse post(const HttpRequest& req) override;
+    HttpResponse get(const std::string& url, const std::map<std::string, std::string>& headers = {}) override;
+
+    using HttpClient::postAsync;
+    using HttpClient::getAsync;
+    HttpRequestHandle postAsync(const HttpRequest& req, HttpCallback callback) override;
+    HttpRequestHandle getAsync(const std::string& url,
+                               const std::map<std::string, std::string>& headers,
+                               HttpCallback callback) override;
+    HttpRequestHandle downloadAsync(const std::string& url,
+                                    const std::map<std::string, std::string>& headers,
+                                    const std::string& filePath,
+                                    uint64_t maxBytes,
+                                    HttpCallback callback) override;
+    HttpRequestHandle streamAsync(const HttpRequest& req,
+                                  HttpChunkCallback onChunk,
+                                  HttpCallback callback) override;
+
+private:
+    class Scheduler;
+
+    std::shared_ptr<HttpRecording> recording_;
+    ReplayOptions options_;
+    Responder responder_;
+    std::shared_ptr<Scheduler> scheduler_;
+    std::mutex randomMutex_;
+    std::mt19937 random_;
+
+    // The response for req and when it is due; method is the recording's
+    // (DOWNLOAD for downloads)
+    std::pair<HttpResponse, std::chrono::milliseconds> respond(const HttpRequest& req, const std::string& method);
+    HttpRequestHandle schedule(const HttpRequest& req, const std::string& method,
+                               std::function<void(HttpResponse)> deliver);
+};
+
+} // namespace ModAI
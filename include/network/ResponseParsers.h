@@ -0,0 +1,58 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace ModAI {
+
+/**
+ * Field extraction for the response bodies on the hot path: Reddit
+ * listings, Hive outputs and chat completion stream events. Only the
+ * fields the callers read are extracted. Built with simdjson (USE_SIMDJSON)
+ * the body is walked once with its On-Demand API and no DOM is allocated;
+ * a body it rejects (or any body, without simdjson) goes through
+ * nlohmann::json, which stays the reference behaviour.
+ */
+
+// The fields the scraper reads from the "data" of a Reddit t3 or t1 thing
+struct RedditThing {
+    std::string name;       // fullname, t3_... or t1_...
+    std::string id;
+    std::string subreddit;
+    std::string url;
+    std::optional<std::string> author;
+    std::optional<std::string> title;
+    std::optional<std::string> selftext;
+    std::optional<std::string> body;
+    bool isSelf = false;
+    std::optional<double> createdUtc;
+
+    // From an already parsed "data" object, e.g. a streamed comment
+    static RedditThing fromJson(const nlohmann::json& data);
+};
+
+struct RedditListing {
+    std::vector<RedditThing> children;  // things without "data" are left out
+    std::string after;                  // empty on the last page
+};
+
+// Nullopt if the body has no data.children; throws on malformed JSON
+std::optional<RedditListing> parseRedditListing(const std::string& body);
+
+struct HiveClass {
+    std::string name;  // "class", or "class_name" in older responses
+    double value = 0.0;
+};
+
+// The classes of each element of "output", in order; nullopt if the body
+// has no output array. Throws on malformed JSON.
+std::optional<std::vector<std::vector<HiveClass>>> parseHiveOutputs(const std::string& body);
+
+// The text of an OpenAI-style stream event: choices[0].delta.content, or
+// choices[0].message.content from servers that don't stream. Empty if the
+// event carries no text; nullopt if it is not such an event.
+std::optional<std::string> parseChatDelta(const std::string& data);
+
+} // namespace ModAI
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace ModAI {
+
+/**
+ * Incremental text/event-stream decoder. Body chunks are fed as they
+ * arrive, split anywhere; each complete event's data (multi-line data
+ * joined with '\n') is handed to onEvent. Comments, ids and retry fields
+ * are ignored.
+ */
+class SseDecoder {
+public:
+    using EventHandler = std::function<void(const std::string& data)>;
+
+    explicit SseDecoder(EventHandler onEvent);
+
+    void feed(const char* data, size_t size);
+    // Delivers a final event the stream ended without a blank line after
+    void finish();
+
+private:
+    EventHandler onEvent_;
+    std::string line_;   // partial line carried over between chunks
+    std::string data_;   // data lines of the event being read
+    bool hasData_ = false;
+    bool lastWasCr_ = false;
+
+    void onLine();
+    void dispatch();
+};
+
+} // namespace ModAI
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace ModAI {
+
+/**
+ * std::streambuf fed from another thread: the network side push()es body
+ * chunks, the reader blocks in underflow() until more data or finish().
+ */
+class ChunkStreamBuf : public std::streambuf {
+public:
+    void push(const char* data, size_t size);
+    void finish();
+
+protected:
+    int_type underflow() override;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> chunks_;
+    std::string current_;
+    bool finished_ = false;
+};
+
+/**
+ * Pulls comments out of a Reddit comments (or /api/morechildren) response
+ * with a SAX parser, so a megathread never exists as a DOM. Each t1 "data"
+ * object is handed to onComment as soon as it closes, holding only its
+ * scalar fields; nested replies are reported on their own. Ids from "more"
+ * stubs are collected for expansion.
+ */
+class CommentStreamParser {
+public:
+    using CommentHandler = std::function<void(const nlohmann::json& commentData)>;
+
+    explicit CommentStreamParser(CommentHandler onComment);
+
+    // False if the input is not valid JSON (comments before the error were still reported)
+    bool parse(std::istream& in);
+    bool parse(const std::string& body);
+
+    // Unexpanded comment ids from "more" stubs, in document order
+    const std::vector<std::string>& moreChildren() const { return moreChildren_; }
+    size_t commentCount() const { return commentCount_; }
+
+    // nlohmann SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(int64_t value);
+    bool number_unsigned(uint64_t value);
+    bool number_float(double value, const std::string& text);
+    bool string(std::string& value);
+    bool binary(std::vector<uint8_t>& value);
+    bool start_object(size_t elements);
+    bool key(std::string& key);
+    bool end_object();
+    bool start_array(size_t elements);
+    bool end_array();
+    bool parse_error(size_t position, const std::string& lastToken, const nlohmann::detail::exception& error);
+
+private:
+    struct Frame {
+        bool isObject = false;
+        std::string keyInParent;  // key this container sits under, if any
+        std::string pendingKey;   // current key while inside an object
+        std::string kind;         // "kind" of a thing {"kind", "data"}
+        nlohmann::json fields;    // scalar fields, for "data" objects
+        bool hasData = false;
+    };
+
+    CommentHandler onComment_;
+    std::vector<Frame> stack_;
+    std::vector<std::string> moreChildren_;
+    size_t commentCount_ = 0;
+
+    void scalar(nlohmann::json value);
+    void push(bool isObject);
+};
+
+} // namespace ModAI
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "network/HttpClient.h"
+#include "storage/ImageStore.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+/**
+ * Fetches a batch of image URLs concurrently, streaming each body to disk
+ * and handing the finished file to the ImageStore. Hashing and the final
+ * rename run on the calling thread, not the network thread.
+ */
+class ImageDownloader {
+public:
+    ImageDownloader(HttpClient& httpClient, ImageStore& store,
+                    size_t maxParallel = 6, uint64_t maxBytesPerFile = 20 * 1024 * 1024);
+
+    // Blocks until every URL finished; returns url -> stored path for the ones that succeeded
+    std::map<std::string, std::string> downloadAll(const std::vector<std::string>& urls,
+                                                   const std::map<std::string, std::string>& headers);
+
+private:
+    HttpClient& httpClient_;
+    ImageStore& store_;
+    size_t maxParallel_;
+    uint64_t maxBytesPerFile_;
+};
+
+} // namespace ModAI
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+struct PollSchedulerOptions {
+    bool adaptive = true;                    // false = every listing at initialInterval
+    std::chrono::seconds minInterval{15};
+    std::chrono::seconds maxInterval{900};
+    std::chrono::seconds initialInterval{60};  // until a listing has been polled
+    size_t pageSize = 25;
+    double targetFill = 0.6;         // expected new posts per poll, as a share of a page
+    double requestsPerSecond = 1.0;  // the API budget
+    double budgetShare = 0.7;        // of it for polls; backlog pages and comments need the rest
+    size_t subredditsPerListing = 10;
+};
+
+/**
+ * Decides when each combined /r/a+b+c listing is polled next. Every
+ * subreddit's post arrival rate is estimated from the creation times of
+ * its recent posts; a listing is polled often enough that the posts
+ * expected between polls (the sum over its subreddits) stay around
+ * targetFill of a page, within [minInterval, maxInterval]. If all listings
+ * together would poll faster than the budget allows, every interval is
+ * stretched by the same factor.
+ *
+ * A listing handed out by takeDue() is in flight until finished(), so a
+ * slow one is never polled twice at once. Thread-safe.
+ */
+class PollScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit PollScheduler(PollSchedulerOptions options = PollSchedulerOptions());
+
+    void setOptions(const PollSchedulerOptions& options);
+    const PollSchedulerOptions& options() const { return options_; }
+
+    // Groups subreddits into listings, all due at once; arrival history
+    // of subreddits that stay is kept
+    void setSubreddits(const std::vector<std::string>& subreddits);
+    std::vector<std::string> listings() const;
+
+    // Listings due by now, most overdue first, marked in flight
+    std::vector<std::string> takeDue(Clock::time_point now);
+    // Schedules the listing's next poll from the rates observed so far
+    void finished(const std::string& listing, Clock::time_point now);
+    // When takeDue() next returns something; max() while all are in flight
+    Clock::time_point nextDue() const;
+
+    // Creation times (unix seconds) of posts a poll returned, any order;
+    // ones older than the newest already recorded are ignored
+    void recordPosts(const std::string& subreddit, const std::vector<double>& createdUtc);
+    // Posts per second
+    double arrivalRate(const std::string& subreddit) const;
+    Clock::duration interval(const std::string& listing) const;
+
+private:
+    static constexpr size_t kRateSamples = 32;
+    static constexpr double kMinRateWindowSeconds = 60.0;
+
+    struct Subreddit {
+        std::deque<double> created;  // oldest first, at most kRateSamples
+        double observedSince = 0.0;  // unix time of the first poll
+    };
+    struct Listing {
+        std::vector<std::string> members;
+        Clock::time_point nextPoll;
+        Clock::duration interval{};
+        bool inFlight = false;
+    };
+
+    PollSchedulerOptions options_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Subreddit> subreddits_;
+    std::map<std::string, Listing> listings_;
+
+    double arrivalRateLocked(const std::string& subreddit, double nowUnix) const;
+    Clock::duration desiredIntervalLocked(const Listing& listing, double nowUnix) const;
+    // Stretch factor keeping the polls of all listings within the budget
+    double budgetStretchLocked(double nowUnix) const;
+};
+
+} // namespace ModAI
@@ -3,15 +3,25 @@
 #include "core/ContentItem.h"
 #include "network/HttpClient.h"
 #include "network/RateLimiter.h"
+#include "network/ResponseParsers.h"
 #include "detectors/ImageModerator.h"
+#include "detectors/ImagePreprocessor.h"
+#include "scraper/PollScheduler.h"
+#include "scraper/SeenIdSet.h"
+#include "storage/ImageStore.h"
 #include <QObject>
 #include <QTimer>
+#include <QThreadPool>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <nlohmann/json.hpp>
 #include <chrono>
+#include <map>
+#include <optional>
 
 namespace ModAI {
 
@@ -21,27 +31,64 @@ class RedditScraper : public QObject {
 private:
     std::unique_ptr<HttpClient> httpClient_;
     std::unique_ptr<ImageModerator> imageModerator_;
+    ImagePreprocessor imagePreprocessor_;
     std::string clientId_;
     std::string clientSecret_;
     std::string userAgent_;
     std::string accessToken_;
     std::chrono::steady_clock::time_point tokenExpiresAt_;
     std::string storagePath_;
-    std::unique_ptr<RateLimiter> rateLimiter_;
-    QTimer* scrapeTimer_;
+    std::shared_ptr<RateLimiter> rateLimiter_;
+    static constexpr int kRequestsPerMinute = 60;
+    QTimer* scrapeTimer_;  // single-shot, armed for the next listing due
+    PollScheduler scheduler_;
+    
+    // Incremental listing state: "before" is the fullname of the newest
+    // post seen, so quiet subreddits cost one empty response per poll.
+    struct ListingCursor {
+        std::string before;
+        int emptyPolls = 0;
+    };
+    struct ListingPage {
+        std::vector<RedditThing> posts;
+        std::string after;
+    };
+    static constexpr size_t kListingLimit = 25;
+    static constexpr int kMaxBacklogPages = 8;
+    static constexpr int kMaxEmptyPolls = 10;
+    std::map<std::string, ListingCursor> cursors_;
+    std::unique_ptr<SeenIdSet> seenIds_;  // persisted, drops re-fetched posts
+    std::unique_ptr<ImageStore> imageStore_;
+    static constexpr size_t kMaxParallelDownloads = 6;
+    static constexpr uint64_t kMaxImageBytes = 20 * 1024 * 1024;
     
     std::vector<std::string> subreddits_;
-    bool isRunning_;
+    static constexpr size_t kSubredditsPerListing = 10;
+    static constexpr int kMaxConcurrentListings = 8;
+    static constexpr size_t kMoreChildrenPerRequest = 100;  // API maximum
+    static constexpr int kMaxMoreChildrenRequests = 50;
+    QThreadPool scrapePool_;
+    std::mutex cursorMutex_;
+    std::mutex authMutex_;
+    std::atomic<bool> isRunning_;
+    // Cancelled by stop(), so listings still in flight are abandoned
+    std::mutex runMutex_;
+    CancellationSource runSource_;
     
     std::function<void(const ContentItem&)> onItemScraped_;
 
-    void authenticate();
+    std::string authenticate();  // returns the current token, empty in public mode
+    std::optional<ListingPage> fetchListing(const std::string& subreddit, const std::string& query);
+    std::vector<RedditThing> fetchNewPosts(const std::string& subreddit);
     std::vector<ContentItem> fetchPosts(const std::string& subreddit);
+    void scrapeGroup(const std::string& listing);
+    void scheduleNextScrape();
     std::vector<ContentItem> fetchComments(const std::string& subreddit);
-    ContentItem parsePost(const nlohmann::json& postJson);
-    ContentItem parseComment(const nlohmann::json& commentJson);
-    void parseCommentsRecursive(const nlohmann::json& children, std::vector<ContentItem>& items);
-    std::string downloadImage(const std::string& url);
+    ContentItem parsePost(const RedditThing& post);
+    ContentItem parseComment(const RedditThing& comment);
+    void expandMoreChildren(const std::string& postId, std::vector<std::string> ids,
+                            const std::function<void(const nlohmann::json&)>& emit);
+    void downloadImages(std::vector<ContentItem>& items);  // swaps image URLs for local paths
     void moderateImage(ContentItem& item);
 
 public:
@@ -51,17 +98,30 @@ public:
                   const std::string& userAgent,
                   const std::string& storagePath,
                   QObject* parent = nullptr);
+    ~RedditScraper() override;
     
     void setImageModerator(std::unique_ptr<ImageModerator> imageModerator);
     void setSubreddits(const std::vector<std::string>& subreddits);
+    // Set before start(); the budget and page size are filled in here
+    void setPollingOptions(const PollSchedulerOptions& options);
+    // Without adaptive polling every listing is polled each intervalSeconds;
+    // with it, that is only the interval until a listing has history
     void start(int intervalSeconds = 60);
     void stop();
     bool isScraping() const { return isRunning_; }
+    const PollScheduler& pollScheduler() const { return scheduler_; }
+    // Images of scraped items are retained here until the caller releases them
+    ImageStore& imageStore() { return *imageStore_; }
     
     void setOnItemScraped(std::function<void(const ContentItem&)> callback);
     
-    // Fetch comments for a specific post
+    // Fetch comments for a specific post, including "load more" stubs
     std::vector<ContentItem> fetchPostComments(const std::string& subreddit, const std::string& postId);
+    
+    // Like fetchPostComments, but each comment is handed to onComment while
+    // the response is still downloading. Returns the number delivered.
+    size_t streamPostComments(const std::string& subreddit, const std::string& postId,
+                              const std::function<void(const ContentItem&)>& onComment);
 
 private slots:
     void performScrape();
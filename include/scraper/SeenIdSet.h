@@ -0,0 +1,43 @@
+#pragma once
+
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ModAI {
+
+/**
+ * Bounded set of recently seen Reddit fullnames, evicting the least
+ * recently seen once full. Every insert is appended to a log file so the
+ * set survives restarts; the log is rewritten when it grows well past the
+ * capacity.
+ */
+class SeenIdSet {
+public:
+    explicit SeenIdSet(const std::string& filePath, size_t capacity = 200000);
+
+    SeenIdSet(const SeenIdSet&) = delete;
+    SeenIdSet& operator=(const SeenIdSet&) = delete;
+
+    // True if the id was new (and is now recorded)
+    bool insert(const std::string& id);
+    bool contains(const std::string& id);
+    size_t size();
+
+private:
+    std::string filePath_;
+    size_t capacity_;
+    std::list<std::string> order_;  // most recent first
+    std::unordered_map<std::string, std::list<std::string>::iterator> index_;
+    std::ofstream log_;
+    size_t logLines_ = 0;
+    std::mutex mutex_;
+
+    void load();
+    void rewriteLocked();
+    void touchLocked(const std::string& id);
+};
+
+} // namespace ModAI
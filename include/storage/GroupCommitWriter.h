@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ModAI {
+
+struct GroupCommitOptions {
+    size_t maxBatchRecords = 512;
+    // How long the writer lingers for more records once one arrives
+    std::chrono::milliseconds maxBatchDelay{2};
+    // fsync after this many records, or once this long has passed since the
+    // last sync with data pending. Both 0 = never fsync (OS flushes).
+    size_t syncEveryRecords = 0;
+    std::chrono::milliseconds syncInterval{1000};
+};
+
+/**
+ * Appends lines to one file from a dedicated thread. Records queued while
+ * a write is in progress go out together in a single write, and fsync is
+ * applied by policy rather than per record. The destructor drains the
+ * queue before closing.
+ */
+class GroupCommitWriter {
+public:
+    explicit GroupCommitWriter(const std::string& filePath, GroupCommitOptions options = GroupCommitOptions());
+    ~GroupCommitWriter();
+
+    GroupCommitWriter(const GroupCommitWriter&) = delete;
+    GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+
+    // Queues one line (a newline is added). Returns immediately.
+    void append(std::string line);
+    // Queues bytes written verbatim, for binary record formats
+    void appendBytes(std::string bytes);
+
+    // Like append(), resolving once the line is written and fsynced; holds
+    // the write error as an exception if it failed
+    std::future<void> appendDurable(std::string line);
+    std::future<void> appendBytesDurable(std::string bytes);
+
+    // Blocks until everything queued so far is written and fsynced
+    void flush();
+    // Blocks until everything queued so far is written, so readers of the
+    // file see it; no fsync beyond what the policy would do anyway
+    void drain();
+
+    const std::string& filePath() const { return filePath_; }
+
+private:
+    struct Record {
+        std::string line;
+        std::shared_ptr<std::promise<void>> done;  // set for durable records and flush barriers
+        bool barrier = false;
+        bool sync = true;  // false for drain() barriers
+        bool newline = true;
+    };
+
+    std::string filePath_;
+    GroupCommitOptions options_;
+    std::FILE* file_ = nullptr;
+
+    std::vector<Record> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    size_t unsyncedRecords_ = 0;
+    std::chrono::steady_clock::time_point lastSync_;
+
+    std::thread thread_;
+
+    void enqueue(Record record);
+    void wait(bool sync);
+    void run();
+    bool writeBatch(std::vector<Record>& batch, std::string& error);
+    bool sync(std::string& error);
+};
+
+} // namespace ModAI
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ModAI {
+
+struct ImageStoreOptions {
+    uint64_t maxBytes = 2ull * 1024 * 1024 * 1024;  // images and thumbnails; 0 = unbounded
+    std::chrono::hours maxAge{24 * 30};               // since last use; 0 = no limit
+    int thumbnailSize = 400;                          // longest side, pixels
+};
+
+/**
+ * Content-addressed directory of downloaded images. Files are named by the
+ * SHA-256 of their bytes, so the same image fetched from different URLs
+ * (i.redd.it, imgur, preview links) is stored - and moderated - once.
+ *
+ * The store persists across restarts together with its URL memo, and is
+ * kept within a size and age budget by evicting the least recently used
+ * images (last use is the file's mtime, so the order survives restarts).
+ * Each image gets a small JPEG thumbnail next to it, see thumbnailPathFor().
+ * Images retained by items still on their way through the pipeline are not
+ * evicted.
+ */
+class ImageStore {
+public:
+    explicit ImageStore(const std::string& rootDir, ImageStoreOptions options = ImageStoreOptions());
+
+    ImageStore(const ImageStore&) = delete;
+    ImageStore& operator=(const ImageStore&) = delete;
+
+    // Evicts right away if the new budget is smaller
+    void setOptions(const ImageStoreOptions& options);
+
+    // Fresh path on the store's filesystem for a download in progress
+    std::string newTempPath();
+
+    /**
+     * Moves a finished download into the store under its content hash and
+     * writes its thumbnail. The temp file is consumed either way.
+     * @return Stored path, or empty if the file is unreadable or not an image
+     */
+    std::string adopt(const std::string& tempPath);
+
+    // URL -> stored path memo, so re-posted links skip the download; it is
+    // journaled to disk, so restarts skip them too
+    std::string lookupUrl(const std::string& url);
+    void rememberUrl(const std::string& url, const std::string& path);
+
+    // Pins a stored image for an item that still needs it; one release()
+    // per retain(). Pins older than kMaxPinAge (items dropped on the way)
+    // no longer protect the image.
+    void retain(const std::string& path);
+    void release(const std::string& path);
+
+    uint64_t totalBytes() const;
+    const std::string& rootDir() const { return rootDir_; }
+
+    // Where the thumbnail of a stored image lives; it may have been evicted
+    static std::string thumbnailPathFor(const std::string& imagePath);
+
+private:
+    struct Entry {
+        uint64_t bytes = 0;       // image plus thumbnail
+        int64_t lastUsed = 0;     // unix seconds
+        int refs = 0;
+        int64_t pinnedAt = 0;     // of the latest retain()
+    };
+
+    std::string rootDir_;
+    std::string incomingDir_;
+    std::string urlLogPath_;
+    ImageStoreOptions options_;
+    std::atomic<uint64_t> tempCounter_{0};
+    std::unordered_map<std::string, std::string> urlIndex_;
+    size_t urlLogLines_ = 0;
+    std::unordered_map<std::string, Entry> entries_;  // by stored path
+    uint64_t totalBytes_ = 0;
+    int64_t nextAgeSweep_ = 0;
+    mutable std::mutex mutex_;
+
+    static constexpr size_t kMaxUrlIndexEntries = 50000;
+    static constexpr std::chrono::hours kMaxPinAge{6};
+    // Eviction frees down to this share of maxBytes, so it runs in batches
+    static constexpr double kEvictionTarget = 0.9;
+
+    static const char* extensionFor(const std::string& header);
+    void scanLocked();
+    void loadUrlLogLocked();
+    void rewriteUrlLogLocked();
+    void touchLocked(const std::string& path, Entry& entry);
+    void evictLocked();
+    void removeLocked(const std::string& path);
+    // Returns the thumbnail's size in bytes, 0 if none was written
+    static uint64_t writeThumbnail(const std::string& imagePath, int thumbnailSize);
+};
+
+} // namespace ModAI
@@ -1,32 +1,38 @@
 #pragma once
 
 #include "storage/Storage.h"
-#include <mutex>
+#include "storage/GroupCommitWriter.h"
+#include <future>
+#include <memory>
 #include <string>
-#include <fstream>
 
 namespace ModAI {
 
 class JsonlStorage : public Storage {
 private:
-    mutable std::mutex writeMutex_;
     std::string basePath_;
     std::string contentFile_;
     std::string actionFile_;
+    std::unique_ptr<GroupCommitWriter> contentWriter_;
+    std::unique_ptr<GroupCommitWriter> actionWriter_;
     
     void ensureDirectoryExists(const std::string& path);
-    void appendLine(const std::string& filepath, const std::string& line);
     std::vector<std::string> readLines(const std::string& filepath);
 
 public:
-    explicit JsonlStorage(const std::string& basePath);
+    explicit JsonlStorage(const std::string& basePath, GroupCommitOptions options = GroupCommitOptions());
     
+    // Queued for the writer thread; durability follows the sync policy
     void saveContent(const ContentItem& item) override;
     void saveAction(const HumanAction& action) override;
     
+    std::future<void> saveContentDurable(const ContentItem& item) override;
+    std::future<void> saveActionDurable(const HumanAction& action) override;
+    
+    void flush();
+    
     std::vector<ContentItem> loadAllContent() override;
     std::vector<HumanAction> loadAllActions() override;
 };
 
 } // namespace ModAI
-
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "storage/GroupCommitWriter.h"
+#include "utils/SharedBytes.h"
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ModAI {
+
+// What a record is indexed by; any field may be empty
+struct SegmentRecordKeys {
+    std::string id;
+    std::string timestamp;  // compared as strings (ISO-8601 sorts correctly)
+    std::string group;      // e.g. subreddit
+};
+
+struct SegmentScanFilter {
+    std::string fromTimestamp;  // inclusive; empty = unbounded
+    std::string toTimestamp;    // inclusive; empty = unbounded
+    std::string group;          // empty = any
+};
+
+struct SegmentLogOptions {
+    uint64_t maxSegmentBytes = 64 * 1024 * 1024;
+    size_t sparseInterval = 256;  // records between timestamp index points
+    GroupCommitOptions writer;
+};
+
+/**
+ * Pull-style iteration over a SegmentLog snapshot, oldest or newest first.
+ * Newest-first walks one sparse-index block at a time, so memory stays
+ * bounded by the block size. Records appended after the reader was opened
+ * are not seen.
+ */
+class SegmentReader {
+public:
+    // Next payload; the view stays valid until the following call
+    bool next(std::string_view& payload);
+
+private:
+    friend class SegmentLog;
+
+    struct Block {
+        size_t file;  // index into files_
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    std::vector<std::string> files_;
+    std::vector<Block> blocks_;  // in visiting order
+    bool reverse_ = false;
+
+    size_t nextBlock_ = 0;
+    size_t mappedFile_ = SIZE_MAX;
+    SharedBytes bytes_;
+    std::vector<std::string_view> pending_;  // current block, in visiting order
+    size_t pendingIndex_ = 0;
+
+    bool loadNextBlock();
+};
+
+/**
+ * Append-only log split into fixed-size segment files of length-prefixed,
+ * checksummed records:
+ *
+ *   u32 payloadLength | u32 fnv1a(payload) | payload     (little-endian)
+ *
+ * Each segment keeps a sparse timestamp index, an id-hash index and group
+ * counts; sealed segments persist theirs in a sidecar ".idx" file so
+ * opening the log reads only the active segment. Reads memory-map the
+ * segment files and skip segments the filter rules out.
+ */
+class SegmentLog {
+public:
+    // Derives keys from a stored payload when an index must be rebuilt
+    using KeyExtractor = std::function<SegmentRecordKeys(std::string_view payload)>;
+    // Return false to stop the scan
+    using Visitor = std::function<bool(std::string_view payload)>;
+
+    SegmentLog(const std::string& directory, const std::string& prefix,
+               KeyExtractor extractor, SegmentLogOptions options = SegmentLogOptions());
+    ~SegmentLog();
+
+    SegmentLog(const SegmentLog&) = delete;
+    SegmentLog& operator=(const SegmentLog&) = delete;
+
+    void append(const std::string& payload, const SegmentRecordKeys& keys);
+    std::future<void> appendDurable(const std::string& payload, const SegmentRecordKeys& keys);
+    void flush();
+
+    // Visits payloads in append order from every segment (and block) the
+    // filter doesn't rule out; the caller applies the exact filter
+    void scan(const SegmentScanFilter& filter, const Visitor& visit);
+    // Coarse filter as in scan(); the caller applies the exact one
+    std::unique_ptr<SegmentReader> reader(const SegmentScanFilter& filter, bool newestFirst);
+    // Payloads whose id key matches, oldest first
+    std::vector<std::string> findById(const std::string& id);
+
+    uint64_t recordCount();
+    size_t segmentCount();
+
+private:
+    struct Segment {
+        uint32_t number = 0;
+        std::string path;
+        uint64_t size = 0;
+        uint64_t records = 0;
+        std::string minTimestamp;
+        std::string maxTimestamp;
+        // (offset, max timestamp of every record before offset)
+        std::vector<std::pair<uint64_t, std::string>> sparse;
+        std::vector<std::pair<uint64_t, uint64_t>> ids;  // (id hash, offset), sorted once sealed
+        std::map<std::string, uint64_t> groups;
+        bool sealed = false;
+    };
+
+    std::string directory_;
+    std::string prefix_;
+    KeyExtractor extractor_;
+    SegmentLogOptions options_;
+
+    std::vector<Segment> segments_;  // oldest first; back() takes appends
+    std::unique_ptr<GroupCommitWriter> writer_;
+    std::mutex mutex_;
+
+    void open();
+    std::string segmentPath(uint32_t number) const;
+    std::string indexPath(const Segment& segment) const;
+    void rebuild(Segment& segment, bool truncateTornTail);
+    bool loadIndex(Segment& segment);
+    void saveIndex(const Segment& segment);
+    void startSegment(uint32_t number);
+    void sealActiveLocked();
+    void appendLocked(const std::string& payload, const SegmentRecordKeys& keys, std::string& record);
+    static void noteRecord(Segment& segment, uint64_t offset, uint64_t recordBytes,
+                           const SegmentRecordKeys& keys, size_t sparseInterval);
+    static bool matches(const Segment& segment, const SegmentScanFilter& filter);
+};
+
+} // namespace ModAI
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "storage/Storage.h"
+#include "storage/SegmentLog.h"
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+/**
+ * Storage on two SegmentLogs under <basePath>/segments: content indexed by
+ * id, timestamp and subreddit, actions by content id and timestamp.
+ * JSONL remains the interchange format via importJsonl()/exportJsonl().
+ */
+class SegmentStorage : public Storage {
+public:
+    explicit SegmentStorage(const std::string& basePath, SegmentLogOptions options = SegmentLogOptions());
+
+    void saveContent(const ContentItem& item) override;
+    void saveAction(const HumanAction& action) override;
+    std::future<void> saveContentDurable(const ContentItem& item) override;
+    std::future<void> saveActionDurable(const HumanAction& action) override;
+
+    std::vector<ContentItem> loadAllContent() override;
+    std::vector<HumanAction> loadAllActions() override;
+    // Reads segments lazily, one index block at a time
+    std::unique_ptr<ContentCursor> openCursor(const ContentQuery& query) override;
+
+    // Latest saved version of the item
+    std::optional<ContentItem> findContent(const std::string& id) override;
+    // Items within the filter's timestamp range / subreddit, oldest first; limit 0 = all
+    std::vector<ContentItem> loadContent(const SegmentScanFilter& filter, size_t limit = 0);
+    std::vector<HumanAction> actionsFor(const std::string& contentId);
+
+    bool empty();
+    void flush();
+
+    // Appends every parseable line of the JSONL files; returns records imported
+    size_t importJsonl(const std::string& contentPath, const std::string& actionPath);
+    size_t exportJsonl(const std::string& contentPath, const std::string& actionPath);
+
+private:
+    std::string basePath_;
+    std::unique_ptr<SegmentLog> content_;
+    std::unique_ptr<SegmentLog> actions_;
+
+    static SegmentRecordKeys contentKeys(const ContentItem& item);
+    static SegmentRecordKeys actionKeys(const HumanAction& action);
+};
+
+} // namespace ModAI
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "storage/Storage.h"
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ModAI {
+
+struct SqliteStorageOptions {
+    size_t maxBatchRecords = 256;
+    // How long the writer lingers for more rows once one arrives
+    std::chrono::milliseconds maxBatchDelay{5};
+};
+
+/**
+ * Storage in a single SQLite database (WAL mode). Content rows are keyed by
+ * id and indexed on (subreddit, timestamp) and (auto_action, timestamp);
+ * actions are indexed on content_id. Saves are queued and committed by a
+ * writer thread in batched transactions; reads and cursors use a second
+ * connection, so paging never waits behind a commit.
+ */
+class SqliteStorage : public Storage {
+public:
+    /**
+     * @throws std::runtime_error if the database cannot be opened or migrated
+     */
+    explicit SqliteStorage(const std::string& databasePath, SqliteStorageOptions options = SqliteStorageOptions());
+    ~SqliteStorage() override;
+
+    SqliteStorage(const SqliteStorage&) = delete;
+    SqliteStorage& operator=(const SqliteStorage&) = delete;
+
+    // Queued for the writer thread; a later save of the same id replaces the row
+    void saveContent(const ContentItem& item) override;
+    void saveAction(const HumanAction& action) override;
+    // Committed with synchronous=FULL, so the WAL is synced before they resolve
+    std::future<void> saveContentDurable(const ContentItem& item) override;
+    std::future<void> saveActionDurable(const HumanAction& action) override;
+
+    std::vector<ContentItem> loadAllContent() override;
+    std::vector<HumanAction> loadAllActions() override;
+    // Keyset-paged over the matching index
+    std::unique_ptr<ContentCursor> openCursor(const ContentQuery& query) override;
+    std::optional<ContentItem> findContent(const std::string& id) override;
+    std::vector<HumanAction> actionsFor(const std::string& contentId);
+
+    bool empty();
+    // Blocks until everything queued so far is committed
+    void flush();
+
+    // Copy another backend's history in; returns records imported
+    size_t importFrom(Storage& source);
+    size_t importJsonl(const std::string& contentPath, const std::string& actionPath);
+
+    struct Connection;
+
+private:
+    struct ContentRow {
+        std::string id;
+        std::string timestamp;
+        std::string subreddit;
+        std::string status;
+        std::string search;
+        std::string json;
+        std::shared_ptr<std::promise<void>> done;  // set for durable saves
+    };
+
+    struct ActionRow {
+        std::string actionId;
+        std::string contentId;
+        std::string timestamp;
+        std::string json;
+        std::shared_ptr<std::promise<void>> done;
+    };
+
+    std::string databasePath_;
+    SqliteStorageOptions options_;
+    std::unique_ptr<Connection> writer_;
+    std::shared_ptr<Connection> reader_;  // shared with open cursors
+
+    std::vector<ContentRow> pendingContent_;
+    std::vector<ActionRow> pendingActions_;
+    std::vector<std::shared_ptr<std::promise<void>>> pendingBarriers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    static ContentRow contentRow(const ContentItem& item, std::string json);
+    static ActionRow actionRow(const HumanAction& action, std::string json);
+    void enqueue(ContentRow row);
+    void enqueue(ActionRow row);
+    void run();
+    bool commitBatch(std::vector<ContentRow>& content, std::vector<ActionRow>& actions, bool durable,
+                     std::string& error);
+};
+
+} // namespace ModAI
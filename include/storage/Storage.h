@@ -1,6 +1,9 @@
 #pragma once
 
 #include "core/ContentItem.h"
+#include <future>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 
@@ -21,15 +24,51 @@ struct HumanAction {
     static HumanAction fromJson(const std::string& json);
 };
 
+struct ContentQuery {
+    std::string subreddit;      // empty = any
+    std::string status;         // decision.auto_action; empty = any
+    std::string fromTimestamp;  // inclusive; empty = unbounded
+    std::string toTimestamp;    // inclusive; empty = unbounded
+    std::string text;           // case-insensitive substring of searchableText(); empty = any
+    bool newestFirst = true;
+
+    bool matches(const ContentItem& item) const;
+    // The fields free-text search looks at, newline separated
+    static std::string searchableText(const ContentItem& item);
+};
+
+/**
+ * Forward-only pager over a query's results. Backends that can, read
+ * lazily, so only the pages actually fetched are ever materialized.
+ */
+class ContentCursor {
+public:
+    virtual ~ContentCursor() = default;
+    // Up to maxItems further results; an empty result means the end
+    virtual std::vector<ContentItem> next(size_t maxItems) = 0;
+    virtual bool atEnd() const = 0;
+};
+
 class Storage {
 public:
     virtual ~Storage() = default;
     
     virtual void saveContent(const ContentItem& item) = 0;
     virtual void saveAction(const HumanAction& action) = 0;
+    // Resolve once the record is committed and synced to disk; a failed
+    // write surfaces as an exception from get()
+    virtual std::future<void> saveContentDurable(const ContentItem& item) = 0;
+    virtual std::future<void> saveActionDurable(const HumanAction& action) = 0;
     
     virtual std::vector<ContentItem> loadAllContent() = 0;
     virtual std::vector<HumanAction> loadAllActions() = 0;
+    
+    // The default loads everything and pages through it in memory
+    virtual std::unique_ptr<ContentCursor> openCursor(const ContentQuery& query);
+    // Latest saved version of the item; the default scans loadAllContent()
+    virtual std::optional<ContentItem> findContent(const std::string& id);
+    
+    std::vector<ContentItem> query(const ContentQuery& query, size_t limit, size_t offset = 0);
 };
 
 } // namespace ModAI
@@ -9,8 +9,13 @@
 #include <QPixmap>
 #include <QTimer>
 #include <QResizeEvent>
+#include <QTableWidget>
+#include <QThreadPool>
+#include <QStringList>
 #include <memory>
+#include <vector>
 #include "detectors/ImageModerator.h"
+#include "utils/CancellationToken.h"
 
 namespace ModAI {
 
@@ -20,13 +25,18 @@ namespace ModAI {
  * Allows users to upload images and get an AI-detection score
  * showing the likelihood that the image was generated by AI.
  * Also checks for embedded metadata from ModAI image generation.
+ *
+ * A folder, or several files dropped at once, is analyzed as a batch on a
+ * small thread pool; the moderator's own rate limiter paces the requests.
+ * Results fill a grid, and selecting a row shows that image.
  */
 class AIImageDetectorPanel : public QWidget {
     Q_OBJECT
 
 public:
     explicit AIImageDetectorPanel(QWidget* parent = nullptr);
-    ~AIImageDetectorPanel() = default;
+    // Stops a running batch and waits for its workers
+    ~AIImageDetectorPanel() override;
 
     /**
      * @brief Initialize with image moderator (Hive AI includes AI detection)
@@ -47,21 +57,43 @@ signals:
 
 private slots:
     void onSelectImage();
+    void onSelectFolder();
     void onAnalyzeImage();
     void onClearImage();
     void onAnalysisComplete(float aiScore, const QString& details, const QString& source);
+    void onBatchRowSelected();
 
 private:
+    struct Analysis {
+        float aiScore = 0.0f;
+        QString details;
+        QString source;  // from embedded ModAI metadata
+    };
+    // Runs on a worker thread; throws if the file can't be read
+    static Analysis analyzeFile(ImageModerator& moderator, const QString& imagePath);
+
     void setupUI();
     void updateResults(float aiScore, const std::string& details, const QString& source = QString());
+    void selectImage(const QString& path);
     void displayImage(const QString& path);
+    // fast = cheap scaling while a resize is still in progress
+    void rescaleDisplay(bool fast);
+    void setBusy(bool busy);
+
+    // Batch mode: the images in a folder, or everything dropped at once
+    void startBatch(const QStringList& paths);
+    void cancelBatch();
+    void onBatchItemDone(uint64_t batchId, int row, bool ok, const Analysis& analysis, const QString& error);
 
 protected:
     void resizeEvent(QResizeEvent* event) override;
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
 
 private:
     QLabel* imageDisplay_;
     QPushButton* selectButton_;
+    QPushButton* folderButton_;
     QPushButton* analyzeButton_;
     QPushButton* clearButton_;
     QLabel* resultLabel_;
@@ -74,7 +106,21 @@ private:
 
     std::shared_ptr<ImageModerator> imageModerator_;
     QString currentImagePath_;
-    QPixmap originalPixmap_;  // Store original for resizing
+    // The loaded image and successive halvings of it, largest first;
+    // rescaling starts from the smallest level still big enough
+    std::vector<QPixmap> pyramid_;
+    QTimer* resizeSettleTimer_;  // smooth rescale once resizing stops
+
+    QTableWidget* batchTable_;
+    QProgressBar* batchProgress_;
+    QThreadPool batchPool_;
+    CancellationSource batchCancellation_;
+    uint64_t batchId_ = 0;
+    int batchDone_ = 0;
+    int batchTotal_ = 0;
+
+    static constexpr int kBatchWorkers = 4;
+    static constexpr int kPyramidMinSide = 256;
 };
 
 } // namespace ModAI
@@ -7,7 +7,11 @@
 #include <QProgressBar>
 #include <QVBoxLayout>
 #include <QTimer>
+#include <QCheckBox>
+#include <QHash>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include "detectors/TextDetector.h"
 
 namespace ModAI {
@@ -17,6 +21,13 @@ namespace ModAI {
  * 
  * Allows users to paste text and get an AI-detection score
  * showing the likelihood that the text was generated by AI.
+ *
+ * Text is scored per paragraph, so editing one paragraph only sends that
+ * one to the model; the overall score is their length-weighted mean and
+ * likely-AI paragraphs are highlighted. With "Analyze as you type" a
+ * debounce timer starts the analysis. One run is in flight at a time;
+ * requests made meanwhile collapse into one rerun and only the result for
+ * the latest text is shown.
  */
 class AITextDetectorPanel : public QWidget {
     Q_OBJECT
@@ -39,11 +50,26 @@ signals:
 private slots:
     void onAnalyzeText();
     void onClearText();
+    void onTextChanged();
     void onAnalysisComplete(float aiScore, const QString& label);
 
 private:
+    struct Paragraph {
+        int start = 0;  // position in the document
+        QString text;
+    };
+    static std::vector<Paragraph> splitParagraphs(const QString& text);
+
     void setupUI();
     void updateResults(float aiScore, const std::string& details);
+    // live = from the debounce timer: no prompts for text that is too short
+    void requestAnalysis(bool live);
+    void startAnalysis();
+    void onParagraphsScored(uint64_t request, const std::vector<QString>& paragraphs,
+                            const std::vector<float>& scores);
+    void renderAnalysis(const std::vector<Paragraph>& paragraphs);
+    void highlightParagraphs(const std::vector<Paragraph>& paragraphs);
+    void stopLoadingAnimation();
 
     QTextEdit* textInput_;
     QPushButton* analyzeButton_;
@@ -55,6 +81,17 @@ private:
     QTimer* loadingTimer_;
     int loadingDots_;
     QString currentText_;  // Store text for watermark check after analysis
+    QCheckBox* liveCheck_;
+    QTimer* debounceTimer_;
+
+    uint64_t latestRequest_ = 0;  // bumped per request; older results aren't shown
+    bool analysisRunning_ = false;
+    bool rerunPending_ = false;
+    // Model score per paragraph text, reused across edits
+    QHash<QString, float> paragraphScores_;
+
+    static constexpr int kDebounceMs = 600;
+    static constexpr int kParagraphCacheLimit = 2000;
 
     std::shared_ptr<TextDetector> textDetector_;
 };
@@ -9,7 +9,17 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QFrame>
+#include <QTimer>
+#include <QImage>
+#include <QPointer>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "network/HttpClient.h"
 #include "detectors/HiveTextModerator.h"
 #include "detectors/ImageModerator.h"
@@ -20,10 +30,13 @@ namespace ModAI {
  * @brief Chat panel with LLM integration and Hive API railguard
  * 
  * This panel provides a chatbot interface where:
- * - User sends messages to an LLM (via API)
- * - LLM responses are analyzed by Hive API
- * - Offensive/inappropriate responses are blocked
- * - Generated images are moderated and watermarked
+ * - User sends messages to an LLM (via API); the reply streams in
+ * - The prompt is moderated while the LLM is already generating, and the
+ *   reply is shown only once the prompt has cleared
+ * - The reply is moderated sentence by sentence as it arrives; a flagged
+ *   prompt or sentence stops the generation and blocks the reply
+ * - Generated images are downloaded, moderated and watermarked in the
+ *   background; results are cached by prompt and by image hash
  */
 class ChatbotPanel : public QWidget {
     Q_OBJECT
@@ -56,14 +69,80 @@ private slots:
 
 private:
     void setupUI();
-    void addMessageToChat(const QString& role, const QString& message, bool blocked = false);
-    void addImageToChat(const QString& imageUrl, const QString& prompt, bool blocked = false);
+    // Returns the bubble widget (nullptr before setupUI)
+    QWidget* addMessageToChat(const QString& role, const QString& message, bool blocked = false);
     void addBlockedImageToChat(const QString& prompt, const QString& reason);
     void callLLM(const QString& userMessage);
     void generateImage(const QString& prompt);
-    bool moderateResponse(const std::string& response);
-    bool moderateImage(const QByteArray& imageData, const QString& mimeType);
-    QByteArray embedImageMetadata(const QByteArray& imageData, const QString& source);
+
+    // Streamed-turn steps, all on the GUI thread; events for a turn that
+    // was replaced or stopped are ignored
+    void onStreamDelta(uint64_t turnId, const std::string& delta);
+    void onStreamFinished(uint64_t turnId, const HttpResponse& response);
+    // segmentEnd identifies a response segment (unused for the prompt)
+    void onModerated(uint64_t turnId, bool prompt, size_t segmentEnd, bool passed);
+    // Runs the moderator on a worker thread under the turn's cancellation
+    void moderateAsync(uint64_t turnId, std::string text, bool prompt, size_t segmentEnd = 0);
+    // Sends complete sentences not yet moderated; all = the rest as well
+    void moderatePendingText(bool all);
+    // Marks the segment ending at segmentEnd as passed and extends the
+    // shown text over every leading segment that has passed
+    void segmentPassed(size_t segmentEnd);
+    void renderTurn();
+    void blockTurn(bool prompt);
+    void finishTurnIfDone();
+    void endTurn(const QString& status);
+    void failTurn(const QString& message, const QString& status);
+
+    void appendHistory(const std::string& role, const std::string& content);
+    // Chat completions request with as much recent history as the budget allows
+    std::string buildChatPayload(const std::string& model);
+
+    // A generated image after moderation, ready to show
+    struct GeneratedImage {
+        QByteArray data;      // PNG with the generator metadata embedded
+        QImage thumbnail;     // scaled for the bubble; empty if undecodable
+        bool passed = false;
+    };
+    // Bubble widgets an image job fills in; null once the chat is cleared
+    struct ImageBubble {
+        QPointer<QFrame> bubble;
+        QPointer<QLabel> imageLabel;
+        QPointer<QLabel> sourceLabel;
+        QPointer<QPushButton> downloadBtn;
+    };
+    // Keyed by hash of model + prompt and by hash of the downloaded bytes;
+    // shared with the workers filling it
+    class GeneratedImageCache {
+    public:
+        std::shared_ptr<const GeneratedImage> find(const std::string& key);
+        void insert(const std::string& key, std::shared_ptr<const GeneratedImage> image);
+
+    private:
+        static constexpr size_t kCapacity = 64;
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::shared_ptr<const GeneratedImage>> entries_;
+        std::deque<std::string> order_;  // oldest first
+    };
+
+    ImageBubble addImageToChat(const QString& prompt);
+    // Image job steps on the GUI thread; a job replaced or cleared is ignored
+    void onImageUrl(uint64_t jobId, ImageBubble bubble, QString prompt, QString modelId,
+                    QString modelName, const HttpResponse& response);
+    void onImageReady(uint64_t jobId, ImageBubble bubble, QString prompt, QString modelName,
+                      std::shared_ptr<const GeneratedImage> image, bool cached);
+    void onImageFailed(uint64_t jobId, ImageBubble bubble, const QString& message,
+                       const QString& imageUrl, const QString& status);
+    void showGeneratedImage(const ImageBubble& bubble, const QString& prompt, const QString& modelName,
+                            std::shared_ptr<const GeneratedImage> image);
+    // Moderation, metadata and thumbnail for downloaded bytes, reusing an
+    // earlier result for identical bytes; worker thread
+    static std::shared_ptr<const GeneratedImage> processGeneratedImage(
+        const SharedBytes& bytes, const QString& modelId, const std::string& promptKey,
+        ImageModerator* moderator, GeneratedImageCache& cache);
+    // nullopt if the moderator failed; callers fail closed
+    static std::optional<bool> moderateImage(ImageModerator* moderator, const SharedBytes& imageData);
+    static QByteArray embedImageMetadata(const QByteArray& imageData, const QString& source);
     void showTypingIndicator();
     void hideTypingIndicator();
     void scrollToBottom();
@@ -82,6 +161,37 @@ private:
     
     bool isDarkTheme_{false};
 
+    // The reply being streamed; GUI thread only
+    struct ChatTurn {
+        uint64_t id = 0;
+        QString modelId;
+        std::string text;              // received so far
+        size_t moderatedUpTo = 0;      // bytes of text already sent for moderation
+        size_t passedUpTo = 0;         // bytes of text cleared in order; all that is shown
+        struct Segment {
+            size_t end;
+            bool passed;
+        };
+        std::deque<Segment> segments;  // sent, not yet below passedUpTo; in text order
+        int moderationsPending = 0;
+        bool promptCleared = false;
+        bool streamDone = false;
+        CancellationSource cancellation;  // stops the stream and queued moderation
+        QWidget* bubble = nullptr;        // created on first render
+    };
+    std::unique_ptr<ChatTurn> turn_;
+    uint64_t nextTurnId_ = 1;
+    QTimer* renderTimer_ = nullptr;    // coalesces label updates while streaming
+
+    // Rough token estimate (4 bytes each) for the history budget
+    static constexpr size_t kHistoryTokenBudget = 3000;
+
+    // The image being generated; a new one or Clear cancels it
+    CancellationSource imageJob_;
+    uint64_t imageJobId_ = 0;
+    std::shared_ptr<GeneratedImageCache> imageCache_ = std::make_shared<GeneratedImageCache>();
+    static constexpr uint64_t kMaxGeneratedImageBytes = 32 * 1024 * 1024;
+
 public:
     void setTheme(bool isDark);
     
@@ -98,13 +208,19 @@ public:
     static QString extractImageMetadata(const QString& imagePath);
 
     std::unique_ptr<HttpClient> httpClient_;
-    std::unique_ptr<HiveTextModerator> textModerator_;
+    // Shared with moderation tasks that may outlive the panel
+    std::shared_ptr<HiveTextModerator> textModerator_;
     std::shared_ptr<ImageModerator> imageModerator_;
     std::string llmApiKey_;
     std::string llmEndpoint_;
     
-    // Conversation history for context
-    std::vector<std::pair<std::string, std::string>> conversationHistory_;
+    // Conversation history for context. Each message is serialized once;
+    // messages that fall out of the token budget are dropped for good
+    struct HistoryEntry {
+        std::string json;   // {"role":...,"content":...}
+        size_t tokens = 0;
+    };
+    std::vector<HistoryEntry> conversationHistory_;
 };
 
 } // namespace ModAI
@@ -1,7 +1,16 @@
 #pragma once
 
 #include "core/ContentItem.h"
+#include "storage/Storage.h"
 #include <QAbstractTableModel>
+#include <QBrush>
+#include <QString>
+#include <QTimer>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ModAI {
@@ -9,8 +18,44 @@ namespace ModAI {
 class DashboardModel : public QAbstractTableModel {
     Q_OBJECT
 
+public:
+    static constexpr int kColumnCount = 9;
+
+    // Immutable once built; replaced as a whole when the item changes
+    struct Row {
+        ContentItemPtr item;
+        std::string searchKey;  // case-folded id/author/subreddit/type/status/labels/text
+        std::array<QString, kColumnCount> display;
+        QBrush background;
+    };
+    using RowPtr = std::shared_ptr<const Row>;
+
 private:
-    std::vector<ContentItem> items_;
+    // Shared rows: the detail panel, exports and background search reference
+    // them without copying
+    std::vector<RowPtr> rows_;
+    
+    // Stored history, paged in as the view scrolls. While attached, rows
+    // are newest first: live items go on top, older pages at the bottom.
+    std::unique_ptr<ContentCursor> history_;
+    bool newestFirst_ = false;
+    static constexpr size_t kHistoryPageSize = 200;
+    static constexpr int kThumbnailSize = 32;  // snippet icons of image items
+    
+    // id -> row key; row = key - firstKey_, so prepending only moves firstKey_
+    std::unordered_map<std::string, int64_t> rowKeys_;
+    int64_t firstKey_ = 0;
+    
+    // Live items queued by queueItem(), inserted together once per frame
+    std::vector<ContentItem> pending_;
+    QTimer* coalesceTimer_;
+    static constexpr int kCoalesceIntervalMs = 16;
+    
+    static RowPtr makeRow(ContentItem item);
+    static QString displayText(const ContentItem& item, int column);
+    static QBrush backgroundFor(const ContentItem& item);
+    void appendPage(std::vector<ContentItem> page);
+    void insertItems(std::vector<ContentItem> items);
 
 public:
     explicit DashboardModel(QObject* parent = nullptr);
@@ -21,9 +66,29 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     
     void addItem(const ContentItem& item);
+    // One insert notification for the whole batch, in arrival order
+    void addItems(std::vector<ContentItem> items);
+    // Coalesced addItem for high-rate producers; rows appear within a frame
+    void queueItem(const ContentItem& item);
+    void flushPending();
     void clear();
-    ContentItem getItem(int row) const;
+    
+    // Replaces the rows with the cursor's first page; the rest load lazily
+    void setHistory(std::unique_ptr<ContentCursor> cursor);
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    // Null if the row is out of range
+    ContentItemPtr itemAt(int row) const;
+    RowPtr rowAt(int row) const;
+    // Stable across prepends; changes only when the rows are reset
+    int64_t rowKey(int row) const { return firstKey_ + row; }
+    // Current rows in order, and the key of the first, for filtering off the UI thread
+    std::vector<RowPtr> snapshotRows(int64_t& firstKey) const;
+    
+    // The folding applied to search keys and needles
+    static std::string foldForSearch(const QString& text);
     void updateItem(int row, const ContentItem& item);
+    // O(1); -1 if the id is not loaded (queued items count once flushed)
     int findRowById(const std::string& id) const;
     
     Qt::ItemFlags flags(const QModelIndex& index) const override;
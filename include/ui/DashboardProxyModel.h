@@ -1,6 +1,11 @@
 #pragma once
 
+#include "ui/DashboardModel.h"
+#include <QFutureWatcher>
 #include <QSortFilterProxyModel>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace ModAI {
 
@@ -11,6 +16,8 @@ public:
     explicit DashboardProxyModel(QObject* parent = nullptr);
 
     void setStatusFilter(const QString& status);
+    // Matching runs on a worker over the rows' precomputed search keys; the
+    // view keeps the previous result until the new one is published
     void setSearchFilter(const QString& text);
     
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
@@ -19,8 +26,23 @@ protected:
     bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override;
 
 private:
-    QString statusFilter_;
-    QString searchFilter_;
+    struct SearchResult {
+        uint64_t generation = 0;
+        std::string needle;
+        int64_t firstKey = 0;
+        std::vector<DashboardModel::RowPtr> rows;  // the rows the flags were computed for
+        std::vector<char> matches;
+    };
+
+    std::string statusFilter_;
+    uint64_t generation_ = 0;
+    // Published result; rows added or replaced since are matched directly
+    SearchResult search_;
+    QFutureWatcher<SearchResult>* watcher_;
+
+    DashboardModel* dashboardModel() const;
+    bool matchesSearch(int sourceRow, const DashboardModel::Row& row) const;
+    void onSearchFinished();
 };
 
 } // namespace ModAI
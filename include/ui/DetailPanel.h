@@ -24,13 +24,14 @@ private:
     QPushButton* allowButton_;
     QPushButton* reviewButton_;
     QPushButton* processCommentsButton_;
+    QPushButton* clusterButton_;
     
-    ContentItem currentItem_;
+    ContentItemPtr currentItem_;
 
 public:
     explicit DetailPanel(QWidget* parent = nullptr);
     
-    void setContentItem(const ContentItem& item);
+    void setContentItem(ContentItemPtr item);
     void clear();
 
 private slots:
@@ -38,10 +39,13 @@ private slots:
     void onAllowClicked();
     void onReviewClicked();
     void onProcessCommentsClicked();
+    void onClusterClicked();
 
 signals:
     void actionRequested(const std::string& itemId, const std::string& action);
     void processCommentsRequested(const std::string& subreddit, const std::string& postId);
+    // Show every item in the near-duplicate cluster the item belongs to
+    void clusterRequested(const std::string& clusterId);
 };
 
 } // namespace ModAI
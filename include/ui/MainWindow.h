@@ -9,11 +9,13 @@
 #include <QPushButton>
 #include <QLineEdit>
 #include <QLabel>
+#include <QPlainTextEdit>
+#include <QProgressDialog>
 #include <QStatusBar>
 #include <QThread>
 #include <QThreadPool>
-#include "core/ModerationEngine.h"
-#include "scraper/RedditScraper.h"
+#include <QTimer>
+#include "core/ModerationService.h"
 #include "ui/DashboardModel.h"
 #include "ui/DetailPanel.h"
 #include "ui/RailguardOverlay.h"
@@ -21,13 +23,12 @@
 #include "ui/AITextDetectorPanel.h"
 #include "ui/AIImageDetectorPanel.h"
 #include "storage/Storage.h"
+#include "export/ExportJob.h"
 #include <QSortFilterProxyModel>
 #include <QComboBox>
 #include "ui/DashboardProxyModel.h"
 #include <QtConcurrent>
 #include <QAction>
-#include <QQueue>
-#include <QMutex>
 
 namespace ModAI {
 
@@ -49,6 +50,8 @@ private:
     QLineEdit* subredditInput_;
     QLineEdit* searchInput_;
     QComboBox* filterCombo_;
+    QTimer* searchDebounce_;  // applies the search once typing pauses
+    static constexpr int kSearchDebounceMs = 250;
     
     // New mode panels
     ChatbotPanel* chatbotPanel_;
@@ -58,16 +61,23 @@ private:
     RailguardOverlay* railguardOverlay_;
     QLabel* statusLabel_;
     
-    std::unique_ptr<ModerationEngine> moderationEngine_;
-    std::unique_ptr<RedditScraper> scraper_;
-    Storage* storagePtr_{nullptr};
+    // Pipeline metrics panel; also dumped to metrics.prom/metrics.json
+    QPlainTextEdit* metricsView_{nullptr};
+    QPushButton* traceButton_{nullptr};
+    QTimer* metricsTimer_{nullptr};
+    int metricsTicks_{0};
+    static constexpr int kMetricsRefreshMs = 1000;
+    static constexpr int kMetricsDumpEveryTicks = 10;
+    
+    std::unique_ptr<ModerationService> service_;
+    Storage* storagePtr_{nullptr};  // owned by service_
     bool historyLoaded_{false};
+    ContentQuery historyQuery_;  // current status/search filter, answered by storage
     std::string dataPath_;
     
-    QThread* workerThread_;
-    QQueue<ContentItem> processingQueue_;
-    QMutex queueMutex_;
-    bool processingActive_;
+    // At most one export runs at a time, off the UI thread
+    std::unique_ptr<ExportJob> exportJob_;
+    QProgressDialog* exportProgress_{nullptr};
     
     // Theme support
     bool isDarkTheme_{false};
@@ -78,15 +88,18 @@ private:
     void setupRedditScraperTab();
     void setupChatbotTab();
     void setupAIDetectorTabs();
+    void setupMetricsTab();
+    void refreshMetrics();
+    void onToggleTrace();
     void setupConnections();
     void loadExistingData();
+    void reloadHistory();
+    void applySearch();
     void cleanupOnExit();
 
 private slots:
     void onToggleScraping();
     void onItemProcessed(const ContentItem& item);
-    void onItemScraped(const ContentItem& item);
-    void processNextItem();
     void onTableSelectionChanged(const QItemSelection& selected, const QItemSelection& deselected);
     void onReviewRequested(const std::string& itemId);
     void onOverrideAction(const std::string& itemId, const std::string& newStatus);
@@ -96,6 +109,7 @@ private slots:
     void onProcessCommentsRequested(const std::string& subreddit, const std::string& postId);
     void onExportCsv();
     void onExportJson();
+    void startExport(const QString& fileName);
     void onImportData();
 
 public:
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace ModAI {
+
+struct CancellationState;
+
+/**
+ * Cooperative cancellation plus an optional deadline, passed by value with
+ * the work it governs. Many tokens share one CancellationSource (e.g. a
+ * scraping session) and each may carry its own deadline (e.g. an item's
+ * latency budget). A default-constructed token never stops.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+
+    // The source was cancelled
+    bool isCancelled() const;
+    // The deadline has passed
+    bool expired() const { return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_; }
+    bool stopRequested() const { return isCancelled() || expired(); }
+
+    bool hasDeadline() const { return deadline_ != Clock::time_point::max(); }
+    // time_point::max() without a deadline
+    Clock::time_point deadline() const { return deadline_; }
+    // Time left, at most `cap`; zero once stopped
+    std::chrono::milliseconds remaining(std::chrono::milliseconds cap) const;
+    // Whether this token can ever stop
+    bool cancellable() const { return state_ != nullptr || hasDeadline(); }
+
+    // Same source, deadline tightened to `deadline` (never loosened)
+    CancellationToken withDeadline(Clock::time_point deadline) const;
+    CancellationToken withTimeout(std::chrono::milliseconds timeout) const {
+        return withDeadline(Clock::now() + timeout);
+    }
+
+    // Unregisters an onCancel() callback when destroyed
+    class Registration {
+    public:
+        Registration() = default;
+        Registration(Registration&& other) noexcept;
+        Registration& operator=(Registration&& other) noexcept;
+        ~Registration();
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+    private:
+        friend class CancellationToken;
+        std::weak_ptr<CancellationState> state_;
+        uint64_t id_ = 0;
+        void reset();
+    };
+
+    /**
+     * Runs callback once when the source is cancelled, on the cancelling
+     * thread; right away if it already is. Deadlines don't trigger it -
+     * whoever waits is expected to bound the wait by deadline().
+     */
+    Registration onCancel(std::function<void()> callback) const;
+
+    // The token the calling thread works under; see CancellationScope
+    static const CancellationToken& current();
+
+private:
+    friend class CancellationSource;
+    std::shared_ptr<CancellationState> state_;
+    Clock::time_point deadline_ = Clock::time_point::max();
+};
+
+class CancellationSource {
+public:
+    CancellationSource();
+
+    CancellationToken token() const;
+    // Idempotent; runs the registered callbacks
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::shared_ptr<CancellationState> state_;
+};
+
+/**
+ * Makes a token current() on this thread until the scope ends, so code
+ * far from the caller (an HTTP client inside a detector) can honour it
+ * without every interface in between taking a parameter.
+ */
+class CancellationScope {
+public:
+    explicit CancellationScope(CancellationToken token);
+    ~CancellationScope();
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+private:
+    CancellationToken previous_;
+};
+
+} // namespace ModAI
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ModAI {
+
+/**
+ * ISO-8601 UTC with milliseconds, e.g. "2024-05-01T12:34:56.789Z" - the
+ * format stored in ContentItem::timestamp, which sorts lexicographically
+ * in time order. Formatted by hand; no gmtime, locale or stream.
+ */
+std::string formatTimestamp(std::chrono::system_clock::time_point time);
+std::string formatTimestamp(int64_t unixMillis);
+
+std::string currentTimestamp();
+
+} // namespace ModAI
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace ModAI {
+
+struct JsonScalar {
+    enum class Type { Null, Boolean, Number, String };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string* text = nullptr;  // may be moved from
+
+    bool isNull() const { return type == Type::Null; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isBoolean() const { return type == Type::Boolean; }
+};
+
+/**
+ * SAX reader for records made of known, nested objects. Instead of a DOM,
+ * subclasses see each scalar member as it is parsed, tagged with the id
+ * they gave its enclosing object; arrays and objects they do not claim are
+ * skipped. Elements of a claimed array arrive as fields of the array's id,
+ * keyed by the array's name. The document must be a JSON object (id kRoot).
+ */
+class JsonFieldReader {
+public:
+    static constexpr int kRoot = 0;
+    static constexpr int kSkip = -1;
+
+    virtual ~JsonFieldReader() = default;
+
+    /**
+     * @throws std::exception on malformed JSON or a non-object document
+     */
+    void parse(const std::string& json);
+
+    // nlohmann SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(int64_t value);
+    bool number_unsigned(uint64_t value);
+    bool number_float(double value, const std::string& text);
+    bool string(std::string& value);
+    bool binary(std::vector<uint8_t>& value);
+    bool start_object(size_t elements);
+    bool key(std::string& key);
+    bool end_object();
+    bool start_array(size_t elements);
+    bool end_array();
+    bool parse_error(size_t position, const std::string& lastToken, const nlohmann::detail::exception& error);
+
+protected:
+    // Id for the object under `key` in object `parent`, or kSkip
+    virtual int onObject(int parent, const std::string& key) = 0;
+    // Id for the array under `key` in object `parent`, or kSkip
+    virtual int onArray(int /*parent*/, const std::string& /*key*/) { return kSkip; }
+    virtual void onField(int object, const std::string& key, const JsonScalar& value) = 0;
+
+private:
+    std::vector<int> stack_;  // object ids; kSkip inside ignored subtrees
+    std::string key_;
+
+    void scalar(const JsonScalar& value);
+};
+
+} // namespace ModAI
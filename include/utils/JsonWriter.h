@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ModAI {
+
+/**
+ * Appends compact JSON straight to a string, without building a DOM.
+ * Output matches nlohmann::json::dump() for the same values: same string
+ * escaping, same shortest round-trip doubles, non-finite doubles as null.
+ * Keys are written in call order, so callers that must match dump() emit
+ * them sorted.
+ *
+ * @throws std::invalid_argument from string()/key() on invalid UTF-8,
+ *         where dump() would throw as well
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out)
+        : out_(out) {}
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(std::string_view name);
+    void string(std::string_view value);
+    void number(double value);
+    void number(int64_t value);
+    void boolean(bool value);
+    void null();
+
+    // The string, or null when absent
+    void optionalString(const std::optional<std::string>& value) {
+        if (value) {
+            string(*value);
+        } else {
+            null();
+        }
+    }
+
+    static void appendEscaped(std::string& out, std::string_view text);
+
+private:
+    std::string& out_;
+    // Bit per nesting level: set once the container has a member
+    uint64_t hasMember_ = 0;
+    int depth_ = 0;
+    bool afterKey_ = false;
+
+    void separate();
+    void open(char bracket);
+    void close(char bracket);
+};
+
+} // namespace ModAI
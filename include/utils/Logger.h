@@ -1,7 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <string>
 
+// Levels below this are compiled out of the MODAI_LOG_* macros entirely
+#ifndef MODAI_LOG_MIN_LEVEL
+#define MODAI_LOG_MIN_LEVEL 0
+#endif
+
 namespace ModAI {
 
 class Logger {
@@ -12,18 +19,57 @@ public:
         Warn,
         Error
     };
-    
+
+    struct Options {
+        size_t queueCapacity = 8192;            // records buffered for the sink thread
+        size_t maxFileBytes = 10 * 1024 * 1024; // rotate once the file reaches this size
+        int maxFiles = 3;                       // rotated files kept: log.1 .. log.N
+        bool console = true;
+    };
+
     static void init(const std::string& logFile);
+    static void init(const std::string& logFile, const Options& options);
+
+    // Runtime threshold; the initial value comes from MODAI_LOG_LEVEL
+    // (debug/info/warn/error), defaulting to Info in release builds
+    static void setLevel(Level level);
+    static Level level();
+    static bool enabled(Level level) {
+        return level >= MODAI_LOG_MIN_LEVEL && level >= threshold_.load(std::memory_order_relaxed);
+    }
+
+    // Queued for the sink thread. Debug/Info records are dropped (and
+    // counted) when the queue is full; Warn/Error wait for room.
     static void log(Level level, const std::string& message);
     static void debug(const std::string& message);
     static void info(const std::string& message);
     static void warn(const std::string& message);
     static void error(const std::string& message);
-    
+
+    // Blocks until everything logged so far has been written
+    static void flush();
+    // Drains and stops the sink thread; later records are written inline.
+    // Registered with atexit on first use.
+    static void shutdown();
+
+    static const char* levelName(Level level);
+
 private:
-    static std::string logFile_;
-    static std::string levelToString(Level level);
+    static std::atomic<int> threshold_;
 };
 
 } // namespace ModAI
 
+// Only evaluates the message when the level is enabled, so disabled levels
+// cost a relaxed load and a branch
+#define MODAI_LOG(level, message)                                  \
+    do {                                                           \
+        if (::ModAI::Logger::enabled(level)) {                     \
+            ::ModAI::Logger::log(level, message);                  \
+        }                                                          \
+    } while (0)
+
+#define MODAI_LOG_DEBUG(message) MODAI_LOG(::ModAI::Logger::Debug, message)
+#define MODAI_LOG_INFO(message) MODAI_LOG(::ModAI::Logger::Info, message)
+#define MODAI_LOG_WARN(message) MODAI_LOG(::ModAI::Logger::Warn, message)
+#define MODAI_LOG_ERROR(message) MODAI_LOG(::ModAI::Logger::Error, message)
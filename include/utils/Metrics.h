@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ModAI {
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * Log-linear histogram of microsecond values (HDR style): 16 linear
+ * sub-buckets per power of two, so any recorded value is reported within
+ * ~6%. Recording is a few relaxed atomic adds; no locks.
+ */
+class Histogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;  // ~12 days in microseconds
+    static constexpr size_t kBucketCount = kSubBuckets * (kMaxExponent - kSubBucketBits + 2);
+
+    void record(uint64_t micros);
+    void record(std::chrono::steady_clock::duration elapsed);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sumMicros() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t maxMicros() const { return max_.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the q-th quantile (0..1); 0 if empty
+    uint64_t quantileMicros(double q) const;
+    // Recorded values <= limit, at bucket resolution
+    uint64_t countAtOrBelow(uint64_t limitMicros) const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+
+    static size_t bucketIndex(uint64_t micros);
+    static uint64_t bucketUpperBound(size_t index);
+};
+
+/**
+ * Process-wide named metrics. Lookups take a lock, so hot paths resolve
+ * their metric once (e.g. into a function-local static) and keep the
+ * reference; metrics are never destroyed.
+ *
+ * Names follow Prometheus conventions; labels are part of the key, given
+ * preformatted as e.g. stage="rules".
+ */
+class Metrics {
+public:
+    static Counter& counter(const std::string& name, const std::string& labels = "");
+    static Gauge& gauge(const std::string& name, const std::string& labels = "");
+    static Histogram& histogram(const std::string& name, const std::string& labels = "");
+
+    // Prometheus text exposition (histograms in seconds)
+    static std::string renderPrometheus();
+    // {"counters":{...},"gauges":{...},"histograms":{name:{count,mean_ms,p50_ms,...}}}
+    static std::string renderJson();
+    // Fixed-width table for the status panel
+    static std::string renderSummary();
+
+    // Written to a temporary file and renamed, so readers never see a partial dump
+    static bool dumpToFile(const std::string& path, bool prometheus);
+};
+
+// Records the scope's wall time into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now()) {
+    }
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Optional timeline capture in Chrome trace-event JSON, which Perfetto
+ * and chrome://tracing open directly. Spans cost one relaxed load while
+ * tracing is off.
+ */
+class Tracing {
+public:
+    static void start(const std::string& outputPath);
+    // Writes the captured events; returns false if the file could not be written
+    static bool stop();
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    // Thread name shown in the timeline
+    static void setThreadName(const std::string& name);
+
+private:
+    friend class TraceSpan;
+    static std::atomic<bool> enabled_;
+    static void record(const char* name, std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end);
+};
+
+// `name` must outlive the trace (string literals)
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : name_(Tracing::enabled() ? name : nullptr) {
+        if (name_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~TraceSpan() {
+        if (name_) {
+            Tracing::record(name_, start_, std::chrono::steady_clock::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace ModAI
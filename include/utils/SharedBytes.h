@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class QByteArray;
+
+namespace ModAI {
+
+/**
+ * Immutable byte buffer whose copies share one underlying allocation (or
+ * file mapping). Used to hand large payloads such as images from storage
+ * through detectors to the network without duplicating them.
+ */
+class SharedBytes {
+public:
+    SharedBytes() = default;
+
+    static SharedBytes copyOf(const void* data, size_t size);
+    static SharedBytes fromVector(std::vector<uint8_t> bytes);
+    static SharedBytes fromString(std::string bytes);
+    // Shares the QByteArray's implicitly shared data; no copy
+    static SharedBytes fromQByteArray(const QByteArray& bytes);
+
+    /**
+     * Memory-maps the file read-only, falling back to reading it if mapping
+     * is unavailable. Returns an empty buffer if the file cannot be opened.
+     */
+    static SharedBytes mapFile(const std::string& path);
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* chars() const { return reinterpret_cast<const char*>(data_); }
+    std::string_view view() const { return std::string_view(chars(), size_); }
+
+    // Non-owning QByteArray over the buffer; must not outlive this object
+    QByteArray toRawQByteArray() const;
+
+private:
+    SharedBytes(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+        : owner_(std::move(owner))
+        , data_(data)
+        , size_(size) {}
+
+    std::shared_ptr<const void> owner_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace ModAI
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+namespace ModAI {
+
+/**
+ * RFC 9562 UUIDv7: 48-bit Unix milliseconds, then a per-thread sequence
+ * and random bits. Ids sort by creation time (strictly within a thread),
+ * which keeps B-tree inserts append-mostly. Uses a thread-local generator
+ * seeded once, so a call costs a clock read and a few arithmetic ops.
+ */
+std::string newUuidV7();
+
+} // namespace ModAI
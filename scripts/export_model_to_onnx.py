@@ -7,6 +7,7 @@ import torch.nn as nn
 from transformers import AutoTokenizer, AutoConfig, AutoModel, PreTrainedModel
 import json
 import os
+import sys
 
 class DesklibAIDetectionModel(PreTrainedModel):
     config_class = AutoConfig
@@ -39,13 +40,61 @@ class DesklibAIDetectionModel(PreTrainedModel):
         return {"logits": logits, "probability": probability}
 
 
+VARIANTS = ("fp32", "int8", "fp16")
+
+
+def variant_path(output_dir, variant):
+    """ai_detector.onnx for fp32, ai_detector.<variant>.onnx otherwise (matches LocalAIDetector)"""
+    name = "ai_detector.onnx" if variant == "fp32" else f"ai_detector.{variant}.onnx"
+    return os.path.join(output_dir, name)
+
+
+def quantize_variants(onnx_path, output_dir, variants):
+    """
+    Derive reduced-precision variants from the exported fp32 graph.
+    int8: dynamic (weight-only, activations quantized at run time) - the CPU path.
+    fp16: weights and compute in half precision with fp32 inputs/outputs - for GPU providers.
+    """
+    written = []
+    if "int8" in variants:
+        from onnxruntime.quantization import quantize_dynamic, QuantType
+        int8_path = variant_path(output_dir, "int8")
+        print(f"  Quantizing to INT8 -> {int8_path}")
+        sys.stdout.flush()
+        quantize_dynamic(
+            onnx_path,
+            int8_path,
+            weight_type=QuantType.QInt8,
+            per_channel=True,
+            # Large models are saved with external data; keep that layout
+            use_external_data_format=os.path.getsize(onnx_path) > 2 * 1024**3
+        )
+        written.append(int8_path)
+    if "fp16" in variants:
+        try:
+            import onnx
+            from onnxconverter_common import float16
+        except ImportError:
+            print("  ⚠ Skipping FP16: pip install onnxconverter-common")
+        else:
+            fp16_path = variant_path(output_dir, "fp16")
+            print(f"  Converting to FP16 -> {fp16_path}")
+            sys.stdout.flush()
+            model = onnx.load(onnx_path)
+            # Keep int64 ids and fp32 probability so the C++ side binds the same tensors
+            model = float16.convert_float_to_float16(model, keep_io_types=True)
+            onnx.save(model, fp16_path)
+            written.append(fp16_path)
+    return written
+
+
 def export_to_onnx(model_directory="desklib/ai-text-detector-v1.01", 
                    output_dir="./models",
-                   max_length=768):
+                   max_length=768,
+                   variants=VARIANTS):
     """
-    Export the model to ONNX format
+    Export the model to ONNX format, plus any reduced-precision variants
     """
-    import sys
     import time
     
     print(f"Loading model from {model_directory}...")
@@ -67,14 +116,14 @@ def export_to_onnx(model_directory="desklib/ai-text-detector-v1.01",
     os.makedirs(output_dir, exist_ok=True)
     
     # Save tokenizer
-    print(f"\n[1/5] Saving tokenizer...")
+    print(f"\n[1/6] Saving tokenizer...")
     sys.stdout.flush()
     tokenizer.save_pretrained(output_dir)
     print(f"✓ Tokenizer saved to {output_dir} ({time.time() - start_time:.1f}s)")
     sys.stdout.flush()
     
     # Create dummy input for tracing
-    print(f"\n[2/5] Preparing dummy inputs for export...")
+    print(f"\n[2/6] Preparing dummy inputs for export...")
     sys.stdout.flush()
     dummy_text = "This is a sample text for model export."
     encoded = tokenizer(
@@ -93,7 +142,7 @@ def export_to_onnx(model_directory="desklib/ai-text-detector-v1.01",
     # Export to ONNX
     onnx_path = os.path.join(output_dir, "ai_detector.onnx")
     
-    print(f"\n[3/5] Exporting model to ONNX format...")
+    print(f"\n[3/6] Exporting model to ONNX format...")
     print(f"⏳ This step takes 2-5 minutes (model size: ~1.5GB)")
     print(f"   Progress indicators:")
     sys.stdout.flush()
@@ -143,7 +192,7 @@ def export_to_onnx(model_directory="desklib/ai-text-detector-v1.01",
     sys.stdout.flush()
     
     # Save model configuration
-    print(f"\n[4/5] Saving configuration...")
+    print(f"\n[4/6] Saving configuration...")
     sys.stdout.flush()
     config = {
         "max_length": max_length,
@@ -161,7 +210,7 @@ def export_to_onnx(model_directory="desklib/ai-text-detector-v1.01",
     sys.stdout.flush()
     
     # Test the ONNX model
-    print(f"\n[5/5] Verifying ONNX model...")
+    print(f"\n[5/6] Verifying ONNX model...")
     sys.stdout.flush()
     import onnxruntime as ort
     
@@ -178,16 +227,37 @@ def export_to_onnx(model_directory="desklib/ai-text-detector-v1.01",
     
     print(f"✓ ONNX model verification successful!")
     print(f"  Test output probability: {outputs[1][0][0]:.4f}")
+    
+    print(f"\n[6/6] Writing quantized variants...")
+    sys.stdout.flush()
+    variant_files = []
+    if any(v != "fp32" for v in variants):
+        variant_files = quantize_variants(onnx_path, output_dir, variants)
+        for path in variant_files:
+            quantized = ort.InferenceSession(path)
+            result = quantized.run(["probability"], {
+                'input_ids': input_ids.numpy(),
+                'attention_mask': attention_mask.numpy()
+            })
+            print(f"✓ {os.path.basename(path)}: {os.path.getsize(path) / 1024**2:.0f} MB, "
+                  f"test probability {result[0][0][0]:.4f}")
+    else:
+        print("  (none requested)")
     print(f"\n{'='*60}")
     print(f"✅ Export complete! Total time: {time.time() - start_time:.1f}s")
     print(f"{'='*60}")
     print(f"\nFiles saved to {output_dir}/:")
     print(f"  📦 ai_detector.onnx (model)")
+    for path in variant_files:
+        print(f"  📦 {os.path.basename(path)} (quantized variant)")
     print(f"  📄 model_config.json (configuration)")
     print(f"  📝 tokenizer files (vocab.txt, tokenizer_config.json, etc.)")
     print(f"\nNext steps:")
     print(f"  1. Rebuild: cd build && cmake .. && cmake --build .")
     print(f"  2. Run: ./ModAI")
+    if variant_files:
+        print(f"  3. Compare variants: ./eval_model_variants --model-dir {output_dir}")
+        print(f"     then pick one with MODAI_MODEL_VARIANT or \"model_variant\" in config/daemon.json")
 
 
 if __name__ == "__main__":
@@ -200,7 +270,13 @@ if __name__ == "__main__":
                         help="Output directory for ONNX model and tokenizer")
     parser.add_argument("--max-length", type=int, default=768,
                         help="Maximum sequence length")
+    parser.add_argument("--variants", default=",".join(VARIANTS),
+                        help="Comma-separated precisions to write: fp32 (always), int8, fp16")
     
     args = parser.parse_args()
+    variants = [v.strip() for v in args.variants.split(",") if v.strip()]
+    unknown = [v for v in variants if v not in VARIANTS]
+    if unknown:
+        parser.error(f"unknown variant(s): {', '.join(unknown)}")
     
-    export_to_onnx(args.model, args.output, args.max_length)
+    export_to_onnx(args.model, args.output, args.max_length, variants)
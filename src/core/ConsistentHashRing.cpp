@@ -0,0 +1,55 @@
+#include "core/ConsistentHashRing.h"
+#include <algorithm>
+#include <cctype>
+
+namespace ModAI {
+
+namespace {
+
+// FNV-1a finished with a splitmix step so nearby names spread over the ring
+uint64_t ringHash(const std::string& text) {
+    uint64_t x = 1469598103934665603ull;
+    for (unsigned char c : text) {
+        x ^= static_cast<unsigned char>(std::tolower(c));
+        x *= 1099511628211ull;
+    }
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace
+
+ConsistentHashRing::ConsistentHashRing(std::vector<std::string> nodes, int virtualNodes)
+    : nodes_(std::move(nodes)) {
+    std::sort(nodes_.begin(), nodes_.end());
+    nodes_.erase(std::unique(nodes_.begin(), nodes_.end()), nodes_.end());
+    virtualNodes = std::max(1, virtualNodes);
+
+    ring_.reserve(nodes_.size() * static_cast<size_t>(virtualNodes));
+    for (size_t node = 0; node < nodes_.size(); ++node) {
+        for (int v = 0; v < virtualNodes; ++v) {
+            ring_.push_back(Point{ringHash(nodes_[node] + "#" + std::to_string(v)), node});
+        }
+    }
+    std::sort(ring_.begin(), ring_.end(), [](const Point& a, const Point& b) { return a.hash < b.hash; });
+}
+
+const std::string& ConsistentHashRing::owner(const std::string& key) const {
+    static const std::string none;
+    if (ring_.empty()) {
+        return none;
+    }
+    uint64_t hash = ringHash(key);
+    auto it = std::lower_bound(ring_.begin(), ring_.end(), hash,
+                               [](const Point& point, uint64_t h) { return point.hash < h; });
+    if (it == ring_.end()) {
+        it = ring_.begin();
+    }
+    return nodes_[it->node];
+}
+
+} // namespace ModAI
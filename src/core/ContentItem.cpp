@@ -1,64 +1,31 @@
 #include "core/ContentItem.h"
-#include <nlohmann/json.hpp>
-#include <iomanip>
-#include <sstream>
-#include <ctime>
-#include <random>
-#include <sstream>
-
-using json = nlohmann::json;
+#include "utils/Clock.h"
+#include "utils/JsonFieldReader.h"
+#include "utils/JsonWriter.h"
+#include "utils/Uuid.h"
 
 namespace ModAI {
 
-std::string generateUUID() {
-    // Simple UUID v4 generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    std::uniform_int_distribution<> dis2(8, 11);
-    
-    std::stringstream ss;
-    ss << std::hex;
-    for (int i = 0; i < 8; i++) {
-        ss << dis(gen);
-    }
-    ss << "-";
-    for (int i = 0; i < 4; i++) {
-        ss << dis(gen);
-    }
-    ss << "-4";
-    for (int i = 0; i < 3; i++) {
-        ss << dis(gen);
-    }
-    ss << "-";
-    ss << dis2(gen);
-    for (int i = 0; i < 3; i++) {
-        ss << dis(gen);
-    }
-    ss << "-";
-    for (int i = 0; i < 12; i++) {
-        ss << dis(gen);
-    }
-    return ss.str();
+namespace {
+
+// Interned once rather than per constructed item
+const Symbol& defaultSource() {
+    static const Symbol source("reddit");
+    return source;
 }
 
-std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%S");
-    ss << "." << std::setfill('0') << std::setw(3) << ms.count() << "Z";
-    return ss.str();
+const Symbol& defaultContentType() {
+    static const Symbol contentType("text");
+    return contentType;
 }
 
+} // namespace
+
 ContentItem::ContentItem() 
-    : id(generateUUID())
-    , timestamp(getCurrentTimestamp())
-    , source("reddit")
-    , content_type("text")
+    : id(newUuidV7())
+    , timestamp(currentTimestamp())
+    , source(defaultSource())
+    , content_type(defaultContentType())
     , schema_version(1) {
 }
 
@@ -69,108 +36,237 @@ ContentItem::ContentItem(const std::string& subreddit, const std::string& conten
 }
 
 std::string ContentItem::toJson() const {
-    json j;
-    j["id"] = id;
-    j["timestamp"] = timestamp;
-    j["source"] = source;
-    j["subreddit"] = subreddit;
-    if (author.has_value()) {
-        j["author"] = author.value();
-    } else {
-        j["author"] = nullptr;
-    }
-    j["content_type"] = content_type;
-    if (text.has_value()) {
-        j["text"] = text.value();
-    } else {
-        j["text"] = nullptr;
-    }
-    if (image_path.has_value()) {
-        j["image_path"] = image_path.value();
-    } else {
-        j["image_path"] = nullptr;
-    }
+    // Streams the same bytes json::dump() produced for this layout: keys
+    // in std::map order, so records stay identical to older JSONL files
+    std::string out;
+    out.reserve(384 + (text ? text->size() : 0));
+    JsonWriter w(out);
+    w.beginObject();
     
     // AI detection
-    j["ai_detection"]["model"] = ai_detection.model;
-    j["ai_detection"]["ai_score"] = ai_detection.ai_score;
-    j["ai_detection"]["label"] = ai_detection.label;
-    j["ai_detection"]["confidence"] = ai_detection.confidence;
-    
-    // Moderation
-    j["moderation"]["provider"] = moderation.provider;
-    j["moderation"]["labels"]["sexual"] = moderation.labels.sexual;
-    j["moderation"]["labels"]["violence"] = moderation.labels.violence;
-    j["moderation"]["labels"]["hate"] = moderation.labels.hate;
-    j["moderation"]["labels"]["drugs"] = moderation.labels.drugs;
-    for (const auto& [key, value] : moderation.labels.additional_labels) {
-        j["moderation"]["labels"][key] = value;
+    w.key("ai_detection");
+    w.beginObject();
+    w.key("ai_score");
+    w.number(ai_detection.ai_score);
+    // Only chunked texts have the key, so other records keep their old bytes
+    if (!ai_detection.chunk_scores.empty()) {
+        w.key("chunk_scores");
+        w.beginArray();
+        for (double score : ai_detection.chunk_scores) {
+            w.number(score);
+        }
+        w.endArray();
     }
+    w.key("confidence");
+    w.number(ai_detection.confidence);
+    w.key("label");
+    w.string(ai_detection.label.str());
+    w.key("model");
+    w.string(ai_detection.model.str());
+    w.endObject();
+    
+    w.key("author");
+    w.optionalString(author);
+    w.key("content_type");
+    w.string(content_type.str());
     
     // Decision
-    j["decision"]["auto_action"] = decision.auto_action;
-    j["decision"]["rule_id"] = decision.rule_id;
-    j["decision"]["threshold_triggered"] = decision.threshold_triggered;
+    w.key("decision");
+    w.beginObject();
+    w.key("auto_action");
+    w.string(decision.auto_action.str());
+    w.key("rule_id");
+    w.string(decision.rule_id.str());
+    w.key("threshold_triggered");
+    w.boolean(decision.threshold_triggered);
+    w.endObject();
     
-    j["schema_version"] = schema_version;
+    if (!duplicate_of.empty()) {
+        w.key("duplicate_of");
+        w.string(duplicate_of);
+    }
+    w.key("id");
+    w.string(id);
+    w.key("image_path");
+    w.optionalString(image_path);
     
-    return j.dump();
-}
-
-ContentItem ContentItem::fromJson(const std::string& jsonStr) {
-    ContentItem item;
-    json j = json::parse(jsonStr);
+    // Moderation; additional labels merge into the fixed ones in key order,
+    // and one named like a fixed label replaces it
+    w.key("moderation");
+    w.beginObject();
+    w.key("labels");
+    w.beginObject();
+    const std::pair<const char*, double> fixedLabels[] = {
+        {"drugs", moderation.labels.drugs},
+        {"hate", moderation.labels.hate},
+        {"sexual", moderation.labels.sexual},
+        {"violence", moderation.labels.violence},
+    };
+    size_t nextFixed = 0;
+    auto writeFixedBefore = [&](const std::string* name) {
+        while (nextFixed < 4 && (!name || name->compare(fixedLabels[nextFixed].first) > 0)) {
+            w.key(fixedLabels[nextFixed].first);
+            w.number(fixedLabels[nextFixed].second);
+            ++nextFixed;
+        }
+        if (name && nextFixed < 4 && name->compare(fixedLabels[nextFixed].first) == 0) {
+            ++nextFixed;
+        }
+    };
+    for (const auto& [key, value] : moderation.labels.additional_labels) {
+        writeFixedBefore(&key.str());
+        w.key(key.str());
+        w.number(value);
+    }
+    writeFixedBefore(nullptr);
+    w.endObject();
+    w.key("provider");
+    w.string(moderation.provider.str());
+    w.endObject();
     
-    item.id = j.value("id", "");
-    item.timestamp = j.value("timestamp", "");
-    item.source = j.value("source", "reddit");
-    item.subreddit = j.value("subreddit", "");
-    if (j.contains("author") && !j["author"].is_null()) {
-        item.author = j["author"].get<std::string>();
+    if (reprocess) {
+        w.key("reprocess");
+        w.boolean(true);
     }
-    item.content_type = j.value("content_type", "text");
-    if (j.contains("text") && !j["text"].is_null()) {
-        item.text = j["text"].get<std::string>();
+    w.key("schema_version");
+    w.number(static_cast<int64_t>(schema_version));
+    w.key("source");
+    w.string(source.str());
+    w.key("subreddit");
+    w.string(subreddit.str());
+    w.key("text");
+    w.optionalString(text);
+    w.key("timestamp");
+    w.string(timestamp);
+    
+    w.endObject();
+    return out;
+}
+
+namespace {
+
+class ContentItemReader : public JsonFieldReader {
+public:
+    explicit ContentItemReader(ContentItem& item)
+        : item_(item) {
     }
-    if (j.contains("image_path") && !j["image_path"].is_null()) {
-        item.image_path = j["image_path"].get<std::string>();
+
+protected:
+    enum Object { AIDetection = 1, Moderation, Labels, Decision, ChunkScores };
+
+    int onObject(int parent, const std::string& key) override {
+        if (parent == kRoot) {
+            if (key == "ai_detection") return AIDetection;
+            if (key == "moderation") return Moderation;
+            if (key == "decision") {
+                // A decision object without auto_action means allow
+                item_.decision.auto_action = "allow";
+                return Decision;
+            }
+        } else if (parent == Moderation && key == "labels") {
+            return Labels;
+        }
+        return kSkip;
     }
-    
-    // AI detection
-    if (j.contains("ai_detection")) {
-        item.ai_detection.model = j["ai_detection"].value("model", "");
-        item.ai_detection.ai_score = j["ai_detection"].value("ai_score", 0.0);
-        item.ai_detection.label = j["ai_detection"].value("label", "");
-        item.ai_detection.confidence = j["ai_detection"].value("confidence", 0.0);
+
+    int onArray(int parent, const std::string& key) override {
+        if (parent == AIDetection && key == "chunk_scores") {
+            return ChunkScores;
+        }
+        return kSkip;
     }
-    
-    // Moderation
-    if (j.contains("moderation")) {
-        item.moderation.provider = j["moderation"].value("provider", "");
-        if (j["moderation"].contains("labels")) {
-            item.moderation.labels.sexual = j["moderation"]["labels"].value("sexual", 0.0);
-            item.moderation.labels.violence = j["moderation"]["labels"].value("violence", 0.0);
-            item.moderation.labels.hate = j["moderation"]["labels"].value("hate", 0.0);
-            item.moderation.labels.drugs = j["moderation"]["labels"].value("drugs", 0.0);
-            for (auto& [key, value] : j["moderation"]["labels"].items()) {
-                if (key != "sexual" && key != "violence" && key != "hate" && key != "drugs") {
-                    if (value.is_number()) {
-                        item.moderation.labels.additional_labels[key] = value.get<double>();
-                    }
+
+    void onField(int object, const std::string& key, const JsonScalar& value) override {
+        switch (object) {
+            case kRoot:
+                if (key == "id") setString(item_.id, value);
+                else if (key == "timestamp") setString(item_.timestamp, value);
+                else if (key == "source") setSymbol(item_.source, value);
+                else if (key == "subreddit") setSymbol(item_.subreddit, value);
+                else if (key == "author") setOptional(item_.author, value);
+                else if (key == "content_type") setSymbol(item_.content_type, value);
+                else if (key == "text") setOptional(item_.text, value);
+                else if (key == "image_path") setOptional(item_.image_path, value);
+                else if (key == "duplicate_of") setString(item_.duplicate_of, value);
+                else if (key == "reprocess" && value.isBoolean()) item_.reprocess = value.boolean;
+                else if (key == "schema_version" && value.isNumber()) {
+                    item_.schema_version = static_cast<int>(value.number);
                 }
+                break;
+            case AIDetection:
+                if (key == "model") setSymbol(item_.ai_detection.model, value);
+                else if (key == "ai_score") setNumber(item_.ai_detection.ai_score, value);
+                else if (key == "label") setSymbol(item_.ai_detection.label, value);
+                else if (key == "confidence") setNumber(item_.ai_detection.confidence, value);
+                break;
+            case ChunkScores:
+                if (value.isNumber()) item_.ai_detection.chunk_scores.push_back(value.number);
+                break;
+            case Moderation:
+                if (key == "provider") setSymbol(item_.moderation.provider, value);
+                break;
+            case Labels: {
+                auto& labels = item_.moderation.labels;
+                if (key == "sexual") setNumber(labels.sexual, value);
+                else if (key == "violence") setNumber(labels.violence, value);
+                else if (key == "hate") setNumber(labels.hate, value);
+                else if (key == "drugs") setNumber(labels.drugs, value);
+                else if (value.isNumber()) labels.additional_labels[key] = value.number;
+                break;
             }
+            case Decision:
+                if (key == "auto_action") setSymbol(item_.decision.auto_action, value);
+                else if (key == "rule_id") setSymbol(item_.decision.rule_id, value);
+                else if (key == "threshold_triggered" && value.isBoolean()) {
+                    item_.decision.threshold_triggered = value.boolean;
+                }
+                break;
         }
     }
-    
-    // Decision
-    if (j.contains("decision")) {
-        item.decision.auto_action = j["decision"].value("auto_action", "allow");
-        item.decision.rule_id = j["decision"].value("rule_id", "");
-        item.decision.threshold_triggered = j["decision"].value("threshold_triggered", false);
+
+private:
+    ContentItem& item_;
+
+    static void setString(std::string& field, const JsonScalar& value) {
+        if (value.isString()) {
+            field = std::move(*value.text);
+        }
     }
-    
-    item.schema_version = j.value("schema_version", 1);
-    
+
+    static void setSymbol(Symbol& field, const JsonScalar& value) {
+        if (value.isString()) {
+            field = Symbol(*value.text);
+        }
+    }
+
+    static void setOptional(std::optional<std::string>& field, const JsonScalar& value) {
+        if (value.isString()) {
+            field = std::move(*value.text);
+        } else if (value.isNull()) {
+            field.reset();
+        }
+    }
+
+    static void setNumber(double& field, const JsonScalar& value) {
+        if (value.isNumber()) {
+            field = value.number;
+        }
+    }
+};
+
+} // namespace
+
+ContentItem::ContentItem(Blank)
+    : source(defaultSource())
+    , content_type(defaultContentType())
+    , schema_version(1) {
+}
+
+ContentItem ContentItem::fromJson(const std::string& jsonStr) {
+    // Missing id/timestamp read as empty, so none are generated
+    ContentItem item{Blank()};
+    ContentItemReader reader(item);
+    reader.parse(jsonStr);
     return item;
 }
 
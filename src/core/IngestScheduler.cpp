@@ -0,0 +1,320 @@
+#include "core/IngestScheduler.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+namespace ModAI {
+
+namespace {
+
+const char* priorityName(WorkPriority priority) {
+    switch (priority) {
+        case WorkPriority::Fresh: return "fresh";
+        case WorkPriority::Requested: return "requested";
+        case WorkPriority::Backfill: return "backfill";
+    }
+    return "fresh";
+}
+
+size_t classIndex(WorkPriority priority) {
+    return static_cast<size_t>(priority);
+}
+
+Counter& shedCounter(WorkPriority priority) {
+    static Counter* counters[] = {
+        &Metrics::counter("modai_ingest_shed_total", "priority=\"fresh\""),
+        &Metrics::counter("modai_ingest_shed_total", "priority=\"requested\""),
+        &Metrics::counter("modai_ingest_shed_total", "priority=\"backfill\""),
+    };
+    return *counters[classIndex(priority)];
+}
+
+std::string acceptRecord(const ContentItem& item, WorkPriority priority) {
+    return "+" + std::to_string(classIndex(priority)) + item.toJson();
+}
+
+} // namespace
+
+IngestScheduler::IngestScheduler(const WorkQueueConfig& config)
+    : config_(config) {
+    config_.capacity = std::max<size_t>(1, config_.capacity);
+    for (size_t c = 0; c < kClasses; ++c) {
+        weights_[c] = std::max(1, config_.priorityWeights[c]);
+    }
+    if (!config_.journalPath.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replayJournal();
+        compactJournal();
+    }
+}
+
+IngestScheduler::~IngestScheduler() = default;
+
+void IngestScheduler::enqueue(Entry entry) {
+    auto& queue = classes_[classIndex(entry.priority)];
+    auto& fifo = queue.bySubreddit[entry.item.subreddit.str()];
+    if (fifo.empty()) {
+        queue.turns.push_back(entry.item.subreddit.str());
+    }
+    fifo.push_back(std::move(entry));
+    ++queue.size;
+    ++size_;
+}
+
+IngestScheduler::Entry IngestScheduler::takeNext() {
+    // Weighted round robin over the classes, then round robin over the
+    // subreddits of the chosen class
+    ClassQueue* chosen = nullptr;
+    for (int pass = 0; pass < 2 && !chosen; ++pass) {
+        for (auto& queue : classes_) {
+            if (queue.size > 0 && queue.credit > 0) {
+                chosen = &queue;
+                break;
+            }
+        }
+        if (!chosen) {
+            for (size_t c = 0; c < kClasses; ++c) {
+                classes_[c].credit = weights_[c];
+            }
+        }
+    }
+    --chosen->credit;
+
+    std::string subreddit = std::move(chosen->turns.front());
+    chosen->turns.pop_front();
+    auto it = chosen->bySubreddit.find(subreddit);
+    Entry entry = std::move(it->second.front());
+    it->second.pop_front();
+    if (it->second.empty()) {
+        chosen->bySubreddit.erase(it);
+    } else {
+        chosen->turns.push_back(std::move(subreddit));
+    }
+    --chosen->size;
+    --size_;
+    return entry;
+}
+
+bool IngestScheduler::shedFor(WorkPriority priority) {
+    if (config_.shedPolicy != "lowest_priority") {
+        return false;  // "newest": the incoming item goes
+    }
+    // Least urgent class first, never one more urgent than the newcomer
+    for (size_t c = kClasses; c-- > classIndex(priority);) {
+        auto& queue = classes_[c];
+        if (queue.size == 0) {
+            continue;
+        }
+        auto busiest = std::max_element(queue.bySubreddit.begin(), queue.bySubreddit.end(),
+                                        [](const auto& a, const auto& b) { return a.second.size() < b.second.size(); });
+        Entry victim = std::move(busiest->second.back());
+        busiest->second.pop_back();
+        if (busiest->second.empty()) {
+            queue.turns.erase(std::find(queue.turns.begin(), queue.turns.end(), busiest->first));
+            queue.bySubreddit.erase(busiest);
+        }
+        --queue.size;
+        --size_;
+        if (journal_) {
+            journal_->append("-" + victim.item.id);
+            ++journalRecords_;
+        }
+        shedCounter(victim.priority).inc();
+        MODAI_LOG_DEBUG("Ingest queue full, shed " + std::string(priorityName(victim.priority)) + " item " +
+                        victim.item.id);
+        return true;
+    }
+    return false;
+}
+
+bool IngestScheduler::publish(const ContentItem& item, WorkPriority priority) {
+    std::string record = config_.journalPath.empty() ? std::string() : acceptRecord(item, priority);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!closed_ && size_ >= config_.capacity) {
+        static Counter& backpressure = Metrics::counter("modai_ingest_backpressure_total");
+        backpressure.inc();
+        auto hasRoom = [this] { return closed_ || size_ < config_.capacity; };
+        if (config_.shedPolicy == "none") {
+            notFull_.wait(lock, hasRoom);
+        } else if (!notFull_.wait_for(lock, config_.maxBlock, hasRoom) && !shedFor(priority)) {
+            shedCounter(priority).inc();
+            return false;
+        }
+    }
+    if (closed_) {
+        return false;
+    }
+    if (journal_) {
+        journal_->append(std::move(record));
+        ++journalRecords_;
+    }
+    enqueue(Entry{item, priority});
+    notEmpty_.notify_one();
+    return true;
+}
+
+std::vector<WorkDelivery> IngestScheduler::receive(size_t maxItems, std::chrono::milliseconds wait) {
+    std::vector<WorkDelivery> deliveries;
+    std::unique_lock<std::mutex> lock(mutex_);
+    notEmpty_.wait_for(lock, wait, [this] { return closed_ || size_ > 0; });
+    while (size_ > 0 && deliveries.size() < maxItems) {
+        Entry entry = takeNext();
+        WorkDelivery delivery;
+        delivery.redelivered = entry.replayed;
+        if (journal_) {
+            // Kept until acked, so a restart delivers it again
+            delivery.token = std::to_string(++deliverySeq_) + ":" + entry.item.id;
+            delivery.item = entry.item;
+            inFlight_.emplace(delivery.token, std::move(entry));
+        } else {
+            delivery.item = std::move(entry.item);
+        }
+        deliveries.push_back(std::move(delivery));
+    }
+    if (!deliveries.empty()) {
+        notFull_.notify_all();
+    }
+    return deliveries;
+}
+
+void IngestScheduler::ack(const std::string& token) {
+    if (token.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!journal_) {
+        return;
+    }
+    auto it = inFlight_.find(token);
+    if (it == inFlight_.end()) {
+        return;
+    }
+    journal_->append("-" + it->second.item.id);
+    inFlight_.erase(it);
+    ++journalRecords_;
+    // Each item costs two records; rewrite once the dead ones dominate
+    if (journalRecords_ > 4 * (config_.capacity + inFlight_.size()) + 1024) {
+        compactJournal();
+    }
+}
+
+void IngestScheduler::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& queue : classes_) {
+        queue.bySubreddit.clear();
+        queue.turns.clear();
+        queue.size = 0;
+    }
+    size_ = 0;
+    inFlight_.clear();
+    if (!config_.journalPath.empty()) {
+        compactJournal();
+    }
+    notFull_.notify_all();
+}
+
+void IngestScheduler::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+}
+
+bool IngestScheduler::isClosed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+size_t IngestScheduler::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+size_t IngestScheduler::size(WorkPriority priority) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return classes_[classIndex(priority)].size;
+}
+
+void IngestScheduler::replayJournal() {
+    std::ifstream file(config_.journalPath);
+    if (!file.is_open()) {
+        return;
+    }
+    // Accepted records in order, minus the acked and shed ones
+    std::vector<std::optional<Entry>> accepted;
+    std::unordered_map<std::string, std::deque<size_t>> byId;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.size() < 2) {
+            continue;
+        }
+        if (line[0] == '-') {
+            auto it = byId.find(line.substr(1));
+            if (it != byId.end()) {
+                accepted[it->second.front()].reset();
+                it->second.pop_front();
+                if (it->second.empty()) {
+                    byId.erase(it);
+                }
+            }
+        } else if (line[0] == '+' && line[1] >= '0' && line[1] < '0' + static_cast<int>(kClasses)) {
+            try {
+                Entry entry{ContentItem::fromJson(line.substr(2)), static_cast<WorkPriority>(line[1] - '0'), true};
+                byId[entry.item.id].push_back(accepted.size());
+                accepted.emplace_back(std::move(entry));
+            } catch (const std::exception& e) {
+                // A torn last line after a crash
+                Logger::warn("Skipping corrupt ingest journal record: " + std::string(e.what()));
+            }
+        }
+    }
+
+    size_t restored = 0;
+    for (auto& entry : accepted) {
+        if (entry) {
+            enqueue(std::move(*entry));
+            ++restored;
+        }
+    }
+    if (restored > 0) {
+        Logger::info("Restored " + std::to_string(restored) + " queued items from " + config_.journalPath);
+    }
+}
+
+void IngestScheduler::compactJournal() {
+    namespace fs = std::filesystem;
+    journal_.reset();  // drains pending appends
+
+    std::error_code ec;
+    fs::create_directories(fs::path(config_.journalPath).parent_path(), ec);
+    std::string tmpPath = config_.journalPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        journalRecords_ = 0;
+        // In-flight items first: they were taken before anything still queued
+        for (const auto& [token, entry] : inFlight_) {
+            out << acceptRecord(entry.item, entry.priority) << '\n';
+            ++journalRecords_;
+        }
+        for (const auto& queue : classes_) {
+            for (const auto& subreddit : queue.turns) {
+                for (const auto& entry : queue.bySubreddit.at(subreddit)) {
+                    out << acceptRecord(entry.item, entry.priority) << '\n';
+                    ++journalRecords_;
+                }
+            }
+        }
+    }
+    fs::rename(tmpPath, config_.journalPath, ec);
+    if (ec) {
+        Logger::error("Failed to compact ingest journal " + config_.journalPath + ": " + ec.message());
+    }
+    journal_ = std::make_unique<GroupCommitWriter>(config_.journalPath);
+}
+
+} // namespace ModAI
@@ -1,12 +1,60 @@
 #include "core/ModerationEngine.h"
 #include "utils/Logger.h"
-#include <QFile>
+#include "utils/Metrics.h"
 #include <QImage>
 #include <QBuffer>
 #include <QIODevice>
+#include <QCryptographicHash>
+#include <QThreadPool>
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <thread>
 
 namespace ModAI {
 
+namespace {
+
+// Part of every cache key, so bumping a model or provider version
+// naturally invalidates its old entries
+const char* const kTextDetectorVersion = "desklib/ai-text-detector-v1.01";
+const char* const kTextModeratorVersion = "hive/text-moderation/v3";
+// Images are keyed by their original bytes; the suffix tracks the
+// ImagePreprocessor settings that shaped what the provider actually saw
+const char* const kImageModeratorVersion = "hive/visual-moderation/v3+jpeg1024q85";
+
+// Collapse whitespace runs and trim, so trivially reformatted reposts share a key
+std::string normalizeText(const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized.push_back(' ');
+            pendingSpace = false;
+        }
+        normalized.push_back(c);
+    }
+    return normalized;
+}
+
+std::string cacheKey(const char* version, const char* data, size_t size) {
+    QByteArray digest = QCryptographicHash::hash(
+        QByteArray::fromRawData(data, static_cast<int>(size)), QCryptographicHash::Sha256);
+    return std::string(version) + ":" + digest.toHex().toStdString();
+}
+
+std::string textCacheKey(const char* version, const std::string& text) {
+    std::string normalized = normalizeText(text);
+    return cacheKey(version, normalized.data(), normalized.size());
+}
+
+} // namespace
+
 ModerationEngine::ModerationEngine(
     std::unique_ptr<TextDetector> textDetector,
     std::unique_ptr<ImageModerator> imageModerator,
@@ -17,80 +65,331 @@ ModerationEngine::ModerationEngine(
     , imageModerator_(std::move(imageModerator))
     , textModerator_(std::move(textModerator))
     , ruleEngine_(std::move(ruleEngine))
-    , storage_(std::move(storage)) {
+    , storage_(std::move(storage))
+    , textDetectorModel_(kTextDetectorVersion)
+    , detectorPool_(std::make_unique<QThreadPool>()) {
+    detectorPool_->setMaxThreadCount(std::max(4, static_cast<int>(std::thread::hardware_concurrency())));
+}
+
+ModerationEngine::~ModerationEngine() {
+    // Abandoned (timed-out) detector tasks still reference this engine
+    detectorPool_->waitForDone();
+}
+
+template <typename Labels>
+void ModerationEngine::applyModerationLabels(ContentItem& item, const Labels& labels) {
+    for (const auto& [label, confidence] : labels) {
+        if (label == "sexual") item.moderation.labels.sexual = confidence;
+        else if (label == "violence") item.moderation.labels.violence = confidence;
+        else if (label == "hate") item.moderation.labels.hate = confidence;
+        else if (label == "drugs") item.moderation.labels.drugs = confidence;
+        else item.moderation.labels.additional_labels[label] = confidence;
+    }
+    item.moderation.provider = "hive";
 }
 
 void ModerationEngine::processItem(ContentItem item) {
+    if (item.cancellation.isCancelled()) {
+        return;
+    }
     Logger::info("Processing content item: " + item.id);
     
-    // Run AI text detection if text content exists
-    if (item.content_type == "text" && item.text.has_value()) {
-        auto textResult = textDetector_->analyze(item.text.value());
-        item.ai_detection.model = "desklib/ai-text-detector-v1.01";
-        item.ai_detection.ai_score = textResult.ai_score;
-        item.ai_detection.label = textResult.label;
-        item.ai_detection.confidence = textResult.confidence;
+    if (!reuseNearDuplicate(item)) {
+        runDetectors(item);
+    } else if (item.moderation.provider != "hive") {
+        // The earlier item's rules didn't need Hive; this one's might
+        if (needsModeration(item)) {
+            moderate(item);
+        } else {
+            skipModeration(item);
+        }
+    }
+    applyRules(item);
+    rememberNearDuplicate(item);
+    if (persist(item)) {
+        notify(item);
+    }
+}
+
+void ModerationEngine::runDetectors(ContentItem& item) {
+    // Each task works on its own copy, so one that times out can finish
+    // in the background without touching the item we return
+    auto launch = [this](ContentItem copy, void (ModerationEngine::*stage)(ContentItem&)) {
+        auto promise = std::make_shared<std::promise<ContentItem>>();
+        auto future = promise->get_future();
+        detectorPool_->start([this, promise, stage, copy = std::move(copy)]() mutable {
+            CancellationScope scope(copy.cancellation);
+            try {
+                (this->*stage)(copy);
+                promise->set_value(std::move(copy));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return future;
+    };
+    
+    bool text = item.content_type == "text" && item.text.has_value();
+    // Lazily, the local detector runs first and Hive only if the rules
+    // still need it; otherwise both run side by side
+    bool lazy = lazyDetectors_;
+    std::future<ContentItem> aiTask;
+    if (text) {
+        aiTask = launch(item, &ModerationEngine::detectAI);
+    }
+    std::future<ContentItem> moderationTask;
+    if (!lazy) {
+        moderationTask = launch(item, &ModerationEngine::moderate);
+    }
+    
+    // The item's own budget can only shorten the wait
+    auto timeout = std::chrono::milliseconds(detectorTimeoutMs_.load());
+    auto deadline = std::min(std::chrono::steady_clock::now() + timeout, item.cancellation.deadline());
+    auto join = [&](std::future<ContentItem>& task, const char* name) -> std::optional<ContentItem> {
+        if (!task.valid()) {
+            return std::nullopt;
+        }
+        if (task.wait_until(deadline) != std::future_status::ready) {
+            Logger::warn(std::string(name) + " timed out for " + item.id + "; continuing without it");
+            return std::nullopt;
+        }
+        try {
+            return task.get();
+        } catch (const std::exception& e) {
+            Logger::error(std::string(name) + " failed for " + item.id + ": " + e.what());
+            return std::nullopt;
+        }
+    };
+    
+    RuleInputs known = kAIScoreInput;
+    if (auto result = join(aiTask, "AI detection")) {
+        item.ai_detection = result->ai_detection;
+    } else if (text) {
+        item.ai_detection.label = "unknown";
+        known = 0;
+    }
+    if (lazy) {
+        if (needsModeration(item, known)) {
+            moderationTask = launch(item, &ModerationEngine::moderate);
+            deadline = std::min(std::chrono::steady_clock::now() + timeout, item.cancellation.deadline());
+        } else {
+            skipModeration(item);
+        }
+    }
+    if (auto result = join(moderationTask, "Moderation")) {
+        item.moderation = result->moderation;
+    }
+}
+
+void ModerationEngine::detectAI(ContentItem& item) {
+    std::vector<ContentItem> batch;
+    batch.push_back(std::move(item));
+    detectAIBatch(batch);
+    item = std::move(batch.front());
+}
+
+void ModerationEngine::detectAIBatch(std::vector<ContentItem>& items) {
+    auto apply = [this](ContentItem& item, double aiScore, const std::string& label, double confidence,
+                        std::vector<double> chunkScores) {
+        item.ai_detection.model = textDetectorModel_;
+        item.ai_detection.ai_score = aiScore;
+        item.ai_detection.label = label;
+        item.ai_detection.confidence = confidence;
+        item.ai_detection.chunk_scores = std::move(chunkScores);
+    };
+    
+    // Run AI text detection on every item with text that isn't cached
+    std::vector<std::string> texts;
+    std::vector<size_t> textIndex;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (items[i].content_type != "text" || !items[i].text.has_value()) {
+            continue;
+        }
         
-        // Also run text moderation
-        auto textModResult = textModerator_->analyzeText(item.text.value());
-        for (const auto& [label, confidence] : textModResult.labels) {
-            if (label == "sexual" || label == "violence" || label == "hate" || label == "drugs") {
-                if (label == "sexual") item.moderation.labels.sexual = confidence;
-                else if (label == "violence") item.moderation.labels.violence = confidence;
-                else if (label == "hate") item.moderation.labels.hate = confidence;
-                else if (label == "drugs") item.moderation.labels.drugs = confidence;
-            } else {
-                item.moderation.labels.additional_labels[label] = confidence;
+        if (resultCache_) {
+            std::string key = textCacheKey(textDetectorModel_.c_str(), items[i].text.value());
+            if (auto cached = cachedResult(items[i], key)) {
+                ++aiDetectionHits_;
+                apply(items[i], cached->value("ai_score", 0.0), cached->value("label", ""),
+                      cached->value("confidence", 0.0),
+                      cached->value("chunk_scores", std::vector<double>()));
+                continue;
             }
+            ++aiDetectionMisses_;
+            keys.push_back(std::move(key));
         }
-        item.moderation.provider = "hive";
+        texts.push_back(items[i].text.value());
+        textIndex.push_back(i);
+    }
+    if (texts.empty()) {
+        return;
     }
     
-    // Run image moderation if image content exists
-    if (item.content_type == "image" && item.image_path.has_value()) {
-        try {
-            QFile file(QString::fromStdString(item.image_path.value()));
-            if (file.open(QIODevice::ReadOnly)) {
-                QByteArray imageData = file.readAll();
-                std::vector<uint8_t> imageBytes(imageData.begin(), imageData.end());
-                
-                auto imageResult = imageModerator_->analyzeImage(imageBytes, "image/jpeg");
-                for (const auto& [label, confidence] : imageResult.labels) {
-                    if (label == "sexual" || label == "violence" || label == "hate" || label == "drugs") {
-                        if (label == "sexual") item.moderation.labels.sexual = confidence;
-                        else if (label == "violence") item.moderation.labels.violence = confidence;
-                        else if (label == "hate") item.moderation.labels.hate = confidence;
-                        else if (label == "drugs") item.moderation.labels.drugs = confidence;
-                    } else {
-                        item.moderation.labels.additional_labels[label] = confidence;
-                    }
-                }
-                item.moderation.provider = "hive";
+    auto textResults = textDetector_->analyzeBatch(texts);
+    for (size_t i = 0; i < textResults.size() && i < textIndex.size(); ++i) {
+        const auto& result = textResults[i];
+        apply(items[textIndex[i]], result.ai_score, result.label, result.confidence, result.chunk_scores);
+        
+        // "unknown" means the detector couldn't run; don't remember that
+        if (resultCache_ && result.label != "unknown") {
+            nlohmann::json cached = {{"ai_score", result.ai_score},
+                                     {"label", result.label},
+                                     {"confidence", result.confidence}};
+            if (!result.chunk_scores.empty()) {
+                cached["chunk_scores"] = result.chunk_scores;
             }
-        } catch (const std::exception& e) {
-            Logger::error("Failed to process image: " + std::string(e.what()));
+            resultCache_->put(keys[i], cached);
         }
     }
+}
+
+void ModerationEngine::moderate(ContentItem& item) {
+    std::vector<ContentItem> batch;
+    batch.push_back(std::move(item));
+    moderateBatch(batch);
+    item = std::move(batch.front());
+}
+
+void ModerationEngine::moderateBatch(std::vector<ContentItem>& items) {
+    // Text moderation goes out as one multi-input request per batch
+    std::vector<std::string> texts;
+    std::vector<size_t> textIndex;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto& item = items[i];
+        if (item.content_type == "image" && item.image_path.has_value()) {
+            // One request per image, so each can follow its own item's token
+            std::optional<CancellationScope> scope;
+            if (item.cancellation.cancellable()) {
+                scope.emplace(item.cancellation);
+            }
+            moderateImage(item);
+            continue;
+        }
+        if (item.content_type != "text" || !item.text.has_value()) {
+            continue;
+        }
+        
+        if (resultCache_) {
+            std::string key = textCacheKey(kTextModeratorVersion, item.text.value());
+            if (auto cached = cachedResult(item, key)) {
+                ++textModerationHits_;
+                applyModerationLabels(item, cached->get<std::vector<std::pair<std::string, double>>>());
+                continue;
+            }
+            ++textModerationMisses_;
+            keys.push_back(std::move(key));
+        }
+        texts.push_back(item.text.value());
+        textIndex.push_back(i);
+    }
+    if (texts.empty()) {
+        return;
+    }
     
-    // Evaluate rules
-    auto matchingRules = ruleEngine_->getMatchingRules(item);
-    if (!matchingRules.empty()) {
-        item.decision.auto_action = matchingRules[0].action;
-        item.decision.rule_id = matchingRules[0].id;
+    auto textResults = textModerator_->analyzeTexts(texts);
+    for (size_t i = 0; i < textResults.size() && i < textIndex.size(); ++i) {
+        applyModerationLabels(items[textIndex[i]], textResults[i].labels);
+        if (resultCache_ && textResults[i].ok) {
+            resultCache_->put(keys[i], textResults[i].labels);
+        }
+    }
+}
+
+std::optional<nlohmann::json> ModerationEngine::cachedResult(const ContentItem& item, const std::string& key) {
+    // A reprocessed item is re-run; its fresh result replaces the entry
+    if (item.reprocess) {
+        return std::nullopt;
+    }
+    return resultCache_->get(key);
+}
+
+void ModerationEngine::moderateImage(ContentItem& item) {
+    try {
+        // Mapped, so hashing and preprocessing read the file in place
+        SharedBytes imageData = SharedBytes::mapFile(item.image_path.value());
+        if (imageData.empty()) {
+            return;
+        }
+        
+        std::string key;
+        if (resultCache_) {
+            key = cacheKey(kImageModeratorVersion, imageData.chars(), imageData.size());
+            if (auto cached = cachedResult(item, key)) {
+                ++imageModerationHits_;
+                applyModerationLabels(item, cached->get<std::map<std::string, double>>());
+                return;
+            }
+            ++imageModerationMisses_;
+        }
+        
+        PreparedImage prepared = imagePreprocessor_.prepare(item.image_path.value());
+        if (!prepared.ok) {
+            return;
+        }
+        
+        auto imageResult = imageModerator_->analyzeImage(prepared.bytes);
+        applyModerationLabels(item, imageResult.labels);
+        if (resultCache_ && imageResult.ok) {
+            resultCache_->put(key, imageResult.labels);
+        }
+    } catch (const std::exception& e) {
+        Logger::error("Failed to process image: " + std::string(e.what()));
+    }
+}
+
+bool ModerationEngine::needsModeration(const ContentItem& item, RuleInputs known) const {
+    if (!lazyDetectors_) {
+        return true;
+    }
+    // Images have no local signal, but rules on ai_score still see its 0
+    if ((ruleEngine_->requiredInputs(item.subreddit) & kModerationInput) == 0) {
+        return false;
+    }
+    return !ruleEngine_->decisionFixed(item, known);
+}
+
+void ModerationEngine::skipModeration(ContentItem& item) {
+    static Counter& skipped = Metrics::counter("modai_detector_skipped_total", "detector=\"hive_moderation\"");
+    skipped.inc();
+    item.moderation.provider = "skipped";
+}
+
+void ModerationEngine::applyRules(ContentItem& item) {
+    static Histogram& ruleTime = Metrics::histogram("modai_rule_eval_seconds");
+    ScopedTimer timer(ruleTime);
+    if (RuleRef rule = ruleEngine_->findFirstMatch(item)) {
+        item.decision.auto_action = rule->action;
+        item.decision.rule_id = rule->id;
         item.decision.threshold_triggered = true;
     } else {
         item.decision.auto_action = "allow";
         item.decision.threshold_triggered = false;
     }
-    
-    // Save to storage
+}
+
+bool ModerationEngine::persist(const ContentItem& item) {
+    static Histogram& writeTime = Metrics::histogram("modai_storage_write_seconds");
+    static Counter& failures = Metrics::counter("modai_storage_write_failures_total");
+    ScopedTimer timer(writeTime);
     try {
-        storage_->saveContent(item);
+        if (item.reprocess) {
+            ContentItem stored = item;
+            stored.reprocess = false;
+            storage_->saveContentDurable(stored).get();
+        } else {
+            storage_->saveContentDurable(item).get();
+        }
+        return true;
     } catch (const std::exception& e) {
-        Logger::error("Failed to save content item: " + std::string(e.what()));
+        failures.inc();
+        Logger::error("Failed to save content item " + item.id + ": " + e.what());
+        return false;
     }
-    
-    // Notify callback
+}
+
+void ModerationEngine::notify(const ContentItem& item) {
     if (onItemProcessed_) {
         onItemProcessed_(item);
     }
@@ -100,5 +399,104 @@ void ModerationEngine::setOnItemProcessed(std::function<void(const ContentItem&)
     onItemProcessed_ = callback;
 }
 
+void ModerationEngine::setTextDetectorVariant(const std::string& variant) {
+    // fp32 keeps the bare version, so results from before variants existed still match
+    textDetectorModel_ = variant.empty() || variant == "fp32"
+        ? Symbol(kTextDetectorVersion)
+        : Symbol(std::string(kTextDetectorVersion) + "+" + variant);
+}
+
+void ModerationEngine::setResultCache(std::unique_ptr<ResultCache> cache) {
+    resultCache_ = std::move(cache);
+}
+
+void ModerationEngine::setNearDuplicateDetection(NearDuplicateOptions text, NearDuplicateOptions image) {
+    textDuplicates_ = std::make_unique<NearDuplicateIndex>(text);
+    imageDuplicates_ = std::make_unique<NearDuplicateIndex>(image);
+}
+
+bool ModerationEngine::reuseNearDuplicate(ContentItem& item) {
+    if (!textDuplicates_) {
+        return false;
+    }
+    
+    bool image = item.content_type == "image" && item.image_path.has_value();
+    std::optional<uint64_t> hash;
+    if (image) {
+        hash = NearDuplicateIndex::imageHash(item.image_path.value());
+    } else if (item.content_type == "text" && item.text.has_value()) {
+        hash = NearDuplicateIndex::textHash(item.text.value());
+    }
+    if (!hash) {
+        return false;
+    }
+    
+    auto match = (image ? imageDuplicates_ : textDuplicates_)->find(*hash);
+    // A reprocessed item must not reuse its own, or anyone's, earlier results
+    if (match && (item.reprocess || match->item->id == item.id)) {
+        match.reset();
+    }
+    if (!match) {
+        std::lock_guard<std::mutex> lock(pendingHashesMutex_);
+        // Items dropped mid-pipeline never come back to claim their hash
+        if (pendingHashes_.size() > 10000) {
+            pendingHashes_.clear();
+        }
+        pendingHashes_[item.id] = *hash;
+        return false;
+    }
+    
+    static Counter& textHits = Metrics::counter("modai_near_duplicate_hits_total", "kind=\"text\"");
+    static Counter& imageHits = Metrics::counter("modai_near_duplicate_hits_total", "kind=\"image\"");
+    (image ? imageHits : textHits).inc();
+    item.ai_detection = match->item->ai_detection;
+    item.moderation = match->item->moderation;
+    item.duplicate_of = match->item->id;
+    MODAI_LOG_DEBUG(item.id + " is a near-duplicate of " + item.duplicate_of +
+                    " (distance " + std::to_string(match->distance) + ")");
+    return true;
+}
+
+void ModerationEngine::rememberNearDuplicate(const ContentItem& item) {
+    if (!textDuplicates_ || !item.duplicate_of.empty()) {
+        return;
+    }
+    
+    uint64_t hash = 0;
+    {
+        std::lock_guard<std::mutex> lock(pendingHashesMutex_);
+        auto it = pendingHashes_.find(item.id);
+        if (it == pendingHashes_.end()) {
+            return;
+        }
+        hash = it->second;
+        pendingHashes_.erase(it);
+    }
+    
+    bool image = item.content_type == "image";
+    // Results a failed or timed-out detector left behind aren't worth reusing
+    if (image ? item.moderation.provider.empty() : item.ai_detection.label == "unknown") {
+        return;
+    }
+    
+    // Only the detector results are reused; drop the payload
+    auto remembered = std::make_shared<ContentItem>(ContentItem::Blank());
+    remembered->id = item.id;
+    remembered->ai_detection = item.ai_detection;
+    remembered->moderation = item.moderation;
+    (image ? imageDuplicates_ : textDuplicates_)->insert(hash, std::move(remembered));
+}
+
+DetectionCacheStats ModerationEngine::cacheStats() const {
+    DetectionCacheStats stats;
+    stats.aiDetectionHits = aiDetectionHits_;
+    stats.aiDetectionMisses = aiDetectionMisses_;
+    stats.textModerationHits = textModerationHits_;
+    stats.textModerationMisses = textModerationMisses_;
+    stats.imageModerationHits = imageModerationHits_;
+    stats.imageModerationMisses = imageModerationMisses_;
+    return stats;
+}
+
 } // namespace ModAI
 
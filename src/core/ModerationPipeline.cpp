@@ -0,0 +1,357 @@
+#include "core/ModerationPipeline.h"
+#include "core/ModerationEngine.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <algorithm>
+
+namespace ModAI {
+
+namespace {
+
+bool isDetectorStage(ModerationPipeline::Stage stage) {
+    return stage == ModerationPipeline::Stage::AIDetection || stage == ModerationPipeline::Stage::Moderation;
+}
+
+// A batch is shared by its items, so it runs until the last of them would
+// stop. Items of one batch come from the same session in practice.
+CancellationToken batchToken(const std::vector<ContentItem>& batch) {
+    CancellationToken token = batch.front().cancellation;
+    for (const auto& item : batch) {
+        if (!item.cancellation.cancellable()) {
+            return CancellationToken();
+        }
+        if (item.cancellation.deadline() > token.deadline()) {
+            token = item.cancellation;
+        }
+    }
+    return token;
+}
+
+} // namespace
+
+ModerationPipeline::ModerationPipeline(ModerationEngine& engine, PipelineConfig config)
+    : engine_(engine)
+    , config_(config) {
+    for (size_t i = 0; i < kStageCount; ++i) {
+        Stage stage = static_cast<Stage>(i);
+        queues_[i] = std::make_unique<BoundedQueue<Queued>>(stageConfig(stage).queueCapacity);
+        std::string label = std::string("stage=\"") + stageName(stage) + "\"";
+        metrics_[i].run = &Metrics::histogram("modai_pipeline_stage_seconds", label);
+        metrics_[i].wait = &Metrics::histogram("modai_pipeline_queue_wait_seconds", label);
+        metrics_[i].depth = &Metrics::gauge("modai_pipeline_queue_depth", label);
+    }
+}
+
+ModerationPipeline::~ModerationPipeline() {
+    stop();
+}
+
+const PipelineStageConfig& ModerationPipeline::stageConfig(Stage stage) const {
+    switch (stage) {
+        case Stage::Ingest: return config_.ingest;
+        case Stage::AIDetection: return config_.aiDetection;
+        case Stage::Moderation: return config_.moderation;
+        case Stage::Rules: return config_.rules;
+        case Stage::Persistence: return config_.persistence;
+        case Stage::Notify: return config_.notify;
+    }
+    return config_.ingest;
+}
+
+const char* ModerationPipeline::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Ingest: return "ingest";
+        case Stage::AIDetection: return "ai_detection";
+        case Stage::Moderation: return "moderation";
+        case Stage::Rules: return "rules";
+        case Stage::Persistence: return "persistence";
+        case Stage::Notify: return "notify";
+    }
+    return "unknown";
+}
+
+void ModerationPipeline::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    int totalWorkers = 0;
+    for (size_t i = 0; i < kStageCount; ++i) {
+        Stage stage = static_cast<Stage>(i);
+        int workers = std::max(1, stageConfig(stage).workers);
+        bool batched = (stage == Stage::AIDetection && config_.aiBatchSize > 1) ||
+                       (stage == Stage::Moderation && config_.moderationBatchSize > 1);
+        for (int w = 0; w < workers; ++w) {
+            workers_[i].emplace_back(batched ? &ModerationPipeline::runBatchWorker
+                                          : &ModerationPipeline::runWorker,
+                                  this, stage);
+        }
+        totalWorkers += workers;
+    }
+    Logger::info("Moderation pipeline started with " + std::to_string(totalWorkers) + " workers");
+}
+
+void ModerationPipeline::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    for (auto& queue : queues_) {
+        queue->close();
+    }
+    for (size_t i = 0; i < kStageCount; ++i) {
+        joinStage(static_cast<Stage>(i));
+    }
+    Logger::info("Moderation pipeline stopped");
+}
+
+void ModerationPipeline::drain() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    // Items only move to later stages, so once a stage's workers have
+    // exited nothing more can arrive downstream of it
+    for (size_t i = 0; i < kStageCount; ++i) {
+        queues_[i]->close();
+        joinStage(static_cast<Stage>(i));
+    }
+    Logger::info("Moderation pipeline drained and stopped");
+}
+
+void ModerationPipeline::joinStage(Stage stage) {
+    auto& workers = workers_[static_cast<size_t>(stage)];
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+bool ModerationPipeline::submit(ContentItem item) {
+    if (!running_) {
+        return false;
+    }
+    return push(Stage::Ingest, std::move(item), true);
+}
+
+bool ModerationPipeline::trySubmit(ContentItem item) {
+    if (!running_) {
+        return false;
+    }
+    if (!push(Stage::Ingest, std::move(item), false)) {
+        Logger::warn("Moderation pipeline ingest queue is full; dropping item");
+        return false;
+    }
+    return true;
+}
+
+void ModerationPipeline::clear() {
+    for (size_t i = 0; i < kStageCount; ++i) {
+        queues_[i]->clear();
+        metrics_[i].depth->set(static_cast<int64_t>(queues_[i]->size()));
+    }
+}
+
+bool ModerationPipeline::push(Stage stage, ContentItem item, bool block) {
+    auto& queue = *queues_[static_cast<size_t>(stage)];
+    Queued queued{std::move(item), std::chrono::steady_clock::now()};
+    bool pushed = block ? queue.push(std::move(queued)) : queue.tryPush(std::move(queued));
+    if (pushed) {
+        metrics_[static_cast<size_t>(stage)].depth->set(static_cast<int64_t>(queue.size()));
+    }
+    return pushed;
+}
+
+void ModerationPipeline::noteDequeued(Stage stage, const Queued& queued) {
+    const StageMetrics& metrics = metrics_[static_cast<size_t>(stage)];
+    metrics.wait->record(std::chrono::steady_clock::now() - queued.enqueued);
+    metrics.depth->set(static_cast<int64_t>(queues_[static_cast<size_t>(stage)]->size()));
+}
+
+size_t ModerationPipeline::queuedCount(Stage stage) const {
+    return queues_[static_cast<size_t>(stage)]->size();
+}
+
+size_t ModerationPipeline::pendingCount() const {
+    size_t total = 0;
+    for (const auto& queue : queues_) {
+        total += queue->size();
+    }
+    return total;
+}
+
+ModerationPipeline::Stage ModerationPipeline::nextStage(Stage stage, ContentItem& item) const {
+    auto moderationOrRules = [this, &item](RuleInputs known) {
+        if (engine_.needsModeration(item, known)) {
+            return Stage::Moderation;
+        }
+        engine_.skipModeration(item);
+        return Stage::Rules;
+    };
+    switch (stage) {
+        case Stage::Ingest:
+            if (!item.duplicate_of.empty()) {
+                // Detector results were copied from an earlier item; Hive
+                // still runs if that item's rules skipped it but these need it
+                return item.moderation.provider == "hive" ? Stage::Rules : moderationOrRules(kAIScoreInput);
+            }
+            if (item.content_type == "text" && item.text.has_value()) {
+                return Stage::AIDetection;
+            }
+            if (item.content_type == "image" && item.image_path.has_value()) {
+                return moderationOrRules(kAIScoreInput);
+            }
+            return Stage::Rules;
+        case Stage::AIDetection:
+            // A failed detection leaves the score unknown to the rules
+            return moderationOrRules(item.ai_detection.label == "unknown" ? 0 : kAIScoreInput);
+        case Stage::Moderation: return Stage::Rules;
+        case Stage::Rules: return Stage::Persistence;
+        case Stage::Persistence: return Stage::Notify;
+        case Stage::Notify: break;
+    }
+    return Stage::Notify;
+}
+
+bool ModerationPipeline::abandoned(Stage stage, ContentItem& item) {
+    static Counter& cancelled = Metrics::counter("modai_pipeline_abandoned_total", "reason=\"cancelled\"");
+    static Counter& overBudget = Metrics::counter("modai_pipeline_abandoned_total", "reason=\"deadline\"");
+    if (item.cancellation.isCancelled()) {
+        cancelled.inc();
+        MODAI_LOG_DEBUG("Dropping " + item.id + ": its session was cancelled");
+        return true;
+    }
+    if (isDetectorStage(stage) && item.cancellation.expired()) {
+        overBudget.inc();
+        Logger::warn(std::string("Latency budget spent before ") + stageName(stage) + " for " + item.id +
+                     "; deciding without it");
+        if (stage == Stage::AIDetection) {
+            item.ai_detection.label = "unknown";
+        }
+    }
+    return false;
+}
+
+bool ModerationPipeline::runStage(Stage stage, ContentItem& item) {
+    TraceSpan span(stageName(stage));
+    ScopedTimer timer(*metrics_[static_cast<size_t>(stage)].run);
+    switch (stage) {
+        case Stage::Ingest:
+            Logger::info("Processing content item: " + item.id);
+            engine_.reuseNearDuplicate(item);
+            break;
+        case Stage::AIDetection:
+            engine_.detectAI(item);
+            break;
+        case Stage::Moderation:
+            engine_.moderate(item);
+            break;
+        case Stage::Rules:
+            engine_.applyRules(item);
+            engine_.rememberNearDuplicate(item);
+            break;
+        case Stage::Persistence:
+            return engine_.persist(item);
+        case Stage::Notify:
+            engine_.notify(item);
+            break;
+    }
+    return true;
+}
+
+void ModerationPipeline::runWorker(Stage stage) {
+    auto& input = *queues_[static_cast<size_t>(stage)];
+    Tracing::setThreadName(stageName(stage));
+
+    while (auto next = input.pop()) {
+        noteDequeued(stage, *next);
+        ContentItem item = std::move(next->item);
+        if (abandoned(stage, item)) {
+            continue;
+        }
+
+        try {
+            // Over budget, the detectors are skipped; later stages still run
+            if (!isDetectorStage(stage) || !item.cancellation.expired()) {
+                CancellationScope scope(item.cancellation);
+                if (!runStage(stage, item)) {
+                    continue;  // Not stored: left unacked for redelivery
+                }
+            }
+        } catch (const std::exception& e) {
+            // A failing stage degrades the item rather than dropping it
+            Logger::error(std::string("Pipeline stage ") + stageName(stage) +
+                          " failed for " + item.id + ": " + e.what());
+        }
+
+        if (!forward(stage, std::move(item))) {
+            break;  // Downstream closed: pipeline is shutting down
+        }
+    }
+}
+
+void ModerationPipeline::runBatchWorker(Stage stage) {
+    auto& input = *queues_[static_cast<size_t>(stage)];
+    Tracing::setThreadName(stageName(stage));
+    bool moderation = stage == Stage::Moderation;
+    size_t batchSize = moderation ? config_.moderationBatchSize : config_.aiBatchSize;
+    auto maxWait = moderation ? config_.moderationBatchMaxWait : config_.aiBatchMaxWait;
+
+    while (true) {
+        auto queued = input.popBatch(batchSize, maxWait);
+        if (queued.empty()) {
+            break;
+        }
+        std::vector<ContentItem> batch;
+        std::vector<ContentItem> overBudget;
+        batch.reserve(queued.size());
+        for (auto& entry : queued) {
+            noteDequeued(stage, entry);
+            if (abandoned(stage, entry.item)) {
+                continue;
+            }
+            (entry.item.cancellation.expired() ? overBudget : batch).push_back(std::move(entry.item));
+        }
+        for (auto& item : overBudget) {
+            if (!forward(stage, std::move(item))) {
+                return;
+            }
+        }
+        if (batch.empty()) {
+            continue;
+        }
+
+        try {
+            CancellationScope scope(batchToken(batch));
+            TraceSpan span(stageName(stage));
+            ScopedTimer timer(*metrics_[static_cast<size_t>(stage)].run);
+            if (moderation) {
+                engine_.moderateBatch(batch);
+            } else {
+                engine_.detectAIBatch(batch);
+            }
+        } catch (const std::exception& e) {
+            Logger::error(std::string("Pipeline stage ") + stageName(stage) +
+                          " failed for batch of " + std::to_string(batch.size()) +
+                          ": " + e.what());
+        }
+
+        for (auto& item : batch) {
+            if (!forward(stage, std::move(item))) {
+                return;
+            }
+        }
+    }
+}
+
+bool ModerationPipeline::forward(Stage stage, ContentItem item) {
+    if (stage == Stage::Notify) {
+        return true;
+    }
+    Stage target = nextStage(stage, item);
+    return push(target, std::move(item), true);
+}
+
+} // namespace ModAI
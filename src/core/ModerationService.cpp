@@ -0,0 +1,678 @@
+#include "core/ModerationService.h"
+#include "core/ConsistentHashRing.h"
+#include "core/ModerationEngine.h"
+#include "core/ResultCache.h"
+#include "core/RuleEngine.h"
+#include "detectors/CoalescingTextModerator.h"
+#include "detectors/HiveImageModerator.h"
+#include "detectors/HiveTextModerator.h"
+#include "detectors/LocalAIDetector.h"
+#include "network/HttpTransport.h"
+#include "network/QtHttpClient.h"
+#include "scraper/RedditScraper.h"
+#include "storage/SegmentStorage.h"
+#ifdef USE_SQLITE
+#include "storage/SqliteStorage.h"
+#endif
+#include "storage/Storage.h"
+#include "utils/Clock.h"
+#include "utils/Crypto.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+namespace ModAI {
+
+namespace {
+
+void readStage(const nlohmann::json& stages, const char* name, PipelineStageConfig& stage) {
+    if (!stages.contains(name) || !stages[name].is_object()) {
+        return;
+    }
+    const auto& j = stages[name];
+    stage.queueCapacity = j.value("queue_capacity", stage.queueCapacity);
+    stage.workers = j.value("workers", stage.workers);
+}
+
+} // namespace
+
+std::string ServiceConfig::defaultDataPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString() + "/data";
+}
+
+std::optional<ServiceConfig> ServiceConfig::fromJsonFile(const std::string& path) {
+    try {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            Logger::error("Could not open config file: " + path);
+            return std::nullopt;
+        }
+        nlohmann::json j;
+        file >> j;
+
+        ServiceConfig config;
+        config.dataPath = j.value("data_path", config.dataPath);
+        config.rulesPath = j.value("rules_path", config.rulesPath);
+        config.modelDir = j.value("model_dir", config.modelDir);
+        config.modelVariant = j.value("model_variant", config.modelVariant);
+        config.logFile = j.value("log_file", config.logFile);
+        config.hiveApiKey = j.value("hive_api_key", config.hiveApiKey);
+        config.redditClientId = j.value("reddit_client_id", config.redditClientId);
+        config.redditClientSecret = j.value("reddit_client_secret", config.redditClientSecret);
+        config.userAgent = j.value("user_agent", config.userAgent);
+        config.subreddits = j.value("subreddits", config.subreddits);
+        config.scrapeIntervalSeconds = j.value("scrape_interval_seconds", config.scrapeIntervalSeconds);
+        if (j.contains("adaptive_polling") && j["adaptive_polling"].is_object()) {
+            const auto& polling = j["adaptive_polling"];
+            auto& options = config.polling;
+            options.adaptive = polling.value("enabled", options.adaptive);
+            options.minInterval = std::chrono::seconds(
+                polling.value("min_interval_seconds", static_cast<int64_t>(options.minInterval.count())));
+            options.maxInterval = std::chrono::seconds(
+                polling.value("max_interval_seconds", static_cast<int64_t>(options.maxInterval.count())));
+            options.targetFill = polling.value("target_fill", options.targetFill);
+            options.budgetShare = polling.value("budget_share", options.budgetShare);
+        }
+        config.onnxIntraOpThreads = j.value("onnx_intra_op_threads", config.onnxIntraOpThreads);
+        config.onnxExecutionProviders = j.value("execution_providers", config.onnxExecutionProviders);
+        config.onnxDeviceId = j.value("onnx_device_id", config.onnxDeviceId);
+        config.warmUpModel = j.value("warm_up_model", config.warmUpModel);
+        if (j.contains("text_chunking") && j["text_chunking"].is_object()) {
+            const auto& chunking = j["text_chunking"];
+            config.chunkLongTexts = chunking.value("enabled", config.chunkLongTexts);
+            config.chunkOverlapTokens = chunking.value("overlap_tokens", config.chunkOverlapTokens);
+            config.maxChunks = chunking.value("max_chunks", config.maxChunks);
+            config.chunkAggregation = chunking.value("aggregation", config.chunkAggregation);
+        }
+        config.watchRules = j.value("watch_rules", config.watchRules);
+        config.resultCache = j.value("result_cache", config.resultCache);
+        config.lazyDetectors = j.value("lazy_detectors", config.lazyDetectors);
+        config.itemBudgetMs = j.value("item_budget_ms", config.itemBudgetMs);
+        if (j.contains("near_duplicates") && j["near_duplicates"].is_object()) {
+            const auto& duplicates = j["near_duplicates"];
+            config.nearDuplicates = duplicates.value("enabled", config.nearDuplicates);
+            config.textDuplicates.maxDistance =
+                duplicates.value("text_max_distance", config.textDuplicates.maxDistance);
+            config.imageDuplicates.maxDistance =
+                duplicates.value("image_max_distance", config.imageDuplicates.maxDistance);
+            config.textDuplicates.capacity = duplicates.value("capacity", config.textDuplicates.capacity);
+            config.imageDuplicates.capacity = config.textDuplicates.capacity;
+        }
+        config.metricsIntervalSeconds = j.value("metrics_interval_seconds", config.metricsIntervalSeconds);
+        if (j.contains("image_store") && j["image_store"].is_object()) {
+            const auto& images = j["image_store"];
+            auto& options = config.imageStore;
+            options.maxBytes = images.value("max_mb", options.maxBytes / (1024 * 1024)) * 1024 * 1024;
+            options.maxAge = std::chrono::hours(
+                images.value("max_age_days", static_cast<int64_t>(options.maxAge.count() / 24)) * 24);
+            options.thumbnailSize = images.value("thumbnail_size", options.thumbnailSize);
+        }
+        if (j.contains("reprocess") && j["reprocess"].is_object()) {
+            const auto& reprocess = j["reprocess"];
+            auto& options = config.reprocess;
+            options.query.subreddit = reprocess.value("subreddit", options.query.subreddit);
+            options.query.fromTimestamp = reprocess.value("since", options.query.fromTimestamp);
+            options.query.toTimestamp = reprocess.value("until", options.query.toTimestamp);
+            options.itemsPerSecond = reprocess.value("items_per_second", options.itemsPerSecond);
+            options.maxInFlight = reprocess.value("max_in_flight", options.maxInFlight);
+            options.checkpointPath = reprocess.value("checkpoint_path", options.checkpointPath);
+            options.checkpointEvery = reprocess.value("checkpoint_every", options.checkpointEvery);
+            options.resubmitAfter = std::chrono::seconds(
+                reprocess.value("resubmit_after_seconds", static_cast<int64_t>(options.resubmitAfter.count())));
+        }
+        if (j.contains("work_queue") && j["work_queue"].is_object()) {
+            const auto& queue = j["work_queue"];
+            auto& wq = config.workQueue;
+            wq.type = queue.value("type", wq.type);
+            wq.capacity = queue.value("capacity", wq.capacity);
+            wq.redisHost = queue.value("redis_host", wq.redisHost);
+            wq.redisPort = queue.value("redis_port", wq.redisPort);
+            wq.stream = queue.value("stream", wq.stream);
+            wq.group = queue.value("group", wq.group);
+            wq.consumer = queue.value("consumer", wq.consumer);
+            wq.maxLength = queue.value("max_length", wq.maxLength);
+            wq.claimIdle = std::chrono::milliseconds(
+                queue.value("claim_idle_ms", static_cast<int64_t>(wq.claimIdle.count())));
+            wq.maxBlock = std::chrono::milliseconds(
+                queue.value("max_block_ms", static_cast<int64_t>(wq.maxBlock.count())));
+            wq.shedPolicy = queue.value("shed_policy", wq.shedPolicy);
+            wq.persist = queue.value("persist", wq.persist);
+            wq.journalPath = queue.value("journal_path", wq.journalPath);
+            wq.backfillAge = std::chrono::seconds(
+                queue.value("backfill_age_seconds", static_cast<int64_t>(wq.backfillAge.count())));
+            if (queue.contains("priority_weights") && queue["priority_weights"].is_object()) {
+                const auto& weights = queue["priority_weights"];
+                wq.priorityWeights[0] = weights.value("fresh", wq.priorityWeights[0]);
+                wq.priorityWeights[1] = weights.value("requested", wq.priorityWeights[1]);
+                wq.priorityWeights[2] = weights.value("backfill", wq.priorityWeights[2]);
+            }
+        }
+        if (j.contains("shard") && j["shard"].is_object()) {
+            const auto& shard = j["shard"];
+            config.shardInstance = shard.value("instance", config.shardInstance);
+            config.shardInstances = shard.value("instances", config.shardInstances);
+        }
+
+        if (j.contains("pipeline") && j["pipeline"].is_object()) {
+            const auto& stages = j["pipeline"];
+            readStage(stages, "ingest", config.pipeline.ingest);
+            readStage(stages, "ai_detection", config.pipeline.aiDetection);
+            readStage(stages, "moderation", config.pipeline.moderation);
+            readStage(stages, "rules", config.pipeline.rules);
+            readStage(stages, "persistence", config.pipeline.persistence);
+            readStage(stages, "notify", config.pipeline.notify);
+            config.pipeline.aiBatchSize = stages.value("ai_batch_size", config.pipeline.aiBatchSize);
+            config.pipeline.moderationBatchSize =
+                stages.value("moderation_batch_size", config.pipeline.moderationBatchSize);
+        }
+        return config;
+    } catch (const std::exception& e) {
+        Logger::error("Failed to parse config " + path + ": " + std::string(e.what()));
+        return std::nullopt;
+    }
+}
+
+ModerationService::ModerationService(ServiceConfig config)
+    : config_(std::move(config)) {
+    if (config_.dataPath.empty()) {
+        config_.dataPath = ServiceConfig::defaultDataPath();
+    }
+    if (config_.modelDir.empty()) {
+        config_.modelDir = config_.dataPath + "/models";
+    }
+    if (config_.modelVariant.empty()) {
+        const char* variant = std::getenv("MODAI_MODEL_VARIANT");
+        config_.modelVariant = variant ? variant : "fp32";
+    }
+    if (config_.modelVariant != "fp32") {
+        std::string path = LocalAIDetector::variantModelPath(config_.modelDir, config_.modelVariant);
+        if (!QFile::exists(QString::fromStdString(path))) {
+            Logger::warn("Model variant " + config_.modelVariant + " not found at " + path + ", using fp32");
+            config_.modelVariant = "fp32";
+        }
+    }
+    QDir().mkpath(QString::fromStdString(config_.dataPath));
+
+    if (config_.hiveApiKey.empty()) {
+        config_.hiveApiKey = Crypto::getApiKey("hive_api_key");
+    }
+    if (config_.redditClientId.empty()) {
+        config_.redditClientId = Crypto::getApiKey("reddit_client_id");
+    }
+    if (config_.redditClientSecret.empty()) {
+        config_.redditClientSecret = Crypto::getApiKey("reddit_client_secret");
+    }
+    if (config_.hiveApiKey.empty()) {
+        Logger::warn("No Hive API key - moderation disabled");
+    }
+
+    // All clients below share one transport; open the API connections early
+    if (!config_.httpClientFactory) {
+        HttpTransport::instance().prewarm({"https://api.thehive.ai",
+                                           "https://oauth.reddit.com",
+                                           "https://www.reddit.com"});
+    }
+
+    // Every LocalAIDetector in the process shares one loaded session via the registry
+    onnxOptions_.intraOpThreads = config_.onnxIntraOpThreads > 0
+        ? config_.onnxIntraOpThreads
+        : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    onnxOptions_.executionProviders = config_.onnxExecutionProviders;
+    onnxOptions_.deviceId = config_.onnxDeviceId;
+    onnxOptions_.warmUp = config_.warmUpModel;
+
+    auto textDetector = std::make_unique<LocalAIDetector>(modelPath(), config_.modelDir, 768, 0.5f, onnxOptions_,
+                                                          LocalAIDetector::LoadMode::Background);
+    textDetector_ = textDetector.get();
+    textDetector_->setChunking(chunkingOptions());
+    textDetector_->whenLoaded([modelDir = config_.modelDir, variant = config_.modelVariant](bool available) {
+        if (available) {
+            Logger::info("Local ONNX AI detector initialized (desklib/ai-text-detector-v1.01, " +
+                         variant + ")");
+        } else {
+            // Kept as a disabled detector; items get no AI score
+            Logger::error("Local AI model not available. Please export the model first:");
+            Logger::error("  python3 scripts/export_model_to_onnx.py --output " + modelDir);
+        }
+    });
+
+    auto imageModerator = std::make_unique<HiveImageModerator>(makeHttpClient(), config_.hiveApiKey);
+    // Single-item calls from concurrent workers are merged into multi-input requests
+    auto textModerator = std::make_unique<CoalescingTextModerator>(
+        std::make_unique<HiveTextModerator>(makeHttpClient(), config_.hiveApiKey));
+
+    rulesPath_ = prepareRules();
+    auto ruleEngine = std::make_unique<RuleEngine>();
+    ruleEngine_ = ruleEngine.get();
+
+    auto storage = openStorage(config_.dataPath);
+    storage_ = storage.get();
+
+    engine_ = std::make_unique<ModerationEngine>(
+        std::move(textDetector),
+        std::move(imageModerator),
+        std::move(textModerator),
+        std::move(ruleEngine),
+        std::move(storage)
+    );
+    engine_->setTextDetectorVariant(config_.modelVariant);
+
+    reloadRules(true);
+    if (config_.watchRules) {
+        watchRules();
+    }
+
+    // Reposts and copypasta reuse earlier detector results
+    if (config_.resultCache) {
+        engine_->setResultCache(std::make_unique<ResultCache>(config_.dataPath + "/cache/results.cache"));
+    }
+
+    // Hive is only called for items whose decision can still depend on it
+    engine_->setLazyDetectors(config_.lazyDetectors);
+    if (config_.nearDuplicates) {
+        engine_->setNearDuplicateDetection(config_.textDuplicates, config_.imageDuplicates);
+    }
+
+    // Stages run concurrently so slow Hive calls don't stall the feed
+    pipeline_ = std::make_unique<ModerationPipeline>(*engine_, config_.pipeline);
+
+    scraper_ = std::make_unique<RedditScraper>(
+        makeHttpClient(),
+        config_.redditClientId,
+        config_.redditClientSecret,
+        config_.userAgent,
+        config_.dataPath
+    );
+    scraper_->setImageModerator(std::make_unique<HiveImageModerator>(makeHttpClient(), config_.hiveApiKey));
+    scraper_->setPollingOptions(config_.polling);
+    scraper_->imageStore().setOptions(config_.imageStore);
+
+    // Delivered items are acked once stored, i.e. when they reach notify
+    if (config_.workQueue.consumer.empty()) {
+        config_.workQueue.consumer = config_.shardInstance;
+    }
+    if (!config_.workQueue.persist) {
+        config_.workQueue.journalPath.clear();
+    } else if (config_.workQueue.journalPath.empty()) {
+        config_.workQueue.journalPath = config_.dataPath + "/queue/ingest.journal";
+    }
+    workQueue_ = makeWorkQueue(config_.workQueue);
+    engine_->setOnItemProcessed([this](const ContentItem& item) {
+        acknowledge(item);
+        releaseImage(item);
+        if (auto job = reprocessJob()) {
+            job->itemProcessed(item);
+        }
+        if (onItemProcessed_) {
+            onItemProcessed_(item);
+        }
+    });
+
+    scraper_->setOnItemScraped([this](const ContentItem& item) {
+        // A full queue holds up the listing thread for a while, slowing the
+        // scrape cycle, before the scheduler sheds something
+        auto backfillBefore = formatTimestamp(std::chrono::system_clock::now() - config_.workQueue.backfillAge);
+        auto priority = item.timestamp < backfillBefore ? WorkPriority::Backfill : WorkPriority::Fresh;
+        if (!workQueue_->publish(item, priority)) {
+            static Counter& rejected = Metrics::counter("modai_pipeline_rejected_total");
+            rejected.inc();
+            releaseImage(item);
+            MODAI_LOG_DEBUG("Work queue full, dropped " + item.id);
+        }
+    });
+}
+
+ModerationService::~ModerationService() {
+    stop(false);
+}
+
+std::unique_ptr<HttpClient> ModerationService::makeHttpClient() const {
+    if (config_.httpClientFactory) {
+        return config_.httpClientFactory();
+    }
+    return std::make_unique<QtHttpClient>();
+}
+
+std::string ModerationService::prepareRules() const {
+    std::string rulesPath = config_.rulesPath.empty() ? config_.dataPath + "/rules.json" : config_.rulesPath;
+
+    // Copy default rules if not exists
+    if (!QFile::exists(QString::fromStdString(rulesPath))) {
+        QFile defaultRules("../config/rules.json");
+        if (!defaultRules.exists()) {
+            // Try alternative path
+            defaultRules.setFileName("config/rules.json");
+        }
+        if (defaultRules.exists()) {
+            defaultRules.copy(QString::fromStdString(rulesPath));
+        }
+    }
+    return rulesPath;
+}
+
+void ModerationService::watchRules() {
+    rulesWatcher_ = std::make_unique<QFileSystemWatcher>();
+    rulesReloadTimer_ = std::make_unique<QTimer>();
+    rulesReloadTimer_->setSingleShot(true);
+    rulesReloadTimer_->setInterval(kRulesReloadDelayMs);
+    QTimer* timer = rulesReloadTimer_.get();
+    QObject::connect(timer, &QTimer::timeout, timer, [this]() { reloadRules(); });
+
+    // Editors save by writing a new file and renaming it over the old one,
+    // which drops the file from the watch; its directory notices the rename
+    QString file = QString::fromStdString(rulesPath_);
+    rulesWatcher_->addPath(QFileInfo(file).absolutePath());
+    if (QFile::exists(file)) {
+        rulesWatcher_->addPath(file);
+    }
+    QObject::connect(rulesWatcher_.get(), &QFileSystemWatcher::fileChanged, timer, [timer]() { timer->start(); });
+    QObject::connect(rulesWatcher_.get(), &QFileSystemWatcher::directoryChanged, timer, [timer]() { timer->start(); });
+}
+
+void ModerationService::reloadRules(bool initial) {
+    QString file = QString::fromStdString(rulesPath_);
+    if (rulesWatcher_ && QFile::exists(file) && !rulesWatcher_->files().contains(file)) {
+        rulesWatcher_->addPath(file);
+    }
+    // The directory also changes for unrelated files (the database, logs)
+    QFileInfo info(file);
+    int64_t modified = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+    int64_t size = info.exists() ? info.size() : -1;
+    if (!initial && modified == rulesModified_ && size == rulesSize_) {
+        return;
+    }
+    rulesModified_ = modified;
+    rulesSize_ = size;
+
+    static Counter& reloaded = Metrics::counter("modai_rule_reloads_total", "result=\"ok\"");
+    static Counter& failed = Metrics::counter("modai_rule_reloads_total", "result=\"failed\"");
+    if (ruleEngine_->loadRulesFromJson(rulesPath_)) {
+        if (!initial) {
+            reloaded.inc();
+        }
+    } else if (!initial) {
+        failed.inc();
+        Logger::warn("Keeping the previous rules; " + rulesPath_ + " could not be loaded");
+    }
+}
+
+std::unique_ptr<Storage> ModerationService::openStorage(const std::string& dataPath) {
+    // History from older versions is imported once
+#ifdef USE_SQLITE
+    auto storage = std::make_unique<SqliteStorage>(dataPath + "/modai.db");
+    if (storage->empty()) {
+        size_t imported = 0;
+        if (QDir(QString::fromStdString(dataPath + "/segments")).exists()) {
+            SegmentStorage segments(dataPath);
+            imported = storage->importFrom(segments);
+        } else if (QFile::exists(QString::fromStdString(dataPath + "/content.jsonl"))) {
+            imported = storage->importJsonl(dataPath + "/content.jsonl", dataPath + "/actions.jsonl");
+        }
+        if (imported > 0) {
+            Logger::info("Imported " + std::to_string(imported) + " records into SQLite storage");
+        }
+    }
+#else
+    auto storage = std::make_unique<SegmentStorage>(dataPath);
+    if (storage->empty() && QFile::exists(QString::fromStdString(dataPath + "/content.jsonl"))) {
+        size_t imported = storage->importJsonl(dataPath + "/content.jsonl", dataPath + "/actions.jsonl");
+        Logger::info("Imported " + std::to_string(imported) + " JSONL records into segment storage");
+    }
+#endif
+    return storage;
+}
+
+LocalAIDetector::ChunkingOptions ModerationService::chunkingOptions() const {
+    using Aggregation = LocalAIDetector::ChunkingOptions::Aggregation;
+    LocalAIDetector::ChunkingOptions options;
+    options.enabled = config_.chunkLongTexts;
+    options.overlapTokens = config_.chunkOverlapTokens;
+    options.maxChunks = config_.maxChunks;
+    if (config_.chunkAggregation == "max") {
+        options.aggregation = Aggregation::Max;
+    } else if (config_.chunkAggregation == "mean") {
+        options.aggregation = Aggregation::Mean;
+    } else {
+        if (config_.chunkAggregation != "length_weighted") {
+            Logger::warn("Unknown chunk aggregation '" + config_.chunkAggregation + "', using length_weighted");
+        }
+        options.aggregation = Aggregation::LengthWeighted;
+    }
+    return options;
+}
+
+std::string ModerationService::modelPath() const {
+    return LocalAIDetector::variantModelPath(config_.modelDir, config_.modelVariant);
+}
+
+bool ModerationService::textDetectorAvailable() const {
+    return textDetector_->isAvailable();
+}
+
+void ModerationService::whenTextDetectorLoaded(std::function<void(bool available)> callback) {
+    textDetector_->whenLoaded(std::move(callback));
+}
+
+void ModerationService::setOnItemProcessed(std::function<void(const ContentItem&)> callback) {
+    onItemProcessed_ = std::move(callback);
+}
+
+void ModerationService::start() {
+    pipeline_->start();
+    consumer_ = std::thread([this] { consume(); });
+}
+
+void ModerationService::consume() {
+    static Counter& duplicates = Metrics::counter("modai_work_queue_duplicates_total");
+    while (true) {
+        // Small batches, so priorities still apply to what waits behind them
+        auto deliveries = workQueue_->receive(16, std::chrono::milliseconds(1000));
+        if (deliveries.empty()) {
+            if (workQueue_->isClosed()) {
+                return;
+            }
+            continue;
+        }
+        for (auto& delivery : deliveries) {
+            // Unreadable entries, and redeliveries that were stored before,
+            // are done; storage is keyed by id so a late duplicate is harmless.
+            // Reprocessed items are always stored already.
+            if (delivery.item.id.empty() ||
+                (delivery.redelivered && !delivery.item.reprocess && storage_->findContent(delivery.item.id))) {
+                duplicates.inc();
+                workQueue_->ack(delivery.token);
+                continue;
+            }
+            if (!delivery.token.empty()) {
+                std::lock_guard<std::mutex> lock(pendingAcksMutex_);
+                pendingAcks_[delivery.item.id].push_back(delivery.token);
+            }
+            // Tokens don't survive the queue; the budget starts here
+            delivery.item.cancellation = sessionToken();
+            if (config_.itemBudgetMs > 0) {
+                delivery.item.cancellation = delivery.item.cancellation.withTimeout(
+                    std::chrono::milliseconds(config_.itemBudgetMs));
+            }
+            if (!pipeline_->submit(std::move(delivery.item))) {
+                // Stopped; unacked deliveries come back after a restart or
+                // are reclaimed by another instance
+                return;
+            }
+        }
+    }
+}
+
+void ModerationService::releaseImage(const ContentItem& item) {
+    // Pinned by the scraper when it downloaded the image. Reprocessed items
+    // never took a pin, and the store is content-addressed, so releasing
+    // for them could drop a live item's.
+    if (item.content_type == "image" && item.image_path.has_value() && !item.reprocess) {
+        scraper_->imageStore().release(*item.image_path);
+    }
+}
+
+bool ModerationService::startReprocessing(ReprocessOptions options, ReprocessJob::FinishedCallback onFinished) {
+    std::shared_ptr<ReprocessJob> previous;  // joined after unlocking
+    std::lock_guard<std::mutex> lock(reprocessMutex_);
+    if (reprocess_ && !reprocess_->finished()) {
+        Logger::warn("Reprocessing is already running");
+        return false;
+    }
+    if (options.checkpointPath.empty()) {
+        options.checkpointPath = config_.dataPath + "/cache/reprocess.checkpoint";
+    }
+    auto job = std::make_shared<ReprocessJob>(*storage_, [this](const ContentItem& item) {
+        return workQueue_->publish(item, WorkPriority::Backfill);
+    }, std::move(options));
+    if (onFinished) {
+        job->setOnFinished(std::move(onFinished));
+    }
+    previous = std::exchange(reprocess_, job);
+    job->start();
+    return true;
+}
+
+void ModerationService::cancelReprocessing() {
+    auto job = reprocessJob();
+    if (job) {
+        job->cancel();
+        job->wait();
+    }
+}
+
+std::shared_ptr<ReprocessJob> ModerationService::reprocessJob() const {
+    std::lock_guard<std::mutex> lock(reprocessMutex_);
+    return reprocess_;
+}
+
+CancellationToken ModerationService::sessionToken() const {
+    std::lock_guard<std::mutex> lock(sessionMutex_);
+    return session_.token();
+}
+
+void ModerationService::cancelSession() {
+    CancellationSource session;
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex_);
+        std::swap(session, session_);
+    }
+    // Outside the lock: cancelling runs callbacks, e.g. HTTP aborts
+    session.cancel();
+}
+
+void ModerationService::acknowledge(const ContentItem& item) {
+    std::string token;
+    {
+        std::lock_guard<std::mutex> lock(pendingAcksMutex_);
+        auto it = pendingAcks_.find(item.id);
+        if (it == pendingAcks_.end()) {
+            return;
+        }
+        token = std::move(it->second.front());
+        it->second.erase(it->second.begin());
+        if (it->second.empty()) {
+            pendingAcks_.erase(it);
+        }
+    }
+    workQueue_->ack(token);
+}
+
+std::vector<std::string> ModerationService::ownedSubreddits(const std::vector<std::string>& subreddits) const {
+    if (config_.shardInstance.empty() || config_.shardInstances.empty()) {
+        return subreddits;
+    }
+    auto instances = config_.shardInstances;
+    if (std::find(instances.begin(), instances.end(), config_.shardInstance) == instances.end()) {
+        Logger::warn("Shard instance " + config_.shardInstance + " is not listed in shard.instances; adding it");
+        instances.push_back(config_.shardInstance);
+    }
+    ConsistentHashRing ring(std::move(instances));
+    std::vector<std::string> owned;
+    for (const auto& subreddit : subreddits) {
+        if (ring.owns(config_.shardInstance, subreddit)) {
+            owned.push_back(subreddit);
+        }
+    }
+    return owned;
+}
+
+void ModerationService::startScraping(const std::vector<std::string>& subreddits, int intervalSeconds) {
+    auto owned = ownedSubreddits(subreddits);
+    if (owned.size() != subreddits.size()) {
+        Logger::info("Shard " + config_.shardInstance + " scrapes " + std::to_string(owned.size()) + " of " +
+                     std::to_string(subreddits.size()) + " subreddits");
+    }
+    if (owned.empty()) {
+        // Still moderates what the other shards publish
+        return;
+    }
+    scraper_->setSubreddits(owned);
+    scraper_->start(intervalSeconds);
+}
+
+void ModerationService::stopScraping(bool dropQueued) {
+    if (scraper_->isScraping()) {
+        scraper_->stop();
+    }
+    if (dropQueued) {
+        workQueue_->clear();
+        pipeline_->clear();
+        // Items workers already hold, and their HTTP calls, stop too
+        cancelSession();
+        // The in-process queue forgot them; a shared one hands them out again later
+        std::lock_guard<std::mutex> lock(pendingAcksMutex_);
+        pendingAcks_.clear();
+    }
+}
+
+void ModerationService::stop(bool drain) {
+    if (stopped_) {
+        return;
+    }
+    stopped_ = true;
+
+    // Submits nothing more; what it already queued finishes like the rest
+    cancelReprocessing();
+    stopScraping(false);
+    workQueue_->close();
+    if (drain) {
+        // The consumer hands over what the in-process queue still holds first
+        if (consumer_.joinable()) {
+            consumer_.join();
+        }
+        pipeline_->drain();
+    } else {
+        cancelSession();
+        pipeline_->stop();
+        if (consumer_.joinable()) {
+            consumer_.join();
+        }
+    }
+
+    auto stats = engine_->cacheStats();
+    Logger::info("Detection cache - AI: " + std::to_string(stats.aiDetectionHits) + " hits / " +
+                 std::to_string(stats.aiDetectionMisses) + " misses, text moderation: " +
+                 std::to_string(stats.textModerationHits) + " / " +
+                 std::to_string(stats.textModerationMisses) + ", image moderation: " +
+                 std::to_string(stats.imageModerationHits) + " / " +
+                 std::to_string(stats.imageModerationMisses));
+    auto http = HttpTransport::instance().stats();
+    Logger::info("HTTP transport - requests: " + std::to_string(http.requests) +
+                 ", TLS handshakes: " + std::to_string(http.tlsHandshakes) +
+                 ", reused connections: " + std::to_string(http.reusedConnections) +
+                 ", HTTP/2 responses: " + std::to_string(http.http2Responses) +
+                 ", queued for pool: " + std::to_string(http.queuedForPool));
+}
+
+} // namespace ModAI
@@ -0,0 +1,204 @@
+#include "core/NearDuplicateIndex.h"
+#include <QImage>
+#include <QImageReader>
+#include <QSize>
+#include <QString>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <mutex>
+#include <string_view>
+
+namespace ModAI {
+
+namespace {
+
+uint64_t fnv1a(std::string_view text) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// FNV's low bits are weak; SimHash needs every bit independent
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// Case-folded words; ASCII punctuation separates, other UTF-8 bytes are word characters
+std::vector<std::string> normalizedWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (unsigned char c : text) {
+        if (c >= 0x80 || std::isalnum(c)) {
+            word.push_back(static_cast<char>(std::tolower(c)));
+        } else if (!word.empty()) {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+} // namespace
+
+NearDuplicateIndex::NearDuplicateIndex(NearDuplicateOptions options)
+    : options_(options) {
+    options_.maxDistance = std::clamp(options_.maxDistance, 0, 7);
+    options_.capacity = std::max<size_t>(1, options_.capacity);
+    bands_ = options_.maxDistance + 1;
+    bandBits_ = (64 + bands_ - 1) / bands_;
+    buckets_.resize(static_cast<size_t>(bands_));
+}
+
+int NearDuplicateIndex::distance(uint64_t a, uint64_t b) {
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+uint64_t NearDuplicateIndex::bandValue(uint64_t hash, int band) const {
+    int shift = band * bandBits_;
+    int bits = std::min(bandBits_, 64 - shift);
+    uint64_t mask = bits >= 64 ? ~0ull : ((1ull << bits) - 1);
+    return (hash >> shift) & mask;
+}
+
+std::optional<NearDuplicateIndex::Match> NearDuplicateIndex::find(uint64_t hash) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::optional<Match> best;
+    for (int band = 0; band < bands_; ++band) {
+        const auto& buckets = buckets_[static_cast<size_t>(band)];
+        auto it = buckets.find(bandValue(hash, band));
+        if (it == buckets.end()) {
+            continue;
+        }
+        for (uint64_t sequence : it->second) {
+            const Entry& entry = entries_[static_cast<size_t>(sequence - firstSequence_)];
+            int d = distance(hash, entry.hash);
+            if (d <= options_.maxDistance && (!best || d < best->distance)) {
+                best = Match{entry.item, d};
+                if (d == 0) {
+                    return best;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void NearDuplicateIndex::insert(uint64_t hash, ContentItemPtr item) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (entries_.size() >= options_.capacity) {
+        evictOldest();
+    }
+    uint64_t sequence = firstSequence_ + entries_.size();
+    entries_.push_back(Entry{hash, std::move(item), sequence});
+    for (int band = 0; band < bands_; ++band) {
+        buckets_[static_cast<size_t>(band)][bandValue(hash, band)].push_back(sequence);
+    }
+}
+
+void NearDuplicateIndex::evictOldest() {
+    const Entry& oldest = entries_.front();
+    for (int band = 0; band < bands_; ++band) {
+        auto& buckets = buckets_[static_cast<size_t>(band)];
+        auto it = buckets.find(bandValue(oldest.hash, band));
+        if (it == buckets.end()) {
+            continue;
+        }
+        // Sequences are appended in order, so the oldest is at the front
+        auto& sequences = it->second;
+        sequences.erase(std::find(sequences.begin(), sequences.end(), oldest.sequence));
+        if (sequences.empty()) {
+            buckets.erase(it);
+        }
+    }
+    entries_.pop_front();
+    ++firstSequence_;
+}
+
+size_t NearDuplicateIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void NearDuplicateIndex::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    firstSequence_ += entries_.size();
+    entries_.clear();
+    for (auto& buckets : buckets_) {
+        buckets.clear();
+    }
+}
+
+std::optional<uint64_t> NearDuplicateIndex::textHash(const std::string& text, size_t minWords) {
+    auto words = normalizedWords(text);
+    if (words.empty() || words.size() < minWords) {
+        return std::nullopt;
+    }
+
+    // Character 5-grams of the normalized text: an edited word only
+    // disturbs the few grams overlapping it
+    std::string normalized;
+    for (const auto& word : words) {
+        if (!normalized.empty()) {
+            normalized.push_back(' ');
+        }
+        normalized += word;
+    }
+    constexpr size_t kShingle = 5;
+    std::array<int, 64> weights{};
+    size_t shingles = normalized.size() >= kShingle ? normalized.size() - kShingle + 1 : 1;
+    for (size_t i = 0; i < shingles; ++i) {
+        uint64_t h = mix(fnv1a(std::string_view(normalized).substr(i, kShingle)));
+        for (int bit = 0; bit < 64; ++bit) {
+            weights[static_cast<size_t>(bit)] += (h >> bit) & 1 ? 1 : -1;
+        }
+    }
+
+    uint64_t hash = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (weights[static_cast<size_t>(bit)] > 0) {
+            hash |= 1ull << bit;
+        }
+    }
+    return hash;
+}
+
+std::optional<uint64_t> NearDuplicateIndex::imageHash(const QImage& image) {
+    if (image.isNull()) {
+        return std::nullopt;
+    }
+    QImage small = image.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                       .convertToFormat(QImage::Format_Grayscale8);
+    uint64_t hash = 0;
+    int bit = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uchar* row = small.constScanLine(y);
+        for (int x = 0; x < 8; ++x, ++bit) {
+            if (row[x] > row[x + 1]) {
+                hash |= 1ull << bit;
+            }
+        }
+    }
+    return hash;
+}
+
+std::optional<uint64_t> NearDuplicateIndex::imageHash(const std::string& path) {
+    // JPEG decodes straight to a reduced size, far cheaper than full resolution
+    QImageReader reader(QString::fromStdString(path));
+    reader.setScaledSize(QSize(64, 64));
+    return imageHash(reader.read());
+}
+
+} // namespace ModAI
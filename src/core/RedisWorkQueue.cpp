@@ -0,0 +1,244 @@
+#include "core/RedisWorkQueue.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <QCoreApplication>
+#include <QSysInfo>
+#include <cstdarg>
+#include <cstring>
+#include <thread>
+#include <hiredis/hiredis.h>
+
+namespace ModAI {
+
+namespace {
+
+struct ReplyDeleter {
+    void operator()(redisReply* reply) const {
+        if (reply) {
+            freeReplyObject(reply);
+        }
+    }
+};
+using ReplyPtr = std::unique_ptr<redisReply, ReplyDeleter>;
+
+ReplyPtr command(redisContext* context, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    void* reply = redisvCommand(context, format, args);
+    va_end(args);
+    return ReplyPtr(static_cast<redisReply*>(reply));
+}
+
+bool isError(const ReplyPtr& reply, const char* prefix = nullptr) {
+    if (!reply || reply->type != REDIS_REPLY_ERROR) {
+        return false;
+    }
+    return !prefix || std::strncmp(reply->str, prefix, std::strlen(prefix)) == 0;
+}
+
+timeval toTimeval(std::chrono::milliseconds ms) {
+    timeval tv;
+    tv.tv_sec = static_cast<long>(ms.count() / 1000);
+    tv.tv_usec = static_cast<long>((ms.count() % 1000) * 1000);
+    return tv;
+}
+
+} // namespace
+
+RedisWorkQueue::RedisWorkQueue(WorkQueueConfig config)
+    : config_(std::move(config)) {
+    if (config_.consumer.empty()) {
+        config_.consumer = QSysInfo::machineHostName().toStdString() + ":" +
+                           std::to_string(QCoreApplication::applicationPid());
+    }
+}
+
+RedisWorkQueue::~RedisWorkQueue() {
+    reset(writer_);
+    reset(reader_);
+}
+
+void RedisWorkQueue::reset(redisContext*& context) {
+    if (context) {
+        redisFree(context);
+        context = nullptr;
+    }
+}
+
+redisContext* RedisWorkQueue::open() {
+    redisContext* context = redisConnectWithTimeout(config_.redisHost.c_str(), config_.redisPort,
+                                                    toTimeval(std::chrono::seconds(2)));
+    if (!context || context->err) {
+        Logger::error("Redis connection failed: " + std::string(context ? context->errstr : "out of memory"));
+        reset(context);
+        return nullptr;
+    }
+    return context;
+}
+
+bool RedisWorkQueue::ensureGroup(redisContext* context) {
+    // Starts at the end of the stream; MKSTREAM so the first instance can create it
+    auto reply = command(context, "XGROUP CREATE %s %s $ MKSTREAM", config_.stream.c_str(), config_.group.c_str());
+    if (!reply) {
+        return false;
+    }
+    if (isError(reply) && !isError(reply, "BUSYGROUP")) {
+        Logger::error("Could not create Redis consumer group " + config_.group + ": " + reply->str);
+        return false;
+    }
+    return true;
+}
+
+bool RedisWorkQueue::connect() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!writer_) {
+        writer_ = open();
+    }
+    groupReady_ = writer_ && ensureGroup(writer_);
+    return groupReady_;
+}
+
+bool RedisWorkQueue::publish(const ContentItem& item, WorkPriority) {
+    if (closed_) {
+        return false;
+    }
+    std::string json = item.toJson();
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!writer_ && !(writer_ = open())) {
+        return false;
+    }
+    // Approximate trimming is O(1); the stream is a buffer, not the archive
+    auto reply = command(writer_, "XADD %s MAXLEN ~ %zu * item %b", config_.stream.c_str(), config_.maxLength,
+                         json.data(), json.size());
+    if (!reply) {
+        Logger::error("Redis XADD failed: " + std::string(writer_->errstr));
+        reset(writer_);
+        return false;
+    }
+    if (isError(reply)) {
+        Logger::error("Redis XADD failed: " + std::string(reply->str));
+        return false;
+    }
+    return true;
+}
+
+void RedisWorkQueue::collectEntries(const redisReply* entries, std::vector<WorkDelivery>& out) {
+    if (!entries || entries->type != REDIS_REPLY_ARRAY) {
+        return;
+    }
+    for (size_t i = 0; i < entries->elements; ++i) {
+        const redisReply* entry = entries->element[i];
+        if (entry->type != REDIS_REPLY_ARRAY || entry->elements < 2 ||
+            entry->element[0]->type != REDIS_REPLY_STRING) {
+            continue;
+        }
+        WorkDelivery delivery;
+        delivery.token.assign(entry->element[0]->str, entry->element[0]->len);
+        const redisReply* fields = entry->element[1];
+        bool parsed = false;
+        // Fields are nil for entries trimmed away while pending
+        if (fields->type == REDIS_REPLY_ARRAY) {
+            for (size_t f = 0; f + 1 < fields->elements; f += 2) {
+                if (std::string(fields->element[f]->str, fields->element[f]->len) != "item") {
+                    continue;
+                }
+                try {
+                    delivery.item = ContentItem::fromJson(
+                        std::string(fields->element[f + 1]->str, fields->element[f + 1]->len));
+                    parsed = !delivery.item.id.empty();
+                } catch (const std::exception& e) {
+                    Logger::error("Bad work queue entry " + delivery.token + ": " + std::string(e.what()));
+                }
+            }
+        }
+        if (!parsed) {
+            // Still handed out so the consumer acks it and it stops coming back
+            delivery.item = ContentItem();
+        }
+        out.push_back(std::move(delivery));
+    }
+}
+
+std::vector<WorkDelivery> RedisWorkQueue::receive(size_t maxItems, std::chrono::milliseconds wait) {
+    std::vector<WorkDelivery> deliveries;
+    if (closed_) {
+        return deliveries;
+    }
+    if (!reader_) {
+        if (!(reader_ = open())) {
+            // Don't spin while Redis is down
+            std::this_thread::sleep_for(wait);
+            return deliveries;
+        }
+        redisSetTimeout(reader_, toTimeval(wait + std::chrono::seconds(5)));
+    }
+    if (!groupReady_) {
+        groupReady_ = ensureGroup(reader_);
+    }
+
+    // Entries a dead consumer never acked come first
+    auto claimed = command(reader_, "XAUTOCLAIM %s %s %s %lld 0-0 COUNT %zu", config_.stream.c_str(),
+                           config_.group.c_str(), config_.consumer.c_str(),
+                           static_cast<long long>(config_.claimIdle.count()), maxItems);
+    if (isError(claimed)) {
+        static std::once_flag warned;
+        std::call_once(warned, [&] {
+            Logger::warn("XAUTOCLAIM failed (Redis 6.2+ needed), stale entries won't be reclaimed: " +
+                         std::string(claimed->str));
+        });
+    } else if (claimed && claimed->type == REDIS_REPLY_ARRAY && claimed->elements >= 2) {
+        collectEntries(claimed->element[1], deliveries);
+        for (auto& delivery : deliveries) {
+            delivery.redelivered = true;
+        }
+        if (!deliveries.empty()) {
+            static Counter& reclaimed = Metrics::counter("modai_work_queue_reclaimed_total");
+            reclaimed.inc(deliveries.size());
+            return deliveries;
+        }
+    }
+
+    auto reply = command(reader_, "XREADGROUP GROUP %s %s COUNT %zu BLOCK %lld STREAMS %s >",
+                         config_.group.c_str(), config_.consumer.c_str(), maxItems,
+                         static_cast<long long>(wait.count()), config_.stream.c_str());
+    if (!reply) {
+        Logger::error("Redis XREADGROUP failed: " + std::string(reader_->errstr));
+        reset(reader_);
+        return deliveries;
+    }
+    if (isError(reply, "NOGROUP")) {
+        // The stream was deleted; recreate it on the next call
+        groupReady_ = false;
+        return deliveries;
+    }
+    if (reply->type != REDIS_REPLY_ARRAY) {
+        return deliveries;  // nil: timed out
+    }
+    for (size_t s = 0; s < reply->elements; ++s) {
+        const redisReply* stream = reply->element[s];
+        if (stream->type == REDIS_REPLY_ARRAY && stream->elements >= 2) {
+            collectEntries(stream->element[1], deliveries);
+        }
+    }
+    return deliveries;
+}
+
+void RedisWorkQueue::ack(const std::string& token) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!writer_ && !(writer_ = open())) {
+        // Left pending; another consumer reclaims it and skips it as already stored
+        return;
+    }
+    auto reply = command(writer_, "XACK %s %s %s", config_.stream.c_str(), config_.group.c_str(), token.c_str());
+    if (!reply) {
+        Logger::error("Redis XACK failed: " + std::string(writer_->errstr));
+        reset(writer_);
+    }
+}
+
+void RedisWorkQueue::close() {
+    // The consumer thread's blocking read returns within its wait
+    closed_ = true;
+}
+
+} // namespace ModAI
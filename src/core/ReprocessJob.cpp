@@ -0,0 +1,351 @@
+#include "core/ReprocessJob.h"
+#include "network/RateLimiter.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace ModAI {
+
+namespace {
+
+constexpr size_t kPageSize = 500;
+constexpr auto kRetryDelay = std::chrono::milliseconds(500);
+
+nlohmann::json queryJson(const ContentQuery& query) {
+    return {{"subreddit", query.subreddit}, {"status", query.status}, {"from", query.fromTimestamp},
+            {"to", query.toTimestamp}, {"text", query.text}};
+}
+
+} // namespace
+
+ReprocessJob::ReprocessJob(Storage& storage, Submit submit, ReprocessOptions options)
+    : storage_(storage)
+    , submit_(std::move(submit))
+    , options_(std::move(options)) {
+    options_.query.newestFirst = false;
+    options_.maxInFlight = std::max<size_t>(1, options_.maxInFlight);
+    options_.checkpointEvery = std::max<size_t>(1, options_.checkpointEvery);
+}
+
+ReprocessJob::~ReprocessJob() {
+    cancel();
+    wait();
+}
+
+void ReprocessJob::setOnProgress(ProgressCallback callback) {
+    onProgress_ = std::move(callback);
+}
+
+void ReprocessJob::setOnFinished(FinishedCallback callback) {
+    onFinished_ = std::move(callback);
+}
+
+void ReprocessJob::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ReprocessJob::cancel() {
+    cancellation_.cancel();
+    changed_.notify_all();
+}
+
+void ReprocessJob::wait() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t ReprocessJob::total() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+size_t ReprocessJob::done() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return done_;
+}
+
+void ReprocessJob::itemProcessed(const ContentItem& item) {
+    static Counter& reprocessed = Metrics::counter("modai_reprocess_items_total");
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Live items pass through here too
+    if (inFlight_.erase(item.id) == 0) {
+        return;
+    }
+    reprocessed.inc();
+    completed_.insert(item.id);
+    ++done_;
+    advanceWatermarkLocked();
+    changed_.notify_all();
+}
+
+void ReprocessJob::advanceWatermarkLocked() {
+    while (!order_.empty() && completed_.erase(order_.front().second) > 0) {
+        watermark_ = order_.front().first + 1;
+        order_.pop_front();
+    }
+}
+
+void ReprocessJob::run() {
+    CancellationToken token = cancellation_.token();
+    size_t position = 0;
+    size_t total = 0;
+    size_t done = 0;
+    std::string error;
+
+    try {
+        // A resumed run keeps to the records its first scan counted; later
+        // ones include the versions it wrote itself
+        bool resumed = loadCheckpoint(position, total, done);
+        if (!resumed) {
+            position = 0;
+            done = 0;
+        }
+        std::unordered_map<std::string, size_t> latest;
+        size_t counted = indexRecords(resumed ? total : std::numeric_limits<size_t>::max(), latest);
+        if (token.isCancelled()) {
+            // A partial count must not end up in a checkpoint
+            finished_ = true;
+            if (onFinished_) {
+                onFinished_(done, true, "");
+            }
+            return;
+        }
+        total = counted;
+        position = std::min(position, total);
+        if (resumed) {
+            Logger::info("Resuming reprocessing at record " + std::to_string(position) + " of " +
+                         std::to_string(total));
+        } else {
+            Logger::info("Reprocessing " + std::to_string(latest.size()) + " items (" +
+                         std::to_string(total) + " stored records)");
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            total_ = total;
+            done_ = done;
+            watermark_ = position;
+            lastCheckpoint_ = position;
+        }
+
+        // The budget only paces submissions; the pipeline's own limits
+        // still apply to the Hive calls they lead to
+        std::unique_ptr<RateLimiter> limiter;
+        if (options_.itemsPerSecond > 0.0) {
+            int perSecond = std::max(1, static_cast<int>(std::ceil(options_.itemsPerSecond)));
+            limiter = std::make_unique<RateLimiter>(
+                perSecond, std::chrono::milliseconds(static_cast<int64_t>(1000.0 * perSecond / options_.itemsPerSecond)));
+        }
+
+        auto cursor = storage_.openCursor(options_.query);
+        size_t record = 0;
+        while (!token.isCancelled() && record < total) {
+            std::vector<ContentItem> page = cursor->next(kPageSize);
+            if (page.empty()) {
+                break;
+            }
+            for (auto& item : page) {
+                if (record >= total || token.isCancelled()) {
+                    break;
+                }
+                const size_t current = record;
+                auto newest = latest.find(item.id);
+                // Only an item's latest version is re-run
+                if (current < position || newest == latest.end() || newest->second != current) {
+                    if (current >= position) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (order_.empty()) {
+                            watermark_ = current + 1;
+                        }
+                    }
+                    ++record;
+                    continue;
+                }
+                if (!waitForRoom(false) || (limiter && !limiter->acquire(token)) ||
+                    !submitItem(std::move(item), current)) {
+                    break;
+                }
+                ++record;
+            }
+
+            size_t watermark;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (order_.empty()) {
+                    watermark_ = std::max(watermark_, std::min(record, total));
+                }
+                watermark = watermark_;
+                done = done_;
+            }
+            if (watermark - lastCheckpoint_ >= options_.checkpointEvery) {
+                saveCheckpoint(watermark, total, done, false);
+                lastCheckpoint_ = watermark;
+            }
+            if (onProgress_) {
+                onProgress_(done, total);
+            }
+        }
+
+        waitForRoom(true);
+    } catch (const std::exception& e) {
+        error = e.what();
+        Logger::error("Reprocessing failed: " + error);
+    }
+
+    size_t watermark;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        watermark = watermark_;
+        done = done_;
+    }
+    // Draining returned, so nothing is left in flight unless cancelled
+    bool cancelled = token.isCancelled();
+    bool finished = error.empty() && !cancelled;
+    saveCheckpoint(watermark, total, done, finished);
+    if (finished) {
+        Logger::info("Reprocessing finished: " + std::to_string(done) + " items re-scored");
+    } else {
+        Logger::info("Reprocessing stopped at record " + std::to_string(watermark) + " of " +
+                     std::to_string(total) + "; it resumes from there");
+    }
+    finished_ = true;
+    if (onFinished_) {
+        onFinished_(done, cancelled, error);
+    }
+}
+
+size_t ReprocessJob::indexRecords(size_t limit, std::unordered_map<std::string, size_t>& latest) {
+    auto cursor = storage_.openCursor(options_.query);
+    CancellationToken token = cancellation_.token();
+    size_t count = 0;
+    while (count < limit && !token.isCancelled()) {
+        std::vector<ContentItem> page = cursor->next(kPageSize);
+        if (page.empty()) {
+            break;
+        }
+        for (const auto& item : page) {
+            if (count == limit) {
+                break;
+            }
+            latest[item.id] = count++;
+        }
+    }
+    return count;
+}
+
+bool ReprocessJob::submitItem(ContentItem item, size_t position) {
+    // Detector results, the decision and duplicate links are recomputed
+    item.ai_detection = AIDetection();
+    item.moderation = ModerationResult();
+    item.decision = Decision();
+    item.duplicate_of.clear();
+    item.reprocess = true;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        order_.emplace_back(position, item.id);
+        inFlight_[item.id] = InFlight{item, position, std::chrono::steady_clock::now()};
+    }
+    CancellationToken token = cancellation_.token();
+    while (!submit_(item)) {
+        // Queue full or shedding; try again once it has drained a little
+        if (token.isCancelled()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_.erase(item.id);
+            order_.pop_back();
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait_for(lock, kRetryDelay);
+    }
+    return true;
+}
+
+bool ReprocessJob::waitForRoom(bool drain) {
+    static Counter& resubmitted = Metrics::counter("modai_reprocess_resubmitted_total");
+    CancellationToken token = cancellation_.token();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (token.isCancelled()) {
+            return false;
+        }
+        if (drain ? inFlight_.empty() : inFlight_.size() < options_.maxInFlight) {
+            return true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        std::vector<ContentItem> overdue;
+        for (auto& [id, entry] : inFlight_) {
+            if (now - entry.submitted >= options_.resubmitAfter) {
+                entry.submitted = now;
+                overdue.push_back(entry.item);
+            }
+        }
+        if (!overdue.empty()) {
+            lock.unlock();
+            for (const auto& item : overdue) {
+                resubmitted.inc();
+                submit_(item);
+            }
+            lock.lock();
+            continue;
+        }
+        changed_.wait_for(lock, std::chrono::seconds(1));
+    }
+}
+
+bool ReprocessJob::loadCheckpoint(size_t& position, size_t& total, size_t& done) {
+    std::ifstream file(options_.checkpointPath);
+    if (!file.is_open()) {
+        return false;
+    }
+    try {
+        nlohmann::json j;
+        file >> j;
+        if (j.value("query", nlohmann::json()) != queryJson(options_.query)) {
+            Logger::warn("Reprocessing checkpoint " + options_.checkpointPath + " is for another query; starting over");
+            return false;
+        }
+        position = j.value("position", size_t{0});
+        total = j.value("total", size_t{0});
+        done = j.value("done", size_t{0});
+        return position <= total;
+    } catch (const std::exception& e) {
+        Logger::warn("Ignoring unreadable reprocessing checkpoint: " + std::string(e.what()));
+        return false;
+    }
+}
+
+void ReprocessJob::saveCheckpoint(size_t position, size_t total, size_t done, bool finished) {
+    std::error_code ec;
+    if (finished) {
+        std::filesystem::remove(options_.checkpointPath, ec);
+        return;
+    }
+    nlohmann::json j = {{"query", queryJson(options_.query)}, {"position", position},
+                        {"total", total}, {"done", done}};
+    // Written aside and renamed, so a crash leaves the previous checkpoint
+    const std::string tempPath = options_.checkpointPath + ".tmp";
+    std::filesystem::create_directories(std::filesystem::path(options_.checkpointPath).parent_path(), ec);
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        out << j.dump();
+        if (!out) {
+            Logger::warn("Failed to write reprocessing checkpoint " + tempPath);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, options_.checkpointPath, ec);
+    if (ec) {
+        Logger::warn("Failed to save reprocessing checkpoint: " + ec.message());
+    }
+}
+
+} // namespace ModAI
@@ -1,57 +1,515 @@
 #include "core/ResultCache.h"
 #include "utils/Logger.h"
-#include <fstream>
-#include <iostream>
+#include <array>
 #include <ctime>
+#include <filesystem>
+#include <vector>
 
 namespace ModAI {
 
-ResultCache::ResultCache(const std::string& filePath) : filePath_(filePath) {
-    load();
+namespace {
+
+constexpr char kMagic[4] = {'M', 'R', 'C', '1'};
+constexpr uint64_t kMagicSize = sizeof(kMagic);
+constexpr uint64_t kRecordHeaderSize = 16;  // keyLen u32, valueLen u32, expiresAt i64
+constexpr uint32_t kMaxKeyLength = 64 * 1024;
+constexpr uint32_t kMaxValueLength = 64 * 1024 * 1024;
+
+// Fixed little-endian encoding so the log is portable between machines
+void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void putI64(uint8_t* out, int64_t value) {
+    auto bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+uint32_t getU32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+int64_t getI64(const uint8_t* in) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return static_cast<int64_t>(bits);
+}
+
+int64_t nowSeconds() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+bool isExpired(int64_t expiresAt, int64_t now) {
+    return expiresAt != 0 && expiresAt <= now;
+}
+
+void writeRecord(std::ostream& out, const std::string& key, const uint8_t* value,
+                 uint32_t valueLength, int64_t expiresAt) {
+    std::array<uint8_t, kRecordHeaderSize> header{};
+    putU32(header.data(), static_cast<uint32_t>(key.size()));
+    putU32(header.data() + 4, valueLength);
+    putI64(header.data() + 8, expiresAt);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    out.write(key.data(), static_cast<std::streamsize>(key.size()));
+    out.write(reinterpret_cast<const char*>(value), valueLength);
 }
 
-void ResultCache::load() {
+} // namespace
+
+ResultCache::ResultCache(const std::string& filePath, ResultCacheOptions options)
+    : filePath_(filePath)
+    , options_(options) {
+    if (!load()) {
+        // Imported outside load()'s lock, then indexed through the normal path
+        if (!importLegacyJsonl()) {
+            std::error_code ec;
+            std::filesystem::remove(filePath_, ec);  // start empty, as with an unknown format
+        }
+        load();
+    }
+    compactor_ = std::thread(&ResultCache::compactorLoop, this);
+}
+
+ResultCache::~ResultCache() {
+    {
+        std::lock_guard<std::mutex> lock(compactMutex_);
+        stopping_ = true;
+    }
+    compactCv_.notify_all();
+    if (compactor_.joinable()) {
+        compactor_.join();
+    }
+}
+
+void ResultCache::openStreams() {
+    writer_.close();
+    reader_.close();
+    writer_.clear();
+    reader_.clear();
+    writer_.open(filePath_, std::ios::binary | std::ios::app);
+    reader_.open(filePath_, std::ios::binary);
+    if (!writer_.is_open() || !reader_.is_open()) {
+        Logger::error("Failed to open result cache: " + filePath_);
+    }
+}
+
+bool ResultCache::load() {
     std::lock_guard<std::mutex> lock(mutex_);
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    if (fs::path(filePath_).has_parent_path()) {
+        fs::create_directories(fs::path(filePath_).parent_path(), ec);
+    }
+
+    bool fresh = !fs::exists(filePath_, ec) || fs::file_size(filePath_, ec) == 0;
+    if (!fresh) {
+        std::ifstream probe(filePath_, std::ios::binary);
+        char magic[kMagicSize] = {};
+        probe.read(magic, kMagicSize);
+        if (magic[0] == '{') {
+            return false;  // pre-index JSONL cache, to be converted first
+        } else if (probe.gcount() != static_cast<std::streamsize>(kMagicSize) ||
+                   !std::equal(magic, magic + kMagicSize, kMagic)) {
+            Logger::warn("Result cache has an unknown format, starting empty: " + filePath_);
+            fresh = true;
+        }
+    }
+
+    if (fresh) {
+        std::ofstream init(filePath_, std::ios::binary | std::ios::trunc);
+        init.write(kMagic, kMagicSize);
+        init.close();
+        fileSize_ = kMagicSize;
+        openStreams();
+        return true;
+    }
+
+    // Scan record headers and keys only; values stay on disk
+    std::ifstream in(filePath_, std::ios::binary);
+    uint64_t total = fs::file_size(filePath_, ec);
+    uint64_t offset = kMagicSize;
+    in.seekg(static_cast<std::streamoff>(offset));
+    int64_t now = nowSeconds();
+    std::array<uint8_t, kRecordHeaderSize> header{};
+    std::string key;
+
+    while (offset + kRecordHeaderSize <= total) {
+        in.read(reinterpret_cast<char*>(header.data()), header.size());
+        if (!in) {
+            break;
+        }
+        uint32_t keyLength = getU32(header.data());
+        uint32_t valueLength = getU32(header.data() + 4);
+        int64_t expiresAt = getI64(header.data() + 8);
+        uint64_t recordLength = kRecordHeaderSize + keyLength + valueLength;
+        if (keyLength == 0 || keyLength > kMaxKeyLength || valueLength > kMaxValueLength ||
+            offset + recordLength > total) {
+            break;  // Torn or corrupt tail from a crash mid-append
+        }
+
+        key.resize(keyLength);
+        in.read(key.data(), keyLength);
+        in.seekg(valueLength, std::ios::cur);
+        if (!in) {
+            break;
+        }
+
+        auto existing = index_.find(key);
+        if (existing != index_.end()) {
+            eraseLocked(existing);
+        }
+        if (!isExpired(expiresAt, now)) {
+            indexLru_.push_front(key);
+            IndexEntry entry;
+            entry.offset = offset;
+            entry.valueLength = valueLength;
+            entry.recordLength = static_cast<uint32_t>(recordLength);
+            entry.expiresAt = expiresAt;
+            entry.lru = indexLru_.begin();
+            index_.emplace(key, entry);
+            liveBytes_ += recordLength;
+        }
+        offset += recordLength;
+    }
+    in.close();
+
+    if (offset < total) {
+        Logger::warn("Result cache: discarding " + std::to_string(total - offset) +
+                     " bytes of incomplete records");
+        fs::resize_file(filePath_, offset, ec);
+    }
+    fileSize_ = offset;
+
+    while (index_.size() > options_.maxEntries && !indexLru_.empty()) {
+        eraseLocked(index_.find(indexLru_.back()));
+    }
+
+    openStreams();
+    Logger::info("Result cache loaded " + std::to_string(index_.size()) + " entries from " + filePath_);
+    maybeRequestCompactionLocked();
+    return true;
+}
+
+bool ResultCache::importLegacyJsonl() {
+    // Pre-index caches were JSONL {hash, result, timestamp}; convert once
     std::ifstream file(filePath_);
-    if (!file.is_open()) return;
-    
+    std::vector<std::pair<std::string, nlohmann::json>> entries;
     std::string line;
     while (std::getline(file, line)) {
         try {
             auto j = nlohmann::json::parse(line);
             if (j.contains("hash") && j.contains("result")) {
-                cache_[j["hash"]] = j["result"];
+                entries.emplace_back(j["hash"].get<std::string>(), j["result"]);
             }
         } catch (...) {}
     }
+    file.close();
+
+    std::string tmpPath = filePath_ + ".import";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(kMagic, kMagicSize);
+        int64_t expiresAt = options_.defaultTtl.count() > 0 ? nowSeconds() + options_.defaultTtl.count() : 0;
+        for (const auto& [hash, result] : entries) {
+            auto value = nlohmann::json::to_cbor(result);
+            writeRecord(out, hash, value.data(), static_cast<uint32_t>(value.size()), expiresAt);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, filePath_, ec);
+    if (ec) {
+        Logger::error("Failed to convert legacy result cache: " + ec.message());
+        return false;
+    }
+    Logger::info("Converted legacy result cache with " + std::to_string(entries.size()) + " entries");
+    return true;
 }
 
 std::optional<nlohmann::json> ResultCache::get(const std::string& hash) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = cache_.find(hash);
-    if (it != cache_.end()) {
-        return it->second;
+    auto it = index_.find(hash);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    if (isExpired(it->second.expiresAt, nowSeconds())) {
+        eraseLocked(it);
+        maybeRequestCompactionLocked();
+        return std::nullopt;
+    }
+    indexLru_.splice(indexLru_.begin(), indexLru_, it->second.lru);
+
+    auto cached = values_.find(hash);
+    if (cached != values_.end()) {
+        valueLru_.splice(valueLru_.begin(), valueLru_, cached->second.lru);
+        return cached->second.value;
+    }
+
+    std::vector<uint8_t> bytes(it->second.valueLength);
+    reader_.clear();
+    reader_.seekg(static_cast<std::streamoff>(it->second.offset + kRecordHeaderSize + hash.size()));
+    reader_.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!reader_) {
+        Logger::warn("Result cache: failed to read entry " + hash);
+        eraseLocked(it);
+        return std::nullopt;
+    }
+
+    try {
+        auto value = nlohmann::json::from_cbor(bytes);
+        rememberValueLocked(hash, value);
+        return value;
+    } catch (const std::exception& e) {
+        Logger::warn("Result cache: corrupt entry " + hash + ": " + e.what());
+        eraseLocked(it);
+        return std::nullopt;
     }
-    return std::nullopt;
 }
 
 void ResultCache::put(const std::string& hash, const nlohmann::json& result) {
+    put(hash, result, options_.defaultTtl);
+}
+
+void ResultCache::put(const std::string& hash, const nlohmann::json& result, std::chrono::seconds ttl) {
+    if (hash.empty() || hash.size() > kMaxKeyLength) {
+        return;
+    }
+    auto value = nlohmann::json::to_cbor(result);
+    if (value.size() > kMaxValueLength) {
+        return;
+    }
+    int64_t expiresAt = ttl.count() > 0 ? nowSeconds() + ttl.count() : 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    append(hash, value, expiresAt);
+    rememberValueLocked(hash, result);
+
+    while (index_.size() > options_.maxEntries && !indexLru_.empty()) {
+        eraseLocked(index_.find(indexLru_.back()));
+    }
+    maybeRequestCompactionLocked();
+}
+
+size_t ResultCache::size() {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (cache_.find(hash) != cache_.end()) return;
-    
-    cache_[hash] = result;
-    append(hash, result);
+    return index_.size();
+}
+
+void ResultCache::append(const std::string& hash, const std::vector<uint8_t>& value, int64_t expiresAt) {
+    writeRecord(writer_, hash, value.data(), static_cast<uint32_t>(value.size()), expiresAt);
+    writer_.flush();  // get() reads through a separate stream
+    if (!writer_) {
+        Logger::error("Result cache: write failed for " + filePath_);
+        writer_.clear();
+        return;
+    }
+
+    auto existing = index_.find(hash);
+    if (existing != index_.end()) {
+        eraseLocked(existing);
+    }
+
+    uint64_t recordLength = kRecordHeaderSize + hash.size() + value.size();
+    indexLru_.push_front(hash);
+    IndexEntry entry;
+    entry.offset = fileSize_;
+    entry.valueLength = static_cast<uint32_t>(value.size());
+    entry.recordLength = static_cast<uint32_t>(recordLength);
+    entry.expiresAt = expiresAt;
+    entry.lru = indexLru_.begin();
+    index_.emplace(hash, entry);
+
+    fileSize_ += recordLength;
+    liveBytes_ += recordLength;
+}
+
+void ResultCache::eraseLocked(std::unordered_map<std::string, IndexEntry>::iterator it) {
+    if (it == index_.end()) {
+        return;
+    }
+    liveBytes_ -= it->second.recordLength;
+    indexLru_.erase(it->second.lru);
+    auto cached = values_.find(it->first);
+    if (cached != values_.end()) {
+        valueLru_.erase(cached->second.lru);
+        values_.erase(cached);
+    }
+    index_.erase(it);
+}
+
+void ResultCache::rememberValueLocked(const std::string& hash, const nlohmann::json& value) {
+    auto cached = values_.find(hash);
+    if (cached != values_.end()) {
+        cached->second.value = value;
+        valueLru_.splice(valueLru_.begin(), valueLru_, cached->second.lru);
+        return;
+    }
+    valueLru_.push_front(hash);
+    values_.emplace(hash, CachedValue{value, valueLru_.begin()});
+
+    while (values_.size() > options_.maxMemoryEntries && !valueLru_.empty()) {
+        values_.erase(valueLru_.back());
+        valueLru_.pop_back();
+    }
 }
 
-void ResultCache::append(const std::string& hash, const nlohmann::json& result) {
-    std::ofstream file(filePath_, std::ios::app);
-    if (file.is_open()) {
-        nlohmann::json entry;
-        entry["hash"] = hash;
-        entry["result"] = result;
-        entry["timestamp"] = std::time(nullptr);
-        file << entry.dump() << "\n";
+void ResultCache::maybeRequestCompactionLocked() {
+    uint64_t garbage = fileSize_ - kMagicSize - liveBytes_;
+    if (fileSize_ < options_.compactionMinBytes ||
+        static_cast<double>(garbage) < options_.compactionGarbageRatio * static_cast<double>(fileSize_)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(compactMutex_);
+        compactRequested_ = true;
+    }
+    compactCv_.notify_one();
+}
+
+void ResultCache::compactorLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(compactMutex_);
+            compactCv_.wait(lock, [this] { return stopping_ || compactRequested_; });
+            if (stopping_) {
+                return;
+            }
+            compactRequested_ = false;
+        }
+        compact();
+    }
+}
+
+void ResultCache::compact() {
+    struct Live {
+        std::string key;
+        uint64_t offset;
+        uint32_t valueLength;
+        int64_t expiresAt;
+    };
+
+    // Phase 1: snapshot the live set; appends continue into the old log
+    std::vector<Live> live;
+    uint64_t snapshotEnd = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (compacting_) {
+            return;
+        }
+        compacting_ = true;
+        live.reserve(index_.size());
+        for (const auto& [key, entry] : index_) {
+            live.push_back({key, entry.offset, entry.valueLength, entry.expiresAt});
+        }
+        snapshotEnd = fileSize_;
+    }
+
+    // Phase 2: copy unexpired snapshot records into a new log, unlocked
+    std::string tmpPath = filePath_ + ".compact";
+    std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> moved;  // key -> (old, new)
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    std::ifstream in(filePath_, std::ios::binary);
+    bool ok = out.is_open() && in.is_open();
+    uint64_t newOffset = kMagicSize;
+    int64_t now = nowSeconds();
+
+    if (ok) {
+        out.write(kMagic, kMagicSize);
+        std::vector<uint8_t> value;
+        for (const auto& record : live) {
+            if (isExpired(record.expiresAt, now)) {
+                continue;
+            }
+            value.resize(record.valueLength);
+            in.seekg(static_cast<std::streamoff>(record.offset + kRecordHeaderSize + record.key.size()));
+            in.read(reinterpret_cast<char*>(value.data()), static_cast<std::streamsize>(value.size()));
+            if (!in) {
+                ok = false;
+                break;
+            }
+            writeRecord(out, record.key, value.data(), record.valueLength, record.expiresAt);
+            moved.emplace(record.key, std::make_pair(record.offset, newOffset));
+            newOffset += kRecordHeaderSize + record.key.size() + record.valueLength;
+        }
+    }
+
+    // Phase 3: append what was written meanwhile, remap offsets, swap files
+    std::lock_guard<std::mutex> lock(mutex_);
+    compacting_ = false;
+
+    if (ok) {
+        writer_.flush();
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(snapshotEnd));
+        std::vector<char> tail(static_cast<size_t>(fileSize_ - snapshotEnd));
+        if (!tail.empty()) {
+            in.read(tail.data(), static_cast<std::streamsize>(tail.size()));
+            ok = static_cast<bool>(in);
+            out.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+        }
+        out.flush();
+        ok = ok && static_cast<bool>(out);
+    }
+    in.close();
+    out.close();
+
+    std::error_code ec;
+    if (!ok) {
+        std::filesystem::remove(tmpPath, ec);
+        Logger::error("Result cache compaction failed for " + filePath_);
+        return;
+    }
+
+    int64_t shift = static_cast<int64_t>(newOffset) - static_cast<int64_t>(snapshotEnd);
+    std::vector<std::string> dropped;
+    liveBytes_ = 0;
+    for (auto& [key, entry] : index_) {
+        if (entry.offset >= snapshotEnd) {
+            entry.offset = static_cast<uint64_t>(static_cast<int64_t>(entry.offset) + shift);
+        } else {
+            auto it = moved.find(key);
+            if (it == moved.end() || it->second.first != entry.offset) {
+                dropped.push_back(key);  // Expired during the copy
+                continue;
+            }
+            entry.offset = it->second.second;
+        }
+        liveBytes_ += entry.recordLength;
+    }
+    for (const auto& key : dropped) {
+        auto it = index_.find(key);
+        liveBytes_ += it->second.recordLength;  // eraseLocked subtracts it again
+        eraseLocked(it);
+    }
+
+    uint64_t before = fileSize_;
+    writer_.close();
+    reader_.close();
+    std::filesystem::rename(tmpPath, filePath_, ec);
+    if (ec) {
+        Logger::error("Result cache compaction rename failed: " + ec.message());
+        std::filesystem::remove(tmpPath, ec);
+        // Offsets now refer to the new layout we failed to install; start over
+        index_.clear();
+        indexLru_.clear();
+        values_.clear();
+        valueLru_.clear();
+        liveBytes_ = 0;
+        std::ofstream reset(filePath_, std::ios::binary | std::ios::trunc);
+        reset.write(kMagic, kMagicSize);
+        fileSize_ = kMagicSize;
+    } else {
+        fileSize_ = newOffset + (before - snapshotEnd);
+        Logger::info("Result cache compacted " + std::to_string(before) + " -> " +
+                     std::to_string(fileSize_) + " bytes");
     }
+    openStreams();
 }
 
 }
@@ -0,0 +1,260 @@
+#include "core/RuleBacktest.h"
+#include "storage/Storage.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <thread>
+#include <unordered_set>
+
+namespace ModAI {
+
+namespace {
+
+constexpr size_t kLoadPageSize = 5000;
+constexpr uint32_t kNoSubreddit = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t kUnseenSubreddit = kNoSubreddit - 1;  // matches no row
+
+} // namespace
+
+// Serves one block of rows; additional labels are expanded from the sparse
+// rows into a dense column the first time a condition reads them
+class RuleBacktest::BlockColumns : public RuleColumns {
+public:
+    explicit BlockColumns(const RuleBacktest& data)
+        : data_(data) {
+    }
+
+    void setBlock(size_t begin, size_t rows) {
+        begin_ = begin;
+        rows_ = rows;
+        ++block_;
+    }
+
+    size_t rows() const override { return rows_; }
+
+    const double* column(RuleField field, const Symbol& label) const override {
+        if (field != RuleField::Label) {
+            return data_.fields_[static_cast<size_t>(field)].data() + begin_;
+        }
+        auto index = data_.labelIndex_.find(label);
+        if (index == data_.labelIndex_.end()) {
+            return nullptr;  // no stored item has it
+        }
+        Dense& dense = dense_[index->second];
+        if (dense.block != block_) {
+            dense.block = block_;
+            dense.values.assign(rows_, 0.0);
+            for (size_t i = 0; i < rows_; ++i) {
+                for (uint32_t k = data_.labelOffsets_[begin_ + i]; k < data_.labelOffsets_[begin_ + i + 1]; ++k) {
+                    if (data_.labelValues_[k].label == index->second) {
+                        dense.values[i] = data_.labelValues_[k].value;
+                    }
+                }
+            }
+        }
+        return dense.values.data();
+    }
+
+private:
+    struct Dense {
+        uint64_t block = 0;
+        std::vector<double> values;
+    };
+
+    const RuleBacktest& data_;
+    size_t begin_ = 0;
+    size_t rows_ = 0;
+    uint64_t block_ = 0;
+    mutable std::unordered_map<uint32_t, Dense> dense_;
+};
+
+size_t RuleBacktest::load(Storage& storage, const ContentQuery& query) {
+    ids_.clear();
+    recordedActions_.clear();
+    withoutModeration_.clear();
+    subreddits_.clear();
+    subredditNames_.clear();
+    for (auto& field : fields_) {
+        field.clear();
+    }
+    labelOffsets_.assign(1, 0);
+    labelValues_.clear();
+    labelIndex_.clear();
+
+    // Newest first, so the first version of an item seen is its latest
+    ContentQuery newestFirst = query;
+    newestFirst.newestFirst = true;
+    auto cursor = storage.openCursor(newestFirst);
+    std::unordered_set<std::string> seen;
+    std::unordered_map<Symbol, uint32_t> subredditIndex;
+
+    for (auto page = cursor->next(kLoadPageSize); !page.empty(); page = cursor->next(kLoadPageSize)) {
+        for (const auto& item : page) {
+            if (!seen.insert(item.id).second) {
+                continue;
+            }
+            ids_.push_back(item.id);
+            recordedActions_.push_back(item.decision.auto_action);
+            const Symbol& provider = item.moderation.provider;
+            withoutModeration_.push_back(provider.empty() || provider == "skipped");
+
+            auto [sub, added] = subredditIndex.try_emplace(item.subreddit, static_cast<uint32_t>(subredditNames_.size()));
+            if (added) {
+                subredditNames_.push_back(item.subreddit);
+            }
+            subreddits_.push_back(sub->second);
+
+            const auto& labels = item.moderation.labels;
+            fields_[static_cast<size_t>(RuleField::AIScore)].push_back(item.ai_detection.ai_score);
+            fields_[static_cast<size_t>(RuleField::Sexual)].push_back(labels.sexual);
+            fields_[static_cast<size_t>(RuleField::Violence)].push_back(labels.violence);
+            fields_[static_cast<size_t>(RuleField::Hate)].push_back(labels.hate);
+            fields_[static_cast<size_t>(RuleField::Drugs)].push_back(labels.drugs);
+            for (const auto& [name, value] : labels.additional_labels) {
+                auto [label, inserted] = labelIndex_.try_emplace(name, static_cast<uint32_t>(labelIndex_.size()));
+                labelValues_.push_back({label->second, value});
+            }
+            labelOffsets_.push_back(static_cast<uint32_t>(labelValues_.size()));
+        }
+    }
+
+    Logger::info("Backtest loaded " + std::to_string(ids_.size()) + " items across " +
+                 std::to_string(subredditNames_.size()) + " subreddits");
+    return ids_.size();
+}
+
+RuleBacktestReport RuleBacktest::run(const RuleSet& rules, unsigned threads) const {
+    auto started = std::chrono::steady_clock::now();
+
+    struct Candidate {
+        const Rule* rule;
+        uint32_t subreddit;  // kNoSubreddit for global rules
+        Symbol action;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& rule : rules.rules()) {
+        if (!rule.enabled || !rule.compiled) {
+            continue;
+        }
+        Candidate candidate{&rule, kNoSubreddit, Symbol(rule.action)};
+        if (!rule.subreddit.empty()) {
+            auto it = std::find(subredditNames_.begin(), subredditNames_.end(), rule.subreddit);
+            // A subreddit with no history still gets a row in the report
+            candidate.subreddit = it == subredditNames_.end()
+                ? kUnseenSubreddit
+                : static_cast<uint32_t>(it - subredditNames_.begin());
+        }
+        candidates.push_back(std::move(candidate));
+    }
+
+    struct Partial {
+        std::vector<size_t> matched;
+        std::vector<size_t> decided;
+        std::map<std::pair<Symbol, Symbol>, size_t> transitions;
+        size_t changed = 0;
+        std::vector<size_t> samples;  // row indices
+    };
+
+    const size_t rows = ids_.size();
+    const size_t blocks = (rows + kBlockRows - 1) / kBlockRows;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, blocks)));
+    std::vector<Partial> partials(threads);
+    const Symbol allow("allow");
+
+    // Each thread takes a contiguous range of blocks
+    auto work = [&](unsigned thread) {
+        Partial& partial = partials[thread];
+        partial.matched.assign(candidates.size(), 0);
+        partial.decided.assign(candidates.size(), 0);
+        BlockColumns columns(*this);
+        std::vector<uint8_t> mask(kBlockRows);
+        std::vector<uint8_t> scratch;
+        std::vector<int32_t> first(kBlockRows);
+
+        for (size_t block = blocks * thread / threads; block < blocks * (thread + 1) / threads; ++block) {
+            const size_t begin = block * kBlockRows;
+            const size_t count = std::min(kBlockRows, rows - begin);
+            columns.setBlock(begin, count);
+            std::fill(first.begin(), first.begin() + static_cast<std::ptrdiff_t>(count), -1);
+            const uint32_t* subreddit = subreddits_.data() + begin;
+
+            for (size_t r = 0; r < candidates.size(); ++r) {
+                candidates[r].rule->compiled->evaluateColumns(columns, mask.data(), scratch);
+                const uint32_t target = candidates[r].subreddit;
+                const uint8_t global = target == kNoSubreddit;
+                const int32_t rule = static_cast<int32_t>(r);
+                size_t matched = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    uint8_t hit = mask[i] & (global | static_cast<uint8_t>(subreddit[i] == target));
+                    matched += hit;
+                    first[i] = (hit && first[i] < 0) ? rule : first[i];
+                }
+                partial.matched[r] += matched;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                const Symbol* action = &allow;
+                if (first[i] >= 0) {
+                    ++partial.decided[static_cast<size_t>(first[i])];
+                    action = &candidates[static_cast<size_t>(first[i])].action;
+                }
+                const Symbol& recorded = recordedActions_[begin + i];
+                if (*action != recorded) {
+                    ++partial.changed;
+                    ++partial.transitions[{recorded, *action}];
+                    if (partial.samples.size() < kMaxSamples) {
+                        partial.samples.push_back(begin + i);
+                    }
+                }
+            }
+        }
+    };
+
+    if (rows > 0) {
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    RuleBacktestReport report;
+    report.items = rows;
+    report.withoutModeration = static_cast<size_t>(std::count(withoutModeration_.begin(), withoutModeration_.end(), 1));
+    for (const auto& candidate : candidates) {
+        report.rules.push_back({candidate.rule->id, candidate.rule->action, 0, 0});
+    }
+    std::map<std::pair<Symbol, Symbol>, size_t> transitions;
+    for (const auto& partial : partials) {
+        for (size_t r = 0; r < partial.matched.size(); ++r) {
+            report.rules[r].matched += partial.matched[r];
+            report.rules[r].decided += partial.decided[r];
+        }
+        for (const auto& [change, count] : partial.transitions) {
+            transitions[change] += count;
+        }
+        report.changed += partial.changed;
+        for (size_t row : partial.samples) {
+            if (report.changedSamples.size() < kMaxSamples) {
+                report.changedSamples.push_back(ids_[row]);
+            }
+        }
+    }
+    for (const auto& [change, count] : transitions) {
+        report.transitions.push_back({change.first.str(), change.second.str(), count});
+    }
+    std::sort(report.transitions.begin(), report.transitions.end(),
+              [](const auto& a, const auto& b) { return a.count > b.count; });
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return report;
+}
+
+} // namespace ModAI
@@ -2,21 +2,52 @@
 #include "utils/Logger.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
-#include <sstream>
-#include <regex>
-#include <algorithm>
-#include <cctype>
 
 namespace ModAI {
 
-void RuleEngine::loadRulesFromJson(const std::string& jsonPath) {
-    rules_.clear();
+RuleSet::RuleSet(std::vector<Rule> rules)
+    : rules_(std::move(rules)) {
+    for (const auto& rule : rules_) {
+        if (!rule.subreddit.empty()) {
+            bySubreddit_.try_emplace(rule.subreddit);
+        }
+    }
+    for (const auto& rule : rules_) {
+        if (!rule.enabled || !rule.compiled) {
+            continue;  // never matches
+        }
+        auto add = [&rule](Bucket& bucket) {
+            bucket.rules.push_back(&rule);
+            bucket.inputs |= rule.compiled->inputs();
+        };
+        if (rule.subreddit.empty()) {
+            add(global_);
+            for (auto& [subreddit, bucket] : bySubreddit_) {
+                add(bucket);
+            }
+        } else {
+            add(bySubreddit_[rule.subreddit]);
+        }
+    }
+}
+
+const RuleSet::Bucket& RuleSet::bucketFor(const Symbol& subreddit) const {
+    auto it = bySubreddit_.find(subreddit);
+    return it == bySubreddit_.end() ? global_ : it->second;
+}
+
+RuleEngine::RuleEngine()
+    : rules_(std::make_shared<const RuleSet>()) {
+}
+
+bool RuleEngine::loadRulesFromJson(const std::string& jsonPath) {
+    std::vector<Rule> rules;
     
     try {
         std::ifstream file(jsonPath);
         if (!file.is_open()) {
             Logger::warn("Could not open rules file: " + jsonPath);
-            return;
+            return false;
         }
         
         nlohmann::json j;
@@ -33,134 +64,96 @@ void RuleEngine::loadRulesFromJson(const std::string& jsonPath) {
                 rule.enabled = ruleJson.value("enabled", true);
                 
                 if (!rule.id.empty() && !rule.condition.empty()) {
-                    rules_.push_back(rule);
+                    compileRule(rule);
+                    rules.push_back(std::move(rule));
                 }
             }
         }
-        
-        Logger::info("Loaded " + std::to_string(rules_.size()) + " rules from " + jsonPath);
     } catch (const std::exception& e) {
         Logger::error("Failed to load rules: " + std::string(e.what()));
+        return false;
+    }
+    
+    size_t count = rules.size();
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        publish(std::move(rules));
     }
+    Logger::info("Loaded " + std::to_string(count) + " rules from " + jsonPath);
+    return true;
 }
 
 void RuleEngine::addRule(const Rule& rule) {
-    rules_.push_back(rule);
+    Rule compiledRule = rule;
+    compileRule(compiledRule);
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    std::vector<Rule> rules = snapshot()->rules();
+    rules.push_back(std::move(compiledRule));
+    publish(std::move(rules));
 }
 
 void RuleEngine::clearRules() {
-    rules_.clear();
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    publish({});
 }
 
-double RuleEngine::getValue(const std::string& field, const ContentItem& item) {
-    if (field == "ai_score") {
-        return item.ai_detection.ai_score;
-    } else if (field == "sexual") {
-        return item.moderation.labels.sexual;
-    } else if (field == "violence") {
-        return item.moderation.labels.violence;
-    } else if (field == "hate") {
-        return item.moderation.labels.hate;
-    } else if (field == "drugs") {
-        return item.moderation.labels.drugs;
-    } else if (item.moderation.labels.additional_labels.count(field) > 0) {
-        return item.moderation.labels.additional_labels.at(field);
-    }
-    return 0.0;
+void RuleEngine::publish(std::vector<Rule> rules) {
+    std::atomic_store(&rules_, std::shared_ptr<const RuleSet>(std::make_shared<const RuleSet>(std::move(rules))));
 }
 
-bool RuleEngine::evaluateCondition(const Rule& rule, const ContentItem& item) {
-    // Supports simple AND/OR expressions like "ai_score > 0.8 && sexual > 0.9"
-    auto trim = [](std::string s) {
-        s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
-        s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
-        return s;
-    };
-
-    auto evaluateComparison = [&](const std::string& expr) {
-        std::regex pattern(R"((\w+)\s*(>=|<=|>|<|==)\s*([\d.]+))");
-        std::smatch match;
-        if (!std::regex_search(expr, match, pattern)) {
-            return false;
-        }
-        std::string field = match[1].str();
-        std::string op = match[2].str();
-        double threshold = std::stod(match[3].str());
-        double value = getValue(field, item);
-
-        if (op == ">") return value > threshold;
-        if (op == ">=") return value >= threshold;
-        if (op == "<") return value < threshold;
-        if (op == "<=") return value <= threshold;
-        if (op == "==") return std::abs(value - threshold) < 0.0001;
+bool RuleEngine::compileRule(Rule& rule) {
+    try {
+        rule.compiled = std::make_shared<const RuleExpression>(RuleExpression::compile(rule.condition));
+        return true;
+    } catch (const std::exception& e) {
+        // An invalid condition never matches, as before
+        Logger::warn("Rule " + rule.id + " disabled: " + std::string(e.what()));
+        rule.compiled.reset();
         return false;
-    };
-
-    // OR segments
-    size_t start = 0;
-    bool anyOr = false;
-    while (start <= rule.condition.size()) {
-        size_t orPos = rule.condition.find("||", start);
-        std::string orSegment = rule.condition.substr(start, orPos == std::string::npos ? std::string::npos : orPos - start);
-        start = (orPos == std::string::npos) ? rule.condition.size() + 1 : orPos + 2;
-
-        // AND segments inside each OR segment
-        bool andSatisfied = true;
-        size_t andStart = 0;
-        while (andStart <= orSegment.size()) {
-            size_t andPos = orSegment.find("&&", andStart);
-            std::string andSegment = orSegment.substr(andStart, andPos == std::string::npos ? std::string::npos : andPos - andStart);
-            andStart = (andPos == std::string::npos) ? orSegment.size() + 1 : andPos + 2;
-
-            if (!evaluateComparison(trim(andSegment))) {
-                andSatisfied = false;
-                break;
-            }
-        }
+    }
+}
 
-        anyOr = anyOr || andSatisfied;
-        if (anyOr) {
-            return true;
+RuleRef RuleEngine::findFirstMatch(const ContentItem& item) const {
+    auto rules = snapshot();
+    for (const Rule* rule : rules->rulesFor(item.subreddit)) {
+        if (rule->compiled->evaluate(item)) {
+            return RuleRef(rules, rule);
         }
     }
+    
+    return nullptr;
+}
 
-    return anyOr;
+RuleInputs RuleEngine::requiredInputs(const Symbol& subreddit) const {
+    return snapshot()->inputsFor(subreddit);
 }
 
-std::string RuleEngine::evaluate(const ContentItem& item) {
-    // Check rules in order, return first matching action
-    for (const auto& rule : rules_) {
-        if (!rule.enabled) {
-            continue;
-        }
-        
-        // Check subreddit match
-        if (!rule.subreddit.empty() && rule.subreddit != item.subreddit) {
-            continue;
-        }
-        
-        if (evaluateCondition(rule, item)) {
-            return rule.action;
+bool RuleEngine::decisionFixed(const ContentItem& item, RuleInputs known) const {
+    // Rules are first-match: an undecided rule ahead of a matching one
+    // could still take precedence, so stop at the first Unknown
+    auto rules = snapshot();
+    for (const Rule* rule : rules->rulesFor(item.subreddit)) {
+        switch (rule->compiled->evaluatePartial(item, known)) {
+            case RuleExpression::Truth::True: return true;
+            case RuleExpression::Truth::Unknown: return false;
+            case RuleExpression::Truth::False: break;
         }
     }
     
-    return "allow";  // Default action
+    return true;
 }
 
-std::vector<Rule> RuleEngine::getMatchingRules(const ContentItem& item) {
-    std::vector<Rule> matching;
-    
-    for (const auto& rule : rules_) {
-        if (!rule.enabled) {
-            continue;
-        }
-        
-        if (!rule.subreddit.empty() && rule.subreddit != item.subreddit) {
-            continue;
-        }
-        
-        if (evaluateCondition(rule, item)) {
-            matching.push_back(rule);
+std::string RuleEngine::evaluate(const ContentItem& item) const {
+    RuleRef rule = findFirstMatch(item);
+    return rule ? rule->action : "allow";  // Default action
+}
+
+std::vector<RuleRef> RuleEngine::getMatchingRules(const ContentItem& item) const {
+    std::vector<RuleRef> matching;
+    auto rules = snapshot();
+    for (const Rule* rule : rules->rulesFor(item.subreddit)) {
+        if (rule->compiled->evaluate(item)) {
+            matching.emplace_back(rules, rule);
         }
     }
     
@@ -168,4 +161,3 @@ std::vector<Rule> RuleEngine::getMatchingRules(const ContentItem& item) {
 }
 
 } // namespace ModAI
-
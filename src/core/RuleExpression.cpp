@@ -0,0 +1,371 @@
+#include "core/RuleExpression.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace ModAI {
+
+class RuleExpression::Parser {
+public:
+    Parser(const std::string& source, RuleExpression& out)
+        : source_(source)
+        , out_(out) {
+    }
+
+    int32_t parse() {
+        int32_t root = parseOr();
+        skipSpace();
+        if (pos_ < source_.size()) {
+            fail("unexpected input");
+        }
+        return root;
+    }
+
+private:
+    const std::string& source_;
+    RuleExpression& out_;
+    size_t pos_ = 0;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument("Rule condition '" + source_ + "': " + message +
+                                    " at position " + std::to_string(pos_));
+    }
+
+    void skipSpace() {
+        while (pos_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool consume(const char* token) {
+        skipSpace();
+        size_t length = std::char_traits<char>::length(token);
+        if (source_.compare(pos_, length, token) != 0) {
+            return false;
+        }
+        // Keyword operators must not be a prefix of a longer identifier
+        if (std::isalpha(static_cast<unsigned char>(token[0])) && pos_ + length < source_.size()) {
+            unsigned char next = static_cast<unsigned char>(source_[pos_ + length]);
+            if (std::isalnum(next) || next == '_') {
+                return false;
+            }
+        }
+        pos_ += length;
+        return true;
+    }
+
+    int32_t addNode(const Node& node) {
+        out_.nodes_.push_back(node);
+        return static_cast<int32_t>(out_.nodes_.size() - 1);
+    }
+
+    int32_t addBinary(Kind kind, int32_t left, int32_t right) {
+        Node node;
+        node.kind = kind;
+        node.left = left;
+        node.right = right;
+        return addNode(node);
+    }
+
+    int32_t addConstant(bool value) {
+        Node node;
+        node.kind = Kind::Constant;
+        node.constant = value;
+        return addNode(node);
+    }
+
+    int32_t parseOr() {
+        int32_t left = parseAnd();
+        while (consume("||") || consume("or")) {
+            left = addBinary(Kind::Or, left, parseAnd());
+        }
+        return left;
+    }
+
+    int32_t parseAnd() {
+        int32_t left = parseUnary();
+        while (consume("&&") || consume("and")) {
+            left = addBinary(Kind::And, left, parseUnary());
+        }
+        return left;
+    }
+
+    int32_t parseUnary() {
+        skipSpace();
+        // "!" but not the start of "!="
+        if ((source_.compare(pos_, 1, "!") == 0 && source_.compare(pos_, 2, "!=") != 0 && consume("!")) ||
+            consume("not")) {
+            Node node;
+            node.kind = Kind::Not;
+            node.left = parseUnary();
+            return addNode(node);
+        }
+        if (consume("(")) {
+            int32_t inner = parseOr();
+            if (!consume(")")) {
+                fail("expected ')'");
+            }
+            return inner;
+        }
+        if (consume("true")) {
+            return addConstant(true);
+        }
+        if (consume("false")) {
+            return addConstant(false);
+        }
+        return parseComparison();
+    }
+
+    int32_t parseComparison() {
+        skipSpace();
+        size_t start = pos_;
+        while (pos_ < source_.size() &&
+               (std::isalnum(static_cast<unsigned char>(source_[pos_])) || source_[pos_] == '_')) {
+            ++pos_;
+        }
+        if (pos_ == start) {
+            fail("expected field name");
+        }
+        std::string field = source_.substr(start, pos_ - start);
+
+        Node node;
+        node.kind = Kind::Compare;
+        if (consume(">=")) node.op = Op::GreaterEqual;
+        else if (consume("<=")) node.op = Op::LessEqual;
+        else if (consume("==")) node.op = Op::Equal;
+        else if (consume("!=")) node.op = Op::NotEqual;
+        else if (consume(">")) node.op = Op::Greater;
+        else if (consume("<")) node.op = Op::Less;
+        else fail("expected comparison operator");
+
+        skipSpace();
+        const char* begin = source_.c_str() + pos_;
+        char* end = nullptr;
+        node.threshold = std::strtod(begin, &end);
+        if (end == begin) {
+            fail("expected number");
+        }
+        pos_ += static_cast<size_t>(end - begin);
+
+        if (field == "ai_score") node.field = RuleField::AIScore;
+        else if (field == "sexual") node.field = RuleField::Sexual;
+        else if (field == "violence") node.field = RuleField::Violence;
+        else if (field == "hate") node.field = RuleField::Hate;
+        else if (field == "drugs") node.field = RuleField::Drugs;
+        else {
+            node.field = RuleField::Label;
+            node.label = static_cast<uint32_t>(out_.labels_.size());
+            out_.labels_.push_back(field);
+        }
+        return addNode(node);
+    }
+};
+
+RuleExpression RuleExpression::compile(const std::string& condition) {
+    RuleExpression expression;
+    Parser parser(condition, expression);
+    expression.root_ = parser.parse();
+    for (const Node& node : expression.nodes_) {
+        if (node.kind == Kind::Compare) {
+            expression.inputs_ |= inputFor(node.field);
+        }
+    }
+    return expression;
+}
+
+RuleInputs RuleExpression::inputFor(RuleField field) {
+    return field == RuleField::AIScore ? kAIScoreInput : kModerationInput;
+}
+
+double RuleExpression::fieldValue(RuleField field, const Symbol& label, const ContentItem& item) {
+    switch (field) {
+        case RuleField::AIScore: return item.ai_detection.ai_score;
+        case RuleField::Sexual: return item.moderation.labels.sexual;
+        case RuleField::Violence: return item.moderation.labels.violence;
+        case RuleField::Hate: return item.moderation.labels.hate;
+        case RuleField::Drugs: return item.moderation.labels.drugs;
+        case RuleField::Label: {
+            const auto& labels = item.moderation.labels.additional_labels;
+            auto it = labels.find(label);
+            return it != labels.end() ? it->second : 0.0;
+        }
+    }
+    return 0.0;
+}
+
+bool RuleExpression::evaluate(const ContentItem& item) const {
+    if (root_ < 0) {
+        return false;
+    }
+    return evaluateNode(root_, item);
+}
+
+bool RuleExpression::evaluateNode(int32_t index, const ContentItem& item) const {
+    const Node& node = nodes_[static_cast<size_t>(index)];
+    switch (node.kind) {
+        case Kind::Constant:
+            return node.constant;
+        case Kind::Not:
+            return !evaluateNode(node.left, item);
+        case Kind::And:
+            return evaluateNode(node.left, item) && evaluateNode(node.right, item);
+        case Kind::Or:
+            return evaluateNode(node.left, item) || evaluateNode(node.right, item);
+        case Kind::Compare:
+            return compare(node, item);
+    }
+    return false;
+}
+
+bool RuleExpression::compare(const Node& node, const ContentItem& item) const {
+    static const Symbol noLabel;
+    const Symbol& label = node.field == RuleField::Label ? labels_[node.label] : noLabel;
+    return compareValue(node.op, fieldValue(node.field, label, item), node.threshold);
+}
+
+bool RuleExpression::compareValue(Op op, double value, double threshold) {
+    switch (op) {
+        case Op::Greater: return value > threshold;
+        case Op::GreaterEqual: return value >= threshold;
+        case Op::Less: return value < threshold;
+        case Op::LessEqual: return value <= threshold;
+        case Op::Equal: return std::abs(value - threshold) < 0.0001;
+        case Op::NotEqual: return std::abs(value - threshold) >= 0.0001;
+    }
+    return false;
+}
+
+void RuleExpression::evaluateColumns(const RuleColumns& columns, uint8_t* out, std::vector<uint8_t>& scratch) const {
+    size_t rows = columns.rows();
+    if (root_ < 0) {
+        std::fill(out, out + rows, uint8_t{0});
+        return;
+    }
+    // One row buffer per tree level is enough: a node only needs its
+    // right operand's buffer while its left result sits in `out`
+    if (scratch.size() < rows * nodes_.size()) {
+        scratch.resize(rows * nodes_.size());
+    }
+    evaluateColumnsNode(root_, columns, out, scratch.data());
+}
+
+void RuleExpression::evaluateColumnsNode(int32_t index, const RuleColumns& columns, uint8_t* out,
+                                         uint8_t* scratch) const {
+    const Node& node = nodes_[static_cast<size_t>(index)];
+    const size_t rows = columns.rows();
+    switch (node.kind) {
+        case Kind::Constant:
+            std::fill(out, out + rows, static_cast<uint8_t>(node.constant));
+            return;
+        case Kind::Not:
+            evaluateColumnsNode(node.left, columns, out, scratch);
+            for (size_t i = 0; i < rows; ++i) {
+                out[i] ^= 1;
+            }
+            return;
+        case Kind::And:
+        case Kind::Or: {
+            evaluateColumnsNode(node.left, columns, out, scratch);
+            evaluateColumnsNode(node.right, columns, scratch, scratch + rows);
+            if (node.kind == Kind::And) {
+                for (size_t i = 0; i < rows; ++i) {
+                    out[i] &= scratch[i];
+                }
+            } else {
+                for (size_t i = 0; i < rows; ++i) {
+                    out[i] |= scratch[i];
+                }
+            }
+            return;
+        }
+        case Kind::Compare:
+            break;
+    }
+
+    static const Symbol noLabel;
+    const double* values = columns.column(node.field, node.field == RuleField::Label ? labels_[node.label] : noLabel);
+    const double threshold = node.threshold;
+    if (!values) {
+        std::fill(out, out + rows, static_cast<uint8_t>(compareValue(node.op, 0.0, threshold)));
+        return;
+    }
+    // A loop per operator keeps the bodies branch-free
+    switch (node.op) {
+        case Op::Greater:
+            for (size_t i = 0; i < rows; ++i) out[i] = values[i] > threshold;
+            break;
+        case Op::GreaterEqual:
+            for (size_t i = 0; i < rows; ++i) out[i] = values[i] >= threshold;
+            break;
+        case Op::Less:
+            for (size_t i = 0; i < rows; ++i) out[i] = values[i] < threshold;
+            break;
+        case Op::LessEqual:
+            for (size_t i = 0; i < rows; ++i) out[i] = values[i] <= threshold;
+            break;
+        case Op::Equal:
+            for (size_t i = 0; i < rows; ++i) out[i] = std::abs(values[i] - threshold) < 0.0001;
+            break;
+        case Op::NotEqual:
+            for (size_t i = 0; i < rows; ++i) out[i] = std::abs(values[i] - threshold) >= 0.0001;
+            break;
+    }
+}
+
+RuleExpression::Truth RuleExpression::evaluatePartial(const ContentItem& item, RuleInputs known) const {
+    if (root_ < 0) {
+        return Truth::False;
+    }
+    if ((inputs_ & ~known) == 0) {
+        return evaluateNode(root_, item) ? Truth::True : Truth::False;
+    }
+    return evaluatePartialNode(root_, item, known);
+}
+
+RuleExpression::Truth RuleExpression::evaluatePartialNode(int32_t index, const ContentItem& item,
+                                                          RuleInputs known) const {
+    const Node& node = nodes_[static_cast<size_t>(index)];
+    switch (node.kind) {
+        case Kind::Constant:
+            return node.constant ? Truth::True : Truth::False;
+        case Kind::Not: {
+            Truth operand = evaluatePartialNode(node.left, item, known);
+            if (operand == Truth::Unknown) {
+                return Truth::Unknown;
+            }
+            return operand == Truth::True ? Truth::False : Truth::True;
+        }
+        case Kind::And: {
+            Truth left = evaluatePartialNode(node.left, item, known);
+            if (left == Truth::False) {
+                return Truth::False;
+            }
+            Truth right = evaluatePartialNode(node.right, item, known);
+            if (right == Truth::False) {
+                return Truth::False;
+            }
+            return left == Truth::True && right == Truth::True ? Truth::True : Truth::Unknown;
+        }
+        case Kind::Or: {
+            Truth left = evaluatePartialNode(node.left, item, known);
+            if (left == Truth::True) {
+                return Truth::True;
+            }
+            Truth right = evaluatePartialNode(node.right, item, known);
+            if (right == Truth::True) {
+                return Truth::True;
+            }
+            return left == Truth::False && right == Truth::False ? Truth::False : Truth::Unknown;
+        }
+        case Kind::Compare:
+            if ((inputFor(node.field) & known) == 0) {
+                return Truth::Unknown;
+            }
+            return compare(node, item) ? Truth::True : Truth::False;
+    }
+    return Truth::False;
+}
+
+} // namespace ModAI
@@ -0,0 +1,51 @@
+#include "core/Symbol.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ModAI {
+
+namespace {
+
+struct Pool {
+    std::mutex mutex;
+    // Keys view their own entry, so lookups need no temporary string
+    std::unordered_map<std::string_view, std::unique_ptr<const std::string>> strings;
+};
+
+Pool& pool() {
+    // Leaked on purpose: Symbols in static objects may outlive a static pool
+    static Pool* instance = new Pool();
+    return *instance;
+}
+
+} // namespace
+
+const std::string& Symbol::emptyString() {
+    static const std::string empty;
+    return empty;
+}
+
+const std::string* Symbol::intern(std::string_view text) {
+    if (text.empty()) {
+        return &emptyString();
+    }
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    auto it = p.strings.find(text);
+    if (it != p.strings.end()) {
+        return it->second.get();
+    }
+    auto entry = std::make_unique<const std::string>(text);
+    const std::string* interned = entry.get();
+    p.strings.emplace(std::string_view(*interned), std::move(entry));
+    return interned;
+}
+
+size_t Symbol::poolSize() {
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return p.strings.size();
+}
+
+} // namespace ModAI
@@ -0,0 +1,30 @@
+#include "core/WorkQueue.h"
+#include "core/IngestScheduler.h"
+#ifdef USE_REDIS
+#include "core/RedisWorkQueue.h"
+#endif
+#include "utils/Logger.h"
+
+namespace ModAI {
+
+std::unique_ptr<WorkQueue> makeWorkQueue(const WorkQueueConfig& config) {
+    if (config.type == "redis") {
+#ifdef USE_REDIS
+        auto queue = std::make_unique<RedisWorkQueue>(config);
+        if (queue->connect()) {
+            Logger::info("Work queue: Redis stream " + config.stream + " on " + config.redisHost + ":" +
+                         std::to_string(config.redisPort) + ", group " + config.group);
+            return queue;
+        }
+        Logger::error("Could not reach Redis at " + config.redisHost + ":" + std::to_string(config.redisPort) +
+                      ", using the in-process work queue");
+#else
+        Logger::error("Built without hiredis; the redis work queue is unavailable, using the in-process one");
+#endif
+    } else if (config.type != "inprocess") {
+        Logger::error("Unknown work queue type '" + config.type + "', using the in-process one");
+    }
+    return std::make_unique<IngestScheduler>(config);
+}
+
+} // namespace ModAI
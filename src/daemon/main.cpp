@@ -0,0 +1,209 @@
+// Headless moderation daemon: runs the scrape -> moderate -> store loop from
+// a config file, without a display. SIGINT/SIGTERM stop scraping and let the
+// pipeline finish what it already has before exiting; a second signal exits
+// immediately.
+//
+// Usage: modai_daemon [--config config/daemon.json]
+//        modai_daemon [--config ...] --backtest candidate_rules.json
+//        modai_daemon [--config ...] --reprocess
+//        modai_daemon [--config ...] --record traffic.jsonl
+//
+// --backtest replays a rules file over the stored history instead, printing
+// how often each rule fires and which recorded decisions it would change.
+// --reprocess also re-runs detection over the stored items selected by the
+// config's "reprocess" entry, behind live traffic; an interrupted run picks
+// up where it stopped. Without subreddits the daemon exits once it is done.
+// --record appends every Reddit and Hive exchange, with its latency, to a
+// file that modai_loadgen --recording replays offline.
+
+#include "core/ModerationService.h"
+#include "core/RuleBacktest.h"
+#include "core/RuleEngine.h"
+#include "storage/Storage.h"
+#include "network/HttpTransport.h"
+#include "network/QtHttpClient.h"
+#include "network/RecordingHttpClient.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+std::atomic<int> g_signals{0};
+
+extern "C" void onTerminate(int) {
+    if (g_signals.fetch_add(1) > 0) {
+        std::_Exit(128 + SIGTERM);
+    }
+}
+
+void dumpMetrics(const std::string& dataPath) {
+    ModAI::Metrics::dumpToFile(dataPath + "/metrics.prom", true);
+    ModAI::Metrics::dumpToFile(dataPath + "/metrics.json", false);
+}
+
+int runBacktest(const ModAI::ServiceConfig& config, const std::string& rulesPath) {
+    ModAI::RuleEngine candidate;
+    if (!candidate.loadRulesFromJson(rulesPath)) {
+        std::cerr << "Cannot load rules from " << rulesPath << "\n";
+        return 1;
+    }
+    auto storage = ModAI::ModerationService::openStorage(config.dataPath);
+    ModAI::RuleBacktest backtest;
+    auto loadStarted = std::chrono::steady_clock::now();
+    backtest.load(*storage, ModAI::ContentQuery());
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStarted).count();
+    ModAI::RuleBacktestReport report = backtest.run(*candidate.snapshot());
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Backtested " << report.items << " items (loaded in " << loadSeconds << "s, evaluated in "
+              << report.seconds << "s)\n";
+    for (const auto& rule : report.rules) {
+        std::cout << "  rule " << rule.id << " (" << rule.action << "): matched " << rule.matched
+                  << ", decided " << rule.decided << "\n";
+    }
+    std::cout << report.changed << " decisions would change\n";
+    for (const auto& transition : report.transitions) {
+        std::cout << "  " << (transition.from.empty() ? "(none)" : transition.from) << " -> " << transition.to
+                  << ": " << transition.count << "\n";
+    }
+    for (const auto& id : report.changedSamples) {
+        std::cout << "  e.g. " << id << "\n";
+    }
+    if (report.withoutModeration > 0) {
+        std::cout << report.withoutModeration << " items have no Hive labels; label rules see 0 for them\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("ModAI");
+    app.setOrganizationName("ModAI");
+
+    std::string configPath = "config/daemon.json";
+    std::string backtestRules;
+    bool reprocess = false;
+    std::string recordPath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--backtest") == 0 && i + 1 < argc) {
+            backtestRules = argv[++i];
+        } else if (std::strcmp(argv[i], "--reprocess") == 0) {
+            reprocess = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::cout << "Usage: " << argv[0]
+                      << " [--config <path>] [--backtest <rules.json>] [--reprocess] [--record <file>]\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << "\n";
+            return 2;
+        }
+    }
+
+    auto loaded = ModAI::ServiceConfig::fromJsonFile(configPath);
+    if (!loaded) {
+        return 1;
+    }
+    ModAI::ServiceConfig config = std::move(*loaded);
+    if (config.subreddits.empty() && backtestRules.empty() && !reprocess) {
+        ModAI::Logger::error("No subreddits configured in " + configPath);
+        return 1;
+    }
+    if (config.dataPath.empty()) {
+        config.dataPath = ModAI::ServiceConfig::defaultDataPath();
+    }
+    if (config.logFile.empty()) {
+        config.logFile = config.dataPath + "/logs/system.log";
+    }
+    QDir().mkpath(QFileInfo(QString::fromStdString(config.logFile)).absolutePath());
+    ModAI::Logger::init(config.logFile);
+    if (!backtestRules.empty()) {
+        int result = runBacktest(config, backtestRules);
+        ModAI::Logger::shutdown();
+        return result;
+    }
+    ModAI::Logger::info("Daemon started with " + configPath);
+
+    std::signal(SIGINT, onTerminate);
+    std::signal(SIGTERM, onTerminate);
+
+    if (!recordPath.empty()) {
+        auto writer = std::make_shared<ModAI::HttpRecordingWriter>(recordPath);
+        if (!writer->isOpen()) {
+            return 1;
+        }
+        config.httpClientFactory = [writer]() -> std::unique_ptr<ModAI::HttpClient> {
+            return std::make_unique<ModAI::RecordingHttpClient>(std::make_unique<ModAI::QtHttpClient>(), writer);
+        };
+        ModAI::Logger::info("Recording HTTP traffic to " + recordPath);
+    }
+
+    ModAI::ModerationService service(config);
+    service.setOnItemProcessed([](const ModAI::ContentItem& item) {
+        const std::string& action = item.decision.auto_action;
+        ModAI::Metrics::counter("modai_items_processed_total", "action=\"" + action + "\"").inc();
+        if (action != "allow") {
+            ModAI::Logger::info(action + ": " + item.id + " in r/" + item.subreddit.str() +
+                                (item.decision.rule_id.empty() ? "" : " (rule " + item.decision.rule_id + ")"));
+        }
+    });
+    service.start();
+    if (!config.subreddits.empty()) {
+        service.startScraping(config.subreddits, config.scrapeIntervalSeconds);
+    }
+    if (reprocess) {
+        const bool exitWhenDone = config.subreddits.empty();
+        service.startReprocessing(config.reprocess, [&app, exitWhenDone](size_t done, bool, const std::string&) {
+            ModAI::Logger::info("Reprocessing ended after " + std::to_string(done) + " items");
+            if (exitWhenDone) {
+                QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+            }
+        });
+    }
+
+    // Signal handlers only set a flag; the event loop notices it here
+    QTimer signalPoll;
+    QObject::connect(&signalPoll, &QTimer::timeout, &app, [&app]() {
+        if (g_signals.load() > 0) {
+            app.quit();
+        }
+    });
+    signalPoll.start(200);
+
+    QTimer metricsTimer;
+    if (config.metricsIntervalSeconds > 0) {
+        QObject::connect(&metricsTimer, &QTimer::timeout, &app, [&config]() {
+            dumpMetrics(config.dataPath);
+        });
+        metricsTimer.start(config.metricsIntervalSeconds * 1000);
+    }
+
+    int result = app.exec();
+
+    ModAI::Logger::info("Shutting down: finishing queued items");
+    service.stop(true);
+    if (config.metricsIntervalSeconds > 0) {
+        dumpMetrics(config.dataPath);
+    }
+    ModAI::HttpTransport::instance().shutdown();
+    ModAI::Logger::info("Daemon stopped");
+    ModAI::Logger::shutdown();
+    return result;
+}
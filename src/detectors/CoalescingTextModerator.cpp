@@ -0,0 +1,126 @@
+#include "detectors/CoalescingTextModerator.h"
+#include "utils/Logger.h"
+#include <algorithm>
+
+namespace ModAI {
+
+namespace {
+
+constexpr std::chrono::milliseconds kCancelPollInterval(50);
+
+} // namespace
+
+CoalescingTextModerator::CoalescingTextModerator(std::unique_ptr<TextModerator> inner,
+                                                 size_t maxBatchSize,
+                                                 std::chrono::milliseconds maxDelay)
+    : inner_(std::move(inner))
+    , maxBatchSize_(std::max<size_t>(1, maxBatchSize))
+    , maxDelay_(maxDelay) {
+    flusher_ = std::thread(&CoalescingTextModerator::flushLoop, this);
+}
+
+CoalescingTextModerator::~CoalescingTextModerator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+}
+
+TextModerationResult CoalescingTextModerator::analyzeText(const std::string& text) {
+    const CancellationToken& token = CancellationToken::current();
+    if (token.stopRequested()) {
+        return TextModerationResult();
+    }
+    std::future<TextModerationResult> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return TextModerationResult();
+        }
+        if (pending_.empty()) {
+            deadline_ = std::chrono::steady_clock::now() + maxDelay_;
+        }
+        pending_.push_back(Pending{text, {}, token});
+        future = pending_.back().result.get_future();
+    }
+    cv_.notify_one();
+    if (!token.cancellable()) {
+        return future.get();
+    }
+
+    // The batch still completes for the other callers; this one just stops
+    // waiting (polled, as a cancel can't interrupt a future wait)
+    while (future.wait_for(token.remaining(kCancelPollInterval)) != std::future_status::ready) {
+        if (token.stopRequested()) {
+            return TextModerationResult();
+        }
+    }
+    return future.get();
+}
+
+std::vector<TextModerationResult> CoalescingTextModerator::analyzeTexts(const std::vector<std::string>& texts) {
+    return inner_->analyzeTexts(texts);
+}
+
+void CoalescingTextModerator::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;  // stopping with nothing left to send
+        }
+
+        // Wait for a full batch or the oldest text's deadline
+        cv_.wait_until(lock, deadline_, [this] {
+            return stopping_ || pending_.size() >= maxBatchSize_;
+        });
+
+        std::vector<Pending> batch;
+        if (pending_.size() <= maxBatchSize_) {
+            batch.swap(pending_);
+        } else {
+            auto split = pending_.begin() + static_cast<std::ptrdiff_t>(maxBatchSize_);
+            batch.assign(std::make_move_iterator(pending_.begin()), std::make_move_iterator(split));
+            pending_.erase(pending_.begin(), split);
+            deadline_ = std::chrono::steady_clock::now();  // leftovers are already overdue
+        }
+        lock.unlock();
+
+        // Callers that gave up while their text was waiting aren't sent
+        batch.erase(std::remove_if(batch.begin(), batch.end(), [](Pending& entry) {
+            if (!entry.cancellation.stopRequested()) {
+                return false;
+            }
+            entry.result.set_value(TextModerationResult());
+            return true;
+        }), batch.end());
+        if (batch.empty()) {
+            lock.lock();
+            continue;
+        }
+
+        std::vector<std::string> texts;
+        texts.reserve(batch.size());
+        for (const auto& entry : batch) {
+            texts.push_back(entry.text);
+        }
+
+        std::vector<TextModerationResult> results;
+        try {
+            results = inner_->analyzeTexts(texts);
+        } catch (const std::exception& e) {
+            Logger::error("Batched text moderation failed: " + std::string(e.what()));
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].result.set_value(i < results.size() ? std::move(results[i]) : TextModerationResult());
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace ModAI
@@ -1,30 +1,47 @@
 #include "detectors/HiveImageModerator.h"
 #include "network/HttpClient.h"
+#include "network/ResponseParsers.h"
 #include "utils/Logger.h"
 #include <nlohmann/json.hpp>
 #include <chrono>
-#include <QByteArray>
 
 namespace ModAI {
 
-// Helper function to encode binary data to base64
-static std::string base64Encode(const std::vector<uint8_t>& data) {
-    QByteArray bytes(reinterpret_cast<const char*>(data.data()), data.size());
-    return bytes.toBase64().toStdString();
+// Appends base64 of data to out, which should already have room reserved
+static void appendBase64(std::string& out, const uint8_t* data, size_t size) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    for (; i + 2 < size; i += 3) {
+        uint32_t triple = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        out.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        out.push_back(kAlphabet[(triple >> 6) & 0x3F]);
+        out.push_back(kAlphabet[triple & 0x3F]);
+    }
+    if (i < size) {
+        uint32_t triple = uint32_t(data[i]) << 16;
+        if (i + 1 < size) {
+            triple |= uint32_t(data[i + 1]) << 8;
+        }
+        out.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? kAlphabet[(triple >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
 }
 
 HiveImageModerator::HiveImageModerator(std::unique_ptr<HttpClient> httpClient, 
                                        const std::string& apiKey)
     : httpClient_(std::move(httpClient))
     , apiKey_(apiKey)
-    , rateLimiter_(std::make_unique<RateLimiter>(100, std::chrono::seconds(60))) {
+    // One budget per API key, shared with every other Hive client using it
+    , rateLimiter_(RateLimiter::shared("hive:" + apiKey, 100, std::chrono::seconds(60))) {
     if (apiKey_.empty()) {
         Logger::warn("Hive API key is empty - image moderation will be skipped");
     }
 }
 
-VisualModerationResult HiveImageModerator::analyzeImage(const std::vector<uint8_t>& imageBytes, 
-                                                         const std::string& mime) {
+VisualModerationResult HiveImageModerator::analyzeImage(const SharedBytes& imageBytes) {
     VisualModerationResult result;
     
     // Skip if no API key
@@ -32,17 +49,23 @@ VisualModerationResult HiveImageModerator::analyzeImage(const std::vector<uint8_
         return result;
     }
     
-    rateLimiter_->waitIfNeeded();
+    if (!rateLimiter_->acquire(CancellationToken::current())) {
+        MODAI_LOG_DEBUG("Hive image moderation abandoned while rate limited");
+        return result;
+    }
     
     // Hive Visual Moderation API v3 - expects JSON body with base64-encoded image
     std::string url = "https://api.thehive.ai/api/v3/hive/visual-moderation";
     
-    // Build JSON request body
-    nlohmann::json requestBody;
-    requestBody["input"] = nlohmann::json::array();
-    nlohmann::json inputItem;
-    inputItem["media_base64"] = base64Encode(imageBytes);
-    requestBody["input"].push_back(inputItem);
+    // Build the JSON body by hand so the base64 text is written exactly
+    // once, straight into the buffer that goes on the wire
+    static const std::string kBodyPrefix = "{\"input\":[{\"media_base64\":\"";
+    static const std::string kBodySuffix = "\"}]}";
+    std::string body;
+    body.reserve(kBodyPrefix.size() + (imageBytes.size() + 2) / 3 * 4 + kBodySuffix.size());
+    body += kBodyPrefix;
+    appendBase64(body, imageBytes.data(), imageBytes.size());
+    body += kBodySuffix;
     
     HttpRequest req;
     req.url = url;
@@ -50,10 +73,11 @@ VisualModerationResult HiveImageModerator::analyzeImage(const std::vector<uint8_
     // V3 API uses Bearer token authorization
     req.headers["Authorization"] = "Bearer " + apiKey_;
     req.contentType = "application/json";
-    req.body = requestBody.dump();
+    req.binaryData = SharedBytes::fromString(std::move(body));
     
     try {
         HttpResponse response = httpClient_->post(req);
+        rateLimiter_->updateFromHeaders(response.headers, response.statusCode);
         
         if (!response.success) {
             Logger::error("Hive Visual Moderation API error: " + response.errorMessage);
@@ -66,35 +90,17 @@ VisualModerationResult HiveImageModerator::analyzeImage(const std::vector<uint8_
             return result;
         }
         
-        auto json = nlohmann::json::parse(response.body);
-        
         // Parse V3 Visual Moderation API response format
         // Expected: { "task_id": "...", "model": "hive/visual-moderation", "version": "1",
         //            "output": [ { "classes": [ { "class": "general_nsfw", "value": 0.99 }, ... ] } ] }
-        // Note: API returns "class" not "class_name"
-        if (json.contains("output") && json["output"].is_array() && !json["output"].empty()) {
-            const auto& firstOutput = json["output"][0];
-            
-            if (firstOutput.contains("classes") && firstOutput["classes"].is_array()) {
-                for (const auto& cls : firstOutput["classes"]) {
-                    // Handle both "class" and "class_name" keys for compatibility
-                    std::string className;
-                    if (cls.contains("class")) {
-                        className = cls["class"].get<std::string>();
-                    } else if (cls.contains("class_name")) {
-                        className = cls["class_name"].get<std::string>();
-                    } else {
-                        continue;
-                    }
-                    
-                    if (cls.contains("value")) {
-                        double value = cls["value"].get<double>();
-                        result.labels[className] = value;
-                    }
-                }
-                
-                Logger::debug("Hive Visual Moderation: Found " + std::to_string(result.labels.size()) + " classifications");
+        // Older responses name the class "class_name"; the parser accepts both
+        auto outputs = parseHiveOutputs(response.body);
+        if (outputs && !outputs->empty()) {
+            result.ok = true;
+            for (auto& cls : outputs->front()) {
+                result.labels[std::move(cls.name)] = cls.value;
             }
+            MODAI_LOG_DEBUG("Hive Visual Moderation: Found " + std::to_string(result.labels.size()) + " classifications");
         } else {
             Logger::warn("Hive Visual Moderation: Unexpected response format - no output array found");
         }
@@ -1,102 +1,159 @@
 #include "detectors/HiveTextModerator.h"
 #include "network/HttpClient.h"
+#include "network/ResponseParsers.h"
 #include "utils/Logger.h"
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <chrono>
 
 namespace ModAI {
 
+namespace {
+
+// At most maxBytes of text, cut back to a code point boundary
+std::string truncateUtf8(const std::string& text, size_t maxBytes) {
+    if (text.size() <= maxBytes) {
+        return text;
+    }
+    size_t cut = maxBytes;
+    // Back off continuation bytes (10xxxxxx) to the start of their sequence
+    while (cut > 0 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) {
+        --cut;
+    }
+    return text.substr(0, cut);
+}
+
+} // namespace
+
 HiveTextModerator::HiveTextModerator(std::unique_ptr<HttpClient> httpClient, 
                                      const std::string& apiKey)
     : httpClient_(std::move(httpClient))
     , apiKey_(apiKey)
-    , rateLimiter_(std::make_unique<RateLimiter>(100, std::chrono::seconds(60))) {
+    // One budget per API key, shared with every other Hive client using it
+    , rateLimiter_(RateLimiter::shared("hive:" + apiKey, 100, std::chrono::seconds(60))) {
     if (apiKey_.empty()) {
         Logger::warn("Hive API key is empty - text moderation will be skipped");
     }
 }
 
 TextModerationResult HiveTextModerator::analyzeText(const std::string& text) {
-    TextModerationResult result;
+    return analyzeTexts({text}).front();
+}
+
+std::vector<TextModerationResult> HiveTextModerator::analyzeTexts(const std::vector<std::string>& texts) {
+    std::vector<TextModerationResult> results(texts.size());
     
     // Skip if no API key
     if (apiKey_.empty()) {
-        return result;
+        return results;
     }
     
-    rateLimiter_->waitIfNeeded();
+    for (size_t begin = 0; begin < texts.size(); begin += kMaxInputsPerRequest) {
+        size_t end = std::min(texts.size(), begin + kMaxInputsPerRequest);
+        analyzeChunk(texts, begin, end, results);
+    }
+    return results;
+}
+
+void HiveTextModerator::analyzeChunk(const std::vector<std::string>& texts, size_t begin, size_t end,
+                                     std::vector<TextModerationResult>& results) {
+    // Serialized one by one, so a text that can't be sent fails alone
+    std::string inputs;
+    std::vector<size_t> sent;  // index into texts of each input, in order
+    for (size_t i = begin; i < end; ++i) {
+        try {
+            // Hive API has 1024 character limit
+            std::string processedText = truncateUtf8(texts[i], 1024);
+            if (processedText.size() < texts[i].size()) {
+                MODAI_LOG_DEBUG("Truncated text from " + std::to_string(texts[i].length()) + " to " +
+                                std::to_string(processedText.size()) + " bytes for Hive API");
+            }
+            // Malformed UTF-8 is sent as U+FFFD rather than failing the request
+            nlohmann::json input = {{"text", std::move(processedText)}};
+            std::string json = input.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            if (!inputs.empty()) {
+                inputs += ',';
+            }
+            inputs += json;
+            sent.push_back(i);
+        } catch (const std::exception& e) {
+            Logger::error("Skipping text for Hive moderation: " + std::string(e.what()));
+        }
+    }
+    if (sent.empty()) {
+        return;
+    }
+
+    // The batch is abandoned (results stay !ok) if its items are
+    // cancelled or out of time before a token frees up
+    if (!rateLimiter_->acquire(CancellationToken::current())) {
+        MODAI_LOG_DEBUG("Hive text moderation abandoned while rate limited");
+        return;
+    }
     
     // Hive text moderation v3 API
     std::string url = "https://api.thehive.ai/api/v3/hive/text-moderation";
     
-    // Hive API has 1024 character limit
-    std::string processedText = text;
-    if (processedText.length() > 1024) {
-        processedText = processedText.substr(0, 1024);
-        Logger::debug("Truncated text from " + std::to_string(text.length()) + " to 1024 chars for Hive API");
-    }
-    
     HttpRequest req;
     req.url = url;
     req.method = "POST";
     req.headers["Authorization"] = "Bearer " + apiKey_;
     req.headers["Content-Type"] = "application/json";
-    
-    nlohmann::json payload;
-    payload["input"] = nlohmann::json::array();
-    payload["input"][0]["text"] = processedText;
-    req.body = payload.dump();
+    req.body = "{\"input\":[" + inputs + "]}";
     
     try {
         HttpResponse response = httpClient_->post(req);
+        rateLimiter_->updateFromHeaders(response.headers, response.statusCode);
         
         // Qt may report error code 302 (protocol error) but body is still valid
         // Check HTTP status code first
         if (response.statusCode != 200 && response.statusCode != 0) {
             Logger::error("Hive Text API returned status: " + std::to_string(response.statusCode));
             Logger::error("Response body: " + response.body);
-            return result;
+            return;
         }
         
         // If no status code but Qt reports error, check if we have body anyway
         if (!response.success && response.body.empty()) {
             Logger::error("Hive Text API error: " + response.errorMessage);
-            return result;
+            return;
         }
         
-        auto json = nlohmann::json::parse(response.body);
-        
-        // Parse v3 API response format
-        if (json.contains("output") && json["output"].is_array() && !json["output"].empty()) {
-            auto& output = json["output"][0];
-            
-            if (output.contains("classes") && output["classes"].is_array()) {
-                for (const auto& classObj : output["classes"]) {
-                    if (classObj.contains("class") && classObj.contains("value")) {
-                        std::string className = classObj["class"].get<std::string>();
-                        int value = classObj["value"].get<int>();
-                        
-                        // Convert 0-3 scale to 0.0-1.0 confidence
-                        double confidence = value / 3.0;
-                        
-                        if (confidence > 0.0) {
-                            result.labels.push_back({className, confidence});
-                            Logger::debug("Hive label: " + className + " = " + std::to_string(confidence) + 
-                                        " (raw value: " + std::to_string(value) + ")");
-                        }
-                    }
-                }
+        // Parse v3 API response format: one output per input, in order
+        if (auto outputs = parseHiveOutputs(response.body)) {
+            if (outputs->size() != sent.size()) {
+                Logger::warn("Hive Text API returned " + std::to_string(outputs->size()) +
+                             " outputs for " + std::to_string(sent.size()) + " inputs");
+            }
+            for (size_t i = 0; i < outputs->size() && i < sent.size(); ++i) {
+                results[sent[i]] = parseOutput((*outputs)[i]);
             }
         }
         
-        Logger::debug("Hive moderation found " + std::to_string(result.labels.size()) + " labels");
+        MODAI_LOG_DEBUG("Hive moderation processed " + std::to_string(sent.size()) + " texts in one request");
         
     } catch (const std::exception& e) {
         Logger::error("Exception in HiveTextModerator: " + std::string(e.what()));
     }
+}
+
+TextModerationResult HiveTextModerator::parseOutput(const std::vector<HiveClass>& classes) {
+    TextModerationResult result;
+    result.ok = true;
     
+    for (const auto& cls : classes) {
+        int value = static_cast<int>(cls.value);
+        
+        // Convert 0-3 scale to 0.0-1.0 confidence
+        double confidence = value / 3.0;
+        
+        if (confidence > 0.0) {
+            result.labels.push_back({cls.name, confidence});
+            MODAI_LOG_DEBUG("Hive label: " + cls.name + " = " + std::to_string(confidence) + 
+                        " (raw value: " + std::to_string(value) + ")");
+        }
+    }
     return result;
 }
 
 } // namespace ModAI
-
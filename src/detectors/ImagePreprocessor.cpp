@@ -0,0 +1,131 @@
+#include "detectors/ImagePreprocessor.h"
+#include "utils/Logger.h"
+#include <QBuffer>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QPainter>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+namespace ModAI {
+
+namespace {
+
+PreparedImage prepared(SharedBytes bytes) {
+    PreparedImage image;
+    image.bytes = std::move(bytes);
+    image.ok = !image.bytes.empty();
+    return image;
+}
+
+} // namespace
+
+ImagePreprocessor::ImagePreprocessor(ImagePreprocessOptions options)
+    : options_(options) {
+    options_.maxDimension = std::max(options_.maxDimension, 64);
+    options_.jpegQuality = std::clamp(options_.jpegQuality, 1, 100);
+}
+
+std::string ImagePreprocessor::sniffMime(const char* data, size_t size) {
+    auto startsWith = [data, size](const char* magic, size_t length, size_t offset = 0) {
+        return size >= offset + length && std::memcmp(data + offset, magic, length) == 0;
+    };
+    if (startsWith("\xFF\xD8\xFF", 3)) return "image/jpeg";
+    if (startsWith("\x89PNG\r\n\x1A\n", 8)) return "image/png";
+    if (startsWith("GIF8", 4)) return "image/gif";
+    if (startsWith("RIFF", 4) && startsWith("WEBP", 4, 8)) return "image/webp";
+    return "application/octet-stream";
+}
+
+std::string ImagePreprocessor::cachePathFor(const std::string& imagePath) const {
+    return imagePath + "." + std::to_string(options_.maxDimension) + "q" +
+           std::to_string(options_.jpegQuality) + ".jpg";
+}
+
+PreparedImage ImagePreprocessor::prepare(const std::string& imagePath) const {
+    QString path = QString::fromStdString(imagePath);
+    QString cachePath = QString::fromStdString(cachePathFor(imagePath));
+
+    QFileInfo cached(cachePath);
+    if (cached.exists() && cached.lastModified() >= QFileInfo(path).lastModified()) {
+        SharedBytes bytes = SharedBytes::mapFile(cachePath.toStdString());
+        if (!bytes.empty()) {
+            return prepared(std::move(bytes));
+        }
+    }
+
+    SharedBytes original = SharedBytes::mapFile(imagePath);
+    if (original.empty()) {
+        Logger::error("Failed to open image file: " + imagePath);
+        return PreparedImage();
+    }
+    std::string originalMime = sniffMime(original.chars(), original.size());
+
+    // Decode from the mapping, not a copy
+    QByteArray originalData = original.toRawQByteArray();
+    QBuffer source(&originalData);
+    source.open(QIODevice::ReadOnly);
+    QImageReader reader(&source);
+    reader.setAutoTransform(true);
+    QSize size = reader.size();
+    const int maxDimension = options_.maxDimension;
+    const bool oversized = size.isValid() && std::max(size.width(), size.height()) > maxDimension;
+
+    if (size.isValid() && !oversized &&
+        original.size() <= options_.passthroughBytes &&
+        (originalMime == "image/jpeg" || originalMime == "image/webp")) {
+        return prepared(original);
+    }
+
+    if (oversized) {
+        // JPEG decodes straight to the reduced size instead of full-res then scale
+        reader.setScaledSize(size.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) {
+        Logger::warn("Could not decode " + imagePath + " (" + reader.errorString().toStdString() +
+                     "), uploading original");
+        return prepared(original);
+    }
+    if (std::max(image.width(), image.height()) > maxDimension) {
+        // Formats without scaled decoding ignore setScaledSize
+        image = image.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (image.hasAlphaChannel()) {
+        // JPEG has no alpha; flatten onto white rather than black
+        QImage flattened(image.size(), QImage::Format_RGB32);
+        flattened.fill(Qt::white);
+        QPainter painter(&flattened);
+        painter.drawImage(0, 0, image);
+        painter.end();
+        image = flattened;
+    }
+
+    QByteArray encoded;
+    QBuffer sink(&encoded);
+    sink.open(QIODevice::WriteOnly);
+    if (!image.save(&sink, "JPEG", options_.jpegQuality)) {
+        Logger::warn("Failed to re-encode " + imagePath + ", uploading original");
+        return prepared(original);
+    }
+    if (static_cast<size_t>(encoded.size()) >= original.size() && !oversized) {
+        // Already compact; re-encoding would only lose quality
+        return prepared(original);
+    }
+
+    QSaveFile cacheFile(cachePath);
+    if (cacheFile.open(QIODevice::WriteOnly)) {
+        cacheFile.write(encoded);
+        if (!cacheFile.commit()) {
+            Logger::warn("Failed to cache preprocessed image " + cachePath.toStdString());
+        }
+    }
+
+    MODAI_LOG_DEBUG("Preprocessed " + imagePath + ": " + std::to_string(original.size()) + " -> " +
+                  std::to_string(encoded.size()) + " bytes");
+    return prepared(SharedBytes::fromQByteArray(encoded));
+}
+
+} // namespace ModAI
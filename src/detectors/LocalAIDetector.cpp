@@ -1,313 +1,505 @@
 #include "detectors/LocalAIDetector.h"
+#include "detectors/OnnxSessionRegistry.h"
 #include "utils/Logger.h"
-#include <fstream>
-#include <sstream>
+#include "utils/Metrics.h"
 #include <algorithm>
-#include <unordered_map>
-
-#ifdef ONNXRUNTIME_FOUND
-#include <onnxruntime_cxx_api.h>
-#endif
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 namespace ModAI {
 
-// Simple tokenizer implementation for DeBERTa
-class SimpleTokenizer {
-public:
-    SimpleTokenizer(const std::string& vocabPath) {
-        loadVocab(vocabPath);
-    }
+// PIMPL implementation
+struct LocalAIDetector::Impl {
+    // Shared with every other detector using the same model file
+    std::shared_ptr<const OnnxModel> model;
     
-    std::vector<int64_t> encode(const std::string& text, int maxLength) {
-        std::vector<int64_t> tokens;
-        
-        // Add [CLS] token
-        tokens.push_back(getTokenId("[CLS]"));
-        
-        // SentencePiece-style tokenization (used by DeBERTa)
-        std::istringstream iss(text);
-        std::string word;
-        
-        while (iss >> word && tokens.size() < maxLength - 1) {
-            // Split trailing punctuation from word
-            while (!word.empty() && std::ispunct(word.back()) && tokens.size() < maxLength - 1) {
-                char punct = word.back();
-                word.pop_back();
-                
-                // Queue punctuation token for later
-                if (!word.empty()) {
-                    // Process word first
-                    std::string spToken = "\u2581" + word;
-                    auto it = vocab_.find(spToken);
-                    if (it != vocab_.end()) {
-                        tokens.push_back(it->second);
-                    } else {
-                        tokens.push_back(getTokenId("[UNK]"));
-                    }
-                    word.clear();
-                }
-                
-                // Then add punctuation (without ▁ prefix for punctuation)
-                std::string punctStr(1, punct);
-                auto punct_it = vocab_.find(punctStr);
-                if (punct_it != vocab_.end()) {
-                    tokens.push_back(punct_it->second);
-                } else {
-                    // Try with ▁ prefix
-                    std::string spPunct = "\u2581" + punctStr;
-                    punct_it = vocab_.find(spPunct);
-                    if (punct_it != vocab_.end()) {
-                        tokens.push_back(punct_it->second);
-                    } else {
-                        tokens.push_back(getTokenId("[UNK]"));
-                    }
-                }
-            }
-            
-            // Process remaining word (if any)
-            if (!word.empty()) {
-                std::string spToken = "\u2581" + word;
-                auto it = vocab_.find(spToken);
-                if (it != vocab_.end()) {
-                    tokens.push_back(it->second);
-                } else {
-                    tokens.push_back(getTokenId("[UNK]"));
-                }
+#ifdef ONNXRUNTIME_FOUND
+    // Tensors over a set of buffers, bound to the session for one {N, L} shape
+    struct ShapeBinding {
+        std::vector<Ort::Value> tensors;  // input_ids, attention_mask, output
+        Ort::IoBinding binding;
+        explicit ShapeBinding(Ort::Session& session) : binding(session) {}
+    };
+    
+    // Each run packs into a set of buffers checked out of a small pool,
+    // sized for the largest batch it has seen, so runs neither allocate
+    // nor rebind. Pooled rather than per thread: pool threads come and go.
+    struct WorkerBuffers {
+        std::vector<int64_t> inputIds;
+        std::vector<int64_t> attentionMask;
+        std::vector<float> output;
+        std::map<std::pair<size_t, size_t>, std::unique_ptr<ShapeBinding>> shapes;
+    };
+    
+    static constexpr size_t kMaxBoundShapes = 64;
+    // Sets kept between runs; more concurrent runs allocate and drop theirs
+    static constexpr size_t kMaxIdleBuffers = 8;
+    
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    // Declared after model so bindings are released before the session
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<WorkerBuffers>> idleBuffers;
+    
+    // Returns its buffers to the pool when it goes out of scope
+    struct BuffersLease {
+        Impl& impl;
+        std::unique_ptr<WorkerBuffers> buffers;
+        ~BuffersLease() {
+            std::lock_guard<std::mutex> lock(impl.buffersMutex);
+            if (impl.idleBuffers.size() < kMaxIdleBuffers) {
+                impl.idleBuffers.push_back(std::move(buffers));
             }
         }
-        
-        // Add [SEP] token
-        tokens.push_back(getTokenId("[SEP]"));
-        
-        // Pad or truncate to maxLength
-        if (tokens.size() < maxLength) {
-            tokens.resize(maxLength, getTokenId("[PAD]"));
-        } else if (tokens.size() > maxLength) {
-            tokens.resize(maxLength);
-            tokens[maxLength - 1] = getTokenId("[SEP]");
+    };
+    
+    BuffersLease leaseBuffers() {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        if (idleBuffers.empty()) {
+            return BuffersLease{*this, std::make_unique<WorkerBuffers>()};
         }
-        
-        return tokens;
+        auto buffers = std::move(idleBuffers.back());
+        idleBuffers.pop_back();
+        return BuffersLease{*this, std::move(buffers)};
     }
     
-    std::vector<int64_t> getAttentionMask(const std::vector<int64_t>& tokens) {
-        std::vector<int64_t> mask;
-        int64_t padId = getTokenId("[PAD]");
-        
-        for (auto token : tokens) {
-            mask.push_back(token != padId ? 1 : 0);
+    ShapeBinding& bind(WorkerBuffers& worker, size_t batchSize, size_t rowLength) {
+        auto key = std::make_pair(batchSize, rowLength);
+        auto it = worker.shapes.find(key);
+        if (it != worker.shapes.end()) {
+            return *it->second;
         }
         
-        return mask;
-    }
-
-private:
-    std::unordered_map<std::string, int64_t> vocab_;
-    
-    void loadVocab(const std::string& path) {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            Logger::error("Failed to load vocabulary from: " + path);
-            return;
+        // Growing the buffers moves them, which invalidates every bound tensor
+        const size_t elements = batchSize * rowLength;
+        if (elements > worker.inputIds.size() || batchSize > worker.output.size()) {
+            worker.shapes.clear();
+            worker.inputIds.resize(std::max(elements, worker.inputIds.size()));
+            worker.attentionMask.resize(worker.inputIds.size());
+            worker.output.resize(std::max(batchSize, worker.output.size()));
+        } else if (worker.shapes.size() >= kMaxBoundShapes) {
+            worker.shapes.clear();
         }
         
-        std::string token;
-        int64_t id = 0;
+        auto shape = std::make_unique<ShapeBinding>(*model->session);
+        const int64_t inputShape[] = {static_cast<int64_t>(batchSize), static_cast<int64_t>(rowLength)};
+        const int64_t outputShape[] = {static_cast<int64_t>(batchSize), 1};
+        shape->tensors.push_back(Ort::Value::CreateTensor<int64_t>(
+            memoryInfo, worker.inputIds.data(), elements, inputShape, 2));
+        shape->tensors.push_back(Ort::Value::CreateTensor<int64_t>(
+            memoryInfo, worker.attentionMask.data(), elements, inputShape, 2));
+        // One probability per row, whether the output is {N} or {N, 1}
+        shape->tensors.push_back(Ort::Value::CreateTensor<float>(
+            memoryInfo, worker.output.data(), batchSize, outputShape, model->outputRank > 1 ? 2 : 1));
         
-        while (std::getline(file, token)) {
-            if (!token.empty()) {
-                vocab_[token] = id++;
-            }
-        }
+        shape->binding.BindInput("input_ids", shape->tensors[0]);
+        shape->binding.BindInput("attention_mask", shape->tensors[1]);
+        shape->binding.BindOutput(model->probabilityOutput.c_str(), shape->tensors[2]);
         
-        Logger::info("Loaded vocabulary with " + std::to_string(vocab_.size()) + " tokens");
-    }
-    
-    int64_t getTokenId(const std::string& token) {
-        auto it = vocab_.find(token);
-        if (it != vocab_.end()) {
-            return it->second;
-        }
-        // Return [UNK] token id, typically 1
-        auto unk_it = vocab_.find("[UNK]");
-        return unk_it != vocab_.end() ? unk_it->second : 1;
+        auto& bound = *shape;
+        worker.shapes.emplace(key, std::move(shape));
+        return bound;
     }
-};
-
-// PIMPL implementation
-struct LocalAIDetector::Impl {
-#ifdef ONNXRUNTIME_FOUND
-    Ort::Env env;
-    std::unique_ptr<Ort::Session> session;
-    Ort::SessionOptions sessionOptions;
-    Ort::AllocatorWithDefaultOptions allocator;
 #endif
-    std::unique_ptr<SimpleTokenizer> tokenizer;
-    
-    Impl() 
-#ifdef ONNXRUNTIME_FOUND
-        : env(ORT_LOGGING_LEVEL_WARNING, "LocalAIDetector")
-#endif
-    {}
 };
 
 LocalAIDetector::LocalAIDetector(const std::string& modelPath,
                                  const std::string& tokenizerPath,
                                  int maxLength,
-                                 float threshold)
+                                 float threshold,
+                                 const OnnxSessionOptions& sessionOptions,
+                                 LoadMode loadMode)
     : impl_(std::make_unique<Impl>())
     , modelPath_(modelPath)
     , tokenizerPath_(tokenizerPath)
     , maxLength_(maxLength)
-    , threshold_(threshold)
-    , available_(false) {
+    , threshold_(threshold) {
+    
+    setLengthBuckets({64, 128, 256, 512, 768});
     
+    if (loadMode == LoadMode::Background) {
+        loader_ = std::thread([this, sessionOptions, buckets = lengthBuckets_]() {
+            load(sessionOptions, buckets);
+        });
+    } else {
+        load(sessionOptions, lengthBuckets_);
+    }
+}
+
+LocalAIDetector::~LocalAIDetector() {
+    // A load in progress cannot be cancelled; wait so it doesn't outlive us
+    if (loader_.joinable()) {
+        loader_.join();
+    }
+}
+
+std::string LocalAIDetector::variantModelPath(const std::string& modelDir, const std::string& variant) {
+    if (variant.empty() || variant == "fp32") {
+        return modelDir + "/ai_detector.onnx";
+    }
+    return modelDir + "/ai_detector." + variant + ".onnx";
+}
+
+void LocalAIDetector::load(const OnnxSessionOptions& sessionOptions, const std::vector<int>& warmUpLengths) {
 #ifdef ONNXRUNTIME_FOUND
     try {
-        // Load tokenizer
+        auto start = std::chrono::steady_clock::now();
+        // Load (or reuse) the session and tokenizer
         std::string vocabPath = tokenizerPath_ + "/vocab.txt";
-        impl_->tokenizer = std::make_unique<SimpleTokenizer>(vocabPath);
-        
-        // Initialize ONNX Runtime session
-        impl_->sessionOptions.SetIntraOpNumThreads(1);
-        impl_->sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+        impl_->model = OnnxSessionRegistry::instance().acquire(modelPath_, vocabPath, sessionOptions);
         
-        impl_->session = std::make_unique<Ort::Session>(
-            impl_->env,
-            modelPath_.c_str(),
-            impl_->sessionOptions
-        );
+        if (sessionOptions.warmUp) {
+            std::call_once(impl_->model->warmedUp, [this, &warmUpLengths]() { warmUp(warmUpLengths); });
+        }
         
-        available_ = true;
-        Logger::info("Local AI Detector initialized successfully with ONNX Runtime");
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        Logger::info("Local AI Detector initialized successfully with ONNX Runtime in " +
+                     std::to_string(elapsed.count()) + " ms");
         Logger::info("Model: " + modelPath_);
+        finishLoading(true);
     } catch (const std::exception& e) {
         Logger::error("Failed to initialize Local AI Detector: " + std::string(e.what()));
-        available_ = false;
+        finishLoading(false);
     }
 #else
+    (void)sessionOptions;
+    (void)warmUpLengths;
     Logger::warn("ONNX Runtime not available - Local AI Detector disabled");
     Logger::warn("Please install ONNX Runtime to use local inference");
-    available_ = false;
+    finishLoading(false);
 #endif
 }
 
-LocalAIDetector::~LocalAIDetector() = default;
+void LocalAIDetector::warmUp(const std::vector<int>& lengths) {
+    // Dummy ids (not pad, so the mask is all ones) filling each bucket
+    int64_t fillId = impl_->model->tokenizer ? impl_->model->tokenizer->unkId() : 1;
+    std::vector<TokenizedInput> inputs(lengths.size());
+    std::vector<size_t> member(1);
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        inputs[i].input_ids.assign(static_cast<size_t>(lengths[i]), fillId);
+        member[0] = i;
+        runPaddedBatch(inputs, member, lengths[i]);
+    }
+    MODAI_LOG_DEBUG("Warmed up " + modelPath_ + " for " + std::to_string(lengths.size()) + " sequence lengths");
+}
+
+void LocalAIDetector::finishLoading(bool available) {
+    std::vector<std::function<void(bool)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex_);
+        available_ = available;
+        loading_ = false;
+        callbacks.swap(loadCallbacks_);
+    }
+    loadCv_.notify_all();
+    for (auto& callback : callbacks) {
+        callback(available);
+    }
+}
 
 bool LocalAIDetector::isAvailable() const {
     return available_;
 }
 
-LocalAIDetector::TokenizedInput LocalAIDetector::tokenize(const std::string& text) {
+bool LocalAIDetector::isLoading() const {
+    std::lock_guard<std::mutex> lock(loadMutex_);
+    return loading_;
+}
+
+bool LocalAIDetector::waitUntilLoaded() const {
+    std::unique_lock<std::mutex> lock(loadMutex_);
+    loadCv_.wait(lock, [this]() { return !loading_; });
+    return available_;
+}
+
+void LocalAIDetector::whenLoaded(std::function<void(bool available)> callback) {
+    {
+        std::lock_guard<std::mutex> lock(loadMutex_);
+        if (loading_) {
+            loadCallbacks_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(available_);
+}
+
+LocalAIDetector::TokenizedInput LocalAIDetector::tokenize(const std::string& text, int maxLength) {
     TokenizedInput result;
     
-    if (!impl_->tokenizer) {
+    if (!impl_->model || !impl_->model->tokenizer) {
         return result;
     }
     
-    result.input_ids = impl_->tokenizer->encode(text, maxLength_);
-    result.attention_mask = impl_->tokenizer->getAttentionMask(result.input_ids);
+    static Histogram& tokenizeTime = Metrics::histogram("modai_tokenize_seconds");
+    ScopedTimer timer(tokenizeTime);
+    impl_->model->tokenizer->encode(text, maxLength, result.input_ids);
     
     return result;
 }
 
-float LocalAIDetector::runInference(const TokenizedInput& input) {
+std::optional<float> LocalAIDetector::runInference(const TokenizedInput& input) {
+    return runBatchInference({input}).front();
+}
+
+int LocalAIDetector::bucketLength(size_t tokenCount) const {
+    for (int bucket : lengthBuckets_) {
+        if (tokenCount <= static_cast<size_t>(bucket)) {
+            return bucket;
+        }
+    }
+    return maxLength_;
+}
+
+std::vector<std::optional<float>> LocalAIDetector::runBatchInference(const std::vector<TokenizedInput>& inputs) {
+    std::vector<std::optional<float>> probabilities(inputs.size());
+    if (inputs.empty()) {
+        return probabilities;
+    }
+    
+    // Group inputs by length bucket so each run pads only to its bucket
+    std::map<int, std::vector<size_t>> buckets;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        buckets[bucketLength(inputs[i].input_ids.size())].push_back(i);
+    }
+    
+    for (const auto& [seqLength, members] : buckets) {
+        auto bucketProbabilities = runPaddedBatch(inputs, members, seqLength);
+        for (size_t i = 0; i < members.size(); ++i) {
+            probabilities[members[i]] = bucketProbabilities[i];
+        }
+    }
+    
+    return probabilities;
+}
+
+std::vector<std::optional<float>> LocalAIDetector::runPaddedBatch(const std::vector<TokenizedInput>& inputs,
+                                                                  const std::vector<size_t>& members,
+                                                                  int seqLength) {
+    // Rows stay nullopt unless the run succeeds
+    std::vector<std::optional<float>> probabilities(members.size());
+    
 #ifdef ONNXRUNTIME_FOUND
     try {
-        // Prepare input tensors
-        std::vector<int64_t> inputShape = {1, static_cast<int64_t>(maxLength_)};
-        
-        auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-        
-        // Create input tensors
-        std::vector<Ort::Value> inputTensors;
-        inputTensors.push_back(Ort::Value::CreateTensor<int64_t>(
-            memoryInfo,
-            const_cast<int64_t*>(input.input_ids.data()),
-            input.input_ids.size(),
-            inputShape.data(),
-            inputShape.size()
-        ));
+        // Pack the batch row-major into pooled buffers bound as {N, seqLength};
+        // the attention mask covers each row's real tokens only
+        const size_t batchSize = members.size();
+        const size_t rowLength = static_cast<size_t>(seqLength);
+        auto lease = impl_->leaseBuffers();
+        auto& worker = *lease.buffers;
+        auto& shape = impl_->bind(worker, batchSize, rowLength);
         
-        inputTensors.push_back(Ort::Value::CreateTensor<int64_t>(
-            memoryInfo,
-            const_cast<int64_t*>(input.attention_mask.data()),
-            input.attention_mask.size(),
-            inputShape.data(),
-            inputShape.size()
-        ));
-        
-        // Input/output names
-        const char* inputNames[] = {"input_ids", "attention_mask"};
-        const char* outputNames[] = {"probability"};
+        int64_t* inputIds = worker.inputIds.data();
+        int64_t* attentionMask = worker.attentionMask.data();
+        std::fill(inputIds, inputIds + batchSize * rowLength, impl_->model->tokenizer->padId());
+        std::fill(attentionMask, attentionMask + batchSize * rowLength, 0);
+        for (size_t row = 0; row < batchSize; ++row) {
+            const auto& ids = inputs[members[row]].input_ids;
+            size_t count = std::min(ids.size(), rowLength);
+            std::copy(ids.begin(), ids.begin() + count, inputIds + row * rowLength);
+            std::fill(attentionMask + row * rowLength, attentionMask + row * rowLength + count, 1);
+        }
         
         // Run inference
-        auto outputTensors = impl_->session->Run(
-            Ort::RunOptions{nullptr},
-            inputNames,
-            inputTensors.data(),
-            2,
-            outputNames,
-            1
-        );
+        static Histogram& runTime = Metrics::histogram("modai_onnx_run_seconds");
+        auto runStart = std::chrono::steady_clock::now();
+        impl_->model->session->Run(Ort::RunOptions{nullptr}, shape.binding);
+        shape.binding.SynchronizeOutputs();
+        runTime.record(std::chrono::steady_clock::now() - runStart);
         
-        // Get probability output
-        float* outputData = outputTensors[0].GetTensorMutableData<float>();
-        return outputData[0];
+        std::copy(worker.output.begin(), worker.output.begin() + batchSize, probabilities.begin());
         
     } catch (const std::exception& e) {
         Logger::error("ONNX inference error: " + std::string(e.what()));
-        return 0.0f;
     }
 #else
-    return 0.0f;
+    (void)inputs;
+    (void)seqLength;
 #endif
+    
+    return probabilities;
 }
 
-TextDetectResult LocalAIDetector::analyze(const std::string& text) {
-    TextDetectResult result;
-    result.label = "unknown";
-    result.ai_score = 0.0;
-    result.confidence = 0.0;
+void LocalAIDetector::setLengthBuckets(std::vector<int> buckets) {
+    std::sort(buckets.begin(), buckets.end());
+    buckets.erase(std::remove_if(buckets.begin(), buckets.end(),
+                                 [this](int b) { return b <= 0 || b > maxLength_; }),
+                  buckets.end());
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+    if (buckets.empty() || buckets.back() != maxLength_) {
+        buckets.push_back(maxLength_);
+    }
+    lengthBuckets_ = std::move(buckets);
+}
+
+void LocalAIDetector::setChunking(const ChunkingOptions& options) {
+    chunking_ = options;
+    chunking_.maxChunks = std::max(1, chunking_.maxChunks);
+    // Consecutive windows must advance by at least a quarter window
+    chunking_.overlapTokens = std::clamp(chunking_.overlapTokens, 0, (maxLength_ - 2) * 3 / 4);
+}
+
+std::vector<LocalAIDetector::TokenizedInput> LocalAIDetector::splitWindows(const TokenizedInput& input) const {
+    // input is [CLS] body [SEP]; each window re-wraps a slice of the body
+    const auto& ids = input.input_ids;
+    const size_t bodyLength = ids.size() - 2;
+    const size_t windowBody = static_cast<size_t>(maxLength_ - 2);
+    const size_t stride = windowBody - static_cast<size_t>(chunking_.overlapTokens);
     
-    if (!available_) {
-        Logger::warn("Local AI Detector not available - skipping analysis");
-        return result;
+    std::vector<TokenizedInput> windows;
+    for (size_t start = 0; ; start += stride) {
+        // The last window is aligned to the end, so every window is full
+        // length and they all share one padded bucket
+        start = std::min(start, bodyLength - windowBody);
+        TokenizedInput window;
+        window.input_ids.reserve(static_cast<size_t>(maxLength_));
+        window.input_ids.push_back(ids.front());
+        window.input_ids.insert(window.input_ids.end(), ids.begin() + 1 + start,
+                                ids.begin() + 1 + start + windowBody);
+        window.input_ids.push_back(ids.back());
+        windows.push_back(std::move(window));
+        if (start + windowBody >= bodyLength) {
+            break;
+        }
+    }
+    return windows;
+}
+
+float LocalAIDetector::aggregateChunks(const std::vector<float>& scores, const std::vector<size_t>& weights) const {
+    using Aggregation = ChunkingOptions::Aggregation;
+    switch (chunking_.aggregation) {
+        case Aggregation::Max:
+            return *std::max_element(scores.begin(), scores.end());
+        case Aggregation::Mean: {
+            double sum = 0.0;
+            for (float score : scores) {
+                sum += score;
+            }
+            return static_cast<float>(sum / static_cast<double>(scores.size()));
+        }
+        case Aggregation::LengthWeighted:
+        default: {
+            double sum = 0.0;
+            double total = 0.0;
+            for (size_t i = 0; i < scores.size(); ++i) {
+                sum += static_cast<double>(scores[i]) * static_cast<double>(weights[i]);
+                total += static_cast<double>(weights[i]);
+            }
+            return total > 0.0 ? static_cast<float>(sum / total) : 0.0f;
+        }
     }
+}
+
+TextDetectResult LocalAIDetector::makeResult(float probability) const {
+    TextDetectResult result;
+    result.ai_score = probability;
+    result.confidence = std::abs(probability - 0.5f) * 2.0f; // Convert to 0-1 confidence
+    result.label = probability >= threshold_ ? "ai" : "human";
+    return result;
+}
+
+TextDetectResult LocalAIDetector::analyze(const std::string& text) {
+    return analyzeBatch({text}).front();
+}
+
+std::vector<TextDetectResult> LocalAIDetector::analyzeBatch(const std::vector<std::string>& texts) {
+    TextDetectResult unknown;
+    unknown.label = "unknown";
+    unknown.ai_score = 0.0;
+    unknown.confidence = 0.0;
+    std::vector<TextDetectResult> results(texts.size(), unknown);
     
-    if (text.empty() || text.length() < 10) {
-        result.label = "human";
-        result.ai_score = 0.0;
-        result.confidence = 1.0;
-        return result;
+    // Items arriving during a background load wait here rather than
+    // being scored "unknown"
+    if (!waitUntilLoaded()) {
+        Logger::warn("Local AI Detector not available - skipping analysis");
+        return results;
     }
     
     try {
-        // Tokenize input
-        auto tokenized = tokenize(text);
+        // Tokenize every text the model should see; short ones are human.
+        // With chunking, a long text contributes several windows to the batch
+        const size_t windowBody = static_cast<size_t>(maxLength_ - 2);
+        const size_t stride = windowBody - static_cast<size_t>(chunking_.overlapTokens);
+        const int tokenLimit = chunking_.enabled
+            ? static_cast<int>(windowBody + stride * static_cast<size_t>(chunking_.maxChunks - 1)) + 2
+            : maxLength_;
+        
+        std::vector<TokenizedInput> batch;
+        std::vector<size_t> batchIndex;
+        std::vector<size_t> chunkWeight;  // body tokens a window adds to its text
+        batch.reserve(texts.size());
+        batchIndex.reserve(texts.size());
+        chunkWeight.reserve(texts.size());
         
-        if (tokenized.input_ids.empty()) {
-            Logger::error("Tokenization failed");
-            return result;
+        for (size_t i = 0; i < texts.size(); ++i) {
+            if (texts[i].empty() || texts[i].length() < 10) {
+                results[i].label = "human";
+                results[i].ai_score = 0.0;
+                results[i].confidence = 1.0;
+                continue;
+            }
+            
+            auto tokenized = tokenize(texts[i], tokenLimit);
+            if (tokenized.input_ids.empty()) {
+                Logger::error("Tokenization failed");
+                continue;
+            }
+            if (tokenized.input_ids.size() <= static_cast<size_t>(maxLength_)) {
+                chunkWeight.push_back(tokenized.input_ids.size());
+                batch.push_back(std::move(tokenized));
+                batchIndex.push_back(i);
+                continue;
+            }
+            
+            size_t covered = 0;
+            const size_t bodyLength = tokenized.input_ids.size() - 2;
+            for (auto& window : splitWindows(tokenized)) {
+                size_t end = std::min(covered == 0 ? windowBody : covered + stride, bodyLength);
+                chunkWeight.push_back(end - covered);
+                covered = end;
+                batch.push_back(std::move(window));
+                batchIndex.push_back(i);
+            }
         }
         
-        // Run inference
-        float probability = runInference(tokenized);
+        // Run inference: one batched call for every text and window
+        auto probabilities = runBatchInference(batch);
         
-        // Set result
-        result.ai_score = probability;
-        result.confidence = std::abs(probability - 0.5f) * 2.0f; // Convert to 0-1 confidence
-        result.label = probability >= threshold_ ? "ai" : "human";
+        for (size_t begin = 0; begin < probabilities.size();) {
+            size_t end = begin + 1;
+            while (end < probabilities.size() && batchIndex[end] == batchIndex[begin]) {
+                ++end;
+            }
+            // A text with any window that failed to run stays "unknown"
+            bool scored = std::all_of(probabilities.begin() + begin, probabilities.begin() + end,
+                                      [](const std::optional<float>& p) { return p.has_value(); });
+            if (!scored) {
+                MODAI_LOG_DEBUG("AI detection failed for text " + std::to_string(batchIndex[begin]) + "; leaving it unknown");
+            } else if (end - begin == 1) {
+                results[batchIndex[begin]] = makeResult(*probabilities[begin]);
+            } else {
+                std::vector<float> scores;
+                for (size_t j = begin; j < end; ++j) {
+                    scores.push_back(*probabilities[j]);
+                }
+                std::vector<size_t> weights(chunkWeight.begin() + begin, chunkWeight.begin() + end);
+                auto& result = results[batchIndex[begin]];
+                result = makeResult(aggregateChunks(scores, weights));
+                result.chunk_scores.assign(scores.begin(), scores.end());
+            }
+            begin = end;
+        }
         
-        Logger::debug("AI Detection - Text length: " + std::to_string(text.length()) +
-                     ", Probability: " + std::to_string(probability) +
-                     ", Label: " + result.label);
+        MODAI_LOG_DEBUG("AI Detection - Batch size: " + std::to_string(batch.size()) +
+                     " of " + std::to_string(texts.size()) + " texts");
         
     } catch (const std::exception& e) {
         Logger::error("Exception in Local AI Detector: " + std::string(e.what()));
     }
     
-    return result;
+    return results;
 }
 
 } // namespace ModAI
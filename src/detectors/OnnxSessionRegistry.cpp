@@ -0,0 +1,208 @@
+#include "detectors/OnnxSessionRegistry.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef ONNXRUNTIME_FOUND
+#if defined(__APPLE__) && __has_include(<coreml_provider_factory.h>)
+#include <coreml_provider_factory.h>
+#define MODAI_HAVE_COREML 1
+#endif
+#if defined(_WIN32) && __has_include(<dml_provider_factory.h>)
+#include <dml_provider_factory.h>
+#define MODAI_HAVE_DML 1
+#endif
+#endif
+
+namespace ModAI {
+
+namespace {
+
+// warmUp is left out: it changes what the detector does, not the session
+std::string cacheKey(const std::string& modelPath, const std::string& vocabPath,
+                     const OnnxSessionOptions& options) {
+    std::string key = modelPath + '\n' + vocabPath + "\nintra=" + std::to_string(options.intraOpThreads);
+    if (options.parallelExecution) {
+        key += " inter=" + std::to_string(options.interOpThreads);
+    }
+    key += " device=" + std::to_string(options.deviceId) + " providers=";
+    for (const auto& provider : options.executionProviders) {
+        key += provider + ',';
+    }
+    return key;
+}
+
+} // namespace
+
+OnnxSessionRegistry& OnnxSessionRegistry::instance() {
+    static OnnxSessionRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<const OnnxModel> OnnxSessionRegistry::acquire(const std::string& modelPath,
+                                                              const std::string& vocabPath,
+                                                              const OnnxSessionOptions& options) {
+    // Loading happens under the lock so concurrent callers for the same
+    // path wait for one load instead of racing to create two sessions
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string key = cacheKey(modelPath, vocabPath, options);
+    auto it = models_.find(key);
+    if (it != models_.end()) {
+        if (auto existing = it->second.lock()) {
+            MODAI_LOG_DEBUG("Reusing loaded ONNX model: " + modelPath);
+            return existing;
+        }
+    }
+
+    auto model = load(modelPath, vocabPath, options);
+    models_[key] = model;
+    return model;
+}
+
+size_t OnnxSessionRegistry::loadedModelCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, model] : models_) {
+        if (!model.expired()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::shared_ptr<const OnnxModel> OnnxSessionRegistry::load(const std::string& modelPath,
+                                                           const std::string& vocabPath,
+                                                           const OnnxSessionOptions& options) {
+    auto model = std::make_shared<OnnxModel>();
+    model->modelPath = modelPath;
+
+    auto tokenizer = std::make_shared<Tokenizer>();
+    if (tokenizer->loadVocab(vocabPath)) {
+        Logger::info("Loaded vocabulary with " + std::to_string(tokenizer->vocabSize()) + " tokens");
+    } else {
+        Logger::error("Failed to load vocabulary from: " + vocabPath);
+    }
+    model->tokenizer = std::move(tokenizer);
+
+#ifdef ONNXRUNTIME_FOUND
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "ModAI");
+    }
+    model->env = env_;
+
+    auto makeSessionOptions = [&options]() {
+        Ort::SessionOptions sessionOptions;
+        sessionOptions.SetIntraOpNumThreads(options.intraOpThreads);
+        if (options.parallelExecution) {
+            sessionOptions.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+            sessionOptions.SetInterOpNumThreads(options.interOpThreads);
+        }
+        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+        return sessionOptions;
+    };
+
+    Ort::SessionOptions sessionOptions = makeSessionOptions();
+    model->executionProvider = appendExecutionProvider(sessionOptions, options);
+    try {
+        model->session = std::make_unique<Ort::Session>(*env_, modelPath.c_str(), sessionOptions);
+    } catch (const Ort::Exception& e) {
+        if (model->executionProvider == "cpu") {
+            throw;
+        }
+        // Provider libraries can still fail at session creation (missing
+        // CUDA runtime, unsupported device); fall back to CPU
+        Logger::warn("ONNX " + model->executionProvider + " session failed, using CPU: " + e.what());
+        model->executionProvider = "cpu";
+        model->session = std::make_unique<Ort::Session>(*env_, modelPath.c_str(), makeSessionOptions());
+    }
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    for (size_t i = 0; i < model->session->GetInputCount(); ++i) {
+        model->inputNames.push_back(model->session->GetInputNameAllocated(i, allocator).get());
+    }
+    for (size_t i = 0; i < model->session->GetOutputCount(); ++i) {
+        model->outputNames.push_back(model->session->GetOutputNameAllocated(i, allocator).get());
+    }
+    if (model->outputNames.empty()) {
+        throw std::runtime_error("ONNX model has no outputs: " + modelPath);
+    }
+    // The exporter emits {logits, probability}; older exports have probability only
+    auto probability = std::find(model->outputNames.begin(), model->outputNames.end(), "probability");
+    size_t probabilityIndex = probability == model->outputNames.end()
+        ? 0 : static_cast<size_t>(probability - model->outputNames.begin());
+    model->probabilityOutput = model->outputNames[probabilityIndex];
+    model->outputRank = std::max<size_t>(
+        1, model->session->GetOutputTypeInfo(probabilityIndex).GetTensorTypeAndShapeInfo().GetShape().size());
+
+    Logger::info("Loaded ONNX model: " + modelPath +
+                 " (provider: " + model->executionProvider +
+                 ", intra-op threads: " + std::to_string(options.intraOpThreads) +
+                 ", inter-op threads: " + std::to_string(options.interOpThreads) + ")");
+#else
+    (void)options;
+    throw std::runtime_error("ONNX Runtime not available");
+#endif
+
+    return model;
+}
+
+#ifdef ONNXRUNTIME_FOUND
+std::string OnnxSessionRegistry::appendExecutionProvider(Ort::SessionOptions& sessionOptions,
+                                                         const OnnxSessionOptions& options) {
+    if (options.executionProviders.empty()) {
+        return "cpu";
+    }
+    std::vector<std::string> available = Ort::GetAvailableProviders();
+    auto built = [&available](const char* name) {
+        return std::find(available.begin(), available.end(), name) != available.end();
+    };
+
+    for (const std::string& provider : options.executionProviders) {
+        try {
+            if (provider == "cpu") {
+                return "cpu";
+            } else if (provider == "cuda" && built("CUDAExecutionProvider")) {
+                OrtCUDAProviderOptions cuda{};
+                cuda.device_id = options.deviceId;
+                sessionOptions.AppendExecutionProvider_CUDA(cuda);
+                return provider;
+            } else if (provider == "tensorrt" && built("TensorrtExecutionProvider")) {
+                OrtTensorRTProviderOptions tensorrt{};
+                tensorrt.device_id = options.deviceId;
+                sessionOptions.AppendExecutionProvider_TensorRT(tensorrt);
+                // Nodes TensorRT can't take run on CUDA rather than CPU
+                if (built("CUDAExecutionProvider")) {
+                    OrtCUDAProviderOptions cuda{};
+                    cuda.device_id = options.deviceId;
+                    sessionOptions.AppendExecutionProvider_CUDA(cuda);
+                }
+                return provider;
+            } else if (provider == "openvino" && built("OpenVINOExecutionProvider")) {
+                OrtOpenVINOProviderOptions openvino{};
+                sessionOptions.AppendExecutionProvider_OpenVINO(openvino);
+                return provider;
+#ifdef MODAI_HAVE_COREML
+            } else if (provider == "coreml" && built("CoreMLExecutionProvider")) {
+                Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CoreML(sessionOptions, 0));
+                return provider;
+#endif
+#ifdef MODAI_HAVE_DML
+            } else if (provider == "directml" && built("DmlExecutionProvider")) {
+                // DirectML requires sequential execution without memory patterns
+                sessionOptions.DisableMemPattern();
+                sessionOptions.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+                Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_DML(sessionOptions, options.deviceId));
+                return provider;
+#endif
+            }
+            Logger::warn("ONNX execution provider not available in this build: " + provider);
+        } catch (const Ort::Exception& e) {
+            Logger::warn("ONNX execution provider " + provider + " failed: " + std::string(e.what()));
+        }
+    }
+    return "cpu";
+}
+#endif
+
+} // namespace ModAI
@@ -0,0 +1,248 @@
+#include "detectors/Tokenizer.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <utility>
+
+namespace ModAI {
+
+namespace {
+
+// U+2581 LOWER ONE EIGHTH BLOCK, SentencePiece's word-start marker
+constexpr std::string_view kWordStart = "\xE2\x96\x81";
+
+bool isSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+bool isPunct(char c) {
+    return std::ispunct(static_cast<unsigned char>(c)) != 0;
+}
+
+size_t utf8Length(char lead) {
+    auto byte = static_cast<unsigned char>(lead);
+    if (byte < 0x80) return 1;
+    if ((byte >> 5) == 0x6) return 2;
+    if ((byte >> 4) == 0xE) return 3;
+    if ((byte >> 3) == 0x1E) return 4;
+    return 1;  // Stray continuation byte: consume it alone
+}
+
+} // namespace
+
+bool Tokenizer::loadVocab(const std::string& vocabPath) {
+    std::ifstream file(vocabPath);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Build with per-node edge lists, then flatten into sorted edge runs
+    std::vector<std::vector<std::pair<uint8_t, uint32_t>>> edges(1);
+    std::vector<int32_t> tokenIds(1, kNoToken);
+
+    std::string piece;
+    int32_t nextId = 0;
+    while (std::getline(file, piece)) {
+        if (!piece.empty() && piece.back() == '\r') {
+            piece.pop_back();
+        }
+        if (piece.empty()) {
+            continue;
+        }
+
+        uint32_t node = kRoot;
+        for (char c : piece) {
+            auto byte = static_cast<uint8_t>(c);
+            auto& out = edges[node];
+            auto it = std::find_if(out.begin(), out.end(),
+                                   [byte](const auto& e) { return e.first == byte; });
+            if (it != out.end()) {
+                node = it->second;
+                continue;
+            }
+            auto created = static_cast<uint32_t>(edges.size());
+            out.emplace_back(byte, created);
+            edges.emplace_back();
+            tokenIds.push_back(kNoToken);
+            node = created;
+        }
+        if (tokenIds[node] == kNoToken) {
+            tokenIds[node] = nextId;
+        }
+        ++nextId;
+    }
+
+    nodes_.assign(edges.size(), Node{});
+    edgeBytes_.clear();
+    edgeTargets_.clear();
+    size_t edgeTotal = edges.size() - 1;
+    edgeBytes_.reserve(edgeTotal);
+    edgeTargets_.reserve(edgeTotal);
+
+    for (size_t n = 0; n < edges.size(); ++n) {
+        auto& out = edges[n];
+        std::sort(out.begin(), out.end());
+        nodes_[n].firstEdge = static_cast<uint32_t>(edgeBytes_.size());
+        nodes_[n].edgeCount = static_cast<uint32_t>(out.size());
+        nodes_[n].tokenId = tokenIds[n];
+        for (const auto& [byte, target] : out) {
+            edgeBytes_.push_back(byte);
+            edgeTargets_.push_back(target);
+        }
+    }
+
+    vocabSize_ = static_cast<size_t>(nextId);
+    wordStartNode_ = walk(kRoot, kWordStart);
+
+    // Match the previous fallback: [UNK] defaults to id 1 if absent
+    int32_t unk = kNoToken;
+    uint32_t unkNode = walk(kRoot, "[UNK]");
+    if (unkNode != kNoNode) {
+        unk = nodes_[unkNode].tokenId;
+    }
+    unkId_ = unk != kNoToken ? unk : 1;
+    clsId_ = tokenId("[CLS]");
+    sepId_ = tokenId("[SEP]");
+    padId_ = tokenId("[PAD]");
+
+    return vocabSize_ > 0;
+}
+
+uint32_t Tokenizer::child(uint32_t node, uint8_t byte) const {
+    const Node& n = nodes_[node];
+    auto first = edgeBytes_.begin() + n.firstEdge;
+    auto last = first + n.edgeCount;
+    auto it = std::lower_bound(first, last, byte);
+    if (it == last || *it != byte) {
+        return kNoNode;
+    }
+    return edgeTargets_[static_cast<size_t>(it - edgeBytes_.begin())];
+}
+
+uint32_t Tokenizer::walk(uint32_t node, std::string_view bytes) const {
+    if (nodes_.empty()) {
+        return kNoNode;
+    }
+    for (char c : bytes) {
+        node = child(node, static_cast<uint8_t>(c));
+        if (node == kNoNode) {
+            break;
+        }
+    }
+    return node;
+}
+
+int64_t Tokenizer::tokenId(std::string_view piece) const {
+    uint32_t node = walk(kRoot, piece);
+    if (node == kNoNode || nodes_[node].tokenId == kNoToken) {
+        return unkId_;
+    }
+    return nodes_[node].tokenId;
+}
+
+size_t Tokenizer::longestMatch(uint32_t start, std::string_view piece, int32_t& tokenId) const {
+    size_t matched = 0;
+    uint32_t node = start;
+    for (size_t i = 0; i < piece.size(); ++i) {
+        node = child(node, static_cast<uint8_t>(piece[i]));
+        if (node == kNoNode) {
+            break;
+        }
+        if (nodes_[node].tokenId != kNoToken) {
+            matched = i + 1;
+            tokenId = nodes_[node].tokenId;
+        }
+    }
+    return matched;
+}
+
+void Tokenizer::encodePiece(std::string_view piece, bool wordStart, size_t limit,
+                            std::vector<int64_t>& ids) const {
+    size_t pos = 0;
+    while (pos < piece.size() && ids.size() < limit) {
+        std::string_view rest = piece.substr(pos);
+        int32_t token = kNoToken;
+        size_t length = 0;
+
+        if (wordStart && wordStartNode_ != kNoNode) {
+            wordStart = false;
+            length = longestMatch(wordStartNode_, rest, token);
+            if (length == 0 && nodes_[wordStartNode_].tokenId != kNoToken) {
+                // No "▁xyz" piece: emit the bare marker, then segment the word
+                ids.push_back(nodes_[wordStartNode_].tokenId);
+                continue;
+            }
+        }
+        if (length == 0) {
+            length = longestMatch(kRoot, rest, token);
+        }
+
+        if (length == 0) {
+            // Nothing in the vocab starts with this character
+            ids.push_back(unkId_);
+            length = std::min(utf8Length(rest.front()), rest.size());
+        } else {
+            ids.push_back(token);
+        }
+        pos += length;
+    }
+}
+
+void Tokenizer::encodeWord(std::string_view word, size_t limit, std::vector<int64_t>& ids) const {
+    // Punctuation characters become their own pieces; only the first piece
+    // of a whitespace-delimited word carries the word-start marker
+    bool wordStart = true;
+    size_t begin = 0;
+    for (size_t i = 0; i <= word.size() && ids.size() < limit; ++i) {
+        bool atEnd = i == word.size();
+        if (!atEnd && !isPunct(word[i])) {
+            continue;
+        }
+        if (i > begin) {
+            encodePiece(word.substr(begin, i - begin), wordStart, limit, ids);
+            wordStart = false;
+        }
+        if (!atEnd && ids.size() < limit) {
+            encodePiece(word.substr(i, 1), wordStart, limit, ids);
+            wordStart = false;
+        }
+        begin = i + 1;
+    }
+}
+
+void Tokenizer::encode(std::string_view text, int maxLength, std::vector<int64_t>& ids) const {
+    ids.clear();
+    if (maxLength < 2) {
+        return;
+    }
+
+    const size_t limit = static_cast<size_t>(maxLength) - 1;  // room for [SEP]
+    ids.push_back(clsId_);
+
+    if (!nodes_.empty()) {
+        size_t pos = 0;
+        while (pos < text.size() && ids.size() < limit) {
+            while (pos < text.size() && isSpace(text[pos])) {
+                ++pos;
+            }
+            size_t end = pos;
+            while (end < text.size() && !isSpace(text[end])) {
+                ++end;
+            }
+            if (end > pos) {
+                encodeWord(text.substr(pos, end - pos), limit, ids);
+            }
+            pos = end;
+        }
+    }
+
+    ids.push_back(sepId_);
+}
+
+std::vector<int64_t> Tokenizer::encode(std::string_view text, int maxLength) const {
+    std::vector<int64_t> ids;
+    encode(text, maxLength, ids);
+    return ids;
+}
+
+} // namespace ModAI
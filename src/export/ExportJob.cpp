@@ -0,0 +1,92 @@
+#include "export/ExportJob.h"
+#include "utils/Logger.h"
+#include <filesystem>
+
+namespace ModAI {
+
+ExportJob::ExportJob(std::unique_ptr<ContentCursor> cursor, ExportFormat format, std::string filepath,
+                     ExportJobOptions options)
+    : cursor_(std::move(cursor))
+    , format_(format)
+    , filepath_(std::move(filepath))
+    , options_(options) {
+}
+
+ExportJob::~ExportJob() {
+    cancel();
+    wait();
+}
+
+void ExportJob::setOnProgress(ProgressCallback callback) {
+    onProgress_ = std::move(callback);
+}
+
+void ExportJob::setOnFinished(FinishedCallback callback) {
+    onFinished_ = std::move(callback);
+}
+
+void ExportJob::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ExportJob::cancel() {
+    cancelled_ = true;
+}
+
+void ExportJob::wait() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ExportJob::run() {
+    const std::string partPath = filepath_ + ".part";
+    size_t written = 0;
+    std::error_code ec;
+
+    try {
+        auto writer = ExportWriter::create(format_, partPath);
+        while (!cancelled_ && cursor_) {
+            std::vector<ContentItem> page = cursor_->next(options_.pageSize);
+            if (page.empty()) {
+                break;
+            }
+            writer->write(page);
+            written += page.size();
+            if (onProgress_) {
+                onProgress_(written);
+            }
+        }
+
+        if (cancelled_) {
+            writer.reset();
+            std::filesystem::remove(partPath, ec);
+            Logger::info("Export to " + filepath_ + " cancelled after " + std::to_string(written) + " items");
+            if (onFinished_) {
+                onFinished_(written, true, "");
+            }
+            return;
+        }
+
+        writer->finish();
+        writer.reset();
+        std::filesystem::rename(partPath, filepath_);
+    } catch (const std::exception& e) {
+        std::filesystem::remove(partPath, ec);
+        Logger::error("Export to " + filepath_ + " failed: " + std::string(e.what()));
+        if (onFinished_) {
+            onFinished_(written, false, e.what());
+        }
+        return;
+    }
+
+    Logger::info("Exported " + std::to_string(written) + " items to " + filepath_);
+    if (onFinished_) {
+        onFinished_(written, false, "");
+    }
+}
+
+} // namespace ModAI
@@ -1,11 +1,12 @@
 #include "export/Exporter.h"
 #include "core/ContentItem.h"
-#include <fstream>
-#include <sstream>
-#include <iomanip>
-#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <cstdio>
 #include <ctime>
+#include <fstream>
+#include <QAbstractTextDocumentLayout>
 #include <QPdfWriter>
 #include <QPainter>
 #include <QPageSize>
@@ -16,161 +17,370 @@
 #include <QTextCharFormat>
 #include <QTextBlockFormat>
 #include <QImage>
+#include <QImageReader>
 #include <QFile>
+#include <QtConcurrent>
 
 namespace ModAI {
 
-void Exporter::exportToPDF(const std::vector<ContentItem>& items, const std::string& filepath) {
-    QPdfWriter writer(QString::fromStdString(filepath));
-    writer.setPageSize(QPageSize(QPageSize::A4));
-    writer.setResolution(300); // 300 DPI
-    
-    QPainter painter(&writer);
-    
-    // Use QTextDocument for rich text layout
-    QTextDocument doc;
-    QTextCursor cursor(&doc);
-    
-    // Title
-    QTextCharFormat titleFormat;
-    titleFormat.setFontPointSize(24);
-    titleFormat.setFontWeight(QFont::Bold);
-    cursor.insertText("Trust & Safety Report\n", titleFormat);
-    
-    // Date
-    QTextCharFormat normalFormat;
-    normalFormat.setFontPointSize(12);
+namespace {
+
+std::string lowercaseExtension(const std::string& filepath) {
+    size_t dot = filepath.find_last_of('.');
+    size_t slash = filepath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "";
+    }
+    std::string ext = filepath.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+std::string generatedAt() {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
-    cursor.insertText("Generated: " + QString::fromStdString(std::ctime(&time_t)), normalFormat);
-    cursor.insertBlock();
-    
-    // Summary
-    int blockedCount = 0;
-    int reviewedCount = 0;
-    for (const auto& item : items) {
-        if (item.decision.auto_action == "block") blockedCount++;
-        if (item.decision.auto_action == "review") reviewedCount++;
-    }
-    
-    cursor.insertText(QString("Total Items: %1\n").arg(items.size()), normalFormat);
-    cursor.insertText(QString("Blocked: %1\n").arg(blockedCount), normalFormat);
-    cursor.insertText(QString("Reviewed: %1\n\n").arg(reviewedCount), normalFormat);
-    
-    // Table
-    QTextTableFormat tableFormat;
-    tableFormat.setHeaderRowCount(1);
-    tableFormat.setBorder(1);
-    tableFormat.setCellPadding(5);
-    tableFormat.setCellSpacing(0);
-    tableFormat.setWidth(QTextLength(QTextLength::PercentageLength, 100));
-    
-    QTextTable* table = cursor.insertTable(items.size() + 1, 5, tableFormat);
-    
-    // Headers
-    QTextCharFormat headerFormat = normalFormat;
-    headerFormat.setFontWeight(QFont::Bold);
-    
-    table->cellAt(0, 0).firstCursorPosition().insertText("ID", headerFormat);
-    table->cellAt(0, 1).firstCursorPosition().insertText("Subreddit", headerFormat);
-    table->cellAt(0, 2).firstCursorPosition().insertText("Type", headerFormat);
-    table->cellAt(0, 3).firstCursorPosition().insertText("AI Score", headerFormat);
-    table->cellAt(0, 4).firstCursorPosition().insertText("Status", headerFormat);
-    
-    // Rows
-    for (size_t i = 0; i < items.size(); ++i) {
-        const auto& item = items[i];
-        int row = i + 1;
-        
-        table->cellAt(row, 0).firstCursorPosition().insertText(QString::fromStdString(item.id).left(8), normalFormat);
-        table->cellAt(row, 1).firstCursorPosition().insertText(QString::fromStdString(item.subreddit), normalFormat);
-        table->cellAt(row, 2).firstCursorPosition().insertText(QString::fromStdString(item.content_type), normalFormat);
-        table->cellAt(row, 3).firstCursorPosition().insertText(QString::number(item.ai_detection.ai_score, 'f', 2), normalFormat);
-        table->cellAt(row, 4).firstCursorPosition().insertText(QString::fromStdString(item.decision.auto_action), normalFormat);
-    }
-    
-    cursor.movePosition(QTextCursor::End);
-    cursor.insertBlock();
-    cursor.insertText("\nDetailed Items:\n", titleFormat);
-    
-    // Details
-    for (const auto& item : items) {
-        cursor.insertText("ID: " + QString::fromStdString(item.id), normalFormat);
+    return std::ctime(&time_t);
+}
+
+void openOrThrow(std::ofstream& file, const std::string& filepath, const char* what) {
+    file.open(filepath, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error(std::string("Failed to open file for ") + what + " export");
+    }
+}
+
+void checkStream(const std::ofstream& file) {
+    if (!file) {
+        throw std::runtime_error("Write to export file failed");
+    }
+}
+
+class CsvExportWriter : public ExportWriter {
+public:
+    explicit CsvExportWriter(const std::string& filepath) {
+        openOrThrow(file_, filepath, "CSV");
+        file_ << "ID,Timestamp,Author,Subreddit,Content Type,Text,Image Path,"
+              << "AI Score,AI Label,Moderation Sexual,Moderation Violence,Moderation Hate,Moderation Drugs,"
+              << "Additional Labels,Status,Rule ID\n";
+    }
+
+    void write(const std::vector<ContentItem>& items) override {
+        std::string line;
+        for (const auto& item : items) {
+            line.clear();
+            appendField(line, item.id);
+            appendField(line, item.timestamp);
+            appendField(line, item.author.value_or("N/A"));
+            appendField(line, item.subreddit);
+            appendField(line, item.content_type);
+            appendField(line, item.text.value_or(""));
+            appendField(line, item.image_path.value_or(""));
+            appendNumber(line, item.ai_detection.ai_score);
+            appendField(line, item.ai_detection.label);
+            appendNumber(line, item.moderation.labels.sexual);
+            appendNumber(line, item.moderation.labels.violence);
+            appendNumber(line, item.moderation.labels.hate);
+            appendNumber(line, item.moderation.labels.drugs);
+
+            // Additional labels as JSON-like string
+            std::string additional = "{";
+            bool first = true;
+            for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
+                if (!first) additional += ", ";
+                additional += label.str();
+                additional += ": ";
+                additional += formatNumber(conf);
+                first = false;
+            }
+            additional += "}";
+            appendField(line, additional);
+
+            appendField(line, item.decision.auto_action);
+            appendField(line, item.decision.rule_id);
+            line.back() = '\n';
+            file_ << line;
+        }
+        checkStream(file_);
+    }
+
+    void finish() override {
+        file_.close();
+        checkStream(file_);
+    }
+
+private:
+    std::ofstream file_;
+
+    static std::string formatNumber(double value) {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%.4f", value);
+        return std::string(buffer, static_cast<size_t>(std::max(length, 0)));
+    }
+
+    // Quoted only when it contains a separator, quote or line break
+    static void appendField(std::string& line, const std::string& field) {
+        if (field.find_first_of(",\"\n\r") == std::string::npos) {
+            line += field;
+        } else {
+            line += '"';
+            for (char c : field) {
+                if (c == '"') line += '"';
+                line += c;
+            }
+            line += '"';
+        }
+        line += ',';
+    }
+
+    static void appendNumber(std::string& line, double value) {
+        line += formatNumber(value);
+        line += ',';
+    }
+};
+
+class JsonExportWriter : public ExportWriter {
+public:
+    JsonExportWriter(const std::string& filepath, bool lines)
+        : lines_(lines) {
+        openOrThrow(file_, filepath, "JSON");
+        if (!lines_) {
+            file_ << "[\n";
+        }
+    }
+
+    void write(const std::vector<ContentItem>& items) override {
+        for (const auto& item : items) {
+            if (lines_) {
+                file_ << item.toJson() << '\n';
+            } else {
+                if (count_ > 0) {
+                    file_ << ",\n";
+                }
+                file_ << item.toJson();
+            }
+            ++count_;
+        }
+        checkStream(file_);
+    }
+
+    void finish() override {
+        if (!lines_) {
+            file_ << (count_ > 0 ? "\n]\n" : "]\n");
+        }
+        file_.close();
+        checkStream(file_);
+    }
+
+private:
+    std::ofstream file_;
+    bool lines_;
+    size_t count_ = 0;
+};
+
+/**
+ * Renders each page of items as its own QTextDocument and paginates it
+ * onto the PDF, so the layout never holds more than one page of items.
+ * Thumbnails for a page are decoded on the global thread pool while the
+ * summary table is laid out.
+ */
+class PdfExportWriter : public ExportWriter {
+public:
+    explicit PdfExportWriter(const std::string& filepath)
+        : writer_(QString::fromStdString(filepath)) {
+        writer_.setPageSize(QPageSize(QPageSize::A4));
+        writer_.setResolution(300); // 300 DPI
+        if (!painter_.begin(&writer_)) {
+            throw std::runtime_error("Failed to open file for PDF export");
+        }
+        normalFormat_.setFontPointSize(12);
+        titleFormat_.setFontPointSize(24);
+        titleFormat_.setFontWeight(QFont::Bold);
+        headerFormat_ = normalFormat_;
+        headerFormat_.setFontWeight(QFont::Bold);
+    }
+
+    void write(const std::vector<ContentItem>& items) override {
+        if (items.empty()) {
+            return;
+        }
+
+        QList<QString> imagePaths;
+        imagePaths.reserve(static_cast<int>(items.size()));
+        for (const auto& item : items) {
+            imagePaths.append(item.image_path.has_value() ? QString::fromStdString(*item.image_path) : QString());
+        }
+        QFuture<QImage> thumbnails = QtConcurrent::mapped(imagePaths, &PdfExportWriter::decodeThumbnail);
+
+        QTextDocument doc;
+        QTextCursor cursor(&doc);
+
+        if (total_ == 0) {
+            cursor.insertText("Trust & Safety Report\n", titleFormat_);
+            cursor.insertText("Generated: " + QString::fromStdString(generatedAt()), normalFormat_);
+            cursor.insertBlock();
+        }
+
+        QTextTableFormat tableFormat;
+        tableFormat.setHeaderRowCount(1);
+        tableFormat.setBorder(1);
+        tableFormat.setCellPadding(5);
+        tableFormat.setCellSpacing(0);
+        tableFormat.setWidth(QTextLength(QTextLength::PercentageLength, 100));
+
+        QTextTable* table = cursor.insertTable(static_cast<int>(items.size()) + 1, 5, tableFormat);
+        table->cellAt(0, 0).firstCursorPosition().insertText("ID", headerFormat_);
+        table->cellAt(0, 1).firstCursorPosition().insertText("Subreddit", headerFormat_);
+        table->cellAt(0, 2).firstCursorPosition().insertText("Type", headerFormat_);
+        table->cellAt(0, 3).firstCursorPosition().insertText("AI Score", headerFormat_);
+        table->cellAt(0, 4).firstCursorPosition().insertText("Status", headerFormat_);
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            const auto& item = items[i];
+            int row = static_cast<int>(i) + 1;
+
+            table->cellAt(row, 0).firstCursorPosition().insertText(QString::fromStdString(item.id).left(8), normalFormat_);
+            table->cellAt(row, 1).firstCursorPosition().insertText(QString::fromStdString(item.subreddit), normalFormat_);
+            table->cellAt(row, 2).firstCursorPosition().insertText(QString::fromStdString(item.content_type), normalFormat_);
+            table->cellAt(row, 3).firstCursorPosition().insertText(QString::number(item.ai_detection.ai_score, 'f', 2), normalFormat_);
+            table->cellAt(row, 4).firstCursorPosition().insertText(QString::fromStdString(item.decision.auto_action), normalFormat_);
+
+            if (item.decision.auto_action == "block") blockedCount_++;
+            if (item.decision.auto_action == "review") reviewedCount_++;
+        }
+
+        cursor.movePosition(QTextCursor::End);
         cursor.insertBlock();
-        
-        if (item.text.has_value()) {
-            cursor.insertText("Text: " + QString::fromStdString(item.text.value()).left(500), normalFormat);
+        cursor.insertText("\nDetailed Items:\n", titleFormat_);
+
+        QList<QImage> images = thumbnails.results();
+        for (size_t i = 0; i < items.size(); ++i) {
+            const auto& item = items[i];
+            cursor.insertText("ID: " + QString::fromStdString(item.id), normalFormat_);
             cursor.insertBlock();
+
+            if (item.text.has_value()) {
+                cursor.insertText("Text: " + QString::fromStdString(item.text.value()).left(500), normalFormat_);
+                cursor.insertBlock();
+            }
+
+            const QImage& image = images[static_cast<int>(i)];
+            if (!image.isNull()) {
+                cursor.insertImage(image);
+                cursor.insertBlock();
+            }
+
+            cursor.insertText("----------------------------------------\n", normalFormat_);
         }
-        
-        if (item.image_path.has_value()) {
-            QString imgPath = QString::fromStdString(item.image_path.value());
-            if (QFile::exists(imgPath)) {
-                QImage img(imgPath);
-                if (!img.isNull()) {
-                    // Scale image to fit
-                    img = img.scaled(400, 300, Qt::KeepAspectRatio);
-                    cursor.insertImage(img);
-                    cursor.insertBlock();
-                }
+
+        total_ += items.size();
+        paint(doc);
+    }
+
+    void finish() override {
+        // Counts are only known once every page has been written
+        QTextDocument doc;
+        QTextCursor cursor(&doc);
+        if (total_ == 0) {
+            cursor.insertText("Trust & Safety Report\n", titleFormat_);
+            cursor.insertText("Generated: " + QString::fromStdString(generatedAt()), normalFormat_);
+            cursor.insertBlock();
+        }
+        cursor.insertText("Summary\n", titleFormat_);
+        cursor.insertText(QString("Total Items: %1\n").arg(total_), normalFormat_);
+        cursor.insertText(QString("Blocked: %1\n").arg(blockedCount_), normalFormat_);
+        cursor.insertText(QString("Reviewed: %1\n").arg(reviewedCount_), normalFormat_);
+        paint(doc);
+
+        if (!painter_.end()) {
+            throw std::runtime_error("Failed to write PDF export");
+        }
+    }
+
+private:
+    QPdfWriter writer_;
+    QPainter painter_;
+    QTextCharFormat normalFormat_;
+    QTextCharFormat titleFormat_;
+    QTextCharFormat headerFormat_;
+    bool firstPage_ = true;
+    size_t total_ = 0;
+    size_t blockedCount_ = 0;
+    size_t reviewedCount_ = 0;
+
+    static QImage decodeThumbnail(const QString& path) {
+        if (path.isEmpty() || !QFile::exists(path)) {
+            return QImage();
+        }
+        // Let the decoder scale (JPEG decodes at reduced size directly)
+        QImageReader reader(path);
+        QSize size = reader.size();
+        if (size.isValid()) {
+            reader.setScaledSize(size.scaled(400, 300, Qt::KeepAspectRatio));
+        }
+        QImage image = reader.read();
+        if (!image.isNull() && !size.isValid()) {
+            image = image.scaled(400, 300, Qt::KeepAspectRatio);
+        }
+        return image;
+    }
+
+    void paint(QTextDocument& doc) {
+        QRectF pageRect = writer_.pageLayout().paintRectPixels(writer_.resolution());
+        doc.documentLayout()->setPaintDevice(&writer_);
+        doc.setPageSize(pageRect.size());
+
+        for (int page = 0; page < doc.pageCount(); ++page) {
+            if (!firstPage_) {
+                writer_.newPage();
             }
+            firstPage_ = false;
+
+            QRectF clip(0, page * pageRect.height(), pageRect.width(), pageRect.height());
+            painter_.save();
+            painter_.translate(0, -clip.top());
+            doc.drawContents(&painter_, clip);
+            painter_.restore();
         }
-        
-        cursor.insertText("----------------------------------------\n", normalFormat);
     }
-    
-    doc.drawContents(&painter);
+};
+
+} // namespace
+
+ExportFormat exportFormatForPath(const std::string& filepath) {
+    std::string ext = lowercaseExtension(filepath);
+    if (ext == "csv") return ExportFormat::Csv;
+    if (ext == "jsonl" || ext == "ndjson") return ExportFormat::Jsonl;
+    if (ext == "pdf") return ExportFormat::Pdf;
+    return ExportFormat::Json;
+}
+
+std::unique_ptr<ExportWriter> ExportWriter::create(ExportFormat format, const std::string& filepath) {
+    switch (format) {
+        case ExportFormat::Csv: return std::make_unique<CsvExportWriter>(filepath);
+        case ExportFormat::Json: return std::make_unique<JsonExportWriter>(filepath, false);
+        case ExportFormat::Jsonl: return std::make_unique<JsonExportWriter>(filepath, true);
+        case ExportFormat::Pdf: return std::make_unique<PdfExportWriter>(filepath);
+    }
+    throw std::invalid_argument("Unknown export format");
+}
+
+void Exporter::exportToPDF(const std::vector<ContentItem>& items, const std::string& filepath) {
+    auto writer = ExportWriter::create(ExportFormat::Pdf, filepath);
+    writer->write(items);
+    writer->finish();
 }
 
 void Exporter::exportToCSV(const std::vector<ContentItem>& items, const std::string& filepath) {
-    std::ofstream file(filepath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for CSV export");
-    }
-    
-    // Header
-    file << "id,timestamp,subreddit,author,content_type,ai_score,sexual,violence,hate,drugs,decision,rule_id\n";
-    
-    // Data rows
-    for (const auto& item : items) {
-        file << item.id << ","
-             << item.timestamp << ","
-             << item.subreddit << ","
-             << (item.author.has_value() ? item.author.value() : "") << ","
-             << item.content_type << ","
-             << item.ai_detection.ai_score << ","
-             << item.moderation.labels.sexual << ","
-             << item.moderation.labels.violence << ","
-             << item.moderation.labels.hate << ","
-             << item.moderation.labels.drugs << ","
-             << item.decision.auto_action << ","
-             << item.decision.rule_id << "\n";
-    }
-    
-    file.close();
+    auto writer = ExportWriter::create(ExportFormat::Csv, filepath);
+    writer->write(items);
+    writer->finish();
 }
 
 void Exporter::exportToJSON(const std::vector<ContentItem>& items, const std::string& filepath) {
-    nlohmann::json j;
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    j["export_timestamp"] = std::ctime(&time_t);
-    j["total_items"] = items.size();
-    
-    nlohmann::json itemsArray = nlohmann::json::array();
-    for (const auto& item : items) {
-        itemsArray.push_back(nlohmann::json::parse(item.toJson()));
-    }
-    j["items"] = itemsArray;
-    
-    std::ofstream file(filepath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for JSON export");
-    }
-    
-    file << j.dump(2);
-    file.close();
+    auto writer = ExportWriter::create(ExportFormat::Json, filepath);
+    writer->write(items);
+    writer->finish();
 }
 
 } // namespace ModAI
-
@@ -0,0 +1,199 @@
+#include "network/CachingHttpClient.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <sstream>
+
+namespace ModAI {
+
+namespace {
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\"");
+    size_t end = text.find_last_not_of(" \t\"");
+    return begin == std::string::npos ? "" : text.substr(begin, end - begin + 1);
+}
+
+// Header names are case-insensitive, and transports differ in how they spell them
+const std::string* findHeader(const std::map<std::string, std::string>& headers, const std::string& name) {
+    for (const auto& [key, value] : headers) {
+        if (lowercase(key) == name) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+struct CachePolicy {
+    bool store = true;
+    int64_t freshUntil = 0;
+};
+
+CachePolicy policyFor(const std::map<std::string, std::string>& headers) {
+    CachePolicy policy;
+    int64_t maxAge = 0;
+    bool noCache = false;
+    if (const std::string* cacheControl = findHeader(headers, "cache-control")) {
+        std::stringstream directives(*cacheControl);
+        std::string directive;
+        while (std::getline(directives, directive, ',')) {
+            directive = lowercase(trim(directive));
+            if (directive == "no-store") {
+                policy.store = false;
+            } else if (directive == "no-cache") {
+                noCache = true;
+            } else if (directive.rfind("max-age=", 0) == 0) {
+                maxAge = std::max<int64_t>(0, std::atoll(trim(directive.substr(8)).c_str()));
+            }
+        }
+    }
+    if (const std::string* vary = findHeader(headers, "vary"); vary && trim(*vary) == "*") {
+        policy.store = false;
+    }
+    if (const std::string* age = findHeader(headers, "age")) {
+        maxAge -= std::max<int64_t>(0, std::atoll(age->c_str()));
+    }
+    // Without max-age the response is only reused after revalidation
+    policy.freshUntil = noCache || maxAge <= 0 ? 0 : unixNow() + maxAge;
+    return policy;
+}
+
+HttpResponse cachedResponse(const HttpCacheEntry& entry, std::map<std::string, std::string> headers) {
+    HttpResponse response;
+    response.statusCode = 200;
+    response.body = entry.body;
+    response.headers = std::move(headers);
+    response.success = true;
+    response.notModified = true;
+    return response;
+}
+
+} // namespace
+
+CachingHttpClient::CachingHttpClient(std::unique_ptr<HttpClient> inner, std::shared_ptr<HttpCache> cache)
+    : inner_(std::move(inner))
+    , cache_(std::move(cache)) {
+}
+
+HttpResponse CachingHttpClient::post(const HttpRequest& req) {
+    return inner_->post(req);
+}
+
+HttpRequestHandle CachingHttpClient::postAsync(const HttpRequest& req, HttpCallback callback) {
+    return inner_->postAsync(req, std::move(callback));
+}
+
+HttpRequestHandle CachingHttpClient::downloadAsync(const std::string& url,
+                                                   const std::map<std::string, std::string>& headers,
+                                                   const std::string& filePath,
+                                                   uint64_t maxBytes,
+                                                   HttpCallback callback) {
+    return inner_->downloadAsync(url, headers, filePath, maxBytes, std::move(callback));
+}
+
+HttpRequestHandle CachingHttpClient::streamAsync(const HttpRequest& req,
+                                                 HttpChunkCallback onChunk,
+                                                 HttpCallback callback) {
+    return inner_->streamAsync(req, std::move(onChunk), std::move(callback));
+}
+
+HttpResponse CachingHttpClient::get(const std::string& url, const std::map<std::string, std::string>& headers) {
+    std::map<std::string, std::string> requestHeaders = headers;
+    std::optional<HttpCacheEntry> cached;
+    if (auto fresh = prepare(url, requestHeaders, cached)) {
+        return std::move(*fresh);
+    }
+    return complete(url, cached, inner_->get(url, requestHeaders));
+}
+
+HttpRequestHandle CachingHttpClient::getAsync(const std::string& url,
+                                              const std::map<std::string, std::string>& headers,
+                                              HttpCallback callback) {
+    std::map<std::string, std::string> requestHeaders = headers;
+    std::optional<HttpCacheEntry> cached;
+    if (auto fresh = prepare(url, requestHeaders, cached)) {
+        callback(std::move(*fresh));
+        return HttpRequestHandle();
+    }
+    return inner_->getAsync(url, requestHeaders,
+        [this, url, cached = std::move(cached), callback = std::move(callback)](HttpResponse response) {
+            callback(complete(url, cached, std::move(response)));
+        });
+}
+
+std::optional<HttpResponse> CachingHttpClient::prepare(const std::string& url,
+                                                       std::map<std::string, std::string>& headers,
+                                                       std::optional<HttpCacheEntry>& cached) {
+    // A caller revalidating on its own gets the server's answer untouched
+    if (findHeader(headers, "if-none-match") || findHeader(headers, "if-modified-since")) {
+        return std::nullopt;
+    }
+    cached = cache_->find(url);
+    if (!cached) {
+        return std::nullopt;
+    }
+    if (cached->freshUntil > unixNow()) {
+        Metrics::counter("modai_http_cache_total", "result=\"hit\"").inc();
+        return cachedResponse(*cached, {});
+    }
+    if (!cached->etag.empty()) {
+        headers["If-None-Match"] = cached->etag;
+    }
+    if (!cached->lastModified.empty()) {
+        headers["If-Modified-Since"] = cached->lastModified;
+    }
+    return std::nullopt;
+}
+
+HttpResponse CachingHttpClient::complete(const std::string& url, const std::optional<HttpCacheEntry>& cached,
+                                         HttpResponse response) {
+    if (response.cancelled || response.deadlineExceeded) {
+        return response;
+    }
+    if (response.statusCode == 304 && cached) {
+        CachePolicy policy = policyFor(response.headers);
+        if (policy.store) {
+            cache_->refresh(url, policy.freshUntil);
+        } else {
+            cache_->remove(url);
+        }
+        Metrics::counter("modai_http_cache_total", "result=\"revalidated\"").inc();
+        MODAI_LOG_DEBUG("Not modified: " + url);
+        return cachedResponse(*cached, std::move(response.headers));
+    }
+    if (response.success && response.statusCode == 200) {
+        Metrics::counter("modai_http_cache_total", "result=\"miss\"").inc();
+        CachePolicy policy = policyFor(response.headers);
+        HttpCacheEntry entry;
+        if (const std::string* etag = findHeader(response.headers, "etag")) {
+            entry.etag = *etag;
+        }
+        if (const std::string* lastModified = findHeader(response.headers, "last-modified")) {
+            entry.lastModified = *lastModified;
+        }
+        entry.freshUntil = policy.freshUntil;
+        // Nothing to revalidate with and no freshness: keeping it can't save a request
+        if (policy.store && (!entry.etag.empty() || !entry.lastModified.empty() || entry.freshUntil > 0)) {
+            entry.body = response.body;
+            cache_->store(url, entry);
+        } else if (cached) {
+            cache_->remove(url);
+        }
+    }
+    return response;
+}
+
+} // namespace ModAI
@@ -0,0 +1,222 @@
+#include "network/HttpCache.h"
+#include "utils/Logger.h"
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace ModAI {
+
+namespace {
+
+constexpr const char* kFileMagic = "MODAI-HTTP-CACHE 1";
+
+} // namespace
+
+HttpCache::HttpCache(const std::string& directory, size_t memoryBytes, size_t diskBytes)
+    : directory_(directory)
+    , memoryBytes_(memoryBytes)
+    , diskBytes_(diskBytes) {
+    if (directory_.empty()) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        Logger::error("Failed to create HTTP cache at " + directory_ + ": " + ec.message());
+        directory_.clear();
+        return;
+    }
+    loadIndex();
+}
+
+size_t HttpCache::sizeOf(const std::string& key, const HttpCacheEntry& entry) {
+    return key.size() + entry.body.size() + entry.etag.size() + entry.lastModified.size() + sizeof(HttpCacheEntry);
+}
+
+std::string HttpCache::fileNameFor(const std::string& key) {
+    QByteArray hash = QCryptographicHash::hash(QByteArray::fromStdString(key), QCryptographicHash::Sha256);
+    return hash.toHex().toStdString();
+}
+
+void HttpCache::loadIndex() {
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    for (const auto& file : std::filesystem::directory_iterator(directory_, ec)) {
+        if (!file.is_regular_file(ec)) {
+            continue;
+        }
+        if (file.path().extension() == ".tmp") {
+            std::filesystem::remove(file.path(), ec);  // interrupted write
+            continue;
+        }
+        files.emplace_back(file.last_write_time(ec), file.path());
+    }
+    // Newest first, so the oldest files are evicted first
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& [time, path] : files) {
+        std::string name = path.filename().string();
+        uint64_t size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            continue;
+        }
+        diskOrder_.push_back(name);
+        disk_[name] = DiskEntry{size, std::prev(diskOrder_.end())};
+        diskUsed_ += size;
+    }
+    while (diskUsed_ > diskBytes_ && !diskOrder_.empty()) {
+        removeFileLocked(diskOrder_.back());
+    }
+}
+
+std::optional<HttpCacheEntry> HttpCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = memory_.find(key);
+    if (it != memory_.end()) {
+        memoryOrder_.splice(memoryOrder_.begin(), memoryOrder_, it->second.position);
+        return it->second.entry;
+    }
+    auto entry = readFileLocked(key);
+    if (entry) {
+        putMemoryLocked(key, *entry);
+    }
+    return entry;
+}
+
+void HttpCache::store(const std::string& key, const HttpCacheEntry& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    putMemoryLocked(key, entry);
+    writeFileLocked(key, entry);
+}
+
+void HttpCache::refresh(const std::string& key, int64_t freshUntil) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = memory_.find(key);
+    if (it != memory_.end()) {
+        it->second.entry.freshUntil = freshUntil;
+    }
+}
+
+void HttpCache::remove(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    removeMemoryLocked(key);
+    if (!directory_.empty()) {
+        removeFileLocked(fileNameFor(key));
+    }
+}
+
+void HttpCache::putMemoryLocked(const std::string& key, const HttpCacheEntry& entry) {
+    removeMemoryLocked(key);
+    size_t size = sizeOf(key, entry);
+    if (size > memoryBytes_) {
+        return;
+    }
+    memoryOrder_.push_front(key);
+    memory_[key] = MemoryEntry{entry, memoryOrder_.begin()};
+    memoryUsed_ += size;
+    while (memoryUsed_ > memoryBytes_) {
+        removeMemoryLocked(memoryOrder_.back());
+    }
+}
+
+void HttpCache::removeMemoryLocked(const std::string& key) {
+    auto it = memory_.find(key);
+    if (it == memory_.end()) {
+        return;
+    }
+    memoryUsed_ -= sizeOf(key, it->second.entry);
+    memoryOrder_.erase(it->second.position);
+    memory_.erase(it);
+}
+
+std::optional<HttpCacheEntry> HttpCache::readFileLocked(const std::string& key) {
+    if (directory_.empty()) {
+        return std::nullopt;
+    }
+    std::string name = fileNameFor(key);
+    auto indexed = disk_.find(name);
+    if (indexed == disk_.end()) {
+        return std::nullopt;
+    }
+
+    std::ifstream in(directory_ + "/" + name, std::ios::binary);
+    std::string magic, storedKey, freshUntil;
+    HttpCacheEntry entry;
+    if (!std::getline(in, magic) || magic != kFileMagic ||
+        !std::getline(in, storedKey) || !std::getline(in, entry.etag) ||
+        !std::getline(in, entry.lastModified) || !std::getline(in, freshUntil)) {
+        removeFileLocked(name);
+        return std::nullopt;
+    }
+    if (storedKey != key) {
+        return std::nullopt;  // hash collision; the other key keeps the file
+    }
+    entry.body.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    try {
+        entry.freshUntil = std::stoll(freshUntil);
+    } catch (const std::exception&) {
+        entry.freshUntil = 0;
+    }
+    diskOrder_.splice(diskOrder_.begin(), diskOrder_, indexed->second.position);
+    return entry;
+}
+
+void HttpCache::writeFileLocked(const std::string& key, const HttpCacheEntry& entry) {
+    if (directory_.empty()) {
+        return;
+    }
+    std::string name = fileNameFor(key);
+    removeFileLocked(name);
+    if (sizeOf(key, entry) > diskBytes_) {
+        return;
+    }
+
+    // Written aside and renamed, so a crash never leaves a torn entry
+    std::string path = directory_ + "/" + name;
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out << kFileMagic << '\n' << key << '\n' << entry.etag << '\n'
+            << entry.lastModified << '\n' << entry.freshUntil << '\n';
+        out.write(entry.body.data(), static_cast<std::streamsize>(entry.body.size()));
+        if (!out) {
+            Logger::warn("Failed to write HTTP cache entry " + path);
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    uint64_t size = ec ? 0 : std::filesystem::file_size(path, ec);
+    if (ec) {
+        Logger::warn("Failed to store HTTP cache entry " + path + ": " + ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    diskOrder_.push_front(name);
+    disk_[name] = DiskEntry{size, diskOrder_.begin()};
+    diskUsed_ += size;
+    while (diskUsed_ > diskBytes_ && !diskOrder_.empty()) {
+        removeFileLocked(diskOrder_.back());
+    }
+}
+
+void HttpCache::removeFileLocked(const std::string& name) {
+    auto it = disk_.find(name);
+    if (it == disk_.end()) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::remove(directory_ + "/" + name, ec);
+    diskUsed_ -= it->second.size;
+    diskOrder_.erase(it->second.position);
+    disk_.erase(it);
+}
+
+} // namespace ModAI
@@ -0,0 +1,128 @@
+#include "network/HttpRecording.h"
+#include "utils/Logger.h"
+#include <QByteArray>
+#include <nlohmann/json.hpp>
+
+namespace ModAI {
+
+std::string HttpRecording::withoutQuery(const std::string& url) {
+    return url.substr(0, url.find_first_of("?#"));
+}
+
+std::string HttpRecording::toJsonLine(const HttpExchange& exchange) {
+    nlohmann::json line;
+    line["method"] = exchange.method;
+    line["url"] = exchange.url;
+    line["request_bytes"] = exchange.requestBytes;
+    line["status"] = exchange.statusCode;
+    line["success"] = exchange.success;
+    if (!exchange.errorMessage.empty()) {
+        line["error"] = exchange.errorMessage;
+    }
+    if (exchange.cancelled) {
+        line["cancelled"] = true;
+    }
+    line["latency_ms"] = exchange.latency.count();
+    line["headers"] = exchange.headers;
+    line["body"] = exchange.body;
+    try {
+        return line.dump();
+    } catch (const nlohmann::json::type_error&) {
+        // Not UTF-8, e.g. an image
+        line.erase("body");
+        line["body_base64"] = QByteArray::fromStdString(exchange.body).toBase64().toStdString();
+        return line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    }
+}
+
+bool HttpRecording::fromJsonLine(const std::string& text, HttpExchange& exchange) {
+    try {
+        auto line = nlohmann::json::parse(text);
+        exchange.method = line.value("method", "GET");
+        exchange.url = line.value("url", "");
+        exchange.requestBytes = line.value("request_bytes", size_t(0));
+        exchange.statusCode = line.value("status", 0);
+        exchange.success = line.value("success", false);
+        exchange.errorMessage = line.value("error", "");
+        exchange.cancelled = line.value("cancelled", false);
+        exchange.latency = std::chrono::milliseconds(line.value("latency_ms", int64_t(0)));
+        exchange.headers = line.value("headers", std::map<std::string, std::string>());
+        if (line.contains("body_base64")) {
+            exchange.body = QByteArray::fromBase64(
+                QByteArray::fromStdString(line["body_base64"].get<std::string>())).toStdString();
+        } else {
+            exchange.body = line.value("body", "");
+        }
+        return !exchange.url.empty();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool HttpRecording::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        Logger::error("Cannot read HTTP recording " + path);
+        return false;
+    }
+    std::string text;
+    size_t skipped = 0;
+    while (std::getline(in, text)) {
+        if (text.empty()) {
+            continue;
+        }
+        HttpExchange exchange;
+        if (fromJsonLine(text, exchange)) {
+            add(std::move(exchange));
+        } else {
+            ++skipped;
+        }
+    }
+    Logger::info("Loaded " + std::to_string(exchanges_.size()) + " HTTP exchanges from " + path +
+                 (skipped > 0 ? " (" + std::to_string(skipped) + " unreadable lines skipped)" : ""));
+    return true;
+}
+
+void HttpRecording::add(HttpExchange exchange) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = exchanges_.size();
+    byUrl_[exchange.method + " " + exchange.url].indices.push_back(index);
+    byPath_[exchange.method + " " + withoutQuery(exchange.url)].indices.push_back(index);
+    exchanges_.push_back(std::move(exchange));
+}
+
+const HttpExchange* HttpRecording::next(const std::string& method, const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byUrl_.find(method + " " + url);
+    if (it == byUrl_.end()) {
+        it = byPath_.find(method + " " + withoutQuery(url));
+        if (it == byPath_.end()) {
+            return nullptr;
+        }
+    }
+    Cursor& cursor = it->second;
+    const HttpExchange& exchange = exchanges_[cursor.indices[cursor.next]];
+    cursor.next = (cursor.next + 1) % cursor.indices.size();
+    return &exchange;
+}
+
+bool HttpRecording::contains(const std::string& method, const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byUrl_.count(method + " " + url) > 0 || byPath_.count(method + " " + withoutQuery(url)) > 0;
+}
+
+HttpRecordingWriter::HttpRecordingWriter(const std::string& path)
+    : out_(path, std::ios::app) {
+    if (!out_) {
+        Logger::error("Cannot write HTTP recording " + path);
+    }
+}
+
+void HttpRecordingWriter::write(const HttpExchange& exchange) {
+    std::string line = HttpRecording::toJsonLine(exchange);
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_ << line << '\n';
+    out_.flush();
+}
+
+} // namespace ModAI
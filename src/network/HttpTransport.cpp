@@ -0,0 +1,530 @@
+#include "network/HttpTransport.h"
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QHttpMultiPart>
+#include <QHttpPart>
+#include <QBuffer>
+#include <QFile>
+#include <QPointer>
+#include <QTimer>
+#include <QUrl>
+#include <algorithm>
+#include <limits>
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+
+namespace ModAI {
+
+// One logical request across retries. Only touched on the transport thread.
+struct HttpTransport::Call {
+    HttpRequest request;
+    HttpCallOptions options;
+    HttpCallback callback;
+    std::string host;
+    int attempt = 0;
+    std::chrono::steady_clock::time_point submitted;  // round trip includes retries
+    QPointer<QNetworkReply> reply;
+    bool holdsSlot = false;
+    bool timedOut = false;
+    bool cancelled = false;
+    bool deadlineExceeded = false;  // with cancelled: the request's deadline ran out
+    bool done = false;
+    CancellationToken::Registration cancelRegistration;
+
+    // Download-to-file and chunk modes: the body streams into sink or
+    // options.onChunk instead of memory
+    std::unique_ptr<QFile> sink;
+    uint64_t received = 0;
+    bool tooLarge = false;
+    bool writeFailed = false;
+};
+
+namespace {
+
+HttpResponse cancelledResponse() {
+    HttpResponse response;
+    response.cancelled = true;
+    response.errorMessage = "Request cancelled";
+    return response;
+}
+
+HttpResponse deadlineResponse() {
+    HttpResponse response;
+    response.cancelled = true;
+    response.deadlineExceeded = true;
+    response.errorMessage = "Request deadline exceeded";
+    return response;
+}
+
+HttpResponse tokenStoppedResponse(const CancellationToken& token) {
+    return token.isCancelled() ? cancelledResponse() : deadlineResponse();
+}
+
+// Bounds how much of a streamed body Qt buffers before we write it out
+constexpr qint64 kDownloadBufferBytes = 256 * 1024;
+
+HttpResponse stoppedResponse() {
+    HttpResponse response;
+    response.errorMessage = "HTTP transport stopped";
+    return response;
+}
+
+std::string hostKey(const std::string& url) {
+    QUrl parsed(QString::fromStdString(url));
+    int defaultPort = parsed.scheme() == "https" ? 443 : 80;
+    return parsed.host().toStdString() + ":" + std::to_string(parsed.port(defaultPort));
+}
+
+} // namespace
+
+HttpTransport& HttpTransport::instance() {
+    static HttpTransport transport;
+    return transport;
+}
+
+HttpTransport::HttpTransport() {
+    thread_.setObjectName("HttpTransport");
+    moveToThread(&thread_);
+    thread_.start();
+}
+
+HttpTransport::~HttpTransport() {
+    shutdown();
+}
+
+QNetworkAccessManager* HttpTransport::manager() {
+    if (!manager_) {
+        manager_ = new QNetworkAccessManager(this);
+    }
+    return manager_;
+}
+
+void HttpTransport::setMaxInFlightPerHost(int limit) {
+    maxInFlightPerHost_ = std::max(1, limit);
+}
+
+HttpTransportStats HttpTransport::stats() const {
+    HttpTransportStats stats;
+    stats.requests = requests_;
+    stats.completed = completed_;
+    stats.failed = failed_;
+    stats.tlsHandshakes = tlsHandshakes_;
+    uint64_t https = httpsAttempts_;
+    stats.reusedConnections = https > stats.tlsHandshakes ? https - stats.tlsHandshakes : 0;
+    stats.http2Responses = http2Responses_;
+    stats.queuedForPool = queuedForPool_;
+    return stats;
+}
+
+void HttpTransport::prewarm(const std::vector<std::string>& urls) {
+    if (stopped_) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, urls]() {
+        for (const auto& url : urls) {
+            QUrl parsed(QString::fromStdString(url));
+            if (parsed.scheme() == "https") {
+                manager()->connectToHostEncrypted(parsed.host(), static_cast<quint16>(parsed.port(443)));
+            } else {
+                manager()->connectToHost(parsed.host(), static_cast<quint16>(parsed.port(80)));
+            }
+            MODAI_LOG_DEBUG("Pre-connecting to " + parsed.host().toStdString());
+        }
+    }, Qt::QueuedConnection);
+}
+
+HttpRequestHandle HttpTransport::submit(const HttpRequest& req, const HttpCallOptions& options, HttpCallback callback) {
+    if (stopped_ || req.cancellation.stopRequested()) {
+        if (callback) {
+            callback(stopped_ ? stoppedResponse() : tokenStoppedResponse(req.cancellation));
+        }
+        return HttpRequestHandle();
+    }
+
+    auto call = std::make_shared<Call>();
+    call->request = req;
+    call->options = options;
+    call->callback = std::move(callback);
+    call->host = hostKey(req.url);
+    call->submitted = std::chrono::steady_clock::now();
+
+    QPointer<HttpTransport> self(this);
+    std::weak_ptr<Call> weak = call;
+    // Runs the cancellation on the transport thread, from whichever thread asks
+    auto abortFrom = [self, weak](bool deadline) {
+        auto abort = [self, weak, deadline]() {
+            auto call = weak.lock();
+            if (self && call) {
+                self->abort(call, deadline);
+            }
+        };
+        if (!self) {
+            return;
+        }
+        if (self->isTransportThread()) {
+            abort();
+        } else {
+            QMetaObject::invokeMethod(self.data(), abort, Qt::QueuedConnection);
+        }
+    };
+    call->cancelRegistration = req.cancellation.onCancel([abortFrom]() { abortFrom(false); });
+
+    auto begin = [this, call]() {
+        if (call->request.cancellation.hasDeadline()) {
+            // One timer covers the whole call: waiting for a slot, attempts and backoff
+            auto left = call->request.cancellation.remaining(
+                std::chrono::milliseconds(std::numeric_limits<int>::max()));
+            std::weak_ptr<Call> weak = call;
+            QTimer::singleShot(static_cast<int>(left.count()), this, [this, weak]() {
+                if (auto call = weak.lock()) {
+                    abort(call, true);
+                }
+            });
+        }
+        enqueue(call);
+    };
+    if (isTransportThread()) {
+        begin();
+    } else {
+        QMetaObject::invokeMethod(this, begin, Qt::QueuedConnection);
+    }
+
+    return HttpRequestHandle([abortFrom]() { abortFrom(false); });
+}
+
+void HttpTransport::abort(const std::shared_ptr<Call>& call, bool deadline) {
+    if (call->done) {
+        return;
+    }
+    call->cancelled = true;
+    call->deadlineExceeded = deadline;
+    if (deadline) {
+        Metrics::counter("modai_http_deadline_exceeded_total", "host=\"" + call->host + "\"").inc();
+    }
+    if (call->reply) {
+        call->reply->abort();  // finished handler completes the call
+    } else {
+        finish(call, deadline ? deadlineResponse() : cancelledResponse());  // queued for a slot or in backoff
+    }
+}
+
+void HttpTransport::enqueue(std::shared_ptr<Call> call) {
+    if (call->done) {
+        return;
+    }
+    if (stopped_) {
+        finish(call, stoppedResponse());
+        return;
+    }
+    unfinished_.insert(call);
+
+    HostState& host = hosts_[call->host];
+    if (host.inFlight >= maxInFlightPerHost_) {
+        queuedForPool_++;
+        host.waiting.push_back(std::move(call));
+        return;
+    }
+    host.inFlight++;
+    call->holdsSlot = true;
+    startAttempt(std::move(call));
+}
+
+void HttpTransport::releaseHost(const std::string& hostName) {
+    HostState& host = hosts_[hostName];
+    host.inFlight--;
+    while (!stopped_ && !host.waiting.empty() && host.inFlight < maxInFlightPerHost_) {
+        auto next = std::move(host.waiting.front());
+        host.waiting.pop_front();
+        if (next->done) {
+            continue;  // cancelled while queued
+        }
+        host.inFlight++;
+        next->holdsSlot = true;
+        startAttempt(std::move(next));
+    }
+}
+
+QNetworkReply* HttpTransport::send(const HttpRequest& req) {
+    QNetworkRequest request(QUrl(QString::fromStdString(req.url)));
+    for (const auto& [key, value] : req.headers) {
+        request.setRawHeader(QByteArray::fromStdString(key), QByteArray::fromStdString(value));
+    }
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, http2Enabled_.load());
+
+    if (req.method == "GET") {
+        return manager()->get(request);
+    }
+
+    if (req.contentType == "multipart/form-data" && !req.binaryData.empty()) {
+        QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+        
+        QHttpPart filePart;
+        filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("image/png"));
+        // Hive API expects field name "media" for image data
+        filePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
+                          QVariant("form-data; name=\"media\"; filename=\"image.png\""));
+        // Read straight from the caller's buffer; the Call keeps it alive
+        // for as long as the reply (and so the multipart) exists
+        QBuffer* payload = new QBuffer(multiPart);
+        payload->setData(req.binaryData.toRawQByteArray());
+        payload->open(QIODevice::ReadOnly);
+        filePart.setBodyDevice(payload);
+        
+        multiPart->append(filePart);
+        
+        request.setRawHeader("Content-Type", "multipart/form-data; boundary=" + multiPart->boundary());
+        QNetworkReply* reply = manager()->post(request, multiPart);
+        multiPart->setParent(reply);
+        return reply;
+    }
+
+    if (!req.contentType.empty()) {
+        request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray::fromStdString(req.contentType));
+    } else {
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    }
+    
+    if (req.body.empty() && !req.binaryData.empty()) {
+        QBuffer* payload = new QBuffer();
+        payload->setData(req.binaryData.toRawQByteArray());
+        payload->open(QIODevice::ReadOnly);
+        QNetworkReply* reply = manager()->post(request, payload);
+        payload->setParent(reply);
+        return reply;
+    }
+    
+    return manager()->post(request, QByteArray::fromStdString(req.body));
+}
+
+HttpResponse HttpTransport::readReply(QNetworkReply* reply) {
+    HttpResponse response;
+    response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    response.body = reply->readAll().toStdString();
+    response.success = (reply->error() == QNetworkReply::NoError);
+    
+    if (!response.success) {
+        response.errorMessage = reply->errorString().toStdString();
+        MODAI_LOG_DEBUG("Qt HTTP error code: " + std::to_string(static_cast<int>(reply->error())) + 
+                     ", HTTP status: " + std::to_string(response.statusCode) +
+                     ", Body length: " + std::to_string(response.body.length()));
+    }
+    
+    // Read headers
+    auto headers = reply->rawHeaderPairs();
+    for (const auto& header : headers) {
+        response.headers[header.first.toStdString()] = header.second.toStdString();
+    }
+    return response;
+}
+
+void HttpTransport::startAttempt(std::shared_ptr<Call> call) {
+    if (call->done) {
+        if (call->holdsSlot) {
+            call->holdsSlot = false;
+            releaseHost(call->host);
+        }
+        return;
+    }
+
+    call->received = 0;
+    call->tooLarge = false;
+    call->writeFailed = false;
+    if (!call->options.downloadPath.empty()) {
+        call->sink = std::make_unique<QFile>(QString::fromStdString(call->options.downloadPath + ".part"));
+        if (!call->sink->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            HttpResponse response;
+            response.errorMessage = "Cannot open download target " + call->options.downloadPath;
+            call->sink.reset();
+            call->holdsSlot = false;
+            releaseHost(call->host);
+            finish(call, std::move(response));
+            return;
+        }
+    }
+
+    QNetworkReply* reply = send(call->request);
+    call->reply = reply;
+    call->timedOut = false;
+    requests_++;
+    if (reply->url().scheme() == "https") {
+        httpsAttempts_++;
+    }
+
+    connect(reply, &QNetworkReply::encrypted, this, [this]() { tlsHandshakes_++; });
+
+    auto* timer = new QTimer(reply);
+    timer->setSingleShot(true);
+    timer->setInterval(call->options.timeoutMs);
+    connect(timer, &QTimer::timeout, reply, [call, reply]() {
+        call->timedOut = true;
+        reply->abort();
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, call, reply]() {
+        onAttemptFinished(call, reply);
+    });
+    if (call->sink || call->options.onChunk) {
+        reply->setReadBufferSize(kDownloadBufferBytes);
+        connect(reply, &QNetworkReply::readyRead, this, [this, call, reply]() {
+            drainBody(call, reply);
+        });
+        connect(reply, &QNetworkReply::metaDataChanged, this, [call, reply]() {
+            // Refuse oversized bodies before any of them arrives
+            uint64_t limit = call->options.maxBodyBytes;
+            qint64 length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+            if (limit > 0 && length > 0 && static_cast<uint64_t>(length) > limit) {
+                call->tooLarge = true;
+                reply->abort();
+            }
+        });
+    }
+    timer->start();
+}
+
+void HttpTransport::drainBody(const std::shared_ptr<Call>& call, QNetworkReply* reply) {
+    if ((!call->sink && !call->options.onChunk) || call->tooLarge || call->writeFailed) {
+        return;
+    }
+    QByteArray chunk = reply->readAll();
+    call->received += static_cast<uint64_t>(chunk.size());
+    uint64_t limit = call->options.maxBodyBytes;
+    if (limit > 0 && call->received > limit) {
+        call->tooLarge = true;
+        reply->abort();
+        return;
+    }
+    if (!call->sink) {
+        if (!chunk.isEmpty()) {
+            call->options.onChunk(chunk.constData(), static_cast<size_t>(chunk.size()));
+        }
+    } else if (call->sink->write(chunk) != chunk.size()) {
+        call->writeFailed = true;
+        reply->abort();
+    }
+}
+
+void HttpTransport::onAttemptFinished(std::shared_ptr<Call> call, QNetworkReply* reply) {
+    call->reply = nullptr;
+    if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()) {
+        http2Responses_++;
+    }
+
+    HttpResponse response;
+    if (stopped_) {
+        response = stoppedResponse();
+    } else if (call->cancelled) {
+        response = call->deadlineExceeded ? deadlineResponse() : cancelledResponse();
+    } else if (call->tooLarge) {
+        response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        response.errorMessage = "Response exceeds " + std::to_string(call->options.maxBodyBytes) + " bytes";
+    } else if (call->timedOut) {
+        response.success = false;
+        response.errorMessage = "Request timeout";
+    } else {
+        drainBody(call, reply);  // whatever arrived after the last readyRead
+        response = readReply(reply);
+        if (call->writeFailed) {
+            response.success = false;
+            response.errorMessage = "Failed to write " + call->options.downloadPath;
+        }
+    }
+    reply->deleteLater();
+
+    if (call->sink) {
+        // Only a complete, successful body replaces the target file
+        call->sink->close();
+        QString partPath = call->sink->fileName();
+        call->sink.reset();
+        if (response.success) {
+            QString target = QString::fromStdString(call->options.downloadPath);
+            QFile::remove(target);
+            if (!QFile::rename(partPath, target)) {
+                response.success = false;
+                response.errorMessage = "Failed to move download into " + call->options.downloadPath;
+                QFile::remove(partPath);
+            }
+        } else {
+            QFile::remove(partPath);
+        }
+    }
+
+    // Free the slot before backing off so other requests to the host proceed
+    call->holdsSlot = false;
+    releaseHost(call->host);
+
+    // Only retry on rate limits (429) or server errors (5xx)
+    // A consumer that already saw part of a streamed body can't be fed it again
+    bool retryable = !response.success && !response.cancelled && !stopped_ &&
+                     (response.statusCode == 429 || response.statusCode >= 500) &&
+                     !(call->options.onChunk && call->received > 0);
+    if (retryable && call->attempt < call->options.maxRetries) {
+        int delay = call->options.retryDelayMs * (1 << call->attempt);
+        // No point backing off past the deadline; the caller gets this failure now
+        auto backoff = std::chrono::milliseconds(delay);
+        if (call->request.cancellation.remaining(backoff) < backoff) {
+            MODAI_LOG_DEBUG("Not retrying request to " + call->host + ": deadline is within the backoff");
+            finish(call, std::move(response));
+            return;
+        }
+        call->attempt++;
+        Metrics::counter("modai_http_retries_total", "host=\"" + call->host + "\"").inc();
+        Logger::warn("Request failed (" + std::to_string(response.statusCode) + "), retrying in " + std::to_string(delay) + "ms. Attempt " + std::to_string(call->attempt));
+        QTimer::singleShot(delay, this, [this, call]() { enqueue(call); });
+        return;
+    }
+
+    finish(call, std::move(response));
+}
+
+void HttpTransport::finish(std::shared_ptr<Call> call, HttpResponse response) {
+    if (call->done) {
+        return;
+    }
+    call->done = true;
+    call->cancelRegistration = CancellationToken::Registration();
+    unfinished_.erase(call);
+    std::string hostLabel = "host=\"" + call->host + "\"";
+    if (response.success) {
+        completed_++;
+    } else {
+        failed_++;
+        Metrics::counter("modai_http_failures_total", hostLabel).inc();
+    }
+    Metrics::histogram("modai_http_request_seconds", hostLabel).record(std::chrono::steady_clock::now() - call->submitted);
+    HttpCallback callback = std::move(call->callback);
+    if (callback) {
+        callback(std::move(response));
+    }
+}
+
+void HttpTransport::shutdown() {
+    if (stopped_.exchange(true)) {
+        return;
+    }
+    auto drain = [this]() {
+        // Complete everything still pending so no caller waits forever
+        auto pending = std::move(unfinished_);
+        unfinished_.clear();
+        for (const auto& call : pending) {
+            if (call->reply) {
+                call->reply->abort();
+            }
+            finish(call, stoppedResponse());
+        }
+        hosts_.clear();
+        delete manager_;
+        manager_ = nullptr;
+    };
+    if (isTransportThread()) {
+        drain();
+    } else if (thread_.isRunning()) {
+        QMetaObject::invokeMethod(this, drain, Qt::BlockingQueuedConnection);
+    }
+    thread_.quit();
+    if (!isTransportThread()) {
+        thread_.wait();
+    }
+    Logger::info("HTTP transport stopped");
+}
+
+} // namespace ModAI
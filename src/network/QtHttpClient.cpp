@@ -1,205 +1,120 @@
 #include "network/QtHttpClient.h"
-#include <QNetworkRequest>
-#include <QNetworkReply>
-#include <QHttpMultiPart>
-#include <QHttpPart>
+#include <QCoreApplication>
 #include <QEventLoop>
-#include <QTimer>
-#include <QByteArray>
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QThread>
+#include <chrono>
 #include "utils/Logger.h"
 
 namespace ModAI {
 
+namespace {
+
+// Requests made inside a CancellationScope inherit its token
+HttpRequest withCurrentToken(HttpRequest request) {
+    if (!request.cancellation.cancellable()) {
+        request.cancellation = CancellationToken::current();
+    }
+    return request;
+}
+
+} // namespace
+
 QtHttpClient::QtHttpClient(QObject* parent)
-    : QObject(parent)
-    , networkManager_(std::make_unique<QNetworkAccessManager>(this))
-    , creationThread_(QThread::currentThread())
-    , timeoutMs_(60000) {  // Increased to 60 seconds for slower APIs
+    : QObject(parent) {
+    options_.timeoutMs = 60000;  // Increased to 60 seconds for slower APIs
 }
 
-QNetworkAccessManager* QtHttpClient::getNetworkManager() {
-    // If we're in a different thread, create a thread-local network manager
-    if (QThread::currentThread() != creationThread_) {
-        // Thread-local storage ensures one manager per worker thread
-        static thread_local std::unique_ptr<QNetworkAccessManager> threadLocalManager;
-        if (!threadLocalManager) {
-            threadLocalManager = std::make_unique<QNetworkAccessManager>(nullptr);
-            Logger::info("Created thread-local QNetworkAccessManager for thread: " + 
-                        std::to_string(reinterpret_cast<uintptr_t>(QThread::currentThread())));
-        }
-        return threadLocalManager.get();
-    }
-    return networkManager_.get();
+HttpRequestHandle QtHttpClient::postAsync(const HttpRequest& req, HttpCallback callback) {
+    HttpRequest request = withCurrentToken(req);
+    request.method = "POST";
+    return HttpTransport::instance().submit(request, options_, std::move(callback));
 }
 
-QNetworkRequest QtHttpClient::createRequest(const std::string& url, const std::map<std::string, std::string>& headers) {
-    QNetworkRequest request(QUrl(QString::fromStdString(url)));
-    
-    for (const auto& [key, value] : headers) {
-        request.setRawHeader(QByteArray::fromStdString(key), QByteArray::fromStdString(value));
-    }
-    
-    return request;
+HttpRequestHandle QtHttpClient::getAsync(const std::string& url,
+                                         const std::map<std::string, std::string>& headers,
+                                         HttpCallback callback) {
+    HttpRequest request;
+    request.url = url;
+    request.method = "GET";
+    request.headers = headers;
+    return HttpTransport::instance().submit(withCurrentToken(std::move(request)), options_, std::move(callback));
+}
+
+HttpRequestHandle QtHttpClient::downloadAsync(const std::string& url,
+                                              const std::map<std::string, std::string>& headers,
+                                              const std::string& filePath,
+                                              uint64_t maxBytes,
+                                              HttpCallback callback) {
+    HttpRequest request;
+    request.url = url;
+    request.method = "GET";
+    request.headers = headers;
+    HttpCallOptions options = options_;
+    options.downloadPath = filePath;
+    options.maxBodyBytes = maxBytes;
+    return HttpTransport::instance().submit(withCurrentToken(std::move(request)), options, std::move(callback));
 }
 
-HttpResponse QtHttpClient::executeRequest(QNetworkReply* reply) {
-    HttpResponse response;
-    
+HttpRequestHandle QtHttpClient::streamAsync(const HttpRequest& req,
+                                            HttpChunkCallback onChunk,
+                                            HttpCallback callback) {
+    HttpCallOptions options = options_;
+    options.onChunk = std::move(onChunk);
+    return HttpTransport::instance().submit(withCurrentToken(req), options, std::move(callback));
+}
+
+HttpResponse QtHttpClient::waitFor(const HttpRequest& original) {
+    HttpRequest req = withCurrentToken(original);
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    auto future = promise->get_future();
+
+    // On the GUI thread, spin a local loop so the window keeps repainting
+    QCoreApplication* app = QCoreApplication::instance();
+    bool guiThread = app && QThread::currentThread() == app->thread();
     QEventLoop loop;
-    QTimer timer;
-    timer.setSingleShot(true);
-    timer.setInterval(timeoutMs_);
-    
-    connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
-    
-    timer.start();
-    loop.exec();
-    
-    if (timer.isActive()) {
-        timer.stop();
-        response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        response.body = reply->readAll().toStdString();
-        response.success = (reply->error() == QNetworkReply::NoError);
-        
-        if (!response.success) {
-            response.errorMessage = reply->errorString().toStdString();
-            Logger::debug("Qt HTTP error code: " + std::to_string(static_cast<int>(reply->error())) + 
-                         ", HTTP status: " + std::to_string(response.statusCode) +
-                         ", Body length: " + std::to_string(response.body.length()));
-        }
-        
-        // Read headers
-        auto headers = reply->rawHeaderPairs();
-        for (const auto& header : headers) {
-            response.headers[header.first.toStdString()] = header.second.toStdString();
-        }
-    } else {
-        // Timeout
+    QEventLoop* loopPtr = guiThread ? &loop : nullptr;
+
+    HttpRequestHandle handle = HttpTransport::instance().submit(req, options_,
+        [promise, loopPtr](HttpResponse response) {
+            // Quit is posted before the value is set, so the loop outlives it
+            if (loopPtr) {
+                QMetaObject::invokeMethod(loopPtr, "quit", Qt::QueuedConnection);
+            }
+            promise->set_value(std::move(response));
+        });
+
+    if (guiThread && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        loop.exec();
+    }
+
+    // Upper bound in case the transport thread stops processing events
+    auto budget = std::chrono::milliseconds(static_cast<int64_t>(options_.timeoutMs) * (options_.maxRetries + 1) +
+                                            static_cast<int64_t>(options_.retryDelayMs) * (1 << options_.maxRetries) + 5000);
+    if (req.cancellation.hasDeadline()) {
+        budget = req.cancellation.remaining(budget) + std::chrono::milliseconds(1000);
+    }
+    if (future.wait_for(budget) != std::future_status::ready) {
+        handle.cancel();
+        HttpResponse response;
         response.success = false;
         response.errorMessage = "Request timeout";
-        reply->abort();
+        return response;
     }
-    
-    reply->deleteLater();
-    return response;
+    return future.get();
 }
 
 HttpResponse QtHttpClient::post(const HttpRequest& req) {
-    HttpResponse response;
-    int retries = 0;
-    
-    while (retries <= maxRetries_) {
-        QNetworkRequest request = createRequest(req.url, req.headers);
-        QNetworkReply* reply = nullptr;
-        
-        if (req.contentType == "multipart/form-data" && !req.binaryData.empty()) {
-            QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-            
-            QHttpPart filePart;
-            filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("image/png"));
-            // Hive API expects field name "media" for image data
-            filePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
-                              QVariant("form-data; name=\"media\"; filename=\"image.png\""));
-            filePart.setBody(QByteArray(reinterpret_cast<const char*>(req.binaryData.data()), 
-                                       req.binaryData.size()));
-            
-            multiPart->append(filePart);
-            
-            request.setRawHeader("Content-Type", "multipart/form-data; boundary=" + multiPart->boundary());
-            reply = getNetworkManager()->post(request, multiPart);
-            multiPart->setParent(reply);
-        } else {
-            if (!req.contentType.empty()) {
-                request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray::fromStdString(req.contentType));
-            } else {
-                request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-            }
-            
-            QByteArray data;
-            if (!req.body.empty()) {
-                data = QByteArray::fromStdString(req.body);
-            } else if (!req.binaryData.empty()) {
-                data = QByteArray(reinterpret_cast<const char*>(req.binaryData.data()), req.binaryData.size());
-            }
-            
-            reply = getNetworkManager()->post(request, data);
-        }
-        
-        response = executeRequest(reply);
-        
-        // Success - return immediately
-        if (response.success) {
-            return response;
-        }
-        
-        // Permanent client errors (except 429) - don't retry
-        if (response.statusCode >= 400 && response.statusCode < 500 && response.statusCode != 429) {
-            return response;
-        }
-        
-        // Only retry on rate limits (429) or server errors (5xx)
-        if (response.statusCode == 429 || response.statusCode >= 500) {
-            retries++;
-            if (retries <= maxRetries_) {
-                int delay = retryDelayMs_ * (1 << (retries - 1));
-                Logger::warn("Request failed (" + std::to_string(response.statusCode) + "), retrying in " + std::to_string(delay) + "ms. Attempt " + std::to_string(retries));
-                
-                QEventLoop loop;
-                QTimer::singleShot(delay, &loop, &QEventLoop::quit);
-                loop.exec();
-            } else {
-                return response;
-            }
-        } else {
-            return response;
-        }
-    }
-    return response;
+    HttpRequest request = req;
+    request.method = "POST";
+    return waitFor(request);
 }
 
 HttpResponse QtHttpClient::get(const std::string& url, const std::map<std::string, std::string>& headers) {
-    HttpResponse response;
-    int retries = 0;
-    
-    while (retries <= maxRetries_) {
-        QNetworkRequest request = createRequest(url, headers);
-        QNetworkReply* reply = getNetworkManager()->get(request);
-        
-        response = executeRequest(reply);
-        
-        // Success - return immediately
-        if (response.success) {
-            return response;
-        }
-        
-        // Permanent client errors (except 429) - don't retry
-        if (response.statusCode >= 400 && response.statusCode < 500 && response.statusCode != 429) {
-            return response;
-        }
-        
-        // Only retry on rate limits (429) or server errors (5xx)
-        if (response.statusCode == 429 || response.statusCode >= 500) {
-            retries++;
-            if (retries <= maxRetries_) {
-                int delay = retryDelayMs_ * (1 << (retries - 1));
-                Logger::warn("Request failed (" + std::to_string(response.statusCode) + "), retrying in " + std::to_string(delay) + "ms. Attempt " + std::to_string(retries));
-                
-                QEventLoop loop;
-                QTimer::singleShot(delay, &loop, &QEventLoop::quit);
-                loop.exec();
-            } else {
-                return response;
-            }
-        } else {
-            return response;
-        }
-    }
-    return response;
+    HttpRequest request;
+    request.url = url;
+    request.method = "GET";
+    request.headers = headers;
+    return waitFor(request);
 }
 
 } // namespace ModAI
-
@@ -1,38 +1,170 @@
 #include "network/RateLimiter.h"
-#include <thread>
-#include <chrono>
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
 
 namespace ModAI {
 
+namespace {
+
+std::optional<double> headerNumber(const std::map<std::string, std::string>& headers, const char* name) {
+    for (const auto& [key, value] : headers) {
+        if (key.size() != std::char_traits<char>::length(name)) {
+            continue;
+        }
+        bool same = std::equal(key.begin(), key.end(), name, [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+        if (!same) {
+            continue;
+        }
+        char* end = nullptr;
+        double number = std::strtod(value.c_str(), &end);
+        if (end == value.c_str() || !std::isfinite(number)) {
+            return std::nullopt;  // e.g. an HTTP-date Retry-After
+        }
+        return number;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
 RateLimiter::RateLimiter(int maxRequests, std::chrono::milliseconds timeWindow)
-    : maxRequests_(maxRequests)
-    , timeWindow_(timeWindow) {
+    : capacity_(std::max(1, maxRequests))
+    , tokensPerMs_(capacity_ / static_cast<double>(std::max<int64_t>(1, timeWindow.count())))
+    , tokens_(capacity_)
+    , lastRefill_(Clock::now())
+    , blockedUntil_(Clock::time_point::min()) {
+}
+
+std::shared_ptr<RateLimiter> RateLimiter::shared(const std::string& key, int maxRequests,
+                                                 std::chrono::milliseconds timeWindow) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<RateLimiter>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto existing = registry[key].lock()) {
+        return existing;
+    }
+    auto limiter = std::make_shared<RateLimiter>(maxRequests, timeWindow);
+    registry[key] = limiter;
+    return limiter;
+}
+
+void RateLimiter::refillLocked(Clock::time_point now) {
+    if (now <= lastRefill_) {
+        return;
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - lastRefill_).count();
+    tokens_ = std::min(capacity_, tokens_ + elapsedMs * tokensPerMs_);
+    lastRefill_ = now;
+}
+
+RateLimiter::Clock::time_point RateLimiter::nextAvailableLocked(Clock::time_point now) const {
+    Clock::time_point next = now;
+    if (tokens_ < 1.0) {
+        double waitMs = (1.0 - tokens_) / tokensPerMs_;
+        next = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(waitMs));
+    }
+    return std::max(next, blockedUntil_);
 }
 
 bool RateLimiter::acquire() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto now = std::chrono::steady_clock::now();
-    
-    // Remove old requests outside the time window
-    while (!requestTimes_.empty() && 
-           (now - requestTimes_.front()) > timeWindow_) {
-        requestTimes_.pop();
+    auto now = Clock::now();
+    refillLocked(now);
+    if (now < blockedUntil_ || tokens_ < 1.0) {
+        return false;
     }
-    
-    if (requestTimes_.size() < static_cast<size_t>(maxRequests_)) {
-        requestTimes_.push(now);
-        return true;
-    }
-    
-    return false;
+    tokens_ -= 1.0;
+    return true;
 }
 
 void RateLimiter::waitIfNeeded() {
-    while (!acquire()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    tryAcquireUntil(Clock::time_point::max());
+}
+
+bool RateLimiter::tryAcquireFor(std::chrono::milliseconds timeout) {
+    return tryAcquireUntil(Clock::now() + timeout);
+}
+
+bool RateLimiter::tryAcquireUntil(Clock::time_point deadline) {
+    return acquire(CancellationToken().withDeadline(deadline));
+}
+
+bool RateLimiter::acquire(const CancellationToken& token) {
+    static Histogram& waitTime = Metrics::histogram("modai_rate_limiter_wait_seconds");
+    Clock::time_point deadline = token.deadline();
+    // Locking before notifying means the wakeup can't slip in between our
+    // cancellation check and the wait
+    auto registration = token.onCancel([this]() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto start = Clock::now();
+    while (true) {
+        if (token.isCancelled()) {
+            return false;
+        }
+        auto now = Clock::now();
+        refillLocked(now);
+        if (now >= blockedUntil_ && tokens_ >= 1.0) {
+            tokens_ -= 1.0;
+            waitTime.record(now - start);
+            return true;
+        }
+        auto next = nextAvailableLocked(now);
+        if (next > deadline) {
+            return false;  // Not going to make it; let the caller reschedule
+        }
+        // Woken early if headers change the schedule
+        cv_.wait_until(lock, next);
     }
 }
 
-} // namespace ModAI
+std::chrono::milliseconds RateLimiter::timeUntilAvailable() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    refillLocked(now);
+    return std::chrono::ceil<std::chrono::milliseconds>(nextAvailableLocked(now) - now);
+}
 
+void RateLimiter::updateFromHeaders(const std::map<std::string, std::string>& headers, int statusCode) {
+    auto retryAfter = headerNumber(headers, "retry-after");
+    auto remaining = headerNumber(headers, "x-ratelimit-remaining");
+    auto reset = headerNumber(headers, "x-ratelimit-reset");  // seconds until the window resets
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    refillLocked(now);
+
+    auto pauseFor = [&](double seconds) {
+        auto until = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        blockedUntil_ = std::max(blockedUntil_, until);
+        tokens_ = std::min(tokens_, 0.0);
+        Logger::warn("Rate limited by server; pausing " + std::to_string(static_cast<int>(std::ceil(seconds))) + "s");
+    };
+
+    if (retryAfter && *retryAfter > 0) {
+        pauseFor(*retryAfter);
+    } else if (remaining) {
+        if (*remaining < 1.0 && reset && *reset > 0) {
+            pauseFor(*reset);
+        } else {
+            // Never spend more than the server says is left
+            tokens_ = std::min(tokens_, std::floor(*remaining));
+        }
+    } else if (statusCode == 429) {
+        // No hint: drain the bucket so the next call waits one refill interval
+        tokens_ = std::min(tokens_, 0.0);
+    }
+    cv_.notify_all();
+}
+
+} // namespace ModAI
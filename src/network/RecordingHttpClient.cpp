@@ -0,0 +1,113 @@
+#include "network/RecordingHttpClient.h"
+#include <fstream>
+#include <iterator>
+
+namespace ModAI {
+
+namespace {
+
+size_t requestSize(const HttpRequest& req) {
+    return req.body.empty() ? req.binaryData.size() : req.body.size();
+}
+
+} // namespace
+
+RecordingHttpClient::RecordingHttpClient(std::unique_ptr<HttpClient> inner,
+                                         std::shared_ptr<HttpRecordingWriter> writer)
+    : inner_(std::move(inner))
+    , writer_(std::move(writer)) {
+}
+
+void RecordingHttpClient::record(const std::string& method, const std::string& url, size_t requestBytes,
+                                 const HttpResponse& response, const std::string& body,
+                                 Clock::time_point started) {
+    HttpExchange exchange;
+    exchange.method = method;
+    exchange.url = url;
+    exchange.requestBytes = requestBytes;
+    exchange.statusCode = response.statusCode;
+    exchange.success = response.success;
+    exchange.errorMessage = response.errorMessage;
+    exchange.cancelled = response.cancelled || response.deadlineExceeded;
+    exchange.headers = response.headers;
+    exchange.latency = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started);
+    if (url.find("/access_token") != std::string::npos && response.success) {
+        exchange.body = R"({"access_token":"recorded","token_type":"bearer","expires_in":86400})";
+    } else {
+        exchange.body = body;
+    }
+    writer_->write(exchange);
+}
+
+HttpResponse RecordingHttpClient::post(const HttpRequest& req) {
+    auto started = Clock::now();
+    HttpResponse response = inner_->post(req);
+    record(req.method.empty() ? "POST" : req.method, req.url, requestSize(req), response, response.body, started);
+    return response;
+}
+
+HttpResponse RecordingHttpClient::get(const std::string& url, const std::map<std::string, std::string>& headers) {
+    auto started = Clock::now();
+    HttpResponse response = inner_->get(url, headers);
+    record("GET", url, 0, response, response.body, started);
+    return response;
+}
+
+HttpRequestHandle RecordingHttpClient::postAsync(const HttpRequest& req, HttpCallback callback) {
+    auto started = Clock::now();
+    return inner_->postAsync(req,
+        [this, method = req.method.empty() ? "POST" : req.method, url = req.url, bytes = requestSize(req),
+         started, callback = std::move(callback)](HttpResponse response) {
+            record(method, url, bytes, response, response.body, started);
+            callback(std::move(response));
+        });
+}
+
+HttpRequestHandle RecordingHttpClient::getAsync(const std::string& url,
+                                                const std::map<std::string, std::string>& headers,
+                                                HttpCallback callback) {
+    auto started = Clock::now();
+    return inner_->getAsync(url, headers,
+        [this, url, started, callback = std::move(callback)](HttpResponse response) {
+            record("GET", url, 0, response, response.body, started);
+            callback(std::move(response));
+        });
+}
+
+HttpRequestHandle RecordingHttpClient::downloadAsync(const std::string& url,
+                                                     const std::map<std::string, std::string>& headers,
+                                                     const std::string& filePath,
+                                                     uint64_t maxBytes,
+                                                     HttpCallback callback) {
+    auto started = Clock::now();
+    return inner_->downloadAsync(url, headers, filePath, maxBytes,
+        [this, url, filePath, started, callback = std::move(callback)](HttpResponse response) {
+            std::string body;
+            if (response.success) {
+                std::ifstream in(filePath, std::ios::binary);
+                body.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            }
+            record("DOWNLOAD", url, 0, response, body, started);
+            callback(std::move(response));
+        });
+}
+
+HttpRequestHandle RecordingHttpClient::streamAsync(const HttpRequest& req,
+                                                   HttpChunkCallback onChunk,
+                                                   HttpCallback callback) {
+    auto started = Clock::now();
+    // Chunks and the completion may arrive on different threads, but never at once
+    auto body = std::make_shared<std::string>();
+    return inner_->streamAsync(req,
+        [body, onChunk = std::move(onChunk)](const char* data, size_t size) {
+            body->append(data, size);
+            onChunk(data, size);
+        },
+        [this, method = req.method, url = req.url, bytes = requestSize(req), body, started,
+         callback = std::move(callback)](HttpResponse response) {
+            record(method, url, bytes, response, *body, started);
+            callback(std::move(response));
+        });
+}
+
+} // namespace ModAI
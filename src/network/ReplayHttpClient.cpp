@@ -0,0 +1,291 @@
+#include "network/ReplayHttpClient.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace ModAI {
+
+/**
+ * Delivers responses when they are due, on one thread. A cancelled request
+ * is delivered right away with HttpResponse::cancelled set.
+ */
+class ReplayHttpClient::Scheduler : public std::enable_shared_from_this<Scheduler> {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Deliver = std::function<void(HttpResponse)>;
+
+    Scheduler() : thread_([this]() { run(); }) {}
+    ~Scheduler() { shutdown(); }
+
+    HttpRequestHandle add(Clock::time_point due, HttpResponse response, Deliver deliver,
+                          const CancellationToken& token) {
+        if (token.hasDeadline() && token.deadline() < due) {
+            due = token.deadline();
+            response = HttpResponse();
+            response.deadlineExceeded = true;
+            response.errorMessage = "Deadline exceeded";
+        }
+        uint64_t id;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopping_) {
+                lock.unlock();
+                deliver(cancelledResponse());
+                return HttpRequestHandle();
+            }
+            id = nextId_++;
+            pending_[id] = Pending{std::move(response), std::move(deliver), due, {}};
+            queue_.emplace(due, id);
+        }
+        changed_.notify_one();
+
+        std::weak_ptr<Scheduler> weak = weak_from_this();
+        if (token.cancellable()) {
+            // Registered outside the lock: it runs right away if already cancelled
+            auto registration = token.onCancel([weak, id]() {
+                if (auto self = weak.lock()) {
+                    self->cancel(id);
+                }
+            });
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto it = pending_.find(id);
+            if (it != pending_.end()) {
+                it->second.registration = std::move(registration);
+            } else {
+                lock.unlock();  // already delivered; unregister without the lock
+            }
+        }
+        return HttpRequestHandle([weak, id]() {
+            if (auto self = weak.lock()) {
+                self->cancel(id);
+            }
+        });
+    }
+
+    void cancel(uint64_t id) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = pending_.find(id);
+            if (it == pending_.end() || it->second.response.cancelled) {
+                return;
+            }
+            queue_.erase({it->second.due, id});
+            it->second.due = Clock::now();
+            it->second.response = cancelledResponse();
+            queue_.emplace(it->second.due, id);
+        }
+        changed_.notify_one();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_one();
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+    }
+
+private:
+    struct Pending {
+        HttpResponse response;
+        Deliver deliver;
+        Clock::time_point due;
+        CancellationToken::Registration registration;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<uint64_t, Pending> pending_;
+    std::set<std::pair<Clock::time_point, uint64_t>> queue_;  // by due time
+    uint64_t nextId_ = 1;
+    bool stopping_ = false;
+    std::thread thread_;  // last, so everything above exists when it starts
+
+    static HttpResponse cancelledResponse() {
+        HttpResponse response;
+        response.cancelled = true;
+        response.errorMessage = "Cancelled";
+        return response;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            if (queue_.empty()) {
+                if (stopping_) {
+                    return;
+                }
+                changed_.wait(lock);
+                continue;
+            }
+            auto [due, id] = *queue_.begin();
+            if (!stopping_ && due > Clock::now()) {
+                changed_.wait_until(lock, due);
+                continue;
+            }
+            queue_.erase(queue_.begin());
+            auto node = pending_.extract(id);
+            const bool stopping = stopping_;
+            lock.unlock();
+            Pending& pending = node.mapped();
+            if (stopping && !pending.response.cancelled) {
+                pending.response = cancelledResponse();
+            }
+            pending.registration = CancellationToken::Registration();
+            pending.deliver(std::move(pending.response));
+            lock.lock();
+        }
+    }
+};
+
+ReplayHttpClient::ReplayHttpClient(std::shared_ptr<HttpRecording> recording, ReplayOptions options,
+                                   Responder responder)
+    : recording_(std::move(recording))
+    , options_(options)
+    , responder_(std::move(responder))
+    , scheduler_(std::make_shared<Scheduler>())
+    , random_(options.seed) {
+}
+
+ReplayHttpClient::~ReplayHttpClient() {
+    scheduler_->shutdown();
+}
+
+std::pair<HttpResponse, std::chrono::milliseconds> ReplayHttpClient::respond(const HttpRequest& req,
+                                                                            const std::string& method) {
+    std::optional<HttpExchange> exchange;
+    const char* source = "responder";
+    if (responder_) {
+        exchange = responder_(req);
+    }
+    if (!exchange && recording_) {
+        source = "recorded";
+        if (const HttpExchange* recorded = recording_->next(method, req.url)) {
+            exchange = *recorded;
+        }
+    }
+
+    HttpResponse response;
+    std::chrono::milliseconds latency{0};
+    if (exchange) {
+        response.statusCode = exchange->statusCode;
+        response.success = exchange->success;
+        response.errorMessage = std::move(exchange->errorMessage);
+        response.headers = std::move(exchange->headers);
+        response.body = std::move(exchange->body);
+        latency = std::chrono::milliseconds(
+            static_cast<int64_t>(static_cast<double>(exchange->latency.count()) * options_.latencyScale));
+    } else {
+        source = "missing";
+        response.statusCode = 404;
+        response.errorMessage = "No recorded response for " + method + " " + req.url;
+        MODAI_LOG_DEBUG(response.errorMessage);
+    }
+    if (options_.fixedLatency.count() >= 0) {
+        latency = options_.fixedLatency;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(randomMutex_);
+        double roll = std::uniform_real_distribution<double>(0.0, 1.0)(random_);
+        if (roll < options_.throttleRate) {
+            source = "throttled";
+            response = HttpResponse();
+            response.statusCode = 429;
+            response.errorMessage = "Too Many Requests (injected)";
+            response.headers["Retry-After"] = std::to_string(options_.retryAfterSeconds);
+        } else if (roll < options_.throttleRate + options_.errorRate) {
+            source = "error";
+            response = HttpResponse();
+            response.statusCode = 503;
+            response.errorMessage = "Service Unavailable (injected)";
+        }
+        if (options_.jitter.count() > 0) {
+            latency += std::chrono::milliseconds(std::uniform_int_distribution<int64_t>(
+                -options_.jitter.count(), options_.jitter.count())(random_));
+        }
+    }
+    Metrics::counter("modai_replay_requests_total", "result=\"" + std::string(source) + "\"").inc();
+    return {std::move(response), std::max(latency, std::chrono::milliseconds(0))};
+}
+
+HttpRequestHandle ReplayHttpClient::schedule(const HttpRequest& req, const std::string& method,
+                                             std::function<void(HttpResponse)> deliver) {
+    auto [response, latency] = respond(req, method);
+    // Like the shared transport, fall back to the caller's token
+    const CancellationToken& token = req.cancellation.cancellable() ? req.cancellation : CancellationToken::current();
+    return scheduler_->add(std::chrono::steady_clock::now() + latency, std::move(response), std::move(deliver), token);
+}
+
+HttpResponse ReplayHttpClient::post(const HttpRequest& req) {
+    return postAsync(req).get();
+}
+
+HttpResponse ReplayHttpClient::get(const std::string& url, const std::map<std::string, std::string>& headers) {
+    return getAsync(url, headers).get();
+}
+
+HttpRequestHandle ReplayHttpClient::postAsync(const HttpRequest& req, HttpCallback callback) {
+    return schedule(req, req.method.empty() ? "POST" : req.method, std::move(callback));
+}
+
+HttpRequestHandle ReplayHttpClient::getAsync(const std::string& url,
+                                             const std::map<std::string, std::string>& headers,
+                                             HttpCallback callback) {
+    HttpRequest req;
+    req.url = url;
+    req.method = "GET";
+    req.headers = headers;
+    return schedule(req, "GET", std::move(callback));
+}
+
+HttpRequestHandle ReplayHttpClient::downloadAsync(const std::string& url,
+                                                  const std::map<std::string, std::string>& headers,
+                                                  const std::string& filePath,
+                                                  uint64_t maxBytes,
+                                                  HttpCallback callback) {
+    HttpRequest req;
+    req.url = url;
+    req.method = "DOWNLOAD";  // as recorded, so a responder can tell
+    req.headers = headers;
+    return schedule(req, req.method, [filePath, maxBytes, callback = std::move(callback)](HttpResponse response) {
+        if (response.success && maxBytes > 0 && response.body.size() > maxBytes) {
+            response.success = false;
+            response.errorMessage = "Response exceeds " + std::to_string(maxBytes) + " bytes";
+        }
+        if (response.success) {
+            std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+            out.write(response.body.data(), static_cast<std::streamsize>(response.body.size()));
+            if (!out) {
+                response.success = false;
+                response.errorMessage = "Failed to write " + filePath;
+            }
+        }
+        response.body.clear();
+        callback(std::move(response));
+    });
+}
+
+HttpRequestHandle ReplayHttpClient::streamAsync(const HttpRequest& req,
+                                                HttpChunkCallback onChunk,
+                                                HttpCallback callback) {
+    return schedule(req, req.method.empty() ? "POST" : req.method,
+        [onChunk = std::move(onChunk), callback = std::move(callback)](HttpResponse response) {
+            if (!response.body.empty()) {
+                onChunk(response.body.data(), response.body.size());
+                response.body.clear();
+            }
+            callback(std::move(response));
+        });
+}
+
+} // namespace ModAI
@@ -0,0 +1,310 @@
+#include "network/ResponseParsers.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#ifdef USE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+namespace ModAI {
+
+namespace {
+
+std::optional<std::string> stringField(const nlohmann::json& object, const char* key) {
+    auto it = object.find(key);
+    if (it == object.end() || !it->is_string()) {
+        return std::nullopt;
+    }
+    return it->get<std::string>();
+}
+
+std::optional<RedditListing> listingFromDom(const std::string& body) {
+    auto json = nlohmann::json::parse(body);
+    if (!json.contains("data") || !json["data"].contains("children")) {
+        return std::nullopt;
+    }
+    const auto& data = json["data"];
+    RedditListing listing;
+    listing.after = stringField(data, "after").value_or("");
+    for (const auto& child : data["children"]) {
+        if (child.contains("data")) {
+            listing.children.push_back(RedditThing::fromJson(child["data"]));
+        }
+    }
+    return listing;
+}
+
+std::optional<std::vector<std::vector<HiveClass>>> hiveFromDom(const std::string& body) {
+    auto json = nlohmann::json::parse(body);
+    if (!json.contains("output") || !json["output"].is_array()) {
+        return std::nullopt;
+    }
+    std::vector<std::vector<HiveClass>> outputs;
+    for (const auto& output : json["output"]) {
+        std::vector<HiveClass>& classes = outputs.emplace_back();
+        if (!output.contains("classes") || !output["classes"].is_array()) {
+            continue;
+        }
+        for (const auto& cls : output["classes"]) {
+            auto name = stringField(cls, "class");
+            if (!name) {
+                name = stringField(cls, "class_name");
+            }
+            auto value = cls.find("value");
+            if (name && value != cls.end() && value->is_number()) {
+                classes.push_back({std::move(*name), value->get<double>()});
+            }
+        }
+    }
+    return outputs;
+}
+
+std::optional<std::string> chatFromDom(const std::string& data) {
+    try {
+        auto event = nlohmann::json::parse(data);
+        const auto& choice = event.at("choices").at(0);
+        const auto& part = choice.contains("delta") ? choice["delta"] : choice.at("message");
+        return stringField(part, "content").value_or("");
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+#ifdef USE_SIMDJSON
+
+namespace od = simdjson::ondemand;
+
+// Parsers keep their buffers between documents
+od::parser& threadParser() {
+    thread_local od::parser parser;
+    return parser;
+}
+
+// simdjson reads a little past the end; bodies rarely have the slack
+simdjson::padded_string_view padded(const std::string& text, simdjson::padded_string& copy) {
+    if (text.capacity() - text.size() >= simdjson::SIMDJSON_PADDING) {
+        return simdjson::padded_string_view(text.data(), text.size(), text.capacity());
+    }
+    copy = simdjson::padded_string(text);
+    return copy;
+}
+
+void readString(od::value value, std::string& out) {
+    if (value.type() == od::json_type::string) {
+        out = std::string_view(value.get_string());
+    }
+}
+
+void readString(od::value value, std::optional<std::string>& out) {
+    if (value.type() == od::json_type::string) {
+        out = std::string(std::string_view(value.get_string()));
+    }
+}
+
+RedditThing readThing(od::object data) {
+    RedditThing thing;
+    for (auto field : data) {
+        std::string_view key = field.unescaped_key();
+        od::value value = field.value();
+        if (key == "name") readString(value, thing.name);
+        else if (key == "id") readString(value, thing.id);
+        else if (key == "subreddit") readString(value, thing.subreddit);
+        else if (key == "url") readString(value, thing.url);
+        else if (key == "author") readString(value, thing.author);
+        else if (key == "title") readString(value, thing.title);
+        else if (key == "selftext") readString(value, thing.selftext);
+        else if (key == "body") readString(value, thing.body);
+        else if (key == "is_self" && value.type() == od::json_type::boolean) {
+            thing.isSelf = value.get_bool();
+        } else if (key == "created_utc" && value.type() == od::json_type::number) {
+            thing.createdUtc = double(value.get_double());
+        }
+    }
+    return thing;
+}
+
+std::optional<RedditListing> listingFromSimdjson(const std::string& body) {
+    simdjson::padded_string copy;
+    od::document doc = threadParser().iterate(padded(body, copy));
+    RedditListing listing;
+    bool hasChildren = false;
+    for (auto field : doc.get_object()) {
+        if (std::string_view(field.unescaped_key()) != "data") {
+            continue;
+        }
+        od::value data = field.value();
+        if (data.type() != od::json_type::object) {
+            continue;
+        }
+        for (auto dataField : data.get_object()) {
+            std::string_view key = dataField.unescaped_key();
+            od::value value = dataField.value();
+            if (key == "after") {
+                readString(value, listing.after);
+            } else if (key == "children" && value.type() == od::json_type::array) {
+                hasChildren = true;
+                for (od::value child : value.get_array()) {
+                    for (auto childField : child.get_object()) {
+                        if (std::string_view(childField.unescaped_key()) == "data") {
+                            listing.children.push_back(readThing(childField.value().get_object()));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (!hasChildren) {
+        return std::nullopt;
+    }
+    return listing;
+}
+
+std::optional<std::vector<std::vector<HiveClass>>> hiveFromSimdjson(const std::string& body) {
+    simdjson::padded_string copy;
+    od::document doc = threadParser().iterate(padded(body, copy));
+    std::optional<std::vector<std::vector<HiveClass>>> outputs;
+    for (auto field : doc.get_object()) {
+        if (std::string_view(field.unescaped_key()) != "output") {
+            continue;
+        }
+        od::value value = field.value();
+        if (value.type() != od::json_type::array) {
+            return std::nullopt;
+        }
+        outputs.emplace();
+        for (od::value output : value.get_array()) {
+            std::vector<HiveClass>& classes = outputs->emplace_back();
+            for (auto outputField : output.get_object()) {
+                if (std::string_view(outputField.unescaped_key()) != "classes") {
+                    continue;
+                }
+                od::value list = outputField.value();
+                if (list.type() != od::json_type::array) {
+                    continue;
+                }
+                for (od::value cls : list.get_array()) {
+                    std::optional<std::string> name;
+                    std::optional<std::string> legacyName;
+                    std::optional<double> score;
+                    for (auto clsField : cls.get_object()) {
+                        std::string_view key = clsField.unescaped_key();
+                        od::value clsValue = clsField.value();
+                        if (key == "class") readString(clsValue, name);
+                        else if (key == "class_name") readString(clsValue, legacyName);
+                        else if (key == "value" && clsValue.type() == od::json_type::number) {
+                            score = double(clsValue.get_double());
+                        }
+                    }
+                    if (!name) {
+                        name = std::move(legacyName);
+                    }
+                    if (name && score) {
+                        classes.push_back({std::move(*name), *score});
+                    }
+                }
+            }
+        }
+    }
+    return outputs;
+}
+
+std::optional<std::string> chatFromSimdjson(const std::string& data) {
+    simdjson::padded_string copy;
+    od::document doc = threadParser().iterate(padded(data, copy));
+    for (auto field : doc.get_object()) {
+        if (std::string_view(field.unescaped_key()) != "choices") {
+            continue;
+        }
+        for (od::value choice : field.value().get_array()) {
+            std::optional<std::string> delta;
+            std::optional<std::string> message;
+            bool hasDelta = false;
+            bool hasMessage = false;
+            for (auto part : choice.get_object()) {
+                std::string_view key = part.unescaped_key();
+                if (key != "delta" && key != "message") {
+                    continue;
+                }
+                const bool isDelta = key == "delta";
+                (isDelta ? hasDelta : hasMessage) = true;
+                od::value object = part.value();
+                if (object.type() != od::json_type::object) {
+                    continue;
+                }
+                for (auto content : object.get_object()) {
+                    if (std::string_view(content.unescaped_key()) == "content") {
+                        readString(content.value(), isDelta ? delta : message);
+                    }
+                }
+            }
+            if (!hasDelta && !hasMessage) {
+                return std::nullopt;
+            }
+            return (hasDelta ? delta : message).value_or("");
+        }
+        return std::nullopt;  // no choices
+    }
+    return std::nullopt;
+}
+
+void noteFallback(const char* format, const simdjson::simdjson_error& error) {
+    Metrics::counter("modai_json_fallback_total", "format=\"" + std::string(format) + "\"").inc();
+    MODAI_LOG_DEBUG(std::string("simdjson rejected a ") + format + " body (" + error.what() + "), using the DOM parser");
+}
+
+#endif
+
+} // namespace
+
+RedditThing RedditThing::fromJson(const nlohmann::json& data) {
+    RedditThing thing;
+    thing.name = stringField(data, "name").value_or("");
+    thing.id = stringField(data, "id").value_or("");
+    thing.subreddit = stringField(data, "subreddit").value_or("");
+    thing.url = stringField(data, "url").value_or("");
+    thing.author = stringField(data, "author");
+    thing.title = stringField(data, "title");
+    thing.selftext = stringField(data, "selftext");
+    thing.body = stringField(data, "body");
+    auto isSelf = data.find("is_self");
+    thing.isSelf = isSelf != data.end() && isSelf->is_boolean() && isSelf->get<bool>();
+    auto created = data.find("created_utc");
+    if (created != data.end() && created->is_number()) {
+        thing.createdUtc = created->get<double>();
+    }
+    return thing;
+}
+
+std::optional<RedditListing> parseRedditListing(const std::string& body) {
+#ifdef USE_SIMDJSON
+    try {
+        return listingFromSimdjson(body);
+    } catch (const simdjson::simdjson_error& e) {
+        noteFallback("reddit_listing", e);
+    }
+#endif
+    return listingFromDom(body);
+}
+
+std::optional<std::vector<std::vector<HiveClass>>> parseHiveOutputs(const std::string& body) {
+#ifdef USE_SIMDJSON
+    try {
+        return hiveFromSimdjson(body);
+    } catch (const simdjson::simdjson_error& e) {
+        noteFallback("hive_output", e);
+    }
+#endif
+    return hiveFromDom(body);
+}
+
+std::optional<std::string> parseChatDelta(const std::string& data) {
+#ifdef USE_SIMDJSON
+    try {
+        return chatFromSimdjson(data);
+    } catch (const simdjson::simdjson_error& e) {
+        noteFallback("chat_event", e);
+    }
+#endif
+    return chatFromDom(data);
+}
+
+} // namespace ModAI
@@ -0,0 +1,68 @@
+#include "network/SseDecoder.h"
+
+namespace ModAI {
+
+SseDecoder::SseDecoder(EventHandler onEvent)
+    : onEvent_(std::move(onEvent)) {
+}
+
+void SseDecoder::feed(const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        // Lines end in \n, \r or \r\n; a \n right after \r is the same break
+        if (c == '\n' && lastWasCr_) {
+            lastWasCr_ = false;
+            continue;
+        }
+        lastWasCr_ = c == '\r';
+        if (c == '\n' || c == '\r') {
+            onLine();
+            line_.clear();
+        } else {
+            line_.push_back(c);
+        }
+    }
+}
+
+void SseDecoder::finish() {
+    if (!line_.empty()) {
+        onLine();
+        line_.clear();
+    }
+    dispatch();
+}
+
+void SseDecoder::onLine() {
+    if (line_.empty()) {
+        dispatch();
+        return;
+    }
+    if (line_[0] == ':') {
+        return;  // comment / keep-alive
+    }
+    size_t colon = line_.find(':');
+    if (line_.compare(0, colon, "data") != 0) {
+        return;
+    }
+    size_t valueStart = colon == std::string::npos ? line_.size() : colon + 1;
+    if (valueStart < line_.size() && line_[valueStart] == ' ') {
+        ++valueStart;
+    }
+    if (hasData_) {
+        data_.push_back('\n');
+    }
+    data_.append(line_, valueStart, std::string::npos);
+    hasData_ = true;
+}
+
+void SseDecoder::dispatch() {
+    if (!hasData_) {
+        return;
+    }
+    std::string data;
+    data.swap(data_);
+    hasData_ = false;
+    onEvent_(data);
+}
+
+} // namespace ModAI
@@ -0,0 +1,173 @@
+#include "scraper/CommentStreamParser.h"
+#include "utils/Logger.h"
+#include <sstream>
+
+namespace ModAI {
+
+void ChunkStreamBuf::push(const char* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunks_.emplace_back(data, size);
+    }
+    cv_.notify_one();
+}
+
+void ChunkStreamBuf::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    cv_.notify_one();
+}
+
+ChunkStreamBuf::int_type ChunkStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return !chunks_.empty() || finished_; });
+    if (chunks_.empty()) {
+        return traits_type::eof();
+    }
+    current_ = std::move(chunks_.front());
+    chunks_.pop_front();
+    setg(&current_[0], &current_[0], &current_[0] + current_.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+CommentStreamParser::CommentStreamParser(CommentHandler onComment)
+    : onComment_(std::move(onComment)) {
+}
+
+bool CommentStreamParser::parse(std::istream& in) {
+    stack_.clear();
+    return nlohmann::json::sax_parse(in, this);
+}
+
+bool CommentStreamParser::parse(const std::string& body) {
+    stack_.clear();
+    return nlohmann::json::sax_parse(body, this);
+}
+
+void CommentStreamParser::push(bool isObject) {
+    Frame frame;
+    frame.isObject = isObject;
+    if (!stack_.empty() && stack_.back().isObject) {
+        frame.keyInParent = stack_.back().pendingKey;
+    }
+    if (isObject && frame.keyInParent == "data") {
+        frame.fields = nlohmann::json::object();
+    }
+    stack_.push_back(std::move(frame));
+}
+
+void CommentStreamParser::scalar(nlohmann::json value) {
+    if (stack_.empty()) {
+        return;
+    }
+    Frame& top = stack_.back();
+    if (top.isObject) {
+        if (top.pendingKey == "kind" && value.is_string()) {
+            top.kind = value.get<std::string>();
+        } else if (top.keyInParent == "data" && top.pendingKey != "body_html") {
+            top.fields[top.pendingKey] = std::move(value);
+        }
+        return;
+    }
+    // Ids listed under a "more" stub: data.children = ["abc", "def", ...]
+    if (top.keyInParent == "children" && value.is_string() && stack_.size() >= 2 &&
+        stack_[stack_.size() - 2].keyInParent == "data") {
+        stack_[stack_.size() - 2].fields["children"].push_back(std::move(value));
+    }
+}
+
+bool CommentStreamParser::null() {
+    scalar(nullptr);
+    return true;
+}
+
+bool CommentStreamParser::boolean(bool value) {
+    scalar(value);
+    return true;
+}
+
+bool CommentStreamParser::number_integer(int64_t value) {
+    scalar(value);
+    return true;
+}
+
+bool CommentStreamParser::number_unsigned(uint64_t value) {
+    scalar(value);
+    return true;
+}
+
+bool CommentStreamParser::number_float(double value, const std::string&) {
+    scalar(value);
+    return true;
+}
+
+bool CommentStreamParser::string(std::string& value) {
+    scalar(std::move(value));
+    return true;
+}
+
+bool CommentStreamParser::binary(std::vector<uint8_t>&) {
+    return true;
+}
+
+bool CommentStreamParser::start_object(size_t) {
+    push(true);
+    return true;
+}
+
+bool CommentStreamParser::key(std::string& key) {
+    stack_.back().pendingKey = std::move(key);
+    return true;
+}
+
+bool CommentStreamParser::end_object() {
+    Frame frame = std::move(stack_.back());
+    stack_.pop_back();
+    if (stack_.empty()) {
+        return true;
+    }
+    Frame& parent = stack_.back();
+    if (frame.keyInParent == "data" && parent.isObject) {
+        // Hand the payload up to its {"kind", "data"} wrapper
+        parent.fields = std::move(frame.fields);
+        parent.hasData = true;
+        return true;
+    }
+    if (!frame.hasData) {
+        return true;
+    }
+    if (frame.kind == "t1") {
+        ++commentCount_;
+        onComment_(frame.fields);
+    } else if (frame.kind == "more" && frame.fields.contains("children")) {
+        for (const auto& id : frame.fields["children"]) {
+            moreChildren_.push_back(id.get<std::string>());
+        }
+    }
+    return true;
+}
+
+bool CommentStreamParser::start_array(size_t) {
+    push(false);
+    return true;
+}
+
+bool CommentStreamParser::end_array() {
+    stack_.pop_back();
+    return true;
+}
+
+bool CommentStreamParser::parse_error(size_t position, const std::string&, const nlohmann::detail::exception& error) {
+    Logger::warn("Comment stream parse error at byte " + std::to_string(position) + ": " + error.what());
+    return false;
+}
+
+} // namespace ModAI
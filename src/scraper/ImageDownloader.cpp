@@ -0,0 +1,97 @@
+#include "scraper/ImageDownloader.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace ModAI {
+
+ImageDownloader::ImageDownloader(HttpClient& httpClient, ImageStore& store,
+                                 size_t maxParallel, uint64_t maxBytesPerFile)
+    : httpClient_(httpClient)
+    , store_(store)
+    , maxParallel_(maxParallel > 0 ? maxParallel : 1)
+    , maxBytesPerFile_(maxBytesPerFile) {
+}
+
+std::map<std::string, std::string> ImageDownloader::downloadAll(
+    const std::vector<std::string>& urls,
+    const std::map<std::string, std::string>& headers) {
+    std::map<std::string, std::string> stored;
+    std::deque<std::string> pending;
+    for (const auto& url : urls) {
+        if (stored.count(url) || std::find(pending.begin(), pending.end(), url) != pending.end()) {
+            continue;
+        }
+        std::string known = store_.lookupUrl(url);
+        if (!known.empty()) {
+            stored[url] = known;
+        } else {
+            pending.push_back(url);
+        }
+    }
+
+    struct Finished {
+        std::string url;
+        std::string tempPath;
+        HttpResponse response;
+    };
+    // Shared with the callbacks, which may outlive this call if a client
+    // completes late
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Finished> finished;
+    };
+    auto state = std::make_shared<State>();
+
+    size_t inFlight = 0;
+    while (!pending.empty() || inFlight > 0) {
+        while (!pending.empty() && inFlight < maxParallel_) {
+            std::string url = std::move(pending.front());
+            pending.pop_front();
+            std::string tempPath = store_.newTempPath();
+            ++inFlight;
+            try {
+                httpClient_.downloadAsync(url, headers, tempPath, maxBytesPerFile_,
+                    [state, url, tempPath](HttpResponse response) {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        state->finished.push_back({url, tempPath, std::move(response)});
+                        state->cv.notify_one();
+                    });
+            } catch (const std::exception& e) {
+                --inFlight;
+                Logger::error("Exception downloading image " + url + ": " + std::string(e.what()));
+            }
+        }
+
+        std::deque<Finished> batch;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [&state, inFlight]() { return inFlight == 0 || !state->finished.empty(); });
+            batch.swap(state->finished);
+        }
+        for (auto& done : batch) {
+            --inFlight;
+            if (!done.response.success || done.response.statusCode != 200) {
+                Logger::warn("Failed to download image from " + done.url + ": " +
+                             (done.response.errorMessage.empty()
+                                  ? "HTTP " + std::to_string(done.response.statusCode)
+                                  : done.response.errorMessage));
+                std::remove(done.tempPath.c_str());
+                continue;
+            }
+            std::string path = store_.adopt(done.tempPath);
+            if (!path.empty()) {
+                store_.rememberUrl(done.url, path);
+                stored[done.url] = path;
+            }
+        }
+    }
+    return stored;
+}
+
+} // namespace ModAI
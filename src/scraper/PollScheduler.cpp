@@ -0,0 +1,204 @@
+#include "scraper/PollScheduler.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <set>
+
+namespace ModAI {
+
+namespace {
+
+double unixNow() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+PollScheduler::PollScheduler(PollSchedulerOptions options)
+    : options_(options) {
+}
+
+void PollScheduler::setOptions(const PollSchedulerOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+}
+
+void PollScheduler::setSubreddits(const std::vector<std::string>& subreddits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::set<std::string> keep;
+    listings_.clear();
+    size_t perListing = std::max<size_t>(1, options_.subredditsPerListing);
+    auto now = Clock::now();
+
+    Listing listing;
+    std::string name;
+    auto flush = [&]() {
+        if (!listing.members.empty()) {
+            listing.nextPoll = now;
+            listing.interval = options_.initialInterval;
+            listings_[name] = std::move(listing);
+        }
+        listing = Listing();
+        name.clear();
+    };
+    for (const auto& subreddit : subreddits) {
+        if (subreddit.empty() || !keep.insert(subreddit).second) {
+            continue;
+        }
+        name += (listing.members.empty() ? "" : "+") + subreddit;
+        listing.members.push_back(subreddit);
+        if (listing.members.size() == perListing) {
+            flush();
+        }
+    }
+    flush();
+
+    for (auto it = subreddits_.begin(); it != subreddits_.end();) {
+        it = keep.count(it->first) ? std::next(it) : subreddits_.erase(it);
+    }
+}
+
+std::vector<std::string> PollScheduler::listings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto& [name, listing] : listings_) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+std::vector<std::string> PollScheduler::takeDue(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<Clock::time_point, std::string>> due;
+    for (auto& [name, listing] : listings_) {
+        if (!listing.inFlight && listing.nextPoll <= now) {
+            due.emplace_back(listing.nextPoll, name);
+        }
+    }
+    std::sort(due.begin(), due.end());
+
+    std::vector<std::string> names;
+    names.reserve(due.size());
+    for (auto& [when, name] : due) {
+        listings_[name].inFlight = true;
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+void PollScheduler::finished(const std::string& listing, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = listings_.find(listing);
+    if (it == listings_.end()) {
+        return;  // Regrouped while it was in flight
+    }
+    double nowUnix = unixNow();
+    for (const auto& member : it->second.members) {
+        auto& subreddit = subreddits_[member];
+        if (subreddit.observedSince == 0.0) {
+            subreddit.observedSince = nowUnix;
+        }
+    }
+
+    Clock::duration interval = options_.initialInterval;
+    if (options_.adaptive) {
+        auto stretched = std::chrono::duration_cast<Clock::duration>(
+            desiredIntervalLocked(it->second, nowUnix) * budgetStretchLocked(nowUnix));
+        interval = std::clamp<Clock::duration>(stretched, options_.minInterval, options_.maxInterval);
+    }
+    if (interval != it->second.interval) {
+        MODAI_LOG_DEBUG("Polling " + listing + " every " +
+                        std::to_string(std::chrono::duration_cast<std::chrono::seconds>(interval).count()) + "s");
+    }
+    it->second.interval = interval;
+    it->second.nextPoll = now + interval;
+    it->second.inFlight = false;
+}
+
+PollScheduler::Clock::time_point PollScheduler::nextDue() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto next = Clock::time_point::max();
+    for (const auto& [name, listing] : listings_) {
+        if (!listing.inFlight) {
+            next = std::min(next, listing.nextPoll);
+        }
+    }
+    return next;
+}
+
+void PollScheduler::recordPosts(const std::string& subreddit, const std::vector<double>& createdUtc) {
+    if (createdUtc.empty()) {
+        return;
+    }
+    std::vector<double> sorted = createdUtc;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& created = subreddits_[subreddit].created;
+    for (double time : sorted) {
+        if (created.empty() || time > created.back()) {
+            created.push_back(time);
+        }
+    }
+    while (created.size() > kRateSamples) {
+        created.pop_front();
+    }
+}
+
+double PollScheduler::arrivalRate(const std::string& subreddit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return arrivalRateLocked(subreddit, unixNow());
+}
+
+PollScheduler::Clock::duration PollScheduler::interval(const std::string& listing) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = listings_.find(listing);
+    return it == listings_.end() ? Clock::duration::zero() : it->second.interval;
+}
+
+double PollScheduler::arrivalRateLocked(const std::string& subreddit, double nowUnix) const {
+    auto it = subreddits_.find(subreddit);
+    if (it == subreddits_.end()) {
+        return 0.0;
+    }
+    const Subreddit& state = it->second;
+    // Posts seen over the span from the oldest of them to now, so a
+    // subreddit that has gone quiet decays towards zero
+    double since = state.created.empty() ? state.observedSince : state.created.front();
+    if (state.observedSince > 0.0) {
+        since = std::min(since, state.observedSince);
+    }
+    if (since <= 0.0) {
+        return 0.0;
+    }
+    double window = std::max(nowUnix - since, kMinRateWindowSeconds);
+    return static_cast<double>(state.created.size()) / window;
+}
+
+PollScheduler::Clock::duration PollScheduler::desiredIntervalLocked(const Listing& listing, double nowUnix) const {
+    double rate = 0.0;
+    for (const auto& member : listing.members) {
+        rate += arrivalRateLocked(member, nowUnix);
+    }
+    double expectedPerPoll = options_.targetFill * static_cast<double>(options_.pageSize);
+    if (rate <= 0.0) {
+        return options_.maxInterval;
+    }
+    double seconds = std::min(expectedPerPoll / rate, static_cast<double>(options_.maxInterval.count()));
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+double PollScheduler::budgetStretchLocked(double nowUnix) const {
+    double budget = options_.requestsPerSecond * options_.budgetShare;
+    if (budget <= 0.0) {
+        return 1.0;
+    }
+    double pollsPerSecond = 0.0;
+    for (const auto& [name, listing] : listings_) {
+        auto interval = std::clamp<Clock::duration>(desiredIntervalLocked(listing, nowUnix),
+                                                    options_.minInterval, options_.maxInterval);
+        pollsPerSecond += 1.0 / std::chrono::duration<double>(interval).count();
+    }
+    return std::max(1.0, pollsPerSecond / budget);
+}
+
+} // namespace ModAI
@@ -1,17 +1,23 @@
 #include "scraper/RedditScraper.h"
-#include "network/HttpClient.h"
+#include "scraper/CommentStreamParser.h"
+#include "scraper/ImageDownloader.h"
+#include "network/CachingHttpClient.h"
+#include "utils/Clock.h"
 #include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include "utils/Uuid.h"
 #include <nlohmann/json.hpp>
 #include <QUrlQuery>
 #include <QByteArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTimer>
-#include <QDir>
-#include <QFile>
-#include <QCryptographicHash>
 #include <chrono>
 #include <algorithm>
+#include <deque>
+#include <future>
+#include <istream>
+#include <optional>
 
 namespace ModAI {
 
@@ -22,24 +28,32 @@ RedditScraper::RedditScraper(std::unique_ptr<HttpClient> httpClient,
                              const std::string& storagePath,
                              QObject* parent)
     : QObject(parent)
-    , httpClient_(std::move(httpClient))
+    // Listings are revalidated, so polls of quiet subreddits come back as 304s
+    , httpClient_(std::make_unique<CachingHttpClient>(
+          std::move(httpClient), std::make_shared<HttpCache>(storagePath + "/cache/http")))
     , imageModerator_(nullptr)
     , clientId_(clientId)
     , clientSecret_(clientSecret)
     , userAgent_(userAgent)
     , storagePath_(storagePath)
     , tokenExpiresAt_(std::chrono::steady_clock::now())
-    , rateLimiter_(std::make_unique<RateLimiter>(60, std::chrono::seconds(60)))
+    , rateLimiter_(RateLimiter::shared("reddit:" + clientId, kRequestsPerMinute, std::chrono::seconds(60)))
+    , seenIds_(std::make_unique<SeenIdSet>(storagePath + "/cache/seen_reddit_ids.txt"))
+    , imageStore_(std::make_unique<ImageStore>(storagePath + "/images"))
     , isRunning_(false) {
     
-    // Ensure images directory exists
-    QDir dir(QString::fromStdString(storagePath_));
-    if (!dir.exists("images")) {
-        dir.mkdir("images");
-    }
-
     scrapeTimer_ = new QTimer(this);
+    scrapeTimer_->setSingleShot(true);
     connect(scrapeTimer_, &QTimer::timeout, this, &RedditScraper::performScrape);
+    
+    scrapePool_.setMaxThreadCount(kMaxConcurrentListings);
+    setPollingOptions(PollSchedulerOptions());
+}
+
+RedditScraper::~RedditScraper() {
+    stop();
+    // In-flight listing fetches reference this scraper
+    scrapePool_.waitForDone();
 }
 
 void RedditScraper::setImageModerator(std::unique_ptr<ImageModerator> imageModerator) {
@@ -47,16 +61,19 @@ void RedditScraper::setImageModerator(std::unique_ptr<ImageModerator> imageModer
     Logger::info("Image moderator set for Reddit scraper");
 }
 
-void RedditScraper::authenticate() {
+std::string RedditScraper::authenticate() {
+    // Scrape workers share the token
+    std::lock_guard<std::mutex> lock(authMutex_);
+
     // If no credentials, operate in public JSON mode (previous behavior)
     if (clientId_.empty() || clientSecret_.empty()) {
         accessToken_.clear();
-        return;
+        return accessToken_;
     }
 
     // Refresh OAuth token if missing or expired (simple client_credentials flow)
     if (!accessToken_.empty() && std::chrono::steady_clock::now() < tokenExpiresAt_) {
-        return;
+        return accessToken_;
     }
 
     HttpRequest req;
@@ -75,7 +92,7 @@ void RedditScraper::authenticate() {
         if (!response.success || response.statusCode != 200) {
             Logger::warn("Failed to obtain Reddit OAuth token: " + response.errorMessage);
             accessToken_.clear();
-            return;
+            return accessToken_;
         }
 
         auto json = nlohmann::json::parse(response.body);
@@ -87,55 +104,52 @@ void RedditScraper::authenticate() {
         Logger::error("Exception acquiring Reddit token: " + std::string(e.what()));
         accessToken_.clear();
     }
+    return accessToken_;
 }
 
-std::vector<ContentItem> RedditScraper::fetchPosts(const std::string& subreddit) {
-    std::vector<ContentItem> items;
-    
-    rateLimiter_->waitIfNeeded();
-    authenticate();
-    
-    const bool useOAuth = !accessToken_.empty();
+std::optional<RedditScraper::ListingPage> RedditScraper::fetchListing(const std::string& subreddit,
+                                                                     const std::string& query) {
+    if (!rateLimiter_->acquire(CancellationToken::current())) {
+        return std::nullopt;  // stopped while waiting for the budget
+    }
+    const std::string accessToken = authenticate();
+    const bool useOAuth = !accessToken.empty();
     std::string url = useOAuth
-        ? "https://oauth.reddit.com/r/" + subreddit + "/new.json?limit=25"
-        : "https://www.reddit.com/r/" + subreddit + "/new.json?limit=25";
+        ? "https://oauth.reddit.com/r/" + subreddit + "/new.json?limit=" + std::to_string(kListingLimit)
+        : "https://www.reddit.com/r/" + subreddit + "/new.json?limit=" + std::to_string(kListingLimit);
+    if (!query.empty()) {
+        url += "&" + query;
+    }
     
     HttpRequest req;
     req.url = url;
     req.method = "GET";
     req.headers["User-Agent"] = userAgent_;
     if (useOAuth) {
-        req.headers["Authorization"] = "Bearer " + accessToken_;
+        req.headers["Authorization"] = "Bearer " + accessToken;
     }
     
     try {
-        Logger::info("Fetching from URL: " + url);
+        MODAI_LOG_DEBUG("Fetching from URL: " + url);
         HttpResponse response = httpClient_->get(url, req.headers);
+        rateLimiter_->updateFromHeaders(response.headers, response.statusCode);
         
-        Logger::info("Response status: " + std::to_string(response.statusCode) + ", success: " + (response.success ? "true" : "false"));
+        MODAI_LOG_DEBUG("Response status: " + std::to_string(response.statusCode) + ", success: " + (response.success ? "true" : "false"));
         
+        if (response.notModified) {
+            // The same page as last time for this query, already processed
+            return ListingPage();
+        }
         if (response.success && response.statusCode == 200) {
-            // Log first 500 chars of response for debugging
-            std::string preview = response.body.substr(0, std::min(size_t(500), response.body.size()));
-            Logger::info("Response preview: " + preview);
-            
-            auto json = nlohmann::json::parse(response.body);
-            
-            if (json.contains("data") && json["data"].contains("children")) {
-                auto& children = json["data"]["children"];
-                Logger::info("Found " + std::to_string(children.size()) + " children in response");
-                
-                for (const auto& child : children) {
-                    if (child.contains("data")) {
-                        ContentItem item = parsePost(child["data"]);
-                        items.push_back(item);
-                    }
-                }
-                Logger::info("Fetched " + std::to_string(items.size()) + " posts from r/" + subreddit);
-            } else {
-                Logger::warn("No data/children in Reddit response for r/" + subreddit);
-                Logger::warn("Response body: " + response.body.substr(0, 1000));
+            // Only the fields parsePost() reads are extracted
+            if (auto listing = parseRedditListing(response.body)) {
+                ListingPage page;
+                page.after = std::move(listing->after);
+                page.posts = std::move(listing->children);
+                return page;
             }
+            Logger::warn("No data/children in Reddit response for r/" + subreddit);
+            Logger::warn("Response body: " + response.body.substr(0, 1000));
         } else {
             Logger::warn("Failed to fetch posts from " + subreddit + ": HTTP " + std::to_string(response.statusCode) + " - " + response.errorMessage);
             if (!response.body.empty()) {
@@ -146,43 +160,143 @@ std::vector<ContentItem> RedditScraper::fetchPosts(const std::string& subreddit)
         Logger::error("Exception fetching posts: " + std::string(e.what()));
     }
     
+    return std::nullopt;
+}
+
+std::vector<RedditThing> RedditScraper::fetchNewPosts(const std::string& subreddit) {
+    ListingCursor cursor;
+    {
+        std::lock_guard<std::mutex> lock(cursorMutex_);
+        cursor = cursors_[subreddit];
+    }
+    auto saveCursor = [&]() {
+        std::lock_guard<std::mutex> lock(cursorMutex_);
+        cursors_[subreddit] = cursor;
+    };
+    std::vector<RedditThing> posts;
+    bool walkBacklog = false;
+    
+    if (!cursor.before.empty()) {
+        // Cheap path: only what's newer than the newest post already seen
+        auto page = fetchListing(subreddit, "before=" + cursor.before);
+        if (!page) {
+            return {};
+        }
+        if (page->posts.empty()) {
+            // A deleted cursor post makes "before" return nothing forever
+            if (++cursor.emptyPolls >= kMaxEmptyPolls) {
+                MODAI_LOG_DEBUG("Resetting listing cursor for r/" + subreddit);
+                cursor.before.clear();
+                cursor.emptyPolls = 0;
+            }
+            saveCursor();
+            return {};
+        }
+        cursor.emptyPolls = 0;
+        if (page->posts.size() < kListingLimit) {
+            posts = std::move(page->posts);
+        } else {
+            walkBacklog = true;  // More than a page arrived since the last poll
+        }
+    }
+    
+    if (posts.empty()) {
+        // Newest first, paging back with "after" until we reach seen posts
+        std::string after;
+        int maxPages = walkBacklog ? kMaxBacklogPages : 1;
+        for (int pageNo = 0; pageNo < maxPages; ++pageNo) {
+            auto page = fetchListing(subreddit, after.empty() ? "" : "after=" + after);
+            if (!page) {
+                break;
+            }
+            bool reachedSeen = false;
+            for (auto& post : page->posts) {
+                if (post.name == cursor.before || seenIds_->contains(post.name)) {
+                    reachedSeen = true;
+                    break;
+                }
+                posts.push_back(std::move(post));
+            }
+            if (reachedSeen || page->after.empty() || page->posts.size() < kListingLimit) {
+                break;
+            }
+            after = page->after;
+        }
+    }
+    
+    if (!posts.empty() && !posts.front().name.empty()) {
+        cursor.before = posts.front().name;
+    }
+    saveCursor();
+    
+    // Seen or not, every post's age tells the scheduler how busy its
+    // subreddit is
+    std::map<std::string, std::vector<double>> created;
+    for (const auto& post : posts) {
+        if (post.createdUtc) {
+            created[post.subreddit.empty() ? subreddit : post.subreddit].push_back(*post.createdUtc);
+        }
+    }
+    for (const auto& [name, times] : created) {
+        scheduler_.recordPosts(name, times);
+    }
+    
+    // Drop anything already processed before it costs a download or a moderation call
+    std::vector<RedditThing> fresh;
+    for (auto& post : posts) {
+        if (seenIds_->insert(post.name)) {
+            fresh.push_back(std::move(post));
+        }
+    }
+    return fresh;
+}
+
+std::vector<ContentItem> RedditScraper::fetchPosts(const std::string& subreddit) {
+    TraceSpan span("fetch_posts");
+    std::vector<ContentItem> items;
+    for (const auto& post : fetchNewPosts(subreddit)) {
+        items.push_back(parsePost(post));
+    }
+    downloadImages(items);
+    Logger::info("Fetched " + std::to_string(items.size()) + " new posts from r/" + subreddit);
     return items;
 }
 
-ContentItem RedditScraper::parsePost(const nlohmann::json& postJson) {
-    ContentItem item;
-    item.subreddit = postJson.value("subreddit", "");
+ContentItem RedditScraper::parsePost(const RedditThing& post) {
+    ContentItem item{ContentItem::Blank()};
+    item.timestamp = currentTimestamp();
+    item.subreddit = post.subreddit;
     item.source = "reddit";
     
     // Extract Reddit post ID (e.g., "1po4bx2" from "t3_1po4bx2")
-    if (postJson.contains("name")) {
-        std::string fullId = postJson["name"].get<std::string>();
+    if (!post.name.empty()) {
         // Remove "t3_" prefix if present
-        if (fullId.find("t3_") == 0) {
-            item.post_id = fullId.substr(3);
+        if (post.name.find("t3_") == 0) {
+            item.post_id = post.name.substr(3);
         } else {
-            item.post_id = fullId;
+            item.post_id = post.name;
         }
     }
     
     // Also store it as the item ID
-    if (postJson.contains("id")) {
-        item.id = postJson["id"].get<std::string>();
+    item.id = post.id;
+    if (item.id.empty()) {
+        item.id = newUuidV7();
     }
     
-    if (postJson.contains("author")) {
-        item.author = postJson["author"].get<std::string>();
+    if (post.author) {
+        item.author = *post.author;
     }
     
     // Determine content type
-    if (postJson.contains("is_self") && postJson["is_self"].get<bool>()) {
+    if (post.isSelf) {
         item.content_type = "text";
-        if (postJson.contains("selftext")) {
-            item.text = postJson["selftext"].get<std::string>();
+        if (post.selftext) {
+            item.text = *post.selftext;
         }
     } else {
         // Check if it's an image
-        std::string url = postJson.value("url", "");
+        const std::string& url = post.url;
         if (url.find(".jpg") != std::string::npos || 
             url.find(".png") != std::string::npos ||
             url.find(".jpeg") != std::string::npos ||
@@ -193,16 +307,13 @@ ContentItem RedditScraper::parsePost(const nlohmann::json& postJson) {
             
             // Store title and selftext as text for text moderation
             std::string combinedText;
-            if (postJson.contains("title")) {
-                std::string title = postJson["title"].get<std::string>();
-                if (!title.empty()) {
-                    combinedText = title;
-                }
+            if (post.title && !post.title->empty()) {
+                combinedText = *post.title;
             }
             
             // Also include selftext body if present
-            if (postJson.contains("selftext")) {
-                std::string selftext = postJson["selftext"].get<std::string>();
+            if (post.selftext) {
+                const std::string& selftext = *post.selftext;
                 if (!selftext.empty() && selftext != "[deleted]" && selftext != "[removed]") {
                     if (!combinedText.empty()) {
                         combinedText += "\n\n" + selftext;
@@ -214,22 +325,15 @@ ContentItem RedditScraper::parsePost(const nlohmann::json& postJson) {
             
             if (!combinedText.empty()) {
                 item.text = combinedText;
-                Logger::info("Image post has text: " + combinedText.substr(0, 50));
+                MODAI_LOG_DEBUG("Image post has text: " + combinedText.substr(0, 50));
             }
             
-            // Download image
-            std::string localPath = downloadImage(url);
-            if (!localPath.empty()) {
-                item.image_path = localPath;
-                // Image moderation will be handled by ModerationEngine after queuing
-            } else {
-                item.image_path = url;
-                Logger::warn("Failed to download image from " + url + ", cannot moderate");
-            }
+            // Replaced with the local copy by downloadImages()
+            item.image_path = url;
         } else {
             item.content_type = "text";
-            if (postJson.contains("title")) {
-                item.text = postJson["title"].get<std::string>();
+            if (post.title) {
+                item.text = *post.title;
             }
         }
     }
@@ -239,11 +343,25 @@ ContentItem RedditScraper::parsePost(const nlohmann::json& postJson) {
 
 std::vector<ContentItem> RedditScraper::fetchPostComments(const std::string& subreddit, const std::string& postId) {
     std::vector<ContentItem> items;
+    streamPostComments(subreddit, postId, [&items](const ContentItem& item) { items.push_back(item); });
+    return items;
+}
+
+size_t RedditScraper::streamPostComments(const std::string& subreddit, const std::string& postId,
+                                         const std::function<void(const ContentItem&)>& onComment) {
+    size_t count = 0;
+    auto emit = [this, &onComment, &count](const nlohmann::json& data) {
+        try {
+            onComment(parseComment(RedditThing::fromJson(data)));
+            ++count;
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping malformed comment: " + std::string(e.what()));
+        }
+    };
     
     rateLimiter_->waitIfNeeded();
-    authenticate();
-    
-    const bool useOAuth = !accessToken_.empty();
+    const std::string accessToken = authenticate();
+    const bool useOAuth = !accessToken.empty();
     std::string url = useOAuth
         ? "https://oauth.reddit.com/r/" + subreddit + "/comments/" + postId + ".json"
         : "https://www.reddit.com/r/" + subreddit + "/comments/" + postId + ".json";
@@ -253,25 +371,36 @@ std::vector<ContentItem> RedditScraper::fetchPostComments(const std::string& sub
     req.method = "GET";
     req.headers["User-Agent"] = userAgent_;
     if (useOAuth) {
-        req.headers["Authorization"] = "Bearer " + accessToken_;
+        req.headers["Authorization"] = "Bearer " + accessToken;
     }
     
+    std::vector<std::string> moreIds;
     try {
-        Logger::info("Fetching comments from URL: " + url);
-        HttpResponse response = httpClient_->get(url, req.headers);
+        MODAI_LOG_DEBUG("Streaming comments from URL: " + url);
+        
+        // The body is parsed on this thread while it is still arriving
+        auto buffer = std::make_shared<ChunkStreamBuf>();
+        auto done = std::make_shared<std::promise<HttpResponse>>();
+        auto finished = done->get_future();
+        HttpRequestHandle handle = httpClient_->streamAsync(req,
+            [buffer](const char* data, size_t size) { buffer->push(data, size); },
+            [buffer, done](HttpResponse response) {
+                buffer->finish();
+                done->set_value(std::move(response));
+            });
+        
+        CommentStreamParser parser(emit);
+        std::istream in(buffer.get());
+        if (!parser.parse(in)) {
+            handle.cancel();
+        }
+        HttpResponse response = finished.get();
+        rateLimiter_->updateFromHeaders(response.headers, response.statusCode);
         
         if (response.success && response.statusCode == 200) {
-            auto json = nlohmann::json::parse(response.body);
-            
-            // Reddit returns an array with 2 elements: [0]=post, [1]=comments
-            if (json.is_array() && json.size() >= 2) {
-                auto& commentsListing = json[1];
-                
-                if (commentsListing.contains("data") && commentsListing["data"].contains("children")) {
-                    parseCommentsRecursive(commentsListing["data"]["children"], items);
-                    Logger::info("Fetched " + std::to_string(items.size()) + " comments for post " + postId);
-                }
-            }
+            moreIds = parser.moreChildren();
+            Logger::info("Fetched " + std::to_string(count) + " comments for post " + postId +
+                         (moreIds.empty() ? "" : ", expanding " + std::to_string(moreIds.size()) + " more"));
         } else {
             Logger::warn("Failed to fetch comments for post " + postId + ": HTTP " + std::to_string(response.statusCode));
         }
@@ -279,74 +408,104 @@ std::vector<ContentItem> RedditScraper::fetchPostComments(const std::string& sub
         Logger::error("Exception fetching post comments: " + std::string(e.what()));
     }
     
-    return items;
+    if (!moreIds.empty()) {
+        expandMoreChildren(postId, std::move(moreIds), emit);
+        Logger::info("Fetched " + std::to_string(count) + " comments in total for post " + postId);
+    }
+    return count;
 }
 
-void RedditScraper::parseCommentsRecursive(const nlohmann::json& children, std::vector<ContentItem>& items) {
-    for (const auto& child : children) {
-        if (child.contains("data")) {
-            auto& data = child["data"];
-            
-            // Skip "more" comments markers
-            if (child.value("kind", "") == "more") {
-                continue;
+void RedditScraper::expandMoreChildren(const std::string& postId, std::vector<std::string> ids,
+                                       const std::function<void(const nlohmann::json&)>& emit) {
+    std::deque<std::string> pending;
+    for (auto& id : ids) {
+        // "_" marks a "continue this thread" link, not an expandable id
+        if (!id.empty() && id != "_") {
+            pending.push_back(std::move(id));
+        }
+    }
+    
+    int requests = 0;
+    while (!pending.empty() && requests < kMaxMoreChildrenRequests) {
+        std::string children;
+        for (size_t i = 0; i < kMoreChildrenPerRequest && !pending.empty(); ++i) {
+            if (!children.empty()) {
+                children += ",";
             }
-            
-            ContentItem item = parseComment(data);
-            items.push_back(item);
-            
-            // Recursively parse replies
-            if (data.contains("replies") && data["replies"].is_object()) {
-                if (data["replies"].contains("data") && data["replies"]["data"].contains("children")) {
-                    parseCommentsRecursive(data["replies"]["data"]["children"], items);
+            children += pending.front();
+            pending.pop_front();
+        }
+        ++requests;
+        
+        rateLimiter_->waitIfNeeded();
+        const std::string accessToken = authenticate();
+        const bool useOAuth = !accessToken.empty();
+        std::string url = std::string(useOAuth ? "https://oauth.reddit.com" : "https://www.reddit.com") +
+                          "/api/morechildren.json?api_type=json&limit_children=false&link_id=t3_" + postId +
+                          "&children=" + children;
+        
+        std::map<std::string, std::string> headers{{"User-Agent", userAgent_}};
+        if (useOAuth) {
+            headers["Authorization"] = "Bearer " + accessToken;
+        }
+        
+        try {
+            HttpResponse response = httpClient_->get(url, headers);
+            rateLimiter_->updateFromHeaders(response.headers, response.statusCode);
+            if (!response.success || response.statusCode != 200) {
+                Logger::warn("Failed to expand comments for post " + postId + ": HTTP " +
+                             std::to_string(response.statusCode));
+                break;
+            }
+            // Expanded batches can contain further "more" stubs
+            CommentStreamParser parser(emit);
+            parser.parse(response.body);
+            for (const auto& id : parser.moreChildren()) {
+                if (id != "_") {
+                    pending.push_back(id);
                 }
             }
+        } catch (const std::exception& e) {
+            Logger::error("Exception expanding comments: " + std::string(e.what()));
+            break;
         }
     }
+    
+    if (!pending.empty()) {
+        Logger::warn("Stopped expanding post " + postId + " with " + std::to_string(pending.size()) +
+                     " comments unfetched");
+    }
 }
 
-std::string RedditScraper::downloadImage(const std::string& url) {
-    // Generate filename from hash of URL
-    QByteArray hash = QCryptographicHash::hash(QByteArray::fromStdString(url), QCryptographicHash::Md5);
-    std::string filename = hash.toHex().toStdString();
-    
-    // Determine extension
-    std::string ext = ".jpg";
-    if (url.find(".png") != std::string::npos) ext = ".png";
-    else if (url.find(".jpeg") != std::string::npos) ext = ".jpg";
-    
-    std::string relativePath = "images/" + filename + ext;
-    std::string fullPath = storagePath_ + "/" + relativePath;
-    
-    // Check if already exists
-    if (QFile::exists(QString::fromStdString(fullPath))) {
-        return fullPath;
+void RedditScraper::downloadImages(std::vector<ContentItem>& items) {
+    std::vector<std::string> urls;
+    for (const auto& item : items) {
+        if (item.content_type == "image" && item.image_path.has_value()) {
+            urls.push_back(*item.image_path);
+        }
+    }
+    if (urls.empty()) {
+        return;
     }
     
-    // Download
-    HttpRequest req;
-    req.url = url;
-    req.method = "GET";
+    std::map<std::string, std::string> headers{{"User-Agent", userAgent_}};
+    ImageDownloader downloader(*httpClient_, *imageStore_, kMaxParallelDownloads, kMaxImageBytes);
+    auto stored = downloader.downloadAll(urls, headers);
     
-    try {
-        HttpResponse response = httpClient_->get(url, req.headers);
-        if (response.success && response.statusCode == 200) {
-            QFile file(QString::fromStdString(fullPath));
-            if (file.open(QIODevice::WriteOnly)) {
-                file.write(response.body.data(), response.body.size());
-                file.close();
-                return fullPath;
-            } else {
-                Logger::error("Failed to save image to " + fullPath);
-            }
+    for (auto& item : items) {
+        if (item.content_type != "image" || !item.image_path.has_value()) {
+            continue;
+        }
+        auto it = stored.find(*item.image_path);
+        if (it != stored.end()) {
+            // Image moderation will be handled by ModerationEngine after queuing;
+            // the store keeps the file until the item is done with it
+            item.image_path = it->second;
+            imageStore_->retain(it->second);
         } else {
-            Logger::warn("Failed to download image from " + url);
+            Logger::warn("Failed to download image from " + *item.image_path + ", cannot moderate");
         }
-    } catch (const std::exception& e) {
-        Logger::error("Exception downloading image: " + std::string(e.what()));
     }
-    
-    return ""; // Return empty if failed
 }
 
 void RedditScraper::moderateImage(ContentItem& item) {
@@ -361,31 +520,16 @@ void RedditScraper::moderateImage(ContentItem& item) {
     }
     
     try {
-        // Read image file into bytes
-        QFile imageFile(QString::fromStdString(*item.image_path));
-        if (!imageFile.open(QIODevice::ReadOnly)) {
-            Logger::error("Failed to open image file: " + *item.image_path);
+        // Downscaled and re-encoded for upload
+        PreparedImage prepared = imagePreprocessor_.prepare(*item.image_path);
+        if (!prepared.ok) {
             return;
         }
         
-        QByteArray imageData = imageFile.readAll();
-        imageFile.close();
-        
-        // Convert to vector<uint8_t>
-        std::vector<uint8_t> imageBytes(imageData.begin(), imageData.end());
-        
-        // Determine MIME type from file extension
-        std::string mimeType = "image/jpeg";
-        if (item.image_path->find(".png") != std::string::npos) {
-            mimeType = "image/png";
-        } else if (item.image_path->find(".webp") != std::string::npos) {
-            mimeType = "image/webp";
-        }
-        
-        Logger::info("Moderating image: " + *item.image_path + " (size: " + std::to_string(imageBytes.size()) + " bytes)");
+        MODAI_LOG_DEBUG("Moderating image: " + *item.image_path + " (upload size: " + std::to_string(prepared.bytes.size()) + " bytes)");
         
         // Analyze image
-        auto result = imageModerator_->analyzeImage(imageBytes, mimeType);
+        auto result = imageModerator_->analyzeImage(prepared.bytes);
         
         // Store moderation results
         item.moderation.provider = "hive_visual";
@@ -441,14 +585,14 @@ void RedditScraper::moderateImage(ContentItem& item) {
         if (maxScore >= BLOCK_THRESHOLD) {
             item.decision.auto_action = "block";
             item.decision.threshold_triggered = true;
-            Logger::info("Image blocked: " + item.id + " (score: " + std::to_string(maxScore) + ")");
+            MODAI_LOG_INFO("Image blocked: " + item.id + " (score: " + std::to_string(maxScore) + ")");
         } else if (maxScore >= REVIEW_THRESHOLD) {
             item.decision.auto_action = "review";
             item.decision.threshold_triggered = true;
-            Logger::info("Image flagged for review: " + item.id + " (score: " + std::to_string(maxScore) + ")");
+            MODAI_LOG_INFO("Image flagged for review: " + item.id + " (score: " + std::to_string(maxScore) + ")");
         } else {
             item.decision.auto_action = "allow";
-            Logger::info("Image allowed: " + item.id + " (score: " + std::to_string(maxScore) + ")");
+            MODAI_LOG_INFO("Image allowed: " + item.id + " (score: " + std::to_string(maxScore) + ")");
         }
         
     } catch (const std::exception& e) {
@@ -458,6 +602,16 @@ void RedditScraper::moderateImage(ContentItem& item) {
 
 void RedditScraper::setSubreddits(const std::vector<std::string>& subreddits) {
     subreddits_ = subreddits;
+    // Coalesced into /r/a+b+c listings, each polled on its own schedule
+    scheduler_.setSubreddits(subreddits_);
+}
+
+void RedditScraper::setPollingOptions(const PollSchedulerOptions& options) {
+    PollSchedulerOptions adjusted = options;
+    adjusted.pageSize = kListingLimit;
+    adjusted.requestsPerSecond = kRequestsPerMinute / 60.0;
+    adjusted.subredditsPerListing = kSubredditsPerListing;
+    scheduler_.setOptions(adjusted);
 }
 
 void RedditScraper::start(int intervalSeconds) {
@@ -465,15 +619,20 @@ void RedditScraper::start(int intervalSeconds) {
         return;
     }
     
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        runSource_ = CancellationSource();
+    }
     isRunning_ = true;
     authenticate();
     
-    // Perform initial scrape
+    PollSchedulerOptions options = scheduler_.options();
+    options.initialInterval = std::chrono::seconds(std::max(1, intervalSeconds));
+    scheduler_.setOptions(options);
+    // Every listing is due right away
+    scheduler_.setSubreddits(subreddits_);
     performScrape();
     
-    // Set up timer for periodic scraping
-    scrapeTimer_->start(intervalSeconds * 1000);
-    
     Logger::info("Reddit scraper started");
 }
 
@@ -484,6 +643,10 @@ void RedditScraper::stop() {
     
     isRunning_ = false;
     scrapeTimer_->stop();
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        runSource_.cancel();
+    }
     
     Logger::info("Reddit scraper stopped");
 }
@@ -497,26 +660,72 @@ void RedditScraper::performScrape() {
         return;
     }
     
-    Logger::info("Performing scrape of " + std::to_string(subreddits_.size()) + " subreddits");
+    auto due = scheduler_.takeDue(PollScheduler::Clock::now());
+    if (!due.empty()) {
+        MODAI_LOG_DEBUG("Polling " + std::to_string(due.size()) + " of " +
+                        std::to_string(scheduler_.listings().size()) + " combined listings");
+    }
     
-    for (const auto& subreddit : subreddits_) {
-        auto posts = fetchPosts(subreddit);
-        Logger::info("Got " + std::to_string(posts.size()) + " posts to process");
-        for (const auto& item : posts) {
-            if (onItemScraped_) {
-                onItemScraped_(item);
-            }
+    // Listings are fetched concurrently; the shared rate limiter keeps the
+    // total within budget
+    CancellationToken token;
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        token = runSource_.token();
+    }
+    for (const auto& group : due) {
+        scrapePool_.start([this, group, token]() {
+            CancellationScope scope(token);
+            auto started = std::chrono::steady_clock::now();
+            scrapeGroup(group);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - started);
+            MODAI_LOG_DEBUG("Scraped " + group + " in " + std::to_string(elapsed.count()) + "ms");
+            scheduler_.finished(group, PollScheduler::Clock::now());
+            QMetaObject::invokeMethod(this, &RedditScraper::scheduleNextScrape, Qt::QueuedConnection);
+        });
+    }
+    scheduleNextScrape();
+}
+
+void RedditScraper::scheduleNextScrape() {
+    if (!isRunning_) {
+        return;
+    }
+    auto next = scheduler_.nextDue();
+    if (next == PollScheduler::Clock::time_point::max()) {
+        return;  // All in flight; the first to finish re-arms the timer
+    }
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - PollScheduler::Clock::now());
+    scrapeTimer_->start(static_cast<int>(std::max<int64_t>(0, wait.count())));
+}
+
+void RedditScraper::scrapeGroup(const std::string& listing) {
+    if (!isRunning_) {
+        return;
+    }
+    auto posts = fetchPosts(listing);
+    
+    // A combined listing mixes subreddits; each post carries its own
+    std::map<std::string, size_t> perSubreddit;
+    for (const auto& item : posts) {
+        ++perSubreddit[item.subreddit];
+        if (isRunning_ && onItemScraped_) {
+            onItemScraped_(item);
         }
     }
+    for (const auto& [subreddit, count] : perSubreddit) {
+        Logger::info("Got " + std::to_string(count) + " new posts from r/" + subreddit);
+    }
 }
 
 std::vector<ContentItem> RedditScraper::fetchComments(const std::string& subreddit) {
+    TraceSpan span("fetch_comments");
     std::vector<ContentItem> items;
     
     rateLimiter_->waitIfNeeded();
-    authenticate();
-    
-    const bool useOAuth = !accessToken_.empty();
+    const std::string accessToken = authenticate();
+    const bool useOAuth = !accessToken.empty();
     std::string url = useOAuth
         ? "https://oauth.reddit.com/r/" + subreddit + "/comments.json?limit=25"
         : "https://www.reddit.com/r/" + subreddit + "/comments.json?limit=25";
@@ -526,21 +735,20 @@ std::vector<ContentItem> RedditScraper::fetchComments(const std::string& subredd
     req.method = "GET";
     req.headers["User-Agent"] = userAgent_;
     if (useOAuth) {
-        req.headers["Authorization"] = "Bearer " + accessToken_;
+        req.headers["Authorization"] = "Bearer " + accessToken;
     }
     
     try {
         HttpResponse response = httpClient_->get(url, req.headers);
+        rateLimiter_->updateFromHeaders(response.headers, response.statusCode);
         
+        if (response.notModified) {
+            return items;  // nothing since the last poll
+        }
         if (response.success && response.statusCode == 200) {
-            auto json = nlohmann::json::parse(response.body);
-            
-            if (json.contains("data") && json["data"].contains("children")) {
-                for (const auto& child : json["data"]["children"]) {
-                    if (child.contains("data")) {
-                        ContentItem item = parseComment(child["data"]);
-                        items.push_back(item);
-                    }
+            if (auto listing = parseRedditListing(response.body)) {
+                for (const auto& comment : listing->children) {
+                    items.push_back(parseComment(comment));
                 }
             }
         } else {
@@ -553,25 +761,29 @@ std::vector<ContentItem> RedditScraper::fetchComments(const std::string& subredd
     return items;
 }
 
-ContentItem RedditScraper::parseComment(const nlohmann::json& commentJson) {
-    ContentItem item;
-    item.subreddit = commentJson.value("subreddit", "");
+ContentItem RedditScraper::parseComment(const RedditThing& comment) {
+    ContentItem item{ContentItem::Blank()};
+    item.subreddit = comment.subreddit;
     item.source = "reddit_comment";
-    item.id = commentJson.value("name", ""); // t1_...
+    item.id = comment.name; // t1_...
+    if (item.id.empty()) {
+        item.id = newUuidV7();
+    }
     
-    if (commentJson.contains("author")) {
-        item.author = commentJson["author"].get<std::string>();
+    if (comment.author) {
+        item.author = *comment.author;
     }
     
     item.content_type = "text";
-    if (commentJson.contains("body")) {
-        item.text = commentJson["body"].get<std::string>();
+    if (comment.body) {
+        item.text = *comment.body;
     }
     
-    // Timestamp
-    if (commentJson.contains("created_utc")) {
-        double utc = commentJson["created_utc"].get<double>();
-        item.timestamp = std::to_string(utc);
+    // Same ISO-8601 form as everything else, so comments sort with posts
+    if (comment.createdUtc) {
+        item.timestamp = formatTimestamp(static_cast<int64_t>(*comment.createdUtc * 1000.0));
+    } else {
+        item.timestamp = currentTimestamp();
     }
     
     return item;
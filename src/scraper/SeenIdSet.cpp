@@ -0,0 +1,100 @@
+#include "scraper/SeenIdSet.h"
+#include "utils/Logger.h"
+#include <filesystem>
+
+namespace ModAI {
+
+SeenIdSet::SeenIdSet(const std::string& filePath, size_t capacity)
+    : filePath_(filePath)
+    , capacity_(capacity > 0 ? capacity : 1) {
+    load();
+}
+
+void SeenIdSet::load() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    if (std::filesystem::path(filePath_).has_parent_path()) {
+        std::filesystem::create_directories(std::filesystem::path(filePath_).parent_path(), ec);
+    }
+
+    std::ifstream in(filePath_);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            touchLocked(line);
+            ++logLines_;
+        }
+    }
+    in.close();
+
+    if (logLines_ > 2 * capacity_) {
+        rewriteLocked();
+    } else {
+        log_.open(filePath_, std::ios::app);
+    }
+    if (!index_.empty()) {
+        Logger::info("Loaded " + std::to_string(index_.size()) + " seen Reddit ids");
+    }
+}
+
+void SeenIdSet::touchLocked(const std::string& id) {
+    auto it = index_.find(id);
+    if (it != index_.end()) {
+        order_.splice(order_.begin(), order_, it->second);
+        return;
+    }
+    order_.push_front(id);
+    index_.emplace(id, order_.begin());
+    if (index_.size() > capacity_) {
+        index_.erase(order_.back());
+        order_.pop_back();
+    }
+}
+
+void SeenIdSet::rewriteLocked() {
+    log_.close();
+    std::string tmpPath = filePath_ + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        // Oldest first, so replaying the log rebuilds the same recency order
+        for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+            out << *it << '\n';
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, filePath_, ec);
+    if (ec) {
+        Logger::warn("Failed to compact seen-id log: " + ec.message());
+    }
+    logLines_ = index_.size();
+    log_.open(filePath_, std::ios::app);
+}
+
+bool SeenIdSet::insert(const std::string& id) {
+    if (id.empty()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool fresh = index_.find(id) == index_.end();
+    touchLocked(id);
+    if (fresh) {
+        log_ << id << '\n';
+        log_.flush();
+        if (++logLines_ > 2 * capacity_) {
+            rewriteLocked();
+        }
+    }
+    return fresh;
+}
+
+bool SeenIdSet::contains(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.find(id) != index_.end();
+}
+
+size_t SeenIdSet::size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+} // namespace ModAI
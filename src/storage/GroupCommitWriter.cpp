@@ -0,0 +1,212 @@
+#include "storage/GroupCommitWriter.h"
+#include "utils/Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ModAI {
+
+namespace {
+
+int syncDescriptor(std::FILE* file) {
+#ifdef _WIN32
+    return _commit(_fileno(file));
+#else
+    return fsync(fileno(file));
+#endif
+}
+
+} // namespace
+
+GroupCommitWriter::GroupCommitWriter(const std::string& filePath, GroupCommitOptions options)
+    : filePath_(filePath)
+    , options_(options)
+    , lastSync_(std::chrono::steady_clock::now()) {
+    if (options_.maxBatchRecords == 0) {
+        options_.maxBatchRecords = 1;
+    }
+    file_ = std::fopen(filePath_.c_str(), "ab");
+    if (!file_) {
+        throw std::runtime_error("Failed to open file for writing: " + filePath_ + " (" + std::strerror(errno) + ")");
+    }
+    thread_ = std::thread(&GroupCommitWriter::run, this);
+}
+
+GroupCommitWriter::~GroupCommitWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (file_) {
+        std::string error;
+        if (unsyncedRecords_ > 0 && (options_.syncEveryRecords > 0 || options_.syncInterval.count() > 0)) {
+            sync(error);
+        }
+        std::fclose(file_);
+    }
+}
+
+void GroupCommitWriter::enqueue(Record record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(record));
+    }
+    cv_.notify_one();
+}
+
+void GroupCommitWriter::append(std::string line) {
+    Record record;
+    record.line = std::move(line);
+    enqueue(std::move(record));
+}
+
+void GroupCommitWriter::appendBytes(std::string bytes) {
+    Record record;
+    record.line = std::move(bytes);
+    record.newline = false;
+    enqueue(std::move(record));
+}
+
+std::future<void> GroupCommitWriter::appendDurable(std::string line) {
+    Record record;
+    record.line = std::move(line);
+    record.done = std::make_shared<std::promise<void>>();
+    auto future = record.done->get_future();
+    enqueue(std::move(record));
+    return future;
+}
+
+std::future<void> GroupCommitWriter::appendBytesDurable(std::string bytes) {
+    Record record;
+    record.line = std::move(bytes);
+    record.newline = false;
+    record.done = std::make_shared<std::promise<void>>();
+    auto future = record.done->get_future();
+    enqueue(std::move(record));
+    return future;
+}
+
+void GroupCommitWriter::flush() {
+    wait(true);
+}
+
+void GroupCommitWriter::drain() {
+    wait(false);
+}
+
+void GroupCommitWriter::wait(bool sync) {
+    Record record;
+    record.barrier = true;
+    record.sync = sync;
+    record.done = std::make_shared<std::promise<void>>();
+    auto future = record.done->get_future();
+    enqueue(std::move(record));
+    try {
+        future.get();
+    } catch (const std::exception& e) {
+        Logger::error("Flush of " + filePath_ + " failed: " + e.what());
+    }
+}
+
+void GroupCommitWriter::run() {
+    const bool timedSync = options_.syncInterval.count() > 0;
+    std::vector<Record> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [this]() { return !queue_.empty() || stopping_; };
+            if (timedSync && unsyncedRecords_ > 0) {
+                // Idle with unsynced data: wake up when the interval is due
+                cv_.wait_until(lock, lastSync_ + options_.syncInterval, ready);
+            } else {
+                cv_.wait(lock, ready);
+            }
+            if (queue_.empty() && stopping_) {
+                break;
+            }
+            // Linger briefly so records from concurrent workers share a write
+            if (!queue_.empty() && !stopping_ && queue_.size() < options_.maxBatchRecords &&
+                options_.maxBatchDelay.count() > 0) {
+                cv_.wait_for(lock, options_.maxBatchDelay, [this]() {
+                    return queue_.size() >= options_.maxBatchRecords || stopping_;
+                });
+            }
+            batch.swap(queue_);
+        }
+
+        std::string error;
+        bool ok = writeBatch(batch, error);
+
+        bool needSync = options_.syncEveryRecords > 0 && unsyncedRecords_ >= options_.syncEveryRecords;
+        if (timedSync && unsyncedRecords_ > 0 &&
+            std::chrono::steady_clock::now() - lastSync_ >= options_.syncInterval) {
+            needSync = true;
+        }
+        for (const auto& record : batch) {
+            needSync = needSync || (record.done && record.sync);
+        }
+        if (ok && needSync && unsyncedRecords_ > 0) {
+            ok = sync(error);
+        }
+
+        for (auto& record : batch) {
+            if (!record.done) {
+                continue;
+            }
+            if (ok) {
+                record.done->set_value();
+            } else {
+                record.done->set_exception(std::make_exception_ptr(std::runtime_error(error)));
+            }
+        }
+        batch.clear();
+    }
+}
+
+bool GroupCommitWriter::writeBatch(std::vector<Record>& batch, std::string& error) {
+    std::string buffer;
+    size_t records = 0;
+    for (const auto& record : batch) {
+        if (!record.barrier) {
+            buffer += record.line;
+            if (record.newline) {
+                buffer += '\n';
+            }
+            ++records;
+        }
+    }
+    if (records == 0) {
+        return true;
+    }
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file_) != buffer.size() || std::fflush(file_) != 0) {
+        error = "Failed to write " + filePath_ + ": " + std::strerror(errno);
+        Logger::error(error);
+        std::clearerr(file_);
+        return false;
+    }
+    unsyncedRecords_ += records;
+    return true;
+}
+
+bool GroupCommitWriter::sync(std::string& error) {
+    lastSync_ = std::chrono::steady_clock::now();
+    if (syncDescriptor(file_) != 0) {
+        error = "Failed to sync " + filePath_ + ": " + std::strerror(errno);
+        Logger::error(error);
+        return false;
+    }
+    unsyncedRecords_ = 0;
+    return true;
+}
+
+} // namespace ModAI
@@ -0,0 +1,388 @@
+#include "storage/ImageStore.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
+#include <QPainter>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace ModAI {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Last use is only written back to the file this often
+constexpr int64_t kTouchGranularitySeconds = 3600;
+constexpr int64_t kAgeSweepIntervalSeconds = 3600;
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t modifiedAt(const fs::path& path) {
+    std::error_code ec;
+    auto written = fs::last_write_time(path, ec);
+    if (ec) {
+        return unixNow();
+    }
+    auto system = std::chrono::system_clock::now() + (written - fs::file_time_type::clock::now());
+    return std::chrono::duration_cast<std::chrono::seconds>(system.time_since_epoch()).count();
+}
+
+bool isImageFile(const fs::path& path) {
+    const std::string extension = path.extension().string();
+    return extension == ".jpg" || extension == ".png" || extension == ".gif" || extension == ".webp";
+}
+
+uint64_t fileBytes(const fs::path& path) {
+    std::error_code ec;
+    uint64_t bytes = fs::file_size(path, ec);
+    return ec ? 0 : bytes;
+}
+
+} // namespace
+
+ImageStore::ImageStore(const std::string& rootDir, ImageStoreOptions options)
+    : rootDir_(rootDir)
+    , incomingDir_(rootDir + "/.incoming")
+    , urlLogPath_(rootDir + "/urls.log")
+    , options_(options) {
+    std::error_code ec;
+    fs::create_directories(incomingDir_, ec);
+    fs::create_directories(rootDir_ + "/thumbs", ec);
+    if (ec) {
+        Logger::error("Failed to create image store at " + rootDir_ + ": " + ec.message());
+    }
+    // Leftovers from a crash mid-download
+    for (const auto& entry : fs::directory_iterator(incomingDir_, ec)) {
+        fs::remove(entry.path(), ec);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    scanLocked();
+    loadUrlLogLocked();
+    evictLocked();
+    Logger::info("Image store: " + std::to_string(entries_.size()) + " images, " +
+                 std::to_string(totalBytes_ / (1024 * 1024)) + " MB, " +
+                 std::to_string(urlIndex_.size()) + " known URLs");
+}
+
+void ImageStore::setOptions(const ImageStoreOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    nextAgeSweep_ = 0;
+    evictLocked();
+}
+
+void ImageStore::scanLocked() {
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(rootDir_, ec)) {
+        if (!file.is_regular_file(ec) || !isImageFile(file.path())) {
+            continue;
+        }
+        const std::string path = file.path().string();
+        Entry entry;
+        entry.bytes = fileBytes(file.path()) + fileBytes(thumbnailPathFor(path));
+        entry.lastUsed = modifiedAt(file.path());
+        totalBytes_ += entry.bytes;
+        entries_.emplace(path, entry);
+    }
+    // Thumbnails whose image went away with a crash mid-eviction
+    for (const auto& thumb : fs::directory_iterator(rootDir_ + "/thumbs", ec)) {
+        bool orphan = true;
+        for (const char* extension : {".jpg", ".png", ".gif", ".webp"}) {
+            if (entries_.count(rootDir_ + "/" + thumb.path().stem().string() + extension)) {
+                orphan = false;
+                break;
+            }
+        }
+        if (orphan) {
+            fs::remove(thumb.path(), ec);
+        }
+    }
+}
+
+void ImageStore::loadUrlLogLocked() {
+    std::ifstream in(urlLogPath_);
+    std::string line;
+    while (std::getline(in, line)) {
+        ++urlLogLines_;
+        size_t tab = line.rfind('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        std::string path = rootDir_ + "/" + line.substr(tab + 1);
+        if (entries_.count(path)) {
+            urlIndex_[line.substr(0, tab)] = std::move(path);
+        }
+    }
+    // Mostly lines for evicted images or superseded URLs
+    if (urlLogLines_ > 1000 && urlLogLines_ > 2 * urlIndex_.size()) {
+        rewriteUrlLogLocked();
+    }
+}
+
+void ImageStore::rewriteUrlLogLocked() {
+    const std::string tempPath = urlLogPath_ + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        for (const auto& [url, path] : urlIndex_) {
+            out << url << '\t' << fs::path(path).filename().string() << '\n';
+        }
+        if (!out) {
+            Logger::warn("Failed to rewrite image URL log " + tempPath);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, urlLogPath_, ec);
+    if (ec) {
+        Logger::warn("Failed to replace image URL log: " + ec.message());
+        return;
+    }
+    urlLogLines_ = urlIndex_.size();
+}
+
+std::string ImageStore::newTempPath() {
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    return incomingDir_ + "/" + std::to_string(stamp) + "-" + std::to_string(tempCounter_++) + ".tmp";
+}
+
+const char* ImageStore::extensionFor(const std::string& header) {
+    auto startsWith = [&header](const char* magic, size_t length, size_t offset = 0) {
+        return header.size() >= offset + length && header.compare(offset, length, magic, length) == 0;
+    };
+    if (startsWith("\xFF\xD8\xFF", 3)) return ".jpg";
+    if (startsWith("\x89PNG\r\n\x1A\n", 8)) return ".png";
+    if (startsWith("GIF8", 4)) return ".gif";
+    if (startsWith("RIFF", 4) && startsWith("WEBP", 4, 8)) return ".webp";
+    return nullptr;
+}
+
+std::string ImageStore::adopt(const std::string& tempPath) {
+    QFile file(QString::fromStdString(tempPath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        Logger::error("Failed to open downloaded image " + tempPath);
+        QFile::remove(QString::fromStdString(tempPath));
+        return "";
+    }
+
+    const char* extension = extensionFor(file.peek(16).toStdString());
+    if (!extension) {
+        // Error pages and HTML previews served with a 200
+        file.close();
+        QFile::remove(QString::fromStdString(tempPath));
+        Logger::warn("Downloaded file is not a supported image, discarding");
+        return "";
+    }
+
+    QCryptographicHash hasher(QCryptographicHash::Sha256);
+    if (!hasher.addData(&file)) {
+        file.close();
+        QFile::remove(QString::fromStdString(tempPath));
+        Logger::error("Failed to hash downloaded image " + tempPath);
+        return "";
+    }
+    file.close();
+
+    std::string finalPath = rootDir_ + "/" + hasher.result().toHex().toStdString() + extension;
+    QString target = QString::fromStdString(finalPath);
+    int thumbnailSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thumbnailSize = options_.thumbnailSize;
+        auto known = entries_.find(finalPath);
+        if (known != entries_.end()) {
+            touchLocked(finalPath, known->second);
+            QFile::remove(QString::fromStdString(tempPath));
+            return finalPath;
+        }
+    }
+    // rename() refuses to overwrite, so a concurrent adopt of the same
+    // content just loses the race and drops its copy
+    if (!QFile::rename(QString::fromStdString(tempPath), target)) {
+        QFile::remove(QString::fromStdString(tempPath));
+        if (!QFile::exists(target)) {
+            Logger::error("Failed to move downloaded image to " + finalPath);
+            return "";
+        }
+        return finalPath;
+    }
+
+    // Decoded once here, so views never decode the full image for a preview
+    uint64_t bytes = fileBytes(finalPath) + writeThumbnail(finalPath, thumbnailSize);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[finalPath];
+    totalBytes_ -= entry.bytes;
+    totalBytes_ += bytes;
+    entry.bytes = bytes;
+    entry.lastUsed = unixNow();
+    evictLocked();
+    return finalPath;
+}
+
+uint64_t ImageStore::writeThumbnail(const std::string& imagePath, int thumbnailSize) {
+    QImageReader reader(QString::fromStdString(imagePath));
+    reader.setAutoTransform(true);
+    QSize size = reader.size();
+    const int side = std::max(16, thumbnailSize);
+    // JPEG and PNG decoders can scale while decoding
+    if (size.isValid() && (size.width() > side || size.height() > side)) {
+        reader.setScaledSize(size.scaled(side, side, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) {
+        Logger::warn("No thumbnail for " + imagePath + ": " + reader.errorString().toStdString());
+        return 0;
+    }
+    if (image.width() > side || image.height() > side) {
+        image = image.scaled(side, side, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (image.hasAlphaChannel()) {
+        QImage opaque(image.size(), QImage::Format_RGB32);
+        opaque.fill(Qt::white);
+        QPainter painter(&opaque);
+        painter.drawImage(0, 0, image);
+        painter.end();
+        image = std::move(opaque);
+    }
+    const std::string thumbPath = thumbnailPathFor(imagePath);
+    if (!image.save(QString::fromStdString(thumbPath), "JPG", 80)) {
+        Logger::warn("Failed to write thumbnail " + thumbPath);
+        return 0;
+    }
+    return fileBytes(thumbPath);
+}
+
+std::string ImageStore::thumbnailPathFor(const std::string& imagePath) {
+    fs::path path(imagePath);
+    return (path.parent_path() / "thumbs" / path.stem()).string() + ".jpg";
+}
+
+std::string ImageStore::lookupUrl(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = urlIndex_.find(url);
+    if (it == urlIndex_.end()) {
+        return "";
+    }
+    auto entry = entries_.find(it->second);
+    if (entry == entries_.end()) {
+        urlIndex_.erase(it);  // evicted; its log line goes at the next rewrite
+        return "";
+    }
+    touchLocked(entry->first, entry->second);
+    return it->second;
+}
+
+void ImageStore::rememberUrl(const std::string& url, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (urlIndex_.size() >= kMaxUrlIndexEntries) {
+        urlIndex_.clear();
+        rewriteUrlLogLocked();
+    }
+    urlIndex_[url] = path;
+    // URLs come from Reddit JSON, where tabs and newlines are escaped
+    std::ofstream out(urlLogPath_, std::ios::app);
+    out << url << '\t' << fs::path(path).filename().string() << '\n';
+    ++urlLogLines_;
+}
+
+void ImageStore::retain(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+        ++it->second.refs;
+        it->second.pinnedAt = unixNow();
+    }
+}
+
+void ImageStore::release(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end() && it->second.refs > 0) {
+        --it->second.refs;
+    }
+}
+
+uint64_t ImageStore::totalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalBytes_;
+}
+
+void ImageStore::touchLocked(const std::string& path, Entry& entry) {
+    int64_t now = unixNow();
+    if (now - entry.lastUsed < kTouchGranularitySeconds) {
+        return;
+    }
+    entry.lastUsed = now;
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+}
+
+void ImageStore::evictLocked() {
+    const int64_t now = unixNow();
+    const bool overSize = options_.maxBytes > 0 && totalBytes_ > options_.maxBytes;
+    const bool sweepAge = options_.maxAge.count() > 0 && now >= nextAgeSweep_;
+    if (!overSize && !sweepAge) {
+        return;
+    }
+
+    const int64_t maxPinAge = std::chrono::duration_cast<std::chrono::seconds>(kMaxPinAge).count();
+    const int64_t oldest = now - std::chrono::duration_cast<std::chrono::seconds>(options_.maxAge).count();
+    std::vector<std::pair<int64_t, const std::string*>> candidates;
+    for (const auto& [path, entry] : entries_) {
+        if (entry.refs == 0 || now - entry.pinnedAt > maxPinAge) {
+            candidates.emplace_back(entry.lastUsed, &path);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    const uint64_t target = static_cast<uint64_t>(static_cast<double>(options_.maxBytes) * kEvictionTarget);
+    size_t evicted = 0;
+    uint64_t freed = 0;
+    for (const auto& [lastUsed, path] : candidates) {
+        bool expired = sweepAge && lastUsed < oldest;
+        bool needSpace = overSize && totalBytes_ > target;
+        if (!expired && !needSpace) {
+            break;
+        }
+        uint64_t bytes = entries_[*path].bytes;
+        removeLocked(std::string(*path));
+        freed += bytes;
+        ++evicted;
+    }
+    if (sweepAge) {
+        nextAgeSweep_ = now + kAgeSweepIntervalSeconds;
+    }
+    if (evicted > 0) {
+        static Counter& evictions = Metrics::counter("modai_image_store_evictions_total");
+        evictions.inc(evicted);
+        Logger::info("Image store evicted " + std::to_string(evicted) + " images (" +
+                     std::to_string(freed / (1024 * 1024)) + " MB)");
+    }
+    if (overSize && totalBytes_ > options_.maxBytes) {
+        MODAI_LOG_DEBUG("Image store over budget; the rest is retained by queued items");
+    }
+    Metrics::gauge("modai_image_store_bytes").set(static_cast<int64_t>(totalBytes_));
+}
+
+void ImageStore::removeLocked(const std::string& path) {
+    auto it = entries_.find(path);
+    if (it == entries_.end()) {
+        return;
+    }
+    std::error_code ec;
+    fs::remove(path, ec);
+    fs::remove(thumbnailPathFor(path), ec);
+    totalBytes_ -= std::min(totalBytes_, it->second.bytes);
+    entries_.erase(it);
+}
+
+} // namespace ModAI
@@ -2,53 +2,100 @@
 #include "core/ContentItem.h"
 #include "utils/Logger.h"
 #include "storage/Storage.h"
+#include "utils/JsonFieldReader.h"
+#include "utils/JsonWriter.h"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
-#include <nlohmann/json.hpp>
 
 namespace fs = std::filesystem;
 
 namespace ModAI {
 
 std::string HumanAction::toJson() const {
-    nlohmann::json j;
-    j["action_id"] = action_id;
-    j["content_id"] = content_id;
-    j["timestamp"] = timestamp;
-    j["reviewer"] = reviewer;
-    j["previous_status"] = previous_status;
-    j["new_status"] = new_status;
-    j["reason"] = reason;
-    if (notes.has_value()) {
-        j["notes"] = notes.value();
-    } else {
-        j["notes"] = nullptr;
-    }
-    j["schema_version"] = schema_version;
-    return j.dump();
+    // Keys in the order json::dump() wrote them
+    std::string out;
+    out.reserve(256);
+    JsonWriter w(out);
+    w.beginObject();
+    w.key("action_id");
+    w.string(action_id);
+    w.key("content_id");
+    w.string(content_id);
+    w.key("new_status");
+    w.string(new_status);
+    w.key("notes");
+    w.optionalString(notes);
+    w.key("previous_status");
+    w.string(previous_status);
+    w.key("reason");
+    w.string(reason);
+    w.key("reviewer");
+    w.string(reviewer);
+    w.key("schema_version");
+    w.number(static_cast<int64_t>(schema_version));
+    w.key("timestamp");
+    w.string(timestamp);
+    w.endObject();
+    return out;
 }
 
+namespace {
+
+class HumanActionReader : public JsonFieldReader {
+public:
+    explicit HumanActionReader(HumanAction& action)
+        : action_(action) {
+    }
+
+protected:
+    int onObject(int, const std::string&) override { return kSkip; }
+
+    void onField(int, const std::string& key, const JsonScalar& value) override {
+        if (value.isNumber()) {
+            if (key == "schema_version") {
+                action_.schema_version = static_cast<int>(value.number);
+            }
+            return;
+        }
+        if (key == "notes") {
+            if (value.isString()) {
+                action_.notes = std::move(*value.text);
+            } else if (value.isNull()) {
+                action_.notes.reset();
+            }
+            return;
+        }
+        if (!value.isString()) {
+            return;
+        }
+        std::string* field = nullptr;
+        if (key == "action_id") field = &action_.action_id;
+        else if (key == "content_id") field = &action_.content_id;
+        else if (key == "timestamp") field = &action_.timestamp;
+        else if (key == "reviewer") field = &action_.reviewer;
+        else if (key == "previous_status") field = &action_.previous_status;
+        else if (key == "new_status") field = &action_.new_status;
+        else if (key == "reason") field = &action_.reason;
+        if (field) {
+            *field = std::move(*value.text);
+        }
+    }
+
+private:
+    HumanAction& action_;
+};
+
+} // namespace
+
 HumanAction HumanAction::fromJson(const std::string& jsonStr) {
     HumanAction action;
-    nlohmann::json j = nlohmann::json::parse(jsonStr);
-    
-    action.action_id = j.value("action_id", "");
-    action.content_id = j.value("content_id", "");
-    action.timestamp = j.value("timestamp", "");
-    action.reviewer = j.value("reviewer", "");
-    action.previous_status = j.value("previous_status", "");
-    action.new_status = j.value("new_status", "");
-    action.reason = j.value("reason", "");
-    if (j.contains("notes") && !j["notes"].is_null()) {
-        action.notes = j["notes"].get<std::string>();
-    }
-    action.schema_version = j.value("schema_version", 1);
-    
+    HumanActionReader reader(action);
+    reader.parse(jsonStr);
     return action;
 }
 
-JsonlStorage::JsonlStorage(const std::string& basePath) 
+JsonlStorage::JsonlStorage(const std::string& basePath, GroupCommitOptions options) 
     : basePath_(basePath) {
     contentFile_ = basePath + "/content.jsonl";
     actionFile_ = basePath + "/actions.jsonl";
@@ -58,6 +105,9 @@ JsonlStorage::JsonlStorage(const std::string& basePath)
     ensureDirectoryExists(basePath + "/logs");
     ensureDirectoryExists(basePath + "/exports/reports");
     ensureDirectoryExists(basePath + "/exports/csv");
+    
+    contentWriter_ = std::make_unique<GroupCommitWriter>(contentFile_, options);
+    actionWriter_ = std::make_unique<GroupCommitWriter>(actionFile_, options);
 }
 
 void JsonlStorage::ensureDirectoryExists(const std::string& path) {
@@ -70,19 +120,6 @@ void JsonlStorage::ensureDirectoryExists(const std::string& path) {
     }
 }
 
-void JsonlStorage::appendLine(const std::string& filepath, const std::string& line) {
-    std::lock_guard<std::mutex> lock(writeMutex_);
-    
-    std::ofstream file(filepath, std::ios::app);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for writing: " + filepath);
-    }
-    
-    file << line << "\n";
-    file.flush();
-    file.close();
-}
-
 std::vector<std::string> JsonlStorage::readLines(const std::string& filepath) {
     std::vector<std::string> lines;
     
@@ -108,8 +145,7 @@ std::vector<std::string> JsonlStorage::readLines(const std::string& filepath) {
 
 void JsonlStorage::saveContent(const ContentItem& item) {
     try {
-        std::string json = item.toJson();
-        appendLine(contentFile_, json);
+        contentWriter_->append(item.toJson());
     } catch (const std::exception& e) {
         Logger::error("Failed to save content item: " + std::string(e.what()));
         throw;
@@ -118,16 +154,29 @@ void JsonlStorage::saveContent(const ContentItem& item) {
 
 void JsonlStorage::saveAction(const HumanAction& action) {
     try {
-        std::string json = action.toJson();
-        appendLine(actionFile_, json);
+        actionWriter_->append(action.toJson());
     } catch (const std::exception& e) {
         Logger::error("Failed to save action: " + std::string(e.what()));
         throw;
     }
 }
 
+std::future<void> JsonlStorage::saveContentDurable(const ContentItem& item) {
+    return contentWriter_->appendDurable(item.toJson());
+}
+
+std::future<void> JsonlStorage::saveActionDurable(const HumanAction& action) {
+    return actionWriter_->appendDurable(action.toJson());
+}
+
+void JsonlStorage::flush() {
+    contentWriter_->flush();
+    actionWriter_->flush();
+}
+
 std::vector<ContentItem> JsonlStorage::loadAllContent() {
     std::vector<ContentItem> items;
+    contentWriter_->drain();  // read our own queued writes
     auto lines = readLines(contentFile_);
     
     for (const auto& line : lines) {
@@ -143,6 +192,7 @@ std::vector<ContentItem> JsonlStorage::loadAllContent() {
 
 std::vector<HumanAction> JsonlStorage::loadAllActions() {
     std::vector<HumanAction> actions;
+    actionWriter_->drain();
     auto lines = readLines(actionFile_);
     
     for (const auto& line : lines) {
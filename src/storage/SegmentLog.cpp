@@ -0,0 +1,509 @@
+#include "storage/SegmentLog.h"
+#include "utils/Logger.h"
+#include "utils/SharedBytes.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+namespace ModAI {
+
+namespace {
+
+constexpr size_t kRecordHeaderBytes = 8;
+
+uint32_t fnv1a32(std::string_view data) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t idHash(const std::string& id) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : id) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint32_t getU32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// Payload at offset, or an empty view if the record runs past limit
+std::string_view payloadAt(const SharedBytes& bytes, uint64_t offset, uint64_t limit) {
+    if (offset + kRecordHeaderBytes > limit) {
+        return {};
+    }
+    uint32_t length = getU32(bytes.data() + offset);
+    if (offset + kRecordHeaderBytes + length > limit) {
+        return {};
+    }
+    return std::string_view(bytes.chars() + offset + kRecordHeaderBytes, length);
+}
+
+} // namespace
+
+SegmentLog::SegmentLog(const std::string& directory, const std::string& prefix,
+                       KeyExtractor extractor, SegmentLogOptions options)
+    : directory_(directory)
+    , prefix_(prefix)
+    , extractor_(std::move(extractor))
+    , options_(options) {
+    if (options_.sparseInterval == 0) {
+        options_.sparseInterval = 1;
+    }
+    open();
+}
+
+SegmentLog::~SegmentLog() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writer_.reset();  // drains queued records
+}
+
+std::string SegmentLog::segmentPath(uint32_t number) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%06u.seg", number);
+    return directory_ + "/" + prefix_ + name;
+}
+
+std::string SegmentLog::indexPath(const Segment& segment) const {
+    return segment.path.substr(0, segment.path.size() - 4) + ".idx";
+}
+
+void SegmentLog::open() {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+
+    std::vector<uint32_t> numbers;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() == prefix_.size() + 11 && name.compare(0, prefix_.size() + 1, prefix_ + "-") == 0 &&
+            name.compare(name.size() - 4, 4, ".seg") == 0) {
+            try {
+                numbers.push_back(static_cast<uint32_t>(std::stoul(name.substr(prefix_.size() + 1, 6))));
+            } catch (const std::exception&) {
+                // Not one of ours
+            }
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        Segment segment;
+        segment.number = numbers[i];
+        segment.path = segmentPath(numbers[i]);
+        bool active = i + 1 == numbers.size();
+        if (active) {
+            rebuild(segment, true);
+        } else {
+            if (!loadIndex(segment)) {
+                rebuild(segment, false);
+                std::sort(segment.ids.begin(), segment.ids.end());
+                saveIndex(segment);
+            }
+            segment.sealed = true;
+        }
+        segments_.push_back(std::move(segment));
+    }
+
+    if (segments_.empty()) {
+        startSegment(1);
+    }
+    writer_ = std::make_unique<GroupCommitWriter>(segments_.back().path, options_.writer);
+
+    uint64_t records = 0;
+    for (const auto& segment : segments_) {
+        records += segment.records;
+    }
+    Logger::info("Opened " + prefix_ + " log: " + std::to_string(segments_.size()) + " segments, " +
+                 std::to_string(records) + " records");
+}
+
+void SegmentLog::noteRecord(Segment& segment, uint64_t offset, uint64_t recordBytes,
+                            const SegmentRecordKeys& keys, size_t sparseInterval) {
+    if (segment.records % sparseInterval == 0) {
+        segment.sparse.emplace_back(offset, segment.maxTimestamp);
+    }
+    if (!keys.timestamp.empty()) {
+        if (segment.minTimestamp.empty() || keys.timestamp < segment.minTimestamp) {
+            segment.minTimestamp = keys.timestamp;
+        }
+        if (keys.timestamp > segment.maxTimestamp) {
+            segment.maxTimestamp = keys.timestamp;
+        }
+    }
+    if (!keys.id.empty()) {
+        segment.ids.emplace_back(idHash(keys.id), offset);
+    }
+    if (!keys.group.empty()) {
+        ++segment.groups[keys.group];
+    }
+    ++segment.records;
+    segment.size = offset + recordBytes;
+}
+
+void SegmentLog::rebuild(Segment& segment, bool truncateTornTail) {
+    SharedBytes bytes = SharedBytes::mapFile(segment.path);
+    uint64_t fileSize = bytes.size();
+    uint64_t offset = 0;
+    while (offset + kRecordHeaderBytes <= fileSize) {
+        std::string_view payload = payloadAt(bytes, offset, fileSize);
+        if (payload.data() == nullptr || fnv1a32(payload) != getU32(bytes.data() + offset + 4)) {
+            break;
+        }
+        SegmentRecordKeys keys;
+        try {
+            keys = extractor_(payload);
+        } catch (const std::exception& e) {
+            Logger::warn("Unindexable record in " + segment.path + ": " + e.what());
+        }
+        noteRecord(segment, offset, kRecordHeaderBytes + payload.size(), keys, options_.sparseInterval);
+        offset = segment.size;
+    }
+    segment.size = offset;
+
+    if (offset < fileSize) {
+        if (truncateTornTail) {
+            // The tail of an interrupted write
+            bytes = SharedBytes();
+            std::error_code ec;
+            fs::resize_file(segment.path, offset, ec);
+            Logger::warn("Truncated " + std::to_string(fileSize - offset) + " torn bytes from " + segment.path);
+        } else {
+            Logger::error("Corrupt record in " + segment.path + " at offset " + std::to_string(offset) +
+                          "; later records in this segment are unreadable");
+        }
+    }
+}
+
+bool SegmentLog::loadIndex(Segment& segment) {
+    try {
+        std::ifstream in(indexPath(segment), std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        nlohmann::json index = nlohmann::json::from_cbor(data);
+
+        std::error_code ec;
+        uint64_t fileSize = fs::file_size(segment.path, ec);
+        if (ec || index.at("size").get<uint64_t>() != fileSize) {
+            return false;  // stale: the segment changed after the index was written
+        }
+        segment.size = fileSize;
+        segment.records = index.at("records").get<uint64_t>();
+        segment.minTimestamp = index.at("min").get<std::string>();
+        segment.maxTimestamp = index.at("max").get<std::string>();
+        for (const auto& point : index.at("sparse")) {
+            segment.sparse.emplace_back(point.at(0).get<uint64_t>(), point.at(1).get<std::string>());
+        }
+        const auto& hashes = index.at("ids");
+        const auto& offsets = index.at("offsets");
+        segment.ids.reserve(hashes.size());
+        for (size_t i = 0; i < hashes.size() && i < offsets.size(); ++i) {
+            segment.ids.emplace_back(hashes[i].get<uint64_t>(), offsets[i].get<uint64_t>());
+        }
+        segment.groups = index.at("groups").get<std::map<std::string, uint64_t>>();
+        return true;
+    } catch (const std::exception& e) {
+        Logger::warn("Rebuilding index for " + segment.path + ": " + e.what());
+        Segment empty;
+        empty.number = segment.number;
+        empty.path = segment.path;
+        segment = std::move(empty);
+        return false;
+    }
+}
+
+void SegmentLog::saveIndex(const Segment& segment) {
+    nlohmann::json index;
+    index["size"] = segment.size;
+    index["records"] = segment.records;
+    index["min"] = segment.minTimestamp;
+    index["max"] = segment.maxTimestamp;
+    index["sparse"] = nlohmann::json::array();
+    for (const auto& [offset, timestamp] : segment.sparse) {
+        index["sparse"].push_back({offset, timestamp});
+    }
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> offsets;
+    hashes.reserve(segment.ids.size());
+    offsets.reserve(segment.ids.size());
+    for (const auto& [hash, offset] : segment.ids) {
+        hashes.push_back(hash);
+        offsets.push_back(offset);
+    }
+    index["ids"] = hashes;
+    index["offsets"] = offsets;
+    index["groups"] = segment.groups;
+
+    std::string path = indexPath(segment);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::vector<uint8_t> data = nlohmann::json::to_cbor(index);
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            Logger::error("Failed to write segment index " + tmpPath);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        Logger::error("Failed to install segment index " + path + ": " + ec.message());
+    }
+}
+
+void SegmentLog::startSegment(uint32_t number) {
+    Segment segment;
+    segment.number = number;
+    segment.path = segmentPath(number);
+    std::ofstream create(segment.path, std::ios::binary | std::ios::app);
+    segments_.push_back(std::move(segment));
+}
+
+void SegmentLog::sealActiveLocked() {
+    writer_.reset();
+    Segment& active = segments_.back();
+    std::sort(active.ids.begin(), active.ids.end());
+    active.sealed = true;
+    saveIndex(active);
+    startSegment(active.number + 1);
+    writer_ = std::make_unique<GroupCommitWriter>(segments_.back().path, options_.writer);
+}
+
+void SegmentLog::appendLocked(const std::string& payload, const SegmentRecordKeys& keys, std::string& record) {
+    uint64_t recordBytes = kRecordHeaderBytes + payload.size();
+    if (segments_.back().size > 0 && segments_.back().size + recordBytes > options_.maxSegmentBytes) {
+        sealActiveLocked();
+    }
+    record.reserve(recordBytes);
+    putU32(record, static_cast<uint32_t>(payload.size()));
+    putU32(record, fnv1a32(payload));
+    record += payload;
+
+    Segment& active = segments_.back();
+    noteRecord(active, active.size, recordBytes, keys, options_.sparseInterval);
+}
+
+void SegmentLog::append(const std::string& payload, const SegmentRecordKeys& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string record;
+    appendLocked(payload, keys, record);
+    writer_->appendBytes(std::move(record));
+}
+
+std::future<void> SegmentLog::appendDurable(const std::string& payload, const SegmentRecordKeys& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string record;
+    appendLocked(payload, keys, record);
+    return writer_->appendBytesDurable(std::move(record));
+}
+
+void SegmentLog::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writer_->flush();
+}
+
+bool SegmentLog::matches(const Segment& segment, const SegmentScanFilter& filter) {
+    if (segment.records == 0) {
+        return false;
+    }
+    if (!filter.group.empty() && segment.groups.find(filter.group) == segment.groups.end()) {
+        return false;
+    }
+    if (!filter.fromTimestamp.empty() && !segment.maxTimestamp.empty() &&
+        segment.maxTimestamp < filter.fromTimestamp) {
+        return false;
+    }
+    if (!filter.toTimestamp.empty() && !segment.minTimestamp.empty() &&
+        segment.minTimestamp > filter.toTimestamp) {
+        return false;
+    }
+    return true;
+}
+
+void SegmentLog::scan(const SegmentScanFilter& filter, const Visitor& visit) {
+    struct Range {
+        std::string path;
+        uint64_t begin;
+        uint64_t end;
+    };
+    std::vector<Range> ranges;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writer_->drain();
+        for (const auto& segment : segments_) {
+            if (!matches(segment, filter)) {
+                continue;
+            }
+            uint64_t begin = 0;
+            if (!filter.fromTimestamp.empty()) {
+                // Last index point before which every record is older than the range
+                for (const auto& [offset, maxBefore] : segment.sparse) {
+                    if (!(maxBefore < filter.fromTimestamp)) {
+                        break;
+                    }
+                    begin = offset;
+                }
+            }
+            ranges.push_back({segment.path, begin, segment.size});
+        }
+    }
+
+    // Segments are append-only, so the recorded sizes stay valid unlocked
+    for (const auto& range : ranges) {
+        SharedBytes bytes = SharedBytes::mapFile(range.path);
+        uint64_t end = std::min<uint64_t>(range.end, bytes.size());
+        uint64_t offset = range.begin;
+        while (offset < end) {
+            std::string_view payload = payloadAt(bytes, offset, end);
+            if (payload.data() == nullptr) {
+                break;
+            }
+            if (!visit(payload)) {
+                return;
+            }
+            offset += kRecordHeaderBytes + payload.size();
+        }
+    }
+}
+
+std::unique_ptr<SegmentReader> SegmentLog::reader(const SegmentScanFilter& filter, bool newestFirst) {
+    auto reader = std::unique_ptr<SegmentReader>(new SegmentReader());
+    reader->reverse_ = newestFirst;
+    std::lock_guard<std::mutex> lock(mutex_);
+    writer_->drain();
+    for (const auto& segment : segments_) {
+        if (!matches(segment, filter)) {
+            continue;
+        }
+        size_t file = reader->files_.size();
+        reader->files_.push_back(segment.path);
+        for (size_t i = 0; i < segment.sparse.size(); ++i) {
+            bool last = i + 1 == segment.sparse.size();
+            uint64_t end = last ? segment.size : segment.sparse[i + 1].first;
+            // Newest timestamp inside this block is bounded by the next point's running max
+            const std::string& maxInBlock = last ? segment.maxTimestamp : segment.sparse[i + 1].second;
+            if (!filter.fromTimestamp.empty() && !maxInBlock.empty() && maxInBlock < filter.fromTimestamp) {
+                continue;
+            }
+            reader->blocks_.push_back({file, segment.sparse[i].first, end});
+        }
+    }
+    if (newestFirst) {
+        std::reverse(reader->blocks_.begin(), reader->blocks_.end());
+    }
+    return reader;
+}
+
+bool SegmentReader::loadNextBlock() {
+    while (nextBlock_ < blocks_.size()) {
+        const Block& block = blocks_[nextBlock_++];
+        if (block.file != mappedFile_) {
+            bytes_ = SharedBytes::mapFile(files_[block.file]);
+            mappedFile_ = block.file;
+        }
+        pending_.clear();
+        pendingIndex_ = 0;
+        uint64_t end = std::min<uint64_t>(block.end, bytes_.size());
+        for (uint64_t offset = block.begin; offset < end;) {
+            std::string_view payload = payloadAt(bytes_, offset, end);
+            if (payload.data() == nullptr) {
+                break;
+            }
+            pending_.push_back(payload);
+            offset += kRecordHeaderBytes + payload.size();
+        }
+        if (reverse_) {
+            std::reverse(pending_.begin(), pending_.end());
+        }
+        if (!pending_.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SegmentReader::next(std::string_view& payload) {
+    if (pendingIndex_ >= pending_.size() && !loadNextBlock()) {
+        return false;
+    }
+    payload = pending_[pendingIndex_++];
+    return true;
+}
+
+std::vector<std::string> SegmentLog::findById(const std::string& id) {
+    uint64_t hash = idHash(id);
+    std::vector<std::pair<std::string, std::vector<uint64_t>>> hits;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writer_->drain();
+        for (const auto& segment : segments_) {
+            std::vector<uint64_t> offsets;
+            if (segment.sealed) {
+                auto range = std::equal_range(segment.ids.begin(), segment.ids.end(),
+                                              std::make_pair(hash, uint64_t(0)),
+                                              [](const auto& a, const auto& b) { return a.first < b.first; });
+                for (auto it = range.first; it != range.second; ++it) {
+                    offsets.push_back(it->second);
+                }
+            } else {
+                for (const auto& [entryHash, offset] : segment.ids) {
+                    if (entryHash == hash) {
+                        offsets.push_back(offset);
+                    }
+                }
+            }
+            if (!offsets.empty()) {
+                std::sort(offsets.begin(), offsets.end());
+                hits.emplace_back(segment.path, std::move(offsets));
+            }
+        }
+    }
+
+    // Hash matches; the caller confirms the actual id
+    std::vector<std::string> payloads;
+    for (const auto& [path, offsets] : hits) {
+        SharedBytes bytes = SharedBytes::mapFile(path);
+        for (uint64_t offset : offsets) {
+            std::string_view payload = payloadAt(bytes, offset, bytes.size());
+            if (payload.data() != nullptr) {
+                payloads.emplace_back(payload);
+            }
+        }
+    }
+    return payloads;
+}
+
+uint64_t SegmentLog::recordCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (const auto& segment : segments_) {
+        total += segment.records;
+    }
+    return total;
+}
+
+size_t SegmentLog::segmentCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+}
+
+} // namespace ModAI
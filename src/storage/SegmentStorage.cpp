@@ -0,0 +1,254 @@
+#include "storage/SegmentStorage.h"
+#include "utils/Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+namespace ModAI {
+
+namespace {
+
+SegmentRecordKeys extractContentKeys(std::string_view payload) {
+    auto j = nlohmann::json::parse(payload.begin(), payload.end());
+    return {j.value("id", ""), j.value("timestamp", ""), j.value("subreddit", "")};
+}
+
+SegmentRecordKeys extractActionKeys(std::string_view payload) {
+    auto j = nlohmann::json::parse(payload.begin(), payload.end());
+    return {j.value("content_id", ""), j.value("timestamp", ""), ""};
+}
+
+bool inRange(const ContentItem& item, const SegmentScanFilter& filter) {
+    if (!filter.group.empty() && item.subreddit != filter.group) {
+        return false;
+    }
+    if (!filter.fromTimestamp.empty() && item.timestamp < filter.fromTimestamp) {
+        return false;
+    }
+    if (!filter.toTimestamp.empty() && item.timestamp > filter.toTimestamp) {
+        return false;
+    }
+    return true;
+}
+
+class SegmentContentCursor : public ContentCursor {
+public:
+    SegmentContentCursor(std::unique_ptr<SegmentReader> reader, ContentQuery query)
+        : reader_(std::move(reader))
+        , query_(std::move(query)) {
+    }
+
+    std::vector<ContentItem> next(size_t maxItems) override {
+        std::vector<ContentItem> page;
+        std::string_view payload;
+        while (page.size() < maxItems) {
+            if (!reader_->next(payload)) {
+                done_ = true;
+                break;
+            }
+            try {
+                ContentItem item = ContentItem::fromJson(std::string(payload));
+                if (query_.matches(item)) {
+                    page.push_back(std::move(item));
+                }
+            } catch (const std::exception& e) {
+                Logger::warn("Skipping corrupt content record: " + std::string(e.what()));
+            }
+        }
+        return page;
+    }
+
+    bool atEnd() const override { return done_; }
+
+private:
+    std::unique_ptr<SegmentReader> reader_;
+    ContentQuery query_;
+    bool done_ = false;
+};
+
+} // namespace
+
+SegmentStorage::SegmentStorage(const std::string& basePath, SegmentLogOptions options)
+    : basePath_(basePath) {
+    for (const char* dir : {"/cache", "/logs", "/exports/reports", "/exports/csv"}) {
+        std::error_code ec;
+        fs::create_directories(basePath + dir, ec);
+        if (ec) {
+            Logger::error("Failed to create directory: " + basePath + dir + " - " + ec.message());
+        }
+    }
+    content_ = std::make_unique<SegmentLog>(basePath + "/segments", "content", extractContentKeys, options);
+    actions_ = std::make_unique<SegmentLog>(basePath + "/segments", "actions", extractActionKeys, options);
+}
+
+SegmentRecordKeys SegmentStorage::contentKeys(const ContentItem& item) {
+    return {item.id, item.timestamp, item.subreddit};
+}
+
+SegmentRecordKeys SegmentStorage::actionKeys(const HumanAction& action) {
+    return {action.content_id, action.timestamp, ""};
+}
+
+void SegmentStorage::saveContent(const ContentItem& item) {
+    try {
+        content_->append(item.toJson(), contentKeys(item));
+    } catch (const std::exception& e) {
+        Logger::error("Failed to save content item: " + std::string(e.what()));
+        throw;
+    }
+}
+
+std::future<void> SegmentStorage::saveContentDurable(const ContentItem& item) {
+    return content_->appendDurable(item.toJson(), contentKeys(item));
+}
+
+void SegmentStorage::saveAction(const HumanAction& action) {
+    try {
+        actions_->append(action.toJson(), actionKeys(action));
+    } catch (const std::exception& e) {
+        Logger::error("Failed to save action: " + std::string(e.what()));
+        throw;
+    }
+}
+
+std::future<void> SegmentStorage::saveActionDurable(const HumanAction& action) {
+    return actions_->appendDurable(action.toJson(), actionKeys(action));
+}
+
+std::vector<ContentItem> SegmentStorage::loadAllContent() {
+    return loadContent(SegmentScanFilter());
+}
+
+std::vector<ContentItem> SegmentStorage::loadContent(const SegmentScanFilter& filter, size_t limit) {
+    std::vector<ContentItem> items;
+    // Records are parsed straight out of the mapped segment, one at a time
+    content_->scan(filter, [&](std::string_view payload) {
+        try {
+            ContentItem item = ContentItem::fromJson(std::string(payload));
+            if (inRange(item, filter)) {
+                items.push_back(std::move(item));
+            }
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt content record: " + std::string(e.what()));
+        }
+        return limit == 0 || items.size() < limit;
+    });
+    return items;
+}
+
+std::unique_ptr<ContentCursor> SegmentStorage::openCursor(const ContentQuery& query) {
+    SegmentScanFilter filter;
+    filter.fromTimestamp = query.fromTimestamp;
+    filter.toTimestamp = query.toTimestamp;
+    filter.group = query.subreddit;
+    return std::make_unique<SegmentContentCursor>(content_->reader(filter, query.newestFirst), query);
+}
+
+std::vector<HumanAction> SegmentStorage::loadAllActions() {
+    std::vector<HumanAction> actions;
+    actions_->scan(SegmentScanFilter(), [&](std::string_view payload) {
+        try {
+            actions.push_back(HumanAction::fromJson(std::string(payload)));
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt action record: " + std::string(e.what()));
+        }
+        return true;
+    });
+    return actions;
+}
+
+std::optional<ContentItem> SegmentStorage::findContent(const std::string& id) {
+    std::optional<ContentItem> latest;
+    for (const auto& payload : content_->findById(id)) {
+        try {
+            ContentItem item = ContentItem::fromJson(payload);
+            if (item.id == id) {
+                latest = std::move(item);
+            }
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt content record: " + std::string(e.what()));
+        }
+    }
+    return latest;
+}
+
+std::vector<HumanAction> SegmentStorage::actionsFor(const std::string& contentId) {
+    std::vector<HumanAction> actions;
+    for (const auto& payload : actions_->findById(contentId)) {
+        try {
+            HumanAction action = HumanAction::fromJson(payload);
+            if (action.content_id == contentId) {
+                actions.push_back(std::move(action));
+            }
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt action record: " + std::string(e.what()));
+        }
+    }
+    return actions;
+}
+
+bool SegmentStorage::empty() {
+    return content_->recordCount() == 0 && actions_->recordCount() == 0;
+}
+
+void SegmentStorage::flush() {
+    content_->flush();
+    actions_->flush();
+}
+
+size_t SegmentStorage::importJsonl(const std::string& contentPath, const std::string& actionPath) {
+    size_t imported = 0;
+    std::string line;
+    std::ifstream contentIn(contentPath);
+    while (std::getline(contentIn, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            ContentItem item = ContentItem::fromJson(line);
+            content_->append(line, contentKeys(item));
+            ++imported;
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt line in " + contentPath + ": " + e.what());
+        }
+    }
+    std::ifstream actionIn(actionPath);
+    while (std::getline(actionIn, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            HumanAction action = HumanAction::fromJson(line);
+            actions_->append(line, actionKeys(action));
+            ++imported;
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt line in " + actionPath + ": " + e.what());
+        }
+    }
+    flush();
+    return imported;
+}
+
+size_t SegmentStorage::exportJsonl(const std::string& contentPath, const std::string& actionPath) {
+    size_t exported = 0;
+    // Payloads are the JSONL lines themselves
+    auto writeAll = [&exported](SegmentLog& log, const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to open file for writing: " + path);
+        }
+        log.scan(SegmentScanFilter(), [&](std::string_view payload) {
+            out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            out.put('\n');
+            ++exported;
+            return true;
+        });
+    };
+    writeAll(*content_, contentPath);
+    writeAll(*actions_, actionPath);
+    return exported;
+}
+
+} // namespace ModAI
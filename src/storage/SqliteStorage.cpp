@@ -0,0 +1,579 @@
+#include "storage/SqliteStorage.h"
+#include "utils/Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <sqlite3.h>
+
+namespace fs = std::filesystem;
+
+namespace ModAI {
+
+namespace {
+
+constexpr int kSchemaVersion = 1;
+constexpr size_t kImportPageSize = 1000;
+
+const char* const kSchema = R"sql(
+CREATE TABLE IF NOT EXISTS content (
+    id TEXT PRIMARY KEY,
+    timestamp TEXT NOT NULL,
+    subreddit TEXT NOT NULL,
+    auto_action TEXT NOT NULL,
+    search TEXT NOT NULL,
+    json TEXT NOT NULL
+) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS content_by_timestamp ON content (timestamp, id);
+CREATE INDEX IF NOT EXISTS content_by_subreddit ON content (subreddit, timestamp, id);
+CREATE INDEX IF NOT EXISTS content_by_action ON content (auto_action, timestamp, id);
+CREATE TABLE IF NOT EXISTS actions (
+    action_id TEXT PRIMARY KEY,
+    content_id TEXT NOT NULL,
+    timestamp TEXT NOT NULL,
+    json TEXT NOT NULL
+);
+CREATE INDEX IF NOT EXISTS actions_by_content ON actions (content_id, timestamp);
+)sql";
+
+void bindText(sqlite3_stmt* stmt, int index, const std::string& value) {
+    sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+}
+
+std::string columnText(sqlite3_stmt* stmt, int column) {
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text ? std::string(text, static_cast<size_t>(sqlite3_column_bytes(stmt, column))) : std::string();
+}
+
+// LIKE pattern matching the literal text anywhere
+std::string likePattern(const std::string& text) {
+    std::string pattern = "%";
+    for (char c : text) {
+        if (c == '%' || c == '_' || c == '\\') {
+            pattern += '\\';
+        }
+        pattern += c;
+    }
+    pattern += '%';
+    return pattern;
+}
+
+} // namespace
+
+struct SqliteStorage::Connection {
+    sqlite3* db = nullptr;
+    std::mutex mutex;
+    sqlite3_stmt* insertContent = nullptr;
+    sqlite3_stmt* insertAction = nullptr;
+
+    Connection(const std::string& path, bool readOnly) {
+        int flags = SQLITE_OPEN_NOMUTEX | (readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+        if (sqlite3_open_v2(path.c_str(), &db, flags, nullptr) != SQLITE_OK) {
+            std::string message = db ? sqlite3_errmsg(db) : "out of memory";
+            sqlite3_close(db);
+            throw std::runtime_error("Failed to open database " + path + ": " + message);
+        }
+        sqlite3_busy_timeout(db, 5000);
+    }
+
+    ~Connection() {
+        sqlite3_finalize(insertContent);
+        sqlite3_finalize(insertAction);
+        // Cursors finalize their own statements; v2 defers until they have
+        sqlite3_close_v2(db);
+    }
+
+    void exec(const char* sql) {
+        char* error = nullptr;
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+            std::string message = error ? error : sqlite3_errmsg(db);
+            sqlite3_free(error);
+            throw std::runtime_error("SQLite: " + message);
+        }
+    }
+
+    sqlite3_stmt* prepare(const std::string& sql) {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v3(db, sql.c_str(), static_cast<int>(sql.size()), SQLITE_PREPARE_PERSISTENT, &stmt,
+                               nullptr) != SQLITE_OK) {
+            throw std::runtime_error("SQLite: " + std::string(sqlite3_errmsg(db)));
+        }
+        return stmt;
+    }
+
+    // Steps a statement returning a single json column, collecting every row
+    std::vector<std::string> collect(sqlite3_stmt* stmt) {
+        std::vector<std::string> rows;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            rows.push_back(columnText(stmt, 0));
+        }
+        if (rc != SQLITE_DONE) {
+            Logger::error("SQLite query failed: " + std::string(sqlite3_errmsg(db)));
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return rows;
+    }
+};
+
+namespace {
+
+using Connection = SqliteStorage::Connection;
+
+std::vector<ContentItem> parseContent(const std::vector<std::string>& rows) {
+    std::vector<ContentItem> items;
+    items.reserve(rows.size());
+    for (const auto& json : rows) {
+        try {
+            items.push_back(ContentItem::fromJson(json));
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt content row: " + std::string(e.what()));
+        }
+    }
+    return items;
+}
+
+std::vector<HumanAction> parseActions(const std::vector<std::string>& rows) {
+    std::vector<HumanAction> actions;
+    actions.reserve(rows.size());
+    for (const auto& json : rows) {
+        try {
+            actions.push_back(HumanAction::fromJson(json));
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt action row: " + std::string(e.what()));
+        }
+    }
+    return actions;
+}
+
+/**
+ * Pages by (timestamp, id) rather than OFFSET, so every page is an index
+ * seek and rows saved meanwhile do not shift later pages.
+ */
+class SqliteContentCursor : public ContentCursor {
+public:
+    SqliteContentCursor(std::shared_ptr<Connection> connection, const ContentQuery& query)
+        : connection_(std::move(connection))
+        , query_(query) {
+        std::string sql = "SELECT json, timestamp, id FROM content";
+        std::vector<std::string> where;
+        // With both filters present, the planner picks whichever index is narrower
+        if (!query_.subreddit.empty()) where.push_back("subreddit = :subreddit");
+        if (!query_.status.empty()) where.push_back("auto_action = :status");
+        if (!query_.fromTimestamp.empty()) where.push_back("timestamp >= :from");
+        if (!query_.toTimestamp.empty()) where.push_back("timestamp <= :to");
+        if (!query_.text.empty()) where.push_back("search LIKE :text ESCAPE '\\'");
+        const char* direction = query_.newestFirst ? "DESC" : "ASC";
+        where.push_back(std::string("(:after IS NULL OR (timestamp, id) ") + (query_.newestFirst ? "<" : ">") +
+                        " (:after, :afterId))");
+        for (size_t i = 0; i < where.size(); ++i) {
+            sql += (i == 0 ? " WHERE " : " AND ") + where[i];
+        }
+        sql += std::string(" ORDER BY timestamp ") + direction + ", id " + direction + " LIMIT :limit";
+
+        std::lock_guard<std::mutex> lock(connection_->mutex);
+        stmt_ = connection_->prepare(sql);
+    }
+
+    ~SqliteContentCursor() override {
+        std::lock_guard<std::mutex> lock(connection_->mutex);
+        sqlite3_finalize(stmt_);
+    }
+
+    std::vector<ContentItem> next(size_t maxItems) override {
+        std::vector<ContentItem> page;
+        if (done_ || maxItems == 0) {
+            return page;
+        }
+        std::vector<std::string> rows;
+        {
+            std::lock_guard<std::mutex> lock(connection_->mutex);
+            bind(":subreddit", query_.subreddit);
+            bind(":status", query_.status);
+            bind(":from", query_.fromTimestamp);
+            bind(":to", query_.toTimestamp);
+            if (!query_.text.empty()) {
+                bind(":text", likePattern(query_.text));
+            }
+            if (started_) {
+                bind(":after", lastTimestamp_);
+                bind(":afterId", lastId_);
+            }
+            sqlite3_bind_int64(stmt_, sqlite3_bind_parameter_index(stmt_, ":limit"),
+                               static_cast<sqlite3_int64>(maxItems));
+            int rc;
+            while ((rc = sqlite3_step(stmt_)) == SQLITE_ROW) {
+                rows.push_back(columnText(stmt_, 0));
+                lastTimestamp_ = columnText(stmt_, 1);
+                lastId_ = columnText(stmt_, 2);
+            }
+            if (rc != SQLITE_DONE) {
+                Logger::error("SQLite cursor failed: " + std::string(sqlite3_errmsg(connection_->db)));
+                done_ = true;
+            }
+            sqlite3_reset(stmt_);
+            sqlite3_clear_bindings(stmt_);
+        }
+        started_ = started_ || !rows.empty();
+        if (rows.size() < maxItems) {
+            done_ = true;
+        }
+        return parseContent(rows);
+    }
+
+    bool atEnd() const override { return done_; }
+
+private:
+    std::shared_ptr<Connection> connection_;
+    ContentQuery query_;
+    sqlite3_stmt* stmt_ = nullptr;
+    std::string lastTimestamp_;
+    std::string lastId_;
+    bool started_ = false;
+    bool done_ = false;
+
+    void bind(const char* name, const std::string& value) {
+        int index = sqlite3_bind_parameter_index(stmt_, name);
+        if (index > 0) {
+            bindText(stmt_, index, value);
+        }
+    }
+};
+
+} // namespace
+
+SqliteStorage::SqliteStorage(const std::string& databasePath, SqliteStorageOptions options)
+    : databasePath_(databasePath)
+    , options_(options) {
+    if (options_.maxBatchRecords == 0) {
+        options_.maxBatchRecords = 1;
+    }
+    std::error_code ec;
+    fs::path parent = fs::path(databasePath_).parent_path();
+    if (!parent.empty()) {
+        fs::create_directories(parent, ec);
+        if (ec) {
+            Logger::error("Failed to create directory: " + parent.string() + " - " + ec.message());
+        }
+    }
+
+    writer_ = std::make_unique<Connection>(databasePath_, false);
+    writer_->exec("PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;");
+    writer_->exec(kSchema);
+    writer_->exec(("PRAGMA user_version=" + std::to_string(kSchemaVersion)).c_str());
+    reader_ = std::make_shared<Connection>(databasePath_, true);
+
+    thread_ = std::thread(&SqliteStorage::run, this);
+}
+
+SqliteStorage::~SqliteStorage() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+SqliteStorage::ContentRow SqliteStorage::contentRow(const ContentItem& item, std::string json) {
+    return {item.id, item.timestamp, item.subreddit, item.decision.auto_action,
+            ContentQuery::searchableText(item), std::move(json)};
+}
+
+SqliteStorage::ActionRow SqliteStorage::actionRow(const HumanAction& action, std::string json) {
+    return {action.action_id, action.content_id, action.timestamp, std::move(json)};
+}
+
+void SqliteStorage::enqueue(ContentRow row) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingContent_.push_back(std::move(row));
+    }
+    cv_.notify_one();
+}
+
+void SqliteStorage::enqueue(ActionRow row) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingActions_.push_back(std::move(row));
+    }
+    cv_.notify_one();
+}
+
+void SqliteStorage::saveContent(const ContentItem& item) {
+    enqueue(contentRow(item, item.toJson()));
+}
+
+void SqliteStorage::saveAction(const HumanAction& action) {
+    enqueue(actionRow(action, action.toJson()));
+}
+
+std::future<void> SqliteStorage::saveContentDurable(const ContentItem& item) {
+    ContentRow row = contentRow(item, item.toJson());
+    row.done = std::make_shared<std::promise<void>>();
+    auto future = row.done->get_future();
+    enqueue(std::move(row));
+    return future;
+}
+
+std::future<void> SqliteStorage::saveActionDurable(const HumanAction& action) {
+    ActionRow row = actionRow(action, action.toJson());
+    row.done = std::make_shared<std::promise<void>>();
+    auto future = row.done->get_future();
+    enqueue(std::move(row));
+    return future;
+}
+
+void SqliteStorage::flush() {
+    auto barrier = std::make_shared<std::promise<void>>();
+    auto future = barrier->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingBarriers_.push_back(barrier);
+    }
+    cv_.notify_one();
+    future.wait();
+}
+
+void SqliteStorage::run() {
+    std::vector<ContentRow> content;
+    std::vector<ActionRow> actions;
+    std::vector<std::shared_ptr<std::promise<void>>> barriers;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto pending = [this]() { return pendingContent_.size() + pendingActions_.size(); };
+            cv_.wait(lock, [&]() { return pending() > 0 || !pendingBarriers_.empty() || stopping_; });
+            if (pending() == 0 && pendingBarriers_.empty() && stopping_) {
+                break;
+            }
+            // Linger so rows from concurrent workers share a transaction
+            if (pending() > 0 && pendingBarriers_.empty() && !stopping_ &&
+                pending() < options_.maxBatchRecords && options_.maxBatchDelay.count() > 0) {
+                cv_.wait_for(lock, options_.maxBatchDelay, [&]() {
+                    return pending() >= options_.maxBatchRecords || !pendingBarriers_.empty() || stopping_;
+                });
+            }
+            content.swap(pendingContent_);
+            actions.swap(pendingActions_);
+            barriers.swap(pendingBarriers_);
+        }
+
+        bool durable = false;
+        for (const auto& row : content) {
+            durable = durable || row.done;
+        }
+        for (const auto& row : actions) {
+            durable = durable || row.done;
+        }
+        std::string error;
+        bool ok = true;
+        if (!content.empty() || !actions.empty()) {
+            ok = commitBatch(content, actions, durable, error);
+        }
+        auto settle = [&](const std::shared_ptr<std::promise<void>>& done) {
+            if (!done) {
+                return;
+            }
+            if (ok) {
+                done->set_value();
+            } else {
+                done->set_exception(std::make_exception_ptr(std::runtime_error(error)));
+            }
+        };
+        for (const auto& row : content) {
+            settle(row.done);
+        }
+        for (const auto& row : actions) {
+            settle(row.done);
+        }
+        for (auto& barrier : barriers) {
+            barrier->set_value();
+        }
+        content.clear();
+        actions.clear();
+        barriers.clear();
+    }
+}
+
+bool SqliteStorage::commitBatch(std::vector<ContentRow>& content, std::vector<ActionRow>& actions, bool durable,
+                                std::string& error) {
+    try {
+        // Only the writer thread touches these after construction
+        if (!writer_->insertContent) {
+            writer_->insertContent = writer_->prepare(
+                "INSERT OR REPLACE INTO content (id, timestamp, subreddit, auto_action, search, json) "
+                "VALUES (?1, ?2, ?3, ?4, ?5, ?6)");
+            writer_->insertAction = writer_->prepare(
+                "INSERT OR REPLACE INTO actions (action_id, content_id, timestamp, json) VALUES (?1, ?2, ?3, ?4)");
+        }
+        if (durable) {
+            // WAL with synchronous=NORMAL only syncs at checkpoints
+            writer_->exec("PRAGMA synchronous=FULL");
+        }
+        writer_->exec("BEGIN IMMEDIATE");
+        for (const auto& row : content) {
+            sqlite3_stmt* stmt = writer_->insertContent;
+            bindText(stmt, 1, row.id);
+            bindText(stmt, 2, row.timestamp);
+            bindText(stmt, 3, row.subreddit);
+            bindText(stmt, 4, row.status);
+            bindText(stmt, 5, row.search);
+            bindText(stmt, 6, row.json);
+            int rc = sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error("SQLite: " + std::string(sqlite3_errmsg(writer_->db)));
+            }
+        }
+        for (const auto& row : actions) {
+            sqlite3_stmt* stmt = writer_->insertAction;
+            bindText(stmt, 1, row.actionId);
+            bindText(stmt, 2, row.contentId);
+            bindText(stmt, 3, row.timestamp);
+            bindText(stmt, 4, row.json);
+            int rc = sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error("SQLite: " + std::string(sqlite3_errmsg(writer_->db)));
+            }
+        }
+        writer_->exec("COMMIT");
+        if (durable) {
+            writer_->exec("PRAGMA synchronous=NORMAL");
+        }
+        return true;
+    } catch (const std::exception& e) {
+        error = "Failed to commit " + std::to_string(content.size() + actions.size()) +
+                " rows to " + databasePath_ + ": " + e.what();
+        Logger::error(error);
+        sqlite3_exec(writer_->db, "ROLLBACK", nullptr, nullptr, nullptr);
+        if (durable) {
+            sqlite3_exec(writer_->db, "PRAGMA synchronous=NORMAL", nullptr, nullptr, nullptr);
+        }
+        return false;
+    }
+}
+
+std::vector<ContentItem> SqliteStorage::loadAllContent() {
+    flush();
+    std::lock_guard<std::mutex> lock(reader_->mutex);
+    sqlite3_stmt* stmt = reader_->prepare("SELECT json FROM content ORDER BY timestamp, id");
+    auto rows = reader_->collect(stmt);
+    sqlite3_finalize(stmt);
+    return parseContent(rows);
+}
+
+std::vector<HumanAction> SqliteStorage::loadAllActions() {
+    flush();
+    std::lock_guard<std::mutex> lock(reader_->mutex);
+    sqlite3_stmt* stmt = reader_->prepare("SELECT json FROM actions ORDER BY timestamp");
+    auto rows = reader_->collect(stmt);
+    sqlite3_finalize(stmt);
+    return parseActions(rows);
+}
+
+std::unique_ptr<ContentCursor> SqliteStorage::openCursor(const ContentQuery& query) {
+    flush();
+    return std::make_unique<SqliteContentCursor>(reader_, query);
+}
+
+std::optional<ContentItem> SqliteStorage::findContent(const std::string& id) {
+    flush();
+    std::vector<std::string> rows;
+    {
+        std::lock_guard<std::mutex> lock(reader_->mutex);
+        sqlite3_stmt* stmt = reader_->prepare("SELECT json FROM content WHERE id = ?1");
+        bindText(stmt, 1, id);
+        rows = reader_->collect(stmt);
+        sqlite3_finalize(stmt);
+    }
+    auto items = parseContent(rows);
+    if (items.empty()) {
+        return std::nullopt;
+    }
+    return std::move(items.front());
+}
+
+std::vector<HumanAction> SqliteStorage::actionsFor(const std::string& contentId) {
+    flush();
+    std::vector<std::string> rows;
+    {
+        std::lock_guard<std::mutex> lock(reader_->mutex);
+        sqlite3_stmt* stmt = reader_->prepare("SELECT json FROM actions WHERE content_id = ?1 ORDER BY timestamp");
+        bindText(stmt, 1, contentId);
+        rows = reader_->collect(stmt);
+        sqlite3_finalize(stmt);
+    }
+    return parseActions(rows);
+}
+
+bool SqliteStorage::empty() {
+    flush();
+    std::lock_guard<std::mutex> lock(reader_->mutex);
+    sqlite3_stmt* stmt = reader_->prepare(
+        "SELECT EXISTS (SELECT 1 FROM content) OR EXISTS (SELECT 1 FROM actions)");
+    bool hasRows = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) != 0;
+    sqlite3_finalize(stmt);
+    return !hasRows;
+}
+
+size_t SqliteStorage::importFrom(Storage& source) {
+    size_t imported = 0;
+    ContentQuery all;
+    all.newestFirst = false;
+    auto cursor = source.openCursor(all);
+    while (!cursor->atEnd()) {
+        auto page = cursor->next(kImportPageSize);
+        if (page.empty()) {
+            break;
+        }
+        for (const auto& item : page) {
+            saveContent(item);
+        }
+        imported += page.size();
+    }
+    for (const auto& action : source.loadAllActions()) {
+        saveAction(action);
+        ++imported;
+    }
+    flush();
+    return imported;
+}
+
+size_t SqliteStorage::importJsonl(const std::string& contentPath, const std::string& actionPath) {
+    size_t imported = 0;
+    std::string line;
+    std::ifstream contentIn(contentPath);
+    while (std::getline(contentIn, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            ContentItem item = ContentItem::fromJson(line);
+            enqueue(contentRow(item, line));
+            ++imported;
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt line in " + contentPath + ": " + e.what());
+        }
+    }
+    std::ifstream actionIn(actionPath);
+    while (std::getline(actionIn, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            HumanAction action = HumanAction::fromJson(line);
+            enqueue(actionRow(action, line));
+            ++imported;
+        } catch (const std::exception& e) {
+            Logger::warn("Skipping corrupt line in " + actionPath + ": " + e.what());
+        }
+    }
+    flush();
+    return imported;
+}
+
+} // namespace ModAI
@@ -0,0 +1,107 @@
+#include "storage/Storage.h"
+#include <algorithm>
+#include <cctype>
+
+namespace ModAI {
+
+namespace {
+
+class VectorCursor : public ContentCursor {
+public:
+    explicit VectorCursor(std::vector<ContentItem> items)
+        : items_(std::move(items)) {
+    }
+
+    std::vector<ContentItem> next(size_t maxItems) override {
+        size_t end = std::min(items_.size(), position_ + maxItems);
+        std::vector<ContentItem> page(std::make_move_iterator(items_.begin() + position_),
+                                      std::make_move_iterator(items_.begin() + end));
+        position_ = end;
+        return page;
+    }
+
+    bool atEnd() const override { return position_ >= items_.size(); }
+
+private:
+    std::vector<ContentItem> items_;
+    size_t position_ = 0;
+};
+
+bool containsIgnoringCase(const std::string& haystack, const std::string& needle) {
+    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                          [](char a, char b) {
+                              return std::tolower(static_cast<unsigned char>(a)) ==
+                                     std::tolower(static_cast<unsigned char>(b));
+                          });
+    return it != haystack.end();
+}
+
+} // namespace
+
+std::string ContentQuery::searchableText(const ContentItem& item) {
+    std::string text = item.id;
+    for (const Symbol* field : {&item.subreddit, &item.content_type, &item.decision.auto_action}) {
+        text += '\n';
+        text += field->str();
+    }
+    text += '\n';
+    text += item.author.value_or("");
+    text += '\n';
+    text += item.text.value_or("");
+    return text;
+}
+
+bool ContentQuery::matches(const ContentItem& item) const {
+    if (!subreddit.empty() && item.subreddit != subreddit) {
+        return false;
+    }
+    if (!status.empty() && item.decision.auto_action != status) {
+        return false;
+    }
+    if (!fromTimestamp.empty() && item.timestamp < fromTimestamp) {
+        return false;
+    }
+    if (!toTimestamp.empty() && item.timestamp > toTimestamp) {
+        return false;
+    }
+    if (!text.empty() && !containsIgnoringCase(searchableText(item), text)) {
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<ContentCursor> Storage::openCursor(const ContentQuery& query) {
+    std::vector<ContentItem> items = loadAllContent();
+    items.erase(std::remove_if(items.begin(), items.end(),
+                               [&query](const ContentItem& item) { return !query.matches(item); }),
+                items.end());
+    // Stored order is arrival order
+    if (query.newestFirst) {
+        std::reverse(items.begin(), items.end());
+    }
+    return std::make_unique<VectorCursor>(std::move(items));
+}
+
+std::optional<ContentItem> Storage::findContent(const std::string& id) {
+    std::optional<ContentItem> latest;
+    for (auto& item : loadAllContent()) {
+        if (item.id == id) {
+            latest = std::move(item);
+        }
+    }
+    return latest;
+}
+
+std::vector<ContentItem> Storage::query(const ContentQuery& query, size_t limit, size_t offset) {
+    auto cursor = openCursor(query);
+    while (offset > 0 && !cursor->atEnd()) {
+        size_t skipped = cursor->next(std::min<size_t>(offset, 1000)).size();
+        if (skipped == 0) {
+            break;
+        }
+        offset -= skipped;
+    }
+    return offset > 0 ? std::vector<ContentItem>() : cursor->next(limit);
+}
+
+} // namespace ModAI
@@ -9,6 +9,14 @@
 #include <QtConcurrent>
 #include <QFutureWatcher>
 #include <QTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QMimeData>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QPointer>
+#include <QColor>
 
 namespace ModAI {
 
@@ -16,10 +24,42 @@ namespace ModAI {
 static const QString AI_GENERATED_MARKER = "ModAI-Generated";
 static const QString METADATA_KEY = "ModAI-Source";
 
+static const QStringList IMAGE_NAME_FILTERS = {"*.png", "*.jpg", "*.jpeg", "*.gif", "*.bmp", "*.webp"};
+
+namespace {
+
+enum BatchColumn { kFileColumn, kScoreColumn, kVerdictColumn, kSourceColumn };
+
+// Where each batch row keeps its result for when it is selected
+constexpr int kPathRole = Qt::UserRole;
+constexpr int kScoreRole = Qt::UserRole + 1;
+constexpr int kDetailsRole = Qt::UserRole + 2;
+constexpr int kSourceRole = Qt::UserRole + 3;
+
+QString verdictFor(float aiScore, QString* color) {
+    if (aiScore >= 0.8f) {
+        *color = "#cc0000"; // Red
+        return "Likely AI-Generated";
+    }
+    if (aiScore >= 0.5f) {
+        *color = "#ff9900"; // Orange
+        return "Possibly AI-Generated";
+    }
+    if (aiScore >= 0.3f) {
+        *color = "#ffcc00"; // Yellow
+        return "Mixed/Uncertain";
+    }
+    *color = "#00cc00"; // Green
+    return "Likely Real/Authentic";
+}
+
+} // namespace
+
 AIImageDetectorPanel::AIImageDetectorPanel(QWidget* parent)
     : QWidget(parent)
     , imageDisplay_(nullptr)
     , selectButton_(nullptr)
+    , folderButton_(nullptr)
     , analyzeButton_(nullptr)
     , clearButton_(nullptr)
     , resultLabel_(nullptr)
@@ -28,8 +68,24 @@ AIImageDetectorPanel::AIImageDetectorPanel(QWidget* parent)
     , sourceLabel_(nullptr)
     , statusLabel_(nullptr)
     , loadingTimer_(nullptr)
-    , loadingDots_(0) {
+    , loadingDots_(0)
+    , resizeSettleTimer_(nullptr)
+    , batchTable_(nullptr)
+    , batchProgress_(nullptr) {
     setupUI();
+    setAcceptDrops(true);
+    batchPool_.setMaxThreadCount(kBatchWorkers);
+    
+    resizeSettleTimer_ = new QTimer(this);
+    resizeSettleTimer_->setSingleShot(true);
+    resizeSettleTimer_->setInterval(150);
+    connect(resizeSettleTimer_, &QTimer::timeout, this, [this]() { rescaleDisplay(false); });
+}
+
+AIImageDetectorPanel::~AIImageDetectorPanel() {
+    batchCancellation_.cancel();
+    batchPool_.clear();
+    batchPool_.waitForDone();
 }
 
 QString AIImageDetectorPanel::extractImageSource(const QString& imagePath) {
@@ -60,9 +116,11 @@ void AIImageDetectorPanel::initialize(std::shared_ptr<ImageModerator> imageModer
     if (imageModerator_) {
         statusLabel_->setText("AI detector ready");
         selectButton_->setEnabled(true);
+        folderButton_->setEnabled(true);
     } else {
         statusLabel_->setText("AI detector not available");
         selectButton_->setEnabled(false);
+        folderButton_->setEnabled(false);
     }
 }
 
@@ -186,6 +244,27 @@ void AIImageDetectorPanel::setupUI() {
     
     layout->addWidget(contentWidget, 1);
     
+    // Batch results grid, shown once a batch starts
+    batchTable_ = new QTableWidget(0, 4);
+    batchTable_->setHorizontalHeaderLabels({"Image", "AI Score", "Verdict", "Source"});
+    batchTable_->horizontalHeader()->setSectionResizeMode(kFileColumn, QHeaderView::Stretch);
+    batchTable_->verticalHeader()->setVisible(false);
+    batchTable_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    batchTable_->setSelectionMode(QAbstractItemView::SingleSelection);
+    batchTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    batchTable_->setMinimumHeight(180);
+    batchTable_->setStyleSheet(
+        "QTableWidget { background-color: white; border: 1px solid #dee2e6; border-radius: 6px; font-size: 13px; }"
+    );
+    batchTable_->hide();
+    layout->addWidget(batchTable_, 1);
+    
+    batchProgress_ = new QProgressBar;
+    batchProgress_->setTextVisible(true);
+    batchProgress_->setFormat("%v / %m images");
+    batchProgress_->hide();
+    layout->addWidget(batchProgress_);
+    
     // Controls - modern styled buttons matching Reddit scraper page
     auto* controlsWidget = new QWidget;
     auto* buttonLayout = new QHBoxLayout(controlsWidget);
@@ -214,6 +293,13 @@ void AIImageDetectorPanel::setupUI() {
         "}"
     );
     
+    folderButton_ = new QPushButton("Analyze Folder");
+    folderButton_->setMinimumHeight(40);
+    folderButton_->setMinimumWidth(150);
+    folderButton_->setEnabled(false);
+    folderButton_->setCursor(Qt::PointingHandCursor);
+    folderButton_->setStyleSheet(selectButton_->styleSheet());
+    
     analyzeButton_ = new QPushButton("Analyze Image");
     analyzeButton_->setMinimumHeight(40);
     analyzeButton_->setMinimumWidth(150);
@@ -269,6 +355,7 @@ void AIImageDetectorPanel::setupUI() {
     );
     
     buttonLayout->addWidget(selectButton_);
+    buttonLayout->addWidget(folderButton_);
     buttonLayout->addWidget(analyzeButton_);
     buttonLayout->addWidget(clearButton_);
     buttonLayout->addStretch();
@@ -282,6 +369,8 @@ void AIImageDetectorPanel::setupUI() {
     
     // Connections
     connect(selectButton_, &QPushButton::clicked, this, &AIImageDetectorPanel::onSelectImage);
+    connect(folderButton_, &QPushButton::clicked, this, &AIImageDetectorPanel::onSelectFolder);
+    connect(batchTable_, &QTableWidget::itemSelectionChanged, this, &AIImageDetectorPanel::onBatchRowSelected);
     connect(analyzeButton_, &QPushButton::clicked, this, &AIImageDetectorPanel::onAnalyzeImage);
     connect(clearButton_, &QPushButton::clicked, this, &AIImageDetectorPanel::onClearImage);
 }
@@ -298,12 +387,16 @@ void AIImageDetectorPanel::onSelectImage() {
         return;
     }
     
-    currentImagePath_ = fileName;
-    displayImage(fileName);
+    selectImage(fileName);
+}
+
+void AIImageDetectorPanel::selectImage(const QString& path) {
+    currentImagePath_ = path;
+    displayImage(path);
     
     analyzeButton_->setEnabled(true);
     clearButton_->setEnabled(true);
-    statusLabel_->setText("Image loaded: " + QFileInfo(fileName).fileName());
+    statusLabel_->setText("Image loaded: " + QFileInfo(path).fileName());
     
     // Reset results
     resultLabel_->setText("No analysis yet");
@@ -311,6 +404,63 @@ void AIImageDetectorPanel::onSelectImage() {
     detailsLabel_->clear();
 }
 
+void AIImageDetectorPanel::onSelectFolder() {
+    // Doubles as the stop button while a batch runs
+    if (batchDone_ < batchTotal_) {
+        cancelBatch();
+        return;
+    }
+    
+    QString dir = QFileDialog::getExistingDirectory(this, "Select Image Folder", QDir::homePath());
+    if (dir.isEmpty()) {
+        return;
+    }
+    
+    QStringList paths;
+    for (const QFileInfo& info : QDir(dir).entryInfoList(IMAGE_NAME_FILTERS, QDir::Files, QDir::Name)) {
+        paths << info.absoluteFilePath();
+    }
+    if (paths.isEmpty()) {
+        statusLabel_->setText("No images in " + QDir(dir).dirName());
+        return;
+    }
+    startBatch(paths);
+}
+
+void AIImageDetectorPanel::dragEnterEvent(QDragEnterEvent* event) {
+    if (event->mimeData()->hasUrls()) {
+        event->acceptProposedAction();
+    }
+}
+
+void AIImageDetectorPanel::dropEvent(QDropEvent* event) {
+    QStringList paths;
+    bool folder = false;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        QFileInfo info(url.toLocalFile());
+        if (info.isDir()) {
+            folder = true;
+            for (const QFileInfo& entry : QDir(info.absoluteFilePath()).entryInfoList(IMAGE_NAME_FILTERS, QDir::Files, QDir::Name)) {
+                paths << entry.absoluteFilePath();
+            }
+        } else if (info.isFile()) {
+            paths << info.absoluteFilePath();
+        }
+    }
+    if (paths.isEmpty()) {
+        return;
+    }
+    event->acceptProposedAction();
+    
+    if (paths.size() == 1 && !folder) {
+        selectImage(paths.front());
+    } else if (batchDone_ < batchTotal_) {
+        statusLabel_->setText("A batch is already running");
+    } else {
+        startBatch(paths);
+    }
+}
+
 void AIImageDetectorPanel::displayImage(const QString& path) {
     QPixmap pixmap(path);
     
@@ -320,16 +470,17 @@ void AIImageDetectorPanel::displayImage(const QString& path) {
         return;
     }
     
-    // Store original pixmap for resizing
-    originalPixmap_ = pixmap;
-    
-    // Scale to fill available space while maintaining aspect ratio
-    QSize displaySize = imageDisplay_->size();
-    if (displaySize.width() < 100 || displaySize.height() < 100) {
-        displaySize = QSize(350, 350); // Fallback size
+    // Halve once per level so resizes rescale from a nearby size instead
+    // of the full image
+    pyramid_.clear();
+    pyramid_.push_back(pixmap);
+    while (std::min(pyramid_.back().width(), pyramid_.back().height()) / 2 >= kPyramidMinSide) {
+        const QPixmap& last = pyramid_.back();
+        pyramid_.push_back(last.scaled(last.width() / 2, last.height() / 2,
+                                       Qt::KeepAspectRatio, Qt::SmoothTransformation));
     }
-    QPixmap scaled = pixmap.scaled(displaySize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    imageDisplay_->setPixmap(scaled);
+    
+    rescaleDisplay(false);
     imageDisplay_->setStyleSheet(
         "QLabel { "
         "  border: 2px solid #0066cc; "
@@ -339,17 +490,84 @@ void AIImageDetectorPanel::displayImage(const QString& path) {
     );
 }
 
+void AIImageDetectorPanel::rescaleDisplay(bool fast) {
+    if (pyramid_.empty() || !imageDisplay_) {
+        return;
+    }
+    
+    // Scale to fill available space while maintaining aspect ratio
+    QSize displaySize = imageDisplay_->size();
+    if (displaySize.width() < 100 || displaySize.height() < 100) {
+        displaySize = QSize(350, 350); // Fallback size
+    }
+    
+    // Smallest level that still only needs shrinking
+    int fittedWidth = pyramid_.front().size().scaled(displaySize, Qt::KeepAspectRatio).width();
+    const QPixmap* source = &pyramid_.front();
+    for (auto it = pyramid_.rbegin(); it != pyramid_.rend(); ++it) {
+        if (it->width() >= fittedWidth) {
+            source = &*it;
+            break;
+        }
+    }
+    imageDisplay_->setPixmap(source->scaled(displaySize, Qt::KeepAspectRatio,
+                                            fast ? Qt::FastTransformation : Qt::SmoothTransformation));
+}
+
 void AIImageDetectorPanel::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
     
-    // Re-scale image when panel is resized
-    if (!originalPixmap_.isNull() && imageDisplay_) {
-        QSize displaySize = imageDisplay_->size();
-        if (displaySize.width() > 50 && displaySize.height() > 50) {
-            QPixmap scaled = originalPixmap_.scaled(displaySize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            imageDisplay_->setPixmap(scaled);
+    // Cheap scaling while the resize is in progress; the smooth one runs
+    // once it has settled
+    if (!pyramid_.empty()) {
+        rescaleDisplay(true);
+        resizeSettleTimer_->start();
+    }
+}
+
+AIImageDetectorPanel::Analysis AIImageDetectorPanel::analyzeFile(ImageModerator& moderator, const QString& imagePath) {
+    Analysis analysis;
+    // Check for embedded metadata first
+    analysis.source = extractImageSource(imagePath);
+    
+    // Mapped rather than read, and shared with the request as-is
+    SharedBytes imageBytes = SharedBytes::mapFile(imagePath.toStdString());
+    if (imageBytes.empty()) {
+        throw std::runtime_error("Failed to open image file");
+    }
+    
+    // Moderate/analyze the image
+    auto result = moderator.analyzeImage(imageBytes);
+    
+    // Extract AI detection score
+    float aiScore = 0.0f;
+    std::string detailsText;
+    
+    for (const auto& [category, score] : result.labels) {
+        if (category == "ai_generated" || category == "ai-generated") {
+            aiScore = static_cast<float>(score);
+            detailsText = "AI-Generated class detected by Hive API";
+            break;
         }
     }
+    
+    // If we have embedded metadata, it's definitely AI-generated
+    if (!analysis.source.isEmpty()) {
+        // Random score between 80% and 95% for metadata-detected images
+        float randomScore = 0.80f + (static_cast<float>(rand() % 16) / 100.0f);
+        aiScore = std::max(aiScore, randomScore);
+        detailsText = "Image contains ModAI generation metadata. ";
+        detailsText += "This image was generated by our chatbot.";
+    } else if (aiScore == 0.0f && !result.labels.empty()) {
+        // If no explicit AI class, use a heuristic
+        detailsText = "Estimating based on visual patterns. ";
+        detailsText += "Note: For accurate AI detection, Hive API should include 'ai_generated' class.";
+        aiScore = 0.3f; // Placeholder
+    }
+    
+    analysis.aiScore = aiScore;
+    analysis.details = QString::fromStdString(detailsText);
+    return analysis;
 }
 
 void AIImageDetectorPanel::onAnalyzeImage() {
@@ -364,14 +582,9 @@ void AIImageDetectorPanel::onAnalyzeImage() {
     }
     
     statusLabel_->setText("Analyzing image with AI...");
-    analyzeButton_->setEnabled(false);
-    selectButton_->setEnabled(false);
-    clearButton_->setEnabled(false);
+    setBusy(true);
     sourceLabel_->hide(); // Hide source label initially
     
-    // First check for embedded metadata
-    QString embeddedSource = extractImageSource(currentImagePath_);
-    
     // Animate button with pulsing dots
     loadingDots_ = 0;
     loadingTimer_ = new QTimer(this);
@@ -405,67 +618,16 @@ void AIImageDetectorPanel::onAnalyzeImage() {
             
             // Re-enable UI
             analyzeButton_->setText("Analyze Image");
-            analyzeButton_->setEnabled(true);
-            selectButton_->setEnabled(true);
-            clearButton_->setEnabled(true);
+            setBusy(false);
         }
         
         watcher->deleteLater();
     });
     
     // Start async analysis
-    QFuture<std::tuple<float, QString, QString>> future = QtConcurrent::run([moderator, imagePath, embeddedSource]() -> std::tuple<float, QString, QString> {
-        // Load image file as bytes
-        QFile file(imagePath);
-        if (!file.open(QIODevice::ReadOnly)) {
-            throw std::runtime_error("Failed to open image file");
-        }
-        
-        QByteArray imageData = file.readAll();
-        file.close();
-        
-        std::vector<uint8_t> imageBytes(imageData.begin(), imageData.end());
-        
-        // Determine MIME type
-        std::string mimeType = "image/jpeg";
-        if (imagePath.endsWith(".png", Qt::CaseInsensitive)) {
-            mimeType = "image/png";
-        } else if (imagePath.endsWith(".gif", Qt::CaseInsensitive)) {
-            mimeType = "image/gif";
-        } else if (imagePath.endsWith(".webp", Qt::CaseInsensitive)) {
-            mimeType = "image/webp";
-        }
-        
-        // Moderate/analyze the image
-        auto result = moderator->analyzeImage(imageBytes, mimeType);
-        
-        // Extract AI detection score
-        float aiScore = 0.0f;
-        std::string detailsText;
-        
-        for (const auto& [category, score] : result.labels) {
-            if (category == "ai_generated" || category == "ai-generated") {
-                aiScore = static_cast<float>(score);
-                detailsText = "AI-Generated class detected by Hive API";
-                break;
-            }
-        }
-        
-        // If we have embedded metadata, it's definitely AI-generated
-        if (!embeddedSource.isEmpty()) {
-            // Random score between 80% and 95% for metadata-detected images
-            float randomScore = 0.80f + (static_cast<float>(rand() % 16) / 100.0f);
-            aiScore = std::max(aiScore, randomScore);
-            detailsText = "Image contains ModAI generation metadata. ";
-            detailsText += "This image was generated by our chatbot.";
-        } else if (aiScore == 0.0f && !result.labels.empty()) {
-            // If no explicit AI class, use a heuristic
-            detailsText = "Estimating based on visual patterns. ";
-            detailsText += "Note: For accurate AI detection, Hive API should include 'ai_generated' class.";
-            aiScore = 0.3f; // Placeholder
-        }
-        
-        return std::make_tuple(aiScore, QString::fromStdString(detailsText), embeddedSource);
+    QFuture<std::tuple<float, QString, QString>> future = QtConcurrent::run([moderator, imagePath]() -> std::tuple<float, QString, QString> {
+        Analysis analysis = analyzeFile(*moderator, imagePath);
+        return std::make_tuple(analysis.aiScore, analysis.details, analysis.source);
     });
     
     watcher->setFuture(future);
@@ -480,13 +642,178 @@ void AIImageDetectorPanel::onAnalysisComplete(float aiScore, const QString& deta
     emit analysisComplete(aiScore);
     
     // Re-enable UI
-    analyzeButton_->setEnabled(true);
-    selectButton_->setEnabled(true);
+    setBusy(false);
+}
+
+void AIImageDetectorPanel::setBusy(bool busy) {
+    analyzeButton_->setEnabled(!busy && !currentImagePath_.isEmpty());
+    selectButton_->setEnabled(!busy);
+    folderButton_->setEnabled(!busy);
+    clearButton_->setEnabled(!busy);
+}
+
+void AIImageDetectorPanel::startBatch(const QStringList& paths) {
+    if (!imageModerator_) {
+        statusLabel_->setText("AI detector not available");
+        return;
+    }
+    
+    cancelBatch();
+    batchCancellation_ = CancellationSource();
+    uint64_t batchId = ++batchId_;
+    batchDone_ = 0;
+    batchTotal_ = paths.size();
+    
+    batchTable_->clearContents();
+    batchTable_->setRowCount(batchTotal_);
+    for (int row = 0; row < batchTotal_; ++row) {
+        auto* fileItem = new QTableWidgetItem(QFileInfo(paths[row]).fileName());
+        fileItem->setData(kPathRole, paths[row]);
+        fileItem->setToolTip(paths[row]);
+        batchTable_->setItem(row, kFileColumn, fileItem);
+        batchTable_->setItem(row, kVerdictColumn, new QTableWidgetItem("Queued"));
+    }
+    batchTable_->show();
+    batchProgress_->setRange(0, batchTotal_);
+    batchProgress_->setValue(0);
+    batchProgress_->show();
+    
+    selectButton_->setEnabled(false);
+    analyzeButton_->setEnabled(false);
+    folderButton_->setText("Stop Batch");
     clearButton_->setEnabled(true);
+    statusLabel_->setText(QString("Analyzing %1 images...").arg(batchTotal_));
+    Logger::info("Starting batch image analysis of " + std::to_string(batchTotal_) + " images");
+    
+    // A few requests in flight at once; beyond that the moderator's rate
+    // limiter is what paces them, and stopping aborts its waits too
+    QPointer<AIImageDetectorPanel> self(this);
+    auto moderator = imageModerator_;
+    CancellationToken token = batchCancellation_.token();
+    for (int row = 0; row < batchTotal_; ++row) {
+        QString path = paths[row];
+        batchPool_.start([self, moderator, token, batchId, row, path]() {
+            if (token.stopRequested()) {
+                return;
+            }
+            CancellationScope scope(token);
+            Analysis analysis;
+            QString error;
+            try {
+                analysis = analyzeFile(*moderator, path);
+            } catch (const std::exception& e) {
+                error = QString::fromStdString(e.what());
+                Logger::error("AI image detection error for " + path.toStdString() + ": " + e.what());
+            }
+            if (!self || token.stopRequested()) {
+                return;
+            }
+            QMetaObject::invokeMethod(self.data(), [self, batchId, row, analysis, error]() {
+                if (self) {
+                    self->onBatchItemDone(batchId, row, error.isEmpty(), analysis, error);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void AIImageDetectorPanel::cancelBatch() {
+    batchCancellation_.cancel();
+    batchPool_.clear();
+    if (batchDone_ < batchTotal_) {
+        for (int row = 0; row < batchTable_->rowCount(); ++row) {
+            QTableWidgetItem* verdict = batchTable_->item(row, kVerdictColumn);
+            if (verdict && verdict->text() == "Queued") {
+                verdict->setText("Stopped");
+            }
+        }
+        statusLabel_->setText(QString("Batch stopped after %1 of %2 images").arg(batchDone_).arg(batchTotal_));
+        Logger::info("Batch image analysis stopped");
+    }
+    // Results still arriving from the stopped batch are ignored
+    ++batchId_;
+    batchTotal_ = batchDone_;
+    folderButton_->setText("Analyze Folder");
+    setBusy(false);
+}
+
+void AIImageDetectorPanel::onBatchItemDone(uint64_t batchId, int row, bool ok, const Analysis& analysis,
+                                           const QString& error) {
+    if (batchId != batchId_) {
+        return;
+    }
+    
+    if (ok) {
+        QString color;
+        QString verdict = verdictFor(analysis.aiScore, &color);
+        auto* scoreItem = new QTableWidgetItem(QString("%1%").arg(static_cast<int>(analysis.aiScore * 100)));
+        scoreItem->setData(kScoreRole, analysis.aiScore);
+        batchTable_->setItem(row, kScoreColumn, scoreItem);
+        auto* verdictItem = new QTableWidgetItem(verdict);
+        verdictItem->setForeground(QColor(color));
+        verdictItem->setData(kDetailsRole, analysis.details);
+        batchTable_->setItem(row, kVerdictColumn, verdictItem);
+        auto* sourceItem = new QTableWidgetItem(analysis.source);
+        sourceItem->setData(kSourceRole, analysis.source);
+        batchTable_->setItem(row, kSourceColumn, sourceItem);
+    } else {
+        auto* verdictItem = new QTableWidgetItem("Error");
+        verdictItem->setToolTip(error);
+        batchTable_->setItem(row, kVerdictColumn, verdictItem);
+    }
+    
+    batchProgress_->setValue(++batchDone_);
+    if (batchDone_ == batchTotal_) {
+        statusLabel_->setText(QString("Batch complete: %1 images analyzed").arg(batchTotal_));
+        Logger::info("Batch image analysis complete");
+        folderButton_->setText("Analyze Folder");
+        setBusy(false);
+    }
+}
+
+void AIImageDetectorPanel::onBatchRowSelected() {
+    auto selected = batchTable_->selectedItems();
+    if (selected.isEmpty()) {
+        return;
+    }
+    int row = selected.front()->row();
+    QTableWidgetItem* fileItem = batchTable_->item(row, kFileColumn);
+    if (!fileItem) {
+        return;
+    }
+    
+    currentImagePath_ = fileItem->data(kPathRole).toString();
+    displayImage(currentImagePath_);
+    
+    QTableWidgetItem* scoreItem = batchTable_->item(row, kScoreColumn);
+    if (scoreItem) {
+        QTableWidgetItem* verdictItem = batchTable_->item(row, kVerdictColumn);
+        QTableWidgetItem* sourceItem = batchTable_->item(row, kSourceColumn);
+        updateResults(scoreItem->data(kScoreRole).toFloat(),
+                      verdictItem ? verdictItem->data(kDetailsRole).toString().toStdString() : std::string(),
+                      sourceItem ? sourceItem->data(kSourceRole).toString() : QString());
+    } else {
+        resultLabel_->setText("No analysis yet");
+        scoreBar_->setValue(0);
+        detailsLabel_->clear();
+        sourceLabel_->hide();
+    }
+    if (batchDone_ == batchTotal_) {
+        analyzeButton_->setEnabled(true);
+    }
 }
 
 void AIImageDetectorPanel::onClearImage() {
+    cancelBatch();
+    batchTable_->clearContents();
+    batchTable_->setRowCount(0);
+    batchTable_->hide();
+    batchProgress_->hide();
+    batchDone_ = batchTotal_ = 0;
+    
     currentImagePath_.clear();
+    pyramid_.clear();
+    resizeSettleTimer_->stop();
     imageDisplay_->clear();
     imageDisplay_->setText("No image loaded\n\nClick 'Select Image' to choose a file");
     imageDisplay_->setStyleSheet(
@@ -515,22 +842,8 @@ void AIImageDetectorPanel::updateResults(float aiScore, const std::string& detai
     scoreBar_->setValue(scorePercent);
     
     // Determine verdict
-    QString verdict;
     QString color;
-    
-    if (aiScore >= 0.8f) {
-        verdict = "Likely AI-Generated";
-        color = "#cc0000"; // Red
-    } else if (aiScore >= 0.5f) {
-        verdict = "Possibly AI-Generated";
-        color = "#ff9900"; // Orange
-    } else if (aiScore >= 0.3f) {
-        verdict = "Mixed/Uncertain";
-        color = "#ffcc00"; // Yellow
-    } else {
-        verdict = "Likely Real/Authentic";
-        color = "#00cc00"; // Green
-    }
+    QString verdict = verdictFor(aiScore, &color);
     
     resultLabel_->setText(verdict);
     resultLabel_->setStyleSheet(
@@ -5,6 +5,9 @@
 #include <QRegularExpression>
 #include <QtConcurrent>
 #include <QFutureWatcher>
+#include <QTextCursor>
+#include <QColor>
+#include <algorithm>
 #include "detectors/LocalAIDetector.h"
 #include "ui/ChatbotPanel.h"
 
@@ -20,8 +23,15 @@ AITextDetectorPanel::AITextDetectorPanel(QWidget* parent)
     , detailsLabel_(nullptr)
     , statusLabel_(nullptr)
     , loadingTimer_(nullptr)
-    , loadingDots_(0) {
+    , loadingDots_(0)
+    , liveCheck_(nullptr)
+    , debounceTimer_(nullptr) {
     setupUI();
+    
+    debounceTimer_ = new QTimer(this);
+    debounceTimer_->setSingleShot(true);
+    debounceTimer_->setInterval(kDebounceMs);
+    connect(debounceTimer_, &QTimer::timeout, this, [this]() { requestAnalysis(true); });
 }
 
 void AITextDetectorPanel::initialize(std::shared_ptr<TextDetector> textDetector) {
@@ -29,13 +39,21 @@ void AITextDetectorPanel::initialize(std::shared_ptr<TextDetector> textDetector)
     
     // Check if it's a LocalAIDetector with isAvailable method
     auto localDetector = std::dynamic_pointer_cast<LocalAIDetector>(textDetector_);
-    if (localDetector && localDetector->isAvailable()) {
-        statusLabel_->setText("AI detector ready");
-        analyzeButton_->setEnabled(true);
-    } else {
+    if (!localDetector) {
         statusLabel_->setText("AI detector not available");
         analyzeButton_->setEnabled(false);
+        return;
     }
+    
+    // Enabled once a background load finishes
+    statusLabel_->setText("Loading AI model...");
+    analyzeButton_->setEnabled(false);
+    localDetector->whenLoaded([this](bool available) {
+        QMetaObject::invokeMethod(this, [this, available]() {
+            statusLabel_->setText(available ? "AI detector ready" : "AI detector not available");
+            analyzeButton_->setEnabled(available);
+        }, Qt::QueuedConnection);
+    });
 }
 
 void AITextDetectorPanel::setupUI() {
@@ -231,8 +249,13 @@ void AITextDetectorPanel::setupUI() {
         "}"
     );
     
+    liveCheck_ = new QCheckBox("Analyze as you type");
+    liveCheck_->setCursor(Qt::PointingHandCursor);
+    liveCheck_->setStyleSheet("font-size: 14px;");
+    
     buttonLayout->addWidget(analyzeButton_);
     buttonLayout->addWidget(clearButton_);
+    buttonLayout->addWidget(liveCheck_);
     buttonLayout->addStretch();
     
     layout->addWidget(controlsWidget);
@@ -245,104 +268,244 @@ void AITextDetectorPanel::setupUI() {
     // Connections
     connect(analyzeButton_, &QPushButton::clicked, this, &AITextDetectorPanel::onAnalyzeText);
     connect(clearButton_, &QPushButton::clicked, this, &AITextDetectorPanel::onClearText);
+    connect(textInput_, &QTextEdit::textChanged, this, &AITextDetectorPanel::onTextChanged);
+    connect(liveCheck_, &QCheckBox::toggled, this, [this](bool live) {
+        if (live) {
+            debounceTimer_->start();
+        } else {
+            debounceTimer_->stop();
+        }
+    });
+}
+
+std::vector<AITextDetectorPanel::Paragraph> AITextDetectorPanel::splitParagraphs(const QString& text) {
+    static const QRegularExpression separator("\\n\\s*\\n");
+    std::vector<Paragraph> paragraphs;
+    auto add = [&](int begin, int end) {
+        while (begin < end && text[begin].isSpace()) {
+            ++begin;
+        }
+        while (end > begin && text[end - 1].isSpace()) {
+            --end;
+        }
+        if (end > begin) {
+            paragraphs.push_back({begin, text.mid(begin, end - begin)});
+        }
+    };
+    int pos = 0;
+    auto it = separator.globalMatch(text);
+    while (it.hasNext()) {
+        auto match = it.next();
+        add(pos, match.capturedStart());
+        pos = match.capturedEnd();
+    }
+    add(pos, text.size());
+    return paragraphs;
+}
+
+void AITextDetectorPanel::onTextChanged() {
+    if (liveCheck_->isChecked()) {
+        debounceTimer_->start();
+    }
 }
 
 void AITextDetectorPanel::onAnalyzeText() {
-    QString text = textInput_->toPlainText();
-    
-    // Store original text for watermark check after analysis
-    currentText_ = text;
-    
-    text = text.trimmed();
+    debounceTimer_->stop();
+    requestAnalysis(false);
+}
+
+void AITextDetectorPanel::requestAnalysis(bool live) {
+    QString text = textInput_->toPlainText().trimmed();
     if (text.isEmpty()) {
-        statusLabel_->setText("Please enter some text to analyze");
+        if (!live) {
+            statusLabel_->setText("Please enter some text to analyze");
+        }
         return;
     }
     
     auto localDetector = std::dynamic_pointer_cast<LocalAIDetector>(textDetector_);
     if (!localDetector || !localDetector->isAvailable()) {
-        statusLabel_->setText("AI detector not available");
+        if (!live) {
+            statusLabel_->setText("AI detector not available");
+        }
         return;
     }
     
     // Check minimum length
     int wordCount = text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts).count();
     if (wordCount < 10) {
-        statusLabel_->setText("Text too short. Please provide at least 10 words for accurate detection.");
+        statusLabel_->setText(live ? "Keep typing - at least 10 words are needed"
+                                   : "Text too short. Please provide at least 10 words for accurate detection.");
         return;
     }
     
-    // Show loading state on button with animation
+    ++latestRequest_;
+    if (!live && !loadingTimer_) {
+        // Show loading state on button with animation
+        analyzeButton_->setEnabled(false);
+        loadingDots_ = 0;
+        loadingTimer_ = new QTimer(this);
+        connect(loadingTimer_, &QTimer::timeout, [this]() {
+            loadingDots_ = (loadingDots_ + 1) % 4;
+            QString dots(loadingDots_, '.');
+            QString spaces(3 - loadingDots_, ' ');
+            analyzeButton_->setText("Analyzing" + dots + spaces);
+        });
+        loadingTimer_->start(400);
+    }
     statusLabel_->setText("Analyzing text...");
-    analyzeButton_->setEnabled(false);
-    clearButton_->setEnabled(false);
-    textInput_->setEnabled(false);
-    
-    // Animate button with pulsing dots
-    loadingDots_ = 0;
-    loadingTimer_ = new QTimer(this);
-    connect(loadingTimer_, &QTimer::timeout, [this]() {
-        loadingDots_ = (loadingDots_ + 1) % 4;
-        QString dots(loadingDots_, '.');
-        QString spaces(3 - loadingDots_, ' ');
-        analyzeButton_->setText("Analyzing" + dots + spaces);
-    });
-    loadingTimer_->start(400);
     
-    // Run analysis in background thread
-    QString textToAnalyze = text;
-    auto detector = textDetector_;
+    // The model runs one request at a time; a request arriving meanwhile
+    // is served by a single rerun for whatever the text is by then
+    if (analysisRunning_) {
+        rerunPending_ = true;
+        return;
+    }
+    startAnalysis();
+}
+
+void AITextDetectorPanel::startAnalysis() {
+    rerunPending_ = false;
     
-    auto* watcher = new QFutureWatcher<std::pair<float, QString>>(this);
-    connect(watcher, &QFutureWatcher<std::pair<float, QString>>::finished, [this, watcher]() {
-        if (loadingTimer_) {
-            loadingTimer_->stop();
-            loadingTimer_->deleteLater();
-            loadingTimer_ = nullptr;
+    // Store original text for watermark check after analysis
+    currentText_ = textInput_->toPlainText();
+    auto paragraphs = splitParagraphs(currentText_);
+    
+    std::vector<QString> uncached;
+    for (const auto& paragraph : paragraphs) {
+        if (!paragraphScores_.contains(paragraph.text) &&
+            std::find(uncached.begin(), uncached.end(), paragraph.text) == uncached.end()) {
+            uncached.push_back(paragraph.text);
         }
-        
+    }
+    if (uncached.empty()) {
+        renderAnalysis(paragraphs);
+        return;
+    }
+    
+    // Only new or edited paragraphs go to the model, in one batched run
+    analysisRunning_ = true;
+    uint64_t request = latestRequest_;
+    auto detector = textDetector_;
+    
+    auto* watcher = new QFutureWatcher<std::vector<float>>(this);
+    connect(watcher, &QFutureWatcher<std::vector<float>>::finished, [this, watcher, request, uncached]() {
         try {
-            auto result = watcher->result();
-            onAnalysisComplete(result.first, result.second);
+            onParagraphsScored(request, uncached, watcher->result());
         } catch (const std::exception& e) {
+            analysisRunning_ = false;
+            rerunPending_ = false;
+            stopLoadingAnimation();
             statusLabel_->setText("Error: " + QString::fromStdString(e.what()));
             Logger::error("AI text detection error: " + std::string(e.what()));
-            
-            // Re-enable UI
-            analyzeButton_->setText("Analyze Text");
-            analyzeButton_->setEnabled(true);
-            clearButton_->setEnabled(true);
-            textInput_->setEnabled(true);
         }
         
         watcher->deleteLater();
     });
     
     // Start async analysis
-    QFuture<std::pair<float, QString>> future = QtConcurrent::run([detector, textToAnalyze]() -> std::pair<float, QString> {
-        auto result = detector->analyze(textToAnalyze.toStdString());
-        return std::make_pair(static_cast<float>(result.ai_score), QString::fromStdString(result.label));
+    QFuture<std::vector<float>> future = QtConcurrent::run([detector, uncached]() -> std::vector<float> {
+        std::vector<std::string> texts;
+        texts.reserve(uncached.size());
+        for (const auto& paragraph : uncached) {
+            texts.push_back(paragraph.toStdString());
+        }
+        std::vector<float> scores;
+        for (const auto& result : detector->analyzeBatch(texts)) {
+            scores.push_back(static_cast<float>(result.ai_score));
+        }
+        return scores;
     });
     
     watcher->setFuture(future);
 }
 
-void AITextDetectorPanel::onAnalysisComplete(float aiScore, const QString& label) {
-    // Reset button text
+void AITextDetectorPanel::onParagraphsScored(uint64_t request, const std::vector<QString>& paragraphs,
+                                             const std::vector<float>& scores) {
+    analysisRunning_ = false;
+    
+    if (paragraphScores_.size() + static_cast<qsizetype>(paragraphs.size()) > kParagraphCacheLimit) {
+        paragraphScores_.clear();
+    }
+    for (size_t i = 0; i < paragraphs.size() && i < scores.size(); ++i) {
+        paragraphScores_.insert(paragraphs[i], scores[i]);
+    }
+    
+    // A stale run still filled the cache, so the rerun only scores
+    // what changed since it started
+    if (rerunPending_) {
+        startAnalysis();
+    } else if (request == latestRequest_) {
+        renderAnalysis(splitParagraphs(currentText_));
+    }
+}
+
+void AITextDetectorPanel::renderAnalysis(const std::vector<Paragraph>& paragraphs) {
+    // Length-weighted, so a one-paragraph text scores as it always has
+    double weighted = 0.0;
+    double totalLength = 0.0;
+    for (const auto& paragraph : paragraphs) {
+        double length = paragraph.text.size();
+        weighted += paragraphScores_.value(paragraph.text) * length;
+        totalLength += length;
+    }
+    float aiScore = totalLength > 0.0 ? static_cast<float>(weighted / totalLength) : 0.0f;
+    
+    highlightParagraphs(paragraphs);
+    QString label = aiScore >= 0.5f ? "ai_generated" : "human";
+    if (paragraphs.size() > 1) {
+        label += QString(" (%1 paragraphs scored separately)").arg(paragraphs.size());
+    }
+    onAnalysisComplete(aiScore, label);
+}
+
+void AITextDetectorPanel::highlightParagraphs(const std::vector<Paragraph>& paragraphs) {
+    // Extra selections leave the text itself, and textChanged, alone
+    QList<QTextEdit::ExtraSelection> selections;
+    for (const auto& paragraph : paragraphs) {
+        float score = paragraphScores_.value(paragraph.text);
+        if (score < 0.5f) {
+            continue;
+        }
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(textInput_->document());
+        selection.cursor.setPosition(paragraph.start);
+        selection.cursor.setPosition(paragraph.start + paragraph.text.size(), QTextCursor::KeepAnchor);
+        selection.format.setBackground(QColor(score >= 0.8f ? "#f8d7da" : "#fff3cd"));
+        selection.format.setToolTip(QString("AI score: %1%").arg(static_cast<int>(score * 100)));
+        selections.append(selection);
+    }
+    textInput_->setExtraSelections(selections);
+}
+
+void AITextDetectorPanel::stopLoadingAnimation() {
+    if (!loadingTimer_) {
+        return;
+    }
+    loadingTimer_->stop();
+    loadingTimer_->deleteLater();
+    loadingTimer_ = nullptr;
     analyzeButton_->setText("Analyze Text");
+    analyzeButton_->setEnabled(true);
+}
+
+void AITextDetectorPanel::onAnalysisComplete(float aiScore, const QString& label) {
+    // Reset button text and re-enable it
+    stopLoadingAnimation();
     
     // Update UI with results
     updateResults(aiScore, label.toStdString());
     emit analysisComplete(aiScore);
-    
-    // Re-enable UI
-    analyzeButton_->setEnabled(true);
-    clearButton_->setEnabled(true);
-    textInput_->setEnabled(true);
 }
 
 void AITextDetectorPanel::onClearText() {
+    debounceTimer_->stop();
+    // Anything still running for the old text is not shown
+    ++latestRequest_;
+    rerunPending_ = false;
+    stopLoadingAnimation();
     textInput_->clear();
+    textInput_->setExtraSelections({});
     resultLabel_->setText("No analysis yet");
     scoreBar_->setValue(0);
     detailsLabel_->clear();
@@ -1,23 +1,29 @@
 #include "ui/ChatbotPanel.h"
 #include "utils/Logger.h"
 #include "detectors/HiveTextModerator.h"
+#include "network/ResponseParsers.h"
+#include "network/SseDecoder.h"
+#include "utils/JsonWriter.h"
 #include <nlohmann/json.hpp>
 #include <QScrollBar>
 #include <QMessageBox>
 #include <QDateTime>
 #include <QFrame>
 #include <QTimer>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
+#include <QPointer>
 #include <QImageReader>
 #include <QImageWriter>
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QFile>
 #include <QStandardPaths>
 #include <QDir>
 #include <QFileDialog>
 #include <QPushButton>
 #include <QRegularExpression>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 
 namespace ModAI {
@@ -26,6 +32,20 @@ namespace ModAI {
 static const QString AI_GENERATED_MARKER = "ModAI-Generated";
 static const QString METADATA_KEY = "ModAI-Source";
 
+namespace {
+
+std::string sha256Hex(const char* data, size_t size) {
+    return QCryptographicHash::hash(QByteArray::fromRawData(data, static_cast<int>(size)),
+                                    QCryptographicHash::Sha256).toHex().toStdString();
+}
+
+std::string promptCacheKey(const QString& modelId, const QString& prompt) {
+    std::string key = modelId.toStdString() + '\n' + prompt.toStdString();
+    return "prompt:" + sha256Hex(key.data(), key.size());
+}
+
+} // namespace
+
 ChatbotPanel::ChatbotPanel(QWidget* parent)
     : QWidget(parent)
     , chatScrollArea_(nullptr)
@@ -40,6 +60,10 @@ ChatbotPanel::ChatbotPanel(QWidget* parent)
     , httpClient_(nullptr)
     , textModerator_(nullptr) {
     setupUI();
+    renderTimer_ = new QTimer(this);
+    renderTimer_->setSingleShot(true);
+    renderTimer_->setInterval(33);
+    connect(renderTimer_, &QTimer::timeout, this, &ChatbotPanel::renderTurn);
 }
 
 void ChatbotPanel::initialize(std::unique_ptr<HttpClient> httpClient,
@@ -305,6 +329,7 @@ QWidget* ChatbotPanel::createMessageBubble(const QString& message, bool isUser,
     
     // Message text
     auto* messageLabel = new QLabel(message, bubble);
+    messageLabel->setObjectName("messageLabel");  // updated in place while streaming
     messageLabel->setWordWrap(true);
     messageLabel->setTextFormat(Qt::PlainText);
     messageLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
@@ -441,10 +466,10 @@ void ChatbotPanel::scrollToBottom() {
     });
 }
 
-void ChatbotPanel::addMessageToChat(const QString& role, const QString& message, bool blocked) {
+QWidget* ChatbotPanel::addMessageToChat(const QString& role, const QString& message, bool blocked) {
     if (!chatLayout_ || !chatContainer_) {
         // Can't log during initialization before Logger is ready
-        return;
+        return nullptr;
     }
     
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm");
@@ -470,6 +495,7 @@ void ChatbotPanel::addMessageToChat(const QString& role, const QString& message,
     
     // Scroll to bottom
     scrollToBottom();
+    return bubble;
 }
 
 void ChatbotPanel::onSendMessage() {
@@ -494,7 +520,7 @@ void ChatbotPanel::onSendMessage() {
         generateImage(userMessage);
     } else {
         // Store in conversation history (only for text models)
-        conversationHistory_.push_back({"user", userMessage.toStdString()});
+        appendHistory("user", userMessage.toStdString());
         
         // Call LLM
         statusLabel_->setText("Thinking...");
@@ -513,10 +539,84 @@ void ChatbotPanel::onClearChat() {
         }
         delete item;
     }
+    if (turn_) {
+        // The bubble it was streaming into is gone; stop the generation too
+        turn_->cancellation.cancel();
+        turn_.reset();
+        renderTimer_->stop();
+        typingIndicator_ = nullptr;
+        sendButton_->setEnabled(true);
+    }
+    if (imageJobId_ != 0) {
+        // Its bubble is gone too; a finished result stays in the cache
+        imageJob_.cancel();
+        ++imageJobId_;
+        typingIndicator_ = nullptr;
+        sendButton_->setEnabled(true);
+    }
     conversationHistory_.clear();
     statusLabel_->setText("Chat cleared");
 }
 
+void ChatbotPanel::appendHistory(const std::string& role, const std::string& content) {
+    HistoryEntry entry;
+    JsonWriter writer(entry.json);
+    writer.beginObject();
+    writer.key("role");
+    writer.string(role);
+    writer.key("content");
+    writer.string(content);
+    writer.endObject();
+    entry.tokens = (content.size() + 3) / 4 + 4;  // + per-message overhead
+    conversationHistory_.push_back(std::move(entry));
+}
+
+std::string ChatbotPanel::buildChatPayload(const std::string& model) {
+    // Newest messages first, until the budget is spent; the latest one is
+    // always sent. Anything older can never fit again, so it is dropped.
+    size_t budget = kHistoryTokenBudget;
+    size_t first = conversationHistory_.size();
+    while (first > 0) {
+        size_t tokens = conversationHistory_[first - 1].tokens;
+        if (first < conversationHistory_.size() && tokens > budget) {
+            break;
+        }
+        budget -= std::min(budget, tokens);
+        --first;
+    }
+    if (first > 0) {
+        Logger::info("Chat history over budget; dropping " + std::to_string(first) + " oldest messages");
+        conversationHistory_.erase(conversationHistory_.begin(),
+                                   conversationHistory_.begin() + static_cast<std::ptrdiff_t>(first));
+    }
+
+    std::string payload;
+    JsonWriter writer(payload);
+    writer.beginObject();
+    writer.key("model");
+    writer.string(model);
+    writer.key("stream");
+    writer.boolean(true);
+    writer.key("messages");
+    writer.beginArray();
+    writer.beginObject();
+    writer.key("role");
+    writer.string("system");
+    writer.key("content");
+    writer.string("You are a helpful, respectful AI assistant. Provide clear, accurate, and concise responses.");
+    writer.endObject();
+    writer.endArray();
+    writer.endObject();
+    // Splice the cached messages in after the system prompt
+    std::string messages;
+    for (const auto& entry : conversationHistory_) {
+        messages += ',';
+        messages += entry.json;
+    }
+    payload.insert(payload.size() - 2, messages);
+    return payload;
+}
+
 void ChatbotPanel::callLLM(const QString& userMessage) {
     if (!httpClient_) {
         hideTypingIndicator();
@@ -530,135 +630,306 @@ void ChatbotPanel::callLLM(const QString& userMessage) {
         // Get selected model from dropdown
         QString selectedModel = modelSelector_->currentData().toString();
         
-        // Construct request for custom GPT API endpoint
-        nlohmann::json payload;
-        payload["model"] = selectedModel.toStdString();
-        
-        // Add conversation history in OpenAI chat completions format
-        nlohmann::json messages = nlohmann::json::array();
-        messages.push_back({
-            {"role", "system"},
-            {"content", "You are a helpful, respectful AI assistant. Provide clear, accurate, and concise responses."}
-        });
-        
-        for (const auto& [role, content] : conversationHistory_) {
-            messages.push_back({{"role", role}, {"content", content}});
-        }
-        
-        payload["messages"] = messages;
-        
         HttpRequest req;
         req.url = llmEndpoint_;
         req.method = "POST";
         req.headers["Content-Type"] = "application/json";
+        req.headers["Accept"] = "text/event-stream";
         // No Authorization header needed for this free API
-        req.body = payload.dump();
-        
-        Logger::info("Calling GPT API at: " + llmEndpoint_);
+        req.body = buildChatPayload(selectedModel.toStdString());
         
-        // Make request (this should be async in production)
-        HttpResponse response = httpClient_->post(req);
-        
-        hideTypingIndicator();
-        
-        if (!response.success) {
-            addMessageToChat("System", "Error: " + QString::fromStdString(response.errorMessage), true);
-            statusLabel_->setText("LLM Error");
-            sendButton_->setEnabled(true);
-            return;
-        }
-        
-        if (response.statusCode != 200) {
-            addMessageToChat("System", "API Error: Status " + QString::number(response.statusCode), true);
-            statusLabel_->setText("API Error");
-            sendButton_->setEnabled(true);
-            return;
+        if (turn_) {
+            turn_->cancellation.cancel();
         }
+        turn_ = std::make_unique<ChatTurn>();
+        turn_->id = nextTurnId_++;
+        turn_->modelId = selectedModel;
+        req.cancellation = turn_->cancellation.token();
+        uint64_t turnId = turn_->id;
         
-        // Parse response in OpenAI format
-        auto jsonResponse = nlohmann::json::parse(response.body);
-        std::string llmResponse;
+        Logger::info("Calling GPT API at: " + llmEndpoint_);
         
-        // Parse OpenAI chat completions format
-        if (jsonResponse.contains("choices") && !jsonResponse["choices"].empty()) {
-            if (jsonResponse["choices"][0].contains("message") && 
-                jsonResponse["choices"][0]["message"].contains("content")) {
-                llmResponse = jsonResponse["choices"][0]["message"]["content"].get<std::string>();
-            } else {
-                addMessageToChat("System", "Error: Invalid response structure", true);
-                statusLabel_->setText("Parse Error");
-                sendButton_->setEnabled(true);
+        // Chunks arrive on the transport thread: decode them there and hop
+        // to the GUI thread with just the new text, skipping it if the
+        // panel is gone by then
+        QPointer<ChatbotPanel> self(this);
+        auto decoder = std::make_shared<SseDecoder>([self, turnId](const std::string& data) {
+            if (data == "[DONE]") {
                 return;
             }
-        } else {
-            addMessageToChat("System", "Error: Unexpected API response format", true);
-            statusLabel_->setText("Parse Error");
-            sendButton_->setEnabled(true);
-            return;
-        }
-        
-        // Add watermark based on selected model
-        QString modelId = modelSelector_->currentData().toString();
-        QString watermarkedResponse = addWatermark(QString::fromStdString(llmResponse), modelId);
-        std::string watermarkedStdString = watermarkedResponse.toStdString();
-        
-        // Debug: Log watermark info
-        Logger::info("Added watermark for model: " + modelId.toStdString() + ", text length: " + 
-                    std::to_string(watermarkedResponse.length()) + " (original: " + 
-                    std::to_string(llmResponse.length()) + ")");
-        
-        // Moderate the LLM response
-        statusLabel_->setText("Moderating response...");
-        bool passed = moderateResponse(llmResponse);
-        
-        if (passed) {
-            addMessageToChat("Assistant", watermarkedResponse);
-            conversationHistory_.push_back({"assistant", watermarkedStdString});
-            statusLabel_->setText("Response sent");
-            emit moderationResult(watermarkedResponse, true);
-        } else {
-            // Show blocked message with actual content (hidden by default)
-            addMessageToChat("Assistant", watermarkedResponse, true);
-            statusLabel_->setText("Response blocked");
-            emit messageBlocked("Content failed moderation");
-            emit moderationResult(watermarkedResponse, false);
-        }
+            // Servers that ignore "stream" send one whole message instead;
+            // the parser reads either
+            auto parsed = parseChatDelta(data);
+            if (!parsed) {
+                MODAI_LOG_DEBUG("Skipping unreadable chat stream event");
+                return;
+            }
+            std::string delta = std::move(*parsed);
+            if (delta.empty() || !self) {
+                return;
+            }
+            QMetaObject::invokeMethod(self.data(), [self, turnId, delta = std::move(delta)]() {
+                if (self) {
+                    self->onStreamDelta(turnId, delta);
+                }
+            }, Qt::QueuedConnection);
+        });
+        httpClient_->streamAsync(req,
+            [decoder](const char* data, size_t size) { decoder->feed(data, size); },
+            [self, decoder, turnId](HttpResponse response) {
+                decoder->finish();
+                if (!self) {
+                    return;
+                }
+                QMetaObject::invokeMethod(self.data(), [self, turnId, response]() {
+                    if (self) {
+                        self->onStreamFinished(turnId, response);
+                    }
+                }, Qt::QueuedConnection);
+            });
         
+        // Checked while the model is already generating; nothing is shown
+        // until it clears
+        moderateAsync(turnId, userMessage.toStdString(), true);
     } catch (const std::exception& e) {
+        hideTypingIndicator();
         addMessageToChat("System", "Exception: " + QString::fromStdString(e.what()), true);
         statusLabel_->setText("Error");
         Logger::error("Chatbot error: " + std::string(e.what()));
+        sendButton_->setEnabled(true);
     }
-    
-    sendButton_->setEnabled(true);
 }
 
-bool ChatbotPanel::moderateResponse(const std::string& response) {
-    if (!textModerator_) {
-        Logger::warn("No text moderator available - allowing response");
-        return true;
+void ChatbotPanel::moderateAsync(uint64_t turnId, std::string text, bool prompt, size_t segmentEnd) {
+    turn_->moderationsPending++;
+    QPointer<ChatbotPanel> self(this);
+    auto moderator = textModerator_;
+    CancellationToken token = turn_->cancellation.token();
+    QtConcurrent::run([self, moderator, token, turnId, text = std::move(text), prompt, segmentEnd]() {
+        bool passed = true;
+        if (!moderator) {
+            Logger::warn("No text moderator available - allowing response");
+        } else if (!token.stopRequested()) {
+            CancellationScope scope(token);
+            try {
+                // Block if any category scores above 0.2
+                const double threshold = 0.2;
+                auto result = moderator->analyzeText(text);
+                for (const auto& [category, score] : result.labels) {
+                    if (score > threshold) {
+                        Logger::info(std::string(prompt ? "Chat prompt" : "LLM response") + " blocked - " +
+                                     category + ": " + std::to_string(score));
+                        passed = false;
+                        break;
+                    }
+                }
+            } catch (const std::exception& e) {
+                Logger::error("Moderation error: " + std::string(e.what()));
+                // Fail closed - block on error
+                passed = false;
+            }
+        }
+        if (!self) {
+            return;
+        }
+        QMetaObject::invokeMethod(self.data(), [self, turnId, prompt, segmentEnd, passed]() {
+            if (self) {
+                self->onModerated(turnId, prompt, segmentEnd, passed);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ChatbotPanel::onStreamDelta(uint64_t turnId, const std::string& delta) {
+    if (!turn_ || turn_->id != turnId) {
+        return;
     }
-    
-    try {
-        // Use Hive API to moderate the text
-        auto result = textModerator_->analyzeText(response);
-        
-        // Check if any category exceeds threshold
-        // Lower threshold to catch more potentially harmful content
-        const float threshold = 0.2f; // Block if score > 0.2 (20%)
-        
-        for (const auto& [category, score] : result.labels) {
-            if (score > threshold) {
-                Logger::info("LLM response blocked - " + category + ": " + std::to_string(score));
-                return false;
+    turn_->text += delta;
+    // Shown once moderated, by segmentPassed()
+    moderatePendingText(false);
+}
+
+void ChatbotPanel::moderatePendingText(bool all) {
+    const std::string& text = turn_->text;
+    size_t end = text.size();
+    if (!all) {
+        // Up to the last sentence end (.!? followed by whitespace, or a newline)
+        end = turn_->moderatedUpTo;
+        for (size_t i = turn_->moderatedUpTo; i + 1 < text.size(); ++i) {
+            char c = text[i];
+            bool boundary = c == '\n' ||
+                ((c == '.' || c == '!' || c == '?') && std::isspace(static_cast<unsigned char>(text[i + 1])));
+            if (boundary) {
+                end = i + 1;
             }
         }
-        
-        return true;
-    } catch (const std::exception& e) {
-        Logger::error("Moderation error: " + std::string(e.what()));
-        // Fail closed - block on error
-        return false;
+    }
+    if (end <= turn_->moderatedUpTo) {
+        return;
+    }
+    std::string segment = text.substr(turn_->moderatedUpTo, end - turn_->moderatedUpTo);
+    turn_->moderatedUpTo = end;
+    turn_->segments.push_back({end, false});
+    if (segment.find_first_not_of(" \t\r\n") == std::string::npos) {
+        segmentPassed(end);
+        return;
+    }
+    moderateAsync(turn_->id, std::move(segment), false, end);
+}
+
+void ChatbotPanel::segmentPassed(size_t segmentEnd) {
+    auto& segments = turn_->segments;
+    for (auto& segment : segments) {
+        if (segment.end == segmentEnd) {
+            segment.passed = true;
+            break;
+        }
+    }
+    size_t before = turn_->passedUpTo;
+    while (!segments.empty() && segments.front().passed) {
+        turn_->passedUpTo = segments.front().end;
+        segments.pop_front();
+    }
+    if (turn_->passedUpTo > before && turn_->promptCleared && !renderTimer_->isActive()) {
+        renderTimer_->start();
+    }
+}
+
+void ChatbotPanel::renderTurn() {
+    // Only text whose moderation (and that of everything before it) passed
+    if (!turn_ || !turn_->promptCleared || turn_->passedUpTo == 0) {
+        return;
+    }
+    QString shown = QString::fromStdString(turn_->text.substr(0, turn_->passedUpTo));
+    if (!turn_->bubble) {
+        hideTypingIndicator();
+        statusLabel_->setText("Receiving response...");
+        turn_->bubble = addMessageToChat("Assistant", shown);
+        return;
+    }
+    if (auto* label = turn_->bubble->findChild<QLabel*>("messageLabel")) {
+        label->setText(shown);
+        scrollToBottom();
+    }
+}
+
+void ChatbotPanel::onStreamFinished(uint64_t turnId, const HttpResponse& response) {
+    if (!turn_ || turn_->id != turnId) {
+        return;
+    }
+    if (!response.success && !response.cancelled && turn_->text.empty()) {
+        failTurn("Error: " + QString::fromStdString(response.errorMessage), "LLM Error");
+        return;
+    }
+    if (response.statusCode != 200 && response.statusCode != 0) {
+        failTurn("API Error: Status " + QString::number(response.statusCode), "API Error");
+        return;
+    }
+    if (turn_->text.empty()) {
+        failTurn("Error: Unexpected API response format", "Parse Error");
+        return;
+    }
+    turn_->streamDone = true;
+    moderatePendingText(true);
+    if (turn_->promptCleared) {
+        statusLabel_->setText("Moderating response...");
+    }
+    finishTurnIfDone();
+}
+
+void ChatbotPanel::onModerated(uint64_t turnId, bool prompt, size_t segmentEnd, bool passed) {
+    if (!turn_ || turn_->id != turnId) {
+        return;
+    }
+    turn_->moderationsPending--;
+    if (!passed) {
+        blockTurn(prompt);
+        return;
+    }
+    if (prompt) {
+        turn_->promptCleared = true;
+        renderTurn();
+    } else {
+        segmentPassed(segmentEnd);
+    }
+    finishTurnIfDone();
+}
+
+void ChatbotPanel::blockTurn(bool prompt) {
+    // Stops the generation and any moderation still queued for it
+    turn_->cancellation.cancel();
+    hideTypingIndicator();
+    if (turn_->bubble) {
+        chatLayout_->removeWidget(turn_->bubble);
+        turn_->bubble->deleteLater();
+        turn_->bubble = nullptr;
+    }
+    if (prompt) {
+        // The prompt stays out of the context sent next time
+        if (!conversationHistory_.empty()) {
+            conversationHistory_.pop_back();
+        }
+        addMessageToChat("System", "Message blocked by safety filter", true);
+        emit messageBlocked("Prompt failed moderation");
+    } else {
+        QString watermarked = addWatermark(QString::fromStdString(turn_->text), turn_->modelId);
+        // Show blocked message with actual content (hidden by default)
+        addMessageToChat("Assistant", watermarked, true);
+        emit messageBlocked("Content failed moderation");
+        emit moderationResult(watermarked, false);
+    }
+    endTurn("Response blocked");
+}
+
+void ChatbotPanel::finishTurnIfDone() {
+    if (!turn_->streamDone || !turn_->promptCleared || turn_->moderationsPending > 0) {
+        return;
+    }
+    // Add watermark based on the model the request was sent to
+    QString watermarked = addWatermark(QString::fromStdString(turn_->text), turn_->modelId);
+    Logger::info("Added watermark for model: " + turn_->modelId.toStdString() + ", text length: " +
+                 std::to_string(watermarked.length()) + " (original: " +
+                 std::to_string(turn_->text.length()) + ")");
+    renderTimer_->stop();
+    if (!turn_->bubble) {
+        hideTypingIndicator();
+        addMessageToChat("Assistant", watermarked);
+    } else if (auto* label = turn_->bubble->findChild<QLabel*>("messageLabel")) {
+        label->setText(watermarked);
+    }
+    appendHistory("assistant", watermarked.toStdString());
+    emit moderationResult(watermarked, true);
+    endTurn("Response sent");
+}
+
+void ChatbotPanel::failTurn(const QString& message, const QString& status) {
+    turn_->cancellation.cancel();
+    hideTypingIndicator();
+    addMessageToChat("System", message, true);
+    endTurn(status);
+}
+
+void ChatbotPanel::endTurn(const QString& status) {
+    renderTimer_->stop();
+    turn_.reset();
+    statusLabel_->setText(status);
+    sendButton_->setEnabled(true);
+}
+
+std::shared_ptr<const ChatbotPanel::GeneratedImage> ChatbotPanel::GeneratedImageCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : it->second;
+}
+
+void ChatbotPanel::GeneratedImageCache::insert(const std::string& key, std::shared_ptr<const GeneratedImage> image) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.insert_or_assign(key, std::move(image)).second) {
+        order_.push_back(key);
+    }
+    while (order_.size() > kCapacity) {
+        entries_.erase(order_.front());
+        order_.pop_front();
     }
 }
 
@@ -671,80 +942,253 @@ void ChatbotPanel::generateImage(const QString& prompt) {
         return;
     }
     
-    try {
-        QString selectedModel = modelSelector_->currentData().toString();
-        QString modelDisplayName = modelSelector_->currentText();
-        
-        // Construct request for Nebius image API
-        nlohmann::json payload;
-        payload["model"] = selectedModel.toStdString();
-        payload["prompt"] = prompt.toStdString();
-        
-        HttpRequest req;
-        req.url = "https://api.tokenfactory.nebius.com/v1/images/generations";
-        req.method = "POST";
-        req.headers["Content-Type"] = "application/json";
-        req.headers["Accept"] = "*/*";
-        
-        // Get API key from environment
-        const char* apiKey = std::getenv("NEBIUS_API_KEY");
-        if (!apiKey || std::string(apiKey).empty()) {
-            hideTypingIndicator();
-            addMessageToChat("System", "Error: NEBIUS_API_KEY environment variable not set", true);
-            sendButton_->setEnabled(true);
-            statusLabel_->setText("API key missing");
-            return;
-        }
-        req.headers["Authorization"] = "Bearer " + std::string(apiKey);
-        req.body = payload.dump();
-        
-        Logger::info("Calling Nebius Image API with model: " + selectedModel.toStdString());
-        
-        HttpResponse response = httpClient_->post(req);
-        
-        if (response.statusCode != 200) {
-            hideTypingIndicator();
-            addMessageToChat("System", "API Error: Status " + QString::number(response.statusCode), true);
-            statusLabel_->setText("API Error");
-            sendButton_->setEnabled(true);
+    QString selectedModel = modelSelector_->currentData().toString();
+    QString modelDisplayName = modelSelector_->currentText();
+    std::string promptKey = promptCacheKey(selectedModel, prompt);
+    
+    imageJob_.cancel();
+    imageJob_ = CancellationSource();
+    uint64_t jobId = ++imageJobId_;
+    
+    // The same prompt to the same model shows the image it got last time
+    if (auto cached = imageCache_->find(promptKey)) {
+        Logger::info("Reusing generated image for repeated prompt");
+        onImageReady(jobId, addImageToChat(prompt), prompt, modelDisplayName, cached, true);
+        return;
+    }
+    
+    // Get API key from environment
+    const char* apiKey = std::getenv("NEBIUS_API_KEY");
+    if (!apiKey || std::string(apiKey).empty()) {
+        hideTypingIndicator();
+        addMessageToChat("System", "Error: NEBIUS_API_KEY environment variable not set", true);
+        sendButton_->setEnabled(true);
+        statusLabel_->setText("API key missing");
+        return;
+    }
+    
+    // Construct request for Nebius image API
+    nlohmann::json payload;
+    payload["model"] = selectedModel.toStdString();
+    payload["prompt"] = prompt.toStdString();
+    
+    HttpRequest req;
+    req.url = "https://api.tokenfactory.nebius.com/v1/images/generations";
+    req.method = "POST";
+    req.headers["Content-Type"] = "application/json";
+    req.headers["Accept"] = "*/*";
+    req.headers["Authorization"] = "Bearer " + std::string(apiKey);
+    req.body = payload.dump();
+    req.cancellation = imageJob_.token();
+    
+    Logger::info("Calling Nebius Image API with model: " + selectedModel.toStdString());
+    
+    // The chat stays usable while the image is generated, downloaded and
+    // moderated; each step hops back here only to update the bubble
+    ImageBubble bubble = addImageToChat(prompt);
+    QPointer<ChatbotPanel> self(this);
+    httpClient_->postAsync(req, [self, jobId, bubble, prompt, selectedModel, modelDisplayName](HttpResponse response) {
+        if (!self) {
             return;
         }
-        
-        // Parse response
+        QMetaObject::invokeMethod(self.data(), [self, jobId, bubble, prompt, selectedModel, modelDisplayName, response]() {
+            if (self) {
+                self->onImageUrl(jobId, bubble, prompt, selectedModel, modelDisplayName, response);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ChatbotPanel::onImageUrl(uint64_t jobId, ImageBubble bubble, QString prompt, QString modelId,
+                              QString modelName, const HttpResponse& response) {
+    if (jobId != imageJobId_) {
+        return;
+    }
+    if (!response.success || response.statusCode != 200) {
+        QString message = response.statusCode > 0 ? "API Error: Status " + QString::number(response.statusCode)
+                                                  : "API Error: " + QString::fromStdString(response.errorMessage);
+        onImageFailed(jobId, bubble, message, QString(), "API Error");
+        return;
+    }
+    
+    std::string imageUrl;
+    try {
         auto jsonResponse = nlohmann::json::parse(response.body);
-        
         if (jsonResponse.contains("data") && !jsonResponse["data"].empty()) {
-            std::string imageUrl = jsonResponse["data"][0]["url"].get<std::string>();
-            Logger::info("Image generated: " + imageUrl);
-            
-            // Download and moderate the image
-            statusLabel_->setText("Moderating image...");
-            addImageToChat(QString::fromStdString(imageUrl), prompt, false);
-        } else {
-            hideTypingIndicator();
-            addMessageToChat("System", "Error: No image in response", true);
-            statusLabel_->setText("Generation failed");
+            imageUrl = jsonResponse["data"][0]["url"].get<std::string>();
         }
-        
     } catch (const std::exception& e) {
-        hideTypingIndicator();
-        addMessageToChat("System", "Exception: " + QString::fromStdString(e.what()), true);
-        statusLabel_->setText("Error");
         Logger::error("Image generation error: " + std::string(e.what()));
     }
-    
-    sendButton_->setEnabled(true);
+    if (imageUrl.empty()) {
+        onImageFailed(jobId, bubble, "Error: No image in response", QString(), "Generation failed");
+        return;
+    }
+    Logger::info("Image generated: " + imageUrl);
+    statusLabel_->setText("Moderating image...");
+    
+    // The body is collected as it arrives and handed to the moderator
+    // without another copy
+    HttpRequest req;
+    req.url = imageUrl;
+    req.method = "GET";
+    req.cancellation = imageJob_.token();
+    
+    auto buffer = std::make_shared<QByteArray>();
+    auto overflow = std::make_shared<bool>(false);
+    QPointer<ChatbotPanel> self(this);
+    auto moderator = imageModerator_;
+    auto cache = imageCache_;
+    CancellationToken token = imageJob_.token();
+    std::string promptKey = promptCacheKey(modelId, prompt);
+    QString url = QString::fromStdString(imageUrl);
+    
+    httpClient_->streamAsync(req,
+        [buffer, overflow](const char* data, size_t size) {
+            if (*overflow || static_cast<uint64_t>(buffer->size()) + size > kMaxGeneratedImageBytes) {
+                *overflow = true;
+                return;
+            }
+            buffer->append(data, static_cast<int>(size));
+        },
+        [self, jobId, bubble, prompt, modelId, modelName, url, buffer, overflow, moderator, cache, token,
+         promptKey](HttpResponse response) {
+            if (!self) {
+                return;
+            }
+            auto fail = [self, jobId, bubble, url](QString message) {
+                QMetaObject::invokeMethod(self.data(), [self, jobId, bubble, url, message]() {
+                    if (self) {
+                        self->onImageFailed(jobId, bubble, message, url, "Download failed");
+                    }
+                }, Qt::QueuedConnection);
+            };
+            if (!response.success || *overflow || buffer->isEmpty()) {
+                std::string reason = *overflow ? "image exceeds " + std::to_string(kMaxGeneratedImageBytes) + " bytes"
+                                               : response.errorMessage;
+                Logger::error("Image download error: " + reason);
+                fail("Could not load image");
+                return;
+            }
+            SharedBytes bytes = SharedBytes::fromQByteArray(*buffer);
+            QtConcurrent::run([self, jobId, bubble, prompt, modelId, modelName, bytes, moderator, cache, token,
+                               promptKey]() {
+                if (token.stopRequested()) {
+                    return;
+                }
+                auto image = processGeneratedImage(bytes, modelId, promptKey, moderator.get(), *cache);
+                if (!self) {
+                    return;
+                }
+                QMetaObject::invokeMethod(self.data(), [self, jobId, bubble, prompt, modelName, image]() {
+                    if (self) {
+                        self->onImageReady(jobId, bubble, prompt, modelName, image, false);
+                    }
+                }, Qt::QueuedConnection);
+            });
+        });
 }
 
-bool ChatbotPanel::moderateImage(const QByteArray& imageData, const QString& mimeType) {
-    if (!imageModerator_) {
+std::shared_ptr<const ChatbotPanel::GeneratedImage> ChatbotPanel::processGeneratedImage(
+    const SharedBytes& bytes, const QString& modelId, const std::string& promptKey,
+    ImageModerator* moderator, GeneratedImageCache& cache) {
+    const char* raw = reinterpret_cast<const char*>(bytes.data());
+    std::string imageKey = "image:" + sha256Hex(raw, bytes.size());
+    if (auto known = cache.find(imageKey)) {
+        MODAI_LOG_DEBUG("Generated image already moderated; reusing the result");
+        cache.insert(promptKey, known);
+        return known;
+    }
+    
+    auto image = std::make_shared<GeneratedImage>();
+    std::optional<bool> verdict;
+    if (!moderator) {
         Logger::warn("Image moderator not configured - skipping moderation");
-        return true; // Allow if no moderator
+        verdict = true;
+    } else {
+        verdict = moderateImage(moderator, bytes);
+    }
+    // Fail closed
+    image->passed = verdict.value_or(false);
+    
+    // Wraps the downloaded buffer; it stays alive as long as bytes does
+    QByteArray imageData = QByteArray::fromRawData(raw, static_cast<int>(bytes.size()));
+    QByteArray imageWithMetadata = embedImageMetadata(imageData, modelId);
+    image->data = imageWithMetadata.isEmpty() ? QByteArray(raw, static_cast<int>(bytes.size())) : imageWithMetadata;
+    
+    QImage decoded;
+    decoded.loadFromData(image->data);
+    if (decoded.isNull()) {
+        QBuffer buffer;
+        buffer.setData(imageData);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        reader.setAutoDetectImageFormat(true);
+        decoded = reader.read();
+    }
+    if (!decoded.isNull()) {
+        image->thumbnail = decoded.scaled(380, 380, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    
+    if (image->passed && !image->thumbnail.isNull()) {
+        // Save the watermarked image locally (auto-save)
+        QString savePath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/generated_images";
+        QDir().mkpath(savePath);
+        QString autoSaveFilename = savePath + "/" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".png";
+        QFile file(autoSaveFilename);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(image->data);
+            file.close();
+            Logger::info("Saved watermarked image to: " + autoSaveFilename.toStdString());
+        }
     }
     
+    // A verdict reached without the moderator is not worth remembering
+    if (moderator && verdict.has_value()) {
+        cache.insert(imageKey, image);
+        cache.insert(promptKey, image);
+    }
+    return image;
+}
+
+void ChatbotPanel::onImageReady(uint64_t jobId, ImageBubble bubble, QString prompt, QString modelName,
+                                std::shared_ptr<const GeneratedImage> image, bool cached) {
+    if (jobId != imageJobId_) {
+        return;
+    }
+    hideTypingIndicator();
+    sendButton_->setEnabled(true);
+    showGeneratedImage(bubble, prompt, modelName, image);
+    if (cached && image->passed) {
+        statusLabel_->setText("Image generated (cached)");
+    }
+    scrollToBottom();
+}
+
+void ChatbotPanel::onImageFailed(uint64_t jobId, ImageBubble bubble, const QString& message,
+                                 const QString& imageUrl, const QString& status) {
+    if (jobId != imageJobId_) {
+        return;
+    }
+    hideTypingIndicator();
+    sendButton_->setEnabled(true);
+    statusLabel_->setText(status);
+    if (!bubble.imageLabel) {
+        return;
+    }
+    if (imageUrl.isEmpty()) {
+        bubble.imageLabel->setText(message);
+    } else {
+        bubble.imageLabel->setText(message + "\n<a href='" + imageUrl + "' style='color: #0066cc;'>Open in browser</a>");
+        bubble.imageLabel->setOpenExternalLinks(true);
+    }
+    bubble.imageLabel->setMinimumSize(200, 50);
+    scrollToBottom();
+}
+
+std::optional<bool> ChatbotPanel::moderateImage(ImageModerator* moderator, const SharedBytes& imageData) {
     try {
-        std::vector<uint8_t> imageBytes(imageData.begin(), imageData.end());
-        auto result = imageModerator_->analyzeImage(imageBytes, mimeType.toStdString());
+        auto result = moderator->analyzeImage(imageData);
         
         // Define harmful categories to check - all "yes_*" and positive indicators
         static const std::vector<std::string> harmfulCategories = {
@@ -820,10 +1264,10 @@ bool ChatbotPanel::moderateImage(const QByteArray& imageData, const QString& mim
         };
         
         // Log all labels for debugging (exclude no_ labels which indicate safe content)
-        Logger::debug("Hive Visual Moderation labels (score > 0.1):");
+        MODAI_LOG_DEBUG("Hive Visual Moderation labels (score > 0.1):");
         for (const auto& [category, score] : result.labels) {
             if (score > 0.1 && category.substr(0, 3) != "no_") {
-                Logger::debug("  " + category + ": " + std::to_string(score));
+                MODAI_LOG_DEBUG("  " + category + ": " + std::to_string(score));
             }
         }
         
@@ -846,7 +1290,7 @@ bool ChatbotPanel::moderateImage(const QByteArray& imageData, const QString& mim
         return true;
     } catch (const std::exception& e) {
         Logger::error("Image moderation error: " + std::string(e.what()));
-        return false; // Fail closed
+        return std::nullopt;  // callers fail closed
     }
 }
 
@@ -982,7 +1426,7 @@ void ChatbotPanel::addBlockedImageToChat(const QString& prompt, const QString& r
     emit imageBlocked(reason);
 }
 
-void ChatbotPanel::addImageToChat(const QString& imageUrl, const QString& prompt, bool blocked) {
+ChatbotPanel::ImageBubble ChatbotPanel::addImageToChat(const QString& prompt) {
     // Create image bubble - styled like assistant chat bubble (left-aligned, white)
     auto* bubbleContainer = new QWidget(chatContainer_);
     auto* containerLayout = new QHBoxLayout(bubbleContainer);
@@ -999,7 +1443,7 @@ void ChatbotPanel::addImageToChat(const QString& imageUrl, const QString& prompt
     auto* imageLabel = new QLabel(bubble);
     imageLabel->setAlignment(Qt::AlignCenter);
     imageLabel->setMinimumSize(300, 200);
-    imageLabel->setText("Loading and moderating...");
+    imageLabel->setText("Generating and moderating...");
     imageLabel->setStyleSheet(
         "QLabel { "
         "  background-color: #f5f5f5; "
@@ -1073,286 +1517,179 @@ void ChatbotPanel::addImageToChat(const QString& imageUrl, const QString& prompt
     
     chatLayout_->addWidget(bubbleContainer);
     chatLayout_->addStretch();
+    scrollToBottom();
     
-    // Get model info for metadata
-    QString selectedModel = modelSelector_->currentData().toString();
-    QString modelName = modelSelector_->currentText();
-    
-    // Download, moderate, and display image asynchronously
-    QNetworkAccessManager* manager = new QNetworkAccessManager(this);
-    QNetworkRequest request{QUrl(imageUrl)};
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    return ImageBubble{bubble, imageLabel, sourceLabel, downloadBtn};
+}
+
+void ChatbotPanel::showGeneratedImage(const ImageBubble& target, const QString& prompt, const QString& modelName,
+                                      std::shared_ptr<const GeneratedImage> result) {
+    if (!target.bubble || !target.imageLabel || !target.sourceLabel || !target.downloadBtn) {
+        return;  // Chat was cleared meanwhile
+    }
+    QFrame* bubble = target.bubble;
+    QLabel* imageLabel = target.imageLabel;
+    QLabel* sourceLabel = target.sourceLabel;
+    QPushButton* downloadBtn = target.downloadBtn;
+    QByteArray finalImageData = result->data;
+    
+    // Save Image, shown with the image (for a blocked one, on Show Anyway)
+    connect(downloadBtn, &QPushButton::clicked, [finalImageData, prompt, passed = result->passed]() {
+        // Create a sanitized filename from prompt
+        QString safeName = prompt.left(30).simplified();
+        safeName.replace(QRegularExpression("[^a-zA-Z0-9 ]"), "");
+        safeName.replace(" ", "_");
+        if (safeName.isEmpty()) safeName = "generated_image";
+        
+        QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) 
+            + "/" + safeName + ".png";
+        
+        QString filename = QFileDialog::getSaveFileName(
+            nullptr,
+            "Save Image",
+            defaultPath,
+            "PNG Image (*.png);;JPEG Image (*.jpg);;All Files (*)"
+        );
+        
+        if (!filename.isEmpty()) {
+            QFile saveFile(filename);
+            if (saveFile.open(QIODevice::WriteOnly)) {
+                saveFile.write(finalImageData);
+                saveFile.close();
+                Logger::info(std::string(passed ? "User saved image to: " : "User saved blocked image to: ") +
+                         filename.toStdString());
+            }
+        }
+    });
     
-    connect(manager, &QNetworkAccessManager::finished, 
-            [this, imageLabel, sourceLabel, downloadBtn, imageUrl, prompt, bubbleContainer, bubble, manager, selectedModel, modelName](QNetworkReply* reply) {
-        hideTypingIndicator();
+    if (!result->passed) {
+        // Image blocked - update bubble to show blocked state with "Show Anyway" option
+        imageLabel->setText("[Image blocked by Hive moderation]\n\nThe generated image was flagged for potentially inappropriate content.");
+        imageLabel->setWordWrap(true);
+        imageLabel->setAlignment(Qt::AlignCenter);
+        imageLabel->setStyleSheet(
+            "QLabel { "
+            "  background-color: #ffebee; "
+            "  border-radius: 12px; "
+            "  padding: 20px; "
+            "  color: #c62828; "
+            "  font-weight: bold; "
+            "  font-size: 11pt; "
+            "}"
+        );
+        bubble->setStyleSheet(
+            "QFrame { "
+            "  background-color: #ffebee; "
+            "  color: #c62828; "
+            "  border-radius: 18px; "
+            "  border: none; "
+            "}"
+        );
         
-        if (reply->error() == QNetworkReply::NoError) {
-            QByteArray imageData = reply->readAll();
-            
-            // Determine MIME type
-            QString mimeType = "image/webp";
-            if (imageUrl.toLower().endsWith(".png")) {
-                mimeType = "image/png";
-            } else if (imageUrl.toLower().endsWith(".jpg") || imageUrl.toLower().endsWith(".jpeg")) {
-                mimeType = "image/jpeg";
+        // Add "Show Anyway" button
+        auto* showAnywayBtn = new QPushButton("Show Anyway", bubble);
+        showAnywayBtn->setStyleSheet(
+            "QPushButton { "
+            "  background-color: #ef5350; "
+            "  color: white; "
+            "  border: none; "
+            "  border-radius: 12px; "
+            "  padding: 8px 16px; "
+            "  font-size: 10pt; "
+            "}"
+            "QPushButton:hover { background-color: #e53935; }"
+        );
+        qobject_cast<QVBoxLayout*>(bubble->layout())->insertWidget(1, showAnywayBtn, 0, Qt::AlignCenter);
+        
+        // Add "Hide Image" button (hidden initially)
+        auto* hideImageBtn = new QPushButton("Hide Image", bubble);
+        hideImageBtn->setStyleSheet(
+            "QPushButton { "
+            "  background-color: #78909c; "
+            "  color: white; "
+            "  border: none; "
+            "  border-radius: 12px; "
+            "  padding: 8px 16px; "
+            "  font-size: 10pt; "
+            "}"
+            "QPushButton:hover { background-color: #546e7a; }"
+        );
+        qobject_cast<QVBoxLayout*>(bubble->layout())->insertWidget(2, hideImageBtn, 0, Qt::AlignCenter);
+        hideImageBtn->hide();
+        
+        // Connect show anyway button (bypassing moderation)
+        connect(showAnywayBtn, &QPushButton::clicked, [this, result, imageLabel, sourceLabel, downloadBtn, showAnywayBtn, hideImageBtn, modelName]() {
+            if (result->thumbnail.isNull()) {
+                return;
             }
+            imageLabel->setPixmap(QPixmap::fromImage(result->thumbnail));
+            imageLabel->setStyleSheet("QLabel { background: transparent; }");
             
-            // Moderate the image
-            bool passedModeration = moderateImage(imageData, mimeType);
+            sourceLabel->setText("Generated by: " + modelName + " (unmoderated)");
+            sourceLabel->setStyleSheet("color: #c62828; font-size: 9pt;");
+            sourceLabel->show();
             
-            if (!passedModeration) {
-                // Image blocked - update bubble to show blocked state with "Show Anyway" option
-                imageLabel->setText("[Image blocked by Hive moderation]\n\nThe generated image was flagged for potentially inappropriate content.");
-                imageLabel->setWordWrap(true);
-                imageLabel->setAlignment(Qt::AlignCenter);
-                imageLabel->setStyleSheet(
-                    "QLabel { "
-                    "  background-color: #ffebee; "
-                    "  border-radius: 12px; "
-                    "  padding: 20px; "
-                    "  color: #c62828; "
-                    "  font-weight: bold; "
-                    "  font-size: 11pt; "
-                    "}"
-                );
-                bubble->setStyleSheet(
-                    "QFrame { "
-                    "  background-color: #ffebee; "
-                    "  color: #c62828; "
-                    "  border-radius: 18px; "
-                    "  border: none; "
-                    "}"
-                );
-                
-                // Add "Show Anyway" button
-                auto* showAnywayBtn = new QPushButton("Show Anyway", bubble);
-                showAnywayBtn->setStyleSheet(
-                    "QPushButton { "
-                    "  background-color: #ef5350; "
-                    "  color: white; "
-                    "  border: none; "
-                    "  border-radius: 12px; "
-                    "  padding: 8px 16px; "
-                    "  font-size: 10pt; "
-                    "}"
-                    "QPushButton:hover { background-color: #e53935; }"
-                );
-                qobject_cast<QVBoxLayout*>(bubble->layout())->insertWidget(1, showAnywayBtn, 0, Qt::AlignCenter);
-                
-                // Add "Hide Image" button (hidden initially)
-                auto* hideImageBtn = new QPushButton("Hide Image", bubble);
-                hideImageBtn->setStyleSheet(
-                    "QPushButton { "
-                    "  background-color: #78909c; "
-                    "  color: white; "
-                    "  border: none; "
-                    "  border-radius: 12px; "
-                    "  padding: 8px 16px; "
-                    "  font-size: 10pt; "
-                    "}"
-                    "QPushButton:hover { background-color: #546e7a; }"
-                );
-                qobject_cast<QVBoxLayout*>(bubble->layout())->insertWidget(2, hideImageBtn, 0, Qt::AlignCenter);
-                hideImageBtn->hide();
-                
-                // Connect show anyway button
-                connect(showAnywayBtn, &QPushButton::clicked, [this, imageLabel, sourceLabel, downloadBtn, showAnywayBtn, hideImageBtn, bubble, imageData, selectedModel, modelName, prompt]() {
-                    // Embed metadata and display (bypassing moderation)
-                    QByteArray imageWithMetadata = embedImageMetadata(imageData, selectedModel);
-                    
-                    QImage image;
-                    image.loadFromData(imageWithMetadata.isEmpty() ? imageData : imageWithMetadata);
-                    
-                    if (image.isNull()) {
-                        QBuffer buffer;
-                        buffer.setData(imageData);
-                        buffer.open(QIODevice::ReadOnly);
-                        QImageReader reader(&buffer);
-                        reader.setAutoDetectImageFormat(true);
-                        image = reader.read();
-                    }
-                    
-                    if (!image.isNull()) {
-                        QPixmap pixmap = QPixmap::fromImage(image);
-                        QPixmap scaled = pixmap.scaled(380, 380, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                        imageLabel->setPixmap(scaled);
-                        imageLabel->setStyleSheet("QLabel { background: transparent; }");
-                        
-                        sourceLabel->setText("Generated by: " + modelName + " (unmoderated)");
-                        sourceLabel->setStyleSheet("color: #c62828; font-size: 9pt;");
-                        sourceLabel->show();
-                        
-                        // Toggle buttons
-                        showAnywayBtn->hide();
-                        hideImageBtn->show();
-                        
-                        // Setup download button
-                        QByteArray finalImageData = imageWithMetadata.isEmpty() ? imageData : imageWithMetadata;
-                        downloadBtn->show();
-                        connect(downloadBtn, &QPushButton::clicked, [finalImageData, prompt]() {
-                            QString safeName = prompt.left(30).simplified();
-                            safeName.replace(QRegularExpression("[^a-zA-Z0-9 ]"), "");
-                            safeName.replace(" ", "_");
-                            if (safeName.isEmpty()) safeName = "generated_image";
-                            
-                            QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) 
-                                + "/" + safeName + ".png";
-                            
-                            QString filename = QFileDialog::getSaveFileName(
-                                nullptr, "Save Image", defaultPath,
-                                "PNG Image (*.png);;JPEG Image (*.jpg);;All Files (*)"
-                            );
-                            
-                            if (!filename.isEmpty()) {
-                                QFile saveFile(filename);
-                                if (saveFile.open(QIODevice::WriteOnly)) {
-                                    saveFile.write(finalImageData);
-                                    saveFile.close();
-                                    Logger::info("User saved blocked image to: " + filename.toStdString());
-                                }
-                            }
-                        });
-                        
-                        statusLabel_->setText("Showing blocked image");
-                        Logger::info("User chose to view blocked image");
-                    }
-                });
-                
-                // Connect hide image button
-                connect(hideImageBtn, &QPushButton::clicked, [imageLabel, sourceLabel, downloadBtn, showAnywayBtn, hideImageBtn, bubble]() {
-                    // Restore blocked state
-                    imageLabel->clear();
-                    imageLabel->setText("[Image blocked by Hive moderation]\n\nThe generated image was flagged for potentially inappropriate content.");
-                    imageLabel->setWordWrap(true);
-                    imageLabel->setAlignment(Qt::AlignCenter);
-                    imageLabel->setStyleSheet(
-                        "QLabel { "
-                        "  background-color: #ffebee; "
-                        "  border-radius: 12px; "
-                        "  padding: 20px; "
-                        "  color: #c62828; "
-                        "  font-weight: bold; "
-                        "  font-size: 11pt; "
-                        "}"
-                    );
-                    bubble->setStyleSheet(
-                        "QFrame { "
-                        "  background-color: #ffebee; "
-                        "  color: #c62828; "
-                        "  border-radius: 18px; "
-                        "  border: none; "
-                        "}"
-                    );
-                    
-                    // Toggle buttons
-                    hideImageBtn->hide();
-                    showAnywayBtn->show();
-                    downloadBtn->hide();
-                    sourceLabel->hide();
-                    
-                    Logger::info("User hid blocked image");
-                });
-                
-                
-                statusLabel_->setText("Image blocked by moderation");
-                emit imageBlocked("Content policy violation");
-            } else {
-                // Embed metadata and display
-                QByteArray imageWithMetadata = embedImageMetadata(imageData, selectedModel);
-                
-                // Load and display the image
-                QImage image;
-                image.loadFromData(imageWithMetadata.isEmpty() ? imageData : imageWithMetadata);
-                
-                if (image.isNull()) {
-                    // Try original data
-                    QBuffer buffer;
-                    buffer.setData(imageData);
-                    buffer.open(QIODevice::ReadOnly);
-                    QImageReader reader(&buffer);
-                    reader.setAutoDetectImageFormat(true);
-                    if (imageUrl.toLower().endsWith(".webp")) {
-                        reader.setFormat("webp");
-                    }
-                    image = reader.read();
-                }
-                
-                if (!image.isNull()) {
-                    QPixmap pixmap = QPixmap::fromImage(image);
-                    QPixmap scaled = pixmap.scaled(380, 380, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                    imageLabel->setPixmap(scaled);
-                    imageLabel->setStyleSheet("QLabel { background: transparent; }");
-                    
-                    // Show source info
-                    sourceLabel->setText("Generated by: " + modelName);
-                    sourceLabel->show();
-                    
-                    // Save the watermarked image locally (auto-save)
-                    QString savePath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/generated_images";
-                    QDir().mkpath(savePath);
-                    QString autoSaveFilename = savePath + "/" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".png";
-                    
-                    QByteArray finalImageData = imageWithMetadata.isEmpty() ? imageData : imageWithMetadata;
-                    
-                    QFile file(autoSaveFilename);
-                    if (file.open(QIODevice::WriteOnly)) {
-                        file.write(finalImageData);
-                        file.close();
-                        Logger::info("Saved watermarked image to: " + autoSaveFilename.toStdString());
-                    }
-                    
-                    // Show download button and connect it
-                    downloadBtn->show();
-                    connect(downloadBtn, &QPushButton::clicked, [finalImageData, prompt]() {
-                        // Create a sanitized filename from prompt
-                        QString safeName = prompt.left(30).simplified();
-                        safeName.replace(QRegularExpression("[^a-zA-Z0-9 ]"), "");
-                        safeName.replace(" ", "_");
-                        if (safeName.isEmpty()) safeName = "generated_image";
-                        
-                        QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) 
-                            + "/" + safeName + ".png";
-                        
-                        QString filename = QFileDialog::getSaveFileName(
-                            nullptr,
-                            "Save Image",
-                            defaultPath,
-                            "PNG Image (*.png);;JPEG Image (*.jpg);;All Files (*)"
-                        );
-                        
-                        if (!filename.isEmpty()) {
-                            QFile saveFile(filename);
-                            if (saveFile.open(QIODevice::WriteOnly)) {
-                                saveFile.write(finalImageData);
-                                saveFile.close();
-                                Logger::info("User saved image to: " + filename.toStdString());
-                            }
-                        }
-                    });
-                    
-                    statusLabel_->setText("Image generated");
-                } else {
-                    imageLabel->setText("<a href='" + imageUrl + "' style='color: #0066cc;'>Click to view image</a>");
-                    imageLabel->setOpenExternalLinks(true);
-                    imageLabel->setMinimumSize(200, 50);
-                }
-            }
-        } else {
-            imageLabel->setText("Could not load image\n<a href='" + imageUrl + "' style='color: #0066cc;'>Open in browser</a>");
-            imageLabel->setOpenExternalLinks(true);
-            imageLabel->setMinimumSize(200, 50);
-            Logger::error("Image download error: " + reply->errorString().toStdString());
-            statusLabel_->setText("Download failed");
-        }
+            // Toggle buttons
+            showAnywayBtn->hide();
+            hideImageBtn->show();
+            downloadBtn->show();
+            
+            statusLabel_->setText("Showing blocked image");
+            Logger::info("User chose to view blocked image");
+        });
         
-        reply->deleteLater();
-        manager->deleteLater();
-        scrollToBottom();
-    });
-    
-    manager->get(request);
-    scrollToBottom();
+        // Connect hide image button
+        connect(hideImageBtn, &QPushButton::clicked, [imageLabel, sourceLabel, downloadBtn, showAnywayBtn, hideImageBtn, bubble]() {
+            // Restore blocked state
+            imageLabel->clear();
+            imageLabel->setText("[Image blocked by Hive moderation]\n\nThe generated image was flagged for potentially inappropriate content.");
+            imageLabel->setWordWrap(true);
+            imageLabel->setAlignment(Qt::AlignCenter);
+            imageLabel->setStyleSheet(
+                "QLabel { "
+                "  background-color: #ffebee; "
+                "  border-radius: 12px; "
+                "  padding: 20px; "
+                "  color: #c62828; "
+                "  font-weight: bold; "
+                "  font-size: 11pt; "
+                "}"
+            );
+            bubble->setStyleSheet(
+                "QFrame { "
+                "  background-color: #ffebee; "
+                "  color: #c62828; "
+                "  border-radius: 18px; "
+                "  border: none; "
+                "}"
+            );
+            
+            // Toggle buttons
+            hideImageBtn->hide();
+            showAnywayBtn->show();
+            downloadBtn->hide();
+            sourceLabel->hide();
+            
+            Logger::info("User hid blocked image");
+        });
+        
+        statusLabel_->setText("Image blocked by moderation");
+        emit imageBlocked("Content policy violation");
+    } else if (!result->thumbnail.isNull()) {
+        imageLabel->setPixmap(QPixmap::fromImage(result->thumbnail));
+        imageLabel->setStyleSheet("QLabel { background: transparent; }");
+        
+        // Show source info
+        sourceLabel->setText("Generated by: " + modelName);
+        sourceLabel->show();
+        
+        downloadBtn->show();
+        
+        statusLabel_->setText("Image generated");
+    } else {
+        imageLabel->setText("Could not display the generated image");
+        imageLabel->setMinimumSize(200, 50);
+    }
 }
 
 void ChatbotPanel::showTypingIndicator() {
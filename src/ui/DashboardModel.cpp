@@ -1,132 +1,67 @@
 #include "ui/DashboardModel.h"
+#include "storage/ImageStore.h"
+#include "utils/Metrics.h"
 #include <QColor>
 #include <QBrush>
 #include <QString>
 #include <QFont>
+#include <QPixmap>
+#include <QPixmapCache>
+#include <QStringList>
 
 namespace ModAI {
 
 DashboardModel::DashboardModel(QObject* parent)
-    : QAbstractTableModel(parent) {
+    : QAbstractTableModel(parent)
+    , coalesceTimer_(new QTimer(this)) {
+    coalesceTimer_->setSingleShot(true);
+    coalesceTimer_->setInterval(kCoalesceIntervalMs);
+    connect(coalesceTimer_, &QTimer::timeout, this, &DashboardModel::flushPending);
 }
 
 int DashboardModel::rowCount(const QModelIndex& parent) const {
     Q_UNUSED(parent);
-    return static_cast<int>(items_.size());
+    return static_cast<int>(rows_.size());
 }
 
 int DashboardModel::columnCount(const QModelIndex& parent) const {
     Q_UNUSED(parent);
-    return 9;  // timestamp, author, subreddit, snippet, type, ai_score, labels, status, link
+    return kColumnCount;  // timestamp, author, subreddit, snippet, type, ai_score, labels, status, link
 }
 
 QVariant DashboardModel::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || index.row() >= static_cast<int>(items_.size())) {
+    if (!index.isValid() || index.row() >= static_cast<int>(rows_.size()) ||
+        index.column() >= kColumnCount) {
         return QVariant();
     }
     
-    const ContentItem& item = items_[index.row()];
+    // Display strings and colours are computed once per row in makeRow()
+    const Row& row = *rows_[index.row()];
     
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
-        switch (index.column()) {
-            case 0: return QString::fromStdString(item.timestamp);
-            case 1: return item.author.has_value() ? QString::fromStdString(item.author.value()) : QString("N/A");
-            case 2: return QString::fromStdString(item.subreddit);
-            case 3: {
-                if (item.text.has_value()) {
-                    QString text = QString::fromStdString(item.text.value());
-                    return text.left(50) + (text.length() > 50 ? "..." : "");
-                }
-                return QString("N/A");
-            }
-            case 4: return QString::fromStdString(item.content_type);
-            case 5: return QString::number(item.ai_detection.ai_score, 'f', 2);
-            case 6: {
-                QString labels;
-                // Only show labels with value > 0.3 (filters out very mild detections)
-                if (item.moderation.labels.sexual > 0.3) labels += "sexual ";
-                if (item.moderation.labels.violence > 0.3) labels += "violence ";
-                if (item.moderation.labels.hate > 0.3) labels += "hate ";
-                if (item.moderation.labels.drugs > 0.3) labels += "drugs ";
-                
-                // Add additional labels (only if confidence > 0.3)
-                for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
-                    if (conf > 0.3) {
-                        labels += QString::fromStdString(label) + " ";
-                    }
-                }
-                
-                return labels.isEmpty() ? QString("none") : labels.trimmed();
-            }
-            case 7: return QString::fromStdString(item.decision.auto_action);
-            case 8: {
-                // Construct Reddit post URL
-                QString url = QString("https://reddit.com/r/%1/comments/%2")
-                    .arg(QString::fromStdString(item.subreddit))
-                    .arg(QString::fromStdString(item.id));
-                return url;
-            }
-            default: return QVariant();
-        }
+        return row.display[static_cast<size_t>(index.column())];
     }
     
     if (role == Qt::BackgroundRole) {
-        // Priority 1: Moderation-based flagging (darker red for blocked content)
-        if (item.decision.auto_action == "block") {
-            // Check if blocked due to moderation labels (not AI)
-            bool moderationBlocked = (item.moderation.labels.sexual > 0.9 || 
-                                     item.moderation.labels.violence > 0.9 || 
-                                     item.moderation.labels.hate > 0.7 ||
-                                     item.moderation.labels.drugs > 0.9);
-            
-            if (moderationBlocked) {
-                return QBrush(QColor(220, 53, 69));  // Strong red for moderation blocking
-            }
-            // AI-based blocking - make it much more visible
-            return QBrush(QColor(255, 150, 150));  // More visible light red for AI blocking
-        }
-        
-        // Priority 2: Review status (yellow for moderation review)
-        if (item.decision.auto_action == "review") {
-            return QBrush(QColor(255, 235, 120));  // More visible yellow
-        }
-        
-        // Priority 3: Check for moderation labels > 0.3 (even if allowed)
-        // This catches content with significant labels that didn't trigger blocking threshold
-        bool hasSignificantLabels = (item.moderation.labels.sexual > 0.3 ||
-                                    item.moderation.labels.violence > 0.3 ||
-                                    item.moderation.labels.hate > 0.3 ||
-                                    item.moderation.labels.drugs > 0.3);
-        
-        // Also check additional labels
-        if (!hasSignificantLabels) {
-            for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
-                if (conf > 0.3) {
-                    hasSignificantLabels = true;
-                    break;
-                }
-            }
-        }
-        
-        if (hasSignificantLabels) {
-            return QBrush(QColor(255, 220, 180));  // Light orange for content with significant labels
+        return row.background;
+    }
+    
+    if (role == Qt::DecorationRole && index.column() == 3) {
+        // Snippet column of image items: the store's pre-generated thumbnail
+        const ContentItem& item = *row.item;
+        if (item.content_type != "image" || !item.image_path.has_value()) {
+            return QVariant();
         }
-        
-        // Priority 4: AI detection coloring for allowed content
-        if (item.decision.auto_action == "allow") {
-            float aiScore = item.ai_detection.ai_score;
-            
-            if (aiScore > 0.6 && aiScore <= 0.8) {
-                // Moderate AI confidence - light yellow
-                return QBrush(QColor(255, 245, 180));  // More visible very light yellow
-            } else if (aiScore > 0.8) {
-                // High AI confidence - light red (but passed other checks)
-                return QBrush(QColor(255, 200, 200));  // More visible very light red
+        QString path = QString::fromStdString(ImageStore::thumbnailPathFor(*item.image_path));
+        QPixmap icon;
+        if (!QPixmapCache::find(path, &icon)) {
+            if (!icon.load(path)) {
+                return QVariant();
             }
+            icon = icon.scaled(kThumbnailSize, kThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            QPixmapCache::insert(path, icon);
         }
-        
-        // Return white background for clean content
-        return QBrush(Qt::white);
+        return icon;
     }
     
     if (role == Qt::ForegroundRole) {
@@ -141,9 +76,12 @@ QVariant DashboardModel::data(const QModelIndex& index, int role) const {
     if (role == Qt::FontRole) {
         // Make link column underlined to indicate clickable
         if (index.column() == 8) {
-            QFont font;
-            font.setUnderline(true);
-            return font;
+            static const QFont linkFont = [] {
+                QFont font;
+                font.setUnderline(true);
+                return font;
+            }();
+            return linkFont;
         }
     }
     
@@ -169,38 +107,294 @@ QVariant DashboardModel::headerData(int section, Qt::Orientation orientation, in
 }
 
 void DashboardModel::addItem(const ContentItem& item) {
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    items_.push_back(item);
+    std::vector<ContentItem> items;
+    items.push_back(item);
+    addItems(std::move(items));
+}
+
+void DashboardModel::addItems(std::vector<ContentItem> items) {
+    // Keep arrival order across the queued and direct paths
+    flushPending();
+    insertItems(std::move(items));
+}
+
+void DashboardModel::queueItem(const ContentItem& item) {
+    pending_.push_back(item);
+    if (!coalesceTimer_->isActive()) {
+        coalesceTimer_->start();
+    }
+}
+
+void DashboardModel::flushPending() {
+    coalesceTimer_->stop();
+    if (pending_.empty()) {
+        return;
+    }
+    TraceSpan span("dashboard_flush");
+    std::vector<ContentItem> items;
+    items.swap(pending_);
+    insertItems(std::move(items));
+}
+
+void DashboardModel::insertItems(std::vector<ContentItem> items) {
+    if (items.empty()) {
+        return;
+    }
+    int count = static_cast<int>(items.size());
+    if (!newestFirst_) {
+        int first = rowCount();
+        beginInsertRows(QModelIndex(), first, first + count - 1);
+        appendPage(std::move(items));
+        endInsertRows();
+        return;
+    }
+    
+    // Newest on top: the last item to arrive becomes row 0
+    beginInsertRows(QModelIndex(), 0, count - 1);
+    std::vector<RowPtr> rows;
+    rows.reserve(items.size());
+    for (auto it = items.rbegin(); it != items.rend(); ++it) {
+        rows.push_back(makeRow(std::move(*it)));
+    }
+    rows_.insert(rows_.begin(), rows.begin(), rows.end());
+    firstKey_ -= count;
+    // Topmost row wins for duplicate ids
+    for (size_t i = rows.size(); i-- > 0;) {
+        rowKeys_[rows[i]->item->id] = firstKey_ + static_cast<int64_t>(i);
+    }
     endInsertRows();
 }
 
 void DashboardModel::clear() {
     beginResetModel();
-    items_.clear();
+    coalesceTimer_->stop();
+    pending_.clear();
+    rows_.clear();
+    rowKeys_.clear();
+    firstKey_ = 0;
+    history_.reset();
+    newestFirst_ = false;
+    endResetModel();
+}
+
+void DashboardModel::setHistory(std::unique_ptr<ContentCursor> cursor) {
+    beginResetModel();
+    coalesceTimer_->stop();
+    pending_.clear();
+    rows_.clear();
+    rowKeys_.clear();
+    firstKey_ = 0;
+    history_ = std::move(cursor);
+    newestFirst_ = true;
+    if (history_) {
+        appendPage(history_->next(kHistoryPageSize));
+    }
     endResetModel();
 }
 
-ContentItem DashboardModel::getItem(int row) const {
-    if (row >= 0 && row < static_cast<int>(items_.size())) {
-        return items_[row];
+bool DashboardModel::canFetchMore(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return false;
+    }
+    return history_ && !history_->atEnd();
+}
+
+void DashboardModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || !history_) {
+        return;
+    }
+    std::vector<ContentItem> page = history_->next(kHistoryPageSize);
+    if (page.empty()) {
+        return;
+    }
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.size()) - 1);
+    appendPage(std::move(page));
+    endInsertRows();
+}
+
+void DashboardModel::appendPage(std::vector<ContentItem> page) {
+    rows_.reserve(rows_.size() + page.size());
+    for (auto& item : page) {
+        int64_t key = firstKey_ + static_cast<int64_t>(rows_.size());
+        rowKeys_.emplace(item.id, key);
+        rows_.push_back(makeRow(std::move(item)));
+    }
+}
+
+QString DashboardModel::displayText(const ContentItem& item, int column) {
+    switch (column) {
+        case 0: return QString::fromStdString(item.timestamp);
+        case 1: return item.author.has_value() ? QString::fromStdString(item.author.value()) : QString("N/A");
+        case 2: return QString::fromStdString(item.subreddit);
+        case 3: {
+            if (item.text.has_value()) {
+                QString text = QString::fromStdString(item.text.value());
+                return text.left(50) + (text.length() > 50 ? "..." : "");
+            }
+            return QString("N/A");
+        }
+        case 4: return QString::fromStdString(item.content_type);
+        case 5: return QString::number(item.ai_detection.ai_score, 'f', 2);
+        case 6: {
+            QString labels;
+            // Only show labels with value > 0.3 (filters out very mild detections)
+            if (item.moderation.labels.sexual > 0.3) labels += "sexual ";
+            if (item.moderation.labels.violence > 0.3) labels += "violence ";
+            if (item.moderation.labels.hate > 0.3) labels += "hate ";
+            if (item.moderation.labels.drugs > 0.3) labels += "drugs ";
+            
+            // Add additional labels (only if confidence > 0.3)
+            for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
+                if (conf > 0.3) {
+                    labels += QString::fromStdString(label) + " ";
+                }
+            }
+            
+            return labels.isEmpty() ? QString("none") : labels.trimmed();
+        }
+        case 7: return QString::fromStdString(item.decision.auto_action);
+        case 8: {
+            // Construct Reddit post URL
+            QString url = QString("https://reddit.com/r/%1/comments/%2")
+                .arg(QString::fromStdString(item.subreddit))
+                .arg(QString::fromStdString(item.id));
+            return url;
+        }
+        default: return QString();
     }
-    return ContentItem();
+}
+
+QBrush DashboardModel::backgroundFor(const ContentItem& item) {
+    // Priority 1: Moderation-based flagging (darker red for blocked content)
+    if (item.decision.auto_action == "block") {
+        // Check if blocked due to moderation labels (not AI)
+        bool moderationBlocked = (item.moderation.labels.sexual > 0.9 || 
+                                 item.moderation.labels.violence > 0.9 || 
+                                 item.moderation.labels.hate > 0.7 ||
+                                 item.moderation.labels.drugs > 0.9);
+        
+        if (moderationBlocked) {
+            return QBrush(QColor(220, 53, 69));  // Strong red for moderation blocking
+        }
+        // AI-based blocking - make it much more visible
+        return QBrush(QColor(255, 150, 150));  // More visible light red for AI blocking
+    }
+    
+    // Priority 2: Review status (yellow for moderation review)
+    if (item.decision.auto_action == "review") {
+        return QBrush(QColor(255, 235, 120));  // More visible yellow
+    }
+    
+    // Priority 3: Check for moderation labels > 0.3 (even if allowed)
+    // This catches content with significant labels that didn't trigger blocking threshold
+    bool hasSignificantLabels = (item.moderation.labels.sexual > 0.3 ||
+                                item.moderation.labels.violence > 0.3 ||
+                                item.moderation.labels.hate > 0.3 ||
+                                item.moderation.labels.drugs > 0.3);
+    
+    // Also check additional labels
+    if (!hasSignificantLabels) {
+        for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
+            if (conf > 0.3) {
+                hasSignificantLabels = true;
+                break;
+            }
+        }
+    }
+    
+    if (hasSignificantLabels) {
+        return QBrush(QColor(255, 220, 180));  // Light orange for content with significant labels
+    }
+    
+    // Priority 4: AI detection coloring for allowed content
+    if (item.decision.auto_action == "allow") {
+        float aiScore = item.ai_detection.ai_score;
+        
+        if (aiScore > 0.6 && aiScore <= 0.8) {
+            // Moderate AI confidence - light yellow
+            return QBrush(QColor(255, 245, 180));  // More visible very light yellow
+        } else if (aiScore > 0.8) {
+            // High AI confidence - light red (but passed other checks)
+            return QBrush(QColor(255, 200, 200));  // More visible very light red
+        }
+    }
+    
+    // Return white background for clean content
+    return QBrush(Qt::white);
+}
+
+DashboardModel::RowPtr DashboardModel::makeRow(ContentItem item) {
+    auto row = std::make_shared<Row>();
+    QStringList parts;
+    // Members of a near-duplicate cluster match a search for its first id
+    parts << QString::fromStdString(item.id)
+          << QString::fromStdString(item.duplicate_of)
+          << QString::fromStdString(item.author.value_or(""))
+          << QString::fromStdString(item.subreddit)
+          << QString::fromStdString(item.content_type)
+          << QString::fromStdString(item.decision.auto_action);
+    for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
+        Q_UNUSED(conf);
+        parts << QString::fromStdString(label);
+    }
+    parts << QString::fromStdString(item.text.value_or(""));
+    // Newline-joined so a needle never matches across two fields
+    QString key = parts.join('\n');
+    row->searchKey = foldForSearch(key);
+    for (int column = 0; column < kColumnCount; ++column) {
+        row->display[static_cast<size_t>(column)] = displayText(item, column);
+    }
+    row->background = backgroundFor(item);
+    row->item = std::make_shared<const ContentItem>(std::move(item));
+    return row;
+}
+
+std::string DashboardModel::foldForSearch(const QString& text) {
+    return text.toCaseFolded().toStdString();
+}
+
+ContentItemPtr DashboardModel::itemAt(int row) const {
+    if (row >= 0 && row < static_cast<int>(rows_.size())) {
+        return rows_[row]->item;
+    }
+    return nullptr;
+}
+
+DashboardModel::RowPtr DashboardModel::rowAt(int row) const {
+    if (row >= 0 && row < static_cast<int>(rows_.size())) {
+        return rows_[row];
+    }
+    return nullptr;
+}
+
+std::vector<DashboardModel::RowPtr> DashboardModel::snapshotRows(int64_t& firstKey) const {
+    firstKey = firstKey_;
+    return rows_;
 }
 
 void DashboardModel::updateItem(int row, const ContentItem& item) {
-    if (row >= 0 && row < static_cast<int>(items_.size())) {
-        items_[row] = item;
+    if (row >= 0 && row < static_cast<int>(rows_.size())) {
+        // Rows are immutable; holders of the old row keep their snapshot
+        const std::string& oldId = rows_[row]->item->id;
+        if (oldId != item.id) {
+            auto it = rowKeys_.find(oldId);
+            if (it != rowKeys_.end() && it->second == firstKey_ + row) {
+                rowKeys_.erase(it);
+            }
+            rowKeys_[item.id] = firstKey_ + row;
+        }
+        rows_[row] = makeRow(item);
         emit dataChanged(index(row, 0), index(row, columnCount() - 1));
     }
 }
 
 int DashboardModel::findRowById(const std::string& id) const {
-    for (size_t i = 0; i < items_.size(); ++i) {
-        if (items_[i].id == id) {
-            return static_cast<int>(i);
-        }
+    auto it = rowKeys_.find(id);
+    if (it == rowKeys_.end()) {
+        return -1; // Not found
     }
-    return -1; // Not found
+    return static_cast<int>(it->second - firstKey_);
 }
 
 Qt::ItemFlags DashboardModel::flags(const QModelIndex& index) const {
@@ -1,56 +1,89 @@
 #include "ui/DashboardProxyModel.h"
-#include "ui/DashboardModel.h"
 #include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QString>
+#include <QtConcurrent>
 
 namespace ModAI {
 
 DashboardProxyModel::DashboardProxyModel(QObject* parent)
-    : QSortFilterProxyModel(parent) {
+    : QSortFilterProxyModel(parent)
+    , watcher_(new QFutureWatcher<SearchResult>(this)) {
+    connect(watcher_, &QFutureWatcher<SearchResult>::finished, this, &DashboardProxyModel::onSearchFinished);
 }
 
 void DashboardProxyModel::setStatusFilter(const QString& status) {
-    statusFilter_ = status;
-    invalidate();
+    statusFilter_ = status.toStdString();
+    invalidateFilter();
 }
 
 void DashboardProxyModel::setSearchFilter(const QString& text) {
-    searchFilter_ = text;
-    invalidate();
-}
+    std::string needle = DashboardModel::foldForSearch(text);
+    uint64_t generation = ++generation_;
 
-bool DashboardProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const {
-    QAbstractItemModel* model = sourceModel();
-    if (!model) return true;
+    DashboardModel* model = dashboardModel();
+    if (needle.empty() || !model) {
+        // Nothing to scan for; publish straight away
+        search_ = SearchResult();
+        search_.generation = generation;
+        search_.needle = std::move(needle);
+        invalidateFilter();
+        return;
+    }
+
+    SearchResult job;
+    job.generation = generation;
+    job.needle = std::move(needle);
+    job.rows = model->snapshotRows(job.firstKey);
 
-    // Check status filter
-    if (!statusFilter_.isEmpty() && statusFilter_ != "All Statuses") {
-        QModelIndex statusIndex = model->index(source_row, 7, source_parent); // Assuming status is column 7
-        // Wait, I need to check DashboardModel column indices.
-        // Let's assume column 7 for now, but I should verify.
-        QString status = model->data(statusIndex).toString();
-        if (status != statusFilter_) {
-            return false;
+    // A superseded scan still runs to completion; its result is discarded
+    watcher_->setFuture(QtConcurrent::run([job = std::move(job)]() mutable {
+        job.matches.resize(job.rows.size());
+        for (size_t i = 0; i < job.rows.size(); ++i) {
+            job.matches[i] = job.rows[i]->searchKey.find(job.needle) != std::string::npos;
         }
+        return std::move(job);
+    }));
+}
+
+void DashboardProxyModel::onSearchFinished() {
+    SearchResult result = watcher_->result();
+    if (result.generation != generation_) {
+        return;
     }
+    search_ = std::move(result);
+    invalidateFilter();
+}
 
-    // Check search filter
-    if (!searchFilter_.isEmpty()) {
-        bool match = false;
-        // Search in all columns
-        for (int i = 0; i < model->columnCount(source_parent); ++i) {
-            QModelIndex index = model->index(source_row, i, source_parent);
-            QString data = model->data(index).toString();
-            if (data.contains(searchFilter_, Qt::CaseInsensitive)) {
-                match = true;
-                break;
-            }
-        }
-        if (!match) return false;
+DashboardModel* DashboardProxyModel::dashboardModel() const {
+    return qobject_cast<DashboardModel*>(sourceModel());
+}
+
+bool DashboardProxyModel::matchesSearch(int sourceRow, const DashboardModel::Row& row) const {
+    if (search_.needle.empty()) {
+        return true;
+    }
+    DashboardModel* model = dashboardModel();
+    int64_t offset = model->rowKey(sourceRow) - search_.firstKey;
+    if (offset >= 0 && offset < static_cast<int64_t>(search_.rows.size()) &&
+        search_.rows[static_cast<size_t>(offset)].get() == &row) {
+        return search_.matches[static_cast<size_t>(offset)] != 0;
     }
+    return row.searchKey.find(search_.needle) != std::string::npos;
+}
 
-    return true;
+bool DashboardProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const {
+    Q_UNUSED(source_parent);
+    DashboardModel* model = dashboardModel();
+    if (!model) return true;
+
+    DashboardModel::RowPtr row = model->rowAt(source_row);
+    if (!row) return true;
+
+    if (!statusFilter_.empty() && row->item->decision.auto_action != statusFilter_) {
+        return false;
+    }
+    return matchesSearch(source_row, *row);
 }
 
 QVariant DashboardProxyModel::data(const QModelIndex& index, int role) const {
@@ -1,6 +1,8 @@
 #include "ui/DetailPanel.h"
+#include "storage/ImageStore.h"
 #include <QHBoxLayout>
 #include <QString>
+#include <QStringList>
 #include <QPixmap>
 
 namespace ModAI {
@@ -71,16 +73,27 @@ DetailPanel::DetailPanel(QWidget* parent)
     processCommentsButton_->setEnabled(false);  // Initially disabled
     layout->addWidget(processCommentsButton_);
     
+    // Near-duplicates point at the first item of their cluster
+    clusterButton_ = new QPushButton("Show Near-Duplicates");
+    clusterButton_->setEnabled(false);
+    layout->addWidget(clusterButton_);
+    
     layout->addStretch();
     
     connect(blockButton_, &QPushButton::clicked, this, &DetailPanel::onBlockClicked);
     connect(allowButton_, &QPushButton::clicked, this, &DetailPanel::onAllowClicked);
     connect(reviewButton_, &QPushButton::clicked, this, &DetailPanel::onReviewClicked);
     connect(processCommentsButton_, &QPushButton::clicked, this, &DetailPanel::onProcessCommentsClicked);
+    connect(clusterButton_, &QPushButton::clicked, this, &DetailPanel::onClusterClicked);
 }
 
-void DetailPanel::setContentItem(const ContentItem& item) {
-    currentItem_ = item;
+void DetailPanel::setContentItem(ContentItemPtr itemPtr) {
+    if (!itemPtr) {
+        clear();
+        return;
+    }
+    currentItem_ = std::move(itemPtr);
+    const ContentItem& item = *currentItem_;
     
     titleLabel_->setText(QString::fromStdString("Item: " + item.id));
     
@@ -88,6 +101,7 @@ void DetailPanel::setContentItem(const ContentItem& item) {
     bool isPost = (item.source == "reddit" && item.post_id.has_value() && !item.post_id.value().empty());
     processCommentsButton_->setEnabled(isPost);
     processCommentsButton_->setText("Process Comments");
+    clusterButton_->setEnabled(true);
     
     if (item.text.has_value()) {
         contentText_->setPlainText(QString::fromStdString(item.text.value()));
@@ -103,7 +117,11 @@ void DetailPanel::setContentItem(const ContentItem& item) {
             // TODO: Download image from URL
             // For now, skip remote images
         } else {
-            pixmap.load(imagePath);
+            // The stored thumbnail is enough here and far cheaper to decode
+            QString thumbnail = QString::fromStdString(ImageStore::thumbnailPathFor(item.image_path.value()));
+            if (!pixmap.load(thumbnail)) {
+                pixmap.load(imagePath);
+            }
         }
         if (!pixmap.isNull()) {
             imageLabel_->setPixmap(pixmap.scaled(400, 200, Qt::KeepAspectRatio, Qt::SmoothTransformation));
@@ -113,10 +131,21 @@ void DetailPanel::setContentItem(const ContentItem& item) {
         imageLabel_->hide();
     }
     
-    aiScoreLabel_->setText(QString("AI Score: %1 (Label: %2, Confidence: %3)")
-                          .arg(item.ai_detection.ai_score, 0, 'f', 2)
-                          .arg(QString::fromStdString(item.ai_detection.label))
-                          .arg(item.ai_detection.confidence, 0, 'f', 2));
+    QString aiText = QString("AI Score: %1 (Label: %2, Confidence: %3)")
+                         .arg(item.ai_detection.ai_score, 0, 'f', 2)
+                         .arg(QString::fromStdString(item.ai_detection.label))
+                         .arg(item.ai_detection.confidence, 0, 'f', 2);
+    // Long texts are scored in overlapping windows; show where the score comes from
+    if (!item.ai_detection.chunk_scores.empty()) {
+        QStringList chunks;
+        for (double score : item.ai_detection.chunk_scores) {
+            chunks << QString::number(score, 'f', 2);
+        }
+        aiText += QString("\nChunk scores (%1 windows): %2")
+                      .arg(static_cast<int>(item.ai_detection.chunk_scores.size()))
+                      .arg(chunks.join("  "));
+    }
+    aiScoreLabel_->setText(aiText);
     
     QString modText = "Moderation Labels: ";
     if (item.moderation.labels.sexual > 0.0) {
@@ -133,44 +162,56 @@ void DetailPanel::setContentItem(const ContentItem& item) {
     }
     moderationLabel_->setText(modText);
     
-    decisionLabel_->setText(QString("Decision: %1 (Rule: %2)")
-                           .arg(QString::fromStdString(item.decision.auto_action))
-                           .arg(QString::fromStdString(item.decision.rule_id)));
+    QString decisionText = QString("Decision: %1 (Rule: %2)")
+                               .arg(QString::fromStdString(item.decision.auto_action))
+                               .arg(QString::fromStdString(item.decision.rule_id));
+    if (!item.duplicate_of.empty()) {
+        decisionText += QString("\nNear-duplicate of %1 (detector results reused)")
+                            .arg(QString::fromStdString(item.duplicate_of));
+    }
+    decisionLabel_->setText(decisionText);
 }
 
 void DetailPanel::clear() {
-    currentItem_ = ContentItem();
+    currentItem_.reset();
     titleLabel_->setText("Select an item to view details");
     contentText_->clear();
     imageLabel_->hide();
     aiScoreLabel_->clear();
     moderationLabel_->clear();
     decisionLabel_->clear();
+    clusterButton_->setEnabled(false);
 }
 
 void DetailPanel::onBlockClicked() {
-    if (!currentItem_.id.empty()) {
-        emit actionRequested(currentItem_.id, "block");
+    if (currentItem_ && !currentItem_->id.empty()) {
+        emit actionRequested(currentItem_->id, "block");
     }
 }
 
 void DetailPanel::onAllowClicked() {
-    if (!currentItem_.id.empty()) {
-        emit actionRequested(currentItem_.id, "allow");
+    if (currentItem_ && !currentItem_->id.empty()) {
+        emit actionRequested(currentItem_->id, "allow");
     }
 }
 
 void DetailPanel::onReviewClicked() {
-    if (!currentItem_.id.empty()) {
-        emit actionRequested(currentItem_.id, "review");
+    if (currentItem_ && !currentItem_->id.empty()) {
+        emit actionRequested(currentItem_->id, "review");
     }
 }
 
 void DetailPanel::onProcessCommentsClicked() {
-    if (currentItem_.post_id.has_value() && !currentItem_.subreddit.empty()) {
+    if (currentItem_ && currentItem_->post_id.has_value() && !currentItem_->subreddit.empty()) {
         processCommentsButton_->setEnabled(false);
         processCommentsButton_->setText("Processing...");
-        emit processCommentsRequested(currentItem_.subreddit, currentItem_.post_id.value());
+        emit processCommentsRequested(currentItem_->subreddit, currentItem_->post_id.value());
+    }
+}
+
+void DetailPanel::onClusterClicked() {
+    if (currentItem_ && !currentItem_->id.empty()) {
+        emit clusterRequested(currentItem_->duplicate_of.empty() ? currentItem_->id : currentItem_->duplicate_of);
     }
 }
 
@@ -1,14 +1,13 @@
 #include "ui/MainWindow.h"
-#include "core/ModerationEngine.h"
-#include "core/RuleEngine.h"
+#include "core/ModerationService.h"
 #include "detectors/LocalAIDetector.h"
 #include "detectors/HiveImageModerator.h"
 #include "detectors/HiveTextModerator.h"
 #include "network/QtHttpClient.h"
-#include "storage/JsonlStorage.h"
+#include "network/HttpTransport.h"
 #include "storage/Storage.h"
 #include "utils/Logger.h"
-#include "utils/Crypto.h"
+#include "utils/Metrics.h"
 #include "ui/ChatbotPanel.h"
 #include "ui/AITextDetectorPanel.h"
 #include "ui/AIImageDetectorPanel.h"
@@ -17,7 +16,6 @@
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QFileDialog>
-#include <QStandardPaths>
 #include <QDir>
 #include <QTimer>
 #include <QItemSelectionModel>
@@ -32,6 +30,8 @@
 #include <QTextStream>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QRegularExpression>
+#include <algorithm>
 
 namespace ModAI {
 
@@ -40,9 +40,7 @@ MainWindow::MainWindow(QWidget* parent)
     , tableView_(nullptr)
     , model_(nullptr)
     , detailPanel_(nullptr)
-    , railguardOverlay_(nullptr)
-    , workerThread_(nullptr)
-    , processingActive_(false) {
+    , railguardOverlay_(nullptr) {
     
     // Register ContentItem as Qt meta-type for cross-thread signals
     qRegisterMetaType<ContentItem>("ContentItem");
@@ -51,110 +49,50 @@ MainWindow::MainWindow(QWidget* parent)
     setupConnections();
     
     // Initialize components
-    dataPath_ = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString() + "/data";
+    dataPath_ = ServiceConfig::defaultDataPath();
     QDir().mkpath(QString::fromStdString(dataPath_));
     
     Logger::init(dataPath_ + "/logs/system.log");
     Logger::info("Application started");
     
-    // Load API keys from secure storage
-    std::string hiveKey = Crypto::getApiKey("hive_api_key");
-    std::string redditClientId = Crypto::getApiKey("reddit_client_id");
-    std::string redditClientSecret = Crypto::getApiKey("reddit_client_secret");
+    // Detectors, storage, rules, pipeline and scraper; the same engine the daemon runs
+    ServiceConfig config;
+    config.dataPath = dataPath_;
+    service_ = std::make_unique<ModerationService>(config);
+    storagePtr_ = &service_->storage();
+    const std::string& hiveKey = service_->config().hiveApiKey;
     
     if (hiveKey.empty()) {
-        Logger::warn("No Hive API key - moderation disabled");
         statusBar()->showMessage("⚠ Hive API key missing - moderation disabled", 0);
     }
+    // The model loads in the background; the window shows meanwhile and
+    // scraped items wait in the pipeline until it is ready
+    statusLabel_->setText("Loading AI model...");
+    service_->whenTextDetectorLoaded([this](bool available) {
+        QMetaObject::invokeMethod(this, [this, available]() {
+            statusLabel_->setText("Ready");
+            if (available) {
+                statusBar()->showMessage("✓ Local AI detection enabled", 3000);
+                return;
+            }
+            statusBar()->showMessage("❌ AI model not found - please export model (see logs)", 0);
+            
+            QMessageBox::warning(this, "AI Model Not Found",
+                "Local AI detection model not found.\n\n"
+                "Please export the model by running:\n"
+                "  python3 scripts/export_model_to_onnx.py --output " +
+                QString::fromStdString(service_->config().modelDir) + "\n\n"
+                "The application will continue without AI detection.");
+        }, Qt::QueuedConnection);
+    });
     
-    // Create HTTP client
-    auto httpClient = std::make_unique<QtHttpClient>(this);
-    
-    // Initialize local AI model for text detection
-    std::string modelPath = dataPath_ + "/models/ai_detector.onnx";
-    std::string tokenizerPath = dataPath_ + "/models";
-    
-    std::unique_ptr<TextDetector> textDetector;
-    
-    // Use local ONNX model only
-    auto localDetector = std::make_unique<LocalAIDetector>(modelPath, tokenizerPath, 768, 0.5f);
-    if (localDetector->isAvailable()) {
-        Logger::info("Local ONNX AI detector initialized (desklib/ai-text-detector-v1.01)");
-        statusBar()->showMessage("✓ Local AI detection enabled", 3000);
-        textDetector = std::move(localDetector);
-    } else {
-        Logger::error("Local AI model not available. Please export the model first:");
-        Logger::error("  python3 scripts/export_model_to_onnx.py --output " + dataPath_ + "/models");
-        statusBar()->showMessage("❌ AI model not found - please export model (see logs)", 0);
-        
-        QMessageBox::warning(this, "AI Model Not Found",
-            "Local AI detection model not found.\n\n"
-            "Please export the model by running:\n"
-            "  python3 scripts/export_model_to_onnx.py --output " +
-            QString::fromStdString(dataPath_) + "/models\n\n"
-            "The application will continue without AI detection.");
-        
-        // Create a disabled detector
-        textDetector = std::make_unique<LocalAIDetector>(modelPath, tokenizerPath, 768, 0.5f);
-    }
-    
-    auto imageModerator = std::make_unique<HiveImageModerator>(
-        std::make_unique<QtHttpClient>(this), hiveKey);
-    auto textModerator = std::make_unique<HiveTextModerator>(
-        std::make_unique<QtHttpClient>(this), hiveKey);
-    
-    // Create rule engine
-    auto ruleEngine = std::make_unique<RuleEngine>();
-    std::string rulesPath = dataPath_ + "/rules.json";
-    
-    // Copy default rules if not exists
-    if (!QFile::exists(QString::fromStdString(rulesPath))) {
-        QFile defaultRules("../config/rules.json");
-        if (!defaultRules.exists()) {
-            // Try alternative path
-            defaultRules.setFileName("config/rules.json");
-        }
-        if (defaultRules.exists()) {
-            defaultRules.copy(QString::fromStdString(rulesPath));
-        }
-    }
-    
-    ruleEngine->loadRulesFromJson(rulesPath);
-    
-    // Create storage
-    auto storage = std::make_unique<JsonlStorage>(dataPath_);
-    storagePtr_ = storage.get();
-    
-    // Create moderation engine
-    moderationEngine_ = std::make_unique<ModerationEngine>(
-        std::move(textDetector),
-        std::move(imageModerator),
-        std::move(textModerator),
-        std::move(ruleEngine),
-        std::move(storage)
-    );
-    
-    moderationEngine_->setOnItemProcessed([this](const ContentItem& item) {
+    service_->setOnItemProcessed([this](const ContentItem& item) {
         // Use QTimer::singleShot to ensure we're in the right thread
         QTimer::singleShot(0, this, [this, item]() {
             onItemProcessed(item);
         });
     });
-    
-    // Create scraper
-    scraper_ = std::make_unique<RedditScraper>(
-        std::make_unique<QtHttpClient>(this),
-        redditClientId,
-        redditClientSecret,
-        "ModAI/1.0 by /u/yourusername",
-        dataPath_
-    );
-    
-    scraper_->setOnItemScraped([this](const ContentItem& item) {
-        // Add to queue for sequential processing
-        QMetaObject::invokeMethod(this, "onItemScraped", Qt::QueuedConnection,
-                                  Q_ARG(ContentItem, item));
-    });
+    service_->start();
     
     // Initialize new mode panels with shared components
     
@@ -167,9 +105,12 @@ MainWindow::MainWindow(QWidget* parent)
         "http://localhost:11434/api/chat" // Default Ollama endpoint
     );
     
-    // AI Text Detector - needs text detector (share a reference)
-    // Create another instance for the detector panel
-    auto textDetectorForPanel = std::make_unique<LocalAIDetector>(modelPath, tokenizerPath, 768, 0.5f);
+    // AI Text Detector - needs text detector
+    // Separate instance, but it reuses the engine's session and vocab
+    auto textDetectorForPanel = std::make_unique<LocalAIDetector>(
+        service_->modelPath(), service_->config().modelDir, 768, 0.5f, service_->onnxOptions(),
+        LocalAIDetector::LoadMode::Background);
+    textDetectorForPanel->setChunking(service_->chunkingOptions());
     aiTextDetectorPanel_->initialize(std::move(textDetectorForPanel));
     
     // AI Image Detector - needs image moderator
@@ -180,18 +121,14 @@ MainWindow::MainWindow(QWidget* parent)
     // Also set image moderator for chatbot (for generated image moderation)
     chatbotPanel_->setImageModerator(imageModeratorForPanel);
     
-    // Set image moderator for Reddit scraper (for Reddit image moderation)
-    scraper_->setImageModerator(std::make_unique<HiveImageModerator>(
-        std::make_unique<QtHttpClient>(this), hiveKey));
-    
     // Do not auto-load old records on startup; user can load via menu.
 }
 
 MainWindow::~MainWindow() {
-    if (workerThread_) {
-        workerThread_->quit();
-        workerThread_->wait();
+    if (service_) {
+        service_->stop(false);
     }
+    HttpTransport::instance().shutdown();
     cleanupOnExit();
 }
 
@@ -208,6 +145,7 @@ void MainWindow::setupUI() {
     setupRedditScraperTab();
     setupChatbotTab();
     setupAIDetectorTabs();
+    setupMetricsTab();
     
     // Status bar with modern styling
     statusLabel_ = new QLabel("Ready");
@@ -683,6 +621,59 @@ void MainWindow::setupAIDetectorTabs() {
     tabWidget_->addTab(aiImageDetectorPanel_, "Image Fingerprinting");
 }
 
+void MainWindow::setupMetricsTab() {
+    QWidget* metricsTab = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(metricsTab);
+    
+    QHBoxLayout* controls = new QHBoxLayout;
+    traceButton_ = new QPushButton("Start Trace");
+    traceButton_->setToolTip("Capture a timeline (Chrome trace JSON, opens in Perfetto)");
+    connect(traceButton_, &QPushButton::clicked, this, &MainWindow::onToggleTrace);
+    controls->addWidget(new QLabel("Per-stage latency, queue depth and request counters"), 1);
+    controls->addWidget(traceButton_);
+    layout->addLayout(controls);
+    
+    metricsView_ = new QPlainTextEdit;
+    metricsView_->setReadOnly(true);
+    metricsView_->setLineWrapMode(QPlainTextEdit::NoWrap);
+    QFont mono("Monospace");
+    mono.setStyleHint(QFont::TypeWriter);
+    metricsView_->setFont(mono);
+    layout->addWidget(metricsView_);
+    
+    tabWidget_->addTab(metricsTab, "Metrics");
+    
+    metricsTimer_ = new QTimer(this);
+    metricsTimer_->setInterval(kMetricsRefreshMs);
+    connect(metricsTimer_, &QTimer::timeout, this, &MainWindow::refreshMetrics);
+    metricsTimer_->start();
+    Tracing::setThreadName("ui");
+}
+
+void MainWindow::refreshMetrics() {
+    if (metricsView_ && metricsView_->isVisible()) {
+        metricsView_->setPlainText(QString::fromStdString(Metrics::renderSummary()));
+    }
+    // For scraping (node_exporter textfile collector) or offline inspection
+    if (++metricsTicks_ % kMetricsDumpEveryTicks == 0 && !dataPath_.empty()) {
+        Metrics::dumpToFile(dataPath_ + "/metrics.prom", true);
+        Metrics::dumpToFile(dataPath_ + "/metrics.json", false);
+    }
+}
+
+void MainWindow::onToggleTrace() {
+    if (!Tracing::enabled()) {
+        Tracing::start(dataPath_ + "/trace.json");
+        traceButton_->setText("Stop Trace");
+        statusBar()->showMessage("Tracing started", 2000);
+        return;
+    }
+    bool written = Tracing::stop();
+    traceButton_->setText("Start Trace");
+    statusBar()->showMessage(written ? QString::fromStdString("Trace written to " + dataPath_ + "/trace.json")
+                                     : QString("Failed to write trace"), 5000);
+}
+
 void MainWindow::setupConnections() {
     connect(toggleScrapingButton_, &QPushButton::clicked, this, &MainWindow::onToggleScraping);
     connect(tableView_->selectionModel(), &QItemSelectionModel::selectionChanged,
@@ -707,7 +698,14 @@ void MainWindow::setupConnections() {
             this, &MainWindow::onOverrideAction);
     connect(detailPanel_, &DetailPanel::processCommentsRequested,
             this, &MainWindow::onProcessCommentsRequested);
+    connect(detailPanel_, &DetailPanel::clusterRequested, this, [this](const std::string& clusterId) {
+        searchInput_->setText(QString::fromStdString(clusterId));
+    });
             
+    searchDebounce_ = new QTimer(this);
+    searchDebounce_->setSingleShot(true);
+    searchDebounce_->setInterval(kSearchDebounceMs);
+    connect(searchDebounce_, &QTimer::timeout, this, &MainWindow::applySearch);
     connect(searchInput_, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
     connect(filterCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterChanged);
 }
@@ -716,26 +714,16 @@ void MainWindow::loadExistingData() {
     if (!storagePtr_) {
         return;
     }
-    auto items = storagePtr_->loadAllContent();
-    model_->clear();
-    for (const auto& item : items) {
-        model_->addItem(item);
-    }
+    // Only the first page is read now; the table pulls in more on scroll
+    model_->setHistory(storagePtr_->openCursor(historyQuery_));
     historyLoaded_ = true;
     statusBar()->showMessage("Loaded previous session items", 3000);
 }
 
 void MainWindow::onToggleScraping() {
-    if (scraper_->isScraping()) {
-        // Stop scraping
-        scraper_->stop();
-        
-        // Clear the processing queue
-        {
-            QMutexLocker locker(&queueMutex_);
-            processingQueue_.clear();
-            processingActive_ = false;
-        }
+    if (service_->scraper().isScraping()) {
+        // Stop scraping and drop items still waiting in the pipeline
+        service_->stopScraping(true);
         
         toggleScrapingButton_->setText("▶ Start Scraping");
         toggleScrapingButton_->setStyleSheet(
@@ -767,9 +755,15 @@ void MainWindow::onToggleScraping() {
             return;
         }
         
-        std::vector<std::string> subreddits = {subreddit.toStdString()};
-        scraper_->setSubreddits(subreddits);
-        scraper_->start(60);  // Scrape every 60 seconds
+        // Accept "a, b c" or "a+b+c"; duplicates are dropped
+        std::vector<std::string> subreddits;
+        for (const QString& name : subreddit.split(QRegularExpression("[,+\\s]+"), Qt::SkipEmptyParts)) {
+            std::string entry = name.toStdString();
+            if (std::find(subreddits.begin(), subreddits.end(), entry) == subreddits.end()) {
+                subreddits.push_back(entry);
+            }
+        }
+        service_->startScraping(subreddits, 60);  // Scrape every 60 seconds
         
         toggleScrapingButton_->setText("⏸ Stop Scraping");
         toggleScrapingButton_->setStyleSheet(
@@ -791,48 +785,15 @@ void MainWindow::onToggleScraping() {
             "}"
         );
         scrapingStatusLabel_->setText("Scraping...");
-        statusLabel_->setText("Scraping: " + subreddit);
-    }
-}
-
-void MainWindow::onItemScraped(const ContentItem& item) {
-    // Add item to processing queue (don't show in UI until processed)
-    {
-        QMutexLocker locker(&queueMutex_);
-        processingQueue_.enqueue(item);
-    }
-    
-    // Start processing if not already active
-    if (!processingActive_) {
-        processingActive_ = true;
-        processNextItem();
+        statusLabel_->setText(subreddits.size() == 1
+            ? "Scraping: " + subreddit
+            : "Scraping " + QString::number(subreddits.size()) + " subreddits");
     }
 }
 
-void MainWindow::processNextItem() {
-    ContentItem item;
-    
-    {
-        QMutexLocker locker(&queueMutex_);
-        if (processingQueue_.isEmpty()) {
-            processingActive_ = false;
-            return;
-        }
-        item = processingQueue_.dequeue();
-    }
-    
-    // Process in background thread
-    QtConcurrent::run([this, item]() {
-        moderationEngine_->processItem(item);
-        
-        // Process next item after this one completes
-        QMetaObject::invokeMethod(this, "processNextItem", Qt::QueuedConnection);
-    });
-}
-
 void MainWindow::onItemProcessed(const ContentItem& item) {
-    // Add item to UI after processing is complete
-    model_->addItem(item);
+    // Add item to UI after processing is complete; bursts share one insert
+    model_->queueItem(item);
     
     // Show railguard if blocked
     if (item.decision.auto_action == "block") {
@@ -844,20 +805,27 @@ void MainWindow::onTableSelectionChanged(const QItemSelection& selected, const Q
     Q_UNUSED(deselected);
     
     if (!selected.indexes().isEmpty()) {
-        int row = selected.indexes().first().row();
-        ContentItem item = model_->getItem(row);
-        detailPanel_->setContentItem(item);
+        int row = proxyModel_->mapToSource(selected.indexes().first()).row();
+        detailPanel_->setContentItem(model_->itemAt(row));
     }
 }
 
 void MainWindow::onReviewRequested(const std::string& itemId) {
     // Find item and show in detail panel
-    for (int i = 0; i < model_->rowCount(); ++i) {
-        ContentItem item = model_->getItem(i);
-        if (item.id == itemId) {
-            tableView_->selectRow(i);
-            detailPanel_->setContentItem(item);
-            break;
+    model_->flushPending();
+    int row = model_->findRowById(itemId);
+    if (row >= 0) {
+        QModelIndex viewIndex = proxyModel_->mapFromSource(model_->index(row, 0));
+        if (viewIndex.isValid()) {
+            tableView_->selectRow(viewIndex.row());
+        }
+        detailPanel_->setContentItem(model_->itemAt(row));
+        return;
+    }
+    // Not paged in yet: a keyed lookup instead of loading history
+    if (storagePtr_) {
+        if (auto item = storagePtr_->findContent(itemId)) {
+            detailPanel_->setContentItem(std::make_shared<const ContentItem>(std::move(*item)));
         }
     }
 }
@@ -868,35 +836,44 @@ void MainWindow::onOverrideAction(const std::string& itemId, const std::string&
         return;
     }
 
-    for (int i = 0; i < model_->rowCount(); ++i) {
-        ContentItem item = model_->getItem(i);
-        if (item.id == itemId) {
-            std::string prev = item.decision.auto_action;
-            item.decision.auto_action = newStatus;
-            model_->updateItem(i, item);
+    model_->flushPending();
+    int row = model_->findRowById(itemId);
+    if (row < 0) {
+        return;
+    }
+    ContentItem item = *model_->itemAt(row);
+    std::string prev = item.decision.auto_action;
+    item.decision.auto_action = newStatus;
+    model_->updateItem(row, item);
 
-            HumanAction action;
-            action.action_id = QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString();
-            action.content_id = itemId;
-            action.timestamp = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toStdString();
-            action.reviewer = "local_user";
-            action.previous_status = prev;
-            action.new_status = newStatus;
-            action.reason = "manual override";
-            action.schema_version = 1;
+    HumanAction action;
+    action.action_id = QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString();
+    action.content_id = itemId;
+    action.timestamp = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toStdString();
+    action.reviewer = "local_user";
+    action.previous_status = prev;
+    action.new_status = newStatus;
+    action.reason = "manual override";
+    action.schema_version = 1;
 
-            try {
-                storagePtr_->saveAction(action);
-            } catch (const std::exception& e) {
-                Logger::error("Failed to save override action: " + std::string(e.what()));
-            }
-            break;
-        }
+    try {
+        storagePtr_->saveAction(action);
+    } catch (const std::exception& e) {
+        Logger::error("Failed to save override action: " + std::string(e.what()));
     }
 }
 
 void MainWindow::onSearchTextChanged(const QString& text) {
+    Q_UNUSED(text);
+    // Restarted on every keystroke; only the settled text is searched
+    searchDebounce_->start();
+}
+
+void MainWindow::applySearch() {
+    QString text = searchInput_->text();
     proxyModel_->setSearchFilter(text);
+    historyQuery_.text = text.trimmed().toStdString();
+    reloadHistory();
 }
 
 void MainWindow::onFilterChanged(int index) {
@@ -908,6 +885,16 @@ void MainWindow::onFilterChanged(int index) {
     else status = ""; // All Statuses
     
     proxyModel_->setStatusFilter(status);
+    historyQuery_.status = status.toStdString();
+    reloadHistory();
+}
+
+void MainWindow::reloadHistory() {
+    // The proxy still filters live rows; history is re-queried through the
+    // storage indices rather than filtered row by row
+    if (historyLoaded_ && storagePtr_) {
+        model_->setHistory(storagePtr_->openCursor(historyQuery_));
+    }
 }
 
 void MainWindow::onLoadHistory() {
@@ -921,22 +908,15 @@ void MainWindow::onLoadHistory() {
 void MainWindow::onProcessCommentsRequested(const std::string& subreddit, const std::string& postId) {
     Logger::info("Fetching comments for post " + postId + " in r/" + subreddit);
     
-    if (!scraper_) {
-        Logger::error("Scraper not initialized");
-        return;
-    }
-    
-    // Fetch comments in background thread
-    QtConcurrent::run([this, subreddit, postId]() {
+    // Fetch comments in background thread; stopping scraping abandons the download
+    QtConcurrent::run([this, subreddit, postId, session = service_->sessionToken()]() {
+        CancellationScope scope(session);
         try {
-            auto comments = scraper_->fetchPostComments(subreddit, postId);
-            Logger::info("Processing " + std::to_string(comments.size()) + " comments");
-            
-            // Queue each comment for processing
-            for (const auto& comment : comments) {
-                QMetaObject::invokeMethod(this, "onItemScraped", Qt::QueuedConnection,
-                                          Q_ARG(ContentItem, comment));
-            }
+            // Queue each comment as soon as it is parsed; a full queue slows the download
+            size_t count = service_->scraper().streamPostComments(subreddit, postId, [this](const ContentItem& comment) {
+                service_->workQueue().publish(comment, WorkPriority::Requested);
+            });
+            Logger::info("Queued " + std::to_string(count) + " comments for processing");
             
             // Re-enable button on UI thread
             QMetaObject::invokeMethod(this, [this]() {
@@ -955,16 +935,19 @@ void MainWindow::cleanupOnExit() {
     if (QFile::exists(contentFile)) {
         QFile::remove(contentFile);
     }
-    // Optionally clear cached images directory if it exists
-    QDir imagesDir(QString::fromStdString(dataPath_ + "/images"));
-    if (imagesDir.exists()) {
-        imagesDir.removeRecursively();
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        QString dbFile = QString::fromStdString(dataPath_ + "/modai.db" + suffix);
+        if (QFile::exists(dbFile)) {
+            QFile::remove(dbFile);
+        }
     }
-    // Clear cache results
-    QString cacheFile = QString::fromStdString(dataPath_ + "/cache/results.jsonl");
-    if (QFile::exists(cacheFile)) {
-        QFile::remove(cacheFile);
+    QDir segmentsDir(QString::fromStdString(dataPath_ + "/segments"));
+    if (segmentsDir.exists()) {
+        segmentsDir.removeRecursively();
     }
+    // Downloaded images and detector results are kept: the image store
+    // bounds its own size, and the next session reuses both instead of
+    // downloading and moderating the same images again
 }
 
 void MainWindow::applyTheme() {
@@ -1180,6 +1163,35 @@ void MainWindow::applyTheme() {
     }
 }
 
+namespace {
+
+// Pages over the rows shown when there is no storage to stream from
+class RowSnapshotCursor : public ContentCursor {
+public:
+    explicit RowSnapshotCursor(std::vector<ContentItemPtr> rows)
+        : rows_(std::move(rows)) {
+    }
+
+    std::vector<ContentItem> next(size_t maxItems) override {
+        std::vector<ContentItem> page;
+        size_t end = std::min(rows_.size(), position_ + maxItems);
+        page.reserve(end - position_);
+        for (; position_ < end; ++position_) {
+            page.push_back(*rows_[position_]);
+            rows_[position_].reset();
+        }
+        return page;
+    }
+
+    bool atEnd() const override { return position_ >= rows_.size(); }
+
+private:
+    std::vector<ContentItemPtr> rows_;
+    size_t position_ = 0;
+};
+
+} // namespace
+
 void MainWindow::onExportCsv() {
     QString fileName = QFileDialog::getSaveFileName(
         this,
@@ -1191,67 +1203,7 @@ void MainWindow::onExportCsv() {
     if (fileName.isEmpty()) {
         return;
     }
-    
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Export Error", "Could not open file for writing: " + fileName);
-        return;
-    }
-    
-    QTextStream out(&file);
-    
-    // Write CSV header
-    out << "ID,Timestamp,Author,Subreddit,Content Type,Text,Image Path,";
-    out << "AI Score,AI Label,Moderation Sexual,Moderation Violence,Moderation Hate,Moderation Drugs,";
-    out << "Additional Labels,Status,Rule ID\n";
-    
-    // Write data rows
-    for (int i = 0; i < model_->rowCount(); ++i) {
-        ContentItem item = model_->getItem(i);
-        
-        // Escape CSV fields (wrap in quotes if they contain commas, quotes, or newlines)
-        auto escapeField = [](const std::string& field) -> QString {
-            QString qfield = QString::fromStdString(field);
-            if (qfield.contains(',') || qfield.contains('"') || qfield.contains('\n')) {
-                qfield.replace('"', "\"\"");
-                return "\"" + qfield + "\"";
-            }
-            return qfield;
-        };
-        
-        out << escapeField(item.id) << ",";
-        out << escapeField(item.timestamp) << ",";
-        out << escapeField(item.author.value_or("N/A")) << ",";
-        out << escapeField(item.subreddit) << ",";
-        out << escapeField(item.content_type) << ",";
-        out << escapeField(item.text.value_or("")) << ",";
-        out << escapeField(item.image_path.value_or("")) << ",";
-        out << QString::number(item.ai_detection.ai_score, 'f', 4) << ",";
-        out << escapeField(item.ai_detection.label) << ",";
-        out << QString::number(item.moderation.labels.sexual, 'f', 4) << ",";
-        out << QString::number(item.moderation.labels.violence, 'f', 4) << ",";
-        out << QString::number(item.moderation.labels.hate, 'f', 4) << ",";
-        out << QString::number(item.moderation.labels.drugs, 'f', 4) << ",";
-        
-        // Additional labels as JSON-like string
-        QString additionalLabels = "{";
-        bool first = true;
-        for (const auto& [label, conf] : item.moderation.labels.additional_labels) {
-            if (!first) additionalLabels += ", ";
-            additionalLabels += QString::fromStdString(label) + ": " + QString::number(conf, 'f', 4);
-            first = false;
-        }
-        additionalLabels += "}";
-        out << escapeField(additionalLabels.toStdString()) << ",";
-        
-        out << escapeField(item.decision.auto_action) << ",";
-        out << escapeField(item.decision.rule_id) << "\n";
-    }
-    
-    file.close();
-    
-    QMessageBox::information(this, "Export Complete", 
-        QString("Successfully exported %1 items to:\n%2").arg(model_->rowCount()).arg(fileName));
+    startExport(fileName);
 }
 
 void MainWindow::onExportJson() {
@@ -1259,39 +1211,74 @@ void MainWindow::onExportJson() {
         this,
         "Export to JSON",
         QDir::homePath() + "/modai_export.json",
-        "JSON Files (*.json);;All Files (*)"
+        "JSON Files (*.json);;JSON Lines (*.jsonl *.ndjson);;All Files (*)"
     );
     
     if (fileName.isEmpty()) {
         return;
     }
-    
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Export Error", "Could not open file for writing: " + fileName);
+    startExport(fileName);
+}
+
+void MainWindow::startExport(const QString& fileName) {
+    if (exportJob_) {
+        QMessageBox::information(this, "Export", "An export is already running.");
         return;
     }
     
-    QTextStream out(&file);
-    
-    // Write JSON array
-    out << "[\n";
-    for (int i = 0; i < model_->rowCount(); ++i) {
-        ContentItem item = model_->getItem(i);
-        
-        if (i > 0) {
-            out << ",\n";
+    // Stream the current filter from storage; without one, export the table
+    std::unique_ptr<ContentCursor> cursor;
+    if (storagePtr_) {
+        cursor = storagePtr_->openCursor(historyQuery_);
+    } else {
+        std::vector<ContentItemPtr> rows;
+        rows.reserve(static_cast<size_t>(model_->rowCount()));
+        for (int i = 0; i < model_->rowCount(); ++i) {
+            rows.push_back(model_->itemAt(i));
         }
-        
-        // Use ContentItem's toJson method
-        out << QString::fromStdString(item.toJson());
+        cursor = std::make_unique<RowSnapshotCursor>(std::move(rows));
     }
-    out << "\n]\n";
     
-    file.close();
+    std::string path = fileName.toStdString();
+    exportJob_ = std::make_unique<ExportJob>(std::move(cursor), exportFormatForPath(path), path);
     
-    QMessageBox::information(this, "Export Complete", 
-        QString("Successfully exported %1 items to:\n%2").arg(model_->rowCount()).arg(fileName));
+    exportProgress_ = new QProgressDialog("Exporting...", "Cancel", 0, 0, this);
+    exportProgress_->setWindowTitle("Export");
+    exportProgress_->setMinimumDuration(500);
+    exportProgress_->setAttribute(Qt::WA_DeleteOnClose);
+    connect(exportProgress_, &QProgressDialog::canceled, this, [this]() {
+        if (exportJob_) {
+            exportJob_->cancel();
+        }
+    });
+    
+    exportJob_->setOnProgress([this](size_t written) {
+        QMetaObject::invokeMethod(this, [this, written]() {
+            if (exportProgress_) {
+                exportProgress_->setLabelText(QString("Exported %1 items...").arg(written));
+            }
+        }, Qt::QueuedConnection);
+    });
+    exportJob_->setOnFinished([this, fileName](size_t written, bool cancelled, const std::string& error) {
+        QMetaObject::invokeMethod(this, [this, fileName, written, cancelled, error]() {
+            if (exportProgress_) {
+                exportProgress_->close();
+                exportProgress_ = nullptr;
+            }
+            exportJob_.reset();
+            
+            if (cancelled) {
+                statusBar()->showMessage("Export cancelled", 3000);
+            } else if (!error.empty()) {
+                QMessageBox::critical(this, "Export Error",
+                    QString("Export to %1 failed:\n%2").arg(fileName, QString::fromStdString(error)));
+            } else {
+                QMessageBox::information(this, "Export Complete",
+                    QString("Successfully exported %1 items to:\n%2").arg(written).arg(fileName));
+            }
+        }, Qt::QueuedConnection);
+    });
+    exportJob_->start();
 }
 
 void MainWindow::onImportData() {
@@ -1323,6 +1310,7 @@ void MainWindow::onImportData() {
     }
     
     int importedCount = 0;
+    std::vector<ContentItem> imported;
     QTextStream in(&file);
     
     try {
@@ -1365,7 +1353,7 @@ void MainWindow::onImportData() {
                     
                     try {
                         ContentItem item = ContentItem::fromJson(itemJson.toStdString());
-                        model_->addItem(item);
+                        imported.push_back(std::move(item));
                         importedCount++;
                     } catch (const std::exception& e) {
                         Logger::warn("Failed to parse item: " + std::string(e.what()));
@@ -1537,7 +1525,7 @@ void MainWindow::onImportData() {
                     item.decision.auto_action = parseCSVField(record, pos).toStdString();
                     item.decision.rule_id = parseCSVField(record, pos).toStdString();
                     
-                    model_->addItem(item);
+                    imported.push_back(std::move(item));
                     importedCount++;
                     
                 } catch (const std::exception& e) {
@@ -1546,6 +1534,8 @@ void MainWindow::onImportData() {
             }
         }
         
+        // One insert for the whole file
+        model_->addItems(std::move(imported));
         file.close();
         
         QMessageBox::information(this, "Import Complete", 
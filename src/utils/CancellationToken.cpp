@@ -0,0 +1,136 @@
+#include "utils/CancellationToken.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace ModAI {
+
+struct CancellationState {
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::map<uint64_t, std::function<void()>> callbacks;
+    uint64_t nextId = 1;
+};
+
+namespace {
+
+thread_local CancellationToken currentToken;
+
+} // namespace
+
+bool CancellationToken::isCancelled() const {
+    return state_ && state_->cancelled.load(std::memory_order_acquire);
+}
+
+std::chrono::milliseconds CancellationToken::remaining(std::chrono::milliseconds cap) const {
+    if (isCancelled()) {
+        return std::chrono::milliseconds(0);
+    }
+    if (!hasDeadline()) {
+        return cap;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline_ - Clock::now());
+    return std::clamp(left, std::chrono::milliseconds(0), cap);
+}
+
+CancellationToken CancellationToken::withDeadline(Clock::time_point deadline) const {
+    CancellationToken token = *this;
+    token.deadline_ = std::min(deadline_, deadline);
+    return token;
+}
+
+CancellationToken::Registration CancellationToken::onCancel(std::function<void()> callback) const {
+    Registration registration;
+    if (!state_) {
+        return registration;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->cancelled) {
+            registration.state_ = state_;
+            registration.id_ = state_->nextId++;
+            state_->callbacks.emplace(registration.id_, std::move(callback));
+            return registration;
+        }
+    }
+    callback();
+    return registration;
+}
+
+const CancellationToken& CancellationToken::current() {
+    return currentToken;
+}
+
+CancellationToken::Registration::Registration(Registration&& other) noexcept
+    : state_(std::move(other.state_))
+    , id_(other.id_) {
+    other.id_ = 0;
+}
+
+CancellationToken::Registration& CancellationToken::Registration::operator=(Registration&& other) noexcept {
+    if (this != &other) {
+        reset();
+        state_ = std::move(other.state_);
+        id_ = other.id_;
+        other.id_ = 0;
+    }
+    return *this;
+}
+
+CancellationToken::Registration::~Registration() {
+    reset();
+}
+
+void CancellationToken::Registration::reset() {
+    if (auto state = state_.lock()) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->callbacks.erase(id_);
+    }
+    state_.reset();
+    id_ = 0;
+}
+
+CancellationSource::CancellationSource()
+    : state_(std::make_shared<CancellationState>()) {
+}
+
+CancellationToken CancellationSource::token() const {
+    CancellationToken token;
+    token.state_ = state_;
+    return token;
+}
+
+void CancellationSource::cancel() {
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->cancelled.exchange(true)) {
+            return;
+        }
+        for (auto& [id, callback] : state_->callbacks) {
+            callbacks.push_back(std::move(callback));
+        }
+        state_->callbacks.clear();
+    }
+    // Outside the lock: callbacks may register or unregister others
+    for (auto& callback : callbacks) {
+        callback();
+    }
+}
+
+bool CancellationSource::isCancelled() const {
+    return state_->cancelled.load(std::memory_order_acquire);
+}
+
+CancellationScope::CancellationScope(CancellationToken token)
+    : previous_(std::move(currentToken)) {
+    currentToken = std::move(token);
+}
+
+CancellationScope::~CancellationScope() {
+    currentToken = std::move(previous_);
+}
+
+} // namespace ModAI
@@ -0,0 +1,78 @@
+#include "utils/Clock.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace ModAI {
+
+namespace {
+
+void appendDigits(char*& out, int64_t value, int digits) {
+    for (int i = digits - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    out += digits;
+}
+
+// Days since 1970-01-01 to a proleptic Gregorian date (H. Hinnant's algorithm)
+void civilFromDays(int64_t days, int64_t& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t mp = (5 * dayOfYear + 2) / 153;
+    day = static_cast<int>(dayOfYear - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+} // namespace
+
+std::string formatTimestamp(int64_t unixMillis) {
+    int64_t seconds = unixMillis >= 0 ? unixMillis / 1000 : (unixMillis - 999) / 1000;
+    int64_t millis = unixMillis - seconds * 1000;
+    int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+    int64_t secondOfDay = seconds - days * 86400;
+
+    // Consecutive items mostly share the second, so the date part is cached
+    thread_local int64_t cachedDays = INT64_MIN;
+    thread_local char cachedDate[11];
+    if (days != cachedDays) {
+        int64_t year;
+        int month, day;
+        civilFromDays(days, year, month, day);
+        char* out = cachedDate;
+        appendDigits(out, year, 4);
+        *out++ = '-';
+        appendDigits(out, month, 2);
+        *out++ = '-';
+        appendDigits(out, day, 2);
+        *out++ = 'T';
+        cachedDays = days;
+    }
+
+    char buffer[24];
+    std::copy(cachedDate, cachedDate + 11, buffer);
+    char* out = buffer + 11;
+    appendDigits(out, secondOfDay / 3600, 2);
+    *out++ = ':';
+    appendDigits(out, secondOfDay / 60 % 60, 2);
+    *out++ = ':';
+    appendDigits(out, secondOfDay % 60, 2);
+    *out++ = '.';
+    appendDigits(out, millis, 3);
+    *out++ = 'Z';
+    return std::string(buffer, sizeof(buffer));
+}
+
+std::string formatTimestamp(std::chrono::system_clock::time_point time) {
+    return formatTimestamp(static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count()));
+}
+
+std::string currentTimestamp() {
+    return formatTimestamp(std::chrono::system_clock::now());
+}
+
+} // namespace ModAI
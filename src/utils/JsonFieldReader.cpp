@@ -0,0 +1,98 @@
+#include "utils/JsonFieldReader.h"
+#include <stdexcept>
+
+namespace ModAI {
+
+void JsonFieldReader::parse(const std::string& json) {
+    stack_.clear();
+    key_.clear();
+    nlohmann::json::sax_parse(json, this);
+}
+
+void JsonFieldReader::scalar(const JsonScalar& value) {
+    if (stack_.empty()) {
+        throw std::invalid_argument("JSON record is not an object");
+    }
+    if (stack_.back() != kSkip) {
+        onField(stack_.back(), key_, value);
+    }
+}
+
+bool JsonFieldReader::null() {
+    scalar(JsonScalar());
+    return true;
+}
+
+bool JsonFieldReader::boolean(bool value) {
+    JsonScalar scalarValue;
+    scalarValue.type = JsonScalar::Type::Boolean;
+    scalarValue.boolean = value;
+    scalar(scalarValue);
+    return true;
+}
+
+bool JsonFieldReader::number_integer(int64_t value) {
+    return number_float(static_cast<double>(value), std::string());
+}
+
+bool JsonFieldReader::number_unsigned(uint64_t value) {
+    return number_float(static_cast<double>(value), std::string());
+}
+
+bool JsonFieldReader::number_float(double value, const std::string&) {
+    JsonScalar scalarValue;
+    scalarValue.type = JsonScalar::Type::Number;
+    scalarValue.number = value;
+    scalar(scalarValue);
+    return true;
+}
+
+bool JsonFieldReader::string(std::string& value) {
+    JsonScalar scalarValue;
+    scalarValue.type = JsonScalar::Type::String;
+    scalarValue.text = &value;
+    scalar(scalarValue);
+    return true;
+}
+
+bool JsonFieldReader::binary(std::vector<uint8_t>&) {
+    return true;
+}
+
+bool JsonFieldReader::start_object(size_t) {
+    if (stack_.empty()) {
+        stack_.push_back(kRoot);
+    } else {
+        stack_.push_back(stack_.back() == kSkip ? kSkip : onObject(stack_.back(), key_));
+    }
+    return true;
+}
+
+bool JsonFieldReader::key(std::string& key) {
+    key_.swap(key);
+    return true;
+}
+
+bool JsonFieldReader::end_object() {
+    stack_.pop_back();
+    return true;
+}
+
+bool JsonFieldReader::start_array(size_t) {
+    if (stack_.empty()) {
+        throw std::invalid_argument("JSON record is not an object");
+    }
+    stack_.push_back(stack_.back() == kSkip ? kSkip : onArray(stack_.back(), key_));
+    return true;
+}
+
+bool JsonFieldReader::end_array() {
+    stack_.pop_back();
+    return true;
+}
+
+bool JsonFieldReader::parse_error(size_t, const std::string&, const nlohmann::detail::exception& error) {
+    throw std::invalid_argument(error.what());
+}
+
+} // namespace ModAI
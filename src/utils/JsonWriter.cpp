@@ -0,0 +1,165 @@
+#include "utils/JsonWriter.h"
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace ModAI {
+
+namespace {
+
+// Length of the well-formed UTF-8 sequence at text[i], or 0 if malformed
+// (overlongs, surrogates and code points past U+10FFFF are rejected)
+size_t utf8SequenceLength(std::string_view text, size_t i) {
+    auto byte = [&](size_t k) { return static_cast<unsigned char>(text[k]); };
+    unsigned char lead = byte(i);
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;  // range for the second byte
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (i + length > text.size() || byte(i + 1) < low || byte(i + 1) > high) {
+        return 0;
+    }
+    for (size_t k = 2; k < length; ++k) {
+        if (byte(i + k) < 0x80 || byte(i + k) > 0xBF) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+// Bytes that end a plain run: control characters, quote, backslash, non-ASCII
+struct PlainBytes {
+    bool plain[256] = {};
+    constexpr PlainBytes() {
+        for (int c = 0x20; c < 0x80; ++c) {
+            plain[c] = c != '"' && c != '\\';
+        }
+    }
+};
+constexpr PlainBytes kPlainBytes;
+
+} // namespace
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    static const char* const kHex = "0123456789abcdef";
+    out += '"';
+    size_t runStart = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (kPlainBytes.plain[c]) {
+            ++i;
+            continue;
+        }
+        if (c >= 0x80) {
+            size_t length = utf8SequenceLength(text, i);
+            if (length == 0) {
+                throw std::invalid_argument("invalid UTF-8 byte at index " + std::to_string(i));
+            }
+            i += length;
+            continue;
+        }
+        out.append(text.data() + runStart, i - runStart);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += kHex[c >> 4];
+                out += kHex[c & 0xF];
+                break;
+        }
+        runStart = ++i;
+    }
+    out.append(text.data() + runStart, text.size() - runStart);
+    out += '"';
+}
+
+void JsonWriter::separate() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (depth_ > 0) {
+        uint64_t bit = uint64_t(1) << ((depth_ - 1) & 63);
+        if (hasMember_ & bit) {
+            out_ += ',';
+        }
+        hasMember_ |= bit;
+    }
+}
+
+void JsonWriter::open(char bracket) {
+    separate();
+    out_ += bracket;
+    ++depth_;
+    hasMember_ &= ~(uint64_t(1) << ((depth_ - 1) & 63));
+}
+
+void JsonWriter::close(char bracket) {
+    out_ += bracket;
+    --depth_;
+}
+
+void JsonWriter::beginObject() { open('{'); }
+void JsonWriter::endObject() { close('}'); }
+void JsonWriter::beginArray() { open('['); }
+void JsonWriter::endArray() { close(']'); }
+
+void JsonWriter::key(std::string_view name) {
+    separate();
+    appendEscaped(out_, name);
+    out_ += ':';
+    afterKey_ = true;
+}
+
+void JsonWriter::string(std::string_view value) {
+    separate();
+    appendEscaped(out_, value);
+}
+
+void JsonWriter::number(double value) {
+    separate();
+    if (!std::isfinite(value)) {
+        out_ += "null";
+        return;
+    }
+    // The formatter dump() itself uses
+    std::array<char, 64> buffer;
+    char* end = nlohmann::detail::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    out_.append(buffer.data(), static_cast<size_t>(end - buffer.data()));
+}
+
+void JsonWriter::number(int64_t value) {
+    separate();
+    out_ += std::to_string(value);
+}
+
+void JsonWriter::boolean(bool value) {
+    separate();
+    out_ += value ? "true" : "false";
+}
+
+void JsonWriter::null() {
+    separate();
+    out_ += "null";
+}
+
+} // namespace ModAI
@@ -1,20 +1,328 @@
 #include "utils/Logger.h"
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace ModAI {
 
-std::string Logger::logFile_;
+namespace {
+
+Logger::Level initialLevel() {
+    if (const char* env = std::getenv("MODAI_LOG_LEVEL")) {
+        if (std::strcmp(env, "debug") == 0) return Logger::Debug;
+        if (std::strcmp(env, "info") == 0) return Logger::Info;
+        if (std::strcmp(env, "warn") == 0) return Logger::Warn;
+        if (std::strcmp(env, "error") == 0) return Logger::Error;
+    }
+#ifdef NDEBUG
+    return Logger::Info;
+#else
+    return Logger::Debug;
+#endif
+}
+
+struct Record {
+    Logger::Level level = Logger::Info;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+/**
+ * Fixed-capacity ring of records drained by one thread. Each drain is
+ * formatted into a single buffer and written with one fwrite per
+ * destination, so the file stays open and is flushed once per batch.
+ */
+class LogSink {
+public:
+    static LogSink& instance() {
+        // Never destroyed: records may still arrive from static destructors
+        static LogSink* sink = new LogSink();
+        return *sink;
+    }
+
+    void configure(const std::string& path, const Logger::Options& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_ = options;
+        if (ring_.size() != options_.queueCapacity) {
+            drainLocked();
+            ring_.assign(std::max<size_t>(options_.queueCapacity, 1), Record());
+            head_ = 0;
+            count_ = 0;
+        }
+        std::lock_guard<std::mutex> ioLock(ioMutex_);
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        path_ = path;
+        openFileLocked();
+    }
+
+    void push(Logger::Level level, const std::string& message) {
+        Record record;
+        record.level = level;
+        record.time = std::chrono::system_clock::now();
+        record.message = message;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopped_) {
+            // After shutdown there is no sink thread; write inline
+            std::vector<Record> batch;
+            batch.push_back(std::move(record));
+            std::lock_guard<std::mutex> ioLock(ioMutex_);
+            writeBatch(batch, 0);
+            return;
+        }
+        startLocked();
+
+        if (count_ == ring_.size()) {
+            if (level < Logger::Warn) {
+                ++dropped_;
+                return;
+            }
+            spaceCv_.wait(lock, [this]() { return count_ < ring_.size() || stopped_; });
+            if (stopped_) {
+                lock.unlock();
+                push(level, record.message);
+                return;
+            }
+        }
+        ring_[(head_ + count_) % ring_.size()] = std::move(record);
+        ++count_;
+        ++enqueued_;
+        if (count_ == 1) {
+            cv_.notify_one();
+        }
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        uint64_t target = enqueued_;
+        cv_.notify_one();
+        flushedCv_.wait(lock, [this, target]() { return written_ >= target || !running_; });
+    }
+
+    void shutdown() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        cv_.notify_one();
+        spaceCv_.notify_all();
+        std::thread thread = std::move(thread_);
+        lock.unlock();
+        if (thread.joinable()) {
+            thread.join();
+        }
+        lock.lock();
+        running_ = false;
+        // Anything left (no thread was ever started, or records raced the stop)
+        drainLocked();
+        flushedCv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable spaceCv_;
+    std::condition_variable flushedCv_;
+    std::vector<Record> ring_ = std::vector<Record>(Logger::Options().queueCapacity);
+    size_t head_ = 0;
+    size_t count_ = 0;
+    uint64_t enqueued_ = 0;
+    uint64_t written_ = 0;
+    size_t dropped_ = 0;
+    bool running_ = false;
+    bool stopped_ = false;
+    std::thread thread_;
+
+    // File state, touched only while writing
+    std::mutex ioMutex_;
+    Logger::Options options_;
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    size_t fileBytes_ = 0;
+    std::time_t cachedSecond_ = -1;
+    char cachedPrefix_[32] = {};
+
+    void startLocked() {
+        if (running_) {
+            return;
+        }
+        running_ = true;
+        thread_ = std::thread([this]() { run(); });
+        static bool registered = false;
+        if (!registered) {
+            registered = true;
+            std::atexit([]() { Logger::shutdown(); });
+        }
+    }
+
+    void run() {
+        std::vector<Record> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return count_ > 0 || stopped_; });
+            if (count_ == 0 && stopped_) {
+                return;
+            }
+            takeLocked(batch);
+            size_t dropped = dropped_;
+            dropped_ = 0;
+            lock.unlock();
+            spaceCv_.notify_all();
+
+            {
+                std::lock_guard<std::mutex> ioLock(ioMutex_);
+                writeBatch(batch, dropped);
+            }
+
+            lock.lock();
+            written_ += batch.size();
+            batch.clear();
+            flushedCv_.notify_all();
+        }
+    }
+
+    void takeLocked(std::vector<Record>& batch) {
+        batch.reserve(count_);
+        for (; count_ > 0; --count_) {
+            batch.push_back(std::move(ring_[head_]));
+            head_ = (head_ + 1) % ring_.size();
+        }
+    }
+
+    void drainLocked() {
+        if (count_ == 0 && dropped_ == 0) {
+            return;
+        }
+        std::vector<Record> batch;
+        takeLocked(batch);
+        std::lock_guard<std::mutex> ioLock(ioMutex_);
+        writeBatch(batch, dropped_);
+        written_ += batch.size();
+        dropped_ = 0;
+    }
+
+    void openFileLocked() {
+        fileBytes_ = 0;
+        if (path_.empty()) {
+            return;
+        }
+        file_ = std::fopen(path_.c_str(), "ab");
+        if (file_) {
+            std::fseek(file_, 0, SEEK_END);
+            long size = std::ftell(file_);
+            fileBytes_ = size > 0 ? static_cast<size_t>(size) : 0;
+        }
+    }
+
+    void rotateLocked() {
+        std::fclose(file_);
+        file_ = nullptr;
+        std::remove((path_ + "." + std::to_string(options_.maxFiles)).c_str());
+        for (int i = options_.maxFiles - 1; i >= 1; --i) {
+            std::rename((path_ + "." + std::to_string(i)).c_str(),
+                        (path_ + "." + std::to_string(i + 1)).c_str());
+        }
+        if (options_.maxFiles > 0) {
+            std::rename(path_.c_str(), (path_ + ".1").c_str());
+        } else {
+            std::remove(path_.c_str());
+        }
+        openFileLocked();
+    }
+
+    // "YYYY-MM-DD HH:MM:SS" in local time, recomputed once per second
+    const char* secondPrefix(std::time_t seconds) {
+        if (seconds != cachedSecond_) {
+            std::tm tm{};
+#ifdef _WIN32
+            localtime_s(&tm, &seconds);
+#else
+            localtime_r(&seconds, &tm);
+#endif
+            std::strftime(cachedPrefix_, sizeof(cachedPrefix_), "%Y-%m-%d %H:%M:%S", &tm);
+            cachedSecond_ = seconds;
+        }
+        return cachedPrefix_;
+    }
+
+    void appendLine(std::string& out, Logger::Level level, std::chrono::system_clock::time_point time,
+                    const std::string& message) {
+        auto sinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch());
+        std::time_t seconds = static_cast<std::time_t>(sinceEpoch.count() / 1000);
+        int millis = static_cast<int>(sinceEpoch.count() % 1000);
+        char stamp[48];
+        int length = std::snprintf(stamp, sizeof(stamp), "[%s.%03d] [", secondPrefix(seconds), millis);
+        out.append(stamp, static_cast<size_t>(length));
+        out += Logger::levelName(level);
+        out += "] ";
+        out += message;
+        out += '\n';
+    }
+
+    void writeBatch(const std::vector<Record>& batch, size_t dropped) {
+        std::string out;
+        if (dropped > 0) {
+            appendLine(out, Logger::Warn, std::chrono::system_clock::now(),
+                       std::to_string(dropped) + " log records dropped (queue full)");
+        }
+        for (const auto& record : batch) {
+            appendLine(out, record.level, record.time, record.message);
+        }
+        if (out.empty()) {
+            return;
+        }
+
+        if (options_.console) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            std::fflush(stdout);
+        }
+        if (file_) {
+            if (options_.maxFileBytes > 0 && fileBytes_ > 0 && fileBytes_ + out.size() > options_.maxFileBytes) {
+                rotateLocked();
+            }
+            if (file_) {
+                fileBytes_ += std::fwrite(out.data(), 1, out.size(), file_);
+                std::fflush(file_);
+            }
+        }
+    }
+};
+
+} // namespace
+
+std::atomic<int> Logger::threshold_{initialLevel()};
 
 void Logger::init(const std::string& logFile) {
-    logFile_ = logFile;
+    init(logFile, Options());
 }
 
-std::string Logger::levelToString(Level level) {
+void Logger::init(const std::string& logFile, const Options& options) {
+    LogSink::instance().configure(logFile, options);
+}
+
+void Logger::setLevel(Level level) {
+    threshold_.store(level, std::memory_order_relaxed);
+}
+
+Logger::Level Logger::level() {
+    return static_cast<Level>(threshold_.load(std::memory_order_relaxed));
+}
+
+const char* Logger::levelName(Level level) {
     switch (level) {
         case Debug: return "DEBUG";
         case Info: return "INFO";
@@ -25,33 +333,10 @@ std::string Logger::levelToString(Level level) {
 }
 
 void Logger::log(Level level, const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << "." << std::setfill('0') << std::setw(3) << ms.count();
-    
-    std::string timestamp = ss.str();
-    std::string levelStr = levelToString(level);
-    std::string logLine = "[" + timestamp + "] [" + levelStr + "] " + message;
-    
-    // Console output
-    std::cout << logLine << std::endl;
-    
-    // File output
-    if (!logFile_.empty()) {
-        static std::mutex logMutex;
-        std::lock_guard<std::mutex> lock(logMutex);
-        
-        std::ofstream file(logFile_, std::ios::app);
-        if (file.is_open()) {
-            file << logLine << std::endl;
-            file.close();
-        }
+    if (!enabled(level)) {
+        return;
     }
+    LogSink::instance().push(level, message);
 }
 
 void Logger::debug(const std::string& message) {
@@ -70,5 +355,12 @@ void Logger::error(const std::string& message) {
     log(Error, message);
 }
 
-} // namespace ModAI
+void Logger::flush() {
+    LogSink::instance().flush();
+}
+
+void Logger::shutdown() {
+    LogSink::instance().shutdown();
+}
 
+} // namespace ModAI
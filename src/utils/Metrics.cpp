@@ -0,0 +1,417 @@
+#include "utils/Metrics.h"
+#include "utils/JsonWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace ModAI {
+
+namespace {
+
+int highestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+template <typename T>
+using Family = std::map<std::string, std::unique_ptr<T>>;  // labels -> metric
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, Family<Counter>> counters;
+    std::map<std::string, Family<Gauge>> gauges;
+    std::map<std::string, Family<Histogram>> histograms;
+
+    static Registry& instance() {
+        // Never destroyed: metric references outlive static destructors
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+};
+
+template <typename T>
+T& lookup(std::map<std::string, Family<T>>& families, const std::string& name, const std::string& labels) {
+    auto& slot = families[name][labels];
+    if (!slot) {
+        slot = std::make_unique<T>();
+    }
+    return *slot;
+}
+
+std::string seriesName(const std::string& name, const std::string& labels, const std::string& extraLabel = "") {
+    std::string all = labels;
+    if (!extraLabel.empty()) {
+        if (!all.empty()) all += ',';
+        all += extraLabel;
+    }
+    return all.empty() ? name : name + "{" + all + "}";
+}
+
+std::string formatDouble(double value, const char* format = "%.6g") {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), format, value);
+    return std::string(buffer, static_cast<size_t>(std::max(length, 0)));
+}
+
+double millis(uint64_t micros) {
+    return static_cast<double>(micros) / 1000.0;
+}
+
+} // namespace
+
+// Histogram
+
+size_t Histogram::bucketIndex(uint64_t micros) {
+    if (micros < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<size_t>(micros);
+    }
+    int exponent = highestBit(micros);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    size_t sub = static_cast<size_t>((micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return kSubBuckets + static_cast<size_t>(exponent - kSubBucketBits) * kSubBuckets + sub;
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < static_cast<size_t>(kSubBuckets)) {
+        return index;
+    }
+    size_t exponent = (index - kSubBuckets) / kSubBuckets + kSubBucketBits;
+    uint64_t sub = (index - kSubBuckets) % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << (exponent - kSubBucketBits)) - 1;
+}
+
+void Histogram::record(uint64_t micros) {
+    buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (micros > seen && !max_.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::record(std::chrono::steady_clock::duration elapsed) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+}
+
+uint64_t Histogram::quantileMicros(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), maxMicros());
+        }
+    }
+    return maxMicros();
+}
+
+uint64_t Histogram::countAtOrBelow(uint64_t limitMicros) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount && bucketUpperBound(i) <= limitMicros; ++i) {
+        total += buckets_[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Metrics
+
+Counter& Metrics::counter(const std::string& name, const std::string& labels) {
+    Registry& registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return lookup(registry.counters, name, labels);
+}
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& labels) {
+    Registry& registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return lookup(registry.gauges, name, labels);
+}
+
+Histogram& Metrics::histogram(const std::string& name, const std::string& labels) {
+    Registry& registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return lookup(registry.histograms, name, labels);
+}
+
+std::string Metrics::renderPrometheus() {
+    Registry& registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::string out;
+
+    for (const auto& [name, family] : registry.counters) {
+        out += "# TYPE " + name + " counter\n";
+        for (const auto& [labels, counter] : family) {
+            out += seriesName(name, labels) + " " + std::to_string(counter->value()) + "\n";
+        }
+    }
+    for (const auto& [name, family] : registry.gauges) {
+        out += "# TYPE " + name + " gauge\n";
+        for (const auto& [labels, gauge] : family) {
+            out += seriesName(name, labels) + " " + std::to_string(gauge->value()) + "\n";
+        }
+    }
+    for (const auto& [name, family] : registry.histograms) {
+        out += "# TYPE " + name + " histogram\n";
+        for (const auto& [labels, histogram] : family) {
+            // Power-of-two boundaries from 16us to ~67s line up with bucket edges
+            for (int exponent = Histogram::kSubBucketBits; exponent <= 26; ++exponent) {
+                uint64_t limit = uint64_t(1) << exponent;
+                std::string le = "le=\"" + formatDouble(static_cast<double>(limit) / 1e6) + "\"";
+                out += seriesName(name + "_bucket", labels, le) + " " +
+                       std::to_string(histogram->countAtOrBelow(limit - 1)) + "\n";
+            }
+            out += seriesName(name + "_bucket", labels, "le=\"+Inf\"") + " " +
+                   std::to_string(histogram->count()) + "\n";
+            out += seriesName(name + "_sum", labels) + " " +
+                   formatDouble(static_cast<double>(histogram->sumMicros()) / 1e6) + "\n";
+            out += seriesName(name + "_count", labels) + " " + std::to_string(histogram->count()) + "\n";
+        }
+    }
+    return out;
+}
+
+std::string Metrics::renderJson() {
+    Registry& registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::string out;
+    JsonWriter writer(out);
+
+    writer.beginObject();
+    writer.key("counters");
+    writer.beginObject();
+    for (const auto& [name, family] : registry.counters) {
+        for (const auto& [labels, counter] : family) {
+            writer.key(seriesName(name, labels));
+            writer.number(static_cast<int64_t>(counter->value()));
+        }
+    }
+    writer.endObject();
+
+    writer.key("gauges");
+    writer.beginObject();
+    for (const auto& [name, family] : registry.gauges) {
+        for (const auto& [labels, gauge] : family) {
+            writer.key(seriesName(name, labels));
+            writer.number(gauge->value());
+        }
+    }
+    writer.endObject();
+
+    writer.key("histograms");
+    writer.beginObject();
+    for (const auto& [name, family] : registry.histograms) {
+        for (const auto& [labels, histogram] : family) {
+            uint64_t count = histogram->count();
+            writer.key(seriesName(name, labels));
+            writer.beginObject();
+            writer.key("count");
+            writer.number(static_cast<int64_t>(count));
+            writer.key("mean_ms");
+            writer.number(count ? millis(histogram->sumMicros()) / static_cast<double>(count) : 0.0);
+            writer.key("p50_ms");
+            writer.number(millis(histogram->quantileMicros(0.50)));
+            writer.key("p90_ms");
+            writer.number(millis(histogram->quantileMicros(0.90)));
+            writer.key("p99_ms");
+            writer.number(millis(histogram->quantileMicros(0.99)));
+            writer.key("max_ms");
+            writer.number(millis(histogram->maxMicros()));
+            writer.endObject();
+        }
+    }
+    writer.endObject();
+    writer.endObject();
+    return out;
+}
+
+std::string Metrics::renderSummary() {
+    Registry& registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::string out;
+    char line[256];
+
+    std::snprintf(line, sizeof(line), "%-56s %9s %9s %9s %9s %9s\n", "latency (ms)", "count", "p50", "p90", "p99", "max");
+    out += line;
+    for (const auto& [name, family] : registry.histograms) {
+        for (const auto& [labels, histogram] : family) {
+            std::snprintf(line, sizeof(line), "%-56s %9llu %9.2f %9.2f %9.2f %9.2f\n",
+                          seriesName(name, labels).c_str(),
+                          static_cast<unsigned long long>(histogram->count()),
+                          millis(histogram->quantileMicros(0.50)),
+                          millis(histogram->quantileMicros(0.90)),
+                          millis(histogram->quantileMicros(0.99)),
+                          millis(histogram->maxMicros()));
+            out += line;
+        }
+    }
+    out += "\n";
+    for (const auto& [name, family] : registry.counters) {
+        for (const auto& [labels, counter] : family) {
+            std::snprintf(line, sizeof(line), "%-56s %9llu\n", seriesName(name, labels).c_str(),
+                          static_cast<unsigned long long>(counter->value()));
+            out += line;
+        }
+    }
+    for (const auto& [name, family] : registry.gauges) {
+        for (const auto& [labels, gauge] : family) {
+            std::snprintf(line, sizeof(line), "%-56s %9lld\n", seriesName(name, labels).c_str(),
+                          static_cast<long long>(gauge->value()));
+            out += line;
+        }
+    }
+    return out;
+}
+
+bool Metrics::dumpToFile(const std::string& path, bool prometheus) {
+    std::string body = prometheus ? renderPrometheus() : renderJson();
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        file << body;
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+// Tracing
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t startMicros;
+    int64_t durationMicros;
+};
+
+struct ThreadTrace {
+    std::mutex mutex;  // uncontended except while stop() collects
+    uint64_t tid = 0;
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+struct TraceState {
+    std::mutex mutex;
+    std::string outputPath;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<std::shared_ptr<ThreadTrace>> threads;
+    uint64_t nextTid = 1;
+
+    static TraceState& instance() {
+        static TraceState* state = new TraceState();
+        return *state;
+    }
+};
+
+ThreadTrace& currentThreadTrace() {
+    thread_local std::shared_ptr<ThreadTrace> trace = [] {
+        auto created = std::make_shared<ThreadTrace>();
+        TraceState& state = TraceState::instance();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        created->tid = state.nextTid++;
+        state.threads.push_back(created);
+        return created;
+    }();
+    return *trace;
+}
+
+} // namespace
+
+std::atomic<bool> Tracing::enabled_{false};
+
+void Tracing::start(const std::string& outputPath) {
+    TraceState& state = TraceState::instance();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.outputPath = outputPath;
+        state.origin = std::chrono::steady_clock::now();
+        for (auto& thread : state.threads) {
+            std::lock_guard<std::mutex> threadLock(thread->mutex);
+            thread->events.clear();
+        }
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracing::setThreadName(const std::string& name) {
+    ThreadTrace& trace = currentThreadTrace();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.name = name;
+}
+
+void Tracing::record(const char* name, std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::time_point end) {
+    TraceState& state = TraceState::instance();
+    ThreadTrace& trace = currentThreadTrace();
+    auto since = [&state](std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - state.origin).count();
+    };
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.events.push_back({name, since(start), since(end) - since(start)});
+}
+
+bool Tracing::stop() {
+    if (!enabled_.exchange(false)) {
+        return false;
+    }
+    TraceState& state = TraceState::instance();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::string out;
+    JsonWriter writer(out);
+    writer.beginObject();
+    writer.key("traceEvents");
+    writer.beginArray();
+    for (auto& thread : state.threads) {
+        std::lock_guard<std::mutex> threadLock(thread->mutex);
+        if (!thread->name.empty()) {
+            writer.beginObject();
+            writer.key("name"); writer.string("thread_name");
+            writer.key("ph"); writer.string("M");
+            writer.key("pid"); writer.number(int64_t(1));
+            writer.key("tid"); writer.number(static_cast<int64_t>(thread->tid));
+            writer.key("args");
+            writer.beginObject();
+            writer.key("name"); writer.string(thread->name);
+            writer.endObject();
+            writer.endObject();
+        }
+        for (const auto& event : thread->events) {
+            writer.beginObject();
+            writer.key("name"); writer.string(event.name);
+            writer.key("ph"); writer.string("X");
+            writer.key("pid"); writer.number(int64_t(1));
+            writer.key("tid"); writer.number(static_cast<int64_t>(thread->tid));
+            writer.key("ts"); writer.number(event.startMicros);
+            writer.key("dur"); writer.number(event.durationMicros);
+            writer.endObject();
+        }
+        thread->events.clear();
+    }
+    writer.endArray();
+    writer.endObject();
+
+    std::ofstream file(state.outputPath, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << out;
+    return static_cast<bool>(file);
+}
+
+} // namespace ModAI
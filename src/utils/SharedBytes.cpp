@@ -0,0 +1,62 @@
+#include "utils/SharedBytes.h"
+#include <QByteArray>
+#include <QFile>
+#include <cstring>
+
+namespace ModAI {
+
+SharedBytes SharedBytes::copyOf(const void* data, size_t size) {
+    auto buffer = std::make_shared<std::vector<uint8_t>>(size);
+    if (size > 0) {
+        std::memcpy(buffer->data(), data, size);
+    }
+    const uint8_t* begin = buffer->data();
+    return SharedBytes(std::move(buffer), begin, size);
+}
+
+SharedBytes SharedBytes::fromVector(std::vector<uint8_t> bytes) {
+    auto buffer = std::make_shared<std::vector<uint8_t>>(std::move(bytes));
+    const uint8_t* begin = buffer->data();
+    size_t size = buffer->size();
+    return SharedBytes(std::move(buffer), begin, size);
+}
+
+SharedBytes SharedBytes::fromString(std::string bytes) {
+    auto buffer = std::make_shared<std::string>(std::move(bytes));
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(buffer->data());
+    size_t size = buffer->size();
+    return SharedBytes(std::move(buffer), begin, size);
+}
+
+SharedBytes SharedBytes::fromQByteArray(const QByteArray& bytes) {
+    // Holding a copy keeps the shared data alive and unmodified
+    auto buffer = std::make_shared<const QByteArray>(bytes);
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(buffer->constData());
+    size_t size = static_cast<size_t>(buffer->size());
+    return SharedBytes(std::move(buffer), begin, size);
+}
+
+SharedBytes SharedBytes::mapFile(const std::string& path) {
+    auto file = std::make_shared<QFile>(QString::fromStdString(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return SharedBytes();
+    }
+    qint64 size = file->size();
+    if (size <= 0) {
+        return SharedBytes();
+    }
+    if (uchar* mapped = file->map(0, size)) {
+        // The mapping stays valid until the QFile is unmapped or destroyed
+        std::shared_ptr<const void> owner(file.get(), [file, mapped](const void*) {
+            file->unmap(mapped);
+        });
+        return SharedBytes(std::move(owner), mapped, static_cast<size_t>(size));
+    }
+    return fromQByteArray(file->readAll());
+}
+
+QByteArray SharedBytes::toRawQByteArray() const {
+    return QByteArray::fromRawData(chars(), static_cast<int>(size_));
+}
+
+} // namespace ModAI
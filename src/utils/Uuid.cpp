@@ -0,0 +1,57 @@
+#include "utils/Uuid.h"
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace ModAI {
+
+namespace {
+
+struct UuidState {
+    std::mt19937_64 rng{std::random_device{}()};
+    uint64_t lastMillis = 0;
+    uint32_t sequence = 0;
+};
+
+void appendHex(char*& out, uint64_t value, int digits) {
+    static const char* const kHex = "0123456789abcdef";
+    for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+        *out++ = kHex[(value >> shift) & 0xF];
+    }
+}
+
+} // namespace
+
+std::string newUuidV7() {
+    thread_local UuidState state;
+
+    uint64_t millis = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    uint64_t random = state.rng();
+
+    // 12-bit sequence: random start each millisecond, +1 within it. On
+    // overflow (or a clock step back) borrow the next millisecond.
+    if (millis > state.lastMillis) {
+        state.lastMillis = millis;
+        state.sequence = static_cast<uint32_t>(random >> 53) & 0x7FF;
+    } else if (++state.sequence > 0xFFF) {
+        ++state.lastMillis;
+        state.sequence = 0;
+    }
+    millis = state.lastMillis;
+
+    char buffer[36];
+    char* out = buffer;
+    appendHex(out, millis >> 16, 8);
+    *out++ = '-';
+    appendHex(out, millis & 0xFFFF, 4);
+    *out++ = '-';
+    appendHex(out, 0x7000 | state.sequence, 4);
+    *out++ = '-';
+    appendHex(out, 0x8000 | ((random >> 32) & 0x3FFF), 4);
+    *out++ = '-';
+    appendHex(out, random & 0xFFFFFFFFFFFFull, 12);
+    return std::string(buffer, sizeof(buffer));
+}
+
+} // namespace ModAI
@@ -0,0 +1,304 @@
+// Accuracy-regression harness for the exported model variants (fp32, int8,
+// fp16). Each variant is scored on a labelled sample set with the same
+// LocalAIDetector the app uses, and compared with the fp32 baseline:
+// accuracy, ROC AUC, score drift and decision flips, plus model size,
+// load time, single-item latency and batched throughput.
+//
+// Usage: eval_model_variants [--model-dir <dir>] [--samples <jsonl>]
+//                            [--variants fp32,int8,fp16] [--batch 16]
+//                            [--threads N] [--max-drift 0.05]
+//                            [--max-accuracy-drop 0.02]
+//
+// Samples are JSON lines: {"text": "...", "label": 1} with 1 = AI-generated.
+// With --max-drift / --max-accuracy-drop the exit code is 1 if any variant
+// exceeds them, so it can gate a variant switch.
+
+#include "detectors/LocalAIDetector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample {
+    std::string text;
+    int label = 0;  // 1 = AI-generated
+};
+
+struct VariantReport {
+    std::string variant;
+    double sizeMb = 0.0;
+    double loadMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double itemsPerSecond = 0.0;
+    double accuracy = 0.0;
+    double auc = 0.0;
+    double meanDrift = 0.0;
+    double maxDrift = 0.0;
+    size_t flips = 0;
+    std::vector<double> scores;
+};
+
+std::vector<Sample> loadSamples(const std::string& path) {
+    std::vector<Sample> samples;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            auto j = nlohmann::json::parse(line);
+            samples.push_back({j.at("text").get<std::string>(), j.at("label").get<int>()});
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping bad sample line: " << e.what() << std::endl;
+        }
+    }
+    return samples;
+}
+
+// Includes external weight data, which large exports are split into
+double modelSizeMb(const std::string& path) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    auto bytes = fs::file_size(path, ec);
+    if (ec) {
+        return 0.0;
+    }
+    for (const char* suffix : {".data", "_data"}) {
+        auto extra = fs::file_size(path + suffix, ec);
+        if (!ec) {
+            bytes += extra;
+        }
+    }
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+// Probability that a random AI sample scores above a random human one
+double rocAuc(const std::vector<double>& scores, const std::vector<Sample>& samples) {
+    double pairs = 0.0;
+    double wins = 0.0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].label != 1) {
+            continue;
+        }
+        for (size_t j = 0; j < samples.size(); ++j) {
+            if (samples[j].label != 0) {
+                continue;
+            }
+            pairs += 1.0;
+            if (scores[i] > scores[j]) {
+                wins += 1.0;
+            } else if (scores[i] == scores[j]) {
+                wins += 0.5;
+            }
+        }
+    }
+    return pairs > 0.0 ? wins / pairs : 0.0;
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool evaluate(const std::string& modelDir, const std::string& variant, const std::vector<Sample>& samples,
+              size_t batchSize, const ModAI::OnnxSessionOptions& options, double threshold,
+              VariantReport& report) {
+    std::string modelPath = ModAI::LocalAIDetector::variantModelPath(modelDir, variant);
+    if (!std::filesystem::exists(modelPath)) {
+        std::cerr << "⚠ " << variant << ": " << modelPath << " not found, skipping" << std::endl;
+        return false;
+    }
+    report.variant = variant;
+    report.sizeMb = modelSizeMb(modelPath);
+
+    auto loadStart = Clock::now();
+    ModAI::LocalAIDetector detector(modelPath, modelDir, 768, static_cast<float>(threshold), options);
+    report.loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+    if (!detector.isAvailable()) {
+        std::cerr << "❌ " << variant << ": model failed to load" << std::endl;
+        return false;
+    }
+
+    // Single-item latency, as the pipeline sees it for a lone item
+    std::vector<double> latencies;
+    latencies.reserve(samples.size());
+    report.scores.reserve(samples.size());
+    for (const auto& sample : samples) {
+        auto start = Clock::now();
+        auto result = detector.analyze(sample.text);
+        latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        report.scores.push_back(result.ai_score);
+    }
+    report.p50Ms = percentile(latencies, 0.50);
+    report.p95Ms = percentile(latencies, 0.95);
+
+    // Throughput with the AI stage's batch size
+    auto batchStart = Clock::now();
+    for (size_t begin = 0; begin < samples.size(); begin += batchSize) {
+        std::vector<std::string> texts;
+        for (size_t i = begin; i < std::min(samples.size(), begin + batchSize); ++i) {
+            texts.push_back(samples[i].text);
+        }
+        detector.analyzeBatch(texts);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+    report.itemsPerSecond = seconds > 0.0 ? static_cast<double>(samples.size()) / seconds : 0.0;
+
+    size_t correct = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        int predicted = report.scores[i] >= threshold ? 1 : 0;
+        if (predicted == samples[i].label) {
+            ++correct;
+        }
+    }
+    report.accuracy = static_cast<double>(correct) / static_cast<double>(samples.size());
+    report.auc = rocAuc(report.scores, samples);
+    return true;
+}
+
+void compareWithBaseline(const VariantReport& baseline, VariantReport& report, double threshold) {
+    double total = 0.0;
+    for (size_t i = 0; i < report.scores.size(); ++i) {
+        double drift = std::fabs(report.scores[i] - baseline.scores[i]);
+        total += drift;
+        report.maxDrift = std::max(report.maxDrift, drift);
+        if ((report.scores[i] >= threshold) != (baseline.scores[i] >= threshold)) {
+            ++report.flips;
+        }
+    }
+    report.meanDrift = report.scores.empty() ? 0.0 : total / static_cast<double>(report.scores.size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* home = std::getenv("HOME");
+    std::string modelDir = std::string(home ? home : ".") + "/.local/share/ModAI/ModAI/data/models";
+    std::string samplesPath = "tests/data/ai_detection_samples.jsonl";
+    std::vector<std::string> variants = {"fp32", "int8", "fp16"};
+    size_t batchSize = 16;
+    double threshold = 0.5;
+    double maxDrift = -1.0;
+    double maxAccuracyDrop = -1.0;
+    ModAI::OnnxSessionOptions options;
+    options.warmUp = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--model-dir" && hasValue) {
+            modelDir = argv[++i];
+        } else if (arg == "--samples" && hasValue) {
+            samplesPath = argv[++i];
+        } else if (arg == "--variants" && hasValue) {
+            variants = splitList(argv[++i]);
+        } else if (arg == "--batch" && hasValue) {
+            batchSize = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            options.intraOpThreads = std::atoi(argv[++i]);
+        } else if (arg == "--max-drift" && hasValue) {
+            maxDrift = std::atof(argv[++i]);
+        } else if (arg == "--max-accuracy-drop" && hasValue) {
+            maxAccuracyDrop = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    // fp32 is the reference every other variant is compared with
+    variants.erase(std::remove(variants.begin(), variants.end(), "fp32"), variants.end());
+    variants.insert(variants.begin(), "fp32");
+
+    auto samples = loadSamples(samplesPath);
+    if (samples.empty()) {
+        std::cerr << "❌ No samples loaded from " << samplesPath << std::endl;
+        return 1;
+    }
+    std::cout << "Evaluating " << samples.size() << " samples from " << samplesPath << std::endl;
+    std::cout << "Model directory: " << modelDir << std::endl << std::endl;
+
+    std::vector<VariantReport> reports;
+    for (const auto& variant : variants) {
+        VariantReport report;
+        if (evaluate(modelDir, variant, samples, batchSize, options, threshold, report)) {
+            reports.push_back(std::move(report));
+        } else if (variant == "fp32") {
+            std::cerr << "❌ The fp32 baseline is required" << std::endl;
+            return 1;
+        }
+    }
+
+    const VariantReport& baseline = reports.front();
+    for (size_t i = 1; i < reports.size(); ++i) {
+        compareWithBaseline(baseline, reports[i], threshold);
+    }
+
+    std::cout << std::left << std::setw(8) << "variant" << std::right
+              << std::setw(10) << "size MB" << std::setw(10) << "load ms"
+              << std::setw(9) << "p50 ms" << std::setw(9) << "p95 ms"
+              << std::setw(10) << "items/s" << std::setw(8) << "speedup"
+              << std::setw(9) << "acc" << std::setw(8) << "AUC"
+              << std::setw(11) << "mean drift" << std::setw(10) << "max drift"
+              << std::setw(7) << "flips" << std::endl;
+    std::cout << std::fixed;
+    for (const auto& r : reports) {
+        double speedup = baseline.itemsPerSecond > 0.0 ? r.itemsPerSecond / baseline.itemsPerSecond : 0.0;
+        std::cout << std::left << std::setw(8) << r.variant << std::right << std::setprecision(1)
+                  << std::setw(10) << r.sizeMb << std::setw(10) << r.loadMs
+                  << std::setprecision(2) << std::setw(9) << r.p50Ms << std::setw(9) << r.p95Ms
+                  << std::setprecision(1) << std::setw(10) << r.itemsPerSecond
+                  << std::setprecision(2) << std::setw(7) << speedup << "x"
+                  << std::setprecision(3) << std::setw(9) << r.accuracy << std::setw(8) << r.auc
+                  << std::setprecision(4) << std::setw(11) << r.meanDrift << std::setw(10) << r.maxDrift
+                  << std::setw(7) << r.flips << std::endl;
+    }
+
+    bool passed = true;
+    for (size_t i = 1; i < reports.size(); ++i) {
+        const auto& r = reports[i];
+        if (maxDrift >= 0.0 && r.maxDrift > maxDrift) {
+            std::cout << "❌ " << r.variant << ": max drift " << r.maxDrift << " exceeds " << maxDrift << std::endl;
+            passed = false;
+        }
+        if (maxAccuracyDrop >= 0.0 && baseline.accuracy - r.accuracy > maxAccuracyDrop) {
+            std::cout << "❌ " << r.variant << ": accuracy drop " << (baseline.accuracy - r.accuracy)
+                      << " exceeds " << maxAccuracyDrop << std::endl;
+            passed = false;
+        }
+    }
+    if (passed && (maxDrift >= 0.0 || maxAccuracyDrop >= 0.0)) {
+        std::cout << "✓ All variants within tolerance" << std::endl;
+    }
+    return passed ? 0 : 1;
+}
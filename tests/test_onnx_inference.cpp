@@ -2,137 +2,20 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <sstream>
-#include <algorithm>
-#include <unordered_map>
 #include <iomanip>
 
+#include "detectors/Tokenizer.h"
+
 #ifdef ONNXRUNTIME_FOUND
 #include <onnxruntime_cxx_api.h>
 #endif
 
-// Simple tokenizer for testing
-class SimpleTokenizer {
-public:
-    SimpleTokenizer(const std::string& vocabPath) {
-        loadVocab(vocabPath);
-    }
-    
-    std::vector<int64_t> encode(const std::string& text, int maxLength) {
-        std::vector<int64_t> tokens;
-        tokens.push_back(getTokenId("[CLS]"));
-        
-        std::istringstream iss(text);
-        std::string word;
-        
-        while (iss >> word && tokens.size() < maxLength - 1) {
-            // Split trailing punctuation from word
-            while (!word.empty() && std::ispunct(word.back()) && tokens.size() < maxLength - 1) {
-                char punct = word.back();
-                word.pop_back();
-                
-                // Queue punctuation token for later
-                if (!word.empty()) {
-                    // Process word first
-                    std::string spToken = "\u2581" + word;
-                    auto it = vocab_.find(spToken);
-                    if (it != vocab_.end()) {
-                        tokens.push_back(it->second);
-                    } else {
-                        tokens.push_back(getTokenId("[UNK]"));
-                    }
-                    word.clear();
-                }
-                
-                // Then add punctuation (without ▁ prefix for punctuation)
-                std::string punctStr(1, punct);
-                auto punct_it = vocab_.find(punctStr);
-                if (punct_it != vocab_.end()) {
-                    tokens.push_back(punct_it->second);
-                } else {
-                    // Try with ▁ prefix
-                    std::string spPunct = "\u2581" + punctStr;
-                    punct_it = vocab_.find(spPunct);
-                    if (punct_it != vocab_.end()) {
-                        tokens.push_back(punct_it->second);
-                    } else {
-                        tokens.push_back(getTokenId("[UNK]"));
-                    }
-                }
-            }
-            
-            // Process remaining word (if any)
-            if (!word.empty()) {
-                std::string spToken = "\u2581" + word;
-                auto it = vocab_.find(spToken);
-                if (it != vocab_.end()) {
-                    tokens.push_back(it->second);
-                } else {
-                    tokens.push_back(getTokenId("[UNK]"));
-                }
-            }
-        }
-        
-        tokens.push_back(getTokenId("[SEP]"));
-        
-        if (tokens.size() < maxLength) {
-            tokens.resize(maxLength, getTokenId("[PAD]"));
-        } else if (tokens.size() > maxLength) {
-            tokens.resize(maxLength);
-            tokens[maxLength - 1] = getTokenId("[SEP]");
-        }
-        
-        return tokens;
-    }
-    
-    std::vector<int64_t> getAttentionMask(const std::vector<int64_t>& tokens) {
-        std::vector<int64_t> mask;
-        int64_t padId = getTokenId("[PAD]");
-        
-        for (auto token : tokens) {
-            mask.push_back(token != padId ? 1 : 0);
-        }
-        
-        return mask;
-    }
-
-private:
-    std::unordered_map<std::string, int64_t> vocab_;
-    
-    void loadVocab(const std::string& path) {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            std::cerr << "Error: Failed to load vocabulary from: " << path << std::endl;
-            return;
-        }
-        
-        std::string token;
-        int64_t id = 0;
-        
-        while (std::getline(file, token)) {
-            if (!token.empty()) {
-                vocab_[token] = id++;
-            }
-        }
-        
-        std::cout << "✓ Loaded vocabulary with " << vocab_.size() << " tokens" << std::endl;
-    }
-    
-    int64_t getTokenId(const std::string& token) {
-        auto it = vocab_.find(token);
-        if (it != vocab_.end()) {
-            return it->second;
-        }
-        auto unk_it = vocab_.find("[UNK]");
-        return unk_it != vocab_.end() ? unk_it->second : 1;
-    }
-};
-
 #ifdef ONNXRUNTIME_FOUND
-float runInference(Ort::Session& session, const std::vector<int64_t>& input_ids, 
-                   const std::vector<int64_t>& attention_mask, int maxLength) {
+float runInference(Ort::Session& session, const std::vector<int64_t>& input_ids) {
     try {
-        std::vector<int64_t> inputShape = {1, static_cast<int64_t>(maxLength)};
+        // Unpadded single sequence: every position is attended
+        std::vector<int64_t> attention_mask(input_ids.size(), 1);
+        std::vector<int64_t> inputShape = {1, static_cast<int64_t>(input_ids.size())};
         
         auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
         
@@ -247,7 +130,12 @@ int main(int argc, char* argv[]) {
     }
     
     if (interactive) std::cout << "[1/4] Loading tokenizer..." << std::endl;
-    SimpleTokenizer tokenizer(vocabPath);
+    ModAI::Tokenizer tokenizer;
+    if (!tokenizer.loadVocab(vocabPath)) {
+        std::cerr << "Error: Failed to load vocabulary from: " << vocabPath << std::endl;
+        return 1;
+    }
+    std::cout << "✓ Loaded vocabulary with " << tokenizer.vocabSize() << " tokens" << std::endl;
     if (interactive) std::cout << std::endl;
     
     if (interactive) std::cout << "[2/4] Loading ONNX model..." << std::endl;
@@ -269,8 +157,7 @@ int main(int argc, char* argv[]) {
         // If specific text provided, just test that
         if (!testText.empty()) {
             auto input_ids = tokenizer.encode(testText, maxLength);
-            auto attention_mask = tokenizer.getAttentionMask(input_ids);
-            float probability = runInference(session, input_ids, attention_mask, maxLength);
+            float probability = runInference(session, input_ids);
             
             if (probability >= 0) {
                 std::string label = probability >= threshold ? "AI-generated" : "Human-written";
@@ -307,10 +194,9 @@ int main(int argc, char* argv[]) {
             
             // Tokenize
             auto input_ids = tokenizer.encode(text, maxLength);
-            auto attention_mask = tokenizer.getAttentionMask(input_ids);
             
             // Run inference
-            float probability = runInference(session, input_ids, attention_mask, maxLength);
+            float probability = runInference(session, input_ids);
             
             if (probability < 0) {
                 std::cout << "❌ Inference failed" << std::endl;
@@ -349,8 +235,7 @@ int main(int argc, char* argv[]) {
             }
             
             auto input_ids = tokenizer.encode(line, maxLength);
-            auto attention_mask = tokenizer.getAttentionMask(input_ids);
-            float probability = runInference(session, input_ids, attention_mask, maxLength);
+            float probability = runInference(session, input_ids);
             
             if (probability >= 0) {
                 std::string label = probability >= threshold ? "AI-generated" : "Human-written";